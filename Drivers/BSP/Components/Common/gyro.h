@@ -81,6 +81,9 @@ typedef struct
   void       (*FilterConfig)(uint8_t);  
   void       (*FilterCmd)(uint8_t);  
   void       (*GetXYZ)(float *);
+  void       (*FIFOConfig)(uint16_t);
+  uint8_t    (*FIFOStatus)(void);
+  void       (*GetXYZQ16)(int32_t *);
 }GYRO_DrvTypeDef;
 /**
   * @}
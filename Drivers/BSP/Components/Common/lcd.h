@@ -65,6 +65,9 @@
 /** @defgroup LCD_Driver_structure  LCD Driver structure
   * @{
   */
+/* Renders line Line (0 = top of the area) of Width RGB565 pixels */
+typedef void (*LCD_SpanRenderTypeDef)(uint16_t Line, uint16_t *pSpan, uint16_t Width);
+
 typedef struct
 {
   void     (*Init)(void);
@@ -84,6 +87,13 @@ typedef struct
   uint16_t (*GetLcdPixelHeight)(void);
   void     (*DrawBitmap)(uint16_t, uint16_t, uint8_t*);
   void     (*DrawRGBImage)(uint16_t, uint16_t, uint16_t, uint16_t, uint8_t*);
+
+  /* Bulk operations: one display window, pixels streamed by DMA.
+     DrawRGBImage, FillRect and DrawRGBSpans are optional: a driver without
+     them (spfd5408) leaves them NULL, and callers test them before use and
+     fall back to WritePixel or DrawHLine. */
+  void     (*FillRect)(uint16_t, uint16_t, uint16_t, uint16_t, uint16_t);
+  void     (*DrawRGBSpans)(uint16_t, uint16_t, uint16_t, uint16_t, LCD_SpanRenderTypeDef);
 }LCD_DrvTypeDef;    
 /**
   * @}
@@ -5,6 +5,23 @@
   * @version V1.1.1
   * @date    24-November-2014
   * @brief   This file includes the LCD driver for HX8347D LCD.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - The bulk operations (hx8347d_FillRect(), hx8347d_DrawRGBImage(),
+  *             hx8347d_DrawRGBSpans(), and the lines and bitmaps drawn with
+  *             them) set the display window once and stream the pixels with
+  *             LCD_IO_FillDataDMA() or LCD_IO_WriteDataDMA(). They return
+  *             with the last transfer in progress, except
+  *             hx8347d_DrawRGBImage(), which waits so that the caller can
+  *             reuse the image buffer.
+  *           - Their areas follow hx8347d_SetDisplayWindow(): Xpos and Height
+  *             on the row registers, Ypos and Width, the direction of the
+  *             lines, on the column registers.
+  *           - hx8347d_DrawRGBSpans() renders each line into one of the two
+  *             line buffers while the other is sent.
+  *           - The next hx8347d_SetCursor() restores the full screen window.
+  *          ===================================================================
   ******************************************************************************
   * @attention
   *
@@ -37,6 +54,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "hx8347d.h"
+#include <string.h>
 
 /** @addtogroup BSP
 * @{
@@ -94,10 +112,16 @@ LCD_DrvTypeDef   hx8347d_drv =
   hx8347d_GetLcdPixelWidth,
   hx8347d_GetLcdPixelHeight,
   hx8347d_DrawBitmap,  
+  hx8347d_DrawRGBImage,
+  hx8347d_FillRect,
+  hx8347d_DrawRGBSpans,
 };
 
 static uint8_t Is_hx8347d_Initialized = 0;
-static uint16_t ArrayRGB[320] = {0};
+/* Line buffers: one is filled while the other is sent */
+static uint16_t ArrayRGB[2][HX8347D_LCD_PIXEL_WIDTH];
+/* A bulk operation left a window smaller than the screen */
+static uint8_t WindowSet = 0;
 
 
 /**
@@ -107,6 +131,7 @@ static uint16_t ArrayRGB[320] = {0};
 /** @defgroup HX8347D_Private_FunctionPrototypes
 * @{
 */
+static uint8_t hx8347d_BeginWrite(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height);
 
 /**
 * @}
@@ -303,6 +328,12 @@ uint16_t hx8347d_ReadID(void)
 */
 void hx8347d_SetCursor(uint16_t Xpos, uint16_t Ypos)
 {
+  if(WindowSet != 0)
+  {
+    /* The end addresses are only set by the window */
+    hx8347d_SetDisplayWindow(0, 0, HX8347D_LCD_PIXEL_WIDTH, HX8347D_LCD_PIXEL_HEIGHT);
+    WindowSet = 0;
+  }
   hx8347d_WriteReg(LCD_REG_6, 0x00);
   hx8347d_WriteReg(LCD_REG_7, Xpos);
   hx8347d_WriteReg(LCD_REG_2, Ypos >> 8);
@@ -407,22 +438,7 @@ void hx8347d_SetDisplayWindow(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint
 */
 void hx8347d_DrawHLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16_t Length)
 {
-  uint32_t i = 0;
-  
-  /* Set Cursor */
-  hx8347d_SetCursor(Xpos, Ypos); 
-  
-  /* Prepare to write GRAM */
-  LCD_IO_WriteReg(LCD_REG_34);
-  
-  
-  /* Sent a complete line */
-  for(i = 0; i < Length; i++)
-  {
-    ArrayRGB[i] = RGBCode;
-  }  
-
-  LCD_IO_WriteMultipleData((uint8_t*)&ArrayRGB[0], Length * 2);
+  hx8347d_FillRect(Xpos, Ypos, Length, 1, RGBCode);
 }
 
 /**
@@ -435,21 +451,7 @@ void hx8347d_DrawHLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16_t
 */
 void hx8347d_DrawVLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16_t Length)
 {
-  uint16_t counter = 0;
-  
-  /* Set Cursor */
-  hx8347d_SetCursor(Xpos, Ypos);
-  /* Prepare to write GRAM */
-  LCD_IO_WriteReg(LCD_REG_34);
-  
-  /* Fill a complete vertical line */
-  for(counter = 0; counter < Length; counter++)
-  {
-    ArrayRGB[counter] = RGBCode;
-  }
-  
-  /* Write 16-bit GRAM Reg */
-  LCD_IO_WriteMultipleData((uint8_t*)&ArrayRGB[0], Length * 2);
+  hx8347d_FillRect(Xpos, Ypos, 1, Length, RGBCode);
 }
 
 /**
@@ -480,13 +482,128 @@ void hx8347d_DrawBitmap(uint16_t Xpos, uint16_t Ypos, uint8_t *pbmp)
   /* Prepare to write GRAM */
   LCD_IO_WriteReg(LCD_REG_34);
   
-  LCD_IO_WriteMultipleData((uint8_t*)pbmp, size*2);
+  if(((uintptr_t)pbmp & 1U) == 0)
+  {
+    /* Restoring the access control waits for the end of the transfer */
+    LCD_IO_WriteDataDMA((uint16_t*)pbmp, size);
+  }
+  else
+  {
+    LCD_IO_WriteMultipleData((uint8_t*)pbmp, size*2);
+  }
   
   /* Set GRAM write direction and BGR = 0 */
   /* Memory access control: MY = 1, MX = 1, MV = 1, ML = 0 */
   hx8347d_WriteReg(LCD_REG_22, 0xE0);
 }
 
+/**
+* @brief  Fills a rectangle with one color.
+* @param  Xpos:    specifies the X position.
+* @param  Ypos:    specifies the Y position.
+* @param  Width:   rectangle width.
+* @param  Height:  rectangle height.
+* @param  RGBCode: the RGB color.
+* @retval None
+*/
+void hx8347d_FillRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, uint16_t RGBCode)
+{
+  if(hx8347d_BeginWrite(Xpos, Ypos, Width, Height) == 0)
+  {
+    LCD_IO_FillDataDMA(RGBCode, (uint32_t)Width * Height);
+  }
+}
+
+/**
+* @brief  Draws an RGB565 image, line after line.
+* @param  Xpos:  specifies the X position.
+* @param  Ypos:  specifies the Y position.
+* @param  Xsize: image width.
+* @param  Ysize: image height.
+* @param  pdata: pixels, native byte order.
+* @retval None
+*/
+void hx8347d_DrawRGBImage(uint16_t Xpos, uint16_t Ypos, uint16_t Xsize, uint16_t Ysize, uint8_t *pdata)
+{
+  uint32_t size, count, line = 0;
+  
+  if(hx8347d_BeginWrite(Xpos, Ypos, Xsize, Ysize) != 0)
+  {
+    return;
+  }
+  
+  size = (uint32_t)Xsize * Ysize;
+  if(((uintptr_t)pdata & 1U) == 0)
+  {
+    /* Straight from the image */
+    LCD_IO_WriteDataDMA((uint16_t*)pdata, size);
+    LCD_IO_WaitDMA();
+  }
+  else
+  {
+    /* Halfword aligned copies for the DMA */
+    while(size > 0)
+    {
+      count = (size > HX8347D_LCD_PIXEL_WIDTH) ? HX8347D_LCD_PIXEL_WIDTH : size;
+      memcpy(ArrayRGB[line & 1U], pdata, count * 2);
+      LCD_IO_WriteDataDMA(ArrayRGB[line & 1U], count);
+      pdata += count * 2;
+      size -= count;
+      line++;
+    }
+  }
+}
+
+/**
+* @brief  Draws a rectangle rendered line by line, without frame buffer.
+* @param  Xpos:   specifies the X position.
+* @param  Ypos:   specifies the Y position.
+* @param  Width:  rectangle width.
+* @param  Height: rectangle height.
+* @param  Render: renders each line while the previous one is sent.
+* @retval None
+*/
+void hx8347d_DrawRGBSpans(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, LCD_SpanRenderTypeDef Render)
+{
+  uint16_t line;
+  
+  if(hx8347d_BeginWrite(Xpos, Ypos, Width, Height) != 0)
+  {
+    return;
+  }
+  
+  for(line = 0; line < Height; line++)
+  {
+    /* Sent two lines ago: its transfer ended before the last one started */
+    Render(line, ArrayRGB[line & 1U], Width);
+    LCD_IO_WriteDataDMA(ArrayRGB[line & 1U], Width);
+  }
+}
+
+/**
+* @brief  Sets the display window and starts the GRAM write.
+* @param  Xpos:   specifies the X position.
+* @param  Ypos:   specifies the Y position.
+* @param  Width:  window width.
+* @param  Height: window height.
+* @retval 0 if started, 1 if the window is empty or off the screen
+*/
+static uint8_t hx8347d_BeginWrite(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height)
+{
+  if((Width == 0) || (Height == 0) ||
+     (Ypos + Width > HX8347D_LCD_PIXEL_WIDTH) || (Xpos + Height > HX8347D_LCD_PIXEL_HEIGHT))
+  {
+    return 1;
+  }
+  
+  hx8347d_SetDisplayWindow(Xpos, Ypos, Width, Height);
+  WindowSet = 1;
+  
+  /* Prepare to write GRAM */
+  LCD_IO_WriteReg(LCD_REG_34);
+  return 0;
+}
+
 /**
 * @}
 */ 
@@ -237,6 +237,10 @@ uint16_t hx8347d_ReadPixel(uint16_t Xpos, uint16_t Ypos);
 void     hx8347d_DrawHLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16_t Length);
 void     hx8347d_DrawVLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16_t Length);
 void     hx8347d_DrawBitmap(uint16_t Xpos, uint16_t Ypos, uint8_t *pbmp);
+void     hx8347d_DrawRGBImage(uint16_t Xpos, uint16_t Ypos, uint16_t Xsize, uint16_t Ysize, uint8_t *pdata);
+
+void     hx8347d_FillRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, uint16_t RGBCode);
+void     hx8347d_DrawRGBSpans(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, LCD_SpanRenderTypeDef Render);
 
 void     hx8347d_SetDisplayWindow(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height);
 
@@ -253,6 +257,9 @@ void     LCD_IO_WriteMultipleData(uint8_t *pData, uint32_t Size);
 void     LCD_IO_WriteReg(uint8_t Reg);
 uint16_t LCD_IO_ReadData(uint16_t Reg);
 void     LCD_Delay (uint32_t delay);
+void     LCD_IO_WriteDataDMA(uint16_t *pData, uint32_t Count);
+void     LCD_IO_FillDataDMA(uint16_t RGBCode, uint32_t Count);
+void     LCD_IO_WaitDMA(void);
 /**
   * @}
   */ 
@@ -72,9 +72,21 @@ GYRO_DrvTypeDef I3g4250Drv =
   0,
   I3G4250D_FilterConfig,
   I3G4250D_FilterCmd,
-  I3G4250D_ReadXYZAngRate
+#if !defined(GYRO_FIXED_POINT_ONLY)
+  I3G4250D_ReadXYZAngRate,
+#else
+  0,
+#endif
+  I3G4250D_FIFOConfig,
+  I3G4250D_FIFOGetStatus,
+  I3G4250D_ReadXYZAngRateQ16
 };
 
+/* CTRL_REG4 (full scale, endianness) as last written: the output data
+   decoding uses this copy instead of reading the register per sample */
+static uint8_t I3G4250DCtrl4;
+static uint8_t I3G4250DCtrl4Valid;
+
 /**
   * @}
   */
@@ -82,6 +94,8 @@ GYRO_DrvTypeDef I3g4250Drv =
 /** @defgroup I3G4250D_Private_FunctionPrototypes Private Function Prototypes
   * @{
   */
+static uint8_t I3G4250D_GetCtrl4(void);
+static uint8_t I3G4250D_ReadRawData(int16_t *pRawData);
 
 /**
   * @}
@@ -111,6 +125,8 @@ void I3G4250D_Init(uint16_t InitStruct)
   /* Write value to MEMS CTRL_REG4 register */
   ctrl = (uint8_t)(InitStruct >> 8);
   GYRO_IO_Write(&ctrl, I3G4250D_CTRL_REG4_ADDR, 1);
+  I3G4250DCtrl4 = ctrl;
+  I3G4250DCtrl4Valid = 1;
 }
 
 
@@ -152,6 +168,9 @@ void I3G4250D_RebootCmd(void)
 {
   uint8_t tmpreg;
 
+  /* The registers are reloaded: read CTRL_REG4 again next time */
+  I3G4250DCtrl4Valid = 0;
+
   /* Read CTRL_REG5 register */
   GYRO_IO_Read(&tmpreg, I3G4250D_CTRL_REG5_ADDR, 1);
 
@@ -324,6 +343,7 @@ uint8_t I3G4250D_GetDataStatus(void)
   return tmpreg;
 }
 
+#if !defined(GYRO_FIXED_POINT_ONLY)
 /**
 * @brief  Calculate the I3G4250D angular data.
 * @param  pfData: Data out pointer
@@ -331,31 +351,12 @@ uint8_t I3G4250D_GetDataStatus(void)
 */
 void I3G4250D_ReadXYZAngRate(float *pfData)
 {
-  uint8_t tmpbuffer[6] = {0};
   int16_t RawData[3] = {0};
   uint8_t tmpreg = 0;
   float sensitivity = 0;
   int i = 0;
 
-  GYRO_IO_Read(&tmpreg, I3G4250D_CTRL_REG4_ADDR, 1);
-
-  GYRO_IO_Read(tmpbuffer, I3G4250D_OUT_X_L_ADDR, 6);
-
-  /* check in the control register 4 the data alignment (Big Endian or Little Endian)*/
-  if (!(tmpreg & I3G4250D_BLE_MSB))
-  {
-    for (i = 0; i < 3; i++)
-    {
-      RawData[i] = (int16_t)(((uint16_t)tmpbuffer[2 * i + 1] << 8) + tmpbuffer[2 * i]);
-    }
-  }
-  else
-  {
-    for (i = 0; i < 3; i++)
-    {
-      RawData[i] = (int16_t)(((uint16_t)tmpbuffer[2 * i] << 8) + tmpbuffer[2 * i + 1]);
-    }
-  }
+  tmpreg = I3G4250D_ReadRawData(RawData);
 
   /* Switch the sensitivity value set in the CRTL4 */
   switch (tmpreg & I3G4250D_FULLSCALE_SELECTION)
@@ -378,6 +379,147 @@ void I3G4250D_ReadXYZAngRate(float *pfData)
     pfData[i] = (float)(RawData[i] * sensitivity);
   }
 }
+#endif /* GYRO_FIXED_POINT_ONLY */
+
+/**
+  * @brief  Calculate the I3G4250D angular data in Q16.16 dps, without floating
+  *         point.
+  * @param  pData: Data out pointer
+  * @retval None
+  */
+void I3G4250D_ReadXYZAngRateQ16(int32_t *pData)
+{
+  int16_t RawData[3] = {0};
+  uint8_t tmpreg = 0;
+  int i = 0;
+
+  tmpreg = I3G4250D_ReadRawData(RawData);
+
+  /* Multiplied by sensitivity */
+  switch (tmpreg & I3G4250D_FULLSCALE_SELECTION)
+  {
+    case I3G4250D_FULLSCALE_245:
+      for (i = 0; i < 3; i++)
+      {
+        pData[i] = I3G4250D_RAW_TO_Q16(RawData[i], I3G4250D_SENSITIVITY_245DPS_Q16_SHIFT);
+      }
+      break;
+
+    case I3G4250D_FULLSCALE_500:
+      for (i = 0; i < 3; i++)
+      {
+        pData[i] = I3G4250D_RAW_TO_Q16(RawData[i], I3G4250D_SENSITIVITY_500DPS_Q16_SHIFT);
+      }
+      break;
+
+    default:
+      for (i = 0; i < 3; i++)
+      {
+        pData[i] = I3G4250D_RAW_TO_Q16(RawData[i], I3G4250D_SENSITIVITY_2000DPS_Q16_SHIFT);
+      }
+      break;
+  }
+}
+
+/**
+  * @brief  Configures the FIFO and its signals on INT2.
+  * @note   Going through bypass mode first empties the FIFO.
+  * @param  FIFOConfig: FIFO_CTRL_REG value (I3G4250D_FIFO_MODE_xxx and watermark
+  *         level) in the low byte, INT2 signals (I3G4250D_INT2_FIFO_xxx) in the
+  *         high byte.
+  * @retval None
+  */
+void I3G4250D_FIFOConfig(uint16_t FIFOConfig)
+{
+  uint8_t tmpreg;
+  uint8_t ctrl = 0x00;
+
+  /* Reset the FIFO content */
+  GYRO_IO_Write(&ctrl, I3G4250D_FIFO_CTRL_REG_ADDR, 1);
+
+  /* Enable the FIFO unless in bypass mode */
+  GYRO_IO_Read(&tmpreg, I3G4250D_CTRL_REG5_ADDR, 1);
+  tmpreg &= (uint8_t)~I3G4250D_FIFO_ENABLE;
+  if ((FIFOConfig & 0xE0) != I3G4250D_FIFO_MODE_BYPASS)
+  {
+    tmpreg |= I3G4250D_FIFO_ENABLE;
+  }
+  GYRO_IO_Write(&tmpreg, I3G4250D_CTRL_REG5_ADDR, 1);
+
+  /* Write value to MEMS FIFO_CTRL_REG register */
+  ctrl = (uint8_t)FIFOConfig;
+  GYRO_IO_Write(&ctrl, I3G4250D_FIFO_CTRL_REG_ADDR, 1);
+
+  /* Watermark, overrun and empty signals on INT2, data ready is left as is */
+  GYRO_IO_Read(&tmpreg, I3G4250D_CTRL_REG3_ADDR, 1);
+  tmpreg &= 0xF8;
+  tmpreg |= (uint8_t)((FIFOConfig >> 8) & 0x07);
+  GYRO_IO_Write(&tmpreg, I3G4250D_CTRL_REG3_ADDR, 1);
+}
+
+/**
+  * @brief  Get the FIFO status.
+  * @param  None
+  * @retval FIFO_SRC_REG: I3G4250D_FIFO_SRC_xxx flags and stored samples level
+  */
+uint8_t I3G4250D_FIFOGetStatus(void)
+{
+  uint8_t tmpreg;
+
+  /* Read FIFO_SRC_REG register */
+  GYRO_IO_Read(&tmpreg, I3G4250D_FIFO_SRC_REG_ADDR, 1);
+
+  return tmpreg;
+}
+
+/**
+  * @brief  Get CTRL_REG4, from the copy kept since the last write.
+  * @param  None
+  * @retval CTRL_REG4 value
+  */
+static uint8_t I3G4250D_GetCtrl4(void)
+{
+  if (I3G4250DCtrl4Valid == 0)
+  {
+    GYRO_IO_Read(&I3G4250DCtrl4, I3G4250D_CTRL_REG4_ADDR, 1);
+    I3G4250DCtrl4Valid = 1;
+  }
+  return I3G4250DCtrl4;
+}
+
+/**
+  * @brief  Read the X, Y, Z raw output data.
+  * @param  pRawData: Data out pointer
+  * @retval CTRL_REG4 value the data were decoded with
+  */
+static uint8_t I3G4250D_ReadRawData(int16_t *pRawData)
+{
+  uint8_t tmpbuffer[6] = {0};
+  uint8_t tmpreg = 0;
+  int i = 0;
+
+  tmpreg = I3G4250D_GetCtrl4();
+
+  GYRO_IO_Read(tmpbuffer, I3G4250D_OUT_X_L_ADDR, 6);
+
+  /* check in the control register 4 the data alignment (Big Endian or Little Endian)*/
+  if (!(tmpreg & I3G4250D_BLE_MSB))
+  {
+    for (i = 0; i < 3; i++)
+    {
+      pRawData[i] = (int16_t)(((uint16_t)tmpbuffer[2 * i + 1] << 8) + tmpbuffer[2 * i]);
+    }
+  }
+  else
+  {
+    for (i = 0; i < 3; i++)
+    {
+      pRawData[i] = (int16_t)(((uint16_t)tmpbuffer[2 * i] << 8) + tmpbuffer[2 * i + 1]);
+    }
+  }
+
+  return tmpreg;
+}
 
 /**
   * @}
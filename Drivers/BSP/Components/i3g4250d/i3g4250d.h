@@ -141,6 +141,16 @@ extern "C" {
 #define I3G4250D_SENSITIVITY_245DPS  ((float)8.75f)         /*!< gyroscope sensitivity with 250 dps full scale [DPS/LSB]  */
 #define I3G4250D_SENSITIVITY_500DPS  ((float)17.50f)        /*!< gyroscope sensitivity with 500 dps full scale [DPS/LSB]  */
 #define I3G4250D_SENSITIVITY_2000DPS ((float)70.00f)        /*!< gyroscope sensitivity with 2000 dps full scale [DPS/LSB] */
+
+/* Sensitivity for Q16.16 dps output without floating point:
+   I3G4250D_RAW_TO_Q16(raw, I3G4250D_SENSITIVITY_xxxDPS_Q16_SHIFT). 18350 is the
+   245 dps sensitivity, 8.75 mdps/LSB, in Q16.16 dps times 2^5 (relative
+   error 4.4e-6); the 500 and 2000 dps ones are 2 and 8 times as large. */
+#define I3G4250D_SENSITIVITY_Q16                 18350
+#define I3G4250D_SENSITIVITY_245DPS_Q16_SHIFT     5
+#define I3G4250D_SENSITIVITY_500DPS_Q16_SHIFT     4
+#define I3G4250D_SENSITIVITY_2000DPS_Q16_SHIFT    2
+#define I3G4250D_RAW_TO_Q16(raw, shift)  ((((int32_t)(raw) * I3G4250D_SENSITIVITY_Q16) + (1 << ((shift) - 1))) >> (shift))
 /**
   * @}
   */
@@ -246,6 +256,42 @@ extern "C" {
   * @}
   */
 
+/** @defgroup FIFO_Mode_Selection FIFO Mode Selection
+  * @{
+  */
+#define I3G4250D_FIFO_MODE_BYPASS            ((uint8_t)0x00)
+#define I3G4250D_FIFO_MODE_FIFO              ((uint8_t)0x20)
+#define I3G4250D_FIFO_MODE_STREAM            ((uint8_t)0x40)
+#define I3G4250D_FIFO_MODE_STREAM_TO_FIFO    ((uint8_t)0x60)
+#define I3G4250D_FIFO_MODE_BYPASS_TO_STREAM  ((uint8_t)0x80)
+#define I3G4250D_FIFO_WATERMARK              ((uint8_t)0x1F)
+#define I3G4250D_FIFO_DEPTH                  32          /* Samples (X, Y, Z) */
+#define I3G4250D_FIFO_ENABLE                 ((uint8_t)0x40)   /* CTRL_REG5 FIFO_EN */
+/**
+  * @}
+  */
+
+/** @defgroup FIFO_INT2_Signals FIFO INT2 Signals
+  * @{
+  */
+#define I3G4250D_INT2_FIFO_WTM               ((uint8_t)0x04)
+#define I3G4250D_INT2_FIFO_OVERRUN           ((uint8_t)0x02)
+#define I3G4250D_INT2_FIFO_EMPTY             ((uint8_t)0x01)
+/**
+  * @}
+  */
+
+/** @defgroup FIFO_Source_Register FIFO Source Register
+  * @{
+  */
+#define I3G4250D_FIFO_SRC_WTM                ((uint8_t)0x80)
+#define I3G4250D_FIFO_SRC_OVERRUN            ((uint8_t)0x40)   /* 32 samples stored */
+#define I3G4250D_FIFO_SRC_EMPTY              ((uint8_t)0x20)
+#define I3G4250D_FIFO_SRC_LEVEL              ((uint8_t)0x1F)
+/**
+  * @}
+  */
+
 /**
   * @}
   */
@@ -268,8 +314,13 @@ void    I3G4250D_DisableIT(uint8_t IntSel);
 void    I3G4250D_FilterConfig(uint8_t FilterStruct);
 void    I3G4250D_FilterCmd(uint8_t HighPassFilterState);
 void    I3G4250D_ReadXYZAngRate(float *pfData);
+void    I3G4250D_ReadXYZAngRateQ16(int32_t *pData);
 uint8_t I3G4250D_GetDataStatus(void);
 
+/* FIFO Functions */
+void    I3G4250D_FIFOConfig(uint16_t FIFOConfig);
+uint8_t I3G4250D_FIFOGetStatus(void);
+
 /* Gyroscope IO functions */
 void    GYRO_IO_Init(void);
 void    GYRO_IO_DeInit(void);
@@ -91,9 +91,21 @@ GYRO_DrvTypeDef L3gd20Drv =
   0,
   L3GD20_FilterConfig,
   L3GD20_FilterCmd,
-  L3GD20_ReadXYZAngRate
+#if !defined(GYRO_FIXED_POINT_ONLY)
+  L3GD20_ReadXYZAngRate,
+#else
+  0,
+#endif
+  L3GD20_FIFOConfig,
+  L3GD20_FIFOGetStatus,
+  L3GD20_ReadXYZAngRateQ16
 };
 
+/* CTRL_REG4 (full scale, endianness) as last written: the output data
+   decoding uses this copy instead of reading the register per sample */
+static uint8_t L3GD20Ctrl4;
+static uint8_t L3GD20Ctrl4Valid;
+
 /**
   * @}
   */
@@ -101,6 +113,8 @@ GYRO_DrvTypeDef L3gd20Drv =
 /** @defgroup L3GD20_Private_FunctionPrototypes
   * @{
   */
+static uint8_t L3GD20_GetCtrl4(void);
+static uint8_t L3GD20_ReadRawData(int16_t *pRawData);
 
 /**
   * @}
@@ -130,6 +144,8 @@ void L3GD20_Init(uint16_t InitStruct)
   /* Write value to MEMS CTRL_REG4 register */  
   ctrl = (uint8_t) (InitStruct >> 8);
   GYRO_IO_Write(&ctrl, L3GD20_CTRL_REG4_ADDR, 1);
+  L3GD20Ctrl4 = ctrl;
+  L3GD20Ctrl4Valid = 1;
 }
 
 
@@ -170,6 +186,9 @@ uint8_t L3GD20_ReadID(void)
 void L3GD20_RebootCmd(void)
 {
   uint8_t tmpreg;
+
+  /* The registers are reloaded: read CTRL_REG4 again next time */
+  L3GD20Ctrl4Valid = 0;
   
   /* Read CTRL_REG5 register */
   GYRO_IO_Read(&tmpreg, L3GD20_CTRL_REG5_ADDR, 1);
@@ -342,6 +361,7 @@ uint8_t L3GD20_GetDataStatus(void)
   return tmpreg;
 }
 
+#if !defined(GYRO_FIXED_POINT_ONLY)
 /**
 * @brief  Calculate the L3GD20 angular data.
 * @param  pfData: Data out pointer
@@ -349,32 +369,13 @@ uint8_t L3GD20_GetDataStatus(void)
 */
 void L3GD20_ReadXYZAngRate(float *pfData)
 {
-  uint8_t tmpbuffer[6] ={0};
   int16_t RawData[3] = {0};
   uint8_t tmpreg = 0;
   float sensitivity = 0;
-  int i =0;
-  
-  GYRO_IO_Read(&tmpreg,L3GD20_CTRL_REG4_ADDR,1);
-  
-  GYRO_IO_Read(tmpbuffer,L3GD20_OUT_X_L_ADDR,6);
-  
-  /* check in the control register 4 the data alignment (Big Endian or Little Endian)*/
-  if(!(tmpreg & L3GD20_BLE_MSB))
-  {
-    for(i=0; i<3; i++)
-    {
-      RawData[i]=(int16_t)(((uint16_t)tmpbuffer[2*i+1] << 8) + tmpbuffer[2*i]);
-    }
-  }
-  else
-  {
-    for(i=0; i<3; i++)
-    {
-      RawData[i]=(int16_t)(((uint16_t)tmpbuffer[2*i] << 8) + tmpbuffer[2*i+1]);
-    }
-  }
-  
+  int i = 0;
+
+  tmpreg = L3GD20_ReadRawData(RawData);
+
   /* Switch the sensitivity value set in the CRTL4 */
   switch(tmpreg & L3GD20_FULLSCALE_SELECTION)
   {
@@ -396,6 +397,147 @@ void L3GD20_ReadXYZAngRate(float *pfData)
     pfData[i]=(float)(RawData[i] * sensitivity);
   }
 }
+#endif /* GYRO_FIXED_POINT_ONLY */
+
+/**
+  * @brief  Calculate the L3GD20 angular data in Q16.16 dps, without floating
+  *         point.
+  * @param  pData: Data out pointer
+  * @retval None
+  */
+void L3GD20_ReadXYZAngRateQ16(int32_t *pData)
+{
+  int16_t RawData[3] = {0};
+  uint8_t tmpreg = 0;
+  int i = 0;
+
+  tmpreg = L3GD20_ReadRawData(RawData);
+
+  /* Multiplied by sensitivity */
+  switch(tmpreg & L3GD20_FULLSCALE_SELECTION)
+  {
+  case L3GD20_FULLSCALE_250:
+    for (i = 0; i < 3; i++)
+    {
+      pData[i] = L3GD20_RAW_TO_Q16(RawData[i], L3GD20_SENSITIVITY_250DPS_Q16_SHIFT);
+    }
+    break;
+
+  case L3GD20_FULLSCALE_500:
+    for (i = 0; i < 3; i++)
+    {
+      pData[i] = L3GD20_RAW_TO_Q16(RawData[i], L3GD20_SENSITIVITY_500DPS_Q16_SHIFT);
+    }
+    break;
+
+  default:
+    for (i = 0; i < 3; i++)
+    {
+      pData[i] = L3GD20_RAW_TO_Q16(RawData[i], L3GD20_SENSITIVITY_2000DPS_Q16_SHIFT);
+    }
+    break;
+  }
+}
+
+/**
+  * @brief  Configures the FIFO and its signals on INT2.
+  * @note   Going through bypass mode first empties the FIFO.
+  * @param  FIFOConfig: FIFO_CTRL_REG value (L3GD20_FIFO_MODE_xxx and watermark
+  *         level) in the low byte, INT2 signals (L3GD20_INT2_FIFO_xxx) in the
+  *         high byte.
+  * @retval None
+  */
+void L3GD20_FIFOConfig(uint16_t FIFOConfig)
+{
+  uint8_t tmpreg;
+  uint8_t ctrl = 0x00;
+
+  /* Reset the FIFO content */
+  GYRO_IO_Write(&ctrl, L3GD20_FIFO_CTRL_REG_ADDR, 1);
+
+  /* Enable the FIFO unless in bypass mode */
+  GYRO_IO_Read(&tmpreg, L3GD20_CTRL_REG5_ADDR, 1);
+  tmpreg &= (uint8_t)~L3GD20_FIFO_ENABLE;
+  if ((FIFOConfig & 0xE0) != L3GD20_FIFO_MODE_BYPASS)
+  {
+    tmpreg |= L3GD20_FIFO_ENABLE;
+  }
+  GYRO_IO_Write(&tmpreg, L3GD20_CTRL_REG5_ADDR, 1);
+
+  /* Write value to MEMS FIFO_CTRL_REG register */
+  ctrl = (uint8_t)FIFOConfig;
+  GYRO_IO_Write(&ctrl, L3GD20_FIFO_CTRL_REG_ADDR, 1);
+
+  /* Watermark, overrun and empty signals on INT2, data ready is left as is */
+  GYRO_IO_Read(&tmpreg, L3GD20_CTRL_REG3_ADDR, 1);
+  tmpreg &= 0xF8;
+  tmpreg |= (uint8_t)((FIFOConfig >> 8) & 0x07);
+  GYRO_IO_Write(&tmpreg, L3GD20_CTRL_REG3_ADDR, 1);
+}
+
+/**
+  * @brief  Get the FIFO status.
+  * @param  None
+  * @retval FIFO_SRC_REG: L3GD20_FIFO_SRC_xxx flags and stored samples level
+  */
+uint8_t L3GD20_FIFOGetStatus(void)
+{
+  uint8_t tmpreg;
+
+  /* Read FIFO_SRC_REG register */
+  GYRO_IO_Read(&tmpreg, L3GD20_FIFO_SRC_REG_ADDR, 1);
+
+  return tmpreg;
+}
+
+/**
+  * @brief  Get CTRL_REG4, from the copy kept since the last write.
+  * @param  None
+  * @retval CTRL_REG4 value
+  */
+static uint8_t L3GD20_GetCtrl4(void)
+{
+  if (L3GD20Ctrl4Valid == 0)
+  {
+    GYRO_IO_Read(&L3GD20Ctrl4, L3GD20_CTRL_REG4_ADDR, 1);
+    L3GD20Ctrl4Valid = 1;
+  }
+  return L3GD20Ctrl4;
+}
+
+/**
+  * @brief  Read the X, Y, Z raw output data.
+  * @param  pRawData: Data out pointer
+  * @retval CTRL_REG4 value the data were decoded with
+  */
+static uint8_t L3GD20_ReadRawData(int16_t *pRawData)
+{
+  uint8_t tmpbuffer[6] ={0};
+  uint8_t tmpreg = 0;
+  int i =0;
+  
+  tmpreg = L3GD20_GetCtrl4();
+  
+  GYRO_IO_Read(tmpbuffer,L3GD20_OUT_X_L_ADDR,6);
+  
+  /* check in the control register 4 the data alignment (Big Endian or Little Endian)*/
+  if(!(tmpreg & L3GD20_BLE_MSB))
+  {
+    for(i=0; i<3; i++)
+    {
+      pRawData[i]=(int16_t)(((uint16_t)tmpbuffer[2*i+1] << 8) + tmpbuffer[2*i]);
+    }
+  }
+  else
+  {
+    for(i=0; i<3; i++)
+    {
+      pRawData[i]=(int16_t)(((uint16_t)tmpbuffer[2*i] << 8) + tmpbuffer[2*i+1]);
+    }
+  }
+
+  return tmpreg;
+}
 
 /**
   * @}
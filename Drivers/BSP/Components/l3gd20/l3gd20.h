@@ -161,6 +161,16 @@
 #define L3GD20_SENSITIVITY_250DPS  ((float)8.75f)         /*!< gyroscope sensitivity with 250 dps full scale [DPS/LSB]  */
 #define L3GD20_SENSITIVITY_500DPS  ((float)17.50f)        /*!< gyroscope sensitivity with 500 dps full scale [DPS/LSB]  */
 #define L3GD20_SENSITIVITY_2000DPS ((float)70.00f)        /*!< gyroscope sensitivity with 2000 dps full scale [DPS/LSB] */
+
+/* Sensitivity for Q16.16 dps output without floating point:
+   L3GD20_RAW_TO_Q16(raw, L3GD20_SENSITIVITY_xxxDPS_Q16_SHIFT). 18350 is the
+   250 dps sensitivity, 8.75 mdps/LSB, in Q16.16 dps times 2^5 (relative
+   error 4.4e-6); the 500 and 2000 dps ones are 2 and 8 times as large. */
+#define L3GD20_SENSITIVITY_Q16                 18350
+#define L3GD20_SENSITIVITY_250DPS_Q16_SHIFT     5
+#define L3GD20_SENSITIVITY_500DPS_Q16_SHIFT     4
+#define L3GD20_SENSITIVITY_2000DPS_Q16_SHIFT    2
+#define L3GD20_RAW_TO_Q16(raw, shift)  ((((int32_t)(raw) * L3GD20_SENSITIVITY_Q16) + (1 << ((shift) - 1))) >> (shift))
 /**
   * @}
   */
@@ -266,6 +276,42 @@
   * @}
   */
 
+/** @defgroup FIFO_Mode_Selection 
+  * @{
+  */
+#define L3GD20_FIFO_MODE_BYPASS            ((uint8_t)0x00)
+#define L3GD20_FIFO_MODE_FIFO              ((uint8_t)0x20)
+#define L3GD20_FIFO_MODE_STREAM            ((uint8_t)0x40)
+#define L3GD20_FIFO_MODE_STREAM_TO_FIFO    ((uint8_t)0x60)
+#define L3GD20_FIFO_MODE_BYPASS_TO_STREAM  ((uint8_t)0x80)
+#define L3GD20_FIFO_WATERMARK              ((uint8_t)0x1F)
+#define L3GD20_FIFO_DEPTH                  32          /* Samples (X, Y, Z) */
+#define L3GD20_FIFO_ENABLE                 ((uint8_t)0x40)   /* CTRL_REG5 FIFO_EN */
+/**
+  * @}
+  */
+
+/** @defgroup FIFO_INT2_Signals
+  * @{
+  */
+#define L3GD20_INT2_FIFO_WTM               ((uint8_t)0x04)
+#define L3GD20_INT2_FIFO_OVERRUN           ((uint8_t)0x02)
+#define L3GD20_INT2_FIFO_EMPTY             ((uint8_t)0x01)
+/**
+  * @}
+  */
+
+/** @defgroup FIFO_Source_Register
+  * @{
+  */
+#define L3GD20_FIFO_SRC_WTM                ((uint8_t)0x80)
+#define L3GD20_FIFO_SRC_OVERRUN            ((uint8_t)0x40)   /* 32 samples stored */
+#define L3GD20_FIFO_SRC_EMPTY              ((uint8_t)0x20)
+#define L3GD20_FIFO_SRC_LEVEL              ((uint8_t)0x1F)
+/**
+  * @}
+  */
+
 /**
   * @}
   */
@@ -288,8 +334,13 @@ void    L3GD20_DisableIT(uint8_t IntSel);
 void    L3GD20_FilterConfig(uint8_t FilterStruct);
 void    L3GD20_FilterCmd(uint8_t HighPassFilterState);
 void    L3GD20_ReadXYZAngRate(float *pfData);
+void    L3GD20_ReadXYZAngRateQ16(int32_t *pData);
 uint8_t L3GD20_GetDataStatus(void);
 
+/* FIFO Functions */
+void    L3GD20_FIFOConfig(uint16_t FIFOConfig);
+uint8_t L3GD20_FIFOGetStatus(void);
+
 /* Gyroscope IO functions */
 void    GYRO_IO_Init(void);
 void    GYRO_IO_DeInit(void);
@@ -6,6 +6,20 @@
   * @date    24-November-2014
   * @brief   This file includes the driver for ST7735 LCD mounted on the Adafruit
   *          1.8" TFT LCD shield (reference ID 802).
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - The bulk operations (st7735_FillRect(), st7735_DrawRGBImage(),
+  *             st7735_DrawRGBSpans(), and the lines and bitmaps drawn with
+  *             them) set the display window once and stream the pixels with
+  *             LCD_IO_FillDataDMA() or LCD_IO_WriteDataDMA(). They return
+  *             with the last transfer in progress, except
+  *             st7735_DrawRGBImage(), which waits so that the caller can
+  *             reuse the image buffer.
+  *           - st7735_DrawRGBSpans() renders each line into one of the two
+  *             line buffers while the other is sent.
+  *           - The next st7735_SetCursor() restores the full screen window.
+  *          ===================================================================
   ******************************************************************************
   * @attention
   *
@@ -38,6 +52,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "st7735.h"
+#include <string.h>
 
 /** @addtogroup BSP
   * @{
@@ -97,9 +112,15 @@ LCD_DrvTypeDef   st7735_drv =
   st7735_GetLcdPixelWidth,
   st7735_GetLcdPixelHeight,
   st7735_DrawBitmap,
+  st7735_DrawRGBImage,
+  st7735_FillRect,
+  st7735_DrawRGBSpans,
 };
 
-static uint16_t ArrayRGB[320] = {0};
+/* Line buffers: one is filled while the other is sent */
+static uint16_t ArrayRGB[2][ST7735_LCD_PIXEL_WIDTH];
+/* A bulk operation left a window smaller than the screen */
+static uint8_t  WindowSet = 0;
 
 /**
 * @}
@@ -108,6 +129,7 @@ static uint16_t ArrayRGB[320] = {0};
 /** @defgroup ST7735_Private_FunctionPrototypes
   * @{
   */
+static void st7735_BeginWrite(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height);
 
 /**
 * @}
@@ -273,6 +295,13 @@ void st7735_DisplayOff(void)
 void st7735_SetCursor(uint16_t Xpos, uint16_t Ypos)
 {
   uint8_t data = 0;
+
+  if(WindowSet != 0)
+  {
+    /* The column and row ends are only set by the window */
+    st7735_SetDisplayWindow(0, 0, ST7735_LCD_PIXEL_WIDTH, ST7735_LCD_PIXEL_HEIGHT);
+    WindowSet = 0;
+  }
   LCD_IO_WriteReg(LCD_REG_42);
   data = (Xpos) >> 8;
   LCD_IO_WriteMultipleData(&data, 1);
@@ -366,18 +395,9 @@ void st7735_SetDisplayWindow(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint1
   */
 void st7735_DrawHLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16_t Length)
 {
-  uint8_t counter = 0;
-  
   if(Xpos + Length > ST7735_LCD_PIXEL_WIDTH) return;
   
-  /* Set Cursor */
-  st7735_SetCursor(Xpos, Ypos);
-  
-  for(counter = 0; counter < Length; counter++)
-  {
-    ArrayRGB[counter] = RGBCode;
-  }
-  LCD_IO_WriteMultipleData((uint8_t*)&ArrayRGB[0], Length * 2);
+  st7735_FillRect(Xpos, Ypos, Length, 1, RGBCode);
 }
 
 /**
@@ -390,13 +410,9 @@ void st7735_DrawHLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16_t L
   */
 void st7735_DrawVLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16_t Length)
 {
-  uint8_t counter = 0;
-  
   if(Ypos + Length > ST7735_LCD_PIXEL_HEIGHT) return;
-  for(counter = 0; counter < Length; counter++)
-  {
-    st7735_WritePixel(Xpos, Ypos + counter, RGBCode);
-  }   
+  
+  st7735_FillRect(Xpos, Ypos, 1, Length, RGBCode);
 }
 
 /**
@@ -444,13 +460,127 @@ void st7735_DrawBitmap(uint16_t Xpos, uint16_t Ypos, uint8_t *pbmp)
   /* Set Cursor */
   st7735_SetCursor(Xpos, Ypos);  
  
-  LCD_IO_WriteMultipleData((uint8_t*)pbmp, size*2);
+  if(((uintptr_t)pbmp & 1U) == 0)
+  {
+    /* Restoring the access control waits for the end of the transfer */
+    LCD_IO_WriteDataDMA((uint16_t*)pbmp, size);
+  }
+  else
+  {
+    LCD_IO_WriteMultipleData((uint8_t*)pbmp, size*2);
+  }
  
   /* Set GRAM write direction and BGR = 0 */
   /* Memory access control: MY = 1, MX = 1, MV = 0, ML = 0 */
   st7735_WriteReg(LCD_REG_54, 0xC0);
 }
 
+/**
+  * @brief  Fills a rectangle with one color.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @param  Width: rectangle width.
+  * @param  Height: rectangle height.
+  * @param  RGBCode: the RGB color.
+  * @retval None
+  */
+void st7735_FillRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, uint16_t RGBCode)
+{
+  if((Width == 0) || (Height == 0) ||
+     (Xpos + Width > ST7735_LCD_PIXEL_WIDTH) || (Ypos + Height > ST7735_LCD_PIXEL_HEIGHT))
+  {
+    return;
+  }
+  
+  st7735_BeginWrite(Xpos, Ypos, Width, Height);
+  LCD_IO_FillDataDMA(RGBCode, (uint32_t)Width * Height);
+}
+
+/**
+  * @brief  Draws an RGB565 image, line after line.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @param  Xsize: image width.
+  * @param  Ysize: image height.
+  * @param  pdata: pixels, native byte order.
+  * @retval None
+  */
+void st7735_DrawRGBImage(uint16_t Xpos, uint16_t Ypos, uint16_t Xsize, uint16_t Ysize, uint8_t *pdata)
+{
+  uint32_t size, count, line = 0;
+  
+  if((Xsize == 0) || (Ysize == 0) ||
+     (Xpos + Xsize > ST7735_LCD_PIXEL_WIDTH) || (Ypos + Ysize > ST7735_LCD_PIXEL_HEIGHT))
+  {
+    return;
+  }
+  
+  st7735_BeginWrite(Xpos, Ypos, Xsize, Ysize);
+  size = (uint32_t)Xsize * Ysize;
+  if(((uintptr_t)pdata & 1U) == 0)
+  {
+    /* Straight from the image */
+    LCD_IO_WriteDataDMA((uint16_t*)pdata, size);
+    LCD_IO_WaitDMA();
+  }
+  else
+  {
+    /* Halfword aligned copies for the DMA */
+    while(size > 0)
+    {
+      count = (size > ST7735_LCD_PIXEL_WIDTH) ? ST7735_LCD_PIXEL_WIDTH : size;
+      memcpy(ArrayRGB[line & 1U], pdata, count * 2);
+      LCD_IO_WriteDataDMA(ArrayRGB[line & 1U], count);
+      pdata += count * 2;
+      size -= count;
+      line++;
+    }
+  }
+}
+
+/**
+  * @brief  Draws a rectangle rendered line by line, without frame buffer.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @param  Width: rectangle width.
+  * @param  Height: rectangle height.
+  * @param  Render: renders each line while the previous one is sent.
+  * @retval None
+  */
+void st7735_DrawRGBSpans(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, LCD_SpanRenderTypeDef Render)
+{
+  uint16_t line;
+  
+  if((Width == 0) || (Height == 0) ||
+     (Xpos + Width > ST7735_LCD_PIXEL_WIDTH) || (Ypos + Height > ST7735_LCD_PIXEL_HEIGHT))
+  {
+    return;
+  }
+  
+  st7735_BeginWrite(Xpos, Ypos, Width, Height);
+  for(line = 0; line < Height; line++)
+  {
+    /* Sent two lines ago: its transfer ended before the last one started */
+    Render(line, ArrayRGB[line & 1U], Width);
+    LCD_IO_WriteDataDMA(ArrayRGB[line & 1U], Width);
+  }
+}
+
+/**
+  * @brief  Sets the display window and starts the memory write.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @param  Width: window width.
+  * @param  Height: window height.
+  * @retval None
+  */
+static void st7735_BeginWrite(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height)
+{
+  st7735_SetDisplayWindow(Xpos, Ypos, Width, Height);
+  WindowSet = 1;
+  LCD_IO_WriteReg(LCD_REG_44);
+}
+
 /**
 * @}
 */ 
@@ -180,6 +180,10 @@ void     st7735_DrawVLine(uint16_t RGBCode, uint16_t Xpos, uint16_t Ypos, uint16
 uint16_t st7735_GetLcdPixelWidth(void);
 uint16_t st7735_GetLcdPixelHeight(void);
 void     st7735_DrawBitmap(uint16_t Xpos, uint16_t Ypos, uint8_t *pbmp);
+void     st7735_DrawRGBImage(uint16_t Xpos, uint16_t Ypos, uint16_t Xsize, uint16_t Ysize, uint8_t *pdata);
+
+void     st7735_FillRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, uint16_t RGBCode);
+void     st7735_DrawRGBSpans(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, LCD_SpanRenderTypeDef Render);
 
 /* LCD driver structure */
 extern LCD_DrvTypeDef   st7735_drv;
@@ -189,6 +193,9 @@ void     LCD_IO_Init(void);
 void     LCD_IO_WriteMultipleData(uint8_t *pData, uint32_t Size);
 void     LCD_IO_WriteReg(uint8_t Reg);
 void     LCD_Delay(uint32_t delay);
+void     LCD_IO_WriteDataDMA(uint16_t *pData, uint32_t Count);
+void     LCD_IO_FillDataDMA(uint16_t RGBCode, uint32_t Count);
+void     LCD_IO_WaitDMA(void);
 /**
   * @}
   */
@@ -114,19 +114,19 @@ TSENSOR_DrvTypeDef Stlm75Drv =
 void STLM75_Init(uint16_t DeviceAddr, TSENSOR_InitTypeDef *pInitStruct)
 {  
   uint8_t confreg = 0;
-  uint16_t tempreg = 0;
+  uint8_t tempreg[2] = {0, 0};
 
   /* Set the Configuration Register */
   confreg = (uint8_t)(pInitStruct->AlertMode | pInitStruct->ConversionMode);
   TSENSOR_IO_Write(DeviceAddr, &confreg, LM75_REG_CONF, 1);
 
   /* Set the Temperature Registers */
-  /* Keep the sign bit and shift the temperature value (as given value is integer, the 0.5 digit is not set) */
-  tempreg = (((pInitStruct->TemperatureLimitHigh & 0x007F) << 8) | (pInitStruct->TemperatureLimitHigh & 0x8000));
-  TSENSOR_IO_Write(DeviceAddr, (uint8_t*)(&tempreg), LM75_REG_TOS, 2);
+  /* MSB first: the limit in degrees C, two's complement (as given value is integer, the 0.5 digit of the LSB is not set) */
+  tempreg[0] = pInitStruct->TemperatureLimitHigh;
+  TSENSOR_IO_Write(DeviceAddr, tempreg, LM75_REG_TOS, 2);
 
-  tempreg = (((pInitStruct->TemperatureLimitLow & 0x007F) << 8) | (pInitStruct->TemperatureLimitLow & 0x8000));
-  TSENSOR_IO_Write(DeviceAddr, (uint8_t*)(&tempreg), LM75_REG_THYS, 2);
+  tempreg[0] = pInitStruct->TemperatureLimitLow;
+  TSENSOR_IO_Write(DeviceAddr, tempreg, LM75_REG_THYS, 2);
 }
 
 /**
@@ -96,6 +96,19 @@
   * @}
   */
 
+/** @defgroup Fault_Queue 
+  * @brief    Consecutive conversions out of the limits before the OS output
+  *           changes, to be OR'ed with the operation mode
+  * @{
+  */
+#define STLM75_FAULT_QUEUE_1                    ((uint8_t)0x00)
+#define STLM75_FAULT_QUEUE_2                    ((uint8_t)0x08)
+#define STLM75_FAULT_QUEUE_4                    ((uint8_t)0x10)
+#define STLM75_FAULT_QUEUE_6                    ((uint8_t)0x18)
+/**
+  * @}
+  */
+
 /**
   * @}
   */
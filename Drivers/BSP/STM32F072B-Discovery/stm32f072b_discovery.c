@@ -19,6 +19,8 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f072b_discovery.h"
+#include "stm32f072b_discovery_i2c.h"
+#include <string.h>
 
 /** @addtogroup BSP
   * @{
@@ -81,7 +83,26 @@ I2C_HandleTypeDef I2cHandle;
 
 #if defined(HAL_SPI_MODULE_ENABLED)
 uint32_t SpixTimeout = SPIx_TIMEOUT_MAX;    /*<! Value of Timeout when SPI communication fails */
-static SPI_HandleTypeDef SpiHandle;
+SPI_HandleTypeDef SpiHandle;
+SPI_HandleTypeDef LcdSpiHandle;
+static __IO uint8_t LcdDmaBusy = 0;         /*<! LCD DMA transfer in progress */
+static uint16_t LcdFillColor;               /*<! Source of the fill transfers */
+#endif
+
+#if defined(HAL_ADC_MODULE_ENABLED) && defined(HAL_TIM_MODULE_ENABLED)
+ADC_HandleTypeDef AdcHandle;
+static TIM_HandleTypeDef AdcTimHandle;      /*<! TIM3, trigger of the conversions */
+static uint32_t AdcDmaLength;               /*<! Samples of the circular buffer */
+#endif
+
+#if defined(HAL_DAC_MODULE_ENABLED) && defined(HAL_TIM_MODULE_ENABLED)
+DAC_HandleTypeDef DacHandle;
+static TIM_HandleTypeDef DacTimHandle;      /*<! TIM6, trigger of the updates */
+static uint32_t DacDmaLength;               /*<! Samples of the circular buffer */
+#endif
+
+#if defined(HAL_UART_MODULE_ENABLED)
+UART_HandleTypeDef UartHandle;
 #endif
 
 /**
@@ -95,19 +116,21 @@ static SPI_HandleTypeDef SpiHandle;
 #if defined(HAL_I2C_MODULE_ENABLED)
 /* I2Cx bus function */
 static void     I2Cx_Init(void);
-static uint32_t I2Cx_WriteData(uint8_t Addr, uint16_t Reg, uint8_t Value);
-static uint32_t I2Cx_WriteBuffer(uint8_t Addr, uint16_t Reg,  uint8_t *pBuffer, uint16_t Length);
-static uint32_t I2Cx_ReadData(uint8_t Addr, uint16_t Reg, uint8_t *Value);
-static uint32_t I2Cx_ReadBuffer(uint8_t Addr, uint16_t Reg, uint8_t *pBuffer, uint16_t Length);
-static void     I2Cx_Error(uint8_t Addr);
+static void     I2Cx_Error(void);
 #endif /* HAL_I2C_MODULE_ENABLED */
 
 #if defined(HAL_SPI_MODULE_ENABLED)
 /* SPIx bus function */
 static void     SPIx_Init(void);
 static uint8_t  SPIx_WriteRead(uint8_t byte);
+static void     SPIx_Read(uint8_t* pBuffer, uint16_t Length);
 static void     SPIx_Error (void);
 static void     SPIx_MspInit(SPI_HandleTypeDef *hspi);
+static void     LCD_SPIx_Init(void);
+static void     LCD_SPIx_Write(uint8_t* pData, uint32_t Size, uint32_t DataSize);
+static void     LCD_SPIx_StartDMA(uint16_t* pData, uint32_t Count, uint32_t MemInc);
+static void     LCD_SPIx_Error(void);
+static void     LCD_SPIx_MspInit(SPI_HandleTypeDef *hspi);
 
 /**
   * @}
@@ -121,6 +144,21 @@ static void     SPIx_MspInit(SPI_HandleTypeDef *hspi);
 void      GYRO_IO_Init(void);
 void      GYRO_IO_Write(uint8_t* pBuffer, uint8_t WriteAddr, uint16_t NumByteToWrite);
 void      GYRO_IO_Read(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead);
+uint32_t  GYRO_IO_ReadDMA(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead);
+void      GYRO_IO_INT2Config(uint32_t Enable);
+void      GYRO_IO_INT2Check(void);
+void      GYRO_IO_RxCpltCallback(void);
+void      GYRO_IO_ErrorCallback(void);
+
+/* Link function for LCD peripheral */
+void      LCD_IO_Init(void);
+void      LCD_IO_WriteReg(uint8_t Reg);
+void      LCD_IO_WriteMultipleData(uint8_t *pData, uint32_t Size);
+uint16_t  LCD_IO_ReadData(uint16_t Reg);
+void      LCD_IO_WriteDataDMA(uint16_t *pData, uint32_t Count);
+void      LCD_IO_FillDataDMA(uint16_t RGBCode, uint32_t Count);
+void      LCD_IO_WaitDMA(void);
+void      LCD_Delay(uint32_t Delay);
 #endif
 
 #if defined(HAL_I2C_MODULE_ENABLED)
@@ -129,8 +167,62 @@ void                      EEPROM_IO_Init(void);
 uint32_t                  EEPROM_IO_WriteData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize);
 uint32_t                  EEPROM_IO_ReadData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize);
 HAL_StatusTypeDef         EEPROM_IO_IsDeviceReady(uint16_t DevAddress, uint32_t Trials);
+uint32_t                  EEPROM_IO_WriteDataDMA(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize);
+uint32_t                  EEPROM_IO_ReadDataDMA(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize);
+HAL_StatusTypeDef         EEPROM_IO_Probe(uint16_t DevAddress);
+void                      EEPROM_IO_TxCpltCallback(void);
+void                      EEPROM_IO_RxCpltCallback(void);
+void                      EEPROM_IO_ErrorCallback(void);
+
+/* Link function for I2C temperature sensor peripheral */
+void                      TSENSOR_IO_Init(void);
+void                      TSENSOR_IO_Write(uint16_t DevAddress, uint8_t* pBuffer, uint8_t WriteAddr, uint16_t Length);
+void                      TSENSOR_IO_Read(uint16_t DevAddress, uint8_t* pBuffer, uint8_t ReadAddr, uint16_t Length);
+uint16_t                  TSENSOR_IO_IsDeviceReady(uint16_t DevAddress, uint32_t Trials);
+void                      TSENSOR_IO_AlertConfig(uint32_t Enable);
+void                      TSENSOR_IO_AlertCheck(void);
 #endif /* HAL_I2C_MODULE_ENABLED */
 
+#if defined(HAL_ADC_MODULE_ENABLED) && defined(HAL_TIM_MODULE_ENABLED)
+/* ADC bus functions */
+static void               ADCx_MspInit(ADC_HandleTypeDef *hadc);
+static uint32_t           ADCx_TimerInit(uint32_t SampleRate);
+
+/* Link function for the sampling pipeline */
+uint32_t                  SAMPLER_IO_Start(uint16_t *pBuffer, uint32_t Length, uint32_t SampleRate);
+void                      SAMPLER_IO_Stop(void);
+uint32_t                  SAMPLER_IO_GetPosition(void);
+void                      SAMPLER_IO_HalfCpltCallback(void);
+void                      SAMPLER_IO_CpltCallback(void);
+void                      SAMPLER_IO_ErrorCallback(void);
+#endif /* HAL_ADC_MODULE_ENABLED && HAL_TIM_MODULE_ENABLED */
+
+#if defined(HAL_DAC_MODULE_ENABLED) && defined(HAL_TIM_MODULE_ENABLED)
+/* DAC bus functions */
+static void               DACx_MspInit(DAC_HandleTypeDef *hdac);
+static uint32_t           DACx_TimerInit(uint32_t SampleRate);
+
+/* Link functions for the synthesizer */
+uint32_t                  SYNTH_IO_Init(uint32_t SampleRate);
+uint8_t                   SYNTH_IO_Start(uint16_t *pBuffer, uint32_t Length);
+void                      SYNTH_IO_Stop(void);
+uint32_t                  SYNTH_IO_GetPosition(void);
+void                      SYNTH_IO_HalfCpltCallback(void);
+void                      SYNTH_IO_CpltCallback(void);
+void                      SYNTH_IO_ErrorCallback(void);
+#endif /* HAL_DAC_MODULE_ENABLED && HAL_TIM_MODULE_ENABLED */
+
+#if defined(HAL_UART_MODULE_ENABLED)
+/* USART bus functions */
+static void               USARTx_MspInit(UART_HandleTypeDef *huart);
+
+/* Link functions for the spectrum analyzer */
+uint8_t                   SPECTRUM_IO_Init(uint32_t BaudRate);
+uint8_t                   SPECTRUM_IO_Transmit(const uint8_t *pData, uint16_t Length);
+void                      SPECTRUM_IO_TxCpltCallback(void);
+void                      SPECTRUM_IO_ErrorCallback(void);
+#endif /* HAL_UART_MODULE_ENABLED */
+
 /**
   * @}
   */ 
@@ -387,109 +479,66 @@ static void I2Cx_Init(void)
 }
 
 /**
-  * @brief  Write a value in a register of the device through BUS.
-  * @param  Addr Device address on BUS Bus.  
-  * @param  Reg The target register address to write
-  * @param  Value The target register value to be written 
-  * @retval None 
+  * @brief Discovery I2Cx error treatment function
+  * @retval None
   */
-static uint32_t I2Cx_WriteData(uint8_t Addr, uint16_t Reg, uint8_t Value)
+static void I2Cx_Error(void)
+{
+  /* Stop the DMA transfer in progress, if any */
+  if (I2cHandle.hdmatx != NULL)
   {
-  HAL_StatusTypeDef status = HAL_OK;
-  
-  status = HAL_I2C_Mem_Write(&I2cHandle, Addr, Reg, I2C_MEMADD_SIZE_16BIT, &Value, 1, I2Cx_TIMEOUT_MAX); 
-
-  /* Check the communication status */
-  if(status != HAL_OK)
+    HAL_DMA_Abort(I2cHandle.hdmatx);
+  }
+  if (I2cHandle.hdmarx != NULL)
   {
-    /* Execute user timeout callback */
-    I2Cx_Error(Addr);
-    return HAL_ERROR;
-  }        
-  return HAL_OK;      
-}
+    HAL_DMA_Abort(I2cHandle.hdmarx);
+  }
 
-/**
-  * @brief  Write a value in a register of the device through BUS.
-  * @param  Addr Device address on BUS Bus.  
-  * @param  Reg The target register address to write
-  * @param  pBuffer The target register value to be written 
-  * @param  Length buffer size to be written
-  * @retval None
-  */
-static uint32_t I2Cx_WriteBuffer(uint8_t Addr, uint16_t Reg,  uint8_t *pBuffer, uint16_t Length)
-  {
-  HAL_StatusTypeDef status = HAL_OK;
-  
-  status = HAL_I2C_Mem_Write_DMA(&I2cHandle, Addr, Reg, I2C_MEMADD_SIZE_16BIT, pBuffer, Length); 
+  /* De-initialize the I2C communication BUS */
+  HAL_I2C_DeInit(&I2cHandle);
 
-  /* Check the communication status */
-  if(status != HAL_OK)
-  {
-    /* Execute user timeout callback */
-    I2Cx_Error(Addr);
-    return HAL_ERROR;
-  }        
-  return HAL_OK;      
+  /* Re- Initiaize the I2C communication BUS */
+  I2Cx_Init();
 }
 
 /**
-  * @brief  Read a register of the device through BUS
-  * @param  Addr Device address on BUS
-  * @param  Reg The target register address to read
-  * @retval Value: read register value
+  * @brief  Memory Tx Transfer completed callback.
+  * @param  hi2c I2C handle
+  * @retval None
   */
-static uint32_t I2Cx_ReadData(uint8_t Addr, uint16_t Reg, uint8_t *Value)
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
 {
-  HAL_StatusTypeDef status = HAL_OK;
-  
-  status = HAL_I2C_Mem_Read(&I2cHandle, Addr, Reg, I2C_MEMADD_SIZE_16BIT, Value, 1, I2Cx_TIMEOUT_MAX);
-  
-  /* Check the communication status */
-  if(status != HAL_OK)
+  if(hi2c->Instance == DISCOVERY_I2Cx)
   {
-    /* Execute user timeout callback */
-    I2Cx_Error(Addr);
-    return HAL_ERROR;
+    BSP_I2C_XferCpltCallback();
   }
-  return HAL_OK;
 }
 
 /**
-  * @brief  Reads multiple data on the BUS.
-  * @param  Addr   I2C Address
-  * @param  Reg    Reg Address 
-  * @param  pBuffer  pointer to read data buffer
-  * @param  Length  length of the data
-  * @retval 0 if no problems to read multiple data
+  * @brief  Memory Rx Transfer completed callback.
+  * @param  hi2c I2C handle
+  * @retval None
   */
-static uint32_t I2Cx_ReadBuffer(uint8_t Addr, uint16_t Reg, uint8_t *pBuffer, uint16_t Length)
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
 {
-  HAL_StatusTypeDef status = HAL_OK;
-
-  status = HAL_I2C_Mem_Read_DMA(&I2cHandle, Addr, Reg, I2C_MEMADD_SIZE_16BIT, pBuffer, Length);
-  
-  /* Check the communication status */
-  if(status != HAL_OK)
+  if(hi2c->Instance == DISCOVERY_I2Cx)
   {
-    /* Execute user timeout callback */
-    I2Cx_Error(Addr);
-    return HAL_ERROR;
+    BSP_I2C_XferCpltCallback();
   }
-  return HAL_OK;
 }
 
 /**
-  * @brief Discovery I2Cx error treatment function
+  * @brief  I2C error callback.
+  * @param  hi2c I2C handle
   * @retval None
   */
-static void I2Cx_Error (uint8_t Addr)
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
 {
-  /* De-initialize the I2C communication BUS */
-  HAL_I2C_DeInit(&I2cHandle);
-
-  /* Re- Initiaize the I2C communication BUS */
-  I2Cx_Init();
+  if(hi2c->Instance == DISCOVERY_I2Cx)
+  {
+    /* Acknowledge failure alone: the device is there but busy or absent */
+    BSP_I2C_XferErrorCallback((HAL_I2C_GetError(hi2c) == HAL_I2C_ERROR_AF) ? 1U : 0U);
+  }
 }
 #endif /* HAL_I2C_MODULE_ENABLED */
 
@@ -548,6 +597,22 @@ static uint8_t SPIx_WriteRead(uint8_t Byte)
   return receivedbyte;
 }
 
+/**
+  * @brief  Reads a block of bytes from the SPI bus in one transfer.
+  * @note   The buffer content is clocked out meanwhile: the slave must ignore
+  *         its input, as the gyroscope does during a read.
+  * @param  pBuffer  buffer receiving the data.
+  * @param  Length  number of bytes.
+  * @retval None
+  */
+static void SPIx_Read(uint8_t* pBuffer, uint16_t Length)
+{
+  if(HAL_SPI_Receive(&SpiHandle, pBuffer, Length, SpixTimeout) != HAL_OK)
+  {
+    SPIx_Error();
+  }
+}
+
 
 /**
   * @brief SPI1 error treatment function
@@ -571,6 +636,8 @@ static void SPIx_Error (void)
 static void SPIx_MspInit(SPI_HandleTypeDef *hspi)
 {
   GPIO_InitTypeDef   GPIO_InitStructure;
+  static DMA_HandleTypeDef hdma_tx;
+  static DMA_HandleTypeDef hdma_rx;
 
   /* Enable SPI2 clock  */
   DISCOVERY_SPIx_CLOCK_ENABLE();
@@ -585,189 +652,1467 @@ static void SPIx_MspInit(SPI_HandleTypeDef *hspi)
   GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_HIGH;
   GPIO_InitStructure.Alternate = DISCOVERY_SPIx_AF;
   HAL_GPIO_Init(DISCOVERY_SPIx_GPIO_PORT, &GPIO_InitStructure);
+
+  /* Move the SPI2 DMA requests to channels 6 and 7 */
+  __HAL_RCC_SYSCFG_CLK_ENABLE();
+  __HAL_DMA_REMAP_CHANNEL_ENABLE(DMA_REMAP_SPI2_DMA_CH67);
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* The TX channel only clocks the bus during the burst reads */
+  hdma_tx.Instance                  = DISCOVERY_GYRO_DMA_CHANNEL_TX;
+  hdma_tx.Init.Direction            = DMA_MEMORY_TO_PERIPH;
+  hdma_tx.Init.PeriphInc            = DMA_PINC_DISABLE;
+  hdma_tx.Init.MemInc               = DMA_MINC_ENABLE;
+  hdma_tx.Init.PeriphDataAlignment  = DMA_PDATAALIGN_BYTE;
+  hdma_tx.Init.MemDataAlignment     = DMA_MDATAALIGN_BYTE;
+  hdma_tx.Init.Mode                 = DMA_NORMAL;
+  hdma_tx.Init.Priority             = DMA_PRIORITY_MEDIUM;
+  __HAL_LINKDMA(hspi, hdmatx, hdma_tx);
+  HAL_DMA_Init(&hdma_tx);
+
+  hdma_rx.Instance                  = DISCOVERY_GYRO_DMA_CHANNEL_RX;
+  hdma_rx.Init.Direction            = DMA_PERIPH_TO_MEMORY;
+  hdma_rx.Init.PeriphInc            = DMA_PINC_DISABLE;
+  hdma_rx.Init.MemInc               = DMA_MINC_ENABLE;
+  hdma_rx.Init.PeriphDataAlignment  = DMA_PDATAALIGN_BYTE;
+  hdma_rx.Init.MemDataAlignment     = DMA_MDATAALIGN_BYTE;
+  hdma_rx.Init.Mode                 = DMA_NORMAL;
+  hdma_rx.Init.Priority             = DMA_PRIORITY_HIGH;
+  __HAL_LINKDMA(hspi, hdmarx, hdma_rx);
+  HAL_DMA_Init(&hdma_rx);
+
+  HAL_NVIC_SetPriority(DISCOVERY_GYRO_DMA_IRQn, DISCOVERY_EEPROM_DMA_PREPRIO, DISCOVERY_EEPROM_DMA_SUBPRIO);
+  HAL_NVIC_EnableIRQ(DISCOVERY_GYRO_DMA_IRQn);
 }
 
 /**
-  * @}
-  */ 
+  * @brief LCD SPI bus initialization
+  * @retval None
+  */
+static void LCD_SPIx_Init(void)
+{
+  if(HAL_SPI_GetState(&LcdSpiHandle) == HAL_SPI_STATE_RESET)
+  {
+    LcdSpiHandle.Instance = DISCOVERY_LCD_SPIx;
+    /* 12 MHz (PCLK / 4): ST7735 write cycle 66 ns minimum */
+    LcdSpiHandle.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_4;
+    LcdSpiHandle.Init.Direction = SPI_DIRECTION_2LINES;
+    LcdSpiHandle.Init.CLKPhase = SPI_PHASE_1EDGE;
+    LcdSpiHandle.Init.CLKPolarity = SPI_POLARITY_LOW;
+    LcdSpiHandle.Init.CRCCalculation = SPI_CRCCALCULATION_DISABLE;
+    LcdSpiHandle.Init.CRCPolynomial = 7;
+    LcdSpiHandle.Init.DataSize = SPI_DATASIZE_8BIT;
+    LcdSpiHandle.Init.FirstBit = SPI_FIRSTBIT_MSB;
+    LcdSpiHandle.Init.NSS = SPI_NSS_SOFT;
+    LcdSpiHandle.Init.TIMode = SPI_TIMODE_DISABLE;
+    LcdSpiHandle.Init.Mode = SPI_MODE_MASTER;
+
+    LCD_SPIx_MspInit(&LcdSpiHandle);
+    HAL_SPI_Init(&LcdSpiHandle);
+  }
+}
 
-/** @addtogroup STM32F072B_DISCOVERY_LINK_Operations_Functions
-  * @{
-  */ 
+/**
+  * @brief  Selects the frame size: 8 bits for commands and parameters, 16
+  *         bits for pixels, sent most significant byte first.
+  * @param  DataSize SPI_DATASIZE_8BIT or SPI_DATASIZE_16BIT
+  * @retval None
+  */
+static void LCD_SPIx_SetDataSize(uint32_t DataSize)
+{
+  if(LcdSpiHandle.Init.DataSize != DataSize)
+  {
+    /* Re-enabled by the next transfer */
+    __HAL_SPI_DISABLE(&LcdSpiHandle);
+    LcdSpiHandle.Init.DataSize = DataSize;
+    MODIFY_REG(LcdSpiHandle.Instance->CR2, SPI_CR2_DS, DataSize);
+  }
+}
 
-/******************************************************************************
-                            LINK OPERATIONS
-*******************************************************************************/
+/**
+  * @brief  Sends a block of frames, waiting for the end.
+  * @param  pData  frames
+  * @param  Size  number of frames
+  * @param  DataSize SPI_DATASIZE_8BIT or SPI_DATASIZE_16BIT
+  * @retval None
+  */
+static void LCD_SPIx_Write(uint8_t* pData, uint32_t Size, uint32_t DataSize)
+{
+  uint32_t count;
+
+  LCD_SPIx_SetDataSize(DataSize);
+  while(Size > 0)
+  {
+    count = (Size > 0xFFFFU) ? 0xFFFFU : Size;
+    if(HAL_SPI_Transmit(&LcdSpiHandle, pData, (uint16_t)count, SpixTimeout) != HAL_OK)
+    {
+      LCD_SPIx_Error();
+      return;
+    }
+    pData += (DataSize == SPI_DATASIZE_16BIT) ? (count * 2) : count;
+    Size -= count;
+  }
+}
 
-/********************************* LINK GYRO *****************************/
 /**
-  * @brief  Configures the GYRO SPI interface.
+  * @brief  Starts a DMA transfer of pixels, after the previous one.
+  * @param  pData  pixels
+  * @param  Count  number of pixels, at most 65535
+  * @param  MemInc 0 to send the first pixel Count times
   * @retval None
   */
-void GYRO_IO_Init(void)
+static void LCD_SPIx_StartDMA(uint16_t* pData, uint32_t Count, uint32_t MemInc)
 {
-  GPIO_InitTypeDef GPIO_InitStructure;
-  
-  /* Configure the Gyroscope Control pins ------------------------------------------*/
-  /* Enable CS GPIO clock and  Configure GPIO PIN for Gyroscope Chip select */  
-  GYRO_CS_GPIO_CLK_ENABLE();  
-  GPIO_InitStructure.Pin = GYRO_CS_PIN;
-  GPIO_InitStructure.Mode = GPIO_MODE_OUTPUT_PP;
+  LCD_IO_WaitDMA();
+  LCD_SPIx_SetDataSize(SPI_DATASIZE_16BIT);
+
+  /* The channel is disabled between transfers */
+  if(MemInc != 0)
+  {
+    SET_BIT(LcdSpiHandle.hdmatx->Instance->CCR, DMA_CCR_MINC);
+  }
+  else
+  {
+    CLEAR_BIT(LcdSpiHandle.hdmatx->Instance->CCR, DMA_CCR_MINC);
+  }
+
+  LCD_CS_LOW();
+  LCD_DC_HIGH();
+  LcdDmaBusy = 1;
+  if(HAL_SPI_Transmit_DMA(&LcdSpiHandle, (uint8_t*)pData, (uint16_t)Count) != HAL_OK)
+  {
+    LcdDmaBusy = 0;
+    LCD_CS_HIGH();
+    LCD_SPIx_Error();
+  }
+}
+
+/**
+  * @brief LCD SPI error treatment function
+  * @retval None
+  */
+static void LCD_SPIx_Error(void)
+{
+  /* De-initialize the SPI communication BUS */
+  HAL_SPI_DeInit(&LcdSpiHandle);
+
+  /* Re- Initiaize the SPI communication BUS */
+  LCD_SPIx_Init();
+}
+
+/**
+  * @brief LCD SPI MSP Init
+  * @param hspi SPI handle
+  * @retval None
+  */
+static void LCD_SPIx_MspInit(SPI_HandleTypeDef *hspi)
+{
+  GPIO_InitTypeDef   GPIO_InitStructure;
+  static DMA_HandleTypeDef hdma_tx;
+
+  DISCOVERY_LCD_SPIx_CLOCK_ENABLE();
+  DISCOVERY_LCD_SPIx_GPIO_CLK_ENABLE();
+
+  GPIO_InitStructure.Pin = (DISCOVERY_LCD_SPIx_SCK_PIN | DISCOVERY_LCD_SPIx_MOSI_PIN | DISCOVERY_LCD_SPIx_MISO_PIN);
+  GPIO_InitStructure.Mode = GPIO_MODE_AF_PP;
   GPIO_InitStructure.Pull  = GPIO_NOPULL;
   GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_HIGH;
-  HAL_GPIO_Init(GYRO_CS_GPIO_PORT, &GPIO_InitStructure);
+  GPIO_InitStructure.Alternate = DISCOVERY_LCD_SPIx_AF;
+  HAL_GPIO_Init(DISCOVERY_LCD_SPIx_GPIO_PORT, &GPIO_InitStructure);
 
-  /* Deselect : Chip Select high */
-  GYRO_CS_HIGH();
+  __HAL_RCC_DMA1_CLK_ENABLE();
 
-  /* Enable INT1, INT2 GPIO clock and Configure GPIO PINs to detect Interrupts */
-  GYRO_INT_GPIO_CLK_ENABLE();
-  GPIO_InitStructure.Pin = GYRO_INT1_PIN | GYRO_INT2_PIN;
-  GPIO_InitStructure.Mode = GPIO_MODE_INPUT;
-  GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_HIGH;
-  GPIO_InitStructure.Pull= GPIO_NOPULL;
-  HAL_GPIO_Init(GYRO_INT_GPIO_PORT, &GPIO_InitStructure);
-  
-  SPIx_Init();
+  /* Pixels only: 16-bit frames */
+  hdma_tx.Instance                  = DISCOVERY_LCD_DMA_CHANNEL_TX;
+  hdma_tx.Init.Direction            = DMA_MEMORY_TO_PERIPH;
+  hdma_tx.Init.PeriphInc            = DMA_PINC_DISABLE;
+  hdma_tx.Init.MemInc               = DMA_MINC_ENABLE;
+  hdma_tx.Init.PeriphDataAlignment  = DMA_PDATAALIGN_HALFWORD;
+  hdma_tx.Init.MemDataAlignment     = DMA_MDATAALIGN_HALFWORD;
+  hdma_tx.Init.Mode                 = DMA_NORMAL;
+  hdma_tx.Init.Priority             = DMA_PRIORITY_LOW;
+  __HAL_LINKDMA(hspi, hdmatx, hdma_tx);
+  HAL_DMA_Init(&hdma_tx);
+
+  HAL_NVIC_SetPriority(DISCOVERY_LCD_DMA_IRQn, DISCOVERY_LCD_DMA_PREPRIO, 0);
+  HAL_NVIC_EnableIRQ(DISCOVERY_LCD_DMA_IRQn);
 }
 
 /**
-  * @brief  Writes one byte to the GYRO.
-  * @param  pBuffer  pointer to the buffer  containing the data to be written to the GYRO.
-  * @param  WriteAddr  GYRO's internal address to write to.
-  * @param  NumByteToWrite Number of bytes to write.
+  * @brief  End of a SPI DMA reception: end of a gyroscope FIFO burst.
+  * @param  hspi SPI handle
   * @retval None
   */
-void GYRO_IO_Write(uint8_t* pBuffer, uint8_t WriteAddr, uint16_t NumByteToWrite)
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi)
 {
-  /* Configure the MS bit: 
-       - When 0, the address will remain unchanged in multiple read/write commands.
-       - When 1, the address will be auto incremented in multiple read/write commands.
-  */
-  if(NumByteToWrite > 0x01)
-  {
-    WriteAddr |= (uint8_t)MULTIPLEBYTE_CMD;
-  }
-  /* Set chip select Low at the start of the transmission */
-  GYRO_CS_LOW();
-  
-  /* Send the Address of the indexed register */
-  SPIx_WriteRead(WriteAddr);
-  
-  /* Send the data that will be written into the device (MSB First) */
-  while(NumByteToWrite >= 0x01)
+  if(hspi->Instance == DISCOVERY_SPIx)
   {
-    SPIx_WriteRead(*pBuffer);
-    NumByteToWrite--;
-    pBuffer++;
+    GYRO_CS_HIGH();
+    GYRO_IO_RxCpltCallback();
   }
-  
-  /* Set chip select High at the end of the transmission */ 
-  GYRO_CS_HIGH();
 }
 
 /**
-  * @brief  Reads a block of data from the GYROSCOPE.
-  * @param  pBuffer  pointer to the buffer that receives the data read from the GYROSCOPE.
-  * @param  ReadAddr  GYROSCOPE's internal address to read from.
-  * @param  NumByteToRead  number of bytes to read from the GYROSCOPE.
+  * @brief  End of a SPI DMA transmission: end of an LCD pixel transfer.
+  * @param  hspi SPI handle
   * @retval None
   */
-void GYRO_IO_Read(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead)
-{  
-  if(NumByteToRead > 0x01)
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  if(hspi->Instance == DISCOVERY_LCD_SPIx)
   {
-    ReadAddr |= (uint8_t)(READWRITE_CMD | MULTIPLEBYTE_CMD);
+    LCD_CS_HIGH();
+    LcdDmaBusy = 0;
   }
-  else
+}
+
+/**
+  * @brief  SPI DMA transfer error.
+  * @param  hspi SPI handle
+  * @retval None
+  */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+  if(hspi->Instance == DISCOVERY_LCD_SPIx)
   {
-    ReadAddr |= (uint8_t)READWRITE_CMD;
+    LCD_CS_HIGH();
+    LcdDmaBusy = 0;
+    LCD_SPIx_Error();
   }
-  /* Set chip select Low at the start of the transmission */
-  GYRO_CS_LOW();
-  
-  /* Send the Address of the indexed register */
-  SPIx_WriteRead(ReadAddr);
-  
-  /* Receive the data that will be read from the device (MSB First) */
-  while(NumByteToRead > 0x00)
+  else if(hspi->Instance == DISCOVERY_SPIx)
   {
-    /* Send dummy byte (0x00) to generate the SPI clock to GYROSCOPE (Slave device) */
-    *pBuffer = SPIx_WriteRead(DUMMY_BYTE);
-    NumByteToRead--;
-    pBuffer++;
+    GYRO_CS_HIGH();
+    SPIx_Error();
+    GYRO_IO_ErrorCallback();
   }
-  
-  /* Set chip select High at the end of the transmission */ 
-  GYRO_CS_HIGH();
-}  
+}
 #endif /* HAL_SPI_MODULE_ENABLED */
 
-#if defined(HAL_I2C_MODULE_ENABLED)
-/********************************* LINK I2C EEPROM *****************************/
+#if defined(HAL_ADC_MODULE_ENABLED) && defined(HAL_TIM_MODULE_ENABLED)
+/******************************* ADC Routines**********************************/
 /**
-  * @brief  Initializes peripherals used by the I2C EEPROM driver.
+  * @brief ADC MSP Init: analog input, circular DMA on channel 1
+  * @param hadc ADC handle
   * @retval None
   */
-void EEPROM_IO_Init(void)
+static void ADCx_MspInit(ADC_HandleTypeDef *hadc)
 {
-  I2Cx_Init();
+  GPIO_InitTypeDef         GPIO_InitStructure;
+  static DMA_HandleTypeDef hdma_adc;
+
+  DISCOVERY_ADCx_CLK_ENABLE();
+  DISCOVERY_ADC_GPIO_CLK_ENABLE();
+
+  GPIO_InitStructure.Pin = DISCOVERY_ADC_PIN;
+  GPIO_InitStructure.Mode = GPIO_MODE_ANALOG;
+  GPIO_InitStructure.Pull = GPIO_NOPULL;
+  HAL_GPIO_Init(DISCOVERY_ADC_GPIO_PORT, &GPIO_InitStructure);
+
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_adc.Instance                 = DISCOVERY_ADC_DMA_CHANNEL;
+  hdma_adc.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+  hdma_adc.Init.PeriphInc           = DMA_PINC_DISABLE;
+  hdma_adc.Init.MemInc              = DMA_MINC_ENABLE;
+  hdma_adc.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+  hdma_adc.Init.MemDataAlignment    = DMA_MDATAALIGN_HALFWORD;
+  hdma_adc.Init.Mode                = DMA_CIRCULAR;
+  hdma_adc.Init.Priority            = DMA_PRIORITY_VERY_HIGH;
+  __HAL_LINKDMA(hadc, DMA_Handle, hdma_adc);
+  HAL_DMA_Init(&hdma_adc);
+
+  HAL_NVIC_SetPriority(DISCOVERY_ADC_DMA_IRQn, DISCOVERY_ADC_DMA_PREPRIO, 0);
+  HAL_NVIC_EnableIRQ(DISCOVERY_ADC_DMA_IRQn);
 }
 
 /**
-  * @brief  Write data to I2C EEPROM driver in using DMA channel
-  * @param  DevAddress Target device address
-  * @param  MemAddress Internal memory address
-  * @param  pBuffer Pointer to data buffer
-  * @param  BufferSize Amount of data to be sent
-  * @retval HAL status
+  * @brief  Sets TIM3 to update, and trigger a conversion, SampleRate times
+  *         per second or as close as its divider allows.
+  * @param  SampleRate  conversions per second.
+  * @retval The rate set, 0 on failure
   */
-uint32_t EEPROM_IO_WriteData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+static uint32_t ADCx_TimerInit(uint32_t SampleRate)
 {
-  if (BufferSize == 1)
+  TIM_MasterConfigTypeDef master;
+  uint32_t clock, divider, prescaler;
+
+  /* APB prescaler 1: the timer runs at PCLK */
+  clock = HAL_RCC_GetPCLK1Freq();
+  divider = (clock + SampleRate / 2U) / SampleRate;
+  if (divider < 2U)
   {
-    return (I2Cx_WriteData(DevAddress, MemAddress, *((uint8_t*)pBuffer)));
+    return 0;
   }
-  else
+  prescaler = (divider - 1U) / 65536U;
+  divider /= prescaler + 1U;
+
+  DISCOVERY_ADC_TIMx_CLK_ENABLE();
+  AdcTimHandle.Instance               = DISCOVERY_ADC_TIMx;
+  AdcTimHandle.Init.Prescaler         = prescaler;
+  AdcTimHandle.Init.CounterMode       = TIM_COUNTERMODE_UP;
+  AdcTimHandle.Init.Period            = divider - 1U;
+  AdcTimHandle.Init.ClockDivision     = TIM_CLOCKDIVISION_DIV1;
+  AdcTimHandle.Init.RepetitionCounter = 0;
+  AdcTimHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&AdcTimHandle) != HAL_OK)
   {
-    return (I2Cx_WriteBuffer(DevAddress, MemAddress, (uint8_t*)pBuffer, (uint32_t)BufferSize));
+    return 0;
   }
+  master.MasterOutputTrigger = TIM_TRGO_UPDATE;
+  master.MasterSlaveMode     = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&AdcTimHandle, &master) != HAL_OK)
+  {
+    return 0;
+  }
+  return clock / ((prescaler + 1U) * divider);
 }
 
 /**
-  * @brief  Read data from I2C EEPROM driver in using DMA channel
-  * @param  DevAddress Target device address
-  * @param  MemAddress Internal memory address
-  * @param  pBuffer Pointer to data buffer
-  * @param  BufferSize Amount of data to be read
-  * @retval HAL status
+  * @brief  Half of the ADC DMA buffer filled.
+  * @param  hadc ADC handle
+  * @retval None
   */
-uint32_t EEPROM_IO_ReadData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
 {
-  if (BufferSize == 1)
+  if(hadc->Instance == DISCOVERY_ADCx)
   {
-    return (I2Cx_ReadData(DevAddress, MemAddress, (uint8_t*)pBuffer));
+    SAMPLER_IO_HalfCpltCallback();
   }
-  else
+}
+
+/**
+  * @brief  ADC DMA buffer filled: the transfer starts over.
+  * @param  hadc ADC handle
+  * @retval None
+  */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  if(hadc->Instance == DISCOVERY_ADCx)
   {
-    return (I2Cx_ReadBuffer(DevAddress, MemAddress, (uint8_t*)pBuffer, (uint32_t)BufferSize));
+    SAMPLER_IO_CpltCallback();
   }
 }
 
 /**
-* @brief  Checks if target device is ready for communication. 
-* @note   This function is used with Memory devices
-* @param  DevAddress Target device address
+  * @brief  ADC DMA transfer error.
+  * @param  hadc ADC handle
+  * @retval None
+  */
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc)
+{
+  if(hadc->Instance == DISCOVERY_ADCx)
+  {
+    SAMPLER_IO_ErrorCallback();
+  }
+}
+#endif /* HAL_ADC_MODULE_ENABLED && HAL_TIM_MODULE_ENABLED */
+
+#if defined(HAL_DAC_MODULE_ENABLED) && defined(HAL_TIM_MODULE_ENABLED)
+/******************************* DAC Routines**********************************/
+/**
+  * @brief DAC MSP Init: analog output, circular DMA on channel 3
+  * @param hdac DAC handle
+  * @retval None
+  */
+static void DACx_MspInit(DAC_HandleTypeDef *hdac)
+{
+  GPIO_InitTypeDef         GPIO_InitStructure;
+  static DMA_HandleTypeDef hdma_dac;
+
+  DISCOVERY_DACx_CLK_ENABLE();
+  DISCOVERY_DAC_GPIO_CLK_ENABLE();
+
+  GPIO_InitStructure.Pin = DISCOVERY_DAC_PIN;
+  GPIO_InitStructure.Mode = GPIO_MODE_ANALOG;
+  GPIO_InitStructure.Pull = GPIO_NOPULL;
+  HAL_GPIO_Init(DISCOVERY_DAC_GPIO_PORT, &GPIO_InitStructure);
+
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_dac.Instance                 = DISCOVERY_DAC_DMA_CHANNEL;
+  hdma_dac.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+  hdma_dac.Init.PeriphInc           = DMA_PINC_DISABLE;
+  hdma_dac.Init.MemInc              = DMA_MINC_ENABLE;
+  hdma_dac.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+  hdma_dac.Init.MemDataAlignment    = DMA_MDATAALIGN_HALFWORD;
+  hdma_dac.Init.Mode                = DMA_CIRCULAR;
+  hdma_dac.Init.Priority            = DMA_PRIORITY_HIGH;
+  __HAL_LINKDMA(hdac, DMA_Handle1, hdma_dac);
+  HAL_DMA_Init(&hdma_dac);
+
+  HAL_NVIC_SetPriority(DISCOVERY_DAC_DMA_IRQn, DISCOVERY_DAC_DMA_PREPRIO, 0);
+  HAL_NVIC_EnableIRQ(DISCOVERY_DAC_DMA_IRQn);
+  HAL_NVIC_SetPriority(DISCOVERY_DAC_IRQn, DISCOVERY_DAC_DMA_PREPRIO, 0);
+  HAL_NVIC_EnableIRQ(DISCOVERY_DAC_IRQn);
+}
+
+/**
+  * @brief  Sets TIM6 to update, and trigger a DAC update, SampleRate times
+  *         per second or as close as its divider allows.
+  * @param  SampleRate  updates per second.
+  * @retval The rate set, 0 on failure
+  */
+static uint32_t DACx_TimerInit(uint32_t SampleRate)
+{
+  TIM_MasterConfigTypeDef master;
+  uint32_t clock, divider, prescaler;
+
+  /* APB prescaler 1: the timer runs at PCLK */
+  clock = HAL_RCC_GetPCLK1Freq();
+  divider = (clock + SampleRate / 2U) / SampleRate;
+  if (divider < 2U)
+  {
+    return 0;
+  }
+  prescaler = (divider - 1U) / 65536U;
+  divider /= prescaler + 1U;
+
+  DISCOVERY_DAC_TIMx_CLK_ENABLE();
+  DacTimHandle.Instance               = DISCOVERY_DAC_TIMx;
+  DacTimHandle.Init.Prescaler         = prescaler;
+  DacTimHandle.Init.CounterMode       = TIM_COUNTERMODE_UP;
+  DacTimHandle.Init.Period            = divider - 1U;
+  DacTimHandle.Init.ClockDivision     = TIM_CLOCKDIVISION_DIV1;
+  DacTimHandle.Init.RepetitionCounter = 0;
+  DacTimHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&DacTimHandle) != HAL_OK)
+  {
+    return 0;
+  }
+  master.MasterOutputTrigger = TIM_TRGO_UPDATE;
+  master.MasterSlaveMode     = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&DacTimHandle, &master) != HAL_OK)
+  {
+    return 0;
+  }
+  return clock / ((prescaler + 1U) * divider);
+}
+
+/**
+  * @brief  Half of the DAC DMA buffer read.
+  * @param  hdac DAC handle
+  * @retval None
+  */
+void HAL_DAC_ConvHalfCpltCallbackCh1(DAC_HandleTypeDef *hdac)
+{
+  if(hdac->Instance == DISCOVERY_DACx)
+  {
+    SYNTH_IO_HalfCpltCallback();
+  }
+}
+
+/**
+  * @brief  DAC DMA buffer read: the transfer starts over.
+  * @param  hdac DAC handle
+  * @retval None
+  */
+void HAL_DAC_ConvCpltCallbackCh1(DAC_HandleTypeDef *hdac)
+{
+  if(hdac->Instance == DISCOVERY_DACx)
+  {
+    SYNTH_IO_CpltCallback();
+  }
+}
+
+/**
+  * @brief  DAC DMA transfer error.
+  * @param  hdac DAC handle
+  * @retval None
+  */
+void HAL_DAC_ErrorCallbackCh1(DAC_HandleTypeDef *hdac)
+{
+  if(hdac->Instance == DISCOVERY_DACx)
+  {
+    SYNTH_IO_ErrorCallback();
+  }
+}
+
+/**
+  * @brief  DAC trigger before the DMA had served the previous one.
+  * @param  hdac DAC handle
+  * @retval None
+  */
+void HAL_DAC_DMAUnderrunCallbackCh1(DAC_HandleTypeDef *hdac)
+{
+  if(hdac->Instance == DISCOVERY_DACx)
+  {
+    SYNTH_IO_ErrorCallback();
+  }
+}
+#endif /* HAL_DAC_MODULE_ENABLED && HAL_TIM_MODULE_ENABLED */
+
+#if defined(HAL_UART_MODULE_ENABLED)
+/******************************* USART Routines********************************/
+/**
+  * @brief USART MSP Init: transmit pin, DMA channel 2 remapped
+  * @param huart UART handle
+  * @retval None
+  */
+static void USARTx_MspInit(UART_HandleTypeDef *huart)
+{
+  GPIO_InitTypeDef         GPIO_InitStructure;
+  static DMA_HandleTypeDef hdma_tx;
+
+  DISCOVERY_USARTx_CLK_ENABLE();
+  DISCOVERY_USARTx_GPIO_CLK_ENABLE();
+
+  GPIO_InitStructure.Pin = DISCOVERY_USARTx_TX_PIN;
+  GPIO_InitStructure.Mode = GPIO_MODE_AF_PP;
+  GPIO_InitStructure.Pull = GPIO_PULLUP;
+  GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_HIGH;
+  GPIO_InitStructure.Alternate = DISCOVERY_USARTx_AF;
+  HAL_GPIO_Init(DISCOVERY_USARTx_GPIO_PORT, &GPIO_InitStructure);
+
+  __HAL_RCC_SYSCFG_CLK_ENABLE();
+  __HAL_DMA_REMAP_CHANNEL_ENABLE(DISCOVERY_USARTx_DMA_REMAP);
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_tx.Instance                  = DISCOVERY_USARTx_DMA_CHANNEL_TX;
+  hdma_tx.Init.Direction            = DMA_MEMORY_TO_PERIPH;
+  hdma_tx.Init.PeriphInc            = DMA_PINC_DISABLE;
+  hdma_tx.Init.MemInc               = DMA_MINC_ENABLE;
+  hdma_tx.Init.PeriphDataAlignment  = DMA_PDATAALIGN_BYTE;
+  hdma_tx.Init.MemDataAlignment     = DMA_MDATAALIGN_BYTE;
+  hdma_tx.Init.Mode                 = DMA_NORMAL;
+  hdma_tx.Init.Priority             = DMA_PRIORITY_LOW;
+  __HAL_LINKDMA(huart, hdmatx, hdma_tx);
+  HAL_DMA_Init(&hdma_tx);
+
+  HAL_NVIC_SetPriority(DISCOVERY_USARTx_DMA_IRQn, DISCOVERY_USARTx_PREPRIO, 0);
+  HAL_NVIC_EnableIRQ(DISCOVERY_USARTx_DMA_IRQn);
+  HAL_NVIC_SetPriority(DISCOVERY_USARTx_IRQn, DISCOVERY_USARTx_PREPRIO, 0);
+  HAL_NVIC_EnableIRQ(DISCOVERY_USARTx_IRQn);
+}
+
+/**
+  * @brief  Last byte of a DMA transmission out of the USART.
+  * @param  huart UART handle
+  * @retval None
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  if(huart->Instance == DISCOVERY_USARTx)
+  {
+    SPECTRUM_IO_TxCpltCallback();
+  }
+}
+
+/**
+  * @brief  USART or DMA error.
+  * @param  huart UART handle
+  * @retval None
+  */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  if(huart->Instance == DISCOVERY_USARTx)
+  {
+    SPECTRUM_IO_ErrorCallback();
+  }
+}
+#endif /* HAL_UART_MODULE_ENABLED */
+
+/**
+  * @}
+  */ 
+
+/** @addtogroup STM32F072B_DISCOVERY_LINK_Operations_Functions
+  * @{
+  */ 
+
+/******************************************************************************
+                            LINK OPERATIONS
+*******************************************************************************/
+#if defined(HAL_SPI_MODULE_ENABLED)
+
+/********************************* LINK GYRO *****************************/
+/**
+  * @brief  Configures the GYRO SPI interface.
+  * @retval None
+  */
+void GYRO_IO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStructure;
+  
+  /* Configure the Gyroscope Control pins ------------------------------------------*/
+  /* Enable CS GPIO clock and  Configure GPIO PIN for Gyroscope Chip select */  
+  GYRO_CS_GPIO_CLK_ENABLE();  
+  GPIO_InitStructure.Pin = GYRO_CS_PIN;
+  GPIO_InitStructure.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStructure.Pull  = GPIO_NOPULL;
+  GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_HIGH;
+  HAL_GPIO_Init(GYRO_CS_GPIO_PORT, &GPIO_InitStructure);
+
+  /* Deselect : Chip Select high */
+  GYRO_CS_HIGH();
+
+  /* Enable INT1, INT2 GPIO clock and Configure GPIO PINs to detect Interrupts */
+  GYRO_INT_GPIO_CLK_ENABLE();
+  GPIO_InitStructure.Pin = GYRO_INT1_PIN | GYRO_INT2_PIN;
+  GPIO_InitStructure.Mode = GPIO_MODE_INPUT;
+  GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_HIGH;
+  GPIO_InitStructure.Pull= GPIO_NOPULL;
+  HAL_GPIO_Init(GYRO_INT_GPIO_PORT, &GPIO_InitStructure);
+  
+  SPIx_Init();
+}
+
+/**
+  * @brief  Writes one byte to the GYRO.
+  * @param  pBuffer  pointer to the buffer  containing the data to be written to the GYRO.
+  * @param  WriteAddr  GYRO's internal address to write to.
+  * @param  NumByteToWrite Number of bytes to write.
+  * @retval None
+  */
+void GYRO_IO_Write(uint8_t* pBuffer, uint8_t WriteAddr, uint16_t NumByteToWrite)
+{
+  /* Configure the MS bit: 
+       - When 0, the address will remain unchanged in multiple read/write commands.
+       - When 1, the address will be auto incremented in multiple read/write commands.
+  */
+  if(NumByteToWrite > 0x01)
+  {
+    WriteAddr |= (uint8_t)MULTIPLEBYTE_CMD;
+  }
+  /* Set chip select Low at the start of the transmission */
+  GYRO_CS_LOW();
+  
+  /* Send the Address of the indexed register */
+  SPIx_WriteRead(WriteAddr);
+  
+  /* Send the data that will be written into the device (MSB First) */
+  while(NumByteToWrite >= 0x01)
+  {
+    SPIx_WriteRead(*pBuffer);
+    NumByteToWrite--;
+    pBuffer++;
+  }
+  
+  /* Set chip select High at the end of the transmission */ 
+  GYRO_CS_HIGH();
+}
+
+/**
+  * @brief  Reads a block of data from the GYROSCOPE.
+  * @param  pBuffer  pointer to the buffer that receives the data read from the GYROSCOPE.
+  * @param  ReadAddr  GYROSCOPE's internal address to read from.
+  * @param  NumByteToRead  number of bytes to read from the GYROSCOPE.
+  * @retval None
+  */
+void GYRO_IO_Read(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead)
+{  
+  if(NumByteToRead > 0x01)
+  {
+    ReadAddr |= (uint8_t)(READWRITE_CMD | MULTIPLEBYTE_CMD);
+  }
+  else
+  {
+    ReadAddr |= (uint8_t)READWRITE_CMD;
+  }
+  /* Set chip select Low at the start of the transmission */
+  GYRO_CS_LOW();
+  
+  /* Send the Address of the indexed register */
+  SPIx_WriteRead(ReadAddr);
+  
+  /* Receive the data that will be read from the device (MSB First) */
+  if(NumByteToRead > 0x01)
+  {
+    SPIx_Read(pBuffer, NumByteToRead);
+  }
+  else if(NumByteToRead == 0x01)
+  {
+    /* Send dummy byte (0x00) to generate the SPI clock to GYROSCOPE (Slave device) */
+    *pBuffer = SPIx_WriteRead(DUMMY_BYTE);
+  }
+  
+  /* Set chip select High at the end of the transmission */ 
+  GYRO_CS_HIGH();
+}  
+
+/**
+  * @brief  Starts a DMA read of a block of data from the GYROSCOPE.
+  * @note   Ends with GYRO_IO_RxCpltCallback() or GYRO_IO_ErrorCallback(),
+  *         from the DMA interrupt, chip select released.
+  * @param  pBuffer  pointer to the buffer that receives the data.
+  * @param  ReadAddr  GYROSCOPE's internal address to read from.
+  * @param  NumByteToRead  number of bytes to read from the GYROSCOPE.
+  * @retval 0 if started
+  */
+uint32_t GYRO_IO_ReadDMA(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead)
+{
+  GYRO_CS_LOW();
+  SPIx_WriteRead((uint8_t)(ReadAddr | READWRITE_CMD | MULTIPLEBYTE_CMD));
+  if(HAL_SPI_Receive_DMA(&SpiHandle, pBuffer, NumByteToRead) != HAL_OK)
+  {
+    GYRO_CS_HIGH();
+    SPIx_Error();
+    return 1;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Enables or disables the interrupt on the INT2 rising edge.
+  * @param  Enable  1 to enable, 0 to disable.
+  * @retval None
+  */
+void GYRO_IO_INT2Config(uint32_t Enable)
+{
+  GPIO_InitTypeDef GPIO_InitStructure;
+
+  GPIO_InitStructure.Pin = GYRO_INT2_PIN;
+  GPIO_InitStructure.Mode = (Enable != 0) ? GPIO_MODE_IT_RISING : GPIO_MODE_INPUT;
+  GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_HIGH;
+  GPIO_InitStructure.Pull = GPIO_NOPULL;
+  HAL_GPIO_Init(GYRO_INT_GPIO_PORT, &GPIO_InitStructure);
+
+  if (Enable != 0)
+  {
+    HAL_NVIC_SetPriority(GYRO_INT2_EXTI_IRQn, GYRO_INT_PREPRIO, 0);
+    HAL_NVIC_EnableIRQ(GYRO_INT2_EXTI_IRQn);
+    GYRO_IO_INT2Check();
+  }
+  else
+  {
+    HAL_NVIC_DisableIRQ(GYRO_INT2_EXTI_IRQn);
+  }
+}
+
+/**
+  * @brief  Raises the INT2 interrupt by software if the line is already
+  *         high: its rising edge has passed.
+  * @retval None
+  */
+void GYRO_IO_INT2Check(void)
+{
+  if (HAL_GPIO_ReadPin(GYRO_INT_GPIO_PORT, GYRO_INT2_PIN) == GPIO_PIN_SET)
+  {
+    EXTI->SWIER = GYRO_INT2_PIN;
+  }
+}
+
+/********************************* LINK LCD ***********************************/
+/**
+  * @brief  Configures the LCD SPI interface.
+  * @retval None
+  */
+void LCD_IO_Init(void)
+{
+  GPIO_InitTypeDef GPIO_InitStructure;
+
+  LCD_CS_GPIO_CLK_ENABLE();
+  LCD_DC_GPIO_CLK_ENABLE();
+  GPIO_InitStructure.Pin = LCD_CS_PIN;
+  GPIO_InitStructure.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStructure.Pull  = GPIO_NOPULL;
+  GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_HIGH;
+  HAL_GPIO_Init(LCD_CS_GPIO_PORT, &GPIO_InitStructure);
+  GPIO_InitStructure.Pin = LCD_DC_PIN;
+  HAL_GPIO_Init(LCD_DC_GPIO_PORT, &GPIO_InitStructure);
+
+  /* Deselect : Chip Select high */
+  LCD_CS_HIGH();
+
+  LCD_SPIx_Init();
+}
+
+/**
+  * @brief  Writes a command byte, after the pixel transfer in progress.
+  * @param  Reg  command or register index
+  * @retval None
+  */
+void LCD_IO_WriteReg(uint8_t Reg)
+{
+  LCD_IO_WaitDMA();
+  LCD_CS_LOW();
+  LCD_DC_LOW();
+  LCD_SPIx_Write(&Reg, 1, SPI_DATASIZE_8BIT);
+  LCD_CS_HIGH();
+}
+
+/**
+  * @brief  Writes data, after the pixel transfer in progress.
+  * @param  pData  one byte, or 16-bit values sent most significant byte
+  *         first
+  * @param  Size  number of bytes
+  * @retval None
+  */
+void LCD_IO_WriteMultipleData(uint8_t *pData, uint32_t Size)
+{
+  LCD_IO_WaitDMA();
+  LCD_CS_LOW();
+  LCD_DC_HIGH();
+  if(Size == 1)
+  {
+    LCD_SPIx_Write(pData, 1, SPI_DATASIZE_8BIT);
+  }
+  else
+  {
+    LCD_SPIx_Write(pData, Size / 2, SPI_DATASIZE_16BIT);
+  }
+  LCD_CS_HIGH();
+}
+
+/**
+  * @brief  Reads a 16-bit register.
+  * @param  Reg  register index
+  * @retval Register value
+  */
+uint16_t LCD_IO_ReadData(uint16_t Reg)
+{
+  uint8_t index = (uint8_t)Reg;
+  uint8_t data[2] = {0, 0};
+
+  LCD_IO_WaitDMA();
+  LCD_CS_LOW();
+  LCD_DC_LOW();
+  LCD_SPIx_Write(&index, 1, SPI_DATASIZE_8BIT);
+  LCD_DC_HIGH();
+  if(HAL_SPI_Receive(&LcdSpiHandle, data, 2, SpixTimeout) != HAL_OK)
+  {
+    LCD_SPIx_Error();
+  }
+  LCD_CS_HIGH();
+
+  return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+/**
+  * @brief  Starts sending pixels by DMA, after the transfer in progress,
+  *         and returns. The buffer must stay unchanged until the next
+  *         LCD_IO function returns.
+  * @param  pData  pixels, halfword aligned
+  * @param  Count  number of pixels
+  * @retval None
+  */
+void LCD_IO_WriteDataDMA(uint16_t *pData, uint32_t Count)
+{
+  uint32_t count;
+
+  while(Count > 0)
+  {
+    count = (Count > 0xFFFFU) ? 0xFFFFU : Count;
+    LCD_SPIx_StartDMA(pData, count, 1);
+    pData += count;
+    Count -= count;
+  }
+}
+
+/**
+  * @brief  Starts sending one pixel value Count times by DMA, after the
+  *         transfer in progress, and returns.
+  * @param  RGBCode  pixel value
+  * @param  Count  number of pixels
+  * @retval None
+  */
+void LCD_IO_FillDataDMA(uint16_t RGBCode, uint32_t Count)
+{
+  uint32_t count;
+
+  while(Count > 0)
+  {
+    count = (Count > 0xFFFFU) ? 0xFFFFU : Count;
+    /* Read by the DMA: changed once the previous transfer is over */
+    LCD_IO_WaitDMA();
+    LcdFillColor = RGBCode;
+    LCD_SPIx_StartDMA(&LcdFillColor, count, 0);
+    Count -= count;
+  }
+}
+
+/**
+  * @brief  Waits for the end of the pixel transfer in progress.
+  * @retval None
+  */
+void LCD_IO_WaitDMA(void)
+{
+  uint32_t tickstart;
+
+  if(LcdDmaBusy == 0)
+  {
+    return;
+  }
+  tickstart = HAL_GetTick();
+  while(LcdDmaBusy != 0)
+  {
+    if((HAL_GetTick() - tickstart) > LCD_DMA_TIMEOUT)
+    {
+      HAL_SPI_Abort(&LcdSpiHandle);
+      LcdDmaBusy = 0;
+      LCD_CS_HIGH();
+      LCD_SPIx_Error();
+    }
+  }
+}
+
+/**
+  * @brief  Wait for loop in ms.
+  * @param  Delay in ms.
+  * @retval None
+  */
+void LCD_Delay(uint32_t Delay)
+{
+  HAL_Delay(Delay);
+}
+#endif /* HAL_SPI_MODULE_ENABLED */
+
+#if defined(HAL_I2C_MODULE_ENABLED)
+/********************************* LINK I2C BUS ********************************/
+/**
+  * @brief  Initializes the I2C bus used by the transaction scheduler.
+  * @retval None
+  */
+void I2C_IO_Init(void)
+{
+  I2Cx_Init();
+}
+
+/**
+  * @brief  Resets the I2C bus after a fault, dropping the transfer in
+  *         progress.
+  * @retval None
+  */
+void I2C_IO_Recover(void)
+{
+  I2Cx_Error();
+}
+
+/**
+  * @brief  Starts writing to a device memory through the DMA.
+  * @param  DevAddress Target device address
+  * @param  MemAddress Internal memory address
+  * @param  MemAddSize I2C_MEMADD_SIZE_8BIT or I2C_MEMADD_SIZE_16BIT
+  * @param  pBuffer Pointer to data buffer
+  * @param  Size Amount of data to be sent
+  * @retval HAL status
+  */
+HAL_StatusTypeDef I2C_IO_MemWriteDMA(uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pBuffer, uint16_t Size)
+{
+  return (HAL_I2C_Mem_Write_DMA(&I2cHandle, DevAddress, MemAddress, MemAddSize, pBuffer, Size));
+}
+
+/**
+  * @brief  Starts reading from a device memory through the DMA.
+  * @param  DevAddress Target device address
+  * @param  MemAddress Internal memory address
+  * @param  MemAddSize I2C_MEMADD_SIZE_8BIT or I2C_MEMADD_SIZE_16BIT
+  * @param  pBuffer Pointer to data buffer
+  * @param  Size Amount of data to be read
+  * @retval HAL status
+  */
+HAL_StatusTypeDef I2C_IO_MemReadDMA(uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pBuffer, uint16_t Size)
+{
+  return (HAL_I2C_Mem_Read_DMA(&I2cHandle, DevAddress, MemAddress, MemAddSize, pBuffer, Size));
+}
+
+/**
+  * @brief  Addresses the device once, without delay.
+  * @note   HAL_I2C_IsDeviceReady() times out on HAL_GetTick(), which does not
+  *         advance when called from SysTick_Handler(): the wait for the STOP
+  *         is bounded by DISCOVERY_I2Cx_PROBE_LOOPS status reads instead.
+  * @param  DevAddress Target device address
+  * @retval HAL_OK if the device acknowledged, HAL_ERROR if not, HAL_BUSY if
+  *         the bus is in use, HAL_TIMEOUT if the probe did not end (SCL held
+  *         low, bus error, arbitration lost): the bus must then be reset
+  */
+HAL_StatusTypeDef I2C_IO_Probe(uint16_t DevAddress)
+{
+  uint32_t loops = DISCOVERY_I2Cx_PROBE_LOOPS;
+  uint32_t isr;
+
+  if ((I2cHandle.State != HAL_I2C_STATE_READY) || (__HAL_I2C_GET_FLAG(&I2cHandle, I2C_FLAG_BUSY) == SET))
+  {
+    return HAL_BUSY;
+  }
+
+  /* START, address and, in AUTOEND mode, STOP after the ACK or the NACK */
+  I2cHandle.Instance->CR2 = I2C_GENERATE_START(I2cHandle.Init.AddressingMode, DevAddress);
+  do
+  {
+    isr = I2cHandle.Instance->ISR;
+  } while (((isr & (I2C_FLAG_STOPF | I2C_FLAG_BERR | I2C_FLAG_ARLO)) == 0U) && (--loops > 0U));
+
+  if ((isr & I2C_FLAG_STOPF) == 0U)
+  {
+    return HAL_TIMEOUT;
+  }
+  __HAL_I2C_CLEAR_FLAG(&I2cHandle, I2C_FLAG_STOPF);
+  if ((isr & I2C_FLAG_AF) != 0U)
+  {
+    __HAL_I2C_CLEAR_FLAG(&I2cHandle, I2C_FLAG_AF);
+    return HAL_ERROR;
+  }
+  return HAL_OK;
+}
+
+/********************************* LINK I2C EEPROM *****************************/
+/* DMA transfers of the EEPROM driver, one at a time */
+static I2C_TransactionTypeDef EEPROMXfer;
+
+/**
+  * @brief  Completion of an EEPROM DMA transfer.
+  * @param  pXfer EEPROM transaction
+  * @retval None
+  */
+static void EEPROM_IO_XferCplt(I2C_TransactionTypeDef* pXfer)
+{
+  if (pXfer->Status != I2C_XFER_OK)
+  {
+    EEPROM_IO_ErrorCallback();
+  }
+  else if (pXfer->Write != 0)
+  {
+    EEPROM_IO_TxCpltCallback();
+  }
+  else
+  {
+    EEPROM_IO_RxCpltCallback();
+  }
+}
+
+/**
+  * @brief  Queues an EEPROM transfer on the I2C bus.
+  * @param  DevAddress Target device address
+  * @param  MemAddress Internal memory address
+  * @param  pBuffer Pointer to data buffer
+  * @param  BufferSize Amount of data
+  * @param  Write 1 to write, 0 to read
+  * @param  Wait 1 to wait for the end of the transfer, 0 to be called back
+  * @retval HAL status
+  */
+static uint32_t EEPROM_IO_Transfer(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize, uint8_t Write, uint8_t Wait)
+{
+  I2C_TransactionTypeDef  xfer;
+  I2C_TransactionTypeDef* pXfer = (Wait != 0) ? &xfer : &EEPROMXfer;
+
+  if ((Wait == 0) && (EEPROMXfer.Status == I2C_XFER_BUSY))
+  {
+    return HAL_BUSY;
+  }
+  memset(pXfer, 0, sizeof(I2C_TransactionTypeDef));
+  pXfer->DevAddress = DevAddress;
+  pXfer->MemAddress = MemAddress;
+  pXfer->MemAddSize = I2C_MEMADD_SIZE_16BIT;
+  pXfer->Size       = (uint16_t)BufferSize;
+  pXfer->pBuffer    = (uint8_t*)pBuffer;
+  pXfer->Write      = Write;
+  pXfer->Priority   = I2C_PRIORITY_NORMAL;
+  pXfer->Flags      = I2C_XFER_AUTOINC;
+  if (Wait != 0)
+  {
+    return ((BSP_I2C_Transfer(pXfer) == I2C_XFER_OK) ? HAL_OK : HAL_ERROR);
+  }
+  pXfer->Callback   = EEPROM_IO_XferCplt;
+  return ((BSP_I2C_Submit(pXfer) == I2C_XFER_OK) ? HAL_OK : HAL_BUSY);
+}
+
+/**
+  * @brief  Initializes peripherals used by the I2C EEPROM driver.
+  * @retval None
+  */
+void EEPROM_IO_Init(void)
+{
+  BSP_I2C_Init();
+}
+
+/**
+  * @brief  Write data to I2C EEPROM driver in using DMA channel
+  * @note   A single byte is written before returning, without callback.
+  * @param  DevAddress Target device address
+  * @param  MemAddress Internal memory address
+  * @param  pBuffer Pointer to data buffer
+  * @param  BufferSize Amount of data to be sent
+  * @retval HAL status
+  */
+uint32_t EEPROM_IO_WriteData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+{
+  return (EEPROM_IO_Transfer(DevAddress, MemAddress, pBuffer, BufferSize, 1, (BufferSize == 1) ? 1U : 0U));
+}
+
+/**
+  * @brief  Read data from I2C EEPROM driver in using DMA channel
+  * @note   A single byte is read before returning, without callback.
+  * @param  DevAddress Target device address
+  * @param  MemAddress Internal memory address
+  * @param  pBuffer Pointer to data buffer
+  * @param  BufferSize Amount of data to be read
+  * @retval HAL status
+  */
+uint32_t EEPROM_IO_ReadData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+{
+  return (EEPROM_IO_Transfer(DevAddress, MemAddress, pBuffer, BufferSize, 0, (BufferSize == 1) ? 1U : 0U));
+}
+
+/**
+* @brief  Checks if target device is ready for communication. 
+* @note   This function is used with Memory devices
+* @param  DevAddress Target device address
 * @param  Trials Number of trials
-* @retval HAL status
+* @retval HAL_OK if ready, HAL_BUSY if the bus was in use
 */
 HAL_StatusTypeDef EEPROM_IO_IsDeviceReady(uint16_t DevAddress, uint32_t Trials)
 { 
+  HAL_StatusTypeDef status = HAL_ERROR;
+
   HAL_Delay(5);
-  return (HAL_I2C_IsDeviceReady(&I2cHandle, DevAddress, Trials, I2Cx_TIMEOUT_MAX));
+  while ((Trials-- > 0) && (status != HAL_OK))
+  {
+    status = BSP_I2C_Probe(DevAddress);
+  }
+  return status;
+}
+
+/**
+  * @brief  Write data to I2C EEPROM driver in using DMA channel, whatever the
+  *         size: completion is always signalled by the Tx complete callback.
+  * @param  DevAddress Target device address
+  * @param  MemAddress Internal memory address
+  * @param  pBuffer Pointer to data buffer
+  * @param  BufferSize Amount of data to be sent
+  * @retval HAL status
+  */
+uint32_t EEPROM_IO_WriteDataDMA(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+{
+  return (EEPROM_IO_Transfer(DevAddress, MemAddress, pBuffer, BufferSize, 1, 0));
+}
+
+/**
+  * @brief  Read data from I2C EEPROM driver in using DMA channel, whatever the
+  *         size: completion is always signalled by the Rx complete callback.
+  * @param  DevAddress Target device address
+  * @param  MemAddress Internal memory address
+  * @param  pBuffer Pointer to data buffer
+  * @param  BufferSize Amount of data to be read
+  * @retval HAL status
+  */
+uint32_t EEPROM_IO_ReadDataDMA(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+{
+  return (EEPROM_IO_Transfer(DevAddress, MemAddress, pBuffer, BufferSize, 0, 0));
+}
+
+/**
+* @brief  Addresses the device once, without delay: usable from a timer
+*         interrupt to poll the end of an EEPROM write cycle.
+* @param  DevAddress Target device address
+* @retval HAL_OK if the device acknowledged, HAL_BUSY if the bus is in use
+*/
+HAL_StatusTypeDef EEPROM_IO_Probe(uint16_t DevAddress)
+{ 
+  return (BSP_I2C_Probe(DevAddress));
+}
+
+/********************************* LINK I2C TSENSOR ****************************/
+/**
+  * @brief  Initializes peripherals used by the I2C temperature sensor driver.
+  * @retval None
+  */
+void TSENSOR_IO_Init(void)
+{
+  BSP_I2C_Init();
+}
+
+/**
+  * @brief  Writes registers of the temperature sensor, ahead of the EEPROM
+  *         traffic.
+  * @param  DevAddress Target device address
+  * @param  pBuffer Pointer to data buffer
+  * @param  WriteAddr Register address
+  * @param  Length Amount of data to be sent
+  * @retval None
+  */
+void TSENSOR_IO_Write(uint16_t DevAddress, uint8_t* pBuffer, uint8_t WriteAddr, uint16_t Length)
+{
+  I2C_TransactionTypeDef xfer;
+
+  memset(&xfer, 0, sizeof(xfer));
+  xfer.DevAddress = DevAddress;
+  xfer.MemAddress = WriteAddr;
+  xfer.MemAddSize = I2C_MEMADD_SIZE_8BIT;
+  xfer.Size       = Length;
+  xfer.pBuffer    = pBuffer;
+  xfer.Write      = 1;
+  xfer.Priority   = I2C_PRIORITY_HIGH;
+  BSP_I2C_Transfer(&xfer);
+}
+
+/**
+  * @brief  Reads registers of the temperature sensor, ahead of the EEPROM
+  *         traffic. Concurrent reads of the same register share a transfer.
+  * @param  DevAddress Target device address
+  * @param  pBuffer Pointer to data buffer
+  * @param  ReadAddr Register address
+  * @param  Length Amount of data to be read
+  * @retval None
+  */
+void TSENSOR_IO_Read(uint16_t DevAddress, uint8_t* pBuffer, uint8_t ReadAddr, uint16_t Length)
+{
+  I2C_TransactionTypeDef xfer;
+
+  memset(&xfer, 0, sizeof(xfer));
+  xfer.DevAddress = DevAddress;
+  xfer.MemAddress = ReadAddr;
+  xfer.MemAddSize = I2C_MEMADD_SIZE_8BIT;
+  xfer.Size       = Length;
+  xfer.pBuffer    = pBuffer;
+  xfer.Priority   = I2C_PRIORITY_HIGH;
+  BSP_I2C_Transfer(&xfer);
+}
+
+/**
+  * @brief  Checks if the temperature sensor is ready for communication.
+  * @param  DevAddress Target device address
+  * @param  Trials Number of trials
+  * @retval HAL status
+  */
+uint16_t TSENSOR_IO_IsDeviceReady(uint16_t DevAddress, uint32_t Trials)
+{ 
+  HAL_StatusTypeDef status = HAL_ERROR;
+
+  while ((Trials-- > 0) && (status != HAL_OK))
+  {
+    status = BSP_I2C_Probe(DevAddress);
+  }
+  return (uint16_t)status;
+}
+
+/**
+  * @brief  Enables or disables the interrupt on the falling edge of the OS
+  *         output of the temperature sensor.
+  * @param  Enable  1 to enable, 0 to disable.
+  * @retval None
+  */
+void TSENSOR_IO_AlertConfig(uint32_t Enable)
+{
+  GPIO_InitTypeDef GPIO_InitStructure;
+
+  TSENSOR_OS_GPIO_CLK_ENABLE();
+  GPIO_InitStructure.Pin = TSENSOR_OS_PIN;
+  GPIO_InitStructure.Mode = (Enable != 0) ? GPIO_MODE_IT_FALLING : GPIO_MODE_INPUT;
+  GPIO_InitStructure.Speed = GPIO_SPEED_FREQ_LOW;
+  GPIO_InitStructure.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(TSENSOR_OS_GPIO_PORT, &GPIO_InitStructure);
+
+  if (Enable != 0)
+  {
+    HAL_NVIC_SetPriority(TSENSOR_OS_EXTI_IRQn, TSENSOR_OS_PREPRIO, 0);
+    HAL_NVIC_EnableIRQ(TSENSOR_OS_EXTI_IRQn);
+    TSENSOR_IO_AlertCheck();
+  }
+  /* EXTI2_3 stays enabled: the gyroscope INT2 line may use it */
+}
+
+/**
+  * @brief  Raises the OS interrupt by software if the output is already
+  *         active: its falling edge has passed.
+  * @retval None
+  */
+void TSENSOR_IO_AlertCheck(void)
+{
+  if (HAL_GPIO_ReadPin(TSENSOR_OS_GPIO_PORT, TSENSOR_OS_PIN) == GPIO_PIN_RESET)
+  {
+    EXTI->SWIER = TSENSOR_OS_PIN;
+  }
 }
 #endif /* HAL_I2C_MODULE_ENABLED */
 
+#if defined(HAL_ADC_MODULE_ENABLED) && defined(HAL_TIM_MODULE_ENABLED)
+/******************************** LINK SAMPLER ********************************/
+/**
+  * @brief  Starts TIM3-triggered conversions of DISCOVERY_ADC_CHANNEL into a
+  *         circular DMA buffer.
+  * @note   The ADC runs left aligned, at PCLK / 4 to stay in step with the
+  *         timer, sampling for 7.5 cycles.
+  * @param  pBuffer  buffer of Length samples, both halves handed over by the
+  *         callbacks in turn.
+  * @param  Length  number of samples of the buffer, even.
+  * @param  SampleRate  conversions per second.
+  * @retval The rate set, 0 on failure
+  */
+uint32_t SAMPLER_IO_Start(uint16_t *pBuffer, uint32_t Length, uint32_t SampleRate)
+{
+  ADC_ChannelConfTypeDef channel;
+  uint32_t rate;
+
+  AdcHandle.Instance                   = DISCOVERY_ADCx;
+  AdcHandle.Init.ClockPrescaler        = ADC_CLOCK_SYNC_PCLK_DIV4;
+  AdcHandle.Init.Resolution            = ADC_RESOLUTION_12B;
+  AdcHandle.Init.DataAlign             = ADC_DATAALIGN_LEFT;
+  AdcHandle.Init.ScanConvMode          = ADC_SCAN_DIRECTION_FORWARD;
+  AdcHandle.Init.EOCSelection          = ADC_EOC_SINGLE_CONV;
+  AdcHandle.Init.LowPowerAutoWait      = DISABLE;
+  AdcHandle.Init.LowPowerAutoPowerOff  = DISABLE;
+  AdcHandle.Init.ContinuousConvMode    = DISABLE;
+  AdcHandle.Init.DiscontinuousConvMode = DISABLE;
+  AdcHandle.Init.ExternalTrigConv      = ADC_EXTERNALTRIGCONV_T3_TRGO;
+  AdcHandle.Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_RISING;
+  AdcHandle.Init.DMAContinuousRequests = ENABLE;
+  AdcHandle.Init.Overrun               = ADC_OVR_DATA_OVERWRITTEN;
+  AdcHandle.Init.SamplingTimeCommon    = ADC_SAMPLETIME_7CYCLES_5;
+  if (HAL_ADC_GetState(&AdcHandle) == HAL_ADC_STATE_RESET)
+  {
+    ADCx_MspInit(&AdcHandle);
+  }
+  if (HAL_ADC_Init(&AdcHandle) != HAL_OK)
+  {
+    return 0;
+  }
+
+  channel.Channel      = DISCOVERY_ADC_CHANNEL;
+  channel.Rank         = ADC_RANK_CHANNEL_NUMBER;
+  channel.SamplingTime = ADC_SAMPLETIME_7CYCLES_5;
+  if ((HAL_ADC_ConfigChannel(&AdcHandle, &channel) != HAL_OK) ||
+      (HAL_ADCEx_Calibration_Start(&AdcHandle) != HAL_OK))
+  {
+    return 0;
+  }
+
+  AdcDmaLength = Length;
+  rate = ADCx_TimerInit(SampleRate);
+  if ((rate == 0U) ||
+      (HAL_ADC_Start_DMA(&AdcHandle, (uint32_t *)pBuffer, Length) != HAL_OK))
+  {
+    return 0;
+  }
+  if (HAL_TIM_Base_Start(&AdcTimHandle) != HAL_OK)
+  {
+    HAL_ADC_Stop_DMA(&AdcHandle);
+    return 0;
+  }
+  return rate;
+}
+
+/**
+  * @brief  Stops the trigger, then the ADC and its DMA.
+  * @retval None
+  */
+void SAMPLER_IO_Stop(void)
+{
+  HAL_TIM_Base_Stop(&AdcTimHandle);
+  HAL_ADC_Stop_DMA(&AdcHandle);
+}
+
+/**
+  * @brief  Index of the sample the DMA writes next.
+  * @retval 0 to Length - 1
+  */
+uint32_t SAMPLER_IO_GetPosition(void)
+{
+  /* CNDTR counts down from Length and reloads after the last transfer */
+  return AdcDmaLength - __HAL_DMA_GET_COUNTER(AdcHandle.DMA_Handle);
+}
+#endif /* HAL_ADC_MODULE_ENABLED && HAL_TIM_MODULE_ENABLED */
+
+#if defined(HAL_DAC_MODULE_ENABLED) && defined(HAL_TIM_MODULE_ENABLED)
+/******************************** LINK SYNTH **********************************/
+/**
+  * @brief  Sets DISCOVERY_DAC_CHANNEL up, output buffer on, updated at each
+  *         TIM6 update, and TIM6 to the rate.
+  * @param  SampleRate  updates per second.
+  * @retval The rate set, 0 on failure
+  */
+uint32_t SYNTH_IO_Init(uint32_t SampleRate)
+{
+  DAC_ChannelConfTypeDef channel;
+
+  DacHandle.Instance = DISCOVERY_DACx;
+  if (HAL_DAC_GetState(&DacHandle) == HAL_DAC_STATE_RESET)
+  {
+    DACx_MspInit(&DacHandle);
+  }
+  if (HAL_DAC_Init(&DacHandle) != HAL_OK)
+  {
+    return 0;
+  }
+  channel.DAC_Trigger      = DISCOVERY_DAC_TRIGGER;
+  channel.DAC_OutputBuffer = DAC_OUTPUTBUFFER_ENABLE;
+  if (HAL_DAC_ConfigChannel(&DacHandle, &channel, DISCOVERY_DAC_CHANNEL) != HAL_OK)
+  {
+    return 0;
+  }
+  return DACx_TimerInit(SampleRate);
+}
+
+/**
+  * @brief  Starts the DMA from a circular buffer of right-aligned 12-bit
+  *         samples, then the trigger.
+  * @param  pBuffer  buffer of Length samples, both halves handed back by the
+  *         callbacks in turn.
+  * @param  Length  number of samples of the buffer, even.
+  * @retval 0 if started, 1 on failure
+  */
+uint8_t SYNTH_IO_Start(uint16_t *pBuffer, uint32_t Length)
+{
+  DacDmaLength = Length;
+  if (HAL_DAC_Start_DMA(&DacHandle, DISCOVERY_DAC_CHANNEL, (uint32_t *)pBuffer, Length,
+                        DAC_ALIGN_12B_R) != HAL_OK)
+  {
+    return 1;
+  }
+  if (HAL_TIM_Base_Start(&DacTimHandle) != HAL_OK)
+  {
+    HAL_DAC_Stop_DMA(&DacHandle, DISCOVERY_DAC_CHANNEL);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Stops the trigger, then the DAC and its DMA.
+  * @retval None
+  */
+void SYNTH_IO_Stop(void)
+{
+  HAL_TIM_Base_Stop(&DacTimHandle);
+  HAL_DAC_Stop_DMA(&DacHandle, DISCOVERY_DAC_CHANNEL);
+}
+
+/**
+  * @brief  Index of the sample the DMA reads next.
+  * @retval 0 to Length - 1
+  */
+uint32_t SYNTH_IO_GetPosition(void)
+{
+  /* CNDTR counts down from Length and reloads after the last transfer */
+  return DacDmaLength - __HAL_DMA_GET_COUNTER(DacHandle.DMA_Handle1);
+}
+#endif /* HAL_DAC_MODULE_ENABLED && HAL_TIM_MODULE_ENABLED */
+
+#if defined(HAL_UART_MODULE_ENABLED)
+/******************************** LINK SPECTRUM *******************************/
+/**
+  * @brief  Sets USART3 up for transmission: 8 data bits, no parity, 1 stop
+  *         bit.
+  * @param  BaudRate  bits per second.
+  * @retval 0 if done, 1 on failure
+  */
+uint8_t SPECTRUM_IO_Init(uint32_t BaudRate)
+{
+  UartHandle.Instance                    = DISCOVERY_USARTx;
+  UartHandle.Init.BaudRate               = BaudRate;
+  UartHandle.Init.WordLength             = UART_WORDLENGTH_8B;
+  UartHandle.Init.StopBits               = UART_STOPBITS_1;
+  UartHandle.Init.Parity                 = UART_PARITY_NONE;
+  UartHandle.Init.Mode                   = UART_MODE_TX;
+  UartHandle.Init.HwFlowCtl              = UART_HWCONTROL_NONE;
+  UartHandle.Init.OverSampling           = UART_OVERSAMPLING_16;
+  UartHandle.Init.OneBitSampling         = UART_ONE_BIT_SAMPLE_DISABLE;
+  UartHandle.AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
+  if (HAL_UART_GetState(&UartHandle) == HAL_UART_STATE_RESET)
+  {
+    USARTx_MspInit(&UartHandle);
+  }
+  return (HAL_UART_Init(&UartHandle) == HAL_OK) ? 0U : 1U;
+}
+
+/**
+  * @brief  Starts the DMA transmission of a frame.
+  * @param  pData  bytes to send, valid until SPECTRUM_IO_TxCpltCallback().
+  * @param  Length  number of bytes.
+  * @retval 0 if started, 1 on failure
+  */
+uint8_t SPECTRUM_IO_Transmit(const uint8_t *pData, uint16_t Length)
+{
+  return (HAL_UART_Transmit_DMA(&UartHandle, pData, Length) == HAL_OK) ? 0U : 1U;
+}
+#endif /* HAL_UART_MODULE_ENABLED */
+
 /**
   * @}
   */
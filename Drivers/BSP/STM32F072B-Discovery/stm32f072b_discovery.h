@@ -166,6 +166,17 @@ typedef enum
    You may modify these timeout values depending on CPU frequency and application
    conditions (interrupts routines ...). */   
 #define SPIx_TIMEOUT_MAX                      ((uint32_t)0x1000)
+
+/*##################### SPI1 ###################################*/
+/* SPI display (ST7735 or HX8347D), transmit only: 12 MHz (PCLK / 4) */
+#define DISCOVERY_LCD_SPIx                    SPI1
+#define DISCOVERY_LCD_SPIx_CLOCK_ENABLE()     __HAL_RCC_SPI1_CLK_ENABLE()
+#define DISCOVERY_LCD_SPIx_GPIO_PORT          GPIOB                      /* GPIOB */
+#define DISCOVERY_LCD_SPIx_AF                 GPIO_AF0_SPI1
+#define DISCOVERY_LCD_SPIx_GPIO_CLK_ENABLE()  __HAL_RCC_GPIOB_CLK_ENABLE()
+#define DISCOVERY_LCD_SPIx_SCK_PIN            GPIO_PIN_3                  /* PB.03 */
+#define DISCOVERY_LCD_SPIx_MISO_PIN           GPIO_PIN_4                  /* PB.04 */
+#define DISCOVERY_LCD_SPIx_MOSI_PIN           GPIO_PIN_5                  /* PB.05 */
 #endif /* HAL_SPI_MODULE_ENABLED */
 
 #if defined(HAL_I2C_MODULE_ENABLED)
@@ -197,8 +208,25 @@ typedef enum
 
 #define DISCOVERY_I2Cx_TIMING                       0x40B32537
 
+/* Status reads before I2C_IO_Probe() gives up, about 1 ms at 48 MHz: ten
+   times an address byte at 100 kHz. Counted, not timed, as SysTick may be
+   the caller */
+#define DISCOVERY_I2Cx_PROBE_LOOPS                  5000U
+
 #define DISCOVERY_EEPROM_I2C_ADDRESS_A01           0xA0  
 
+/* STLM75 temperature sensor, external, on the same I2C2 bus (A2..A0 low) */
+#define DISCOVERY_TSENSOR_I2C_ADDRESS_A01          0x90
+
+/* STLM75 OS output, open drain, active low, on PC.03 with the internal
+   pull-up. EXTI line 3 shares its interrupt with the gyroscope INT2 line, and
+   so its priority (GYRO_INT_PREPRIO). */
+#define TSENSOR_OS_GPIO_PORT                       GPIOC                       /* GPIOC */
+#define TSENSOR_OS_GPIO_CLK_ENABLE()               __HAL_RCC_GPIOC_CLK_ENABLE()
+#define TSENSOR_OS_PIN                             GPIO_PIN_3                  /* PC.03 */
+#define TSENSOR_OS_EXTI_IRQn                       EXTI2_3_IRQn
+#define TSENSOR_OS_PREPRIO                         1
+
 #endif /* HAL_I2C_MODULE_ENABLED */
 
 /**
@@ -235,6 +263,38 @@ typedef enum
 #define GYRO_INT1_EXTI_IRQn              EXTI0_1_IRQn 
 #define GYRO_INT2_PIN                    GPIO_PIN_2                  /* PC.02 */
 #define GYRO_INT2_EXTI_IRQn              EXTI2_3_IRQn 
+#define GYRO_INT_PREPRIO                 1
+
+/* SPI2 DMA requests remapped to channels 6 and 7: channels 4 and 5 serve
+   I2C2. The interrupt is shared with the EEPROM DMA, and so is its priority. */
+#define DISCOVERY_GYRO_DMA_CHANNEL_RX    DMA1_Channel6
+#define DISCOVERY_GYRO_DMA_CHANNEL_TX    DMA1_Channel7
+#define DISCOVERY_GYRO_DMA_IRQn          DMA1_Channel4_5_6_7_IRQn
+
+/*##################### LCD ##########################*/
+/* Chip Select and Data/Command macro definition */
+#define LCD_CS_LOW()        HAL_GPIO_WritePin(LCD_CS_GPIO_PORT, LCD_CS_PIN, GPIO_PIN_RESET)
+#define LCD_CS_HIGH()       HAL_GPIO_WritePin(LCD_CS_GPIO_PORT, LCD_CS_PIN, GPIO_PIN_SET)
+#define LCD_DC_LOW()        HAL_GPIO_WritePin(LCD_DC_GPIO_PORT, LCD_DC_PIN, GPIO_PIN_RESET)
+#define LCD_DC_HIGH()       HAL_GPIO_WritePin(LCD_DC_GPIO_PORT, LCD_DC_PIN, GPIO_PIN_SET)
+
+/**
+  * @brief  LCD SPI Interface pins
+  */
+#define LCD_CS_GPIO_PORT             GPIOB                       /* GPIOB */
+#define LCD_CS_GPIO_CLK_ENABLE()     __HAL_RCC_GPIOB_CLK_ENABLE()
+#define LCD_CS_PIN                   GPIO_PIN_8                  /* PB.08 */
+#define LCD_DC_GPIO_PORT             GPIOB                       /* GPIOB */
+#define LCD_DC_GPIO_CLK_ENABLE()     __HAL_RCC_GPIOB_CLK_ENABLE()
+#define LCD_DC_PIN                   GPIO_PIN_9                  /* PB.09 */
+
+/* SPI1 transmit DMA on channel 3: the application calls HAL_DMA_IRQHandler()
+   for LcdSpiHandle.hdmatx from DMA1_Channel2_3_IRQHandler(). The longest
+   transfer, 65535 pixels, takes 88 ms. */
+#define DISCOVERY_LCD_DMA_CHANNEL_TX     DMA1_Channel3
+#define DISCOVERY_LCD_DMA_IRQn           DMA1_Channel2_3_IRQn
+#define DISCOVERY_LCD_DMA_PREPRIO        2
+#define LCD_DMA_TIMEOUT                  ((uint32_t)100)
 
 /*##################### EEPROM ##########################*/
 /**
@@ -251,6 +311,69 @@ typedef enum
 #define DISCOVERY_EEPROM_DMA_PREPRIO               0
 #define DISCOVERY_EEPROM_DMA_SUBPRIO               0
 
+/*##################### SAMPLER ##########################*/
+/**
+  * @brief  ADC input of the sampling pipeline, converted at each TIM3 update
+  *         (TRGO). The application calls HAL_DMA_IRQHandler() for
+  *         AdcHandle.DMA_Handle from DMA1_Channel1_IRQHandler().
+  */
+#define DISCOVERY_ADCx                             ADC1
+#define DISCOVERY_ADCx_CLK_ENABLE()                __HAL_RCC_ADC1_CLK_ENABLE()
+#define DISCOVERY_ADC_GPIO_PORT                    GPIOA                       /* GPIOA */
+#define DISCOVERY_ADC_GPIO_CLK_ENABLE()            __HAL_RCC_GPIOA_CLK_ENABLE()
+#define DISCOVERY_ADC_PIN                          GPIO_PIN_1                  /* PA.01 */
+#define DISCOVERY_ADC_CHANNEL                      ADC_CHANNEL_1
+#define DISCOVERY_ADC_TIMx                         TIM3
+#define DISCOVERY_ADC_TIMx_CLK_ENABLE()            __HAL_RCC_TIM3_CLK_ENABLE()
+#define DISCOVERY_ADC_DMA_CHANNEL                  DMA1_Channel1
+#define DISCOVERY_ADC_DMA_IRQn                     DMA1_Channel1_IRQn
+#define DISCOVERY_ADC_DMA_PREPRIO                  0
+
+/*##################### SPECTRUM ##########################*/
+/**
+  * @brief  USART3 of the spectrum analyzer, transmit only, on PC10: PB10 and
+  *         PB11 are the EEPROM I2C2 pins. Its transmit DMA request is
+  *         remapped to channel 2, beside the LCD one (channels 6 and 7 are
+  *         the gyroscope SPI2 ones). The application calls
+  *         HAL_DMA_IRQHandler() for UartHandle.hdmatx from
+  *         DMA1_Channel2_3_IRQHandler() and HAL_UART_IRQHandler() from
+  *         USART3_4_IRQHandler(): the end of a frame is the transmission
+  *         complete interrupt.
+  */
+#define DISCOVERY_USARTx                           USART3
+#define DISCOVERY_USARTx_CLK_ENABLE()              __HAL_RCC_USART3_CLK_ENABLE()
+#define DISCOVERY_USARTx_GPIO_PORT                 GPIOC                       /* GPIOC */
+#define DISCOVERY_USARTx_GPIO_CLK_ENABLE()         __HAL_RCC_GPIOC_CLK_ENABLE()
+#define DISCOVERY_USARTx_TX_PIN                    GPIO_PIN_10                 /* PC.10 */
+#define DISCOVERY_USARTx_AF                        GPIO_AF1_USART3
+#define DISCOVERY_USARTx_IRQn                      USART3_4_IRQn
+#define DISCOVERY_USARTx_DMA_CHANNEL_TX            DMA1_Channel2
+#define DISCOVERY_USARTx_DMA_REMAP                 DMA_REMAP_USART3_DMA_CH32
+#define DISCOVERY_USARTx_DMA_IRQn                  DMA1_Channel2_3_IRQn
+#define DISCOVERY_USARTx_PREPRIO                   DISCOVERY_LCD_DMA_PREPRIO
+
+/*##################### SYNTH ##########################*/
+/**
+  * @brief  DAC output of the synthesizer, updated at each TIM6 update (TRGO)
+  *         from DMA1 channel 3, the only one of DAC_CH1 and also the LCD
+  *         transmit one. The application calls HAL_DMA_IRQHandler() for
+  *         DacHandle.DMA_Handle1 from DMA1_Channel2_3_IRQHandler() and
+  *         HAL_DAC_IRQHandler() from TIM6_DAC_IRQHandler().
+  */
+#define DISCOVERY_DACx                             DAC1
+#define DISCOVERY_DACx_CLK_ENABLE()                __HAL_RCC_DAC1_CLK_ENABLE()
+#define DISCOVERY_DAC_GPIO_PORT                    GPIOA                       /* GPIOA */
+#define DISCOVERY_DAC_GPIO_CLK_ENABLE()            __HAL_RCC_GPIOA_CLK_ENABLE()
+#define DISCOVERY_DAC_PIN                          GPIO_PIN_4                  /* PA.04 */
+#define DISCOVERY_DAC_CHANNEL                      DAC_CHANNEL_1
+#define DISCOVERY_DAC_TRIGGER                      DAC_TRIGGER_T6_TRGO
+#define DISCOVERY_DAC_TIMx                         TIM6
+#define DISCOVERY_DAC_TIMx_CLK_ENABLE()            __HAL_RCC_TIM6_CLK_ENABLE()
+#define DISCOVERY_DAC_DMA_CHANNEL                  DMA1_Channel3
+#define DISCOVERY_DAC_DMA_IRQn                     DMA1_Channel2_3_IRQn
+#define DISCOVERY_DAC_IRQn                         TIM6_DAC_IRQn
+#define DISCOVERY_DAC_DMA_PREPRIO                  DISCOVERY_LCD_DMA_PREPRIO
+
 /**
   * @}
   */  
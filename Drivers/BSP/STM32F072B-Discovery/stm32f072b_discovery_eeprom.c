@@ -25,6 +25,15 @@
   *          @note In this driver, basic read and write functions (EEPROM_ReadBuffer() 
   *                and EEPROM_WritePage()) use Polling mode to perform the data transfer 
   *                to/from EEPROM memory.
+  *          @note BSP_EEPROM_ReadAsync() and BSP_EEPROM_WriteAsync() queue a request
+  *                and return at once. The transfers run on DMA and the end of each
+  *                write cycle is polled from BSP_EEPROM_AsyncTickHandler(), which
+  *                must be called from SysTick_Handler(). Do not mix them with the
+  *                blocking functions, the EEPROM cache or the key-value store.
+  *          @note A failed DMA transfer (NACK, bus error) releases the blocking
+  *                waits at once with EEPROMDataError set: they return EEPROM_FAIL
+  *                instead of timing out. BSP_EEPROM_ErrorCallback() tells the
+  *                cache.
   *             
   *     +-----------------------------------------------------------------+
   *     |               Pin assignment for M24LR64 EEPROM                 |
@@ -76,11 +85,41 @@ __IO uint16_t  EEPROMAddress = 0;
 __IO uint32_t  EEPROMTimeout = EEPROM_LONG_TIMEOUT;
 __IO uint16_t  EEPROMDataRead;
 __IO uint8_t*  EEPROMDataWritePointer;
+__IO uint8_t   EEPROMDataError;       /* Set when the last transfer failed */
 __IO uint8_t   EEPROMDataNum;
+
+/* Asynchronous requests: queue, current phase and its start tick */
+static EEPROM_RequestTypeDef* volatile  EEPROMQueueHead;
+static EEPROM_RequestTypeDef*           EEPROMQueueTail;
+static __IO uint32_t                    EEPROMAsyncState;
+static uint32_t                         EEPROMAsyncTick;
+static uint16_t                         EEPROMAsyncChunk;
 /**
   * @}
   */ 
 
+/** @defgroup STM32072B_DISCOVERY_EEPROM_Private_Constants Private Constants
+  * @{
+  */
+#define EEPROM_ASYNC_IDLE          0U    /* No request in progress */
+#define EEPROM_ASYNC_XFER          1U    /* DMA transfer in flight */
+#define EEPROM_ASYNC_WRITE_CYCLE   2U    /* Page sent, EEPROM programming it */
+#define EEPROM_ASYNC_RETRY         3U    /* Transfer refused, retry once the EEPROM acknowledges */
+/**
+  * @}
+  */
+
+/** @defgroup STM32072B_DISCOVERY_EEPROM_Private_Functions Private Functions
+  * @{
+  */
+static uint32_t EEPROM_Async_Submit(EEPROM_RequestTypeDef* pRequest, uint8_t* pBuffer, uint16_t Addr,
+                                    uint16_t Size, uint8_t Write, void (*Callback)(EEPROM_RequestTypeDef* pRequest));
+static void     EEPROM_Async_Start(void);
+static void     EEPROM_Async_Complete(uint32_t Status);
+/**
+  * @}
+  */
+
 /** @addtogroup STM32F072B_DISCOVERY_EEPROM_Exported_Functions
   * @{
   */
@@ -132,22 +171,33 @@ uint32_t BSP_EEPROM_ReadBuffer(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t* Nu
       variable to 0. User should check on this variable in order to know if the 
       DMA transfer has been complete or not. */
   EEPROMDataRead = *NumByteToRead;
+  EEPROMDataError = 0;
   
   if (EEPROM_IO_ReadData(EEPROMAddress, ReadAddr, (uint32_t) pBuffer, buffersize) != EEPROM_OK)
   {
     return EEPROM_FAIL;
   }
   
+  /* A single byte is read in polling mode and is already there */
+  if (buffersize == 1)
+  {
+    EEPROMDataRead = 0;
+  }
+
   /* Wait transfer through DMA to be complete */
   EEPROMTimeout = HAL_GetTick();
   while (EEPROMDataRead > 0)
   {
-    if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT)
+    if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT)
     {      
       BSP_EEPROM_TIMEOUT_UserCallback(); 
       return EEPROM_TIMEOUT;
     }
   }
+  if (EEPROMDataError != 0)
+  {
+    return EEPROM_FAIL;
+  }
 
   /* If all operations OK, return EEPROM_OK (0) */
   return EEPROM_OK;
@@ -189,9 +239,20 @@ uint32_t BSP_EEPROM_WritePage(uint8_t* pBuffer, uint16_t WriteAddr, uint8_t* Num
       variable to 0. User should check on this variable in order to know if the 
       DMA transfer has been complete or not. */
   EEPROMDataWritePointer = NumByteToWrite;  
+  EEPROMDataError = 0;
   
   status = EEPROM_IO_WriteData(EEPROMAddress, WriteAddr, (uint32_t) pBuffer, buffersize);
   
+  /* A single byte is written in polling mode: no DMA complete interrupt */
+  if ((status == EEPROM_OK) && (buffersize == 1))
+  {
+    *NumByteToWrite = 0;
+  }
+  if ((status != EEPROM_OK) || (buffersize == 1))
+  {
+    EEPROMDataWritePointer = NULL;
+  }
+
   /* If all operations OK, return EEPROM_OK (0) */
   return status;
 }
@@ -232,11 +293,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
       EEPROMTimeout = HAL_GetTick();
       while (EEPROMDataNum > 0)
       {
-        if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+        if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
           BSP_EEPROM_TIMEOUT_UserCallback(); 
           return EEPROM_TIMEOUT;
         }
       }
+      if (EEPROMDataError != 0) return EEPROM_FAIL;
       if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;
     }
     /*!< If NumByteToWrite > EEPROM_PAGESIZE */
@@ -254,11 +316,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
         EEPROMTimeout = HAL_GetTick();
         while (EEPROMDataNum > 0)
         {
-          if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+          if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
             BSP_EEPROM_TIMEOUT_UserCallback(); 
             return EEPROM_TIMEOUT;
           }
         }
+        if (EEPROMDataError != 0) return EEPROM_FAIL;
         if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;
         WriteAddr +=  EEPROM_PAGESIZE;
         pBuffer += EEPROM_PAGESIZE;
@@ -276,11 +339,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
         EEPROMTimeout = HAL_GetTick();
         while (EEPROMDataNum > 0)
         {
-          if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+          if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
             BSP_EEPROM_TIMEOUT_UserCallback(); 
             return EEPROM_TIMEOUT;
           }
         }
+        if (EEPROMDataError != 0) return EEPROM_FAIL;
         if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;
       }
     }
@@ -306,11 +370,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
         EEPROMTimeout = HAL_GetTick();
         while (EEPROMDataNum > 0)
         {
-          if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+          if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
             BSP_EEPROM_TIMEOUT_UserCallback(); 
             return EEPROM_TIMEOUT;
           }
           }
+        if (EEPROMDataError != 0) return EEPROM_FAIL;
         if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;      
         
         /* Store the number of data to be written */
@@ -324,11 +389,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
         EEPROMTimeout = HAL_GetTick();
         while (EEPROMDataNum > 0)
         {
-          if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+          if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
             BSP_EEPROM_TIMEOUT_UserCallback(); 
             return EEPROM_TIMEOUT;
           }
         }
+        if (EEPROMDataError != 0) return EEPROM_FAIL;
         if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;        
       }      
       else      
@@ -343,11 +409,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
         EEPROMTimeout = HAL_GetTick();
         while (EEPROMDataNum > 0)
         {
-          if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+          if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
             BSP_EEPROM_TIMEOUT_UserCallback(); 
             return EEPROM_TIMEOUT;
           }
         }
+        if (EEPROMDataError != 0) return EEPROM_FAIL;
         if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;        
           }
         }
@@ -356,7 +423,7 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
     {
       NumByteToWrite -= count;
       numofpage =  NumByteToWrite / EEPROM_PAGESIZE;
-      numofsingle = numofsingle % EEPROM_PAGESIZE;
+      numofsingle = NumByteToWrite % EEPROM_PAGESIZE;
       
       if(count != 0)
       {  
@@ -370,11 +437,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
         EEPROMTimeout = HAL_GetTick();
         while (EEPROMDataNum > 0)
         {
-          if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+          if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
             BSP_EEPROM_TIMEOUT_UserCallback(); 
             return EEPROM_TIMEOUT;
           }
         }
+        if (EEPROMDataError != 0) return EEPROM_FAIL;
         if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;
         WriteAddr += count;
         pBuffer += count;
@@ -392,11 +460,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
         EEPROMTimeout = HAL_GetTick();
         while (EEPROMDataNum > 0)
         {
-          if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+          if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
             BSP_EEPROM_TIMEOUT_UserCallback();
             return EEPROM_TIMEOUT;
           }
         }
+        if (EEPROMDataError != 0) return EEPROM_FAIL;
         if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;
         WriteAddr +=  EEPROM_PAGESIZE;
         pBuffer += EEPROM_PAGESIZE;  
@@ -413,11 +482,12 @@ uint32_t BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t N
         EEPROMTimeout = HAL_GetTick();
         while (EEPROMDataNum > 0)
         {
-          if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT) {
+          if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT) {
             BSP_EEPROM_TIMEOUT_UserCallback(); 
             return EEPROM_TIMEOUT;
         }
       }
+        if (EEPROMDataError != 0) return EEPROM_FAIL;
         if (BSP_EEPROM_WaitEepromStandbyState() != EEPROM_OK) return EEPROM_FAIL;
       }
     }
@@ -448,7 +518,7 @@ uint32_t BSP_EEPROM_WaitEepromStandbyState(void)
 
   do
   {
-    if((HAL_GetTick() - EEPROMTimeout) < EEPROM_LONG_TIMEOUT)
+    if((HAL_GetTick() - EEPROMTimeout) > EEPROM_LONG_TIMEOUT)
     {
       BSP_EEPROM_TIMEOUT_UserCallback(); 
       return EEPROM_TIMEOUT;
@@ -468,23 +538,201 @@ uint32_t BSP_EEPROM_WaitEepromStandbyState(void)
 }
 
 /**
-  * @brief  Memory Tx Transfer completed callbacks.
-  * @param  hi2c I2C handle
+  * @brief  Starts reading a block of data from the EEPROM in the background.
+  * @note   Requests are served in submission order. Completion is signalled by
+  *         pRequest->Status leaving EEPROM_BUSY and, when Callback is not
+  *         NULL, by a call to Callback from interrupt context. The request
+  *         and the buffer must stay valid until then.
+  * @param  pRequest  request handle, owned by the driver until completion.
+  * @param  pBuffer  pointer to the buffer that receives the data.
+  * @param  ReadAddr  EEPROM's internal address to start reading from.
+  * @param  NumByteToRead  number of bytes to read.
+  * @param  Callback  completion callback, or NULL to poll the handle.
+  * @retval EEPROM_OK (0) if the request is queued, EEPROM_FAIL if it is out of
+  *         range
+  */
+uint32_t BSP_EEPROM_ReadAsync(EEPROM_RequestTypeDef* pRequest, uint8_t* pBuffer, uint16_t ReadAddr,
+                              uint16_t NumByteToRead, void (*Callback)(EEPROM_RequestTypeDef* pRequest))
+{
+  return EEPROM_Async_Submit(pRequest, pBuffer, ReadAddr, NumByteToRead, 0, Callback);
+}
+
+/**
+  * @brief  Starts writing a block of data to the EEPROM in the background.
+  * @note   The data is sent page by page with HAL_I2C_Mem_Write_DMA(). The
+  *         end of each write cycle is detected by ACK polling from
+  *         BSP_EEPROM_AsyncTickHandler(), so the CPU is free meanwhile.
+  *         Completion is signalled as for BSP_EEPROM_ReadAsync(), once the
+  *         last page is programmed.
+  * @param  pRequest  request handle, owned by the driver until completion.
+  * @param  pBuffer  pointer to the data, left untouched until completion.
+  * @param  WriteAddr  EEPROM's internal address to write to.
+  * @param  NumByteToWrite  number of bytes to write.
+  * @param  Callback  completion callback, or NULL to poll the handle.
+  * @retval EEPROM_OK (0) if the request is queued, EEPROM_FAIL if it is out of
+  *         range
+  */
+uint32_t BSP_EEPROM_WriteAsync(EEPROM_RequestTypeDef* pRequest, uint8_t* pBuffer, uint16_t WriteAddr,
+                               uint16_t NumByteToWrite, void (*Callback)(EEPROM_RequestTypeDef* pRequest))
+{
+  return EEPROM_Async_Submit(pRequest, pBuffer, WriteAddr, NumByteToWrite, 1, Callback);
+}
+
+/**
+  * @brief  Polls an asynchronous request.
+  * @param  pRequest  request handle.
+  * @retval EEPROM_BUSY while queued or in progress, then EEPROM_OK (0),
+  *         EEPROM_FAIL or EEPROM_TIMEOUT
+  */
+uint32_t BSP_EEPROM_AsyncStatus(EEPROM_RequestTypeDef* pRequest)
+{
+  return pRequest->Status;
+}
+
+/**
+  * @brief  Timer side of the asynchronous requests: ACK polling during write
+  *         cycles, retries and timeouts.
+  * @note   Call every millisecond, from SysTick_Handler() after HAL_IncTick().
+  *         Each poll is a single addressing attempt on the bus.
   * @retval None
   */
-void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+void BSP_EEPROM_AsyncTickHandler(void)
 {
-  *EEPROMDataWritePointer = 0;  
+  uint32_t elapsed = HAL_GetTick() - EEPROMAsyncTick;
+  HAL_StatusTypeDef ready;
+
+  switch (EEPROMAsyncState)
+  {
+  case EEPROM_ASYNC_XFER:
+    if (elapsed > EEPROM_LONG_TIMEOUT)
+    {
+      EEPROM_Async_Complete(EEPROM_TIMEOUT);
+    }
+    break;
+
+  case EEPROM_ASYNC_WRITE_CYCLE:
+  case EEPROM_ASYNC_RETRY:
+    if ((EEPROMAsyncState == EEPROM_ASYNC_WRITE_CYCLE) && (elapsed < EEPROM_ASYNC_FIRST_POLL))
+    {
+      break;
+    }
+    ready = EEPROM_IO_Probe(EEPROMAddress);
+    if (ready == HAL_OK)
+    {
+      if (EEPROMQueueHead->Done == EEPROMQueueHead->Size)
+      {
+        EEPROM_Async_Complete(EEPROM_OK);
+      }
+      else
+      {
+        EEPROM_Async_Start();
+      }
+    }
+    else if (elapsed > EEPROM_LONG_TIMEOUT)
+    {
+      EEPROM_Async_Complete(EEPROM_TIMEOUT);
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+/**
+  * @brief  EEPROM DMA write completed, from the link layer.
+  * @retval None
+  */
+void EEPROM_IO_TxCpltCallback(void)
+{
+  if (EEPROMAsyncState == EEPROM_ASYNC_XFER)
+  {
+    /* The EEPROM now programs the page and does not acknowledge until done */
+    EEPROMQueueHead->Done += EEPROMAsyncChunk;
+    EEPROMAsyncState = EEPROM_ASYNC_WRITE_CYCLE;
+    EEPROMAsyncTick = HAL_GetTick();
+    return;
+  }
+  /* Not set when the link layer is used directly; dropped once done, so a
+     later failed read cannot clear a counter that is gone */
+  if (EEPROMDataWritePointer != NULL)
+  {
+    *EEPROMDataWritePointer = 0;
+    EEPROMDataWritePointer = NULL;
+  }
+  BSP_EEPROM_TxCpltCallback();
 }
 
 /**
-  * @brief  Memory Rx Transfer completed callbacks.
-  * @param  hi2c I2C handle
+  * @brief  EEPROM DMA read completed, from the link layer.
   * @retval None
   */
-void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+void EEPROM_IO_RxCpltCallback(void)
 {
+  if (EEPROMAsyncState == EEPROM_ASYNC_XFER)
+  {
+    EEPROMQueueHead->Done += EEPROMAsyncChunk;
+    EEPROM_Async_Complete(EEPROM_OK);
+    return;
+  }
   EEPROMDataRead = 0;
+  BSP_EEPROM_RxCpltCallback();
+}
+
+/**
+  * @brief  EEPROM DMA transfer failed, from the link layer.
+  * @note   A transfer addressed to the EEPROM while it is still programming
+  *         is not acknowledged: an asynchronous request retries it once the
+  *         EEPROM answers again. Any other transfer is released as if done,
+  *         with EEPROMDataError set, and BSP_EEPROM_ErrorCallback() called.
+  * @retval None
+  */
+void EEPROM_IO_ErrorCallback(void)
+{
+  if (EEPROMAsyncState == EEPROM_ASYNC_XFER)
+  {
+    EEPROMAsyncState = EEPROM_ASYNC_RETRY;
+    return;
+  }
+  EEPROMDataError = 1;
+  EEPROMDataRead = 0;
+  if (EEPROMDataWritePointer != NULL)
+  {
+    *EEPROMDataWritePointer = 0;
+    EEPROMDataWritePointer = NULL;
+  }
+  BSP_EEPROM_ErrorCallback();
+}
+
+/**
+  * @brief  EEPROM page write completed callback.
+  * @note   Called once the page data has been sent; the EEPROM then starts its
+  *         internal write cycle. Overridden by the EEPROM cache.
+  * @retval None
+  */
+__weak void BSP_EEPROM_TxCpltCallback(void)
+{
+}
+
+/**
+  * @brief  EEPROM read completed callback.
+  * @note   Called once the requested data has been received. Overridden by
+  *         the EEPROM cache.
+  * @retval None
+  */
+__weak void BSP_EEPROM_RxCpltCallback(void)
+{
+}
+
+/**
+  * @brief  EEPROM transfer failed callback.
+  * @note   Called from interrupt context when a page write or a multi-byte
+  *         read was not acknowledged or hit a bus error. Overridden by the
+  *         EEPROM cache.
+  * @retval None
+  */
+__weak void BSP_EEPROM_ErrorCallback(void)
+{
 }
 
 /**
@@ -499,6 +747,115 @@ __weak uint32_t BSP_EEPROM_TIMEOUT_UserCallback(void)
   }
 }
 
+/**
+  * @}
+  */
+
+/** @addtogroup STM32072B_DISCOVERY_EEPROM_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Queues an asynchronous request and starts it if the bus is idle.
+  */
+static uint32_t EEPROM_Async_Submit(EEPROM_RequestTypeDef* pRequest, uint8_t* pBuffer, uint16_t Addr,
+                                    uint16_t Size, uint8_t Write, void (*Callback)(EEPROM_RequestTypeDef* pRequest))
+{
+  uint32_t primask;
+
+  if (((uint32_t)Addr + Size) > (uint32_t)EEPROM_MAX_SIZE)
+  {
+    pRequest->Status = EEPROM_FAIL;
+    return EEPROM_FAIL;
+  }
+  pRequest->pBuffer = pBuffer;
+  pRequest->Address = Addr;
+  pRequest->Size = Size;
+  pRequest->Done = 0;
+  pRequest->Write = Write;
+  pRequest->Callback = Callback;
+  pRequest->pNext = NULL;
+  pRequest->Status = EEPROM_BUSY;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (EEPROMQueueHead == NULL)
+  {
+    EEPROMQueueHead = pRequest;
+  }
+  else
+  {
+    EEPROMQueueTail->pNext = pRequest;
+  }
+  EEPROMQueueTail = pRequest;
+  if ((EEPROMAsyncState == EEPROM_ASYNC_IDLE) && (EEPROMQueueHead == pRequest))
+  {
+    EEPROM_Async_Start();
+  }
+  __set_PRIMASK(primask);
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Starts the next transfer of the request at the queue head: the
+  *         rest of the block for a read, the rest of the page for a write.
+  *         Runs with interrupts masked or from interrupt context.
+  */
+static void EEPROM_Async_Start(void)
+{
+  EEPROM_RequestTypeDef* req = EEPROMQueueHead;
+  uint32_t remaining = req->Size - req->Done;
+  uint16_t addr = (uint16_t)(req->Address + req->Done);
+  uint32_t status;
+
+  if (remaining == 0)
+  {
+    EEPROM_Async_Complete(EEPROM_OK);
+    return;
+  }
+  if ((req->Write != 0) && (remaining > (EEPROM_PAGESIZE - (addr % EEPROM_PAGESIZE))))
+  {
+    remaining = EEPROM_PAGESIZE - (addr % EEPROM_PAGESIZE);
+  }
+  EEPROMAsyncChunk = (uint16_t)remaining;
+  EEPROMAsyncState = EEPROM_ASYNC_XFER;
+  EEPROMAsyncTick = HAL_GetTick();
+  if (req->Write != 0)
+  {
+    status = EEPROM_IO_WriteDataDMA(EEPROMAddress, addr, (uint32_t)(req->pBuffer + req->Done), remaining);
+  }
+  else
+  {
+    status = EEPROM_IO_ReadDataDMA(EEPROMAddress, addr, (uint32_t)(req->pBuffer + req->Done), remaining);
+  }
+  if ((status != HAL_OK) && (EEPROMAsyncState == EEPROM_ASYNC_XFER))
+  {
+    /* Bus busy or reset by the link layer: try again from the tick */
+    EEPROMAsyncState = EEPROM_ASYNC_RETRY;
+  }
+}
+
+/**
+  * @brief  Retires the request at the queue head and starts the next one.
+  */
+static void EEPROM_Async_Complete(uint32_t Status)
+{
+  EEPROM_RequestTypeDef* req = EEPROMQueueHead;
+
+  EEPROMQueueHead = req->pNext;
+  EEPROMAsyncState = EEPROM_ASYNC_IDLE;
+  req->Status = Status;
+  if (req->Callback != NULL)
+  {
+    /* May submit again */
+    req->Callback(req);
+  }
+  if ((EEPROMQueueHead != NULL) && (EEPROMAsyncState == EEPROM_ASYNC_IDLE))
+  {
+    EEPROM_Async_Start();
+  }
+}
+
 /**
   * @}
   */
@@ -58,11 +58,40 @@ This timeout is based on systick set to 1ms*/
 #define EEPROM_OK                    0
 #define EEPROM_FAIL                  1
 #define EEPROM_TIMEOUT               2
+#define EEPROM_BUSY                  3
+
+/* Ticks (ms) from the end of an asynchronous page write to the first ACK 
+   poll; the M24LR64 write cycle lasts up to 5 ms */
+#ifndef EEPROM_ASYNC_FIRST_POLL
+#define EEPROM_ASYNC_FIRST_POLL      4
+#endif
 
 /**
   * @}
   */ 
 
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_Exported_Types Exported Types
+  * @{
+  */
+/* Asynchronous request handle: filled in by BSP_EEPROM_ReadAsync() and
+   BSP_EEPROM_WriteAsync(), owned by the driver while Status is EEPROM_BUSY */
+typedef struct __EEPROM_RequestTypeDef
+{
+  uint8_t*                         pBuffer;
+  uint16_t                         Address;
+  uint16_t                         Size;
+  uint16_t                         Done;        /* Bytes transferred so far */
+  uint8_t                          Write;
+  __IO uint32_t                    Status;      /* EEPROM_BUSY until complete */
+  void                           (*Callback)(struct __EEPROM_RequestTypeDef* pRequest);
+  void*                            pContext;    /* Free for the caller */
+  struct __EEPROM_RequestTypeDef*  pNext;
+} EEPROM_RequestTypeDef;
+
+/**
+  * @}
+  */
+
 /** @defgroup STM32F072B_DISCOVERY_EEPROM_Exported_Functions Exported Functions
   * @{
   */ 
@@ -71,6 +100,12 @@ uint32_t          BSP_EEPROM_ReadBuffer(uint8_t* pBuffer, uint16_t ReadAddr, uin
 uint32_t          BSP_EEPROM_WritePage(uint8_t* pBuffer, uint16_t WriteAddr, uint8_t* NumByteToWrite);
 uint32_t          BSP_EEPROM_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite);
 uint32_t          BSP_EEPROM_WaitEepromStandbyState(void);
+uint32_t          BSP_EEPROM_ReadAsync(EEPROM_RequestTypeDef* pRequest, uint8_t* pBuffer, uint16_t ReadAddr,
+                                       uint16_t NumByteToRead, void (*Callback)(EEPROM_RequestTypeDef* pRequest));
+uint32_t          BSP_EEPROM_WriteAsync(EEPROM_RequestTypeDef* pRequest, uint8_t* pBuffer, uint16_t WriteAddr,
+                                        uint16_t NumByteToWrite, void (*Callback)(EEPROM_RequestTypeDef* pRequest));
+uint32_t          BSP_EEPROM_AsyncStatus(EEPROM_RequestTypeDef* pRequest);
+void              BSP_EEPROM_AsyncTickHandler(void);
 
 /* USER Callbacks: This function is declared as __weak in EEPROM driver and 
    should be implemented into user application.  
@@ -78,12 +113,25 @@ uint32_t          BSP_EEPROM_WaitEepromStandbyState(void);
    occur during communication (waiting on an event that doesn't occur, bus 
    errors, busy devices ...). */
 __weak uint32_t   BSP_EEPROM_TIMEOUT_UserCallback(void);
+/* BSP_EEPROM_TxCpltCallback() and BSP_EEPROM_RxCpltCallback() are called from
+   the I2C DMA complete interrupts at the end of each page write and of each
+   multi-byte read, BSP_EEPROM_ErrorCallback() when one of them failed. */
+void              BSP_EEPROM_TxCpltCallback(void);
+void              BSP_EEPROM_RxCpltCallback(void);
+void              BSP_EEPROM_ErrorCallback(void);
 
 /* Link function for I2C EEPROM peripheral */
 void              EEPROM_IO_Init(void);
 uint32_t          EEPROM_IO_WriteData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize);
 uint32_t          EEPROM_IO_ReadData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize);
 HAL_StatusTypeDef EEPROM_IO_IsDeviceReady(uint16_t DevAddress, uint32_t Trials);
+uint32_t          EEPROM_IO_WriteDataDMA(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize);
+uint32_t          EEPROM_IO_ReadDataDMA(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize);
+HAL_StatusTypeDef EEPROM_IO_Probe(uint16_t DevAddress);
+/* Called by the link layer at the end of the DMA transfers */
+void              EEPROM_IO_TxCpltCallback(void);
+void              EEPROM_IO_RxCpltCallback(void);
+void              EEPROM_IO_ErrorCallback(void);
 
 /**
   * @}
@@ -0,0 +1,770 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_eeprom_cache.c
+  * @brief   This file provides a RAM write-back cache in front of the I2C
+  *          M24LR64 EEPROM driver.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - Writes land in RAM and return immediately. Dirty bytes are
+  *             coalesced per EEPROM page, so several small writes to the same
+  *             page cost a single write cycle, and rewriting a byte before it
+  *             was flushed costs nothing.
+  *           - Dirty pages are programmed in the background, one DMA burst
+  *             per page. The burst is started from BSP_EEPROM_CacheProcess()
+  *             once the previous self-timed write cycle (tW) has elapsed, and
+  *             its end is signalled by the I2C Tx complete callback.
+  *           - A burst the EEPROM refuses (still programming) or that hits a
+  *             bus error is reported by BSP_EEPROM_ErrorCallback(): its bytes
+  *             are dirty again and go out after another tW. After
+  *             EEPROM_CACHE_RETRIES failures in a row the blocking calls
+  *             return EEPROM_FAIL; the background flush keeps retrying.
+  *           - BSP_EEPROM_CacheProcess() must be called periodically, ideally
+  *             from SysTick_Handler() after HAL_IncTick().
+  *           - While the cache is in use all EEPROM accesses must go through
+  *             it: it assumes it owns the I2C bus between bursts.
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_eeprom_cache.h"
+#include <string.h>
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_EEPROM_CACHE
+  * @brief      Write-combining cache for the I2C EEPROM driver.
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_CACHE_Private_Types Private Types
+  * @{
+  */
+#if (EEPROM_CACHE_LINE_SIZE > 16) || ((EEPROM_CACHE_LINE_SIZE % EEPROM_PAGESIZE) != 0)
+#error "EEPROM_CACHE_LINE_SIZE must be a multiple of EEPROM_PAGESIZE and at most 16"
+#endif
+
+#define CACHE_NO_TAG              0xFFFFU
+#define CACHE_LINE_MASK           ((uint16_t)((1UL << EEPROM_CACHE_LINE_SIZE) - 1U))
+#define CACHE_PAGE_MASK           ((uint16_t)((1UL << EEPROM_PAGESIZE) - 1U))
+
+typedef enum
+{
+  CACHE_IDLE = 0,       /* EEPROM ready, no burst in flight */
+  CACHE_WRITING,        /* DMA burst in flight */
+  CACHE_WRITE_CYCLE,    /* Burst done, EEPROM busy programming the page */
+  CACHE_READING         /* Line fill in progress, bursts held off */
+} CacheStateTypeDef;
+
+typedef struct
+{
+  uint16_t Tag;         /* EEPROM address of byte 0, CACHE_NO_TAG if unused */
+  uint16_t Valid;       /* One bit per byte holding EEPROM content */
+  uint16_t Dirty;       /* One bit per byte not yet programmed */
+  uint16_t Age;         /* LRU stamp */
+  uint8_t  Data[EEPROM_CACHE_LINE_SIZE];
+} CacheLineTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_CACHE_Private_Variables Private Variables
+  * @{
+  */
+static CacheLineTypeDef          CacheLines[EEPROM_CACHE_LINES];
+static EEPROM_CacheStatsTypeDef  CacheStats;
+static __IO CacheStateTypeDef    CacheState = CACHE_IDLE;
+static __IO uint32_t             CacheTick;
+static __IO uint8_t              CacheHold;
+static __IO uint8_t              CacheReadPending;
+static __IO uint8_t              CacheReadFailed;
+static __IO uint8_t              CacheFailures;     /* Failed bursts in a row */
+static uint16_t                  CacheClock;
+static uint8_t                   CacheNextLine;
+
+/* Burst in flight: data is snapshotted so the line may be rewritten meanwhile */
+static uint8_t                   BurstData[EEPROM_PAGESIZE];
+static __IO uint8_t              BurstCount;
+static uint16_t                  BurstAddr;
+static uint8_t                   BurstLine;
+static uint16_t                  BurstMask;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_CACHE_Private_Functions Private Functions
+  * @{
+  */
+static CacheLineTypeDef* EEPROM_Cache_Find(uint16_t Tag);
+static CacheLineTypeDef* EEPROM_Cache_Allocate(uint16_t Tag, uint32_t AllowDirty);
+static uint32_t          EEPROM_Cache_Fill(CacheLineTypeDef* pLine, uint16_t Tag);
+static uint32_t          EEPROM_Cache_ReadEeprom(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t NumByteToRead);
+static uint32_t          EEPROM_Cache_PrepareBurst(void);
+static void              EEPROM_Cache_StartBurst(void);
+static void              EEPROM_Cache_WaitIdle(void);
+static void              EEPROM_Cache_PollReady(void);
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_EEPROM_CACHE_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Initializes the EEPROM driver and empties the cache.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_CacheInit(void)
+{
+  BSP_EEPROM_CacheInvalidate();
+  memset(&CacheStats, 0, sizeof(CacheStats));
+  CacheState = CACHE_IDLE;
+  CacheFailures = 0;
+  return BSP_EEPROM_Init();
+}
+
+/**
+  * @brief  Reads a block of data through the cache.
+  * @note   Lines missing from the cache are fetched from the EEPROM. A fetch
+  *         has to wait for the write cycle in progress, if any, to end.
+  * @param  pBuffer  pointer to the buffer that receives the data.
+  * @param  ReadAddr  EEPROM's internal address to start reading from.
+  * @param  NumByteToRead  number of bytes to read.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_CacheRead(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t NumByteToRead)
+{
+  CacheLineTypeDef* line;
+  uint16_t tag, offset, count, need;
+
+  if ((uint32_t)ReadAddr + NumByteToRead > EEPROM_MAX_SIZE)
+  {
+    return EEPROM_FAIL;
+  }
+
+  while (NumByteToRead > 0)
+  {
+    tag    = ReadAddr - (ReadAddr % EEPROM_CACHE_LINE_SIZE);
+    offset = ReadAddr - tag;
+    count  = EEPROM_CACHE_LINE_SIZE - offset;
+    if (count > NumByteToRead)
+    {
+      count = NumByteToRead;
+    }
+    need = (uint16_t)(((1UL << count) - 1U) << offset);
+
+    line = EEPROM_Cache_Find(tag);
+    if ((line != NULL) && ((line->Valid & need) == need))
+    {
+      CacheStats.ReadHits++;
+    }
+    else
+    {
+      CacheStats.ReadMisses++;
+      if (line == NULL)
+      {
+        line = EEPROM_Cache_Allocate(tag, 0);
+      }
+      if (line == NULL)
+      {
+        /* Every line holds dirty data: read around the cache */
+        uint32_t status;
+
+        EEPROM_Cache_WaitIdle();
+        status = EEPROM_Cache_ReadEeprom(pBuffer, ReadAddr, count);
+        CacheState = CACHE_IDLE;
+        if (status != EEPROM_OK)
+        {
+          return status;
+        }
+        pBuffer += count;
+        ReadAddr += count;
+        NumByteToRead -= count;
+        continue;
+      }
+      if (EEPROM_Cache_Fill(line, tag) != EEPROM_OK)
+      {
+        return EEPROM_FAIL;
+      }
+    }
+
+    line->Age = ++CacheClock;
+    memcpy(pBuffer, &line->Data[offset], count);
+    pBuffer += count;
+    ReadAddr += count;
+    NumByteToRead -= count;
+  }
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Writes a block of data into the cache.
+  * @note   The data is programmed into the EEPROM later, in the background.
+  *         This call only blocks when every cache line already holds dirty
+  *         data, until the least recently used one has been flushed.
+  * @param  pBuffer  pointer to the data to be written.
+  * @param  WriteAddr  EEPROM's internal address to write to.
+  * @param  NumByteToWrite  number of bytes to write.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_CacheWrite(const uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite)
+{
+  CacheLineTypeDef* line;
+  uint16_t tag, offset, count, mask;
+  uint32_t primask;
+
+  if ((uint32_t)WriteAddr + NumByteToWrite > EEPROM_MAX_SIZE)
+  {
+    return EEPROM_FAIL;
+  }
+
+  CacheStats.WriteBytes += NumByteToWrite;
+  while (NumByteToWrite > 0)
+  {
+    tag    = WriteAddr - (WriteAddr % EEPROM_CACHE_LINE_SIZE);
+    offset = WriteAddr - tag;
+    count  = EEPROM_CACHE_LINE_SIZE - offset;
+    if (count > NumByteToWrite)
+    {
+      count = NumByteToWrite;
+    }
+    mask = (uint16_t)(((1UL << count) - 1U) << offset);
+
+    line = EEPROM_Cache_Find(tag);
+    if (line == NULL)
+    {
+      line = EEPROM_Cache_Allocate(tag, 1);
+      if (line == NULL)
+      {
+        return (CacheFailures > EEPROM_CACHE_RETRIES) ? EEPROM_FAIL : EEPROM_TIMEOUT;
+      }
+    }
+
+    /* The burst engine snapshots data and clears dirty bits from interrupt
+       context: update both atomically with respect to it. */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(&line->Data[offset], pBuffer, count);
+    line->Valid |= mask;
+    line->Dirty |= mask;
+    line->Age = ++CacheClock;
+    __set_PRIMASK(primask);
+
+    pBuffer += count;
+    WriteAddr += count;
+    NumByteToWrite -= count;
+  }
+
+  BSP_EEPROM_CacheProcess();
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Waits until every dirty byte has been programmed into the EEPROM.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_CacheFlush(void)
+{
+  uint32_t tickstart = HAL_GetTick();
+  uint32_t progress = CacheStats.WriteCycles;
+
+  /* Each call gets EEPROM_CACHE_RETRIES retries */
+  CacheFailures = 0;
+  while ((BSP_EEPROM_CacheIsClean() == 0) || (CacheState != CACHE_IDLE))
+  {
+    EEPROM_Cache_PollReady();
+    BSP_EEPROM_CacheProcess();
+    if (CacheFailures > EEPROM_CACHE_RETRIES)
+    {
+      return EEPROM_FAIL;
+    }
+    if (CacheStats.WriteCycles != progress)
+    {
+      progress = CacheStats.WriteCycles;
+      tickstart = HAL_GetTick();
+    }
+    else if ((HAL_GetTick() - tickstart) > EEPROM_LONG_TIMEOUT)
+    {
+      BSP_EEPROM_TIMEOUT_UserCallback();
+      return EEPROM_TIMEOUT;
+    }
+  }
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Tells whether the cache holds data not yet programmed.
+  * @retval 1 if no dirty bytes remain, 0 otherwise.
+  */
+uint32_t BSP_EEPROM_CacheIsClean(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < EEPROM_CACHE_LINES; i++)
+  {
+    if (CacheLines[i].Dirty != 0)
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Drops every cache line, including dirty ones.
+  * @retval None
+  */
+void BSP_EEPROM_CacheInvalidate(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < EEPROM_CACHE_LINES; i++)
+  {
+    CacheLines[i].Tag = CACHE_NO_TAG;
+    CacheLines[i].Valid = 0;
+    CacheLines[i].Dirty = 0;
+    CacheLines[i].Age = 0;
+  }
+}
+
+/**
+  * @brief  Advances the background flush.
+  * @note   Call every millisecond (SysTick) and whenever convenient. Starts the
+  *         next page burst once the EEPROM write cycle has elapsed.
+  * @retval None
+  */
+void BSP_EEPROM_CacheProcess(void)
+{
+  uint32_t start = 0;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+
+  if ((CacheState == CACHE_WRITING) && ((HAL_GetTick() - CacheTick) > EEPROM_LONG_TIMEOUT))
+  {
+    /* Lost completion (bus error): give the bytes back and retry */
+    CacheLines[BurstLine].Dirty |= BurstMask;
+    CacheStats.Errors++;
+    CacheFailures++;
+    CacheState = CACHE_IDLE;
+  }
+  if ((CacheState == CACHE_WRITE_CYCLE) && ((HAL_GetTick() - CacheTick) > EEPROM_CACHE_WRITE_CYCLE))
+  {
+    CacheState = CACHE_IDLE;
+  }
+  if ((CacheState == CACHE_IDLE) && (CacheHold == 0))
+  {
+    start = EEPROM_Cache_PrepareBurst();
+  }
+
+  __set_PRIMASK(primask);
+
+  if (start != 0)
+  {
+    EEPROM_Cache_StartBurst();
+  }
+}
+
+/**
+  * @brief  Returns the cache statistics.
+  * @param  pStats  pointer to the structure receiving the counters.
+  * @retval None
+  */
+void BSP_EEPROM_CacheGetStats(EEPROM_CacheStatsTypeDef* pStats)
+{
+  *pStats = CacheStats;
+}
+
+/**
+  * @brief  EEPROM page write completed callback.
+  * @note   Called from the I2C Tx complete interrupt: the EEPROM now starts
+  *         its self-timed write cycle.
+  * @retval None
+  */
+void BSP_EEPROM_TxCpltCallback(void)
+{
+  if (CacheState == CACHE_WRITING)
+  {
+    CacheTick = HAL_GetTick();
+    CacheState = CACHE_WRITE_CYCLE;
+    CacheFailures = 0;
+  }
+}
+
+/**
+  * @brief  EEPROM read completed callback.
+  * @retval None
+  */
+void BSP_EEPROM_RxCpltCallback(void)
+{
+  CacheReadPending = 0;
+}
+
+/**
+  * @brief  EEPROM transfer failed callback.
+  * @note   Called from interrupt context. A refused burst gives its bytes
+  *         back; the next one waits for a write cycle, as the EEPROM most
+  *         likely did not acknowledge because it was still programming.
+  * @retval None
+  */
+void BSP_EEPROM_ErrorCallback(void)
+{
+  if (CacheState == CACHE_WRITING)
+  {
+    CacheLines[BurstLine].Dirty |= BurstMask;
+    CacheStats.Errors++;
+    CacheFailures++;
+    CacheTick = HAL_GetTick();
+    CacheState = CACHE_WRITE_CYCLE;
+  }
+  if (CacheReadPending != 0)
+  {
+    CacheReadFailed = 1;
+    CacheReadPending = 0;
+  }
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_EEPROM_CACHE_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Looks a line up by tag.
+  * @param  Tag  line aligned EEPROM address.
+  * @retval Line pointer, NULL on miss.
+  */
+static CacheLineTypeDef* EEPROM_Cache_Find(uint16_t Tag)
+{
+  uint32_t i;
+
+  for (i = 0; i < EEPROM_CACHE_LINES; i++)
+  {
+    if (CacheLines[i].Tag == Tag)
+    {
+      return &CacheLines[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Claims the least recently used clean line for a new tag.
+  * @param  Tag  line aligned EEPROM address.
+  * @param  AllowDirty  when no clean line is left, wait for the least recently
+  *         used dirty line to be flushed (1) or give up (0).
+  * @retval Line pointer, NULL if no line could be claimed.
+  */
+static CacheLineTypeDef* EEPROM_Cache_Allocate(uint16_t Tag, uint32_t AllowDirty)
+{
+  CacheLineTypeDef* victim = NULL;
+  CacheLineTypeDef* oldest = NULL;
+  uint32_t i;
+
+  for (i = 0; i < EEPROM_CACHE_LINES; i++)
+  {
+    CacheLineTypeDef* line = &CacheLines[i];
+    if ((line->Dirty == 0) && ((victim == NULL) || ((uint16_t)(CacheClock - line->Age) > (uint16_t)(CacheClock - victim->Age))))
+    {
+      victim = line;
+    }
+    if ((oldest == NULL) || ((uint16_t)(CacheClock - line->Age) > (uint16_t)(CacheClock - oldest->Age)))
+    {
+      oldest = line;
+    }
+  }
+
+  if ((victim == NULL) && (AllowDirty != 0))
+  {
+    uint32_t tickstart = HAL_GetTick();
+    CacheFailures = 0;
+    while (oldest->Dirty != 0)
+    {
+      EEPROM_Cache_PollReady();
+      BSP_EEPROM_CacheProcess();
+      if (CacheFailures > EEPROM_CACHE_RETRIES)
+      {
+        return NULL;
+      }
+      if ((HAL_GetTick() - tickstart) > EEPROM_LONG_TIMEOUT)
+      {
+        BSP_EEPROM_TIMEOUT_UserCallback();
+        return NULL;
+      }
+    }
+    victim = oldest;
+  }
+
+  if (victim != NULL)
+  {
+    victim->Tag = Tag;
+    victim->Valid = 0;
+    victim->Dirty = 0;
+    victim->Age = CacheClock;
+  }
+  return victim;
+}
+
+/**
+  * @brief  Fetches a line from the EEPROM, keeping the bytes already dirty.
+  * @param  pLine  line to fill.
+  * @param  Tag  line aligned EEPROM address.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_Cache_Fill(CacheLineTypeDef* pLine, uint16_t Tag)
+{
+  uint8_t  fetched[EEPROM_CACHE_LINE_SIZE];
+  uint32_t primask, i;
+
+  EEPROM_Cache_WaitIdle();
+  if (EEPROM_Cache_ReadEeprom(fetched, Tag, EEPROM_CACHE_LINE_SIZE) != EEPROM_OK)
+  {
+    CacheState = CACHE_IDLE;
+    return EEPROM_FAIL;
+  }
+  CacheState = CACHE_IDLE;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  for (i = 0; i < EEPROM_CACHE_LINE_SIZE; i++)
+  {
+    if ((pLine->Dirty & (1U << i)) == 0)
+    {
+      pLine->Data[i] = fetched[i];
+    }
+  }
+  pLine->Valid = CACHE_LINE_MASK;
+  __set_PRIMASK(primask);
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Reads a block from the EEPROM and waits for the DMA to complete.
+  * @note   The engine must be held off (CACHE_READING) by the caller.
+  * @param  pBuffer  pointer to the buffer that receives the data.
+  * @param  ReadAddr  EEPROM's internal address to start reading from.
+  * @param  NumByteToRead  number of bytes to read.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_Cache_ReadEeprom(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t NumByteToRead)
+{
+  uint32_t tickstart;
+
+  /* Single bytes are read in polling mode: no completion interrupt */
+  CacheReadFailed = 0;
+  CacheReadPending = (NumByteToRead > 1) ? 1 : 0;
+  if (EEPROM_IO_ReadData(DISCOVERY_EEPROM_I2C_ADDRESS_A01, ReadAddr, (uint32_t)pBuffer, NumByteToRead) != HAL_OK)
+  {
+    CacheReadPending = 0;
+    return EEPROM_FAIL;
+  }
+
+  tickstart = HAL_GetTick();
+  while (CacheReadPending != 0)
+  {
+    if ((HAL_GetTick() - tickstart) > EEPROM_LONG_TIMEOUT)
+    {
+      CacheReadPending = 0;
+      BSP_EEPROM_TIMEOUT_UserCallback();
+      return EEPROM_TIMEOUT;
+    }
+  }
+  return (CacheReadFailed != 0) ? EEPROM_FAIL : EEPROM_OK;
+}
+
+/**
+  * @brief  Waits for the burst engine to release the bus, then holds it off.
+  * @retval None
+  */
+static void EEPROM_Cache_WaitIdle(void)
+{
+  uint32_t primask;
+
+  CacheHold = 1;
+  for (;;)
+  {
+    EEPROM_Cache_PollReady();
+    BSP_EEPROM_CacheProcess();
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (CacheState == CACHE_IDLE)
+    {
+      CacheState = CACHE_READING;
+      CacheHold = 0;
+      __set_PRIMASK(primask);
+      return;
+    }
+    __set_PRIMASK(primask);
+  }
+}
+
+/**
+  * @brief  Ends the write cycle early if the EEPROM acknowledges again.
+  * @note   Used by the blocking paths only, which would otherwise wait for the
+  *         worst case tW rounded up to the next tick. EEPROM_IO_Probe()
+  *         addresses the device once; EEPROM_IO_IsDeviceReady() would first
+  *         wait 5 ms, longer than tW.
+  * @retval None
+  */
+static void EEPROM_Cache_PollReady(void)
+{
+  uint8_t  hold = CacheHold;
+  uint32_t primask;
+
+  if (CacheState != CACHE_WRITE_CYCLE)
+  {
+    return;
+  }
+
+  /* Keep SysTick from starting a burst while the bus is addressed */
+  CacheHold = 1;
+  if (EEPROM_IO_Probe(DISCOVERY_EEPROM_I2C_ADDRESS_A01) == HAL_OK)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (CacheState == CACHE_WRITE_CYCLE)
+    {
+      CacheState = CACHE_IDLE;
+    }
+    __set_PRIMASK(primask);
+  }
+  CacheHold = hold;
+}
+
+/**
+  * @brief  Picks the next dirty page and snapshots it for programming.
+  * @note   Called with interrupts masked and the engine idle. The burst spans
+  *         from the first to the last dirty byte of the page when the bytes
+  *         in between are known, otherwise the first run of dirty bytes.
+  *         Lines are visited round-robin so one hot line cannot starve others.
+  * @retval 1 if a burst is ready to start, 0 if the cache is clean.
+  */
+static uint32_t EEPROM_Cache_PrepareBurst(void)
+{
+  CacheLineTypeDef* line;
+  uint16_t dirty, valid, span;
+  uint8_t first, last, page;
+  uint32_t i, n;
+
+  for (n = 0; n < EEPROM_CACHE_LINES; n++)
+  {
+    i = (CacheNextLine + n) % EEPROM_CACHE_LINES;
+    if (CacheLines[i].Dirty != 0)
+    {
+      break;
+    }
+  }
+  if (n == EEPROM_CACHE_LINES)
+  {
+    return 0;
+  }
+  CacheNextLine = (uint8_t)((i + 1) % EEPROM_CACHE_LINES);
+  line = &CacheLines[i];
+
+  /* First dirty page of the line */
+  for (page = 0; ((line->Dirty >> page) & CACHE_PAGE_MASK) == 0; page += EEPROM_PAGESIZE)
+  {
+  }
+  dirty = (line->Dirty >> page) & CACHE_PAGE_MASK;
+  valid = (line->Valid >> page) & CACHE_PAGE_MASK;
+  for (first = 0; (dirty & (1U << first)) == 0; first++)
+  {
+  }
+  for (last = EEPROM_PAGESIZE - 1; (dirty & (1U << last)) == 0; last--)
+  {
+  }
+  span = (uint16_t)(((1UL << (last - first + 1)) - 1U) << first);
+  if ((valid & span) != span)
+  {
+    /* Unknown bytes inside the span: only program the first dirty run */
+    for (last = first; ((last + 1) < EEPROM_PAGESIZE) && ((dirty & (1U << (last + 1))) != 0); last++)
+    {
+    }
+  }
+  else if (first == last)
+  {
+    /* Single bytes go through the polling path: pad with a known neighbour */
+    if (((last + 1) < EEPROM_PAGESIZE) && ((valid & (1U << (last + 1))) != 0))
+    {
+      last++;
+    }
+    else if ((first > 0) && ((valid & (1U << (first - 1))) != 0))
+    {
+      first--;
+    }
+  }
+  span = (uint16_t)(((1UL << (last - first + 1)) - 1U) << first);
+
+  BurstLine  = (uint8_t)i;
+  BurstMask  = (uint16_t)(span << page);
+  BurstAddr  = line->Tag + page + first;
+  BurstCount = (uint8_t)(last - first + 1);
+  memcpy(BurstData, &line->Data[page + first], BurstCount);
+  line->Dirty &= (uint16_t)~BurstMask;
+
+  CacheTick  = HAL_GetTick();
+  CacheState = CACHE_WRITING;
+  CacheStats.WriteCycles++;
+  CacheStats.ProgramBytes += BurstCount;
+  return 1;
+}
+
+/**
+  * @brief  Hands the prepared burst to the EEPROM driver.
+  * @retval None
+  */
+static void EEPROM_Cache_StartBurst(void)
+{
+  uint8_t  count = BurstCount;
+  uint32_t primask;
+
+  if (BSP_EEPROM_WritePage(BurstData, BurstAddr, (uint8_t*)&BurstCount) != EEPROM_OK)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    CacheLines[BurstLine].Dirty |= BurstMask;
+    CacheStats.Errors++;
+    CacheFailures++;
+    CacheState = CACHE_IDLE;
+    __set_PRIMASK(primask);
+  }
+  else if (count == 1)
+  {
+    /* Single bytes are written in polling mode: no completion interrupt */
+    BSP_EEPROM_TxCpltCallback();
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
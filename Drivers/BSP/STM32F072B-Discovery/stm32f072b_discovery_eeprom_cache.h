@@ -0,0 +1,109 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_eeprom_cache.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_eeprom_cache.c write-back cache.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_EEPROM_CACHE_H
+#define __STM32072B_DISCOVERY_EEPROM_CACHE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_eeprom.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_CACHE STM32F072B_DISCOVERY EEPROM CACHE
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_CACHE_Exported_Constants Exported Constants
+  * @{
+  */
+
+/* Bytes per cache line, multiple of EEPROM_PAGESIZE and at most 16 */
+#ifndef EEPROM_CACHE_LINE_SIZE
+#define EEPROM_CACHE_LINE_SIZE       16
+#endif
+
+/* Number of cache lines (RAM cost is about 24 bytes per line) */
+#ifndef EEPROM_CACHE_LINES
+#define EEPROM_CACHE_LINES           16
+#endif
+
+/* M24LR64 self-timed write cycle (tW), in ms */
+#ifndef EEPROM_CACHE_WRITE_CYCLE
+#define EEPROM_CACHE_WRITE_CYCLE     5
+#endif
+
+/* Failed bursts in a row after which the blocking calls give up */
+#ifndef EEPROM_CACHE_RETRIES
+#define EEPROM_CACHE_RETRIES         3
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_CACHE_Exported_Types Exported Types
+  * @{
+  */
+typedef struct
+{
+  uint32_t WriteBytes;       /* Bytes accepted by BSP_EEPROM_CacheWrite() */
+  uint32_t ProgramBytes;     /* Bytes actually sent to the EEPROM */
+  uint32_t WriteCycles;      /* Page programming cycles started */
+  uint32_t ReadHits;         /* Line reads served from RAM */
+  uint32_t ReadMisses;       /* Line reads that went to the EEPROM */
+  uint32_t Errors;           /* Failed or timed out bursts (retried) */
+} EEPROM_CacheStatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_CACHE_Exported_Functions Exported Functions
+  * @{
+  */
+uint32_t BSP_EEPROM_CacheInit(void);
+uint32_t BSP_EEPROM_CacheRead(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t NumByteToRead);
+uint32_t BSP_EEPROM_CacheWrite(const uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite);
+uint32_t BSP_EEPROM_CacheFlush(void);
+uint32_t BSP_EEPROM_CacheIsClean(void);
+void     BSP_EEPROM_CacheInvalidate(void);
+void     BSP_EEPROM_CacheProcess(void);
+void     BSP_EEPROM_CacheGetStats(EEPROM_CacheStatsTypeDef* pStats);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_EEPROM_CACHE_H */
@@ -0,0 +1,995 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_eeprom_kv.c
+  * @brief   This file provides a log-structured, wear-leveled key-value store
+  *          on the I2C M24LR64 EEPROM.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - The store area is split into segments used as a circular log.
+  *             Each segment starts with a header holding a magic number and a
+  *             sequence number that is never reused. Records are appended to
+  *             the newest segment; an update never rewrites data in place, so
+  *             the writes move around the whole area.
+  *           - Record layout, padded to EEPROM_PAGESIZE:
+  *               Key (2) | Length (1) | Flags (1) | Value | pad | CRC32 (4)
+  *             The CRC is seeded with the sequence number of the segment, so
+  *             records left over from an earlier use of the segment, and
+  *             records torn by a power failure, are rejected. The CRC page is
+  *             programmed last and is the commit point of the record.
+  *           - A RAM index (open addressing) maps each key to its newest
+  *             record. BSP_EEPROM_KV_Init() rebuilds it by replaying the
+  *             segments in sequence order. A failed read (the EEPROM link
+  *             busy with the cache or the asynchronous API, a NACK) is not
+  *             an invalid record: Init and the compaction stop there and
+  *             return the error, the log untouched.
+  *           - The oldest segment is compacted by copying its live records to
+  *             the head, then released by clearing its magic number. One free
+  *             segment is always kept for this. BSP_EEPROM_KV_Process() does
+  *             it one record at a time in the background; BSP_EEPROM_KV_Set()
+  *             only does it itself when no spare segment is left.
+  *           - The store talks to the EEPROM_IO_* link layer directly. It
+  *             waits for its transfers through the completion flags the
+  *             EEPROM driver clears from the DMA callbacks, and for write
+  *             cycles by ACK polling with EEPROM_IO_Probe(). It owns its
+  *             EEPROM area: do not mix it with the EEPROM cache there.
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_eeprom_kv.h"
+#include <string.h>
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_EEPROM_KV
+  * @brief      Log-structured key-value store on the I2C EEPROM.
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_KV_Private_Types Private Types
+  * @{
+  */
+#if (EEPROM_KV_SEGMENTS < 3) || (EEPROM_KV_SEGMENTS > 32)
+#error "EEPROM_KV_SIZE must hold between 3 and 32 segments"
+#endif
+#if ((EEPROM_KV_BASE % EEPROM_PAGESIZE) != 0) || ((EEPROM_KV_SEGMENT_SIZE % EEPROM_PAGESIZE) != 0)
+#error "The store area and its segments must be page aligned"
+#endif
+#if (EEPROM_KV_BASE + EEPROM_KV_SIZE) > EEPROM_MAX_SIZE
+#error "The store area does not fit in the EEPROM"
+#endif
+#if (EEPROM_KV_INDEX_SIZE & (EEPROM_KV_INDEX_SIZE - 1)) != 0
+#error "EEPROM_KV_INDEX_SIZE must be a power of two"
+#endif
+#if EEPROM_KV_MAX_VALUE > 254
+#error "EEPROM_KV_MAX_VALUE must be below 255"
+#endif
+
+#define KV_MAGIC                  0x3156564BUL        /* "KVV1" */
+#define KV_HEADER_SIZE            12U                 /* Magic, Seq, CRC32 */
+#define KV_FLAG_DELETED           0x01U
+#define KV_PAD(n)                 ((((n) + EEPROM_PAGESIZE - 1U) / EEPROM_PAGESIZE) * EEPROM_PAGESIZE)
+#define KV_RECORD_SIZE(len)       (4U + KV_PAD(len) + 4U)
+#define KV_SEGMENT_ADDR(s)        ((uint16_t)(EEPROM_KV_BASE + (s) * EEPROM_KV_SEGMENT_SIZE))
+/* Fibonacci hashing: top bits of the 16-bit product */
+#define KV_HASH(key)              ((((uint16_t)((key) * 40503U)) * (uint32_t)EEPROM_KV_INDEX_SIZE) >> 16)
+
+typedef struct
+{
+  uint16_t Key;         /* EEPROM_KV_NO_KEY when the slot is empty */
+  uint16_t Addr;        /* EEPROM address of the newest record */
+  uint8_t  Length;      /* Value length */
+} KV_EntryTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_KV_Private_Variables Private Variables
+  * @{
+  */
+static const uint32_t  KVCrcTable[16] =
+{
+  0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+  0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+  0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+  0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+static KV_EntryTypeDef        KVIndex[EEPROM_KV_INDEX_SIZE];
+static uint32_t               KVSeq[EEPROM_KV_SEGMENTS];   /* 0 when free */
+static uint32_t               KVNextSeq = 1;
+static uint16_t               KVCount;
+static uint8_t                KVFree;
+static uint8_t                KVHead;
+static uint16_t               KVHeadOffset;
+static uint16_t               KVCompactOffset;             /* 0 when idle */
+static EEPROM_KVStatsTypeDef  KVStats;
+
+/* Record being encoded or decoded */
+static uint8_t                KVRecord[KV_RECORD_SIZE(EEPROM_KV_MAX_VALUE)];
+
+/* Bytes of the page write in progress, cleared by EEPROM_IO_TxCpltCallback() */
+static __IO uint8_t           KVWritePending;
+
+/* Completion flags of stm32f072b_discovery_eeprom.c */
+extern __IO uint16_t          EEPROMDataRead;
+extern __IO uint8_t*          EEPROMDataWritePointer;
+extern __IO uint8_t           EEPROMDataError;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_KV_Private_Functions Private Functions
+  * @{
+  */
+static uint32_t         EEPROM_KV_Crc(uint32_t Seed, const uint8_t* pData, uint32_t Size);
+static uint32_t         EEPROM_KV_WaitXfer(void);
+static uint32_t         EEPROM_KV_WaitWriteCycle(void);
+static uint32_t         EEPROM_KV_Read(uint16_t Addr, uint8_t* pBuffer, uint16_t Size);
+static uint32_t         EEPROM_KV_Program(uint16_t Addr, const uint8_t* pBuffer, uint16_t Size);
+static uint32_t         EEPROM_KV_ReadHeader(uint32_t Segment, uint32_t* pSeq);
+static uint32_t         EEPROM_KV_Open(uint32_t Segment);
+static uint32_t         EEPROM_KV_Release(uint32_t Segment);
+static uint32_t         EEPROM_KV_Load(uint32_t Segment, uint16_t Offset, uint32_t* pSize);
+static uint32_t         EEPROM_KV_Append(uint16_t Key, uint8_t Flags, const uint8_t* pValue, uint8_t Length, uint16_t* pAddr, uint32_t Compacting);
+static uint32_t         EEPROM_KV_Advance(uint32_t Compacting);
+static uint32_t         EEPROM_KV_Tail(void);
+static uint32_t         EEPROM_KV_CompactStep(uint32_t* pReleased);
+static KV_EntryTypeDef* EEPROM_KV_Find(uint16_t Key);
+static uint32_t         EEPROM_KV_Put(uint16_t Key, uint16_t Addr, uint8_t Length);
+static void             EEPROM_KV_Remove(uint16_t Key);
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_EEPROM_KV_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Mounts the store: rebuilds the index from the log.
+  * @note   An area holding no valid segment is formatted. Records cut short by
+  *         a power failure are dropped, so every key comes back with the last
+  *         value whose write completed. A read error fails the mount: call
+  *         it again before using the store.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_KV_Init(void)
+{
+  uint32_t seg, last, best, seq, size, status;
+  uint16_t offset;
+
+  if (BSP_EEPROM_Init() != EEPROM_OK)
+  {
+    return EEPROM_FAIL;
+  }
+
+  memset(&KVStats, 0, sizeof(KVStats));
+  memset(KVIndex, 0xFF, sizeof(KVIndex));
+  KVCount = 0;
+  KVFree = 0;
+  KVCompactOffset = 0;
+  KVNextSeq = 1;
+
+  for (seg = 0; seg < EEPROM_KV_SEGMENTS; seg++)
+  {
+    if (EEPROM_KV_ReadHeader(seg, &KVSeq[seg]) != EEPROM_OK)
+    {
+      return EEPROM_FAIL;
+    }
+    if (KVSeq[seg] == 0)
+    {
+      KVFree++;
+    }
+  }
+  if (KVFree == EEPROM_KV_SEGMENTS)
+  {
+    return BSP_EEPROM_KV_Format();
+  }
+
+  /* Replay the segments oldest first */
+  last = 0;
+  for (;;)
+  {
+    best = EEPROM_KV_SEGMENTS;
+    for (seg = 0; seg < EEPROM_KV_SEGMENTS; seg++)
+    {
+      if ((KVSeq[seg] > last) && ((best == EEPROM_KV_SEGMENTS) || (KVSeq[seg] < KVSeq[best])))
+      {
+        best = seg;
+      }
+    }
+    if (best == EEPROM_KV_SEGMENTS)
+    {
+      break;
+    }
+    seq = KVSeq[best];
+
+    offset = KV_HEADER_SIZE;
+    for (;;)
+    {
+      uint16_t key;
+
+      /* A read error is not the end of the log: appends would overwrite
+         the records not replayed yet */
+      status = EEPROM_KV_Load(best, offset, &size);
+      if (status != EEPROM_OK)
+      {
+        return status;
+      }
+      if (size == 0)
+      {
+        break;
+      }
+      key = (uint16_t)(KVRecord[0] | (KVRecord[1] << 8));
+
+      if ((KVRecord[3] & KV_FLAG_DELETED) != 0)
+      {
+        EEPROM_KV_Remove(key);
+      }
+      else if (EEPROM_KV_Put(key, (uint16_t)(KV_SEGMENT_ADDR(best) + offset), KVRecord[2]) != EEPROM_OK)
+      {
+        return EEPROM_KV_FULL;
+      }
+      offset += (uint16_t)size;
+    }
+
+    KVHead = (uint8_t)best;
+    KVHeadOffset = offset;
+    last = seq;
+  }
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Erases every key.
+  * @note   Clears the magic number of every segment, then opens the first
+  *         one. Sequence numbers keep increasing across formats.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_KV_Format(void)
+{
+  static const uint8_t zero[EEPROM_PAGESIZE] = { 0 };
+  uint32_t seg, seq;
+
+  for (seg = 0; seg < EEPROM_KV_SEGMENTS; seg++)
+  {
+    /* Learn the sequence numbers in use before destroying the headers */
+    if ((EEPROM_KV_ReadHeader(seg, &seq) != EEPROM_OK) ||
+        (EEPROM_KV_Program(KV_SEGMENT_ADDR(seg), zero, EEPROM_PAGESIZE) != EEPROM_OK))
+    {
+      return EEPROM_FAIL;
+    }
+    KVSeq[seg] = 0;
+  }
+  memset(KVIndex, 0xFF, sizeof(KVIndex));
+  KVCount = 0;
+  KVFree = EEPROM_KV_SEGMENTS;
+  KVCompactOffset = 0;
+  return EEPROM_KV_Open(0);
+}
+
+/**
+  * @brief  Reads the value stored under a key.
+  * @param  Key  key, any value but EEPROM_KV_NO_KEY.
+  * @param  pBuffer  pointer to the buffer that receives the value.
+  * @param  pLength  in: size of the buffer, out: length of the value.
+  * @retval EEPROM_OK (0), EEPROM_KV_NOT_FOUND if the key does not exist,
+  *         EEPROM_FAIL if the buffer is too small or the read failed.
+  */
+uint32_t BSP_EEPROM_KV_Get(uint16_t Key, uint8_t* pBuffer, uint8_t* pLength)
+{
+  KV_EntryTypeDef* entry = EEPROM_KV_Find(Key);
+  uint8_t size = *pLength;
+
+  if (entry == NULL)
+  {
+    return EEPROM_KV_NOT_FOUND;
+  }
+  *pLength = entry->Length;
+  if (entry->Length > size)
+  {
+    return EEPROM_FAIL;
+  }
+  if (entry->Length == 0)
+  {
+    return EEPROM_OK;
+  }
+  return EEPROM_KV_Read((uint16_t)(entry->Addr + 4U), pBuffer, entry->Length);
+}
+
+/**
+  * @brief  Stores a value under a key.
+  * @note   Returns once the record is committed. Storing the value a key
+  *         already holds writes nothing.
+  * @param  Key  key, any value but EEPROM_KV_NO_KEY.
+  * @param  pBuffer  pointer to the value.
+  * @param  Length  value length, up to EEPROM_KV_MAX_VALUE.
+  * @retval EEPROM_OK (0), EEPROM_KV_FULL if the index or the log is full, else
+  *         a value different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_KV_Set(uint16_t Key, const uint8_t* pBuffer, uint8_t Length)
+{
+  KV_EntryTypeDef* entry;
+  uint16_t addr;
+  uint32_t status;
+
+  if ((Key == EEPROM_KV_NO_KEY) || (Length > EEPROM_KV_MAX_VALUE))
+  {
+    return EEPROM_FAIL;
+  }
+
+  entry = EEPROM_KV_Find(Key);
+  if ((entry != NULL) && (entry->Length == Length))
+  {
+    if ((Length == 0) ||
+        ((EEPROM_KV_Read((uint16_t)(entry->Addr + 4U), KVRecord, Length) == EEPROM_OK) &&
+         (memcmp(KVRecord, pBuffer, Length) == 0)))
+    {
+      return EEPROM_OK;
+    }
+  }
+  if ((entry == NULL) && (KVCount >= EEPROM_KV_MAX_KEYS))
+  {
+    return EEPROM_KV_FULL;
+  }
+
+  status = EEPROM_KV_Append(Key, 0, pBuffer, Length, &addr, 0);
+  if (status != EEPROM_OK)
+  {
+    return status;
+  }
+  KVStats.UserBytes += Length;
+  KVStats.Records++;
+  return EEPROM_KV_Put(Key, addr, Length);
+}
+
+/**
+  * @brief  Deletes a key.
+  * @param  Key  key to delete.
+  * @retval EEPROM_OK (0), EEPROM_KV_NOT_FOUND if the key does not exist, else
+  *         a value different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_KV_Delete(uint16_t Key)
+{
+  uint16_t addr;
+  uint32_t status;
+
+  if (EEPROM_KV_Find(Key) == NULL)
+  {
+    return EEPROM_KV_NOT_FOUND;
+  }
+  status = EEPROM_KV_Append(Key, KV_FLAG_DELETED, NULL, 0, &addr, 0);
+  if (status == EEPROM_OK)
+  {
+    KVStats.Records++;
+    EEPROM_KV_Remove(Key);
+  }
+  return status;
+}
+
+/**
+  * @brief  Background compaction.
+  * @note   Call from the main loop when idle. Moves at most one record per
+  *         call, while fewer than EEPROM_KV_COMPACT_THRESHOLD segments are
+  *         free. Not reentrant with the other functions of the store.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+uint32_t BSP_EEPROM_KV_Process(void)
+{
+  uint32_t released;
+
+  if (KVFree >= EEPROM_KV_COMPACT_THRESHOLD)
+  {
+    return EEPROM_OK;
+  }
+  return EEPROM_KV_CompactStep(&released);
+}
+
+/**
+  * @brief  Returns the number of keys stored.
+  * @retval Number of keys.
+  */
+uint32_t BSP_EEPROM_KV_Count(void)
+{
+  return KVCount;
+}
+
+/**
+  * @brief  Returns the store statistics.
+  * @param  pStats  pointer to the structure receiving the counters.
+  * @retval None
+  */
+void BSP_EEPROM_KV_GetStats(EEPROM_KVStatsTypeDef* pStats)
+{
+  *pStats = KVStats;
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_EEPROM_KV_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  CRC-32 (IEEE 802.3), nibble-wise.
+  * @param  Seed  initial value, the segment sequence number for records.
+  * @param  pData  pointer to the data.
+  * @param  Size  number of bytes.
+  * @retval CRC value.
+  */
+static uint32_t EEPROM_KV_Crc(uint32_t Seed, const uint8_t* pData, uint32_t Size)
+{
+  uint32_t crc = ~Seed;
+
+  while (Size-- > 0)
+  {
+    crc ^= *pData++;
+    crc = (crc >> 4) ^ KVCrcTable[crc & 0x0FU];
+    crc = (crc >> 4) ^ KVCrcTable[crc & 0x0FU];
+  }
+  return ~crc;
+}
+
+/**
+  * @brief  Waits for the end of the transfer in progress.
+  * @note   Single bytes are sent in polling mode: their flag is cleared by
+  *         the caller. Waiting on the completion flags, not on
+  *         EEPROM_IO_IsDeviceReady(), spares the 5 ms that function spends
+  *         before addressing the device. A failed transfer clears them too,
+  *         with EEPROMDataError set.
+  * @retval EEPROM_OK (0), EEPROM_FAIL or EEPROM_TIMEOUT
+  */
+static uint32_t EEPROM_KV_WaitXfer(void)
+{
+  uint32_t tickstart = HAL_GetTick();
+
+  while ((EEPROMDataRead > 0) || (KVWritePending > 0))
+  {
+    if ((HAL_GetTick() - tickstart) > EEPROM_LONG_TIMEOUT)
+    {
+      BSP_EEPROM_TIMEOUT_UserCallback();
+      return EEPROM_TIMEOUT;
+    }
+  }
+  return (EEPROMDataError != 0) ? EEPROM_FAIL : EEPROM_OK;
+}
+
+/**
+  * @brief  Waits for the end of the write cycle of the last page written.
+  * @note   The EEPROM does not acknowledge its address during a write cycle.
+  * @retval EEPROM_OK (0) or EEPROM_TIMEOUT
+  */
+static uint32_t EEPROM_KV_WaitWriteCycle(void)
+{
+  uint32_t tickstart = HAL_GetTick();
+
+  while (EEPROM_IO_Probe(DISCOVERY_EEPROM_I2C_ADDRESS_A01) != HAL_OK)
+  {
+    if ((HAL_GetTick() - tickstart) > EEPROM_LONG_TIMEOUT)
+    {
+      BSP_EEPROM_TIMEOUT_UserCallback();
+      return EEPROM_TIMEOUT;
+    }
+  }
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Reads a block from the EEPROM.
+  * @param  Addr  EEPROM address.
+  * @param  pBuffer  pointer to the buffer that receives the data.
+  * @param  Size  number of bytes.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_KV_Read(uint16_t Addr, uint8_t* pBuffer, uint16_t Size)
+{
+  EEPROMDataRead = Size;
+  EEPROMDataError = 0;
+  if (EEPROM_IO_ReadData(DISCOVERY_EEPROM_I2C_ADDRESS_A01, Addr, (uint32_t)pBuffer, Size) != HAL_OK)
+  {
+    EEPROMDataRead = 0;
+    return EEPROM_FAIL;
+  }
+  if (Size == 1)
+  {
+    EEPROMDataRead = 0;
+  }
+  return EEPROM_KV_WaitXfer();
+}
+
+/**
+  * @brief  Programs a block into the EEPROM, one page at a time.
+  * @param  Addr  EEPROM address.
+  * @param  pBuffer  pointer to the data.
+  * @param  Size  number of bytes.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_KV_Program(uint16_t Addr, const uint8_t* pBuffer, uint16_t Size)
+{
+  uint16_t chunk;
+  uint32_t status;
+
+  while (Size > 0)
+  {
+    chunk = (uint16_t)(EEPROM_PAGESIZE - (Addr % EEPROM_PAGESIZE));
+    if (chunk > Size)
+    {
+      chunk = Size;
+    }
+    KVWritePending = (uint8_t)chunk;
+    EEPROMDataWritePointer = &KVWritePending;
+    EEPROMDataError = 0;
+    if (EEPROM_IO_WriteData(DISCOVERY_EEPROM_I2C_ADDRESS_A01, Addr, (uint32_t)pBuffer, chunk) != HAL_OK)
+    {
+      KVWritePending = 0;
+      EEPROMDataWritePointer = NULL;
+      return EEPROM_FAIL;
+    }
+    if (chunk == 1)
+    {
+      KVWritePending = 0;
+    }
+    status = EEPROM_KV_WaitXfer();
+    EEPROMDataWritePointer = NULL;
+    if (status == EEPROM_OK)
+    {
+      status = EEPROM_KV_WaitWriteCycle();
+    }
+    if (status != EEPROM_OK)
+    {
+      return status;
+    }
+    KVStats.ProgramBytes += chunk;
+    pBuffer += chunk;
+    Addr += chunk;
+    Size -= chunk;
+  }
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Reads a segment header.
+  * @note   Also raises KVNextSeq past the sequence number of released
+  *         segments, whose header is intact but for the magic number.
+  * @param  Segment  segment number.
+  * @param  pSeq  receives the sequence number, 0 if the segment is free.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_KV_ReadHeader(uint32_t Segment, uint32_t* pSeq)
+{
+  uint8_t  header[KV_HEADER_SIZE];
+  uint32_t magic, seq, crc;
+
+  *pSeq = 0;
+  if (EEPROM_KV_Read(KV_SEGMENT_ADDR(Segment), header, KV_HEADER_SIZE) != EEPROM_OK)
+  {
+    return EEPROM_FAIL;
+  }
+  magic = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+  seq   = header[4] | (header[5] << 8) | (header[6] << 16) | ((uint32_t)header[7] << 24);
+  crc   = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t)header[11] << 24);
+
+  header[0] = (uint8_t)KV_MAGIC;
+  header[1] = (uint8_t)(KV_MAGIC >> 8);
+  header[2] = (uint8_t)(KV_MAGIC >> 16);
+  header[3] = (uint8_t)(KV_MAGIC >> 24);
+  if ((seq == 0) || (seq == 0xFFFFFFFFUL) || (EEPROM_KV_Crc(0, header, 8) != crc))
+  {
+    return EEPROM_OK;
+  }
+  if (seq >= KVNextSeq)
+  {
+    KVNextSeq = seq + 1U;
+  }
+  if (magic == KV_MAGIC)
+  {
+    *pSeq = seq;
+  }
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Starts a new head segment.
+  * @param  Segment  free segment number.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_KV_Open(uint32_t Segment)
+{
+  uint8_t  header[KV_HEADER_SIZE];
+  uint32_t seq = KVNextSeq++;
+  uint32_t crc, status;
+
+  header[0] = (uint8_t)KV_MAGIC;
+  header[1] = (uint8_t)(KV_MAGIC >> 8);
+  header[2] = (uint8_t)(KV_MAGIC >> 16);
+  header[3] = (uint8_t)(KV_MAGIC >> 24);
+  header[4] = (uint8_t)seq;
+  header[5] = (uint8_t)(seq >> 8);
+  header[6] = (uint8_t)(seq >> 16);
+  header[7] = (uint8_t)(seq >> 24);
+  crc = EEPROM_KV_Crc(0, header, 8);
+  header[8]  = (uint8_t)crc;
+  header[9]  = (uint8_t)(crc >> 8);
+  header[10] = (uint8_t)(crc >> 16);
+  header[11] = (uint8_t)(crc >> 24);
+
+  /* The CRC page goes last: a torn header leaves the segment free */
+  status = EEPROM_KV_Program(KV_SEGMENT_ADDR(Segment), header, KV_HEADER_SIZE);
+  if (status != EEPROM_OK)
+  {
+    return status;
+  }
+  KVSeq[Segment] = seq;
+  KVFree--;
+  KVHead = (uint8_t)Segment;
+  KVHeadOffset = KV_HEADER_SIZE;
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Returns a compacted segment to the free pool.
+  * @param  Segment  segment number.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_KV_Release(uint32_t Segment)
+{
+  static const uint8_t zero[EEPROM_PAGESIZE] = { 0 };
+  uint32_t status;
+
+  status = EEPROM_KV_Program(KV_SEGMENT_ADDR(Segment), zero, EEPROM_PAGESIZE);
+  if (status != EEPROM_OK)
+  {
+    return status;
+  }
+  KVSeq[Segment] = 0;
+  KVFree++;
+  KVStats.Compactions++;
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Reads and checks the record at an offset of a segment.
+  * @param  Segment  segment number.
+  * @param  Offset  offset of the record in the segment.
+  * @param  pSize  receives the record size in bytes, 0 if there is no valid
+  *         record there (end of the log in this segment).
+  * @retval EEPROM_OK (0) if the record could be read, valid or not, else
+  *         the status of the failed read: *pSize is then meaningless.
+  */
+static uint32_t EEPROM_KV_Load(uint32_t Segment, uint16_t Offset, uint32_t* pSize)
+{
+  uint16_t addr = (uint16_t)(KV_SEGMENT_ADDR(Segment) + Offset);
+  uint32_t size, crc, status;
+
+  *pSize = 0;
+  if ((Offset + KV_RECORD_SIZE(0)) > EEPROM_KV_SEGMENT_SIZE)
+  {
+    return EEPROM_OK;
+  }
+  status = EEPROM_KV_Read(addr, KVRecord, 4);
+  if (status != EEPROM_OK)
+  {
+    return status;
+  }
+  size = KV_RECORD_SIZE(KVRecord[2]);
+  if ((KVRecord[2] > EEPROM_KV_MAX_VALUE) || ((Offset + size) > EEPROM_KV_SEGMENT_SIZE) ||
+      ((KVRecord[0] == 0xFF) && (KVRecord[1] == 0xFF)))
+  {
+    return EEPROM_OK;
+  }
+  status = EEPROM_KV_Read((uint16_t)(addr + 4U), &KVRecord[4], (uint16_t)(size - 4U));
+  if (status != EEPROM_OK)
+  {
+    return status;
+  }
+  crc = KVRecord[size - 4] | (KVRecord[size - 3] << 8) | (KVRecord[size - 2] << 16) | ((uint32_t)KVRecord[size - 1] << 24);
+  if (EEPROM_KV_Crc(KVSeq[Segment], KVRecord, size - 4U) == crc)
+  {
+    *pSize = size;
+  }
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Appends a record to the head segment.
+  * @param  Key  record key.
+  * @param  Flags  record flags.
+  * @param  pValue  pointer to the value, may point into KVRecord.
+  * @param  Length  value length.
+  * @param  pAddr  receives the EEPROM address of the record.
+  * @param  Compacting  1 when called by the compaction, which may use the
+  *         last free segment.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_KV_Append(uint16_t Key, uint8_t Flags, const uint8_t* pValue, uint8_t Length, uint16_t* pAddr, uint32_t Compacting)
+{
+  uint32_t size = KV_RECORD_SIZE(Length);
+  uint32_t crc, status;
+  uint16_t addr;
+
+  if ((KVHeadOffset + size) > EEPROM_KV_SEGMENT_SIZE)
+  {
+    status = EEPROM_KV_Advance(Compacting);
+    if (status != EEPROM_OK)
+    {
+      return status;
+    }
+  }
+
+  if (Length > 0)
+  {
+    memmove(&KVRecord[4], pValue, Length);
+  }
+  KVRecord[0] = (uint8_t)Key;
+  KVRecord[1] = (uint8_t)(Key >> 8);
+  KVRecord[2] = Length;
+  KVRecord[3] = Flags;
+  memset(&KVRecord[4 + Length], 0xFF, KV_PAD(Length) - Length);
+  crc = EEPROM_KV_Crc(KVSeq[KVHead], KVRecord, size - 4U);
+  KVRecord[size - 4] = (uint8_t)crc;
+  KVRecord[size - 3] = (uint8_t)(crc >> 8);
+  KVRecord[size - 2] = (uint8_t)(crc >> 16);
+  KVRecord[size - 1] = (uint8_t)(crc >> 24);
+
+  addr = (uint16_t)(KV_SEGMENT_ADDR(KVHead) + KVHeadOffset);
+  status = EEPROM_KV_Program(addr, KVRecord, (uint16_t)size);
+  if (status != EEPROM_OK)
+  {
+    /* Whatever was written is not committed: skip over it */
+    KVHeadOffset = EEPROM_KV_SEGMENT_SIZE;
+    return status;
+  }
+  KVHeadOffset += (uint16_t)size;
+  *pAddr = addr;
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Moves the head to the next free segment.
+  * @note   The application keeps one segment spare for the compaction: when
+  *         taking the next one would use it, the oldest segments are
+  *         compacted first.
+  * @param  Compacting  1 when called by the compaction.
+  * @retval EEPROM_OK (0), EEPROM_KV_FULL if no segment can be freed, else a
+  *         value different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_KV_Advance(uint32_t Compacting)
+{
+  uint32_t released, tries, seg, status;
+
+  if (Compacting == 0)
+  {
+    for (tries = 0; KVFree < 2; tries++)
+    {
+      if (tries == EEPROM_KV_SEGMENTS)
+      {
+        return EEPROM_KV_FULL;
+      }
+      do
+      {
+        if (EEPROM_KV_Tail() == KVHead)
+        {
+          return EEPROM_KV_FULL;
+        }
+        status = EEPROM_KV_CompactStep(&released);
+        if (status != EEPROM_OK)
+        {
+          return status;
+        }
+      } while (released == 0);
+    }
+  }
+  if (KVFree == 0)
+  {
+    return EEPROM_KV_FULL;
+  }
+
+  /* Next free segment after the head: the log wraps around the area */
+  for (seg = (KVHead + 1U) % EEPROM_KV_SEGMENTS; KVSeq[seg] != 0; seg = (seg + 1U) % EEPROM_KV_SEGMENTS)
+  {
+  }
+  return EEPROM_KV_Open(seg);
+}
+
+/**
+  * @brief  Finds the oldest segment in use.
+  * @retval Segment number.
+  */
+static uint32_t EEPROM_KV_Tail(void)
+{
+  uint32_t seg, tail = KVHead;
+
+  for (seg = 0; seg < EEPROM_KV_SEGMENTS; seg++)
+  {
+    if ((KVSeq[seg] != 0) && (KVSeq[seg] < KVSeq[tail]))
+    {
+      tail = seg;
+    }
+  }
+  return tail;
+}
+
+/**
+  * @brief  Moves the next record of the oldest segment, if still live, or
+  *         releases the segment once all its records have been visited.
+  * @param  pReleased  set to 1 when a segment was released, 0 otherwise.
+  * @retval EEPROM_OK (0) if operation is correctly performed, else return value
+  *         different from EEPROM_OK (0)
+  */
+static uint32_t EEPROM_KV_CompactStep(uint32_t* pReleased)
+{
+  uint32_t tail = EEPROM_KV_Tail();
+  uint32_t size, status;
+  uint16_t addr, key;
+  KV_EntryTypeDef* entry;
+
+  *pReleased = 0;
+  if (tail == KVHead)
+  {
+    return EEPROM_OK;
+  }
+  if (KVCompactOffset == 0)
+  {
+    KVCompactOffset = KV_HEADER_SIZE;
+  }
+
+  /* Released only at the end of its log, never on a read error */
+  status = EEPROM_KV_Load(tail, KVCompactOffset, &size);
+  if (status != EEPROM_OK)
+  {
+    return status;
+  }
+  if (size == 0)
+  {
+    status = EEPROM_KV_Release(tail);
+    if (status == EEPROM_OK)
+    {
+      KVCompactOffset = 0;
+      *pReleased = 1;
+    }
+    return status;
+  }
+
+  /* Live when the index still points here; deletions die with the segment */
+  key = (uint16_t)(KVRecord[0] | (KVRecord[1] << 8));
+  entry = EEPROM_KV_Find(key);
+  if ((entry != NULL) && (entry->Addr == (uint16_t)(KV_SEGMENT_ADDR(tail) + KVCompactOffset)))
+  {
+    status = EEPROM_KV_Append(key, 0, &KVRecord[4], KVRecord[2], &addr, 1);
+    if (status != EEPROM_OK)
+    {
+      return status;
+    }
+    entry->Addr = addr;
+    KVStats.CopiedRecords++;
+  }
+  KVCompactOffset += (uint16_t)size;
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Looks a key up in the index.
+  * @param  Key  key.
+  * @retval Entry pointer, NULL if the key does not exist.
+  */
+static KV_EntryTypeDef* EEPROM_KV_Find(uint16_t Key)
+{
+  uint32_t slot = KV_HASH(Key);
+
+  KVStats.Lookups++;
+  for (;;)
+  {
+    KVStats.Probes++;
+    if (KVIndex[slot].Key == Key)
+    {
+      return (Key == EEPROM_KV_NO_KEY) ? NULL : &KVIndex[slot];
+    }
+    if (KVIndex[slot].Key == EEPROM_KV_NO_KEY)
+    {
+      return NULL;
+    }
+    slot = (slot + 1U) & (EEPROM_KV_INDEX_SIZE - 1U);
+  }
+}
+
+/**
+  * @brief  Adds or updates an index entry.
+  * @param  Key  key.
+  * @param  Addr  EEPROM address of the record.
+  * @param  Length  value length.
+  * @retval EEPROM_OK (0) or EEPROM_KV_FULL
+  */
+static uint32_t EEPROM_KV_Put(uint16_t Key, uint16_t Addr, uint8_t Length)
+{
+  uint32_t slot = KV_HASH(Key);
+
+  while ((KVIndex[slot].Key != Key) && (KVIndex[slot].Key != EEPROM_KV_NO_KEY))
+  {
+    slot = (slot + 1U) & (EEPROM_KV_INDEX_SIZE - 1U);
+  }
+  if (KVIndex[slot].Key == EEPROM_KV_NO_KEY)
+  {
+    if (KVCount >= EEPROM_KV_MAX_KEYS)
+    {
+      return EEPROM_KV_FULL;
+    }
+    KVCount++;
+  }
+  KVIndex[slot].Key = Key;
+  KVIndex[slot].Addr = Addr;
+  KVIndex[slot].Length = Length;
+  return EEPROM_OK;
+}
+
+/**
+  * @brief  Removes an index entry, shifting back the entries probed past it.
+  * @param  Key  key.
+  * @retval None
+  */
+static void EEPROM_KV_Remove(uint16_t Key)
+{
+  KV_EntryTypeDef* entry = EEPROM_KV_Find(Key);
+  uint32_t hole, slot, home;
+
+  if (entry == NULL)
+  {
+    return;
+  }
+  hole = (uint32_t)(entry - KVIndex);
+  slot = hole;
+  for (;;)
+  {
+    slot = (slot + 1U) & (EEPROM_KV_INDEX_SIZE - 1U);
+    if (KVIndex[slot].Key == EEPROM_KV_NO_KEY)
+    {
+      break;
+    }
+    home = KV_HASH(KVIndex[slot].Key);
+    /* Move the entry unless its home lies cyclically in (hole, slot] */
+    if (((slot - home) & (EEPROM_KV_INDEX_SIZE - 1U)) >= ((slot - hole) & (EEPROM_KV_INDEX_SIZE - 1U)))
+    {
+      KVIndex[hole] = KVIndex[slot];
+      hole = slot;
+    }
+  }
+  KVIndex[hole].Key = EEPROM_KV_NO_KEY;
+  KVCount--;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
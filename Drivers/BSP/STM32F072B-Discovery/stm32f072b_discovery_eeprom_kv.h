@@ -0,0 +1,129 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_eeprom_kv.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_eeprom_kv.c key-value store.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_EEPROM_KV_H
+#define __STM32072B_DISCOVERY_EEPROM_KV_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_eeprom.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_KV STM32F072B_DISCOVERY EEPROM KV
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_KV_Exported_Constants Exported Constants
+  * @{
+  */
+
+/* EEPROM area owned by the store */
+#ifndef EEPROM_KV_BASE
+#define EEPROM_KV_BASE               0x0000
+#endif
+#ifndef EEPROM_KV_SIZE
+#define EEPROM_KV_SIZE               EEPROM_MAX_SIZE
+#endif
+
+/* Log segment size: the unit of compaction, at least 3 segments are needed */
+#ifndef EEPROM_KV_SEGMENT_SIZE
+#define EEPROM_KV_SEGMENT_SIZE       1024
+#endif
+
+/* Index slots (power of two, 6 bytes of RAM each); at most 3/4 can be used */
+#ifndef EEPROM_KV_INDEX_SIZE
+#define EEPROM_KV_INDEX_SIZE         64
+#endif
+
+/* Largest value in bytes */
+#ifndef EEPROM_KV_MAX_VALUE
+#define EEPROM_KV_MAX_VALUE          64
+#endif
+
+/* BSP_EEPROM_KV_Process() compacts while fewer segments than this are free */
+#ifndef EEPROM_KV_COMPACT_THRESHOLD
+#define EEPROM_KV_COMPACT_THRESHOLD  2
+#endif
+
+#define EEPROM_KV_SEGMENTS           (EEPROM_KV_SIZE / EEPROM_KV_SEGMENT_SIZE)
+#define EEPROM_KV_MAX_KEYS           ((EEPROM_KV_INDEX_SIZE * 3) / 4)
+
+/* Key value reserved by the store */
+#define EEPROM_KV_NO_KEY             0xFFFF
+
+/* Return codes, in addition to EEPROM_OK, EEPROM_FAIL, EEPROM_TIMEOUT and
+   EEPROM_BUSY */
+#define EEPROM_KV_NOT_FOUND          4
+#define EEPROM_KV_FULL               5
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_KV_Exported_Types Exported Types
+  * @{
+  */
+typedef struct
+{
+  uint32_t UserBytes;        /* Value bytes passed to BSP_EEPROM_KV_Set() */
+  uint32_t ProgramBytes;     /* Bytes written to the EEPROM, all included */
+  uint32_t Records;          /* Records appended by the application */
+  uint32_t CopiedRecords;    /* Records moved by compaction */
+  uint32_t Compactions;      /* Segments reclaimed */
+  uint32_t Lookups;          /* Index lookups */
+  uint32_t Probes;           /* Index slots visited by those lookups */
+} EEPROM_KVStatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_EEPROM_KV_Exported_Functions Exported Functions
+  * @{
+  */
+uint32_t BSP_EEPROM_KV_Init(void);
+uint32_t BSP_EEPROM_KV_Format(void);
+uint32_t BSP_EEPROM_KV_Get(uint16_t Key, uint8_t* pBuffer, uint8_t* pLength);
+uint32_t BSP_EEPROM_KV_Set(uint16_t Key, const uint8_t* pBuffer, uint8_t Length);
+uint32_t BSP_EEPROM_KV_Delete(uint16_t Key);
+uint32_t BSP_EEPROM_KV_Process(void);
+uint32_t BSP_EEPROM_KV_Count(void);
+void     BSP_EEPROM_KV_GetStats(EEPROM_KVStatsTypeDef* pStats);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_EEPROM_KV_H */
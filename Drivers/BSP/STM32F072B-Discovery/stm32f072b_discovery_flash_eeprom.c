@@ -0,0 +1,713 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_flash_eeprom.c
+  * @brief   This file provides an EEPROM emulation in two pages of the
+  *          STM32F072 internal flash, with a RAM index of the variables.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - Variables have a 16-bit virtual address below
+  *             FLASH_EE_VARIABLES and a 32-bit value. Each update appends an
+  *             8-byte entry to the active page:
+  *               VirtAddress (2) | Data (4) | CRC16 (2)
+  *             programmed with one HAL_FLASH_Program() double-word call, i.e.
+  *             four back-to-back half-word programs under one unlock. The CRC
+  *             half-word goes last and is the commit point of the entry;
+  *             torn entries fail the CRC and are skipped.
+  *           - The first 8 bytes of a page are its header: a status half-word
+  *             (erased 0xFFFF, receive 0xEEEE, valid 0x0000) and a generation
+  *             counter. Status changes only clear bits, as the flash allows
+  *             on a programmed half-word.
+  *           - A RAM index maps every variable to its newest entry, so reads
+  *             are one index lookup and two half-word loads and never scan a
+  *             page. BSP_FLASH_EE_Init() rebuilds it from the pages.
+  *           - When the active page runs low, the newest value of every
+  *             variable moves to the other page. BSP_FLASH_EE_Process() does
+  *             it step by step from the main loop: erase the spare page, mark
+  *             it receive once the active page is full, copy up to
+  *             FLASH_EE_COPY_PER_CALL variables per call, erase the old page,
+  *             mark the new one valid. Writes made in the meantime go to the
+  *             new page and make copying their variable unnecessary, so the
+  *             copies are put off as long as the slack allows.
+  *             BSP_FLASH_EE_Write() only runs these steps itself when the
+  *             page it writes to has no room left.
+  *           - Every swap step is power-fail safe: BSP_FLASH_EE_Init() works
+  *             out from the two page states where the swap stopped and
+  *             resumes it.
+  *           - The CPU stalls while it fetches code from flash during a page
+  *             erase (up to 40 ms) or a half-word program (up to 70 us).
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_flash_eeprom.h"
+#include <string.h>
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_FLASH_EEPROM
+  * @brief      EEPROM emulation in the internal flash.
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_FLASH_EEPROM_Private_Types Private Types
+  * @{
+  */
+#if (FLASH_EE_BASE % FLASH_PAGE_SIZE) != 0
+#error "FLASH_EE_BASE must be page aligned"
+#endif
+#if (FLASH_EE_VARIABLES + FLASH_EE_SWAP_THRESHOLD) > FLASH_EE_PAGE_ENTRIES
+#error "FLASH_EE_VARIABLES and FLASH_EE_SWAP_THRESHOLD do not fit in a page"
+#endif
+#if FLASH_EE_COPY_PER_CALL < 1
+#error "FLASH_EE_COPY_PER_CALL must be at least 1"
+#endif
+
+#define FEE_STATUS_ERASED         0xFFFFU
+#define FEE_STATUS_RECEIVE        0xEEEEU
+#define FEE_STATUS_VALID          0x0000U
+#define FEE_NO_PAGE               0xFFU
+#define FEE_NO_ENTRY              0xFFFFU
+#define FEE_PAGE_ADDR(p)          (FLASH_EE_BASE + (uint32_t)(p) * FLASH_PAGE_SIZE)
+#define FEE_ENTRY_ADDR(p, s)      (FEE_PAGE_ADDR(p) + 8U * ((uint32_t)(s) + 1U))
+#define FEE_SLOT(p, s)            ((uint16_t)((p) * FLASH_EE_PAGE_ENTRIES + (s)))
+#define FEE_SLOT_PAGE(slot)       ((slot) / FLASH_EE_PAGE_ENTRIES)
+#define FEE_SLOT_ENTRY(slot)      ((slot) % FLASH_EE_PAGE_ENTRIES)
+#define FEE_HALFWORD(addr)        (*(__IO uint16_t *)(addr))
+#define FEE_WORD(addr)            (*(__IO uint32_t *)(addr))
+
+typedef enum
+{
+  FEE_PAGE_ERASED = 0,
+  FEE_PAGE_RECEIVE,
+  FEE_PAGE_VALID,
+  FEE_PAGE_INVALID
+} FEE_PageStateTypeDef;
+
+/* Page swap steps, in order */
+typedef enum
+{
+  FEE_IDLE = 0,
+  FEE_ERASE,                  /* Erase the spare page */
+  FEE_MARK,                   /* Mark it receive */
+  FEE_COPY,                   /* Copy the variables still on the old page */
+  FEE_RETIRE,                 /* Erase the old page */
+  FEE_VALIDATE                /* Mark the new page valid */
+} FEE_SwapTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_FLASH_EEPROM_Private_Variables Private Variables
+  * @{
+  */
+static uint16_t               FEEIndex[FLASH_EE_VARIABLES];  /* Newest entry, FEE_NO_ENTRY if none */
+static uint8_t                FEEActive = FEE_NO_PAGE;       /* Valid page */
+static uint8_t                FEERecv = FEE_NO_PAGE;         /* Page being filled by a swap */
+static uint16_t               FEEFree;                       /* Next entry of the page written to */
+static uint16_t               FEECopyVar;                    /* Next variable to copy */
+static uint16_t               FEEPending;                    /* Variables still to copy */
+static uint32_t               FEEGeneration;
+static FEE_SwapTypeDef        FEEState;
+static FLASH_EE_StatsTypeDef  FEEStats;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_FLASH_EEPROM_Private_Functions Private Functions
+  * @{
+  */
+static uint16_t             FLASH_EE_Crc(uint16_t VirtAddress, uint32_t Data);
+static FEE_PageStateTypeDef FLASH_EE_PageState(uint32_t Page);
+static uint32_t             FLASH_EE_PageBlank(uint32_t Page);
+static uint32_t             FLASH_EE_Erase(uint32_t Page);
+static uint32_t             FLASH_EE_SetStatus(uint32_t Page, uint16_t Status, uint32_t Generation);
+static uint16_t             FLASH_EE_Scan(uint32_t Page);
+static uint32_t             FLASH_EE_Load(uint16_t Slot);
+static uint32_t             FLASH_EE_Append(uint16_t VirtAddress, uint32_t Data);
+static uint32_t             FLASH_EE_HasRoom(void);
+static uint32_t             FLASH_EE_SwapStep(void);
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_FLASH_EEPROM_Exported_Functions Exported Functions
+  * @{
+  */
+
+/**
+  * @brief  Mounts the emulated EEPROM: recovers the page states left by a
+  *         reset or a power failure, then builds the RAM index.
+  * @note   The pages are formatted when neither holds valid data.
+  * @retval FLASH_EE_OK (0) if operation is correctly performed, else return
+  *         value is different from FLASH_EE_OK (0)
+  */
+uint32_t BSP_FLASH_EE_Init(void)
+{
+  FEE_PageStateTypeDef state[2];
+  uint32_t page, other, var, status = FLASH_EE_OK;
+
+  state[0] = FLASH_EE_PageState(0);
+  state[1] = FLASH_EE_PageState(1);
+
+  /* Never left behind by a swap, but keep the newer page */
+  if ((state[0] == FEE_PAGE_VALID) && (state[1] == FEE_PAGE_VALID))
+  {
+    page = (FEE_WORD(FEE_PAGE_ADDR(1) + 4U) > FEE_WORD(FEE_PAGE_ADDR(0) + 4U)) ? 1U : 0U;
+    state[page ^ 1U] = FEE_PAGE_INVALID;
+  }
+
+  FEEActive = FEE_NO_PAGE;
+  FEERecv = FEE_NO_PAGE;
+  FEEState = FEE_IDLE;
+  memset(&FEEStats, 0, sizeof(FEEStats));
+
+  if ((state[0] == FEE_PAGE_VALID) || (state[1] == FEE_PAGE_VALID))
+  {
+    page = (state[0] == FEE_PAGE_VALID) ? 0U : 1U;
+    other = page ^ 1U;
+    FEEActive = (uint8_t)page;
+    FEEGeneration = FEE_WORD(FEE_PAGE_ADDR(page) + 4U);
+    if (state[other] == FEE_PAGE_RECEIVE)
+    {
+      /* Cut while copying: copy what is left */
+      FEERecv = (uint8_t)other;
+      FEEState = FEE_COPY;
+    }
+  }
+  else if ((state[0] == FEE_PAGE_RECEIVE) || (state[1] == FEE_PAGE_RECEIVE))
+  {
+    /* Cut after the copy: the old page is erased, or being erased */
+    page = (state[0] == FEE_PAGE_RECEIVE) ? 0U : 1U;
+    other = page ^ 1U;
+    if (state[other] == FEE_PAGE_RECEIVE)
+    {
+      return BSP_FLASH_EE_Format();
+    }
+    FEERecv = (uint8_t)page;
+    FEEActive = (uint8_t)other;
+    FEEGeneration = FEE_WORD(FEE_PAGE_ADDR(page) + 4U) - 1U;
+    FEEState = (FLASH_EE_PageBlank(other) != 0) ? FEE_VALIDATE : FEE_RETIRE;
+  }
+  else
+  {
+    return BSP_FLASH_EE_Format();
+  }
+
+  /* Replay the old page first so that the new page overrides it */
+  for (var = 0; var < FLASH_EE_VARIABLES; var++)
+  {
+    FEEIndex[var] = FEE_NO_ENTRY;
+  }
+  if (FEEState <= FEE_COPY)
+  {
+    FEEFree = FLASH_EE_Scan(FEEActive);
+  }
+  if (FEERecv != FEE_NO_PAGE)
+  {
+    FEEFree = FLASH_EE_Scan(FEERecv);
+  }
+  FEEStats.Generation = FEEGeneration;
+
+  if (FEEState == FEE_COPY)
+  {
+    FEECopyVar = 0;
+    FEEPending = 0;
+    for (var = 0; var < FLASH_EE_VARIABLES; var++)
+    {
+      if ((FEEIndex[var] != FEE_NO_ENTRY) && (FEE_SLOT_PAGE(FEEIndex[var]) == FEEActive))
+      {
+        FEEPending++;
+      }
+    }
+  }
+  else if ((FEEState == FEE_IDLE) && (FEE_HALFWORD(FEE_PAGE_ADDR(FEEActive)) != FEE_STATUS_VALID))
+  {
+    /* Finish a valid mark torn by a power failure */
+    HAL_FLASH_Unlock();
+    status = FLASH_EE_SetStatus(FEEActive, FEE_STATUS_VALID, 0);
+    HAL_FLASH_Lock();
+  }
+  return status;
+}
+
+/**
+  * @brief  Erases both pages and starts an empty emulated EEPROM.
+  * @retval FLASH_EE_OK (0) if operation is correctly performed, else return
+  *         value is different from FLASH_EE_OK (0)
+  */
+uint32_t BSP_FLASH_EE_Format(void)
+{
+  uint32_t var, status = FLASH_EE_OK;
+
+  for (var = 0; var < FLASH_EE_VARIABLES; var++)
+  {
+    FEEIndex[var] = FEE_NO_ENTRY;
+  }
+  FEEActive = FEE_NO_PAGE;
+  FEERecv = FEE_NO_PAGE;
+  FEEState = FEE_IDLE;
+  FEEFree = 0;
+  FEEGeneration = 0;
+
+  HAL_FLASH_Unlock();
+  if ((FLASH_EE_PageBlank(0) == 0) && (FLASH_EE_Erase(0) != FLASH_EE_OK))
+  {
+    status = FLASH_EE_FAIL;
+  }
+  if ((FLASH_EE_PageBlank(1) == 0) && (FLASH_EE_Erase(1) != FLASH_EE_OK))
+  {
+    status = FLASH_EE_FAIL;
+  }
+  if ((status == FLASH_EE_OK) && (FLASH_EE_SetStatus(0, FEE_STATUS_VALID, FEEGeneration) == FLASH_EE_OK))
+  {
+    FEEActive = 0;
+  }
+  else
+  {
+    status = FLASH_EE_FAIL;
+  }
+  HAL_FLASH_Lock();
+  FEEStats.Generation = FEEGeneration;
+  return status;
+}
+
+/**
+  * @brief  Reads a variable.
+  * @param  VirtAddress: virtual address of the variable.
+  * @param  pData: pointer to the variable value.
+  * @retval FLASH_EE_OK (0), FLASH_EE_NOT_FOUND if the variable was never
+  *         written, FLASH_EE_FAIL on a bad virtual address
+  */
+uint32_t BSP_FLASH_EE_Read(uint16_t VirtAddress, uint32_t* pData)
+{
+  if (VirtAddress >= FLASH_EE_VARIABLES)
+  {
+    return FLASH_EE_FAIL;
+  }
+  if (FEEIndex[VirtAddress] == FEE_NO_ENTRY)
+  {
+    return FLASH_EE_NOT_FOUND;
+  }
+  *pData = FLASH_EE_Load(FEEIndex[VirtAddress]);
+  return FLASH_EE_OK;
+}
+
+/**
+  * @brief  Writes a variable.
+  * @param  VirtAddress: virtual address of the variable.
+  * @param  Data: new value.
+  * @retval FLASH_EE_OK (0) if operation is correctly performed, else return
+  *         value is different from FLASH_EE_OK (0)
+  */
+uint32_t BSP_FLASH_EE_Write(uint16_t VirtAddress, uint32_t Data)
+{
+  return BSP_FLASH_EE_WriteMulti(&VirtAddress, &Data, 1);
+}
+
+/**
+  * @brief  Writes several variables with the flash unlocked once.
+  * @note   Values equal to the stored ones are not programmed again. The
+  *         entries are committed one by one, in order.
+  * @param  pVirtAddress: virtual addresses of the variables.
+  * @param  pData: new values.
+  * @param  Count: number of variables.
+  * @retval FLASH_EE_OK (0) if operation is correctly performed, else return
+  *         value is different from FLASH_EE_OK (0)
+  */
+uint32_t BSP_FLASH_EE_WriteMulti(const uint16_t* pVirtAddress, const uint32_t* pData, uint32_t Count)
+{
+  uint32_t i, status = FLASH_EE_OK;
+
+  if ((FEEActive == FEE_NO_PAGE) && (FEERecv == FEE_NO_PAGE))
+  {
+    return FLASH_EE_FAIL;
+  }
+
+  HAL_FLASH_Unlock();
+  for (i = 0; (i < Count) && (status == FLASH_EE_OK); i++)
+  {
+    uint16_t var = pVirtAddress[i];
+
+    if (var >= FLASH_EE_VARIABLES)
+    {
+      status = FLASH_EE_FAIL;
+      break;
+    }
+    FEEStats.Writes++;
+    if ((FEEIndex[var] != FEE_NO_ENTRY) && (FLASH_EE_Load(FEEIndex[var]) == pData[i]))
+    {
+      FEEStats.Skipped++;
+      continue;
+    }
+    while ((status == FLASH_EE_OK) && (FLASH_EE_HasRoom() == 0))
+    {
+      FEEStats.SyncSteps++;
+      status = FLASH_EE_SwapStep();
+    }
+    if (status == FLASH_EE_OK)
+    {
+      status = FLASH_EE_Append(var, pData[i]);
+    }
+  }
+  HAL_FLASH_Lock();
+  return status;
+}
+
+/**
+  * @brief  Background work: runs one page swap step once the active page is
+  *         running low. Call it from the main loop when there is time.
+  * @retval FLASH_EE_OK (0) if operation is correctly performed, else return
+  *         value is different from FLASH_EE_OK (0)
+  */
+uint32_t BSP_FLASH_EE_Process(void)
+{
+  uint32_t status;
+
+  if (BSP_FLASH_EE_SwapPending() == 0)
+  {
+    return FLASH_EE_OK;
+  }
+  HAL_FLASH_Unlock();
+  status = FLASH_EE_SwapStep();
+  HAL_FLASH_Lock();
+  return status;
+}
+
+/**
+  * @brief  Tells whether BSP_FLASH_EE_Process() has work to do.
+  * @note   Steps are taken as late as they can be while keeping
+  *         FLASH_EE_SWAP_THRESHOLD entries of slack: the new page is only
+  *         opened once the active one is full, and a variable is only copied
+  *         when it has to be, as a later write may make the copy useless.
+  * @retval 1 if a page swap step is due, else 0
+  */
+uint32_t BSP_FLASH_EE_SwapPending(void)
+{
+  uint32_t room = FLASH_EE_PAGE_ENTRIES - FEEFree;
+
+  switch (FEEState)
+  {
+  case FEE_IDLE:
+    return ((FEEActive != FEE_NO_PAGE) && (room < FLASH_EE_SWAP_THRESHOLD)) ? 1U : 0U;
+  case FEE_MARK:
+    return (room == 0) ? 1U : 0U;
+  case FEE_COPY:
+    return ((room - FEEPending) < FLASH_EE_SWAP_THRESHOLD) ? 1U : 0U;
+  default:
+    return 1;
+  }
+}
+
+/**
+  * @brief  Returns the emulation counters.
+  * @param  pStats: pointer to the counters.
+  * @retval None
+  */
+void BSP_FLASH_EE_GetStats(FLASH_EE_StatsTypeDef* pStats)
+{
+  *pStats = FEEStats;
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_FLASH_EEPROM_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  CRC-16/CCITT of an entry.
+  */
+static uint16_t FLASH_EE_Crc(uint16_t VirtAddress, uint32_t Data)
+{
+  uint8_t  bytes[6];
+  uint16_t crc = 0xFFFF;
+  uint32_t i, bit;
+
+  bytes[0] = (uint8_t)VirtAddress;
+  bytes[1] = (uint8_t)(VirtAddress >> 8);
+  bytes[2] = (uint8_t)Data;
+  bytes[3] = (uint8_t)(Data >> 8);
+  bytes[4] = (uint8_t)(Data >> 16);
+  bytes[5] = (uint8_t)(Data >> 24);
+  for (i = 0; i < sizeof(bytes); i++)
+  {
+    crc ^= (uint16_t)(bytes[i] << 8);
+    for (bit = 0; bit < 8U; bit++)
+    {
+      crc = ((crc & 0x8000U) != 0) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+  * @brief  Decodes the status half-word of a page.
+  * @note   A status programmed only part of the way from receive to valid
+  *         has no bit outside 0xEEEE set: it counts as valid. One torn on its
+  *         way from erased to receive has some of them set: it is invalid.
+  */
+static FEE_PageStateTypeDef FLASH_EE_PageState(uint32_t Page)
+{
+  uint16_t status = FEE_HALFWORD(FEE_PAGE_ADDR(Page));
+
+  if (status == FEE_STATUS_ERASED)
+  {
+    return FEE_PAGE_ERASED;
+  }
+  if (status == FEE_STATUS_RECEIVE)
+  {
+    return FEE_PAGE_RECEIVE;
+  }
+  if ((status & (uint16_t)~FEE_STATUS_RECEIVE) == 0)
+  {
+    return FEE_PAGE_VALID;
+  }
+  return FEE_PAGE_INVALID;
+}
+
+/**
+  * @brief  Checks that a page reads fully erased.
+  */
+static uint32_t FLASH_EE_PageBlank(uint32_t Page)
+{
+  uint32_t addr;
+
+  for (addr = FEE_PAGE_ADDR(Page); addr < FEE_PAGE_ADDR(Page + 1U); addr += 4U)
+  {
+    if (FEE_WORD(addr) != 0xFFFFFFFFUL)
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Erases one page. The flash must be unlocked.
+  */
+static uint32_t FLASH_EE_Erase(uint32_t Page)
+{
+  FLASH_EraseInitTypeDef erase;
+  uint32_t error;
+
+  erase.TypeErase = FLASH_TYPEERASE_PAGES;
+  erase.PageAddress = FEE_PAGE_ADDR(Page);
+  erase.NbPages = 1;
+  FEEStats.Erases++;
+  return (HAL_FLASHEx_Erase(&erase, &error) == HAL_OK) ? FLASH_EE_OK : FLASH_EE_FAIL;
+}
+
+/**
+  * @brief  Programs the header of a page: the generation first when the
+  *         page leaves the erased state, then the status. The flash must be
+  *         unlocked.
+  */
+static uint32_t FLASH_EE_SetStatus(uint32_t Page, uint16_t Status, uint32_t Generation)
+{
+  uint32_t addr = FEE_PAGE_ADDR(Page);
+
+  if ((FEE_HALFWORD(addr) == FEE_STATUS_ERASED) &&
+      (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + 4U, Generation) != HAL_OK))
+  {
+    return FLASH_EE_FAIL;
+  }
+  return (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr, Status) == HAL_OK) ? FLASH_EE_OK : FLASH_EE_FAIL;
+}
+
+/**
+  * @brief  Points the index at the valid entries of a page, in order.
+  * @retval First free entry of the page
+  */
+static uint16_t FLASH_EE_Scan(uint32_t Page)
+{
+  uint32_t addr, slot, data;
+  uint16_t var, crc;
+
+  for (slot = 0; slot < FLASH_EE_PAGE_ENTRIES; slot++)
+  {
+    addr = FEE_ENTRY_ADDR(Page, slot);
+    var = FEE_HALFWORD(addr);
+    data = FEE_HALFWORD(addr + 2U) | ((uint32_t)FEE_HALFWORD(addr + 4U) << 16);
+    crc = FEE_HALFWORD(addr + 6U);
+    if ((var == 0xFFFFU) && (data == 0xFFFFFFFFUL) && (crc == 0xFFFFU))
+    {
+      break;
+    }
+    /* Torn entries fail the CRC and keep their slot */
+    if ((var < FLASH_EE_VARIABLES) && (crc == FLASH_EE_Crc(var, data)))
+    {
+      FEEIndex[var] = FEE_SLOT(Page, slot);
+    }
+  }
+  return (uint16_t)slot;
+}
+
+/**
+  * @brief  Value of an entry. Entries are only half-word aligned.
+  */
+static uint32_t FLASH_EE_Load(uint16_t Slot)
+{
+  uint32_t addr = FEE_ENTRY_ADDR(FEE_SLOT_PAGE(Slot), FEE_SLOT_ENTRY(Slot));
+
+  return FEE_HALFWORD(addr + 2U) | ((uint32_t)FEE_HALFWORD(addr + 4U) << 16);
+}
+
+/**
+  * @brief  Programs an entry on the page being written and indexes it. The
+  *         flash must be unlocked and the page must have room.
+  */
+static uint32_t FLASH_EE_Append(uint16_t VirtAddress, uint32_t Data)
+{
+  uint32_t page = (FEEState >= FEE_COPY) ? FEERecv : FEEActive;
+  uint16_t slot = FEE_SLOT(page, FEEFree);
+  uint64_t entry;
+
+  entry = (uint64_t)VirtAddress | ((uint64_t)Data << 16) |
+          ((uint64_t)FLASH_EE_Crc(VirtAddress, Data) << 48);
+  /* The slot is used up even if programming fails */
+  FEEFree++;
+  if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, FEE_ENTRY_ADDR(page, FEE_SLOT_ENTRY(slot)), entry) != HAL_OK)
+  {
+    return FLASH_EE_FAIL;
+  }
+  if ((FEEState == FEE_COPY) && (FEEIndex[VirtAddress] != FEE_NO_ENTRY) &&
+      (FEE_SLOT_PAGE(FEEIndex[VirtAddress]) == FEEActive))
+  {
+    FEEPending--;
+  }
+  FEEIndex[VirtAddress] = slot;
+  FEEStats.Entries++;
+  return FLASH_EE_OK;
+}
+
+/**
+  * @brief  Tells whether one more entry can be written now. While copying,
+  *         the variables still on the old page keep their room on the new.
+  */
+static uint32_t FLASH_EE_HasRoom(void)
+{
+  if (FEEState == FEE_COPY)
+  {
+    return ((FLASH_EE_PAGE_ENTRIES - FEEFree) > FEEPending) ? 1U : 0U;
+  }
+  return (FEEFree < FLASH_EE_PAGE_ENTRIES) ? 1U : 0U;
+}
+
+/**
+  * @brief  Runs the next page swap step. The flash must be unlocked.
+  */
+static uint32_t FLASH_EE_SwapStep(void)
+{
+  uint32_t var, copied = 0, status = FLASH_EE_OK;
+
+  switch (FEEState)
+  {
+  case FEE_IDLE:
+    FEERecv = FEEActive ^ 1U;
+    FEEState = FEE_ERASE;
+    /* fall through */
+
+  case FEE_ERASE:
+    if ((FLASH_EE_PageBlank(FEERecv) == 0) && (FLASH_EE_Erase(FEERecv) != FLASH_EE_OK))
+    {
+      return FLASH_EE_FAIL;
+    }
+    FEEState = FEE_MARK;
+    break;
+
+  case FEE_MARK:
+    if (FLASH_EE_SetStatus(FEERecv, FEE_STATUS_RECEIVE, FEEGeneration + 1U) != FLASH_EE_OK)
+    {
+      FEEState = FEE_ERASE;
+      return FLASH_EE_FAIL;
+    }
+    FEEFree = 0;
+    FEECopyVar = 0;
+    FEEPending = 0;
+    for (var = 0; var < FLASH_EE_VARIABLES; var++)
+    {
+      if (FEEIndex[var] != FEE_NO_ENTRY)
+      {
+        FEEPending++;
+      }
+    }
+    FEEState = FEE_COPY;
+    break;
+
+  case FEE_COPY:
+    while ((copied < FLASH_EE_COPY_PER_CALL) && (FEECopyVar < FLASH_EE_VARIABLES))
+    {
+      uint16_t slot = FEEIndex[FEECopyVar];
+
+      if ((slot != FEE_NO_ENTRY) && (FEE_SLOT_PAGE(slot) == FEEActive))
+      {
+        status = FLASH_EE_Append(FEECopyVar, FLASH_EE_Load(slot));
+        if (status != FLASH_EE_OK)
+        {
+          return status;
+        }
+        FEEStats.Copies++;
+        copied++;
+      }
+      FEECopyVar++;
+    }
+    if (FEECopyVar == FLASH_EE_VARIABLES)
+    {
+      FEEState = FEE_RETIRE;
+    }
+    break;
+
+  case FEE_RETIRE:
+    if (FLASH_EE_Erase(FEEActive) != FLASH_EE_OK)
+    {
+      return FLASH_EE_FAIL;
+    }
+    FEEState = FEE_VALIDATE;
+    break;
+
+  case FEE_VALIDATE:
+    if (FLASH_EE_SetStatus(FEERecv, FEE_STATUS_VALID, 0) != FLASH_EE_OK)
+    {
+      return FLASH_EE_FAIL;
+    }
+    FEEActive = FEERecv;
+    FEERecv = FEE_NO_PAGE;
+    FEEGeneration++;
+    FEEStats.Generation = FEEGeneration;
+    FEEStats.Swaps++;
+    FEEState = FEE_IDLE;
+    break;
+
+  default:
+    break;
+  }
+  return status;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,123 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_flash_eeprom.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_flash_eeprom.c EEPROM emulation.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_FLASH_EEPROM_H
+#define __STM32072B_DISCOVERY_FLASH_EEPROM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f0xx_hal.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_FLASH_EEPROM STM32F072B_DISCOVERY FLASH EEPROM
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_FLASH_EEPROM_Exported_Constants Exported Constants
+  * @{
+  */
+
+/* First of the two flash pages used by the emulation: the last two pages of
+   the 128 KB flash, kept out of the FLASH region by STM32F072XX_FLASH.ld */
+#ifndef FLASH_EE_BASE
+#define FLASH_EE_BASE                (FLASH_BANK1_END + 1U - 2U * FLASH_PAGE_SIZE)
+#endif
+
+/* Number of variables, with virtual addresses 0 to FLASH_EE_VARIABLES - 1
+   (2 bytes of RAM each) */
+#ifndef FLASH_EE_VARIABLES
+#define FLASH_EE_VARIABLES           64
+#endif
+
+/* BSP_FLASH_EE_Process() prepares a page swap when fewer free entries than
+   this are left on the active page, and copies ahead so that as many stay
+   free on the new page */
+#ifndef FLASH_EE_SWAP_THRESHOLD
+#define FLASH_EE_SWAP_THRESHOLD      64
+#endif
+
+/* Variables copied to the new page per call of BSP_FLASH_EE_Process() */
+#ifndef FLASH_EE_COPY_PER_CALL
+#define FLASH_EE_COPY_PER_CALL       8
+#endif
+
+/* Entries per page: 8 bytes each, the first one holds the page header */
+#define FLASH_EE_PAGE_ENTRIES        ((FLASH_PAGE_SIZE / 8U) - 1U)
+
+/* Return codes */
+#define FLASH_EE_OK                  0
+#define FLASH_EE_FAIL                1
+#define FLASH_EE_NOT_FOUND           2
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_FLASH_EEPROM_Exported_Types Exported Types
+  * @{
+  */
+typedef struct
+{
+  uint32_t Writes;           /* Variables passed to BSP_FLASH_EE_Write() */
+  uint32_t Skipped;          /* Writes dropped because the value was unchanged */
+  uint32_t Entries;          /* Entries programmed, copies included */
+  uint32_t Copies;           /* Entries moved by page swaps */
+  uint32_t Swaps;            /* Page swaps completed */
+  uint32_t Erases;           /* Page erases */
+  uint32_t SyncSteps;        /* Swap steps done by a write that found no room */
+  uint32_t Generation;       /* Page swaps over the life of the device */
+} FLASH_EE_StatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_FLASH_EEPROM_Exported_Functions Exported Functions
+  * @{
+  */
+uint32_t BSP_FLASH_EE_Init(void);
+uint32_t BSP_FLASH_EE_Format(void);
+uint32_t BSP_FLASH_EE_Read(uint16_t VirtAddress, uint32_t* pData);
+uint32_t BSP_FLASH_EE_Write(uint16_t VirtAddress, uint32_t Data);
+uint32_t BSP_FLASH_EE_WriteMulti(const uint16_t* pVirtAddress, const uint32_t* pData, uint32_t Count);
+uint32_t BSP_FLASH_EE_Process(void);
+uint32_t BSP_FLASH_EE_SwapPending(void);
+void     BSP_FLASH_EE_GetStats(FLASH_EE_StatsTypeDef* pStats);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_FLASH_EEPROM_H */
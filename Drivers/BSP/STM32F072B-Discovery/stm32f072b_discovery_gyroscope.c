@@ -4,6 +4,27 @@
   * @author  MCD Application Team
   * @brief   This file provides a set of functions needed to manage the l3gd20
   *          MEMS accelerometer available on STM32F072B-Discovery Kit.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - BSP_GYRO_StreamStart() puts the gyroscope FIFO in stream mode
+  *             with its watermark signal on INT2. At each INT2 rising edge
+  *             BSP_GYRO_StreamIRQHandler() reads the FIFO level and pulls all
+  *             the stored samples in one SPI DMA burst; the callback gets
+  *             them, X, Y, Z raw values per sample, from the DMA interrupt.
+  *             The buffer is reused after the callback returns.
+  *           - The application calls BSP_GYRO_StreamIRQHandler() from
+  *             HAL_GPIO_EXTI_Callback() for GYRO_INT2_PIN, and
+  *             HAL_DMA_IRQHandler() for SpiHandle.hdmarx and hdmatx from
+  *             DMA1_Channel4_5_6_7_IRQHandler().
+  *           - While streaming, the other gyroscope functions must not be
+  *             used: they would share the SPI bus with the bursts.
+  *           - BSP_GYRO_GetXYZQ16() and GYRO_RAW_TO_Q16() give Q16.16 dps
+  *             with integer arithmetic only. With GYRO_FIXED_POINT_ONLY
+  *             defined, the float ReadXYZAngRate functions are left out of
+  *             the component drivers, and the soft-float routines out of
+  *             the image; BSP_GYRO_GetXYZ() then does nothing.
+  *          ===================================================================
   ******************************************************************************
   * @attention
   *
@@ -34,7 +55,14 @@
 /** @defgroup STM32F072B_DISCOVERY_GYRO_Private_Variables Private Variables
   * @{
   */
-static GYRO_DrvTypeDef *GyroscopeDrv;
+static GYRO_DrvTypeDef        *GyroscopeDrv;
+static void                  (*GyroStreamCallback)(int16_t* pSamples, uint32_t Count);
+static __IO uint8_t            GyroStreaming;
+static __IO uint8_t            GyroBurst;          /* DMA burst in progress */
+static uint32_t                GyroBurstCount;
+static GYRO_StreamStatsTypeDef GyroStats;
+/* X, Y, Z per sample: little endian as set by BSP_GYRO_Init(), like the CPU */
+static int16_t                 GyroFifo[GYRO_FIFO_SAMPLES * 3U];
 
 /**
   * @}
@@ -210,6 +238,148 @@ void BSP_GYRO_GetXYZ(float *pfData)
   }
 }
 
+/**
+  * @brief  Get XYZ angular rate in Q16.16 dps
+  * @param  pData pointer on Q16.16 array
+  * @retval None
+  */
+void BSP_GYRO_GetXYZQ16(int32_t *pData)
+{
+  if (GyroscopeDrv->GetXYZQ16 != NULL)
+  {
+    GyroscopeDrv->GetXYZQ16(pData);
+  }
+}
+
+/**
+  * @brief  Starts streaming the samples through the gyroscope FIFO.
+  * @note   Samples come at the output data rate set by BSP_GYRO_Init(), in
+  *         bursts of GYRO_FIFO_WATERMARK samples or more.
+  * @param  Callback  called from the DMA interrupt with each burst.
+  * @retval GYRO_OK if started
+  */
+uint8_t BSP_GYRO_StreamStart(void (*Callback)(int16_t* pSamples, uint32_t Count))
+{
+  if ((GyroscopeDrv == NULL) || (GyroscopeDrv->FIFOConfig == NULL) || (Callback == NULL))
+  {
+    return GYRO_ERROR;
+  }
+  GyroStreamCallback = Callback;
+  GyroBurst = 0;
+  GyroStreaming = 1;
+
+  /* Stream mode, watermark on INT2 (both components share the register map) */
+  GyroscopeDrv->FIFOConfig((uint16_t)(L3GD20_FIFO_MODE_STREAM | (GYRO_FIFO_WATERMARK & L3GD20_FIFO_WATERMARK)) |
+                           ((uint16_t)L3GD20_INT2_FIFO_WTM << 8));
+  GYRO_IO_INT2Config(1);
+  return GYRO_OK;
+}
+
+/**
+  * @brief  Stops streaming and puts the FIFO back in bypass mode.
+  * @retval None
+  */
+void BSP_GYRO_StreamStop(void)
+{
+  uint32_t tickstart;
+
+  if (GyroStreaming == 0)
+  {
+    return;
+  }
+  GyroStreaming = 0;
+  GYRO_IO_INT2Config(0);
+  tickstart = HAL_GetTick();
+  while ((GyroBurst != 0) && ((HAL_GetTick() - tickstart) < GYRO_BURST_TIMEOUT))
+  {
+  }
+  GyroscopeDrv->FIFOConfig(L3GD20_FIFO_MODE_BYPASS);
+}
+
+/**
+  * @brief  Starts a FIFO burst: to be called from the INT2 EXTI interrupt.
+  * @retval None
+  */
+void BSP_GYRO_StreamIRQHandler(void)
+{
+  uint8_t  status;
+  uint32_t count;
+
+  if ((GyroStreaming == 0) || (GyroBurst != 0))
+  {
+    return;
+  }
+  status = GyroscopeDrv->FIFOStatus();
+  if ((status & L3GD20_FIFO_SRC_OVERRUN) != 0)
+  {
+    count = GYRO_FIFO_SAMPLES;
+    GyroStats.Overruns++;
+  }
+  else if ((status & L3GD20_FIFO_SRC_EMPTY) != 0)
+  {
+    count = 0;
+  }
+  else
+  {
+    count = status & L3GD20_FIFO_SRC_LEVEL;
+  }
+  if (count == 0)
+  {
+    return;
+  }
+
+  /* The address wraps from OUT_Z_H back to OUT_X_L in FIFO mode */
+  GyroBurst = 1;
+  GyroBurstCount = count;
+  if (GYRO_IO_ReadDMA((uint8_t*)GyroFifo, L3GD20_OUT_X_L_ADDR, (uint16_t)(count * 6U)) != 0)
+  {
+    GyroStats.Errors++;
+    GyroBurst = 0;
+  }
+}
+
+/**
+  * @brief  Returns the stream counters.
+  * @param  pStats  pointer to the structure to fill.
+  * @retval None
+  */
+void BSP_GYRO_GetStreamStats(GYRO_StreamStatsTypeDef* pStats)
+{
+  *pStats = GyroStats;
+}
+
+/**
+  * @brief  End of a FIFO burst, from the link layer.
+  * @retval None
+  */
+void GYRO_IO_RxCpltCallback(void)
+{
+  GyroStats.Bursts++;
+  GyroStats.Samples += GyroBurstCount;
+  GyroStreamCallback(GyroFifo, GyroBurstCount);
+  GyroBurst = 0;
+
+  /* Still at the watermark: no new edge will come */
+  if (GyroStreaming != 0)
+  {
+    GYRO_IO_INT2Check();
+  }
+}
+
+/**
+  * @brief  Failure of a FIFO burst, from the link layer.
+  * @retval None
+  */
+void GYRO_IO_ErrorCallback(void)
+{
+  GyroStats.Errors++;
+  GyroBurst = 0;
+  if (GyroStreaming != 0)
+  {
+    GYRO_IO_INT2Check();
+  }
+}
+
 /**
   * @}
   */
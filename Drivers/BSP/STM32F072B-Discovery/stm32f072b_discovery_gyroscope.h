@@ -55,9 +55,37 @@ typedef enum
 } 
 GYRO_StatusTypeDef;
 
+typedef struct
+{
+  uint32_t Bursts;           /* DMA bursts completed */
+  uint32_t Samples;          /* Samples delivered */
+  uint32_t Overruns;         /* Bursts that found the FIFO full: older samples may be lost */
+  uint32_t Errors;           /* Bursts that failed */
+} GYRO_StreamStatsTypeDef;
+
 /**
   * @}
   */ 
+
+/** @defgroup STM32F072B_DISCOVERY_GYRO_Exported_Constants Exported Constants
+  * @{
+  */
+/* FIFO level (samples) that raises INT2 in stream mode; the burst then takes
+   every stored sample, up to GYRO_FIFO_SAMPLES */
+#ifndef GYRO_FIFO_WATERMARK
+#define GYRO_FIFO_WATERMARK          28U
+#endif
+#define GYRO_FIFO_SAMPLES            32U
+/* Longest wait, in ms, for a burst in progress when the stream stops */
+#define GYRO_BURST_TIMEOUT           2U
+
+/* Q16.16 dps of a raw sample, such as the stream ones, at the 500 dps full
+   scale set by BSP_GYRO_Init() (same sensitivity on both components) */
+#define GYRO_RAW_TO_Q16(raw)         L3GD20_RAW_TO_Q16((raw), L3GD20_SENSITIVITY_500DPS_Q16_SHIFT)
+
+/**
+  * @}
+  */
  
 /** @defgroup STM32F072B_DISCOVERY_GYRO_Exported_Functions Exported Functions
   * @{
@@ -70,6 +98,21 @@ void    BSP_GYRO_ITConfig(GYRO_InterruptConfigTypeDef *pIntConfigStruct);
 void    BSP_GYRO_EnableIT(uint8_t IntPin);
 void    BSP_GYRO_DisableIT(uint8_t IntPin);
 void    BSP_GYRO_GetXYZ(float* pfData);
+void    BSP_GYRO_GetXYZQ16(int32_t* pData);
+
+/* FIFO stream */
+uint8_t BSP_GYRO_StreamStart(void (*Callback)(int16_t* pSamples, uint32_t Count));
+void    BSP_GYRO_StreamStop(void);
+void    BSP_GYRO_StreamIRQHandler(void);
+void    BSP_GYRO_GetStreamStats(GYRO_StreamStatsTypeDef* pStats);
+
+/* Link functions for the gyroscope FIFO bursts */
+uint32_t GYRO_IO_ReadDMA(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead);
+void     GYRO_IO_INT2Config(uint32_t Enable);
+void     GYRO_IO_INT2Check(void);
+/* Called by the link layer at the end of a DMA burst */
+void     GYRO_IO_RxCpltCallback(void);
+void     GYRO_IO_ErrorCallback(void);
 
 /**
   * @}
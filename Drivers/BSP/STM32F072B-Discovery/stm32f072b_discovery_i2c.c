@@ -0,0 +1,665 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_i2c.c
+  * @brief   This file provides a transaction scheduler for the I2C2 bus,
+  *          shared by the M24LR64 EEPROM and the STLM75 temperature sensor.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - Drivers describe each transfer in an I2C_TransactionTypeDef and
+  *             hand it to BSP_I2C_Submit(), from thread or interrupt context.
+  *             The scheduler owns it until its Status leaves I2C_XFER_BUSY;
+  *             the optional callback then runs in interrupt context.
+  *             BSP_I2C_Transfer() is the blocking form.
+  *           - There is one FIFO per priority. The next transaction starts from
+  *             the completion interrupt of the previous one, before any
+  *             callback runs, so DMA transfers follow each other back to back.
+  *           - When a read starts, the queued reads of the same device that
+  *             ask for the same bytes, or for contiguous bytes of a device
+  *             with I2C_XFER_AUTOINC set, join it: one transfer of up to
+  *             I2C_MERGE_MAX bytes serves them all. Merging stops at the
+  *             first queued write to the device, whatever its priority: the
+  *             reads behind it, in its FIFO or in a lower one, must see what
+  *             it writes.
+  *           - A NACK ends the transaction: the device decides (an EEPROM in
+  *             its write cycle, a missing sensor). A bus fault, a failed start
+  *             or a transfer with no completion within its time limit resets
+  *             the bus through I2C_IO_Recover() and the transaction is tried
+  *             again, up to I2C_XFER_RETRIES times. The queue is left as is.
+  *             The reset runs with interrupts enabled, before the callbacks;
+  *             nothing starts on the bus until it is done.
+  *           - Timeouts are checked by BSP_I2C_TickHandler(), to be called
+  *             from SysTick_Handler(). BSP_I2C_Probe() addresses a device
+  *             once when the bus is free, and may be used from SysTick too:
+  *             I2C_IO_Probe() bounds its wait without HAL_GetTick().
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_i2c.h"
+#include <string.h>
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_I2C
+  * @brief      I2C2 transaction scheduler.
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_I2C_Private_Constants Private Constants
+  * @{
+  */
+#define I2C_RECOVERY_NONE       0U
+#define I2C_RECOVERY_PENDING    1U      /* Bus to reset, nothing starts */
+#define I2C_RECOVERY_RUNNING    2U      /* I2C_IO_Recover() in progress */
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_I2C_Private_Variables Private Variables
+  * @{
+  */
+static I2C_TransactionTypeDef*          I2CQueueHead[I2C_PRIORITIES];
+static I2C_TransactionTypeDef*          I2CQueueTail[I2C_PRIORITIES];
+static uint32_t                         I2CQueued;
+static I2C_TransactionTypeDef* volatile I2CCurrent;    /* Transaction on the bus */
+static I2C_TransactionTypeDef*          I2CFollowers;  /* Reads merged into it */
+static __IO uint8_t                     I2CProbing;    /* BSP_I2C_Probe() owns the bus */
+static __IO uint8_t                     I2CRecovery;   /* I2C_RECOVERY_xxx */
+static uint8_t                          I2CMerging;    /* Transfer goes through I2CMergeBuffer */
+static uint16_t                         I2CMergeAddr;
+static uint16_t                         I2CMergeSize;
+static uint32_t                         I2CStartTick;
+static uint32_t                         I2CTimeLimit;
+static I2C_TransactionTypeDef*          I2CDoneHead;   /* Completed, callbacks pending */
+static I2C_TransactionTypeDef*          I2CDoneTail;
+static uint8_t                          I2CMergeBuffer[I2C_MERGE_MAX];
+static I2C_StatsTypeDef                 I2CStats;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_I2C_Private_Functions Private Functions
+  * @{
+  */
+static void     I2C_Push(I2C_TransactionTypeDef* pXfer, uint32_t Front);
+static void     I2C_Done(I2C_TransactionTypeDef* pXfer, uint32_t Result);
+static void     I2C_Merge(void);
+static void     I2C_Dispatch(void);
+static void     I2C_Fault(uint32_t Result);
+static void     I2C_Recover(void);
+static void     I2C_Notify(void);
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_I2C_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Initializes the I2C bus used by the scheduler.
+  * @note   May be called by every driver of the bus: queued transactions are
+  *         kept.
+  * @retval None
+  */
+void BSP_I2C_Init(void)
+{
+  I2C_IO_Init();
+}
+
+/**
+  * @brief  Queues a transaction, and starts it if the bus is free.
+  * @param  pXfer  transaction, owned by the scheduler until completion.
+  * @retval I2C_XFER_OK (0) if queued, I2C_XFER_ERROR if the transaction is
+  *         empty or still pending
+  */
+uint32_t BSP_I2C_Submit(I2C_TransactionTypeDef* pXfer)
+{
+  uint32_t primask;
+
+  if ((pXfer->Size == 0) || (pXfer->Priority >= I2C_PRIORITIES) || (pXfer->Status == I2C_XFER_BUSY))
+  {
+    return I2C_XFER_ERROR;
+  }
+  pXfer->Attempts = 0;
+  pXfer->Status = I2C_XFER_BUSY;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  I2CStats.Submitted++;
+  I2C_Push(pXfer, 0);
+  I2C_Dispatch();
+  __set_PRIMASK(primask);
+
+  I2C_Notify();
+  return I2C_XFER_OK;
+}
+
+/**
+  * @brief  Queues a transaction and waits for its completion.
+  * @note   The completion comes from the DMA interrupt: do not call with
+  *         interrupts masked, or from an interrupt of the same or a higher
+  *         priority (SysTick is lower than DISCOVERY_EEPROM_DMA_PREPRIO).
+  *         Runs BSP_I2C_TickHandler() itself, so it ends even where
+  *         SysTick_Handler() does not call it.
+  * @param  pXfer  transaction.
+  * @retval Final status of the transaction: I2C_XFER_OK (0), I2C_XFER_NACK,
+  *         I2C_XFER_ERROR or I2C_XFER_TIMEOUT
+  */
+uint32_t BSP_I2C_Transfer(I2C_TransactionTypeDef* pXfer)
+{
+  uint32_t tick;
+
+  if (BSP_I2C_Submit(pXfer) != I2C_XFER_OK)
+  {
+    return I2C_XFER_ERROR;
+  }
+  tick = HAL_GetTick();
+  while (pXfer->Status == I2C_XFER_BUSY)
+  {
+    if (HAL_GetTick() != tick)
+    {
+      tick = HAL_GetTick();
+      BSP_I2C_TickHandler();
+    }
+  }
+  return pXfer->Status;
+}
+
+/**
+  * @brief  Addresses a device once, if the bus is free.
+  * @note   Does not wait: usable from SysTick_Handler() to poll the end of an
+  *         EEPROM write cycle. Queued transactions go first.
+  * @param  DevAddress  device address.
+  * @retval HAL_OK if the device acknowledged, HAL_BUSY if the bus is in use,
+  *         HAL_ERROR otherwise
+  */
+HAL_StatusTypeDef BSP_I2C_Probe(uint16_t DevAddress)
+{
+  HAL_StatusTypeDef status;
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if ((I2CCurrent != NULL) || (I2CProbing != 0) || (I2CRecovery != I2C_RECOVERY_NONE))
+  {
+    __set_PRIMASK(primask);
+    return HAL_BUSY;
+  }
+  I2CProbing = 1;
+  __set_PRIMASK(primask);
+
+  status = I2C_IO_Probe(DevAddress);
+
+  __disable_irq();
+  I2CProbing = 0;
+  if (status == HAL_TIMEOUT)
+  {
+    /* The bus is stuck: reset it, the caller tries again */
+    I2CStats.Recoveries++;
+    I2CRecovery = I2C_RECOVERY_PENDING;
+    status = HAL_BUSY;
+  }
+  I2C_Dispatch();
+  __set_PRIMASK(primask);
+
+  I2C_Notify();
+  return status;
+}
+
+/**
+  * @brief  Ends a transfer that overran its time limit: resets the bus and
+  *         tries the transaction again.
+  * @note   Call every millisecond, from SysTick_Handler() after HAL_IncTick().
+  * @retval None
+  */
+void BSP_I2C_TickHandler(void)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if ((I2CCurrent != NULL) && ((HAL_GetTick() - I2CStartTick) > I2CTimeLimit))
+  {
+    I2C_Fault(I2C_XFER_TIMEOUT);
+    I2C_Dispatch();
+  }
+  __set_PRIMASK(primask);
+
+  I2C_Notify();
+}
+
+/**
+  * @brief  Returns the scheduler counters.
+  * @param  pStats  pointer to the structure to fill.
+  * @retval None
+  */
+void BSP_I2C_GetStats(I2C_StatsTypeDef* pStats)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *pStats = I2CStats;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  End of the current transfer, from the link layer.
+  * @note   Hands out the data of merged reads and starts the next transfer
+  *         before the completion callbacks run.
+  * @retval None
+  */
+void BSP_I2C_XferCpltCallback(void)
+{
+  I2C_TransactionTypeDef* xfer;
+  I2C_TransactionTypeDef* next;
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  xfer = I2CCurrent;
+  if (xfer != NULL)
+  {
+    I2CCurrent = NULL;
+    if (I2CMerging != 0)
+    {
+      memcpy(xfer->pBuffer, &I2CMergeBuffer[xfer->MemAddress - I2CMergeAddr], xfer->Size);
+    }
+    for (next = I2CFollowers; next != NULL; next = I2CFollowers)
+    {
+      I2CFollowers = next->pNext;
+      if (I2CMerging != 0)
+      {
+        memcpy(next->pBuffer, &I2CMergeBuffer[next->MemAddress - I2CMergeAddr], next->Size);
+      }
+      else
+      {
+        /* Inside the range of the first one, not always at its start */
+        memcpy(next->pBuffer, &xfer->pBuffer[next->MemAddress - I2CMergeAddr], next->Size);
+      }
+      I2C_Done(next, I2C_XFER_OK);
+    }
+    I2C_Done(xfer, I2C_XFER_OK);
+    I2C_Dispatch();
+  }
+  __set_PRIMASK(primask);
+
+  I2C_Notify();
+}
+
+/**
+  * @brief  Failure of the current transfer, from the link layer.
+  * @param  Nack  1 if the device did not acknowledge, 0 for a bus fault.
+  * @retval None
+  */
+void BSP_I2C_XferErrorCallback(uint32_t Nack)
+{
+  I2C_TransactionTypeDef* xfer;
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (I2CCurrent != NULL)
+  {
+    if (Nack != 0)
+    {
+      /* The followers address the same device and would not get an ACK either */
+      I2CStats.Nacks++;
+      for (xfer = I2CFollowers; xfer != NULL; xfer = I2CFollowers)
+      {
+        I2CFollowers = xfer->pNext;
+        I2C_Done(xfer, I2C_XFER_NACK);
+      }
+      xfer = I2CCurrent;
+      I2CCurrent = NULL;
+      I2C_Done(xfer, I2C_XFER_NACK);
+    }
+    else
+    {
+      I2C_Fault(I2C_XFER_ERROR);
+    }
+    I2C_Dispatch();
+  }
+  __set_PRIMASK(primask);
+
+  I2C_Notify();
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_I2C_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Adds a transaction to the queue of its priority, at the back, or
+  *         at the front for a new attempt. Interrupts masked.
+  */
+static void I2C_Push(I2C_TransactionTypeDef* pXfer, uint32_t Front)
+{
+  uint32_t prio = pXfer->Priority;
+
+  if (Front != 0)
+  {
+    pXfer->pNext = I2CQueueHead[prio];
+    I2CQueueHead[prio] = pXfer;
+    if (I2CQueueTail[prio] == NULL)
+    {
+      I2CQueueTail[prio] = pXfer;
+    }
+  }
+  else
+  {
+    pXfer->pNext = NULL;
+    if (I2CQueueHead[prio] == NULL)
+    {
+      I2CQueueHead[prio] = pXfer;
+    }
+    else
+    {
+      I2CQueueTail[prio]->pNext = pXfer;
+    }
+    I2CQueueTail[prio] = pXfer;
+  }
+  if (++I2CQueued > I2CStats.MaxQueued)
+  {
+    I2CStats.MaxQueued = I2CQueued;
+  }
+}
+
+/**
+  * @brief  Moves a transaction to the completed list. Interrupts masked.
+  */
+static void I2C_Done(I2C_TransactionTypeDef* pXfer, uint32_t Result)
+{
+  pXfer->Result = (uint8_t)Result;
+  pXfer->pNext = NULL;
+  if (I2CDoneHead == NULL)
+  {
+    I2CDoneHead = pXfer;
+  }
+  else
+  {
+    I2CDoneTail->pNext = pXfer;
+  }
+  I2CDoneTail = pXfer;
+  if ((Result == I2C_XFER_ERROR) || (Result == I2C_XFER_TIMEOUT))
+  {
+    I2CStats.Failed++;
+  }
+}
+
+/**
+  * @brief  Takes the queued reads that the read about to start can serve.
+  *         Interrupts masked.
+  */
+static void I2C_Merge(void)
+{
+  I2C_TransactionTypeDef* head = I2CCurrent;
+  I2C_TransactionTypeDef* x;
+  I2C_TransactionTypeDef* prev;
+  I2C_TransactionTypeDef* next;
+  I2C_TransactionTypeDef* last = NULL;
+  uint32_t lo = head->MemAddress, hi = lo + head->Size;
+  uint32_t xlo, xhi, nlo, nhi, prio, same, write = 0;
+
+  I2CFollowers = NULL;
+  I2CMerging = 0;
+  for (prio = 0; (prio < I2C_PRIORITIES) && (write == 0); prio++)
+  {
+    prev = NULL;
+    for (x = I2CQueueHead[prio]; x != NULL; x = next)
+    {
+      next = x->pNext;
+      if (x->DevAddress != head->DevAddress)
+      {
+        prev = x;
+        continue;
+      }
+      if (x->Write != 0)
+      {
+        /* It runs before every read behind it and in the lower FIFOs */
+        write = 1;
+        break;
+      }
+      xlo = x->MemAddress;
+      xhi = xlo + x->Size;
+      nlo = (xlo < lo) ? xlo : lo;
+      nhi = (xhi > hi) ? xhi : hi;
+      same = ((xlo == head->MemAddress) && (x->Size == head->Size)) ? 1U : 0U;
+      if ((x->MemAddSize != head->MemAddSize) ||
+          ((same == 0) && (((x->Flags & head->Flags & I2C_XFER_AUTOINC) == 0) ||
+                           (xlo > hi) || (xhi < lo) || ((nhi - nlo) > I2C_MERGE_MAX))))
+      {
+        prev = x;
+        continue;
+      }
+
+      /* Unlink it from its queue and add it to the followers */
+      if (prev == NULL)
+      {
+        I2CQueueHead[prio] = next;
+      }
+      else
+      {
+        prev->pNext = next;
+      }
+      if (I2CQueueTail[prio] == x)
+      {
+        I2CQueueTail[prio] = prev;
+      }
+      I2CQueued--;
+      x->pNext = NULL;
+      if (last == NULL)
+      {
+        I2CFollowers = x;
+      }
+      else
+      {
+        last->pNext = x;
+      }
+      last = x;
+      I2CStats.Merged++;
+      lo = nlo;
+      hi = nhi;
+    }
+  }
+  I2CMergeAddr = (uint16_t)lo;
+  I2CMergeSize = (uint16_t)(hi - lo);
+  /* Reads inside the first one's range: the data lands in its buffer and
+     each follower copies its part from there */
+  I2CMerging = (I2CMergeSize != head->Size) ? 1U : 0U;
+}
+
+/**
+  * @brief  Starts the next queued transaction if the bus is free.
+  *         Interrupts masked.
+  */
+static void I2C_Dispatch(void)
+{
+  I2C_TransactionTypeDef* xfer;
+  HAL_StatusTypeDef status;
+  uint32_t prio;
+
+  while ((I2CCurrent == NULL) && (I2CProbing == 0) && (I2CRecovery == I2C_RECOVERY_NONE))
+  {
+    for (prio = 0; (prio < I2C_PRIORITIES) && (I2CQueueHead[prio] == NULL); prio++)
+    {
+    }
+    if (prio == I2C_PRIORITIES)
+    {
+      return;
+    }
+    xfer = I2CQueueHead[prio];
+    I2CQueueHead[prio] = xfer->pNext;
+    if (I2CQueueHead[prio] == NULL)
+    {
+      I2CQueueTail[prio] = NULL;
+    }
+    I2CQueued--;
+    xfer->pNext = NULL;
+    I2CCurrent = xfer;
+
+    if (xfer->Write != 0)
+    {
+      I2CFollowers = NULL;
+      I2CMerging = 0;
+      I2CMergeAddr = xfer->MemAddress;
+      I2CMergeSize = xfer->Size;
+    }
+    else
+    {
+      I2C_Merge();
+    }
+
+    I2CStats.Transfers++;
+    I2CStartTick = HAL_GetTick();
+    I2CTimeLimit = I2C_XFER_TIMEOUT + I2CMergeSize / 8U;
+    if (xfer->Write != 0)
+    {
+      status = I2C_IO_MemWriteDMA(xfer->DevAddress, xfer->MemAddress, xfer->MemAddSize, xfer->pBuffer, xfer->Size);
+    }
+    else
+    {
+      status = I2C_IO_MemReadDMA(xfer->DevAddress, I2CMergeAddr, xfer->MemAddSize,
+                                 (I2CMerging != 0) ? I2CMergeBuffer : xfer->pBuffer, I2CMergeSize);
+    }
+    if (status != HAL_OK)
+    {
+      I2C_Fault(I2C_XFER_ERROR);
+    }
+  }
+}
+
+/**
+  * @brief  Marks the bus for a reset after a fault and queues the current
+  *         transaction again, or ends it once out of attempts. The followers
+  *         go back to the front of their queues. Interrupts masked: the reset
+  *         itself is left to I2C_Recover().
+  */
+static void I2C_Fault(uint32_t Result)
+{
+  I2C_TransactionTypeDef* xfer = I2CCurrent;
+  I2C_TransactionTypeDef* rev = NULL;
+  I2C_TransactionTypeDef* next;
+
+  I2CStats.Recoveries++;
+  I2CRecovery = I2C_RECOVERY_PENDING;
+  I2CCurrent = NULL;
+
+  /* Reverse the followers so that pushing each to the front keeps the order */
+  while (I2CFollowers != NULL)
+  {
+    next = I2CFollowers->pNext;
+    I2CFollowers->pNext = rev;
+    rev = I2CFollowers;
+    I2CFollowers = next;
+  }
+  for (; rev != NULL; rev = next)
+  {
+    next = rev->pNext;
+    I2C_Push(rev, 1);
+  }
+
+  if (++xfer->Attempts > I2C_XFER_RETRIES)
+  {
+    I2C_Done(xfer, Result);
+  }
+  else
+  {
+    I2C_Push(xfer, 1);
+  }
+}
+
+/**
+  * @brief  Resets the bus if a fault asked for it, then starts the next
+  *         transaction. Outside the masked sections: HAL_I2C_DeInit(),
+  *         HAL_I2C_Init() and the DMA aborts run with interrupts enabled.
+  */
+static void I2C_Recover(void)
+{
+  uint32_t primask;
+
+  for (;;)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (I2CRecovery != I2C_RECOVERY_PENDING)
+    {
+      __set_PRIMASK(primask);
+      return;
+    }
+    I2CRecovery = I2C_RECOVERY_RUNNING;
+    __set_PRIMASK(primask);
+
+    I2C_IO_Recover();
+
+    __disable_irq();
+    I2CRecovery = I2C_RECOVERY_NONE;
+    I2C_Dispatch();
+    __set_PRIMASK(primask);
+  }
+}
+
+/**
+  * @brief  Resets the bus if needed, then publishes the status of the
+  *         completed transactions and runs their callbacks, with interrupts
+  *         enabled again.
+  */
+static void I2C_Notify(void)
+{
+  I2C_TransactionTypeDef* xfer;
+  uint32_t primask;
+
+  I2C_Recover();
+  for (;;)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    xfer = I2CDoneHead;
+    if (xfer != NULL)
+    {
+      I2CDoneHead = xfer->pNext;
+    }
+    __set_PRIMASK(primask);
+    if (xfer == NULL)
+    {
+      return;
+    }
+    /* From here on the owner may reuse it */
+    xfer->Status = xfer->Result;
+    if (xfer->Callback != NULL)
+    {
+      xfer->Callback(xfer);
+    }
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,149 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_i2c.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_i2c.c I2C transaction scheduler.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_I2C_H
+#define __STM32072B_DISCOVERY_I2C_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f0xx_hal.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_I2C STM32F072B_DISCOVERY I2C
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_I2C_Exported_Constants Exported Constants
+  * @{
+  */
+
+/* Transaction priorities, served in this order; FIFO within a priority */
+#define I2C_PRIORITY_HIGH            0U
+#define I2C_PRIORITY_NORMAL          1U
+#define I2C_PRIORITY_LOW             2U
+#define I2C_PRIORITIES               3U
+
+/* Transaction flags */
+#define I2C_XFER_AUTOINC             0x01U   /* The device steps its register address on
+                                                reads: contiguous reads may be merged */
+
+/* Transaction status */
+#define I2C_XFER_OK                  0U
+#define I2C_XFER_NACK                1U      /* The device did not acknowledge */
+#define I2C_XFER_ERROR               2U      /* Bus fault, still there after the retries */
+#define I2C_XFER_TIMEOUT             3U      /* No completion, still none after the retries */
+#define I2C_XFER_BUSY                4U      /* Queued or on the bus */
+
+/* Largest read made of merged requests, in bytes */
+#ifndef I2C_MERGE_MAX
+#define I2C_MERGE_MAX                32U
+#endif
+
+/* Bus recoveries and new attempts after a fault, before a transaction fails */
+#ifndef I2C_XFER_RETRIES
+#define I2C_XFER_RETRIES             3U
+#endif
+
+/* Time allowed for a transfer: this many ms, plus 1 ms per 8 bytes (100 kHz) */
+#ifndef I2C_XFER_TIMEOUT
+#define I2C_XFER_TIMEOUT             10U
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_I2C_Exported_Types Exported Types
+  * @{
+  */
+typedef struct __I2C_TransactionTypeDef
+{
+  uint16_t DevAddress;       /* 8-bit device address */
+  uint16_t MemAddress;       /* Register or memory address */
+  uint16_t MemAddSize;       /* I2C_MEMADD_SIZE_8BIT or I2C_MEMADD_SIZE_16BIT */
+  uint16_t Size;             /* Data bytes, at least 1 */
+  uint8_t* pBuffer;          /* Data, left untouched until completion */
+  uint8_t  Write;            /* 1 to write pBuffer, 0 to read into it */
+  uint8_t  Priority;         /* I2C_PRIORITY_xxx */
+  uint8_t  Flags;            /* I2C_XFER_xxx flags */
+  uint8_t  Attempts;         /* Driver owned */
+  uint8_t  Result;           /* Driver owned */
+  __IO uint32_t Status;      /* I2C_XFER_BUSY until completion */
+  void   (*Callback)(struct __I2C_TransactionTypeDef* pXfer);
+  void*    pContext;         /* For the caller */
+  struct __I2C_TransactionTypeDef* pNext;  /* Driver owned */
+} I2C_TransactionTypeDef;
+
+typedef struct
+{
+  uint32_t Submitted;        /* Transactions accepted */
+  uint32_t Transfers;        /* DMA transfers started, retries included */
+  uint32_t Merged;           /* Reads served by the transfer of another one */
+  uint32_t Nacks;            /* Transfers not acknowledged */
+  uint32_t Recoveries;       /* Bus resets after a fault or a timeout */
+  uint32_t Failed;           /* Transactions ended with an error or a timeout */
+  uint32_t MaxQueued;        /* Most transactions waiting at once */
+} I2C_StatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_I2C_Exported_Functions Exported Functions
+  * @{
+  */
+void              BSP_I2C_Init(void);
+uint32_t          BSP_I2C_Submit(I2C_TransactionTypeDef* pXfer);
+uint32_t          BSP_I2C_Transfer(I2C_TransactionTypeDef* pXfer);
+HAL_StatusTypeDef BSP_I2C_Probe(uint16_t DevAddress);
+void              BSP_I2C_TickHandler(void);
+void              BSP_I2C_GetStats(I2C_StatsTypeDef* pStats);
+
+/* Called by the link layer from the I2C and DMA interrupts */
+void              BSP_I2C_XferCpltCallback(void);
+void              BSP_I2C_XferErrorCallback(uint32_t Nack);
+
+/* Link functions for the I2C bus */
+void              I2C_IO_Init(void);
+void              I2C_IO_Recover(void);
+HAL_StatusTypeDef I2C_IO_MemWriteDMA(uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pBuffer, uint16_t Size);
+HAL_StatusTypeDef I2C_IO_MemReadDMA(uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pBuffer, uint16_t Size);
+HAL_StatusTypeDef I2C_IO_Probe(uint16_t DevAddress);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_I2C_H */
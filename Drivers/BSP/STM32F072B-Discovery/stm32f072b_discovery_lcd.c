@@ -0,0 +1,747 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_lcd.c
+  * @brief   This file provides a tile renderer for the ST7735 and HX8347D
+  *          SPI displays, without frame buffer.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - A frame buffer would not fit: 320 x 240 RGB565 is 150 KB, the
+  *             device has 16 KB of RAM. The screen is described instead: a
+  *             background color, then up to LCD_ELEMENTS_MAX rectangles and
+  *             fixed length text fields, drawn in the order they were added.
+  *           - Changing an element marks the pixels it changes dirty, as one
+  *             bounding box per LCD_TILE_WIDTH x LCD_TILE_HEIGHT tile. Text
+  *             fields are compared character by character: "23.45" becoming
+  *             "23.46" marks one character cell.
+  *           - BSP_LCD_Refresh() renders the dirty area of each tile into the
+  *             tile buffer and sends it through the DrawRGBImage() window
+  *             operation of the driver, by DMA. It waits for the end of each
+  *             transfer, so it belongs in the main loop. A driver without
+  *             DrawRGBImage() (spfd5408) gets the tile one WritePixel() at a
+  *             time instead: correct, but several times slower.
+  *           - Characters come from a glyph cache: LCD_GLYPH_CACHE_SIZE
+  *             glyphs of 6 x 8 RGB565 pixels, for a character and two
+  *             colors, the least recently used one replaced. Larger scales
+  *             repeat the cached pixels: no font bit is tested per pixel.
+  *           - RAM: the tile buffer (1 KB at 32 x 16), 108 bytes per cached
+  *             glyph, 4 bytes per tile and 32 bytes per element (at
+  *             LCD_TEXT_MAX 16): 3.8 KB with the defaults, above the BSP
+  *             RAM budget of cmake/memory_budget.json. A target using the
+  *             renderer raises it under "targets".
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_lcd.h"
+#include <string.h>
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_LCD
+  * @brief      Dirty rectangle tile renderer with a glyph cache.
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_LCD_Private_Types Private Types
+  * @{
+  */
+#if (LCD_TILE_WIDTH > 255U) || (LCD_TILE_HEIGHT > 255U)
+#error "LCD_TILE_WIDTH and LCD_TILE_HEIGHT must be at most 255"
+#endif
+
+#define LCD_ELEMENT_RECT             0U
+#define LCD_ELEMENT_TEXT             1U
+
+typedef struct
+{
+  uint16_t X;
+  uint16_t Y;
+  uint16_t Width;
+  uint16_t Height;
+  uint16_t Color;            /* Rectangle or text color */
+  uint16_t BackColor;        /* Text background */
+  uint8_t  Type;
+  uint8_t  Scale;            /* Text: pixels per font pixel */
+  uint8_t  Length;           /* Text: character cells */
+  char     Text[LCD_TEXT_MAX];
+} LCD_ElementTypeDef;
+
+typedef struct
+{
+  uint16_t TextColor;
+  uint16_t BackColor;
+  char     Code;             /* 0 when free */
+  uint32_t LastUse;
+  uint16_t Pixels[LCD_CELL_WIDTH * LCD_CELL_HEIGHT];
+} LCD_GlyphTypeDef;
+
+/* Dirty area of a tile, in tile coordinates, X1 and Y1 excluded: X1 is 0
+   when the tile is clean */
+typedef struct
+{
+  uint8_t  X0;
+  uint8_t  Y0;
+  uint8_t  X1;
+  uint8_t  Y1;
+} LCD_AreaTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_LCD_Private_Variables Private Variables
+  * @{
+  */
+const uint8_t LCD_Font5x7[(LCD_FONT_LAST - LCD_FONT_FIRST + 1U) * LCD_FONT_HEIGHT] =
+{
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* ' ' */
+  0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, /* '!' */
+  0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, /* '"' */
+  0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A, /* '#' */
+  0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04, /* '$' */
+  0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, /* '%' */
+  0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D, /* '&' */
+  0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, /* '\'' */
+  0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, /* '(' */
+  0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, /* ')' */
+  0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00, /* '*' */
+  0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, /* '+' */
+  0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08, /* ',' */
+  0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, /* '-' */
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, /* '.' */
+  0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, /* '/' */
+  0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E, /* '0' */
+  0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E, /* '1' */
+  0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F, /* '2' */
+  0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E, /* '3' */
+  0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02, /* '4' */
+  0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E, /* '5' */
+  0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E, /* '6' */
+  0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, /* '7' */
+  0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E, /* '8' */
+  0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C, /* '9' */
+  0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00, /* ':' */
+  0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08, /* ';' */
+  0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, /* '<' */
+  0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00, /* '=' */
+  0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, /* '>' */
+  0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, /* '?' */
+  0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E, /* '@' */
+  0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, /* 'A' */
+  0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E, /* 'B' */
+  0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E, /* 'C' */
+  0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C, /* 'D' */
+  0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F, /* 'E' */
+  0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10, /* 'F' */
+  0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F, /* 'G' */
+  0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, /* 'H' */
+  0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, /* 'I' */
+  0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C, /* 'J' */
+  0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, /* 'K' */
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F, /* 'L' */
+  0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11, /* 'M' */
+  0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, /* 'N' */
+  0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, /* 'O' */
+  0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10, /* 'P' */
+  0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D, /* 'Q' */
+  0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11, /* 'R' */
+  0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E, /* 'S' */
+  0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, /* 'T' */
+  0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, /* 'U' */
+  0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04, /* 'V' */
+  0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A, /* 'W' */
+  0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11, /* 'X' */
+  0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04, /* 'Y' */
+  0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F, /* 'Z' */
+};
+
+static LCD_DrvTypeDef     *LcdDrv = NULL;
+static uint32_t            LcdOrientation;
+static uint16_t            LcdWidth;
+static uint16_t            LcdHeight;
+static uint16_t            LcdBackColor;
+static uint16_t            LcdTilesX;
+static uint16_t            LcdTilesY;
+static LCD_AreaTypeDef     LcdDirty[LCD_TILES_MAX];
+static LCD_ElementTypeDef  LcdElements[LCD_ELEMENTS_MAX];
+static uint8_t             LcdElementCount;
+static LCD_GlyphTypeDef    LcdGlyphs[LCD_GLYPH_CACHE_SIZE];
+static uint32_t            LcdGlyphClock;
+static uint16_t            LcdTile[LCD_TILE_WIDTH * LCD_TILE_HEIGHT];
+static LCD_StatsTypeDef    LcdStats;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_LCD_Private_Functions Private Functions
+  * @{
+  */
+static char            LCD_FoldChar(char Code);
+static const uint16_t *LCD_GetGlyph(char Code, uint16_t TextColor, uint16_t BackColor);
+static void            LCD_Render(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height);
+static void            LCD_RenderText(const LCD_ElementTypeDef *pElement, uint16_t Xpos, uint16_t Ypos, uint16_t Width,
+                                      uint16_t X0, uint16_t Y0, uint16_t X1, uint16_t Y1);
+static void            LCD_Blit(const uint16_t *pGlyph, uint32_t Scale, uint32_t OffsetX, uint32_t OffsetY,
+                                uint32_t Width, uint32_t Height, uint16_t *pDst, uint32_t Stride);
+static void            LCD_WritePixels(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height);
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_LCD_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Initializes the display and starts an empty screen.
+  * @param  pDrv: LCD component driver, st7735_drv or hx8347d_drv (or a
+  *         driver without DrawRGBImage(), written to pixel by pixel).
+  * @param  Orientation: LCD_ORIENTATION_XY (ST7735) or LCD_ORIENTATION_YX
+  *         (HX8347D).
+  * @param  BackColor: background color, RGB565.
+  * @retval LCD_OK, or LCD_ERROR if the screen has more than LCD_TILES_MAX
+  *         tiles.
+  */
+uint8_t BSP_LCD_Init(LCD_DrvTypeDef *pDrv, uint32_t Orientation, uint16_t BackColor)
+{
+  uint16_t width, height;
+
+  if((pDrv == NULL) || (Orientation > LCD_ORIENTATION_YX))
+  {
+    return LCD_ERROR;
+  }
+  width = pDrv->GetLcdPixelWidth();
+  height = pDrv->GetLcdPixelHeight();
+  if((uint32_t)((width + LCD_TILE_WIDTH - 1U) / LCD_TILE_WIDTH) *
+     ((height + LCD_TILE_HEIGHT - 1U) / LCD_TILE_HEIGHT) > LCD_TILES_MAX)
+  {
+    return LCD_ERROR;
+  }
+
+  pDrv->Init();
+  LcdDrv = pDrv;
+  LcdOrientation = Orientation;
+  LcdWidth = width;
+  LcdHeight = height;
+  LcdTilesX = (uint16_t)((width + LCD_TILE_WIDTH - 1U) / LCD_TILE_WIDTH);
+  LcdTilesY = (uint16_t)((height + LCD_TILE_HEIGHT - 1U) / LCD_TILE_HEIGHT);
+  LcdBackColor = BackColor;
+  LcdElementCount = 0;
+  memset(LcdDirty, 0, sizeof(LcdDirty));
+  memset(LcdGlyphs, 0, sizeof(LcdGlyphs));
+  LcdGlyphClock = 0;
+  memset(&LcdStats, 0, sizeof(LcdStats));
+
+  BSP_LCD_Invalidate(0, 0, width, height);
+  return LCD_OK;
+}
+
+/**
+  * @brief  Adds a filled rectangle over the elements added before.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @param  Width: rectangle width.
+  * @param  Height: rectangle height.
+  * @param  RGBCode: rectangle color.
+  * @retval Element number, or LCD_NO_ELEMENT if there is no room or the
+  *         rectangle leaves the screen.
+  */
+uint8_t BSP_LCD_AddRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, uint16_t RGBCode)
+{
+  LCD_ElementTypeDef *pElement;
+
+  if((LcdDrv == NULL) || (LcdElementCount == LCD_ELEMENTS_MAX) || (Width == 0) || (Height == 0) ||
+     ((uint32_t)Xpos + Width > LcdWidth) || ((uint32_t)Ypos + Height > LcdHeight))
+  {
+    return LCD_NO_ELEMENT;
+  }
+
+  pElement = &LcdElements[LcdElementCount];
+  memset(pElement, 0, sizeof(*pElement));
+  pElement->Type = LCD_ELEMENT_RECT;
+  pElement->X = Xpos;
+  pElement->Y = Ypos;
+  pElement->Width = Width;
+  pElement->Height = Height;
+  pElement->Color = RGBCode;
+  BSP_LCD_Invalidate(Xpos, Ypos, Width, Height);
+  return LcdElementCount++;
+}
+
+/**
+  * @brief  Adds a blank text field over the elements added before.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @param  Length: character cells, at most LCD_TEXT_MAX.
+  * @param  Scale: pixels per font pixel, 1 for 6 x 8 pixel cells.
+  * @param  TextColor: character color.
+  * @param  BackColor: color of the cells.
+  * @retval Element number, or LCD_NO_ELEMENT if there is no room or the
+  *         field leaves the screen.
+  */
+uint8_t BSP_LCD_AddText(uint16_t Xpos, uint16_t Ypos, uint8_t Length, uint8_t Scale, uint16_t TextColor, uint16_t BackColor)
+{
+  LCD_ElementTypeDef *pElement;
+  uint32_t width = (uint32_t)Length * LCD_CELL_WIDTH * Scale;
+  uint32_t height = (uint32_t)LCD_CELL_HEIGHT * Scale;
+
+  if((LcdDrv == NULL) || (LcdElementCount == LCD_ELEMENTS_MAX) || (Length == 0) || (Length > LCD_TEXT_MAX) ||
+     (Scale == 0) || (Xpos + width > LcdWidth) || (Ypos + height > LcdHeight))
+  {
+    return LCD_NO_ELEMENT;
+  }
+
+  pElement = &LcdElements[LcdElementCount];
+  pElement->Type = LCD_ELEMENT_TEXT;
+  pElement->X = Xpos;
+  pElement->Y = Ypos;
+  pElement->Width = (uint16_t)width;
+  pElement->Height = (uint16_t)height;
+  pElement->Color = TextColor;
+  pElement->BackColor = BackColor;
+  pElement->Scale = Scale;
+  pElement->Length = Length;
+  memset(pElement->Text, ' ', sizeof(pElement->Text));
+  BSP_LCD_Invalidate(Xpos, Ypos, (uint16_t)width, (uint16_t)height);
+  return LcdElementCount++;
+}
+
+/**
+  * @brief  Changes the color of a rectangle.
+  * @param  Element: element number from BSP_LCD_AddRect().
+  * @param  RGBCode: rectangle color.
+  * @retval None
+  */
+void BSP_LCD_SetRectColor(uint8_t Element, uint16_t RGBCode)
+{
+  LCD_ElementTypeDef *pElement = &LcdElements[Element];
+
+  if((Element < LcdElementCount) && (pElement->Type == LCD_ELEMENT_RECT) && (pElement->Color != RGBCode))
+  {
+    pElement->Color = RGBCode;
+    BSP_LCD_Invalidate(pElement->X, pElement->Y, pElement->Width, pElement->Height);
+  }
+}
+
+/**
+  * @brief  Changes the characters of a text field: the cells that change
+  *         are marked dirty, the cells after the end of pText are blank.
+  * @param  Element: element number from BSP_LCD_AddText().
+  * @param  pText: characters, zero terminated.
+  * @retval None
+  */
+void BSP_LCD_SetText(uint8_t Element, const char *pText)
+{
+  LCD_ElementTypeDef *pElement = &LcdElements[Element];
+  uint16_t cell;
+  uint8_t  i;
+  char     code;
+
+  if((Element >= LcdElementCount) || (pElement->Type != LCD_ELEMENT_TEXT))
+  {
+    return;
+  }
+
+  cell = (uint16_t)(LCD_CELL_WIDTH * pElement->Scale);
+  for(i = 0; i < pElement->Length; i++)
+  {
+    code = ' ';
+    if(*pText != '\0')
+    {
+      code = LCD_FoldChar(*pText++);
+    }
+    if(pElement->Text[i] != code)
+    {
+      pElement->Text[i] = code;
+      BSP_LCD_Invalidate((uint16_t)(pElement->X + i * cell), pElement->Y, cell, pElement->Height);
+    }
+  }
+}
+
+/**
+  * @brief  Marks an area to be sent again by the next BSP_LCD_Refresh().
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @param  Width: area width.
+  * @param  Height: area height.
+  * @retval None
+  */
+void BSP_LCD_Invalidate(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height)
+{
+  LCD_AreaTypeDef *pArea;
+  uint32_t x1, y1, tx, ty, ox, oy;
+  uint8_t  ax0, ay0, ax1, ay1;
+
+  if((LcdDrv == NULL) || (Width == 0) || (Height == 0) || (Xpos >= LcdWidth) || (Ypos >= LcdHeight))
+  {
+    return;
+  }
+  x1 = ((uint32_t)Xpos + Width > LcdWidth) ? LcdWidth : ((uint32_t)Xpos + Width);
+  y1 = ((uint32_t)Ypos + Height > LcdHeight) ? LcdHeight : ((uint32_t)Ypos + Height);
+
+  for(ty = Ypos / LCD_TILE_HEIGHT; ty <= (y1 - 1U) / LCD_TILE_HEIGHT; ty++)
+  {
+    oy = ty * LCD_TILE_HEIGHT;
+    ay0 = (uint8_t)((Ypos > oy) ? (Ypos - oy) : 0U);
+    ay1 = (uint8_t)((y1 < oy + LCD_TILE_HEIGHT) ? (y1 - oy) : LCD_TILE_HEIGHT);
+    for(tx = Xpos / LCD_TILE_WIDTH; tx <= (x1 - 1U) / LCD_TILE_WIDTH; tx++)
+    {
+      ox = tx * LCD_TILE_WIDTH;
+      ax0 = (uint8_t)((Xpos > ox) ? (Xpos - ox) : 0U);
+      ax1 = (uint8_t)((x1 < ox + LCD_TILE_WIDTH) ? (x1 - ox) : LCD_TILE_WIDTH);
+      pArea = &LcdDirty[ty * LcdTilesX + tx];
+      if(pArea->X1 == 0)
+      {
+        pArea->X0 = ax0;
+        pArea->Y0 = ay0;
+        pArea->X1 = ax1;
+        pArea->Y1 = ay1;
+      }
+      else
+      {
+        /* Bounding box of both */
+        pArea->X0 = (ax0 < pArea->X0) ? ax0 : pArea->X0;
+        pArea->Y0 = (ay0 < pArea->Y0) ? ay0 : pArea->Y0;
+        pArea->X1 = (ax1 > pArea->X1) ? ax1 : pArea->X1;
+        pArea->Y1 = (ay1 > pArea->Y1) ? ay1 : pArea->Y1;
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Renders and sends the dirty area of every tile.
+  * @retval Pixels sent.
+  */
+uint32_t BSP_LCD_Refresh(void)
+{
+  LCD_AreaTypeDef *pArea = &LcdDirty[0];
+  uint32_t pixels = 0;
+  uint16_t tx, ty, x, y, w, h;
+
+  if(LcdDrv == NULL)
+  {
+    return 0;
+  }
+
+  for(ty = 0; ty < LcdTilesY; ty++)
+  {
+    for(tx = 0; tx < LcdTilesX; tx++, pArea++)
+    {
+      if(pArea->X1 == 0)
+      {
+        continue;
+      }
+      x = (uint16_t)(tx * LCD_TILE_WIDTH + pArea->X0);
+      y = (uint16_t)(ty * LCD_TILE_HEIGHT + pArea->Y0);
+      w = (uint16_t)(pArea->X1 - pArea->X0);
+      h = (uint16_t)(pArea->Y1 - pArea->Y0);
+      pArea->X1 = 0;
+
+      LCD_Render(x, y, w, h);
+      if(LcdDrv->DrawRGBImage == NULL)
+      {
+        LCD_WritePixels(x, y, w, h);
+      }
+      else if(LcdOrientation == LCD_ORIENTATION_XY)
+      {
+        LcdDrv->DrawRGBImage(x, y, w, h, (uint8_t*)LcdTile);
+      }
+      else
+      {
+        LcdDrv->DrawRGBImage(y, x, w, h, (uint8_t*)LcdTile);
+      }
+      LcdStats.Areas++;
+      pixels += (uint32_t)w * h;
+    }
+  }
+
+  if(pixels != 0)
+  {
+    LcdStats.Frames++;
+    LcdStats.Pixels += pixels;
+  }
+  return pixels;
+}
+
+/**
+  * @brief  Reads the renderer statistics.
+  * @param  pStats: pointer to the statistics.
+  * @retval None
+  */
+void BSP_LCD_GetStats(LCD_StatsTypeDef *pStats)
+{
+  *pStats = LcdStats;
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_LCD_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Character as stored: upper case, '?' outside the font.
+  * @param  Code: character.
+  * @retval Character of the font.
+  */
+static char LCD_FoldChar(char Code)
+{
+  if((Code >= 'a') && (Code <= 'z'))
+  {
+    Code = (char)(Code - ('a' - 'A'));
+  }
+  if(((uint8_t)Code < LCD_FONT_FIRST) || ((uint8_t)Code > LCD_FONT_LAST))
+  {
+    Code = '?';
+  }
+  return Code;
+}
+
+/**
+  * @brief  Glyph of a character in two colors, rasterized on a cache miss
+  *         in place of the least recently used one.
+  * @param  Code: character of the font.
+  * @param  TextColor: character color.
+  * @param  BackColor: cell color.
+  * @retval LCD_CELL_WIDTH x LCD_CELL_HEIGHT pixels.
+  */
+static const uint16_t *LCD_GetGlyph(char Code, uint16_t TextColor, uint16_t BackColor)
+{
+  LCD_GlyphTypeDef *pGlyph, *pOldest = &LcdGlyphs[0];
+  const uint8_t    *pFont;
+  uint16_t         *pPixel;
+  uint32_t          i, row, col;
+
+  LcdGlyphClock++;
+  for(i = 0; i < LCD_GLYPH_CACHE_SIZE; i++)
+  {
+    pGlyph = &LcdGlyphs[i];
+    if((pGlyph->Code == Code) && (pGlyph->TextColor == TextColor) && (pGlyph->BackColor == BackColor))
+    {
+      pGlyph->LastUse = LcdGlyphClock;
+      LcdStats.GlyphHits++;
+      return pGlyph->Pixels;
+    }
+    if(pGlyph->LastUse < pOldest->LastUse)
+    {
+      pOldest = pGlyph;
+    }
+  }
+
+  LcdStats.GlyphMisses++;
+  pGlyph = pOldest;
+  pGlyph->Code = Code;
+  pGlyph->TextColor = TextColor;
+  pGlyph->BackColor = BackColor;
+  pGlyph->LastUse = LcdGlyphClock;
+  pFont = &LCD_Font5x7[((uint8_t)Code - LCD_FONT_FIRST) * LCD_FONT_HEIGHT];
+  pPixel = pGlyph->Pixels;
+  for(row = 0; row < LCD_CELL_HEIGHT; row++)
+  {
+    for(col = 0; col < LCD_CELL_WIDTH; col++)
+    {
+      /* The last column and line space the cells */
+      *pPixel++ = ((row < LCD_FONT_HEIGHT) && (col < LCD_FONT_WIDTH) &&
+                   ((pFont[row] & (0x10U >> col)) != 0)) ? TextColor : BackColor;
+    }
+  }
+  return pGlyph->Pixels;
+}
+
+/**
+  * @brief  Renders an area into the tile buffer, Width pixels per line.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @param  Width: area width, at most LCD_TILE_WIDTH.
+  * @param  Height: area height, at most LCD_TILE_HEIGHT.
+  * @retval None
+  */
+static void LCD_Render(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height)
+{
+  const LCD_ElementTypeDef *pElement;
+  uint16_t *pDst;
+  uint32_t  i, e, row, col;
+  uint16_t  x0, y0, x1, y1;
+
+  for(i = 0; i < (uint32_t)Width * Height; i++)
+  {
+    LcdTile[i] = LcdBackColor;
+  }
+
+  for(e = 0; e < LcdElementCount; e++)
+  {
+    pElement = &LcdElements[e];
+    x0 = (pElement->X > Xpos) ? pElement->X : Xpos;
+    y0 = (pElement->Y > Ypos) ? pElement->Y : Ypos;
+    x1 = ((pElement->X + pElement->Width) < (Xpos + Width)) ? (uint16_t)(pElement->X + pElement->Width) : (uint16_t)(Xpos + Width);
+    y1 = ((pElement->Y + pElement->Height) < (Ypos + Height)) ? (uint16_t)(pElement->Y + pElement->Height) : (uint16_t)(Ypos + Height);
+    if((x0 >= x1) || (y0 >= y1))
+    {
+      continue;
+    }
+
+    if(pElement->Type == LCD_ELEMENT_TEXT)
+    {
+      LCD_RenderText(pElement, Xpos, Ypos, Width, x0, y0, x1, y1);
+      continue;
+    }
+    pDst = &LcdTile[(y0 - Ypos) * Width + (x0 - Xpos)];
+    for(row = y0; row < y1; row++)
+    {
+      for(col = 0; col < (uint32_t)(x1 - x0); col++)
+      {
+        pDst[col] = pElement->Color;
+      }
+      pDst += Width;
+    }
+  }
+}
+
+/**
+  * @brief  Renders the part of a text field inside the area.
+  * @param  pElement: text field.
+  * @param  Xpos: area X position.
+  * @param  Ypos: area Y position.
+  * @param  Width: area width, the tile buffer line length.
+  * @param  X0: first column of the field in the area.
+  * @param  Y0: first line of the field in the area.
+  * @param  X1: column after the last one.
+  * @param  Y1: line after the last one.
+  * @retval None
+  */
+static void LCD_RenderText(const LCD_ElementTypeDef *pElement, uint16_t Xpos, uint16_t Ypos, uint16_t Width,
+                           uint16_t X0, uint16_t Y0, uint16_t X1, uint16_t Y1)
+{
+  uint32_t cell = (uint32_t)LCD_CELL_WIDTH * pElement->Scale;
+  uint32_t first = (X0 - pElement->X) / cell;
+  uint32_t last = (X1 - 1U - pElement->X) / cell;
+  uint32_t c, cx, px0, px1;
+
+  for(c = first; c <= last; c++)
+  {
+    cx = pElement->X + c * cell;
+    px0 = (cx > X0) ? cx : X0;
+    px1 = ((cx + cell) < X1) ? (cx + cell) : X1;
+    LCD_Blit(LCD_GetGlyph(pElement->Text[c], pElement->Color, pElement->BackColor), pElement->Scale,
+             px0 - cx, Y0 - pElement->Y, px1 - px0, (uint32_t)(Y1 - Y0),
+             &LcdTile[(Y0 - Ypos) * Width + (px0 - Xpos)], Width);
+  }
+}
+
+/**
+  * @brief  Copies part of a glyph, each pixel repeated Scale times across
+  *         and down.
+  * @param  pGlyph: glyph pixels.
+  * @param  Scale: pixels per glyph pixel.
+  * @param  OffsetX: first column, in scaled pixels.
+  * @param  OffsetY: first line, in scaled pixels.
+  * @param  Width: columns to copy.
+  * @param  Height: lines to copy.
+  * @param  pDst: first destination pixel.
+  * @param  Stride: destination pixels per line.
+  * @retval None
+  */
+static void LCD_Blit(const uint16_t *pGlyph, uint32_t Scale, uint32_t OffsetX, uint32_t OffsetY,
+                     uint32_t Width, uint32_t Height, uint16_t *pDst, uint32_t Stride)
+{
+  const uint16_t *pSrc;
+  uint32_t sy = OffsetY, sx0 = OffsetX, phasey = 0, phasex0 = 0;
+  uint32_t row, col, sx, phasex;
+
+  if(Scale > 1U)
+  {
+    /* One division per cell: the Cortex-M0 has no divide instruction */
+    sy = OffsetY / Scale;
+    phasey = OffsetY - sy * Scale;
+    sx0 = OffsetX / Scale;
+    phasex0 = OffsetX - sx0 * Scale;
+  }
+
+  for(row = 0; row < Height; row++)
+  {
+    pSrc = &pGlyph[sy * LCD_CELL_WIDTH];
+    if(Scale == 1U)
+    {
+      memcpy(pDst, &pSrc[sx0], Width * 2U);
+      sy++;
+    }
+    else
+    {
+      sx = sx0;
+      phasex = phasex0;
+      for(col = 0; col < Width; col++)
+      {
+        pDst[col] = pSrc[sx];
+        if(++phasex == Scale)
+        {
+          phasex = 0;
+          sx++;
+        }
+      }
+      if(++phasey == Scale)
+      {
+        phasey = 0;
+        sy++;
+      }
+    }
+    pDst += Stride;
+  }
+}
+
+/**
+  * @brief  Sends the tile buffer one pixel at a time, for a driver without
+  *         DrawRGBImage().
+  * @param  Xpos: area X position.
+  * @param  Ypos: area Y position.
+  * @param  Width: area width, the tile buffer line length.
+  * @param  Height: area height.
+  * @retval None
+  */
+static void LCD_WritePixels(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height)
+{
+  const uint16_t *pSrc = LcdTile;
+  uint16_t row, col;
+
+  for(row = 0; row < Height; row++)
+  {
+    for(col = 0; col < Width; col++, pSrc++)
+    {
+      if(LcdOrientation == LCD_ORIENTATION_XY)
+      {
+        LcdDrv->WritePixel((uint16_t)(Xpos + col), (uint16_t)(Ypos + row), *pSrc);
+      }
+      else
+      {
+        LcdDrv->WritePixel((uint16_t)(Ypos + row), (uint16_t)(Xpos + col), *pSrc);
+      }
+    }
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
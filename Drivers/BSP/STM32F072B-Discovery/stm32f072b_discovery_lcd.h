@@ -0,0 +1,148 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_lcd.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_lcd.c tile renderer.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_LCD_H
+#define __STM32072B_DISCOVERY_LCD_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f0xx_hal.h"
+/* Include LCD component driver interface */
+#include "../Components/Common/lcd.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_LCD STM32F072B_DISCOVERY LCD
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_LCD_Exported_Types Exported Types
+  * @{
+  */
+typedef enum
+{
+  LCD_OK = 0,
+  LCD_ERROR = 1
+}
+LCD_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t Frames;           /* BSP_LCD_Refresh() calls that sent pixels */
+  uint32_t Areas;            /* Tile areas sent, one window each */
+  uint32_t Pixels;           /* Pixels sent */
+  uint32_t GlyphHits;        /* Character cells drawn from the glyph cache */
+  uint32_t GlyphMisses;      /* Glyphs rasterized into the cache */
+} LCD_StatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_LCD_Exported_Constants Exported Constants
+  * @{
+  */
+/* Screen coordinates: X along the display memory lines, Y across them.
+   The driver takes them as its Xpos and Ypos (ST7735), or swapped, Xpos
+   selecting the line (HX8347D) */
+#define LCD_ORIENTATION_XY           0U
+#define LCD_ORIENTATION_YX           1U
+
+/* Tile size in pixels: the tile buffer holds one tile, RGB565 */
+#ifndef LCD_TILE_WIDTH
+#define LCD_TILE_WIDTH               32U
+#endif
+#ifndef LCD_TILE_HEIGHT
+#define LCD_TILE_HEIGHT              16U
+#endif
+/* Tiles tracked: 150 cover 320 x 240 */
+#ifndef LCD_TILES_MAX
+#define LCD_TILES_MAX                150U
+#endif
+
+/* Rectangles and text fields of the screen, and characters per field */
+#ifndef LCD_ELEMENTS_MAX
+#define LCD_ELEMENTS_MAX             16U
+#endif
+#ifndef LCD_TEXT_MAX
+#define LCD_TEXT_MAX                 16U
+#endif
+/* Glyphs kept rasterized in RGB565, for a character and two colors */
+#ifndef LCD_GLYPH_CACHE_SIZE
+#define LCD_GLYPH_CACHE_SIZE         16U
+#endif
+
+/* 5 x 7 font in character cells of 6 x 8 pixels, times the field scale.
+   Characters from LCD_FONT_FIRST to LCD_FONT_LAST; lower case letters are
+   drawn upper case, others as '?' */
+#define LCD_FONT_WIDTH               5U
+#define LCD_FONT_HEIGHT              7U
+#define LCD_CELL_WIDTH               6U
+#define LCD_CELL_HEIGHT              8U
+#define LCD_FONT_FIRST               0x20U
+#define LCD_FONT_LAST                0x5AU
+
+#define LCD_NO_ELEMENT               0xFFU
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_LCD_Exported_Variables Exported Variables
+  * @{
+  */
+/* One byte per glyph line, top first, bit 4 the leftmost pixel */
+extern const uint8_t LCD_Font5x7[(LCD_FONT_LAST - LCD_FONT_FIRST + 1U) * LCD_FONT_HEIGHT];
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_LCD_Exported_Functions Exported Functions
+  * @{
+  */
+uint8_t  BSP_LCD_Init(LCD_DrvTypeDef *pDrv, uint32_t Orientation, uint16_t BackColor);
+uint8_t  BSP_LCD_AddRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height, uint16_t RGBCode);
+uint8_t  BSP_LCD_AddText(uint16_t Xpos, uint16_t Ypos, uint8_t Length, uint8_t Scale, uint16_t TextColor, uint16_t BackColor);
+void     BSP_LCD_SetRectColor(uint8_t Element, uint16_t RGBCode);
+void     BSP_LCD_SetText(uint8_t Element, const char *pText);
+void     BSP_LCD_Invalidate(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height);
+uint32_t BSP_LCD_Refresh(void);
+void     BSP_LCD_GetStats(LCD_StatsTypeDef *pStats);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_LCD_H */
@@ -0,0 +1,652 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_nnmodel.c
+  * @brief   This file provides a runtime for CMSIS-NN models stored as a
+  *          binary image, e.g. in flash.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - A model image (tools/nn_model.py, cmake/nn_model.cmake) is a
+  *             header, a table of ops and the weights, biases and q4 scales
+  *             they point to. Each op is one CMSIS-NN call with its
+  *             dimensions, shifts and offsets: the image holds no code and
+  *             no pointers, and the runtime reads it where it lies. Nothing
+  *             is copied or allocated: the handle holds three pointers, the
+  *             activations live in an arena of the application, at the
+  *             offsets the image gives (tools/nn_plan.py plans them).
+  *           - BSP_NNMODEL_Init() checks the whole image once: magic,
+  *             version, checksum, and for every op its code, its dimensions
+  *             against what its kernel accepts, its tensors inside the arena
+  *             and apart from each other, its weights inside the image.
+  *             BSP_NNMODEL_Run() then runs the ops in order without further
+  *             checks, each through the function table NnmodelOps indexed
+  *             by its code.
+  *           - The input and the output are q7 tensors of the arena
+  *             (BSP_NNMODEL_GetInput(), BSP_NNMODEL_GetOutput()); any
+  *             scaling of the raw input is left to the application. The ops
+  *             may overwrite the input (pooling destroys its input).
+  *           - Square HWC tensors only, as the square CMSIS-NN kernels take
+  *             them. Linked against the *_cm0.S kernels, the convolutions
+  *             and fully connected ops leave the scratch alone; the C
+  *             kernels may use it (ARM_MATH_DSP), so the image sizes it for
+  *             either.
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_nnmodel.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_NNMODEL
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_NNMODEL_Private_Constants Private Constants
+  * @{
+  */
+/* Bytes summed between two reductions of the checksum: the second sum stays
+   below 2^32 */
+#define NNMODEL_CHECKSUM_BLOCK       2048U
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_NNMODEL_Private_Types Private Types
+  * @{
+  */
+
+/* Bytes an op reads and writes, 0 for what it does not use */
+typedef struct
+{
+  uint64_t Input;            /* Arena */
+  uint64_t Output;
+  uint64_t Scratch;
+  uint64_t Weights;          /* Image */
+  uint64_t Bias;
+  uint64_t Scale;
+  uint64_t Zero;
+  uint8_t  InPlace;          /* Output must be Input (1) or may be (2) */
+} NNMODEL_SizesTypeDef;
+
+typedef struct
+{
+  /* Sizes of the op, NNMODEL_ERROR if its kernel cannot take its dimensions */
+  uint8_t    (*Sizes)(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes);
+  arm_status (*Run)(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+} NNMODEL_OpFunctionsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_NNMODEL_Private_Functions Private Functions
+  * @{
+  */
+static uint8_t    NNMODEL_SizesConv(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes);
+static uint8_t    NNMODEL_SizesPool(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes);
+static uint8_t    NNMODEL_SizesActivation(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes);
+static uint8_t    NNMODEL_SizesFc(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes);
+static arm_status NNMODEL_RunConvBasic(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunConvFast(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunConvRGB(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunDepthwise(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunMaxPool(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunAvePool(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunRelu(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunSoftmax(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunFc(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunFcOpt(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+static arm_status NNMODEL_RunFcQ4(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp);
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_NNMODEL_Private_Variables Private Variables
+  * @{
+  */
+
+/* Indexed by NNMODEL_OP_* */
+static const NNMODEL_OpFunctionsTypeDef NnmodelOps[NNMODEL_OP_COUNT] =
+{
+  { NNMODEL_SizesConv,       NNMODEL_RunConvBasic },
+  { NNMODEL_SizesConv,       NNMODEL_RunConvFast },
+  { NNMODEL_SizesConv,       NNMODEL_RunConvRGB },
+  { NNMODEL_SizesConv,       NNMODEL_RunDepthwise },
+  { NNMODEL_SizesPool,       NNMODEL_RunMaxPool },
+  { NNMODEL_SizesPool,       NNMODEL_RunAvePool },
+  { NNMODEL_SizesActivation, NNMODEL_RunRelu },
+  { NNMODEL_SizesActivation, NNMODEL_RunSoftmax },
+  { NNMODEL_SizesFc,         NNMODEL_RunFc },
+  { NNMODEL_SizesFc,         NNMODEL_RunFcOpt },
+  { NNMODEL_SizesFc,         NNMODEL_RunFcQ4 },
+};
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_NNMODEL_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Tensor of the arena.
+  * @param  pModel  model.
+  * @param  Offset  arena offset.
+  * @retval Address of the tensor
+  */
+__STATIC_INLINE q7_t *NNMODEL_Tensor(const NNMODEL_HandleTypeDef *pModel, uint32_t Offset)
+{
+  return &pModel->pArena[Offset];
+}
+
+/**
+  * @brief  Data of the image.
+  * @param  pModel  model.
+  * @param  Offset  image offset.
+  * @retval Address of the data
+  */
+__STATIC_INLINE const void *NNMODEL_Data(const NNMODEL_HandleTypeDef *pModel, uint32_t Offset)
+{
+  return (const uint8_t *)pModel->pHeader + Offset;
+}
+
+/**
+  * @brief  Fletcher-32 of bytes, the sums reduced by end-around carry.
+  * @param  pData  bytes.
+  * @param  Size   number of bytes.
+  * @retval Second sum << 16 | first sum
+  */
+static uint32_t NNMODEL_Checksum(const uint8_t *pData, uint32_t Size)
+{
+  uint32_t a = 0U, b = 0U;
+  uint32_t n;
+
+  while (Size > 0U)
+  {
+    n = (Size < NNMODEL_CHECKSUM_BLOCK) ? Size : NNMODEL_CHECKSUM_BLOCK;
+    Size -= n;
+    do
+    {
+      a += *pData++;
+      b += a;
+    } while (--n > 0U);
+    a = (a & 0xFFFFU) + (a >> 16);
+    b = (b & 0xFFFFU) + (b >> 16);
+  }
+  a = (a & 0xFFFFU) + (a >> 16);
+  b = (b & 0xFFFFU) + (b >> 16);
+  return (b << 16) | a;
+}
+
+/**
+  * @brief  Output dimension of a convolution or pooling window.
+  * @param  pOp   op.
+  * @param  Ceil  round the windows up, as pooling does (Caffe).
+  * @retval Output width, 0 if the kernel does not fit the padded input
+  */
+static uint32_t NNMODEL_OutDim(const NNMODEL_OpTypeDef *pOp, uint8_t Ceil)
+{
+  uint32_t padded = (uint32_t)pOp->InDim + 2U * pOp->Pad;
+
+  if ((pOp->KerDim == 0U) || (pOp->Stride == 0U) || (padded < pOp->KerDim))
+  {
+    return 0U;
+  }
+  padded -= pOp->KerDim;
+  return ((Ceil != 0U) ? (padded + pOp->Stride - 1U) : padded) / pOp->Stride + 1U;
+}
+
+/**
+  * @brief  Bytes of a square HWC tensor.
+  * @retval Dim * Dim * Ch
+  */
+__STATIC_INLINE uint64_t NNMODEL_Volume(uint16_t Dim, uint16_t Ch)
+{
+  return (uint64_t)Dim * Dim * Ch;
+}
+
+/**
+  * @brief  Sizes of the convolutions: basic, fast, RGB and depthwise.
+  * @param  pOp     op.
+  * @param  pSizes  sizes to set.
+  * @retval NNMODEL_OK, or NNMODEL_ERROR on dimensions the kernel rejects
+  */
+static uint8_t NNMODEL_SizesConv(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes)
+{
+  uint64_t window = (uint64_t)pOp->KerDim * pOp->KerDim;
+
+  if ((pOp->OutDim == 0U) || (pOp->OutDim != NNMODEL_OutDim(pOp, 0U)))
+  {
+    return NNMODEL_ERROR;
+  }
+  if (((pOp->Code == NNMODEL_OP_CONV_FAST) && (((pOp->InCh % 4U) != 0U) || ((pOp->OutCh % 2U) != 0U))) ||
+      ((pOp->Code == NNMODEL_OP_CONV_RGB) && (pOp->InCh != 3U)) ||
+      ((pOp->Code == NNMODEL_OP_DEPTHWISE) && (pOp->InCh != pOp->OutCh)))
+  {
+    return NNMODEL_ERROR;
+  }
+  pSizes->Input = NNMODEL_Volume(pOp->InDim, pOp->InCh);
+  pSizes->Output = NNMODEL_Volume(pOp->OutDim, pOp->OutCh);
+  /* bufferA: 2 ch_im_in dim_kernel^2 q15 */
+  pSizes->Scratch = 4U * pOp->InCh * window;
+  pSizes->Weights = window * pOp->InCh * ((pOp->Code == NNMODEL_OP_DEPTHWISE) ? 1U : pOp->OutCh);
+  pSizes->Bias = pOp->OutCh;
+  return NNMODEL_OK;
+}
+
+/**
+  * @brief  Sizes of max and average pooling.
+  * @param  pOp     op.
+  * @param  pSizes  sizes to set.
+  * @retval NNMODEL_OK, or NNMODEL_ERROR on dimensions the kernel rejects
+  */
+static uint8_t NNMODEL_SizesPool(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes)
+{
+  /* Windows rounded up or down */
+  if ((pOp->OutDim == 0U) || (pOp->OutDim > NNMODEL_OutDim(pOp, 1U)) || (pOp->OutCh != pOp->InCh))
+  {
+    return NNMODEL_ERROR;
+  }
+  pSizes->Input = NNMODEL_Volume(pOp->InDim, pOp->InCh);
+  pSizes->Output = NNMODEL_Volume(pOp->OutDim, pOp->OutCh);
+  /* bufferA of average pooling: 2 dim_im_out ch_im_in q15 */
+  pSizes->Scratch = (pOp->Code == NNMODEL_OP_AVEPOOL) ? 4U * (uint64_t)pOp->OutDim * pOp->InCh : 0U;
+  return NNMODEL_OK;
+}
+
+/**
+  * @brief  Sizes of relu, in place, and softmax.
+  * @param  pOp     op.
+  * @param  pSizes  sizes to set.
+  * @retval NNMODEL_OK, or NNMODEL_ERROR on dimensions the kernel rejects
+  */
+static uint8_t NNMODEL_SizesActivation(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes)
+{
+  pSizes->Input = NNMODEL_Volume(pOp->InDim, pOp->InCh);
+  if ((pOp->OutDim != pOp->InDim) || (pOp->OutCh != pOp->InCh) || (pSizes->Input > 0xFFFFU))
+  {
+    return NNMODEL_ERROR;
+  }
+  pSizes->Output = pSizes->Input;
+  pSizes->InPlace = (pOp->Code == NNMODEL_OP_RELU) ? 1U : 2U;
+  return NNMODEL_OK;
+}
+
+/**
+  * @brief  Sizes of the fully connected ops, q7 and 4-bit weights.
+  * @param  pOp     op.
+  * @param  pSizes  sizes to set.
+  * @retval NNMODEL_OK, or NNMODEL_ERROR on dimensions the kernel rejects
+  */
+static uint8_t NNMODEL_SizesFc(const NNMODEL_OpTypeDef *pOp, NNMODEL_SizesTypeDef *pSizes)
+{
+  uint64_t dim = NNMODEL_Volume(pOp->InDim, pOp->InCh);
+
+  if ((dim > 0xFFFFU) || (pOp->OutDim != 1U))
+  {
+    return NNMODEL_ERROR;
+  }
+  pSizes->Input = dim;
+  pSizes->Output = pOp->OutCh;
+  pSizes->Bias = pOp->OutCh;
+  if (pOp->Code == NNMODEL_OP_FC_Q4)
+  {
+    if ((pOp->Scale % 2U) != 0U)
+    {
+      return NNMODEL_ERROR;
+    }
+    pSizes->Weights = (dim + 1U) / 2U * pOp->OutCh;
+    pSizes->Scale = 2U * (uint64_t)pOp->OutCh;
+    pSizes->Zero = pOp->OutCh;
+  }
+  else
+  {
+    /* vec_buffer: dim_vec q15 */
+    pSizes->Scratch = 2U * dim;
+    pSizes->Weights = dim * pOp->OutCh;
+  }
+  return NNMODEL_OK;
+}
+
+/**
+  * @brief  Tells whether Size bytes at Offset lie within Limit.
+  * @retval 1 if they do (always for 0 bytes), 0 otherwise
+  */
+__STATIC_INLINE uint8_t NNMODEL_Within(uint32_t Offset, uint64_t Size, uint32_t Limit)
+{
+  return (uint8_t)((Size == 0U) || ((uint64_t)Offset + Size <= Limit));
+}
+
+/**
+  * @brief  Tells whether two arena spans share a byte.
+  * @retval 1 if they do, 0 otherwise
+  */
+__STATIC_INLINE uint8_t NNMODEL_Overlap(uint32_t a, uint64_t SizeA, uint32_t b, uint64_t SizeB)
+{
+  return (uint8_t)((SizeA != 0U) && (SizeB != 0U) && ((uint64_t)a < b + SizeB) && ((uint64_t)b < a + SizeA));
+}
+
+/**
+  * @brief  Checks an op against the image and the arena.
+  * @param  pHeader  image.
+  * @param  pOp      op.
+  * @retval NNMODEL_OK, or NNMODEL_ERROR if it cannot run as it is
+  */
+static uint8_t NNMODEL_CheckOp(const NNMODEL_HeaderTypeDef *pHeader, const NNMODEL_OpTypeDef *pOp)
+{
+  NNMODEL_SizesTypeDef sizes = { 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U };
+  uint32_t             arena = pHeader->ArenaSize;
+  uint32_t             image = pHeader->Size;
+
+  if ((pOp->Code >= NNMODEL_OP_COUNT) || (NnmodelOps[pOp->Code].Sizes(pOp, &sizes) != NNMODEL_OK))
+  {
+    return NNMODEL_ERROR;
+  }
+  if ((sizes.Input == 0U) || (sizes.Output == 0U) ||
+      !NNMODEL_Within(pOp->Input, sizes.Input, arena) || !NNMODEL_Within(pOp->Output, sizes.Output, arena) ||
+      !NNMODEL_Within(pOp->Scratch, sizes.Scratch, arena) ||
+      !NNMODEL_Within(pOp->Weights, sizes.Weights, image) || !NNMODEL_Within(pOp->Bias, sizes.Bias, image) ||
+      !NNMODEL_Within(pOp->Scale, sizes.Scale, image) || !NNMODEL_Within(pOp->Zero, sizes.Zero, image))
+  {
+    return NNMODEL_ERROR;
+  }
+  /* The q15 scratch on a halfword, apart from the tensors */
+  if ((sizes.Scratch != 0U) &&
+      (((pOp->Scratch % 2U) != 0U) || NNMODEL_Overlap(pOp->Scratch, sizes.Scratch, pOp->Input, sizes.Input) ||
+       NNMODEL_Overlap(pOp->Scratch, sizes.Scratch, pOp->Output, sizes.Output)))
+  {
+    return NNMODEL_ERROR;
+  }
+  if (sizes.InPlace == 1U)
+  {
+    return (pOp->Output == pOp->Input) ? NNMODEL_OK : NNMODEL_ERROR;
+  }
+  if ((sizes.InPlace == 2U) && (pOp->Output == pOp->Input))
+  {
+    return NNMODEL_OK;
+  }
+  return NNMODEL_Overlap(pOp->Input, sizes.Input, pOp->Output, sizes.Output) ? NNMODEL_ERROR : NNMODEL_OK;
+}
+
+/**
+  * @brief  The convolution ops, each its CMSIS-NN kernel.
+  * @param  pModel  model.
+  * @param  pOp     op.
+  * @retval Status of the kernel
+  */
+static arm_status NNMODEL_RunConvBasic(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  return arm_convolve_HWC_q7_basic(NNMODEL_Tensor(pModel, pOp->Input), pOp->InDim, pOp->InCh,
+                                   NNMODEL_Data(pModel, pOp->Weights), pOp->OutCh, pOp->KerDim, pOp->Pad,
+                                   pOp->Stride, NNMODEL_Data(pModel, pOp->Bias), pOp->BiasShift, pOp->OutShift,
+                                   NNMODEL_Tensor(pModel, pOp->Output), pOp->OutDim,
+                                   (q15_t *)NNMODEL_Tensor(pModel, pOp->Scratch), NULL);
+}
+
+static arm_status NNMODEL_RunConvFast(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  return arm_convolve_HWC_q7_fast(NNMODEL_Tensor(pModel, pOp->Input), pOp->InDim, pOp->InCh,
+                                  NNMODEL_Data(pModel, pOp->Weights), pOp->OutCh, pOp->KerDim, pOp->Pad,
+                                  pOp->Stride, NNMODEL_Data(pModel, pOp->Bias), pOp->BiasShift, pOp->OutShift,
+                                  NNMODEL_Tensor(pModel, pOp->Output), pOp->OutDim,
+                                  (q15_t *)NNMODEL_Tensor(pModel, pOp->Scratch), NULL);
+}
+
+static arm_status NNMODEL_RunConvRGB(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  return arm_convolve_HWC_q7_RGB(NNMODEL_Tensor(pModel, pOp->Input), pOp->InDim, pOp->InCh,
+                                 NNMODEL_Data(pModel, pOp->Weights), pOp->OutCh, pOp->KerDim, pOp->Pad,
+                                 pOp->Stride, NNMODEL_Data(pModel, pOp->Bias), pOp->BiasShift, pOp->OutShift,
+                                 NNMODEL_Tensor(pModel, pOp->Output), pOp->OutDim,
+                                 (q15_t *)NNMODEL_Tensor(pModel, pOp->Scratch), NULL);
+}
+
+static arm_status NNMODEL_RunDepthwise(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  return arm_depthwise_separable_conv_HWC_q7(NNMODEL_Tensor(pModel, pOp->Input), pOp->InDim, pOp->InCh,
+                                             NNMODEL_Data(pModel, pOp->Weights), pOp->OutCh, pOp->KerDim,
+                                             pOp->Pad, pOp->Stride, NNMODEL_Data(pModel, pOp->Bias),
+                                             pOp->BiasShift, pOp->OutShift, NNMODEL_Tensor(pModel, pOp->Output),
+                                             pOp->OutDim, (q15_t *)NNMODEL_Tensor(pModel, pOp->Scratch), NULL);
+}
+
+/**
+  * @brief  The pooling and activation ops, each its CMSIS-NN function.
+  * @param  pModel  model.
+  * @param  pOp     op.
+  * @retval ARM_MATH_SUCCESS
+  */
+static arm_status NNMODEL_RunMaxPool(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  arm_maxpool_q7_HWC(NNMODEL_Tensor(pModel, pOp->Input), pOp->InDim, pOp->InCh, pOp->KerDim, pOp->Pad,
+                     pOp->Stride, pOp->OutDim, NULL, NNMODEL_Tensor(pModel, pOp->Output));
+  return ARM_MATH_SUCCESS;
+}
+
+static arm_status NNMODEL_RunAvePool(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  arm_avepool_q7_HWC(NNMODEL_Tensor(pModel, pOp->Input), pOp->InDim, pOp->InCh, pOp->KerDim, pOp->Pad,
+                     pOp->Stride, pOp->OutDim, NNMODEL_Tensor(pModel, pOp->Scratch),
+                     NNMODEL_Tensor(pModel, pOp->Output));
+  return ARM_MATH_SUCCESS;
+}
+
+static arm_status NNMODEL_RunRelu(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  arm_relu_q7(NNMODEL_Tensor(pModel, pOp->Input), (uint16_t)(pOp->InDim * pOp->InDim * pOp->InCh));
+  return ARM_MATH_SUCCESS;
+}
+
+static arm_status NNMODEL_RunSoftmax(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  arm_softmax_q7(NNMODEL_Tensor(pModel, pOp->Input), (uint16_t)(pOp->InDim * pOp->InDim * pOp->InCh),
+                 NNMODEL_Tensor(pModel, pOp->Output));
+  return ARM_MATH_SUCCESS;
+}
+
+/**
+  * @brief  The fully connected ops, each its CMSIS-NN kernel.
+  * @param  pModel  model.
+  * @param  pOp     op.
+  * @retval Status of the kernel
+  */
+static arm_status NNMODEL_RunFc(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  return arm_fully_connected_q7(NNMODEL_Tensor(pModel, pOp->Input), NNMODEL_Data(pModel, pOp->Weights),
+                                (uint16_t)(pOp->InDim * pOp->InDim * pOp->InCh), pOp->OutCh, pOp->BiasShift,
+                                pOp->OutShift, NNMODEL_Data(pModel, pOp->Bias),
+                                NNMODEL_Tensor(pModel, pOp->Output), (q15_t *)NNMODEL_Tensor(pModel, pOp->Scratch));
+}
+
+static arm_status NNMODEL_RunFcOpt(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  return arm_fully_connected_q7_opt(NNMODEL_Tensor(pModel, pOp->Input), NNMODEL_Data(pModel, pOp->Weights),
+                                    (uint16_t)(pOp->InDim * pOp->InDim * pOp->InCh), pOp->OutCh,
+                                    pOp->BiasShift, pOp->OutShift, NNMODEL_Data(pModel, pOp->Bias),
+                                    NNMODEL_Tensor(pModel, pOp->Output),
+                                    (q15_t *)NNMODEL_Tensor(pModel, pOp->Scratch));
+}
+
+static arm_status NNMODEL_RunFcQ4(const NNMODEL_HandleTypeDef *pModel, const NNMODEL_OpTypeDef *pOp)
+{
+  return arm_fully_connected_q7_q4(NNMODEL_Tensor(pModel, pOp->Input), NNMODEL_Data(pModel, pOp->Weights),
+                                   NNMODEL_Data(pModel, pOp->Scale), NNMODEL_Data(pModel, pOp->Zero),
+                                   (uint16_t)(pOp->InDim * pOp->InDim * pOp->InCh), pOp->OutCh, pOp->BiasShift,
+                                   pOp->OutShift, NNMODEL_Data(pModel, pOp->Bias),
+                                   NNMODEL_Tensor(pModel, pOp->Output));
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_NNMODEL_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Opens a model image where it lies and checks it.
+  * @param  pModel     handle to set, cleared on an error.
+  * @param  pImage     model image, word aligned (flash or RAM); it must stay
+  *                    in place and unchanged while the handle is used.
+  * @param  Size       bytes available at pImage.
+  * @param  pArena     activation arena, word aligned.
+  * @param  ArenaSize  bytes of the arena.
+  * @retval NNMODEL_OK, or NNMODEL_ERROR if the image is not a valid model,
+  *         does not fit Size or needs a larger arena
+  */
+uint8_t BSP_NNMODEL_Init(NNMODEL_HandleTypeDef *pModel, const void *pImage, uint32_t Size,
+                         q7_t *pArena, uint32_t ArenaSize)
+{
+  const NNMODEL_HeaderTypeDef *header = (const NNMODEL_HeaderTypeDef *)pImage;
+  const NNMODEL_OpTypeDef     *ops;
+  uint32_t                     i;
+
+  pModel->pHeader = NULL;
+  pModel->pOps = NULL;
+  pModel->pArena = NULL;
+  if ((pImage == NULL) || (pArena == NULL) || ((((uint32_t)pImage) % 4U) != 0U) ||
+      ((((uint32_t)pArena) % 4U) != 0U) || (Size < sizeof(NNMODEL_HeaderTypeDef)))
+  {
+    return NNMODEL_ERROR;
+  }
+  if ((header->Magic != NNMODEL_MAGIC) || (header->Version != NNMODEL_VERSION) || (header->Size > Size) ||
+      (header->Size < sizeof(NNMODEL_HeaderTypeDef)) || (header->ArenaSize > ArenaSize) ||
+      (header->OpCount == 0U) || ((header->OpOffset % 4U) != 0U) ||
+      (header->OpOffset < sizeof(NNMODEL_HeaderTypeDef)) ||
+      !NNMODEL_Within(header->OpOffset, (uint64_t)header->OpCount * sizeof(NNMODEL_OpTypeDef), header->Size) ||
+      (header->InputSize == 0U) || (header->OutputSize == 0U) ||
+      !NNMODEL_Within(header->InputOffset, header->InputSize, header->ArenaSize) ||
+      !NNMODEL_Within(header->OutputOffset, header->OutputSize, header->ArenaSize))
+  {
+    return NNMODEL_ERROR;
+  }
+  if (NNMODEL_Checksum((const uint8_t *)pImage + sizeof(NNMODEL_HeaderTypeDef),
+                       header->Size - sizeof(NNMODEL_HeaderTypeDef)) != header->Checksum)
+  {
+    return NNMODEL_ERROR;
+  }
+  ops = (const NNMODEL_OpTypeDef *)((const uint8_t *)pImage + header->OpOffset);
+  for (i = 0U; i < header->OpCount; i++)
+  {
+    if (NNMODEL_CheckOp(header, &ops[i]) != NNMODEL_OK)
+    {
+      return NNMODEL_ERROR;
+    }
+  }
+
+  pModel->pHeader = header;
+  pModel->pOps = ops;
+  pModel->pArena = pArena;
+  return NNMODEL_OK;
+}
+
+/**
+  * @brief  Runs the ops of the model in order, from its input tensor to its
+  *         output tensor.
+  * @param  pModel  model opened by BSP_NNMODEL_Init().
+  * @retval NNMODEL_OK, or NNMODEL_ERROR if the model is not open or a kernel
+  *         failed (the ops after it are not run)
+  */
+uint8_t BSP_NNMODEL_Run(const NNMODEL_HandleTypeDef *pModel)
+{
+  const NNMODEL_OpTypeDef *op = pModel->pOps;
+  const NNMODEL_OpTypeDef *end;
+
+  if (op == NULL)
+  {
+    return NNMODEL_ERROR;
+  }
+  for (end = op + pModel->pHeader->OpCount; op < end; op++)
+  {
+    if (NnmodelOps[op->Code].Run(pModel, op) != ARM_MATH_SUCCESS)
+    {
+      return NNMODEL_ERROR;
+    }
+  }
+  return NNMODEL_OK;
+}
+
+/**
+  * @brief  Runs one op of the model, e.g. to time the ops apart or to spread
+  *         an inference over several calls; the ops before it must have run.
+  * @param  pModel  model opened by BSP_NNMODEL_Init().
+  * @param  Index   op, from 0.
+  * @retval NNMODEL_OK, or NNMODEL_ERROR if the model is not open, there is
+  *         no such op or its kernel failed
+  */
+uint8_t BSP_NNMODEL_RunOp(const NNMODEL_HandleTypeDef *pModel, uint32_t Index)
+{
+  const NNMODEL_OpTypeDef *op;
+
+  if ((pModel->pOps == NULL) || (Index >= pModel->pHeader->OpCount))
+  {
+    return NNMODEL_ERROR;
+  }
+  op = &pModel->pOps[Index];
+  return (NnmodelOps[op->Code].Run(pModel, op) == ARM_MATH_SUCCESS) ? NNMODEL_OK : NNMODEL_ERROR;
+}
+
+/**
+  * @brief  Input tensor of the model, in the arena.
+  * @param  pModel  model opened by BSP_NNMODEL_Init().
+  * @param  pSize   set to its bytes if not NULL.
+  * @retval Address of the q7 input, NULL if the model is not open
+  */
+q7_t *BSP_NNMODEL_GetInput(const NNMODEL_HandleTypeDef *pModel, uint32_t *pSize)
+{
+  if (pModel->pHeader == NULL)
+  {
+    return NULL;
+  }
+  if (pSize != NULL)
+  {
+    *pSize = pModel->pHeader->InputSize;
+  }
+  return NNMODEL_Tensor(pModel, pModel->pHeader->InputOffset);
+}
+
+/**
+  * @brief  Output tensor of the model, in the arena, valid after a run.
+  * @param  pModel  model opened by BSP_NNMODEL_Init().
+  * @param  pSize   set to its bytes if not NULL.
+  * @retval Address of the q7 output, NULL if the model is not open
+  */
+q7_t *BSP_NNMODEL_GetOutput(const NNMODEL_HandleTypeDef *pModel, uint32_t *pSize)
+{
+  if (pModel->pHeader == NULL)
+  {
+    return NULL;
+  }
+  if (pSize != NULL)
+  {
+    *pSize = pModel->pHeader->OutputSize;
+  }
+  return NNMODEL_Tensor(pModel, pModel->pHeader->OutputOffset);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,155 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_nnmodel.h
+  * @brief   This file contains the binary model format and all the functions
+  *          prototypes for the stm32f072b_discovery_nnmodel.c CMSIS-NN
+  *          model runtime.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_NNMODEL_H
+#define __STM32072B_DISCOVERY_NNMODEL_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_NNMODEL STM32F072B_DISCOVERY NNMODEL
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_NNMODEL_Exported_Constants Exported Constants
+  * @{
+  */
+
+#define NNMODEL_OK                   0U
+#define NNMODEL_ERROR                1U
+
+/* "NNM1" read as a little-endian word */
+#define NNMODEL_MAGIC                0x314D4E4EU
+#define NNMODEL_VERSION              1U
+
+/* Op codes (NNMODEL_OpTypeDef.Code) and the CMSIS-NN function each runs */
+#define NNMODEL_OP_CONV_BASIC        0U   /* arm_convolve_HWC_q7_basic */
+#define NNMODEL_OP_CONV_FAST         1U   /* arm_convolve_HWC_q7_fast */
+#define NNMODEL_OP_CONV_RGB          2U   /* arm_convolve_HWC_q7_RGB */
+#define NNMODEL_OP_DEPTHWISE         3U   /* arm_depthwise_separable_conv_HWC_q7 */
+#define NNMODEL_OP_MAXPOOL           4U   /* arm_maxpool_q7_HWC */
+#define NNMODEL_OP_AVEPOOL           5U   /* arm_avepool_q7_HWC */
+#define NNMODEL_OP_RELU              6U   /* arm_relu_q7, in place */
+#define NNMODEL_OP_SOFTMAX           7U   /* arm_softmax_q7 */
+#define NNMODEL_OP_FC                8U   /* arm_fully_connected_q7 */
+#define NNMODEL_OP_FC_OPT            9U   /* arm_fully_connected_q7_opt */
+#define NNMODEL_OP_FC_Q4             10U  /* arm_fully_connected_q7_q4 */
+#define NNMODEL_OP_COUNT             11U
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_NNMODEL_Exported_Types Exported Types
+  * @{
+  */
+
+/* Model image, as tools/nn_model.py writes it: this header, then the op
+   table, then the weights. Little endian, read in place: the image must be
+   word aligned. Offsets are in bytes, from the start of the image for the
+   op table and the weights, from the start of the arena for the tensors. */
+typedef struct
+{
+  uint32_t Magic;            /* NNMODEL_MAGIC */
+  uint16_t Version;          /* NNMODEL_VERSION */
+  uint16_t OpCount;
+  uint32_t Size;             /* Bytes of the image */
+  uint32_t OpOffset;         /* First NNMODEL_OpTypeDef */
+  uint32_t ArenaSize;        /* Activations and scratch, word aligned */
+  uint32_t InputOffset;      /* q7 input of the first op */
+  uint32_t InputSize;
+  uint32_t OutputOffset;     /* q7 output of the last op */
+  uint32_t OutputSize;
+  uint32_t Checksum;         /* Fletcher-32 of the image after the header */
+} NNMODEL_HeaderTypeDef;
+
+/* One CMSIS-NN call. Dimensions of square HWC tensors: InDim x InDim x InCh
+   in, OutDim x OutDim x OutCh out (OutCh the rows of a fully connected op,
+   the input its InDim x InDim x InCh values). KerDim, Pad and Stride are
+   those of the convolutions and pools, BiasShift and OutShift those of the
+   convolutions and fully connected ops, 0 elsewhere. Scale and Zero are the
+   per-row uint16 scales and uint8 zero points of NNMODEL_OP_FC_Q4. */
+typedef struct
+{
+  uint8_t  Code;             /* NNMODEL_OP_* */
+  uint8_t  Reserved;
+  uint16_t InDim;
+  uint16_t InCh;
+  uint16_t OutDim;
+  uint16_t OutCh;
+  uint16_t KerDim;
+  uint16_t Pad;
+  uint16_t Stride;
+  uint16_t BiasShift;
+  uint16_t OutShift;
+  uint32_t Input;            /* Arena offsets */
+  uint32_t Output;
+  uint32_t Scratch;          /* bufferA or vec_buffer */
+  uint32_t Weights;          /* Image offsets, 0 if none */
+  uint32_t Bias;
+  uint32_t Scale;
+  uint32_t Zero;
+} NNMODEL_OpTypeDef;
+
+typedef struct
+{
+  const NNMODEL_HeaderTypeDef *pHeader;  /* The image */
+  const NNMODEL_OpTypeDef     *pOps;
+  q7_t                        *pArena;
+} NNMODEL_HandleTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_NNMODEL_Exported_Functions Exported Functions
+  * @{
+  */
+uint8_t  BSP_NNMODEL_Init(NNMODEL_HandleTypeDef *pModel, const void *pImage, uint32_t Size,
+                          q7_t *pArena, uint32_t ArenaSize);
+uint8_t  BSP_NNMODEL_Run(const NNMODEL_HandleTypeDef *pModel);
+uint8_t  BSP_NNMODEL_RunOp(const NNMODEL_HandleTypeDef *pModel, uint32_t Index);
+q7_t    *BSP_NNMODEL_GetInput(const NNMODEL_HandleTypeDef *pModel, uint32_t *pSize);
+q7_t    *BSP_NNMODEL_GetOutput(const NNMODEL_HandleTypeDef *pModel, uint32_t *pSize);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_NNMODEL_H */
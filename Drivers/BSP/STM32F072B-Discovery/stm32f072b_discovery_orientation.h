@@ -0,0 +1,112 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_orientation.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_orientation.c orientation filter.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_ORIENTATION_H
+#define __STM32072B_DISCOVERY_ORIENTATION_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f0xx_hal.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_ORIENTATION STM32F072B_DISCOVERY ORIENTATION
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_ORIENTATION_Exported_Constants Exported Constants
+  * @{
+  */
+
+#define ORIENT_OK                    0U
+#define ORIENT_ERROR                 1U
+
+/* Samples processed at once, the gyroscope FIFO depth; longer updates are
+   split */
+#define ORIENT_BURST_MAX             32U
+
+/* Samples averaged for the initial rate offset, the board held still */
+#ifndef ORIENT_CALIBRATION_SAMPLES
+#define ORIENT_CALIBRATION_SAMPLES   256U
+#endif
+
+/* A burst is still when, on every axis, its samples span at most
+   ORIENT_STILL_SPREAD LSB and their mean is within ORIENT_STILL_OFFSET LSB
+   of the rate offset; the offset then moves 1/2^ORIENT_BIAS_SHIFT of the
+   way to that mean */
+#ifndef ORIENT_STILL_SPREAD
+#define ORIENT_STILL_SPREAD          48
+#endif
+#ifndef ORIENT_STILL_OFFSET
+#define ORIENT_STILL_OFFSET          32
+#endif
+#ifndef ORIENT_BIAS_SHIFT
+#define ORIENT_BIAS_SHIFT            3U
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_ORIENTATION_Exported_Types Exported Types
+  * @{
+  */
+typedef struct
+{
+  int16_t  W;                /* Unit quaternion, Q15, rotating the body frame */
+  int16_t  X;                /* axes onto the frame at the end of the */
+  int16_t  Y;                /* calibration */
+  int16_t  Z;
+  int32_t  Bias[3];          /* Rate offset removed, raw LSB in Q16.16 */
+  uint32_t Samples;          /* Samples integrated */
+  uint8_t  Calibrated;       /* 0 while the initial offset is measured */
+  uint8_t  Still;            /* The last burst was still */
+} ORIENT_AttitudeTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_ORIENTATION_Exported_Functions Exported Functions
+  * @{
+  */
+uint8_t BSP_ORIENT_Init(uint32_t SampleRate, uint32_t Sensitivity);
+void    BSP_ORIENT_Update(const int16_t* pSamples, uint32_t Count);
+void    BSP_ORIENT_GetAttitude(ORIENT_AttitudeTypeDef* pAttitude);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_ORIENTATION_H */
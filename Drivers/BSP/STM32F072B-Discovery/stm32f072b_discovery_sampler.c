@@ -0,0 +1,252 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_sampler.c
+  * @brief   This file provides a block-streaming pipeline from the ADC to the
+  *          CMSIS-DSP functions.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - BSP_SAMPLER_Start() starts the ADC on DISCOVERY_ADC_PIN,
+  *             triggered by the TIM3 update event at the requested rate, and
+  *             a circular DMA into a buffer of two blocks. Each half and
+  *             complete transfer interrupt hands the block the DMA has just
+  *             finished to the chain, while the DMA fills the other one.
+  *           - The chain works in the DMA buffer itself: the left-aligned
+  *             12-bit samples become q15 in place (one XOR per two samples),
+  *             arm_fir_decimate_q15() filters and decimates them into the
+  *             output block, arm_rms_q15() measures it, and the application
+  *             callback gets the output block and its RMS value. Without
+  *             decimation the callback gets the DMA block itself.
+  *           - The chain runs in the DMA1_Channel1 interrupt: the
+  *             application calls HAL_DMA_IRQHandler() for
+  *             AdcHandle.DMA_Handle from DMA1_Channel1_IRQHandler(). It must
+  *             be done with a block before the DMA comes back to it, one
+  *             block time later. A block the DMA has started to write again
+  *             when the chain starts or ends, or a block whose interrupt was
+  *             lost because the previous one ran too long, is counted as an
+  *             overrun: its samples are not those of one period.
+  *           - The DMA channel 1 interrupt has the priority of the EEPROM
+  *             DMA interrupt (DISCOVERY_ADC_DMA_PREPRIO), the highest: the
+  *             chain delays the end of the EEPROM and gyroscope transfers,
+  *             never the other way round by more than their short handlers.
+  *             A block time at the highest rate and the largest block is
+  *             0.43 ms.
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_sampler.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_SAMPLER
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SAMPLER_Private_Variables Private Variables
+  * @{
+  */
+static SAMPLER_CallbackTypeDef       SamplerCallback;
+static __IO uint8_t                  SamplerRunning;
+static uint8_t                       SamplerNext;        /* Half expected next */
+static uint16_t                      SamplerBlockSize;
+static uint8_t                       SamplerDecimFactor;
+static arm_fir_decimate_instance_q15 SamplerDecim;
+static SAMPLER_StatsTypeDef          SamplerStats;
+/* Two blocks of halfwords, word aligned for the in-place conversion */
+static uint32_t                      SamplerBuffer[SAMPLER_BLOCK_MAX];
+static q15_t                         SamplerOutput[SAMPLER_BLOCK_MAX / 2U];
+static q15_t                         SamplerState[SAMPLER_TAPS_MAX + SAMPLER_BLOCK_MAX - 1U];
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SAMPLER_Private_Functions Private Functions
+  * @{
+  */
+
+/**
+  * @brief  Runs the chain on one half of the DMA buffer.
+  * @param  Half  0 for the first block, 1 for the second.
+  * @retval None
+  */
+static void SAMPLER_Process(uint32_t Half)
+{
+  uint32_t *pWord = &SamplerBuffer[Half * (SamplerBlockSize / 2U)];
+  q15_t    *pBlock = (q15_t *)pWord;
+  uint32_t  count = SamplerBlockSize;
+  uint32_t  overrun, position, i;
+  q15_t     rms;
+
+  if (SamplerRunning == 0)
+  {
+    return;
+  }
+  /* An interrupt lost, or the DMA already back in this half */
+  overrun = (Half != SamplerNext) ? 1U : 0U;
+  SamplerNext = (uint8_t)(Half ^ 1U);
+  position = SAMPLER_IO_GetPosition();
+  if ((position / SamplerBlockSize) == Half)
+  {
+    overrun = 1U;
+  }
+
+  /* Left-aligned unsigned to q15: flip the sign bit of both halfwords */
+  for (i = 0; i < count / 2U; i++)
+  {
+    pWord[i] ^= 0x80008000U;
+  }
+
+  if (SamplerDecimFactor > 1U)
+  {
+    arm_fir_decimate_q15(&SamplerDecim, pBlock, SamplerOutput, count);
+    pBlock = SamplerOutput;
+    count /= SamplerDecimFactor;
+  }
+  arm_rms_q15(pBlock, count, &rms);
+  SamplerCallback(pBlock, count, rms);
+
+  /* The DMA back in this half: part of the block was overwritten meanwhile */
+  position = SAMPLER_IO_GetPosition();
+  if ((SamplerRunning != 0) && ((position / SamplerBlockSize) == Half))
+  {
+    overrun = 1U;
+  }
+  SamplerStats.Blocks++;
+  SamplerStats.Overruns += overrun;
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_SAMPLER_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Starts sampling and the processing chain.
+  * @note   The rate is that of the TIM3 divider closest to SampleRate:
+  *         BSP_SAMPLER_GetStats() returns it.
+  * @param  pConfig  pipeline configuration; the coefficients must remain
+  *         valid until BSP_SAMPLER_Stop().
+  * @retval SAMPLER_OK if started
+  */
+uint8_t BSP_SAMPLER_Start(const SAMPLER_ConfigTypeDef *pConfig)
+{
+  uint32_t rate;
+
+  if ((SamplerRunning != 0) || (pConfig == NULL) || (pConfig->Callback == NULL) ||
+      (pConfig->SampleRate == 0U) || (pConfig->SampleRate > SAMPLER_RATE_MAX) ||
+      (pConfig->BlockSize < 2U) || (pConfig->BlockSize > SAMPLER_BLOCK_MAX) ||
+      ((pConfig->BlockSize & 1U) != 0U) || (pConfig->DecimFactor == 0U) ||
+      ((pConfig->BlockSize % pConfig->DecimFactor) != 0U))
+  {
+    return SAMPLER_ERROR;
+  }
+  if (pConfig->DecimFactor > 1U)
+  {
+    if ((pConfig->pDecimCoeffs == NULL) || (pConfig->DecimTaps == 0U) ||
+        (pConfig->DecimTaps > SAMPLER_TAPS_MAX) ||
+        (arm_fir_decimate_init_q15(&SamplerDecim, pConfig->DecimTaps, pConfig->DecimFactor,
+                                   (q15_t *)pConfig->pDecimCoeffs, SamplerState,
+                                   pConfig->BlockSize) != ARM_MATH_SUCCESS))
+    {
+      return SAMPLER_ERROR;
+    }
+  }
+
+  SamplerCallback = pConfig->Callback;
+  SamplerBlockSize = pConfig->BlockSize;
+  SamplerDecimFactor = pConfig->DecimFactor;
+  SamplerNext = 0;
+  SamplerStats.SampleRate = 0;
+  SamplerStats.Blocks = 0;
+  SamplerStats.Overruns = 0;
+  SamplerStats.Errors = 0;
+  SamplerRunning = 1;
+
+  rate = SAMPLER_IO_Start((uint16_t *)SamplerBuffer, 2U * SamplerBlockSize, pConfig->SampleRate);
+  if (rate == 0U)
+  {
+    SamplerRunning = 0;
+    return SAMPLER_ERROR;
+  }
+  SamplerStats.SampleRate = rate;
+  return SAMPLER_OK;
+}
+
+/**
+  * @brief  Stops the timer, the ADC and its DMA.
+  * @note   A block in the chain when called still reaches the callback.
+  * @retval None
+  */
+void BSP_SAMPLER_Stop(void)
+{
+  if (SamplerRunning == 0)
+  {
+    return;
+  }
+  SamplerRunning = 0;
+  SAMPLER_IO_Stop();
+}
+
+/**
+  * @brief  Returns the pipeline counters.
+  * @param  pStats  pointer to the structure to fill.
+  * @retval None
+  */
+void BSP_SAMPLER_GetStats(SAMPLER_StatsTypeDef *pStats)
+{
+  *pStats = SamplerStats;
+}
+
+/**
+  * @brief  First block filled, from the link layer.
+  * @retval None
+  */
+void SAMPLER_IO_HalfCpltCallback(void)
+{
+  SAMPLER_Process(0);
+}
+
+/**
+  * @brief  Second block filled, from the link layer.
+  * @retval None
+  */
+void SAMPLER_IO_CpltCallback(void)
+{
+  SAMPLER_Process(1);
+}
+
+/**
+  * @brief  ADC or DMA error, from the link layer.
+  * @retval None
+  */
+void SAMPLER_IO_ErrorCallback(void)
+{
+  SamplerStats.Errors++;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
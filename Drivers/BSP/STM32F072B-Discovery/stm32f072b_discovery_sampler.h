@@ -0,0 +1,123 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_sampler.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_sampler.c ADC sampling pipeline.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_SAMPLER_H
+#define __STM32072B_DISCOVERY_SAMPLER_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f0xx_hal.h"
+#include "arm_math.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SAMPLER STM32F072B_DISCOVERY SAMPLER
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SAMPLER_Exported_Constants Exported Constants
+  * @{
+  */
+
+#define SAMPLER_OK                   0U
+#define SAMPLER_ERROR                1U
+
+/* Largest block, in ADC samples: the DMA buffer holds two */
+#ifndef SAMPLER_BLOCK_MAX
+#define SAMPLER_BLOCK_MAX            256U
+#endif
+/* Largest decimation filter */
+#ifndef SAMPLER_TAPS_MAX
+#define SAMPLER_TAPS_MAX             64U
+#endif
+
+/* Highest conversion rate: 20 ADC clock cycles per conversion, 7.5 of them
+   sampling, at PCLK / 4 = 12 MHz */
+#define SAMPLER_RATE_MAX             600000U
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SAMPLER_Exported_Types Exported Types
+  * @{
+  */
+
+/* Application stage, at the end of the chain: Count samples, decimated, and
+   their RMS value. pBlock is only valid during the call. */
+typedef void (*SAMPLER_CallbackTypeDef)(const q15_t *pBlock, uint32_t Count, q15_t Rms);
+
+typedef struct
+{
+  uint32_t                SampleRate;    /* ADC conversions per second */
+  uint16_t                BlockSize;     /* ADC samples per block: even, a multiple of DecimFactor */
+  uint8_t                 DecimFactor;   /* 1: no decimation filter */
+  uint16_t                DecimTaps;     /* Taps of the decimation filter */
+  const q15_t            *pDecimCoeffs;  /* in the order of arm_fir_decimate_q15() */
+  SAMPLER_CallbackTypeDef Callback;
+} SAMPLER_ConfigTypeDef;
+
+typedef struct
+{
+  uint32_t SampleRate;       /* Conversions per second, as the timer runs */
+  uint32_t Blocks;           /* Blocks through the whole chain */
+  uint32_t Overruns;         /* Blocks the DMA wrote to before the chain was done */
+  uint32_t Errors;           /* DMA or ADC errors */
+} SAMPLER_StatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SAMPLER_Exported_Functions Exported Functions
+  * @{
+  */
+uint8_t BSP_SAMPLER_Start(const SAMPLER_ConfigTypeDef *pConfig);
+void    BSP_SAMPLER_Stop(void);
+void    BSP_SAMPLER_GetStats(SAMPLER_StatsTypeDef *pStats);
+
+/* Link functions of the ADC, its DMA and the TIM3 trigger */
+uint32_t SAMPLER_IO_Start(uint16_t *pBuffer, uint32_t Length, uint32_t SampleRate);
+void     SAMPLER_IO_Stop(void);
+uint32_t SAMPLER_IO_GetPosition(void);
+/* Called by the link layer from the DMA interrupt */
+void     SAMPLER_IO_HalfCpltCallback(void);
+void     SAMPLER_IO_CpltCallback(void);
+void     SAMPLER_IO_ErrorCallback(void);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_SAMPLER_H */
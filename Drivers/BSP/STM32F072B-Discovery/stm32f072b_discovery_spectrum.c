@@ -0,0 +1,536 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_spectrum.c
+  * @brief   This file provides a spectrum analyzer streaming its frames over
+  *          USART3.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - BSP_SPECTRUM_Push() takes the samples of the sampling pipeline
+  *             (BSP_SAMPLER_Start(), from its callback) into a ring of two
+  *             frames. Each time Hop more samples are in, the last N of them
+  *             are a frame ready: N - Hop samples of overlap. A frame not
+  *             taken when the next one is ready is dropped.
+  *           - BSP_SPECTRUM_Process() runs from the main loop. It takes the
+  *             last frame ready and, with arm_mult_q15(), applies a Hann
+  *             window on the way out of the ring, then runs arm_rfft_q15().
+  *             Each bin is then 8 log2 of the power re^2 + im^2, from a
+  *             normalisation and a table of 64 mantissas: 8 bits, 0.376 dB
+  *             per step, 93 dB of range. The log of the power is twice that
+  *             of the magnitude: no arm_cmplx_mag_q15(), whose square root
+  *             needs the floating-point library on the Cortex-M0.
+  *           - Each frame sent holds the differences to the previous one sent,
+  *             one nibble per bin, or all the bins every KeyInterval frames
+  *             and when that is shorter (see the frame format in
+  *             stm32f072b_discovery_spectrum.h). A receiver that misses a
+  *             frame, from a sequence gap or a bad checksum, waits for the
+  *             next key frame. Noise bins change by more than 7 steps
+  *             from one frame to the next and take three nibbles each:
+  *             the bins below the Floor of the configuration are set to
+  *             it, which keeps the noise out of the delta frames.
+  *           - Two transmit buffers: one on the USART3 DMA, the next one
+  *             queued. A frame analysed while both are in use is not sent,
+  *             and the next one still refers to the last one sent.
+  *           - arm_rfft_q15() works from arm_cfft_sR_q15_len<N/2> and the
+  *             realCoefAQ15/BQ15 tables: fft_tables(... TYPES q15 RFFT)
+  *             (cmake/fft_tables.cmake) gives those of the sizes used only.
+  *             With SPECTRUM_FFT_MAX at 512, the buffers take 7 Kbytes of
+  *             RAM.
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_spectrum.h"
+#include <string.h>
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_SPECTRUM
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SPECTRUM_Private_Variables Private Variables
+  * @{
+  */
+/* 8 log2(1 + (m + 0.5) / 64), rounded: the fraction of a bin from the 6 bits
+   after the leading one of the power */
+static const uint8_t SpectrumLogTable[64] =
+{
+  0U, 0U, 0U, 1U, 1U, 1U, 1U, 1U, 1U, 2U, 2U, 2U, 2U, 2U, 2U, 3U,
+  3U, 3U, 3U, 3U, 3U, 3U, 3U, 4U, 4U, 4U, 4U, 4U, 4U, 4U, 4U, 5U,
+  5U, 5U, 5U, 5U, 5U, 5U, 5U, 6U, 6U, 6U, 6U, 6U, 6U, 6U, 6U, 6U,
+  7U, 7U, 7U, 7U, 7U, 7U, 7U, 7U, 7U, 7U, 7U, 8U, 8U, 8U, 8U, 8U
+};
+
+static arm_rfft_instance_q15    SpectrumFft;
+static SPECTRUM_CallbackTypeDef SpectrumCallback;
+static SPECTRUM_StatsTypeDef    SpectrumStats;
+static uint16_t                 SpectrumSize;       /* 0 until initialized */
+static uint16_t                 SpectrumHop;
+static uint16_t                 SpectrumKeyInterval;
+static uint16_t                 SpectrumSinceKey;   /* Frames sent since the last key frame */
+static uint8_t                  SpectrumLog2Size;
+static uint8_t                  SpectrumFloor;
+static uint8_t                  SpectrumSeq;
+static uint32_t                 SpectrumRate;
+/* Written by BSP_SPECTRUM_Push() only */
+static __IO uint32_t            SpectrumWritten;    /* Samples pushed */
+static __IO uint32_t            SpectrumReady;      /* Frames ready */
+static __IO uint32_t            SpectrumReadyEnd;   /* Last sample of the last of them, + 1 */
+static uint32_t                 SpectrumNextEnd;
+static uint32_t                 SpectrumTaken;      /* Frames ready when last taken */
+/* 0 when idle, else 1 + the buffer on the DMA, or waiting for it */
+static __IO uint8_t             SpectrumTxActive;
+static __IO uint8_t             SpectrumTxQueued;
+static __IO uint8_t             SpectrumForceKey;
+static uint16_t                 SpectrumTxQueuedLength;
+static q15_t                    SpectrumRing[2U * SPECTRUM_FFT_MAX];
+static q15_t                    SpectrumWindow[SPECTRUM_FFT_MAX];
+static q15_t                    SpectrumFrame[SPECTRUM_FFT_MAX];
+static q15_t                    SpectrumOutput[2U * SPECTRUM_FFT_MAX];
+static uint8_t                  SpectrumBins[SPECTRUM_FFT_MAX / 2U];
+static uint8_t                  SpectrumSent[SPECTRUM_FFT_MAX / 2U];
+static uint8_t                  SpectrumTx[2][SPECTRUM_FRAME_MAX];
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SPECTRUM_Private_Functions Private Functions
+  * @{
+  */
+
+/**
+  * @brief  8 log2 of a power, to within one step.
+  * @param  Power  re^2 + im^2 of a bin, up to 2^31.
+  * @retval The bin, 0 for a power of 0 or 1
+  */
+static uint8_t SPECTRUM_Log(uint32_t Power)
+{
+  uint32_t exponent = 31U;
+
+  if (Power == 0U)
+  {
+    return 0;
+  }
+  /* No CLZ instruction on the Cortex-M0 */
+  if (Power < 0x00010000U)
+  {
+    Power <<= 16;
+    exponent -= 16U;
+  }
+  if (Power < 0x01000000U)
+  {
+    Power <<= 8;
+    exponent -= 8U;
+  }
+  if (Power < 0x10000000U)
+  {
+    Power <<= 4;
+    exponent -= 4U;
+  }
+  if (Power < 0x40000000U)
+  {
+    Power <<= 2;
+    exponent -= 2U;
+  }
+  if (Power < 0x80000000U)
+  {
+    Power <<= 1;
+    exponent -= 1U;
+  }
+  return (uint8_t)(8U * exponent + SpectrumLogTable[(Power >> 25) & 0x3FU]);
+}
+
+/**
+  * @brief  Appends a nibble to a delta payload.
+  * @param  pPayload  payload.
+  * @param  Index  nibbles already in it.
+  * @param  Value  0 to 15.
+  * @retval None
+  */
+static void SPECTRUM_PutNibble(uint8_t *pPayload, uint32_t Index, uint32_t Value)
+{
+  if ((Index & 1U) == 0U)
+  {
+    pPayload[Index >> 1] = (uint8_t)Value;
+  }
+  else
+  {
+    pPayload[Index >> 1] |= (uint8_t)(Value << 4);
+  }
+}
+
+/**
+  * @brief  Builds the frame of SpectrumBins.
+  * @param  pFrame  transmit buffer, SPECTRUM_FRAME_MAX bytes.
+  * @param  Key  1 for a key frame, 0 for a delta frame if not longer.
+  * @retval Length of the frame, bit 16 set for a key frame
+  */
+static uint32_t SPECTRUM_Encode(uint8_t *pFrame, uint32_t Key)
+{
+  uint8_t *pPayload = &pFrame[SPECTRUM_HEADER_SIZE];
+  uint32_t bins = SpectrumSize / 2U;
+  uint32_t limit = SPECTRUM_KEY_INFO_SIZE + bins;
+  uint32_t length = 0, nibbles = 0, sum1 = 0, sum2 = 0, i;
+  int32_t  delta;
+
+  if (Key == 0U)
+  {
+    for (i = 0; i < bins; i++)
+    {
+      /* Three nibbles at most: key frame if the payload would reach its size */
+      if (nibbles + 4U > 2U * limit)
+      {
+        break;
+      }
+      delta = (int32_t)SpectrumBins[i] - (int32_t)SpectrumSent[i];
+      if ((delta >= -7) && (delta <= 7))
+      {
+        SPECTRUM_PutNibble(pPayload, nibbles++, (delta >= 0) ? (uint32_t)(2 * delta) : (uint32_t)(-2 * delta - 1));
+      }
+      else
+      {
+        SPECTRUM_PutNibble(pPayload, nibbles++, SPECTRUM_NIBBLE_ESCAPE);
+        SPECTRUM_PutNibble(pPayload, nibbles++, SpectrumBins[i] >> 4);
+        SPECTRUM_PutNibble(pPayload, nibbles++, SpectrumBins[i] & 0x0FU);
+      }
+    }
+    if (i == bins)
+    {
+      length = (nibbles + 1U) / 2U;
+    }
+    else
+    {
+      Key = 1U;
+    }
+  }
+  if (Key != 0U)
+  {
+    pPayload[0] = (uint8_t)SpectrumRate;
+    pPayload[1] = (uint8_t)(SpectrumRate >> 8);
+    pPayload[2] = (uint8_t)(SpectrumRate >> 16);
+    pPayload[3] = (uint8_t)(SpectrumRate >> 24);
+    pPayload[4] = (uint8_t)SpectrumHop;
+    pPayload[5] = (uint8_t)(SpectrumHop >> 8);
+    memcpy(&pPayload[SPECTRUM_KEY_INFO_SIZE], SpectrumBins, bins);
+    length = limit;
+  }
+
+  pFrame[0] = SPECTRUM_SYNC0;
+  pFrame[1] = SPECTRUM_SYNC1;
+  pFrame[2] = (uint8_t)(((Key != 0U) ? SPECTRUM_FLAG_KEY : 0U) | (SpectrumSeq & SPECTRUM_SEQ_MASK));
+  pFrame[3] = SpectrumLog2Size;
+  pFrame[4] = (uint8_t)length;
+  pFrame[5] = (uint8_t)(length >> 8);
+
+  /* Fletcher-16, reduced once: no overflow below 5800 bytes */
+  for (i = 2; i < SPECTRUM_HEADER_SIZE + length; i++)
+  {
+    sum1 += pFrame[i];
+    sum2 += sum1;
+  }
+  pFrame[i] = (uint8_t)(sum1 % 255U);
+  pFrame[i + 1U] = (uint8_t)(sum2 % 255U);
+  return (i + SPECTRUM_CHECKSUM_SIZE) | ((Key != 0U) ? (1UL << 16) : 0U);
+}
+
+/**
+  * @brief  Sends the bins of the frame analysed, or queues them behind the
+  *         frame being sent.
+  * @retval None
+  */
+static void SPECTRUM_Send(void)
+{
+  uint32_t primask, frame, length, key, buffer;
+  uint8_t  started = 1U;
+
+  /* The buffer neither on the DMA nor queued: only this function queues */
+  if ((SpectrumTxActive != 0U) && (SpectrumTxQueued != 0U))
+  {
+    SpectrumStats.TxDropped++;
+    return;
+  }
+  buffer = (SpectrumTxActive == 1U) ? 1U : 0U;
+
+  key = ((SpectrumSinceKey == 0U) || (SpectrumForceKey != 0U)) ? 1U : 0U;
+  frame = SPECTRUM_Encode(SpectrumTx[buffer], key);
+  length = frame & 0xFFFFU;
+  key = frame >> 16;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (SpectrumTxActive == 0U)
+  {
+    SpectrumTxActive = (uint8_t)(buffer + 1U);
+    if (SPECTRUM_IO_Transmit(SpectrumTx[buffer], (uint16_t)length) != 0U)
+    {
+      SpectrumTxActive = 0;
+      started = 0;
+    }
+  }
+  else
+  {
+    SpectrumTxQueuedLength = (uint16_t)length;
+    SpectrumTxQueued = (uint8_t)(buffer + 1U);
+  }
+  if (started == 0U)
+  {
+    SpectrumStats.TxErrors++;
+    SpectrumForceKey = 1U;
+  }
+  else if (key != 0U)
+  {
+    SpectrumForceKey = 0;
+  }
+  __set_PRIMASK(primask);
+  if (started == 0U)
+  {
+    return;
+  }
+
+  memcpy(SpectrumSent, SpectrumBins, SpectrumSize / 2U);
+  SpectrumSeq++;
+  SpectrumSinceKey = (key != 0U) ? 1U : (uint16_t)(SpectrumSinceKey + 1U);
+  if (SpectrumSinceKey >= SpectrumKeyInterval)
+  {
+    SpectrumSinceKey = 0;
+  }
+  SpectrumStats.Sent++;
+  SpectrumStats.KeyFrames += key;
+  SpectrumStats.Bytes += length;
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_SPECTRUM_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Sets up the transform, the window and USART3.
+  * @note   Call before the sampler starts pushing samples.
+  * @param  pConfig  analyzer configuration.
+  * @retval SPECTRUM_OK if done
+  */
+uint8_t BSP_SPECTRUM_Init(const SPECTRUM_ConfigTypeDef *pConfig)
+{
+  const q15_t *pCoefA;
+  uint32_t size, step, i;
+
+  if ((pConfig == NULL) || (pConfig->FftSize < SPECTRUM_FFT_MIN) || (pConfig->FftSize > SPECTRUM_FFT_MAX) ||
+      ((pConfig->FftSize & (pConfig->FftSize - 1U)) != 0U) || (pConfig->Hop == 0U) ||
+      (pConfig->Hop > pConfig->FftSize) || (pConfig->KeyInterval == 0U) ||
+      (arm_rfft_init_q15(&SpectrumFft, pConfig->FftSize, 0U, 1U) != ARM_MATH_SUCCESS))
+  {
+    return SPECTRUM_ERROR;
+  }
+  size = pConfig->FftSize;
+
+  /* Hann window, 0.5 - 0.5 cos(2 pi i / N): the odd entries of realCoefAQ15,
+     twidCoefRModifier pairs apart, hold -0.5 cos(2 pi i / N) */
+  pCoefA = SpectrumFft.pTwiddleAReal;
+  step = 2U * SpectrumFft.twidCoefRModifier;
+  SpectrumWindow[0] = 0;
+  for (i = 1; i < size / 2U; i++)
+  {
+    SpectrumWindow[i] = (q15_t)(0x4000 + pCoefA[i * step + 1U]);
+    SpectrumWindow[size - i] = SpectrumWindow[i];
+  }
+  SpectrumWindow[size / 2U] = 0x7FFF;
+
+  SpectrumSize = 0;
+  if (SPECTRUM_IO_Init(pConfig->BaudRate) != 0U)
+  {
+    return SPECTRUM_ERROR;
+  }
+  SpectrumCallback = pConfig->Callback;
+  SpectrumHop = pConfig->Hop;
+  SpectrumKeyInterval = pConfig->KeyInterval;
+  SpectrumFloor = pConfig->Floor;
+  SpectrumRate = pConfig->SampleRate;
+  for (SpectrumLog2Size = 0; (1UL << SpectrumLog2Size) < size; SpectrumLog2Size++)
+  {
+  }
+  SpectrumSinceKey = 0;
+  SpectrumSeq = 0;
+  SpectrumWritten = 0;
+  SpectrumReady = 0;
+  SpectrumReadyEnd = 0;
+  SpectrumNextEnd = size;
+  SpectrumTaken = 0;
+  SpectrumTxActive = 0;
+  SpectrumTxQueued = 0;
+  SpectrumForceKey = 0;
+  memset(&SpectrumStats, 0, sizeof(SpectrumStats));
+  SpectrumSize = (uint16_t)size;
+  return SPECTRUM_OK;
+}
+
+/**
+  * @brief  Adds samples to the ring and marks the frames they complete.
+  * @note   Called from the sampler callback, in the DMA interrupt.
+  * @param  pSamples  samples in q15.
+  * @param  Count  number of samples.
+  * @retval None
+  */
+void BSP_SPECTRUM_Push(const q15_t *pSamples, uint32_t Count)
+{
+  uint32_t written = SpectrumWritten;
+  uint32_t mask = 2U * SpectrumSize - 1U;
+  uint32_t ready = 0, chunk, position;
+
+  if (SpectrumSize == 0U)
+  {
+    return;
+  }
+  while (Count != 0U)
+  {
+    position = written & mask;
+    chunk = mask + 1U - position;
+    if (chunk > Count)
+    {
+      chunk = Count;
+    }
+    memcpy(&SpectrumRing[position], pSamples, chunk * sizeof(q15_t));
+    pSamples += chunk;
+    Count -= chunk;
+    written += chunk;
+  }
+  SpectrumWritten = written;
+
+  /* The frames ready: only the last one is kept */
+  while ((int32_t)(written - SpectrumNextEnd) >= 0)
+  {
+    SpectrumReadyEnd = SpectrumNextEnd;
+    SpectrumNextEnd += SpectrumHop;
+    ready++;
+  }
+  SpectrumReady += ready;
+}
+
+/**
+  * @brief  Analyses and sends the last frame ready.
+  * @note   Called from the main loop.
+  * @retval 1 if a frame was analysed, 0 if none was ready or the ring
+  *         overwrote it meanwhile
+  */
+uint32_t BSP_SPECTRUM_Process(void)
+{
+  uint32_t size = SpectrumSize;
+  uint32_t mask = 2U * size - 1U;
+  uint32_t primask, ready, start, first, i;
+  q15_t    re, im;
+  uint8_t  bin;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  ready = SpectrumReady;
+  start = SpectrumReadyEnd - size;
+  __set_PRIMASK(primask);
+  if ((size == 0U) || (ready == SpectrumTaken))
+  {
+    return 0;
+  }
+  SpectrumStats.Dropped += ready - SpectrumTaken - 1U;
+  SpectrumTaken = ready;
+
+  /* Windowed out of the ring, in two parts if it wraps */
+  first = (mask + 1U) - (start & mask);
+  if (first > size)
+  {
+    first = size;
+  }
+  arm_mult_q15(&SpectrumRing[start & mask], SpectrumWindow, SpectrumFrame, first);
+  if (first < size)
+  {
+    arm_mult_q15(SpectrumRing, &SpectrumWindow[first], &SpectrumFrame[first], size - first);
+  }
+  /* The oldest samples overwritten meanwhile: the frame spans two periods */
+  if ((SpectrumWritten - start) > (mask + 1U))
+  {
+    SpectrumStats.Dropped++;
+    return 0;
+  }
+
+  arm_rfft_q15(&SpectrumFft, SpectrumFrame, SpectrumOutput);
+  for (i = 0; i < size / 2U; i++)
+  {
+    re = SpectrumOutput[2U * i];
+    im = SpectrumOutput[2U * i + 1U];
+    bin = SPECTRUM_Log((uint32_t)(re * re) + (uint32_t)(im * im));
+    SpectrumBins[i] = (bin > SpectrumFloor) ? bin : SpectrumFloor;
+  }
+  SpectrumStats.Frames++;
+  if (SpectrumCallback != NULL)
+  {
+    SpectrumCallback(SpectrumBins, size / 2U, start + size);
+  }
+
+  SPECTRUM_Send();
+  return 1;
+}
+
+/**
+  * @brief  Returns the analyzer counters.
+  * @param  pStats  pointer to the structure to fill.
+  * @retval None
+  */
+void BSP_SPECTRUM_GetStats(SPECTRUM_StatsTypeDef *pStats)
+{
+  *pStats = SpectrumStats;
+}
+
+/**
+  * @brief  Frame sent, from the link layer: sends the one queued.
+  * @retval None
+  */
+void SPECTRUM_IO_TxCpltCallback(void)
+{
+  uint8_t buffer = SpectrumTxQueued;
+
+  SpectrumTxQueued = 0;
+  SpectrumTxActive = buffer;
+  if ((buffer != 0U) &&
+      (SPECTRUM_IO_Transmit(SpectrumTx[buffer - 1U], SpectrumTxQueuedLength) != 0U))
+  {
+    SpectrumTxActive = 0;
+    SpectrumStats.TxErrors++;
+    SpectrumForceKey = 1U;
+  }
+}
+
+/**
+  * @brief  USART or DMA error, from the link layer: the frame is lost.
+  * @retval None
+  */
+void SPECTRUM_IO_ErrorCallback(void)
+{
+  SpectrumStats.TxErrors++;
+  SpectrumForceKey = 1U;
+  SPECTRUM_IO_TxCpltCallback();
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
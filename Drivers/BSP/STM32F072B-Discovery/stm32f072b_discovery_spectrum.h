@@ -0,0 +1,147 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_spectrum.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_spectrum.c spectrum analyzer.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_SPECTRUM_H
+#define __STM32072B_DISCOVERY_SPECTRUM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f0xx_hal.h"
+#include "arm_math.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SPECTRUM STM32F072B_DISCOVERY SPECTRUM
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SPECTRUM_Exported_Constants Exported Constants
+  * @{
+  */
+
+#define SPECTRUM_OK                  0U
+#define SPECTRUM_ERROR               1U
+
+/* Largest real FFT, in samples: sizes the sample ring, the window and the
+   transform buffers */
+#ifndef SPECTRUM_FFT_MAX
+#define SPECTRUM_FFT_MAX             512U
+#endif
+#define SPECTRUM_FFT_MIN             32U
+
+/* Frame on the wire:
+     0xA5 0x5A  flags  log2(N)  length (2 bytes)  payload  checksum (2 bytes)
+   flags: SPECTRUM_FLAG_KEY and the sequence number of the frame sent, modulo
+   128. The checksum is the Fletcher-16 of the bytes from flags to the end of
+   the payload, the low sum first. Multi-byte fields are little endian.
+   Key frame payload: sample rate (4 bytes), hop (2 bytes), then N / 2 bins.
+   Delta frame payload: one nibble per bin, low nibble first, the zigzag code
+   of the difference to the previous frame sent (-7 to 7), or
+   SPECTRUM_NIBBLE_ESCAPE then the bin itself, high nibble first. */
+#define SPECTRUM_SYNC0               0xA5U
+#define SPECTRUM_SYNC1               0x5AU
+#define SPECTRUM_FLAG_KEY            0x80U
+#define SPECTRUM_SEQ_MASK            0x7FU
+#define SPECTRUM_NIBBLE_ESCAPE       0x0FU
+#define SPECTRUM_HEADER_SIZE         6U
+#define SPECTRUM_KEY_INFO_SIZE       6U
+#define SPECTRUM_CHECKSUM_SIZE       2U
+/* A delta frame longer than the key frame is sent as a key frame */
+#define SPECTRUM_FRAME_MAX           (SPECTRUM_HEADER_SIZE + SPECTRUM_KEY_INFO_SIZE + \
+                                      SPECTRUM_FFT_MAX / 2U + SPECTRUM_CHECKSUM_SIZE)
+
+/* A bin is 8 log2 of the power of an arm_rfft_q15() output, 0 to 248:
+   0.376 dB per step. A full-scale sine without the window gives 224 at its
+   bin, with the Hann window 208. */
+#define SPECTRUM_BIN_FULL_SCALE      224U
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SPECTRUM_Exported_Types Exported Types
+  * @{
+  */
+
+/* Bins of each frame analysed, sent or not: N / 2 of them, from DC; End is
+   the number of samples pushed up to the last of the frame. pBins is only
+   valid during the call. */
+typedef void (*SPECTRUM_CallbackTypeDef)(const uint8_t *pBins, uint32_t Count, uint32_t End);
+
+typedef struct
+{
+  uint16_t                 FftSize;      /* N, a power of 2, SPECTRUM_FFT_MIN to SPECTRUM_FFT_MAX */
+  uint16_t                 Hop;          /* Samples between frames, 1 to N: N / 2 for 50% overlap */
+  uint16_t                 KeyInterval;  /* Frames sent per key frame */
+  uint8_t                  Floor;        /* Bins below it are set to it, 0 for none */
+  uint32_t                 SampleRate;   /* Of the samples pushed, sent in the key frames */
+  uint32_t                 BaudRate;     /* Of USART3 */
+  SPECTRUM_CallbackTypeDef Callback;     /* NULL if none */
+} SPECTRUM_ConfigTypeDef;
+
+typedef struct
+{
+  uint32_t Frames;           /* Frames analysed */
+  uint32_t Dropped;          /* Frames replaced by the next one, or overwritten, before their analysis */
+  uint32_t Sent;             /* Frames queued for transmission */
+  uint32_t KeyFrames;        /* Of which key frames */
+  uint32_t TxDropped;        /* Frames analysed while both transmit buffers were in use */
+  uint32_t TxErrors;         /* USART or DMA errors */
+  uint32_t Bytes;            /* Bytes queued for transmission */
+} SPECTRUM_StatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SPECTRUM_Exported_Functions Exported Functions
+  * @{
+  */
+uint8_t  BSP_SPECTRUM_Init(const SPECTRUM_ConfigTypeDef *pConfig);
+void     BSP_SPECTRUM_Push(const q15_t *pSamples, uint32_t Count);
+uint32_t BSP_SPECTRUM_Process(void);
+void     BSP_SPECTRUM_GetStats(SPECTRUM_StatsTypeDef *pStats);
+
+/* Link functions of USART3 and its transmit DMA */
+uint8_t  SPECTRUM_IO_Init(uint32_t BaudRate);
+uint8_t  SPECTRUM_IO_Transmit(const uint8_t *pData, uint16_t Length);
+/* Called by the link layer from the USART interrupt */
+void     SPECTRUM_IO_TxCpltCallback(void);
+void     SPECTRUM_IO_ErrorCallback(void);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_SPECTRUM_H */
@@ -0,0 +1,469 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_synth.c
+  * @brief   This file provides a DMA-fed waveform synthesizer on the DAC.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - BSP_SYNTH_Start() starts the DAC channel 1 on DISCOVERY_DAC_PIN,
+  *             updated at each TIM6 update event at the requested rate from
+  *             a circular DMA buffer of two blocks. The half and complete
+  *             transfer interrupts refill the block the DMA has just read
+  *             while it reads the other one; both blocks are written before
+  *             the start. The output timing is that of the timer alone: the
+  *             interrupt latency only has to stay below a block time.
+  *           - Each voice is a 32-bit phase accumulator: the phase advances
+  *             by floor(f * 2^32 / rate) per sample. Its 9 upper bits index
+  *             sinTable_q15 (512 points and the closing one, as
+  *             arm_sin_q15() reads it), the next 16 interpolate linearly
+  *             between two entries; SYNTH_WAVE_SINE_TABLE takes the nearest
+  *             entry instead, for fewer cycles and a worse spectrum. Square
+  *             and saw waves come from the phase itself.
+  *           - A sweep moves the increment by a constant step each sample,
+  *             from Frequency to SweepTo, in runs of samples that end at the
+  *             sweep ends: the inner loops never test for them. The phase is
+  *             never reset, so a voice stays continuous across blocks,
+  *             sweeps and BSP_SYNTH_SetVoice() changes, which take effect at
+  *             the start of the next block written.
+  *           - The voices add up in q15, then 2048 + sum / 16, rounded, is
+  *             saturated to the 12-bit right-aligned DAC range; a voice of
+  *             Amplitude 0x7FFF spans it all.
+  *           - The blocks are written in the DMA1_Channel2_3 interrupt: the
+  *             application calls HAL_DMA_IRQHandler() for
+  *             DacHandle.DMA_Handle1 from DMA1_Channel2_3_IRQHandler(), and
+  *             HAL_DAC_IRQHandler() from TIM6_DAC_IRQHandler(). A block still
+  *             being written when the DMA comes back to it, or whose
+  *             interrupt was lost because the previous one ran too long, is
+  *             counted as an underrun: the DAC has output part of the block
+  *             before.
+  *           - DMA1 channel 3 is also the LCD SPI1 transmit channel: the
+  *             synthesizer and the LCD DMA transfers exclude each other.
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_synth.h"
+#include "arm_common_tables.h"
+#include <string.h>
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_SYNTH
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SYNTH_Private_Types Private Types
+  * @{
+  */
+typedef struct
+{
+  uint32_t Phase;
+  uint32_t Increment;
+  int32_t  Step;             /* Added to Increment each sample of a sweep */
+  uint32_t Left;             /* Samples to the end of the sweep */
+  uint32_t Samples;          /* Samples of a whole sweep */
+  uint32_t Start;            /* Increments at Frequency and SweepTo */
+  uint32_t End;
+  uint8_t  Wave;
+  uint8_t  Sweep;
+  q15_t    Amplitude;
+} SYNTH_StateTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SYNTH_Private_Variables Private Variables
+  * @{
+  */
+static SYNTH_CallbackTypeDef SynthCallback;
+static __IO uint8_t          SynthRunning;
+static uint8_t               SynthNext;          /* Half expected next */
+static uint16_t              SynthBlockSize;
+static SYNTH_StatsTypeDef    SynthStats;
+/* Voices as last set, and those to apply at the next block */
+static SYNTH_VoiceTypeDef    SynthVoices[SYNTH_VOICES];
+static __IO uint8_t          SynthPending;
+static SYNTH_StateTypeDef    SynthStates[SYNTH_VOICES];
+static int32_t               SynthMix[SYNTH_BLOCK_MAX];
+static uint16_t              SynthBuffer[2U * SYNTH_BLOCK_MAX];
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SYNTH_Private_Functions Private Functions
+  * @{
+  */
+
+/**
+  * @brief  Phase increment of a frequency at the running rate.
+  * @param  Frequency  in mHz.
+  * @retval floor(Frequency * 2^32 / rate), held below half a turn
+  */
+static uint32_t SYNTH_Increment(uint32_t Frequency)
+{
+  uint64_t increment = ((uint64_t)Frequency << 32) / ((uint64_t)SynthStats.SampleRate * 1000U);
+
+  return (increment < 0x80000000U) ? (uint32_t)increment : 0x7FFFFFFFU;
+}
+
+/**
+  * @brief  Sets a voice up from its settings, at its current phase.
+  * @param  pState  voice state.
+  * @param  pVoice  settings.
+  * @retval None
+  */
+static void SYNTH_Apply(SYNTH_StateTypeDef *pState, const SYNTH_VoiceTypeDef *pVoice)
+{
+  uint64_t samples = (uint64_t)pVoice->SweepTime * SynthStats.SampleRate / 1000U;
+
+  pState->Wave = pVoice->Wave;
+  pState->Amplitude = pVoice->Amplitude;
+  pState->Start = SYNTH_Increment(pVoice->Frequency);
+  pState->End = SYNTH_Increment(pVoice->SweepTo);
+  pState->Increment = pState->Start;
+  pState->Step = 0;
+  pState->Sweep = pVoice->Sweep;
+  if ((pState->Sweep == SYNTH_SWEEP_NONE) || (samples == 0U) || (samples > 0xFFFFFFFFU))
+  {
+    pState->Sweep = SYNTH_SWEEP_NONE;
+    return;
+  }
+  pState->Samples = (uint32_t)samples;
+  pState->Left = pState->Samples;
+  pState->Step = (int32_t)(((int64_t)pState->End - (int64_t)pState->Start) / (int64_t)samples);
+}
+
+/**
+  * @brief  Next sweep, once the increment has reached one end.
+  * @param  pState  voice state.
+  * @retval None
+  */
+static void SYNTH_SweepEnd(SYNTH_StateTypeDef *pState)
+{
+  switch (pState->Sweep)
+  {
+    case SYNTH_SWEEP_ONCE:
+      pState->Increment = pState->End;
+      pState->Step = 0;
+      pState->Sweep = SYNTH_SWEEP_NONE;
+      break;
+    case SYNTH_SWEEP_REPEAT:
+      pState->Increment = pState->Start;
+      break;
+    default:
+      /* Back the same way, by the same steps */
+      pState->Step = -pState->Step;
+      break;
+  }
+  pState->Left = pState->Samples;
+}
+
+/**
+  * @brief  Adds Count samples of a voice to the mix, sweeping as it goes.
+  * @param  pState  voice state.
+  * @param  pMix  mix samples, q15.
+  * @param  Count  number of samples, without a sweep end before the last.
+  * @retval None
+  */
+static void SYNTH_Voice(SYNTH_StateTypeDef *pState, int32_t *pMix, uint32_t Count)
+{
+  uint32_t phase = pState->Phase, increment = pState->Increment, index, i;
+  int32_t  step = pState->Step, amplitude = pState->Amplitude, a, b;
+
+  switch (pState->Wave)
+  {
+    case SYNTH_WAVE_SINE:
+      for (i = 0; i < Count; i++)
+      {
+        index = phase >> 23;
+        a = sinTable_q15[index];
+        b = sinTable_q15[index + 1U];
+        a += ((b - a) * (int32_t)((phase >> 7) & 0xFFFFU)) >> 16;
+        pMix[i] += (a * amplitude) >> 15;
+        phase += increment;
+        increment += (uint32_t)step;
+      }
+      break;
+    case SYNTH_WAVE_SINE_TABLE:
+      for (i = 0; i < Count; i++)
+      {
+        /* Nearest entry: the closing one when rounding up past the last */
+        pMix[i] += (sinTable_q15[(phase >> 23) + ((phase >> 22) & 1U)] * amplitude) >> 15;
+        phase += increment;
+        increment += (uint32_t)step;
+      }
+      break;
+    case SYNTH_WAVE_SQUARE:
+      for (i = 0; i < Count; i++)
+      {
+        pMix[i] += (phase < 0x80000000U) ? amplitude : -amplitude;
+        phase += increment;
+        increment += (uint32_t)step;
+      }
+      break;
+    default:
+      for (i = 0; i < Count; i++)
+      {
+        pMix[i] += ((int32_t)(int16_t)(phase >> 16) * amplitude) >> 15;
+        phase += increment;
+        increment += (uint32_t)step;
+      }
+      break;
+  }
+  pState->Phase = phase;
+  pState->Increment = increment;
+}
+
+/**
+  * @brief  Writes the next block into one half of the DMA buffer.
+  * @param  Half  0 for the first block, 1 for the second.
+  * @retval None
+  */
+static void SYNTH_Render(uint32_t Half)
+{
+  uint16_t           *pOut = &SynthBuffer[Half * SynthBlockSize];
+  SYNTH_StateTypeDef *pState;
+  uint32_t            pending, voice, done, count, clipped = 0, i;
+  int32_t             v;
+
+  /* Settings changed since the last block */
+  pending = SynthPending;
+  SynthPending = 0;
+  for (voice = 0; voice < SYNTH_VOICES; voice++)
+  {
+    if ((pending & (1U << voice)) != 0U)
+    {
+      SYNTH_Apply(&SynthStates[voice], &SynthVoices[voice]);
+    }
+  }
+
+  memset(SynthMix, 0, SynthBlockSize * sizeof(SynthMix[0]));
+  for (voice = 0; voice < SYNTH_VOICES; voice++)
+  {
+    pState = &SynthStates[voice];
+    if ((pState->Wave == SYNTH_WAVE_OFF) || (pState->Amplitude == 0))
+    {
+      continue;
+    }
+    for (done = 0; done < SynthBlockSize; done += count)
+    {
+      count = SynthBlockSize - done;
+      if (pState->Sweep == SYNTH_SWEEP_NONE)
+      {
+        SYNTH_Voice(pState, &SynthMix[done], count);
+        continue;
+      }
+      count = (pState->Left < count) ? pState->Left : count;
+      SYNTH_Voice(pState, &SynthMix[done], count);
+      pState->Left -= count;
+      if (pState->Left == 0U)
+      {
+        SYNTH_SweepEnd(pState);
+      }
+    }
+  }
+
+  for (i = 0; i < SynthBlockSize; i++)
+  {
+    /* 2048 + sum / 16, rounded */
+    v = (SynthMix[i] + 32776) >> 4;
+    if ((uint32_t)v > 4095U)
+    {
+      v = (v < 0) ? 0 : 4095;
+      clipped++;
+    }
+    pOut[i] = (uint16_t)v;
+  }
+  SynthStats.Clipped += clipped;
+  SynthStats.Blocks++;
+
+  if (SynthCallback != NULL)
+  {
+    SynthCallback(pOut, SynthBlockSize);
+  }
+}
+
+/**
+  * @brief  Refills the half of the DMA buffer just read.
+  * @param  Half  0 for the first block, 1 for the second.
+  * @retval None
+  */
+static void SYNTH_Process(uint32_t Half)
+{
+  uint32_t underrun;
+
+  if (SynthRunning == 0)
+  {
+    return;
+  }
+  /* An interrupt lost, or the DMA already back in this half */
+  underrun = (Half != SynthNext) ? 1U : 0U;
+  SynthNext = (uint8_t)(Half ^ 1U);
+  if ((SYNTH_IO_GetPosition() / SynthBlockSize) == Half)
+  {
+    underrun = 1U;
+  }
+
+  SYNTH_Render(Half);
+
+  /* The DMA back in this half: part of it was read before the new block */
+  if ((SynthRunning != 0) && ((SYNTH_IO_GetPosition() / SynthBlockSize) == Half))
+  {
+    underrun = 1U;
+  }
+  SynthStats.Underruns += underrun;
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_SYNTH_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Starts the synthesizer, every voice from phase 0 with the
+  *         settings last given by BSP_SYNTH_SetVoice().
+  * @note   The rate is that of the TIM6 divider closest to SampleRate:
+  *         BSP_SYNTH_GetStats() returns it.
+  * @param  pConfig  synthesizer configuration.
+  * @retval SYNTH_OK if started
+  */
+uint8_t BSP_SYNTH_Start(const SYNTH_ConfigTypeDef *pConfig)
+{
+  uint32_t rate;
+
+  if ((SynthRunning != 0) || (pConfig == NULL) || (pConfig->SampleRate == 0U) ||
+      (pConfig->SampleRate > SYNTH_RATE_MAX) || (pConfig->BlockSize == 0U) ||
+      (pConfig->BlockSize > SYNTH_BLOCK_MAX))
+  {
+    return SYNTH_ERROR;
+  }
+  rate = SYNTH_IO_Init(pConfig->SampleRate);
+  if (rate == 0U)
+  {
+    return SYNTH_ERROR;
+  }
+
+  SynthCallback = pConfig->Callback;
+  SynthBlockSize = pConfig->BlockSize;
+  SynthNext = 0;
+  SynthStats.SampleRate = rate;
+  SynthStats.Blocks = 0;
+  SynthStats.Underruns = 0;
+  SynthStats.Clipped = 0;
+  SynthStats.Errors = 0;
+  memset(SynthStates, 0, sizeof(SynthStates));
+  SynthPending = (uint8_t)((1U << SYNTH_VOICES) - 1U);
+
+  SYNTH_Render(0);
+  SYNTH_Render(1);
+  SynthRunning = 1;
+  if (SYNTH_IO_Start(SynthBuffer, 2U * SynthBlockSize) != 0U)
+  {
+    SynthRunning = 0;
+    return SYNTH_ERROR;
+  }
+  return SYNTH_OK;
+}
+
+/**
+  * @brief  Stops the timer, the DAC and its DMA.
+  * @retval None
+  */
+void BSP_SYNTH_Stop(void)
+{
+  if (SynthRunning == 0)
+  {
+    return;
+  }
+  SynthRunning = 0;
+  SYNTH_IO_Stop();
+}
+
+/**
+  * @brief  Sets a voice, from the next block written on.
+  * @note   The phase goes on from where it is; a sweep starts over.
+  * @param  Voice  0 to SYNTH_VOICES - 1.
+  * @param  pVoice  settings, copied.
+  * @retval SYNTH_OK if set
+  */
+uint8_t BSP_SYNTH_SetVoice(uint32_t Voice, const SYNTH_VoiceTypeDef *pVoice)
+{
+  uint32_t primask;
+
+  if ((Voice >= SYNTH_VOICES) || (pVoice == NULL) || (pVoice->Wave > SYNTH_WAVE_SAW) ||
+      (pVoice->Sweep > SYNTH_SWEEP_PINGPONG) || (pVoice->Amplitude < 0))
+  {
+    return SYNTH_ERROR;
+  }
+  /* Not with the block interrupt halfway through the copy */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  SynthVoices[Voice] = *pVoice;
+  SynthPending |= (uint8_t)(1U << Voice);
+  __set_PRIMASK(primask);
+  return SYNTH_OK;
+}
+
+/**
+  * @brief  Returns the synthesizer counters.
+  * @param  pStats  pointer to the structure to fill.
+  * @retval None
+  */
+void BSP_SYNTH_GetStats(SYNTH_StatsTypeDef *pStats)
+{
+  *pStats = SynthStats;
+}
+
+/**
+  * @brief  First block read, from the link layer.
+  * @retval None
+  */
+void SYNTH_IO_HalfCpltCallback(void)
+{
+  SYNTH_Process(0);
+}
+
+/**
+  * @brief  Second block read, from the link layer.
+  * @retval None
+  */
+void SYNTH_IO_CpltCallback(void)
+{
+  SYNTH_Process(1);
+}
+
+/**
+  * @brief  DMA or DAC underrun error, from the link layer.
+  * @retval None
+  */
+void SYNTH_IO_ErrorCallback(void)
+{
+  SynthStats.Errors++;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
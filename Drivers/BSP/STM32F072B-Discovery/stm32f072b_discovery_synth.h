@@ -0,0 +1,145 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_synth.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_synth.c DAC waveform synthesizer.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_SYNTH_H
+#define __STM32072B_DISCOVERY_SYNTH_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f0xx_hal.h"
+#include "arm_math.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SYNTH STM32F072B_DISCOVERY SYNTH
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SYNTH_Exported_Constants Exported Constants
+  * @{
+  */
+
+#define SYNTH_OK                     0U
+#define SYNTH_ERROR                  1U
+
+/* Voices mixed into the output */
+#ifndef SYNTH_VOICES
+#define SYNTH_VOICES                 4U
+#endif
+/* Largest block, in DAC samples: the DMA buffer holds two */
+#ifndef SYNTH_BLOCK_MAX
+#define SYNTH_BLOCK_MAX              256U
+#endif
+
+/* Highest update rate of the DAC */
+#define SYNTH_RATE_MAX               1000000U
+
+/* Waveforms */
+#define SYNTH_WAVE_OFF               0U
+#define SYNTH_WAVE_SINE              1U   /* sinTable_q15, interpolated */
+#define SYNTH_WAVE_SINE_TABLE        2U   /* sinTable_q15, nearest entry */
+#define SYNTH_WAVE_SQUARE            3U
+#define SYNTH_WAVE_SAW               4U   /* Rising, from 0 at the sine zero crossing */
+
+/* Frequency sweeps, from Frequency to SweepTo in SweepTime */
+#define SYNTH_SWEEP_NONE             0U
+#define SYNTH_SWEEP_ONCE             1U   /* then held at SweepTo */
+#define SYNTH_SWEEP_REPEAT           2U   /* from Frequency again */
+#define SYNTH_SWEEP_PINGPONG         3U   /* back to Frequency, and so on */
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SYNTH_Exported_Types Exported Types
+  * @{
+  */
+
+/* Application stage: each block of Count DAC samples (right-aligned 12-bit)
+   once written to the DMA buffer. pBlock is only valid during the call. */
+typedef void (*SYNTH_CallbackTypeDef)(const uint16_t *pBlock, uint32_t Count);
+
+typedef struct
+{
+  uint8_t  Wave;             /* SYNTH_WAVE_* */
+  uint8_t  Sweep;            /* SYNTH_SWEEP_* */
+  q15_t    Amplitude;        /* Peak, 0x7FFF for half the DAC range */
+  uint32_t Frequency;        /* mHz, held below half the sample rate */
+  uint32_t SweepTo;          /* mHz */
+  uint32_t SweepTime;        /* ms from Frequency to SweepTo */
+} SYNTH_VoiceTypeDef;
+
+typedef struct
+{
+  uint32_t              SampleRate;    /* DAC updates per second */
+  uint16_t              BlockSize;     /* DAC samples per block */
+  SYNTH_CallbackTypeDef Callback;      /* NULL if none */
+} SYNTH_ConfigTypeDef;
+
+typedef struct
+{
+  uint32_t SampleRate;       /* Updates per second, as the timer runs */
+  uint32_t Blocks;           /* Blocks written, the two before the start included */
+  uint32_t Underruns;        /* Blocks the DMA read from before they were done */
+  uint32_t Clipped;          /* Samples of the mix out of the DAC range */
+  uint32_t Errors;           /* DMA or DAC underrun errors */
+} SYNTH_StatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_SYNTH_Exported_Functions Exported Functions
+  * @{
+  */
+uint8_t BSP_SYNTH_Start(const SYNTH_ConfigTypeDef *pConfig);
+void    BSP_SYNTH_Stop(void);
+uint8_t BSP_SYNTH_SetVoice(uint32_t Voice, const SYNTH_VoiceTypeDef *pVoice);
+void    BSP_SYNTH_GetStats(SYNTH_StatsTypeDef *pStats);
+
+/* Link functions of the DAC, its DMA and the TIM6 trigger */
+uint32_t SYNTH_IO_Init(uint32_t SampleRate);
+uint8_t  SYNTH_IO_Start(uint16_t *pBuffer, uint32_t Length);
+void     SYNTH_IO_Stop(void);
+uint32_t SYNTH_IO_GetPosition(void);
+/* Called by the link layer from the DMA and DAC interrupts */
+void     SYNTH_IO_HalfCpltCallback(void);
+void     SYNTH_IO_CpltCallback(void);
+void     SYNTH_IO_ErrorCallback(void);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_SYNTH_H */
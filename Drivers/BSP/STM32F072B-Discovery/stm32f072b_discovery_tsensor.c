@@ -0,0 +1,475 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_tsensor.c
+  * @brief   This file provides a set of functions needed to manage an STLM75
+  *          temperature sensor wired to the I2C2 bus of the board.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - The sensor shares the bus with the M24LR64 EEPROM. Its
+  *             register accesses go through the I2C transaction scheduler
+  *             (stm32f072b_discovery_i2c.c) at high priority, so they wait
+  *             for at most the EEPROM transfer already on the bus.
+  *           - The STLM75 does not step its register pointer: each register
+  *             is read on its own; reads of the same register made at the
+  *             same time by different callers share one transfer.
+  *           - BSP_TSENSOR_AlertStart() sets the limits and puts the OS output
+  *             in interrupt mode: it goes active once the temperature has
+  *             been above the high limit for TSENSOR_FAULT_QUEUE conversions,
+  *             then once it has been below the low limit as long, and so on.
+  *             Nothing is read in between. At each falling edge
+  *             BSP_TSENSOR_AlertIRQHandler() submits a read of the
+  *             temperature, which also releases the output; the callback
+  *             gets the value and the side of the limits from the DMA
+  *             interrupt. The application calls it from
+  *             HAL_GPIO_EXTI_Callback() for TSENSOR_OS_PIN.
+  *           - BSP_TSENSOR_SampleStart() adds periodic reads, submitted from
+  *             BSP_TSENSOR_TickHandler() (SysTick_Handler(), after
+  *             HAL_IncTick()) at normal priority, without waiting. Every
+  *             Decimation reads, their mean goes into a ring of
+  *             TSENSOR_HISTORY_SIZE entries that BSP_TSENSOR_GetHistory()
+  *             empties, oldest first; when full the oldest entry goes. A
+  *             period whose read is still pending is skipped. The sensor
+  *             converts every 150 ms at most: faster reads repeat values.
+  *           - The temperatures of the service are int16_t in 1/256 degree
+  *             C, the layout of the temperature register: no float.
+  *          ===================================================================
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery_tsensor.h"
+#include <string.h>
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_TSENSOR
+  * @brief      STLM75 temperature sensor.
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_TSENSOR_Private_Variables Private Variables
+  * @{
+  */
+static TSENSOR_DrvTypeDef*    tsensor_drv;
+static uint16_t               TSENSORAddr;
+static void                 (*TSensorAlertCallback)(int16_t Temp, uint32_t Above);
+static int16_t                TSensorLow;          /* Low limit, 1/256 degree */
+static __IO uint8_t           TSensorAlertPending; /* Edge not served by a read yet */
+static uint32_t               TSensorPeriod;       /* ms between reads, 0 when not sampling */
+static uint32_t               TSensorCountdown;
+static uint32_t               TSensorDecimation;
+static uint32_t               TSensorAccCount;
+static int32_t                TSensorAccSum;
+static uint32_t               TSensorHistoryHead;  /* Next entry written */
+static uint32_t               TSensorHistoryCount;
+static I2C_TransactionTypeDef TSensorAlertXfer;
+static I2C_TransactionTypeDef TSensorSampleXfer;
+static uint8_t                TSensorAlertData[2];
+static uint8_t                TSensorSampleData[2];
+static int16_t                TSensorHistory[TSENSOR_HISTORY_SIZE];
+static TSENSOR_StatsTypeDef   TSensorStats;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_TSENSOR_Private_Functions Private Functions
+  * @{
+  */
+static void    TSENSOR_Submit(I2C_TransactionTypeDef* pXfer, uint8_t* pData, uint8_t Priority,
+                              void (*Callback)(I2C_TransactionTypeDef* pXfer));
+static int16_t TSENSOR_Q8(const uint8_t* pData);
+static void    TSENSOR_AlertDone(I2C_TransactionTypeDef* pXfer);
+static void    TSENSOR_SampleDone(I2C_TransactionTypeDef* pXfer);
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_TSENSOR_Exported_Functions
+  * @{
+  */
+
+/**
+  * @brief  Initializes peripherals used by the I2C temperature sensor driver.
+  * @note   Continuous conversion, OS output in interrupt mode between 23 and
+  *         24 degrees C. Stops the sampling service and clears its counters.
+  * @retval TSENSOR_OK (0) if the sensor answered, TSENSOR_ERROR otherwise
+  */
+uint32_t BSP_TSENSOR_Init(void)
+{
+  TSENSOR_InitTypeDef STLM75_InitStructure;
+
+  TSensorAlertCallback = NULL;
+  TSensorPeriod = 0;
+  memset(&TSensorStats, 0, sizeof(TSensorStats));
+  if (Stlm75Drv.IsReady(DISCOVERY_TSENSOR_I2C_ADDRESS_A01, TSENSOR_MAX_TRIALS) != HAL_OK)
+  {
+    tsensor_drv = NULL;
+    return TSENSOR_ERROR;
+  }
+  TSENSORAddr = DISCOVERY_TSENSOR_I2C_ADDRESS_A01;
+  tsensor_drv = &Stlm75Drv;
+
+  STLM75_InitStructure.AlertMode            = STLM75_INTERRUPT_MODE;
+  STLM75_InitStructure.ConversionMode       = STLM75_CONTINUOUS_MODE;
+  STLM75_InitStructure.TemperatureLimitHigh = 24;
+  STLM75_InitStructure.TemperatureLimitLow  = 23;
+  tsensor_drv->Init(TSENSORAddr, &STLM75_InitStructure);
+  return TSENSOR_OK;
+}
+
+/**
+  * @brief  Returns the configuration register of the sensor.
+  * @retval Configuration register, 0 if the sensor is not initialized
+  */
+uint8_t BSP_TSENSOR_ReadStatus(void)
+{
+  if (tsensor_drv == NULL)
+  {
+    return 0;
+  }
+  return (tsensor_drv->ReadStatus(TSENSORAddr));
+}
+
+/**
+  * @brief  Reads the temperature.
+  * @retval Temperature in degrees C, by steps of 0.5
+  */
+float BSP_TSENSOR_ReadTemp(void)
+{
+  uint16_t raw;
+  int16_t  halves;
+
+  if (tsensor_drv == NULL)
+  {
+    return 0.0f;
+  }
+  /* 9-bit two's complement: sign in bit 15, value in half degrees in bits 7:0 */
+  raw = tsensor_drv->ReadTemp(TSENSORAddr);
+  halves = (int16_t)(raw & 0x00FFU);
+  if ((raw & 0x8000U) != 0)
+  {
+    halves -= 256;
+  }
+  return ((float)halves / 2.0f);
+}
+
+/**
+  * @brief  Starts the alert service: the callback runs each time the
+  *         temperature goes above High, then below Low, and so on.
+  * @note   BSP_TSENSOR_Init() comes first. Blocks while the limits are
+  *         written.
+  * @param  High  high limit, in degrees C.
+  * @param  Low  low limit, in degrees C, below High.
+  * @param  Callback  called from the DMA interrupt with the temperature,
+  *         in 1/256 degree C, and 1 above High, 0 below Low.
+  * @retval TSENSOR_OK (0) if started, TSENSOR_ERROR otherwise
+  */
+uint32_t BSP_TSENSOR_AlertStart(int8_t High, int8_t Low, void (*Callback)(int16_t Temp, uint32_t Above))
+{
+  TSENSOR_InitTypeDef STLM75_InitStructure;
+
+  if ((tsensor_drv == NULL) || (Callback == NULL) || (High <= Low))
+  {
+    return TSENSOR_ERROR;
+  }
+  TSENSOR_IO_AlertConfig(0);
+  TSensorAlertCallback = Callback;
+  TSensorLow = (int16_t)(Low * TSENSOR_Q8_ONE_DEGREE);
+  TSensorAlertPending = 0;
+
+  STLM75_InitStructure.AlertMode            = STLM75_INTERRUPT_MODE | TSENSOR_FAULT_QUEUE;
+  STLM75_InitStructure.ConversionMode       = STLM75_CONTINUOUS_MODE;
+  STLM75_InitStructure.TemperatureLimitHigh = (uint8_t)High;
+  STLM75_InitStructure.TemperatureLimitLow  = (uint8_t)Low;
+  tsensor_drv->Init(TSENSORAddr, &STLM75_InitStructure);
+
+  TSENSOR_IO_AlertConfig(1);
+  return TSENSOR_OK;
+}
+
+/**
+  * @brief  Stops the alert service. The sensor keeps its limits.
+  * @retval None
+  */
+void BSP_TSENSOR_AlertStop(void)
+{
+  TSENSOR_IO_AlertConfig(0);
+  TSensorAlertCallback = NULL;
+  TSensorAlertPending = 0;
+}
+
+/**
+  * @brief  Reads the temperature after an OS edge: to be called from the OS
+  *         EXTI interrupt.
+  * @retval None
+  */
+void BSP_TSENSOR_AlertIRQHandler(void)
+{
+  if (TSensorAlertCallback == NULL)
+  {
+    return;
+  }
+  TSensorStats.Alerts++;
+  if (TSensorAlertXfer.Status == I2C_XFER_BUSY)
+  {
+    /* Read again when this one ends */
+    TSensorAlertPending = 1;
+    return;
+  }
+  TSENSOR_Submit(&TSensorAlertXfer, TSensorAlertData, I2C_PRIORITY_HIGH, TSENSOR_AlertDone);
+}
+
+/**
+  * @brief  Starts the periodic reads.
+  * @note   Empties the history.
+  * @param  Period  ms between reads, from 1.
+  * @param  Decimation  reads averaged into each history entry, from 1.
+  * @retval TSENSOR_OK (0) if started, TSENSOR_ERROR otherwise
+  */
+uint32_t BSP_TSENSOR_SampleStart(uint32_t Period, uint32_t Decimation)
+{
+  uint32_t primask;
+
+  if ((tsensor_drv == NULL) || (Period == 0) || (Decimation == 0) || (Decimation > 0xFFFFU))
+  {
+    return TSENSOR_ERROR;
+  }
+  primask = __get_PRIMASK();
+  __disable_irq();
+  TSensorDecimation = Decimation;
+  TSensorAccCount = 0;
+  TSensorAccSum = 0;
+  TSensorHistoryHead = 0;
+  TSensorHistoryCount = 0;
+  TSensorCountdown = Period;
+  TSensorPeriod = Period;
+  __set_PRIMASK(primask);
+  return TSENSOR_OK;
+}
+
+/**
+  * @brief  Stops the periodic reads. The history is kept.
+  * @retval None
+  */
+void BSP_TSENSOR_SampleStop(void)
+{
+  TSensorPeriod = 0;
+}
+
+/**
+  * @brief  Submits the periodic read when due, and the alert read after a
+  *         failed one.
+  * @note   Call every millisecond, from SysTick_Handler() after HAL_IncTick().
+  * @retval None
+  */
+void BSP_TSENSOR_TickHandler(void)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if ((TSensorAlertPending != 0) && (TSensorAlertXfer.Status != I2C_XFER_BUSY) && (TSensorAlertCallback != NULL))
+  {
+    /* The OS output stays active until the sensor is read */
+    TSensorAlertPending = 0;
+    TSENSOR_Submit(&TSensorAlertXfer, TSensorAlertData, I2C_PRIORITY_HIGH, TSENSOR_AlertDone);
+  }
+  if ((TSensorPeriod != 0) && (--TSensorCountdown == 0))
+  {
+    TSensorCountdown = TSensorPeriod;
+    if (TSensorSampleXfer.Status == I2C_XFER_BUSY)
+    {
+      TSensorStats.Skipped++;
+    }
+    else
+    {
+      TSensorStats.Reads++;
+      TSENSOR_Submit(&TSensorSampleXfer, TSensorSampleData, I2C_PRIORITY_NORMAL, TSENSOR_SampleDone);
+    }
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Takes the oldest history entries.
+  * @param  pBuffer  pointer to the buffer receiving them, in 1/256 degree C.
+  * @param  Max  size of the buffer, in entries.
+  * @retval Number of entries copied
+  */
+uint32_t BSP_TSENSOR_GetHistory(int16_t* pBuffer, uint32_t Max)
+{
+  uint32_t primask, index, count, i;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  count = (TSensorHistoryCount < Max) ? TSensorHistoryCount : Max;
+  index = (TSensorHistoryHead >= TSensorHistoryCount) ? (TSensorHistoryHead - TSensorHistoryCount) :
+          (TSensorHistoryHead + TSENSOR_HISTORY_SIZE - TSensorHistoryCount);
+  for (i = 0; i < count; i++)
+  {
+    pBuffer[i] = TSensorHistory[index];
+    if (++index == TSENSOR_HISTORY_SIZE)
+    {
+      index = 0;
+    }
+  }
+  TSensorHistoryCount -= count;
+  __set_PRIMASK(primask);
+  return count;
+}
+
+/**
+  * @brief  Returns the sampling service counters.
+  * @param  pStats  pointer to the structure to fill.
+  * @retval None
+  */
+void BSP_TSENSOR_GetStats(TSENSOR_StatsTypeDef* pStats)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *pStats = TSensorStats;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY_TSENSOR_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Submits a read of the temperature register.
+  * @param  pXfer  transaction, not pending.
+  * @param  pData  2-byte buffer.
+  * @param  Priority  I2C_PRIORITY_xxx.
+  * @param  Callback  completion callback.
+  * @retval None
+  */
+static void TSENSOR_Submit(I2C_TransactionTypeDef* pXfer, uint8_t* pData, uint8_t Priority,
+                           void (*Callback)(I2C_TransactionTypeDef* pXfer))
+{
+  memset(pXfer, 0, sizeof(I2C_TransactionTypeDef));
+  pXfer->DevAddress = TSENSORAddr;
+  pXfer->MemAddress = LM75_REG_TEMP;
+  pXfer->MemAddSize = I2C_MEMADD_SIZE_8BIT;
+  pXfer->Size       = 2;
+  pXfer->pBuffer    = pData;
+  pXfer->Priority   = Priority;
+  pXfer->Callback   = Callback;
+  if (BSP_I2C_Submit(pXfer) != I2C_XFER_OK)
+  {
+    TSensorStats.Errors++;
+  }
+}
+
+/**
+  * @brief  Temperature register to 1/256 degree C.
+  * @param  pData  register, MSB first.
+  * @retval Temperature
+  */
+static int16_t TSENSOR_Q8(const uint8_t* pData)
+{
+  /* 9-bit two's complement in bits 15:7, bits 6:0 undefined */
+  return (int16_t)(((uint16_t)pData[0] << 8) | (pData[1] & 0x80U));
+}
+
+/**
+  * @brief  End of the read that follows an OS edge, in interrupt context.
+  * @param  pXfer  transaction.
+  * @retval None
+  */
+static void TSENSOR_AlertDone(I2C_TransactionTypeDef* pXfer)
+{
+  int16_t temp;
+
+  if (pXfer->Status != I2C_XFER_OK)
+  {
+    /* Again from the next tick */
+    TSensorStats.Errors++;
+    TSensorAlertPending = 1;
+    return;
+  }
+  temp = TSENSOR_Q8(TSensorAlertData);
+  if (TSensorAlertCallback != NULL)
+  {
+    /* Above the high limit, or below the low one */
+    TSensorAlertCallback(temp, (temp > TSensorLow) ? 1U : 0U);
+  }
+  if ((TSensorAlertPending != 0) && (TSensorAlertCallback != NULL))
+  {
+    TSensorAlertPending = 0;
+    TSENSOR_Submit(&TSensorAlertXfer, TSensorAlertData, I2C_PRIORITY_HIGH, TSENSOR_AlertDone);
+  }
+}
+
+/**
+  * @brief  End of a periodic read, in interrupt context.
+  * @param  pXfer  transaction.
+  * @retval None
+  */
+static void TSENSOR_SampleDone(I2C_TransactionTypeDef* pXfer)
+{
+  int32_t entry;
+
+  if (TSensorPeriod == 0)
+  {
+    return;
+  }
+  if (pXfer->Status != I2C_XFER_OK)
+  {
+    TSensorStats.Errors++;
+    return;
+  }
+  TSensorAccSum += TSENSOR_Q8(TSensorSampleData);
+  if (++TSensorAccCount < TSensorDecimation)
+  {
+    return;
+  }
+  /* One division per entry */
+  entry = (TSensorDecimation == 1U) ? TSensorAccSum : (TSensorAccSum / (int32_t)TSensorDecimation);
+  TSensorAccSum = 0;
+  TSensorAccCount = 0;
+
+  TSensorHistory[TSensorHistoryHead] = (int16_t)entry;
+  if (++TSensorHistoryHead == TSENSOR_HISTORY_SIZE)
+  {
+    TSensorHistoryHead = 0;
+  }
+  if (TSensorHistoryCount == TSENSOR_HISTORY_SIZE)
+  {
+    TSensorStats.Overwritten++;
+  }
+  else
+  {
+    TSensorHistoryCount++;
+  }
+  TSensorStats.Entries++;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
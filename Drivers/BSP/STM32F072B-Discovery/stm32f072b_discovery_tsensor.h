@@ -0,0 +1,120 @@
+/**
+  ******************************************************************************
+  * @file    stm32f072b_discovery_tsensor.h
+  * @brief   This file contains all the functions prototypes for the
+  *          stm32f072b_discovery_tsensor.c temperature sensor driver.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32072B_DISCOVERY_TSENSOR_H
+#define __STM32072B_DISCOVERY_TSENSOR_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f072b_discovery.h"
+#include "stm32f072b_discovery_i2c.h"
+#include "../Components/stlm75/stlm75.h"
+
+/** @addtogroup BSP
+  * @{
+  */
+
+/** @addtogroup STM32F072B_DISCOVERY
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_TSENSOR STM32F072B_DISCOVERY TSENSOR
+  * @{
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_TSENSOR_Exported_Constants Exported Constants
+  * @{
+  */
+
+/* Maximum number of trials for the presence check of BSP_TSENSOR_Init() */
+#define TSENSOR_MAX_TRIALS           50
+
+#define TSENSOR_OK                   0
+#define TSENSOR_ERROR                1
+
+/* Conversions beyond a limit before the OS output changes */
+#ifndef TSENSOR_FAULT_QUEUE
+#define TSENSOR_FAULT_QUEUE          STLM75_FAULT_QUEUE_2
+#endif
+
+/* History entries kept for BSP_TSENSOR_GetHistory() */
+#ifndef TSENSOR_HISTORY_SIZE
+#define TSENSOR_HISTORY_SIZE         32U
+#endif
+
+/* Temperatures of the sampling service are in 1/256 degrees C, as laid out
+   in the temperature register: steps of 0.5 degree, finer after averaging */
+#define TSENSOR_Q8_ONE_DEGREE        256
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_TSENSOR_Exported_Types Exported Types
+  * @{
+  */
+typedef struct
+{
+  uint32_t Alerts;           /* OS interrupts taken */
+  uint32_t Reads;            /* Periodic reads submitted */
+  uint32_t Skipped;          /* Periods whose read was still pending */
+  uint32_t Errors;           /* Reads ended without data, alert or periodic */
+  uint32_t Entries;          /* History entries written */
+  uint32_t Overwritten;      /* History entries dropped unread */
+} TSENSOR_StatsTypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F072B_DISCOVERY_TSENSOR_Exported_Functions Exported Functions
+  * @{
+  */
+uint32_t BSP_TSENSOR_Init(void);
+uint8_t  BSP_TSENSOR_ReadStatus(void);
+float    BSP_TSENSOR_ReadTemp(void);
+
+/* Sampling service on the I2C transaction scheduler */
+uint32_t BSP_TSENSOR_AlertStart(int8_t High, int8_t Low, void (*Callback)(int16_t Temp, uint32_t Above));
+void     BSP_TSENSOR_AlertStop(void);
+void     BSP_TSENSOR_AlertIRQHandler(void);
+uint32_t BSP_TSENSOR_SampleStart(uint32_t Period, uint32_t Decimation);
+void     BSP_TSENSOR_SampleStop(void);
+void     BSP_TSENSOR_TickHandler(void);
+uint32_t BSP_TSENSOR_GetHistory(int16_t* pBuffer, uint32_t Max);
+void     BSP_TSENSOR_GetStats(TSENSOR_StatsTypeDef* pStats);
+
+/* Link functions for the OS output of the sensor */
+void     TSENSOR_IO_AlertConfig(uint32_t Enable);
+void     TSENSOR_IO_AlertCheck(void);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32072B_DISCOVERY_TSENSOR_H */
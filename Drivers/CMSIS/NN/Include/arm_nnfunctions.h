@@ -696,6 +696,37 @@ extern    "C"
                                           q7_t * pOut, 
                                           q15_t * vec_buffer);
 
+  /**
+   * @brief Q7 fully-connected layer function with packed 4-bit weights
+   * @param[in]       pV          pointer to input vector
+   * @param[in]       pM          pointer to packed weights
+   * @param[in]       pScale      pointer to the scale of each row
+   * @param[in]       pZero       pointer to the zero point of each row
+   * @param[in]       dim_vec     length of the vector
+   * @param[in]       num_of_rows number of rows in weight matrix
+   * @param[in]       bias_shift  amount of left-shift for bias
+   * @param[in]       out_shift   amount of right-shift for output
+   * @param[in]       bias        pointer to bias
+   * @param[in,out]   pOut        pointer to output vector
+   * @return     The function returns <code>ARM_MATH_SUCCESS</code>
+   *
+   * A weight q of row r stands for the q7 weight
+   * (q - pZero[r]) * pScale[r] / 2^ARM_NN_Q4_SCALE_SHIFT.
+   */
+
+#define ARM_NN_Q4_SCALE_SHIFT 11
+
+    arm_status arm_fully_connected_q7_q4(const q7_t * pV,
+                                         const uint8_t * pM,
+                                         const uint16_t * pScale,
+                                         const uint8_t * pZero,
+                                         const uint16_t dim_vec,
+                                         const uint16_t num_of_rows,
+                                         const uint16_t bias_shift,
+                                         const uint16_t out_shift,
+                                         const q7_t * bias,
+                                         q7_t * pOut);
+
   /**
    * @brief Q15 basic fully-connected layer function
    * @param[in]       pV          pointer to input vector
@@ -84,11 +84,21 @@ void arm_nn_activations_direct_q15(q15_t * data, uint16_t size, uint16_t int_wid
         q15_t     out;
         q15_t     in = *pIn++;
         q15_t     frac = (uint32_t) in & bit_mask;
-        q15_t     value = lookup_table[__USAT(in >> shift_size, 8)];
-        q15_t     value2 = lookup_table[__USAT(1 + (in >> shift_size), 8)];
+        /* the table is indexed by the two's complement of the Q3.4 input:
+           saturating the index would send every negative input to entry 0 */
+        q15_t     value = lookup_table[(uint8_t)(in >> shift_size)];
 
-        /* doing the interpolation here for better accuracy */
-        out = ((q31_t) (full_frac - frac) * value + (q31_t) value2 * frac) >> shift_size;
+        if ((in >> shift_size) != 0x7f)
+        {
+            q15_t     value2 = lookup_table[(uint8_t)(1 + ((uint8_t)(in >> shift_size)))];
+
+            /* doing the interpolation here for better accuracy */
+            out = ((q31_t) (full_frac - frac) * value + (q31_t) value2 * frac) >> shift_size;
+        } else
+        {
+            /* the largest entry has no neighbour to interpolate with */
+            out = value;
+        }
 
         *pOut++ = out;
         i--;
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2010-2018 Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* ----------------------------------------------------------------------
+ * Project:      CMSIS NN Library
+ * Title:        arm_fully_connected_q7_q4.c
+ * Description:  Q7 fully-connected layer function with packed 4-bit weights
+ *
+ * Target Processor:  Cortex-M cores
+ *
+ * -------------------------------------------------------------------- */
+
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+
+/**
+ *  @ingroup groupNN
+ */
+
+/**
+ * @addtogroup FC
+ * @{
+ */
+
+/*
+ * Output of one row: the sum of pV * q less the zero point times the sum of
+ * pV, scaled in q7 weight units and requantized as arm_fully_connected_q7()
+ * does. The product with the scale is split at ARM_NN_Q4_SCALE_SHIFT so that
+ * it stays within 32 bits; the result is that of the 64-bit product,
+ * rounded to nearest.
+ */
+static q7_t arm_nn_q4_output(q31_t sum,
+                             q31_t sumV,
+                             const uint8_t zero,
+                             const uint16_t scale,
+                             const q7_t bias,
+                             const uint16_t bias_shift,
+                             const uint16_t out_shift)
+{
+    q31_t     acc = sum - (q31_t) zero * sumV;
+    q31_t     scaled = (acc >> ARM_NN_Q4_SCALE_SHIFT) * (q31_t) scale
+        + (q31_t) ((((uint32_t) acc & ((1U << ARM_NN_Q4_SCALE_SHIFT) - 1U)) * scale
+                    + (1U << (ARM_NN_Q4_SCALE_SHIFT - 1))) >> ARM_NN_Q4_SCALE_SHIFT);
+    q31_t     out = ((q31_t) bias << bias_shift) + NN_ROUND(out_shift) + scaled;
+
+    return (q7_t) __SSAT((out >> out_shift), 8);
+}
+
+  /**
+   * @brief Q7 fully-connected layer function with packed 4-bit weights
+   * @param[in]       pV          pointer to input vector
+   * @param[in]       pM          pointer to packed weights
+   * @param[in]       pScale      pointer to the scale of each row
+   * @param[in]       pZero       pointer to the zero point of each row
+   * @param[in]       dim_vec     length of the vector
+   * @param[in]       num_of_rows number of rows in weight matrix
+   * @param[in]       bias_shift  amount of left-shift for bias
+   * @param[in]       out_shift   amount of right-shift for output
+   * @param[in]       bias        pointer to bias
+   * @param[in,out]   pOut        pointer to output vector
+   * @return     The function returns <code>ARM_MATH_SUCCESS</code>
+   *
+   * @details
+   *
+   * <b>Buffer size:</b>
+   *
+   * none
+   *
+   * Weight w of row r stands for the q7 weight
+   * (q - pZero[r]) * pScale[r] / 2^ARM_NN_Q4_SCALE_SHIFT, q the unsigned
+   * 4-bit value stored: the output is that of arm_fully_connected_q7() on
+   * those weights, with the same bias_shift and out_shift.
+   *
+   * Each row takes (dim_vec + 1) / 2 bytes, columns 2k and 2k + 1 in the low
+   * and high nibble of byte k (the high nibble of the last byte unused when
+   * dim_vec is odd). The rows go by groups of 4, the last one of
+   * num_of_rows % 4 rows if that is not 0, and the rows of a group are
+   * interleaved byte by byte: with n rows in the group, byte k of its row i
+   * is at n * k + i. tools/nn_q4_pack.py converts q7 weights.
+   *
+   * The nibbles are taken apart in registers within the dot product; the
+   * zero points come in once per row, through the sum of the input vector.
+   * Every intermediate fits in 32 bits for dim_vec up to 32768.
+   */
+
+arm_status
+arm_fully_connected_q7_q4(const q7_t * pV,
+                          const uint8_t * pM,
+                          const uint16_t * pScale,
+                          const uint8_t * pZero,
+                          const uint16_t dim_vec,
+                          const uint16_t num_of_rows,
+                          const uint16_t bias_shift,
+                          const uint16_t out_shift, const q7_t * bias, q7_t * pOut)
+{
+    const uint8_t *pB = pM;
+    const q7_t *pA;
+    q7_t     *pO = pOut;
+    q31_t     sumV = 0;
+    uint16_t  rowCnt = num_of_rows >> 2;
+    uint16_t  colCnt;
+    uint16_t  i;
+
+    for (i = 0; i < dim_vec; i++)
+    {
+        sumV += pV[i];
+    }
+
+    while (rowCnt)
+    {
+        q31_t     sum = 0;
+        q31_t     sum2 = 0;
+        q31_t     sum3 = 0;
+        q31_t     sum4 = 0;
+
+        pA = pV;
+        colCnt = dim_vec >> 1;
+        while (colCnt)
+        {
+            q31_t     inA1 = *pA++;
+            q31_t     inA2 = *pA++;
+            uint8_t   inB;
+
+            inB = *pB++;
+            sum += inA1 * (inB & 0x0F) + inA2 * (inB >> 4);
+            inB = *pB++;
+            sum2 += inA1 * (inB & 0x0F) + inA2 * (inB >> 4);
+            inB = *pB++;
+            sum3 += inA1 * (inB & 0x0F) + inA2 * (inB >> 4);
+            inB = *pB++;
+            sum4 += inA1 * (inB & 0x0F) + inA2 * (inB >> 4);
+
+            colCnt--;
+        }
+        if (dim_vec & 0x1)
+        {
+            q31_t     inA1 = *pA;
+
+            sum += inA1 * (*pB++ & 0x0F);
+            sum2 += inA1 * (*pB++ & 0x0F);
+            sum3 += inA1 * (*pB++ & 0x0F);
+            sum4 += inA1 * (*pB++ & 0x0F);
+        }
+
+        *pO++ = arm_nn_q4_output(sum, sumV, *pZero++, *pScale++, *bias++, bias_shift, out_shift);
+        *pO++ = arm_nn_q4_output(sum2, sumV, *pZero++, *pScale++, *bias++, bias_shift, out_shift);
+        *pO++ = arm_nn_q4_output(sum3, sumV, *pZero++, *pScale++, *bias++, bias_shift, out_shift);
+        *pO++ = arm_nn_q4_output(sum4, sumV, *pZero++, *pScale++, *bias++, bias_shift, out_shift);
+
+        rowCnt--;
+    }
+
+    rowCnt = num_of_rows & 0x3;
+    if (rowCnt)
+    {
+        q31_t     sum[3] = { 0, 0, 0 };
+
+        pA = pV;
+        colCnt = dim_vec >> 1;
+        while (colCnt)
+        {
+            q31_t     inA1 = *pA++;
+            q31_t     inA2 = *pA++;
+
+            for (i = 0; i < rowCnt; i++)
+            {
+                uint8_t   inB = *pB++;
+
+                sum[i] += inA1 * (inB & 0x0F) + inA2 * (inB >> 4);
+            }
+
+            colCnt--;
+        }
+        if (dim_vec & 0x1)
+        {
+            for (i = 0; i < rowCnt; i++)
+            {
+                sum[i] += *pA * (*pB++ & 0x0F);
+            }
+        }
+
+        for (i = 0; i < rowCnt; i++)
+        {
+            *pO++ = arm_nn_q4_output(sum[i], sumV, *pZero++, *pScale++, *bias++, bias_shift, out_shift);
+        }
+    }
+
+    /* Return to ARM_MATH_SUCCESS */
+    return (ARM_MATH_SUCCESS);
+
+}
+
+/**
+ * @} end of FC group
+ */
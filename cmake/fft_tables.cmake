@@ -0,0 +1,53 @@
+find_package(Python3 COMPONENTS Interpreter)
+
+set(FFT_TABLES_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/../tools/fft_tables.py)
+
+# Only the CMSIS-DSP FFT tables a target uses, generated by tools/fft_tables.py
+# into <target>_<prefix>fft_tables.c, in place of arm_common_tables.c and
+# arm_const_structs.c (leave those out of the target):
+#   fft_tables(<target> LENGTHS <n>... TYPES <q15|q31|f32>...
+#              [RADIX] [RFFT] [SIN] [PREFIX <prefix> HEADER])
+# RADIX adds the init functions of the radix-2/radix-4 q15 and q31 kernels
+# (leave arm_cfft_radix*_init_q*.c out as well). RFFT adds those of the q15
+# and q31 real FFTs of twice each length, with their coefficient tables
+# (leave arm_rfft_init_q15.c and arm_rfft_init_q31.c out). SIN adds
+# sinTable_q15, for arm_sin_q15() and arm_cos_q15(). PREFIX and HEADER name
+# the symbols apart and declare them in <target>_<prefix>fft_tables.h, to
+# link beside the stock tables or another set.
+function(fft_tables target)
+    cmake_parse_arguments(FFT "RADIX;RFFT;SIN;HEADER" "PREFIX" "LENGTHS;TYPES" ${ARGN})
+    if (NOT Python3_Interpreter_FOUND)
+        message(FATAL_ERROR "Python3 not found, the FFT tables of ${target} cannot be generated")
+    endif()
+
+    set(base "${CMAKE_CURRENT_BINARY_DIR}/${target}_${FFT_PREFIX}fft_tables")
+    set(source "${base}.c")
+    set(outputs ${source})
+    set(args --lengths ${FFT_LENGTHS} --types ${FFT_TYPES} --output ${source})
+    if (FFT_RADIX)
+        list(APPEND args --radix)
+    endif()
+    if (FFT_RFFT)
+        list(APPEND args --rfft)
+    endif()
+    if (FFT_SIN)
+        list(APPEND args --sin)
+    endif()
+    if (FFT_PREFIX)
+        list(APPEND args --prefix ${FFT_PREFIX})
+    endif()
+    if (FFT_HEADER)
+        set(header "${base}.h")
+        list(APPEND outputs ${header})
+        list(APPEND args --header ${header})
+        target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+    endif()
+
+    add_custom_command(
+        OUTPUT ${outputs}
+        COMMAND ${Python3_EXECUTABLE} ${FFT_TABLES_SCRIPT} ${args}
+        DEPENDS ${FFT_TABLES_SCRIPT}
+        COMMENT "Generating ${FFT_PREFIX}FFT tables of ${target}"
+        VERBATIM)
+    target_sources(${target} PRIVATE ${outputs})
+endfunction()
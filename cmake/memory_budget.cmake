@@ -0,0 +1,27 @@
+find_package(Python3 COMPONENTS Interpreter)
+
+# Attribute the linked image's flash/RAM to subsystems from its map file and
+# fail the build when a budget in memory_budget.json is exceeded.
+function(memory_budget target)
+    set(map    "$<TARGET_FILE_DIR:${target}>/${target}.map")
+    set(report "${CMAKE_CURRENT_BINARY_DIR}/${target}.mem.json")
+    set(stamp  "${CMAKE_CURRENT_BINARY_DIR}/${target}.mem.stamp")
+    set(budget "${CMAKE_SOURCE_DIR}/cmake/memory_budget.json")
+
+    # One map file per image instead of the shared ${CMAKE_PROJECT_NAME}.map
+    target_link_options(${target} PRIVATE "-Wl,-Map=${map}")
+
+    if (Python3_Interpreter_FOUND)
+        add_custom_command(
+            OUTPUT ${stamp}
+            BYPRODUCTS ${report}
+            COMMAND ${Python3_EXECUTABLE} ${CMAKE_SOURCE_DIR}/tools/mem_budget.py ${map}
+                    --target ${target} --budget ${budget} --report ${report} --stamp ${stamp}
+            DEPENDS ${target} ${budget} ${CMAKE_SOURCE_DIR}/tools/mem_budget.py
+            COMMENT "Checking memory budget of ${target}"
+            VERBATIM)
+        add_custom_target(memory_budget_${target} ALL DEPENDS ${stamp})
+    else()
+        message(WARNING "Python3 not found, memory budget of ${target} is not checked")
+    endif()
+endfunction()
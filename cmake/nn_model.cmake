@@ -0,0 +1,51 @@
+find_package(Python3 COMPONENTS Interpreter)
+
+set(NN_MODEL_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/../tools/nn_model.py)
+# Imported by the script
+set(NN_MODEL_MODULES ${CMAKE_CURRENT_LIST_DIR}/../tools/nn_plan.py ${CMAKE_CURRENT_LIST_DIR}/../tools/nn_q4_pack.py)
+
+# Model image of a CMSIS-NN layer graph for stm32f072b_discovery_nnmodel.c,
+# converted by tools/nn_model.py from the graph and the C headers of its
+# weights and shifts, as <target>_<name>.nnm and as the C header
+# <target>_<name>_model.h: <NAME>_MODEL, the bytes of the image, with
+# <NAME>_MODEL_SIZE and <NAME>_MODEL_ARENA_SIZE:
+#   nn_model(<target> GRAPH <graph.json> HEADERS <weights.h>...
+#            [NAME <name>] [VARIANTS <layer>=<variant>...])
+# NAME defaults to the graph name. VARIANTS override the kernels of the
+# graph, e.g. ip1=q4.
+function(nn_model target)
+    cmake_parse_arguments(NN "" "GRAPH;NAME" "HEADERS;VARIANTS" ${ARGN})
+    if (NOT Python3_Interpreter_FOUND)
+        message(FATAL_ERROR "Python3 not found, the model of ${target} cannot be converted")
+    endif()
+
+    get_filename_component(graph ${NN_GRAPH} ABSOLUTE)
+    if (NN_NAME)
+        set(name ${NN_NAME})
+    else()
+        file(READ ${graph} graph_text)
+        string(JSON name GET ${graph_text} name)
+    endif()
+    string(TOUPPER ${name} prefix)
+    set(image "${CMAKE_CURRENT_BINARY_DIR}/${target}_${name}.nnm")
+    set(header "${CMAKE_CURRENT_BINARY_DIR}/${target}_${name}_model.h")
+    set(args ${graph} --output ${image} --c-header ${header} --prefix ${prefix}_MODEL)
+    set(sources)
+    foreach(path ${NN_HEADERS})
+        get_filename_component(path ${path} ABSOLUTE)
+        list(APPEND args --header ${path})
+        list(APPEND sources ${path})
+    endforeach()
+    foreach(variant ${NN_VARIANTS})
+        list(APPEND args --variant ${variant})
+    endforeach()
+
+    add_custom_command(
+        OUTPUT ${image} ${header}
+        COMMAND ${Python3_EXECUTABLE} ${NN_MODEL_SCRIPT} ${args}
+        DEPENDS ${NN_MODEL_SCRIPT} ${NN_MODEL_MODULES} ${graph} ${sources}
+        COMMENT "Converting the ${name} model of ${target}"
+        VERBATIM)
+    target_sources(${target} PRIVATE ${header})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endfunction()
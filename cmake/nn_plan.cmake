@@ -0,0 +1,41 @@
+find_package(Python3 COMPONENTS Interpreter)
+
+set(NN_PLAN_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/../tools/nn_plan.py)
+
+# Activation arena of a CMSIS-NN layer graph, planned by tools/nn_plan.py into
+# <target>_<graph name>_plan.h: the arena size and the offset and size of
+# every tensor and scratch buffer, as <PREFIX><NAME>_OFFSET/_SIZE:
+#   nn_plan(<target> GRAPH <graph.json> [PREFIX <prefix>] [ALIGN <bytes>]
+#           [LIMIT <bytes>])
+# PREFIX defaults to the graph name in capitals and _. LIMIT fails the build
+# when the arena exceeds it.
+function(nn_plan target)
+    cmake_parse_arguments(NN "" "GRAPH;PREFIX;ALIGN;LIMIT" "" ${ARGN})
+    if (NOT Python3_Interpreter_FOUND)
+        message(FATAL_ERROR "Python3 not found, the activation arena of ${target} cannot be planned")
+    endif()
+
+    get_filename_component(graph ${NN_GRAPH} ABSOLUTE)
+    file(READ ${graph} graph_text)
+    string(JSON name GET ${graph_text} name)
+    set(header "${CMAKE_CURRENT_BINARY_DIR}/${target}_${name}_plan.h")
+    set(args ${graph} --output ${header})
+    if (DEFINED NN_PREFIX)
+        list(APPEND args --prefix ${NN_PREFIX})
+    endif()
+    if (NN_ALIGN)
+        list(APPEND args --align ${NN_ALIGN})
+    endif()
+    if (NN_LIMIT)
+        list(APPEND args --limit ${NN_LIMIT})
+    endif()
+
+    add_custom_command(
+        OUTPUT ${header}
+        COMMAND ${Python3_EXECUTABLE} ${NN_PLAN_SCRIPT} ${args}
+        DEPENDS ${NN_PLAN_SCRIPT} ${graph}
+        COMMENT "Planning the ${name} activation arena of ${target}"
+        VERBATIM)
+    target_sources(${target} PRIVATE ${header})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endfunction()
@@ -0,0 +1,38 @@
+find_package(Python3 COMPONENTS Interpreter)
+
+set(NN_Q4_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/../tools/nn_q4_pack.py)
+
+# q7 fully connected weights packed in 4 bits by tools/nn_q4_pack.py for
+# arm_fully_connected_q7_q4(), into <target>_<name in lower case>_q4.h:
+# <PREFIX>, <PREFIX>_SCALE and <PREFIX>_ZERO, with <PREFIX>_DIM, _ROWS and
+# _SIZE (the bytes of <PREFIX>):
+#   nn_q4_pack(<target> HEADER <weights.h> NAME <macro> DIM <columns>
+#              ROWS <rows> [LAYOUT rows|opt] [PREFIX <prefix>])
+# LAYOUT opt reads the order of arm_fully_connected_q7_opt(). PREFIX defaults
+# to <NAME>_Q4.
+function(nn_q4_pack target)
+    cmake_parse_arguments(NN "" "HEADER;NAME;DIM;ROWS;LAYOUT;PREFIX" "" ${ARGN})
+    if (NOT Python3_Interpreter_FOUND)
+        message(FATAL_ERROR "Python3 not found, the weights of ${target} cannot be packed")
+    endif()
+
+    get_filename_component(source ${NN_HEADER} ABSOLUTE)
+    string(TOLOWER ${NN_NAME} name)
+    set(header "${CMAKE_CURRENT_BINARY_DIR}/${target}_${name}_q4.h")
+    set(args ${source} ${NN_NAME} --dim ${NN_DIM} --rows ${NN_ROWS} --output ${header})
+    if (NN_LAYOUT)
+        list(APPEND args --layout ${NN_LAYOUT})
+    endif()
+    if (NN_PREFIX)
+        list(APPEND args --prefix ${NN_PREFIX})
+    endif()
+
+    add_custom_command(
+        OUTPUT ${header}
+        COMMAND ${Python3_EXECUTABLE} ${NN_Q4_SCRIPT} ${args}
+        DEPENDS ${NN_Q4_SCRIPT} ${source}
+        COMMENT "Packing ${NN_NAME} of ${target} in 4 bits"
+        VERBATIM)
+    target_sources(${target} PRIVATE ${header})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endfunction()
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    dsp_bench.h
+  * @brief   Kernels, sweeps and entry points of the CMSIS-DSP benchmark image,
+  *          read by tools/dsp_bench.py from the ELF file: keep the layout of
+  *          BENCH_KernelTypeDef in step with the script.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_BENCH_H
+#define __DSP_BENCH_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "arm_math.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Largest point of each sweep, sizing the buffers */
+#define BENCH_TAPS_MAX             64U
+#define BENCH_STAGES_MAX           4U
+#define BENCH_BLOCK_MAX            256U
+#define BENCH_FFT_MAX              1024U
+/* Delay between two taps of arm_fir_sparse_q15(), in samples */
+#define BENCH_SPARSE_SPACING       4U
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  BENCH_FIR_Q15         = 0,
+  BENCH_FIR_Q15_C       = 1,
+  BENCH_FIR_FAST_Q15    = 2,
+  BENCH_CONV_OPT_Q15    = 3,
+  BENCH_FIR_SPARSE_Q15  = 4,
+  BENCH_BIQUAD_Q15      = 5,
+  BENCH_BIQUAD_Q15_C    = 6,
+  BENCH_CFFT_RADIX2_Q15 = 7,
+  BENCH_CFFT_RADIX4_Q15 = 8,
+  BENCH_CFFT_Q15        = 9,
+  BENCH_KERNELS         = 10
+} BENCH_KernelIdTypeDef;
+
+typedef enum
+{
+  BENCH_SWEEP_FIR    = 0,    /* BenchTaps x BenchBlocks */
+  BENCH_SWEEP_FFT    = 1,    /* BenchFftLengths */
+  BENCH_SWEEP_BIQUAD = 2     /* BenchStages x BenchBlocks */
+} BENCH_SweepTypeDef;
+
+typedef struct
+{
+  const char *Name;
+  void      (*Entry)(void);  /* Function timed, called by BENCH_Run() */
+  uint32_t    Sweep;         /* BENCH_SweepTypeDef */
+} BENCH_KernelTypeDef;
+
+/* Exported variables --------------------------------------------------------*/
+extern const BENCH_KernelTypeDef BenchKernels[BENCH_KERNELS];
+extern const uint16_t            BenchTaps[4];
+extern const uint16_t            BenchStages[3];
+extern const uint16_t            BenchBlocks[3];
+extern const uint16_t            BenchFftLengths[4];
+
+/* Exported functions ------------------------------------------------------- */
+/* Instance, state and input of Kernel for Param taps (stages, points) and Block
+   samples per call; 0 on success, -1 if out of the sweep */
+int32_t BENCH_Setup(uint32_t Kernel, uint32_t Param, uint32_t Block);
+/* One call of Kernel as set up last */
+void    BENCH_Run(uint32_t Kernel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_BENCH_H */
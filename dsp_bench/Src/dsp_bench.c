@@ -0,0 +1,295 @@
+/**
+  ******************************************************************************
+  * @file    dsp_bench.c
+  * @brief   CMSIS-DSP q15 filter and FFT kernels as built for the Cortex-M0,
+  *          set up and called one at a time for tools/dsp_bench.py:
+  *           - arm_fir_q15(), arm_fir_fast_q15(), arm_conv_opt_q15() and
+  *             arm_fir_sparse_q15() for every tap count of BenchTaps and
+  *             block size of BenchBlocks
+  *           - arm_biquad_cascade_df1_q15() for every stage count of
+  *             BenchStages and block size of BenchBlocks
+  *           - arm_cfft_radix2_q15(), arm_cfft_radix4_q15() and arm_cfft_q15()
+  *             for every length of BenchFftLengths, forward, bit reversed
+  *
+  ==============================================================================
+                          ##### Notes #####
+  ==============================================================================
+  *  The image is not meant for the board: the script runs it on the cycle
+  *  model of tools/m0_model.py after every build, calling BENCH_Setup() then
+  *  BENCH_Run() and counting the cycles of the kernel alone, from its first
+  *  instruction to its return. main() only idles; the linker keeps the two
+  *  entry points (--undefined in CMakeLists.txt).
+  *
+  *  Everything named Bench* belongs to the harness (input, output,
+  *  coefficients) and is left out of the footprint of the kernels. The
+  *  instances, states and scratch buffers below are the kernels' own: the
+  *  script counts the bytes of them each kernel writes. The q15 buffers are
+  *  word aligned, as the kernels reading two samples per word assume: a
+  *  HardFault in the table is an unaligned access of the kernel itself.
+  *
+  *  arm_conv_opt_q15() stands for a FIR filter through one convolution of
+  *  the block with the taps, without the overlap-add of successive blocks.
+  *  The sparse filter has its taps BENCH_SPARSE_SPACING samples apart.
+  *
+  *  arm_fir_q15() and arm_biquad_cascade_df1_q15() are the Thumb-1 kernels
+  *  of *_cm0.S; the C kernels they replace are built beside them with a _c
+  *  suffix (CMakeLists.txt) and timed on the same input. The biquad stages
+  *  are all the same low-pass, within the 32-bit accumulator bound of the
+  *  Thumb-1 kernel.
+  *
+  *  The FFT tables are generated for BenchFftLengths only
+  *  (cmake/fft_tables.cmake): the radix-2 and radix-4 kernels step through
+  *  the 1024-point ones.
+  ******************************************************************************
+  */
+#include "dsp_bench.h"
+#include "arm_const_structs.h"
+#include <stddef.h>
+
+/* Harness ------------------------------------------------------------------*/
+/* The C kernels of arm_fir_q15.c and arm_biquad_cascade_df1_q15.c */
+void arm_fir_q15_c(const arm_fir_instance_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+void arm_biquad_cascade_df1_q15_c(const arm_biquad_casd_df1_inst_q15 *S, q15_t *pSrc, q15_t *pDst,
+                                  uint32_t blockSize);
+
+typedef struct
+{
+  uint32_t Kernel;
+  uint32_t Param;
+  uint32_t Block;
+} BENCH_ConfigTypeDef;
+
+const BENCH_KernelTypeDef BenchKernels[BENCH_KERNELS] =
+{
+  { "arm_fir_q15",                   (void (*)(void))arm_fir_q15,                   BENCH_SWEEP_FIR },
+  { "arm_fir_q15_c",                 (void (*)(void))arm_fir_q15_c,                 BENCH_SWEEP_FIR },
+  { "arm_fir_fast_q15",              (void (*)(void))arm_fir_fast_q15,              BENCH_SWEEP_FIR },
+  { "arm_conv_opt_q15",              (void (*)(void))arm_conv_opt_q15,              BENCH_SWEEP_FIR },
+  { "arm_fir_sparse_q15",            (void (*)(void))arm_fir_sparse_q15,            BENCH_SWEEP_FIR },
+  { "arm_biquad_cascade_df1_q15",    (void (*)(void))arm_biquad_cascade_df1_q15,    BENCH_SWEEP_BIQUAD },
+  { "arm_biquad_cascade_df1_q15_c",  (void (*)(void))arm_biquad_cascade_df1_q15_c,  BENCH_SWEEP_BIQUAD },
+  { "arm_cfft_radix2_q15",           (void (*)(void))arm_cfft_radix2_q15,           BENCH_SWEEP_FFT },
+  { "arm_cfft_radix4_q15",           (void (*)(void))arm_cfft_radix4_q15,           BENCH_SWEEP_FFT },
+  { "arm_cfft_q15",                  (void (*)(void))arm_cfft_q15,                  BENCH_SWEEP_FFT },
+};
+
+const uint16_t BenchTaps[4]       = { 8U, 16U, 32U, 64U };
+const uint16_t BenchStages[3]     = { 1U, 2U, 4U };
+const uint16_t BenchBlocks[3]     = { 16U, 64U, 256U };
+const uint16_t BenchFftLengths[4] = { 16U, 64U, 256U, 1024U };
+
+static BENCH_ConfigTypeDef BenchConfig;
+/* Filter input, or complex FFT data in place */
+static q15_t BenchIn[2U * BENCH_FFT_MAX] __ALIGNED(4);
+/* Filter output, up to the full convolution */
+static q15_t BenchOut[BENCH_BLOCK_MAX + BENCH_TAPS_MAX - 1U] __ALIGNED(4);
+static q15_t BenchCoeffs[BENCH_TAPS_MAX] __ALIGNED(4);
+/* Butterworth low-pass at fs / 10, halved for postShift = 1 */
+static const q15_t BenchLowpass[6] = { 1106, 0, 2211, 1106, 18727, -6763 };
+static q15_t BenchBiquadCoeffs[6U * BENCH_STAGES_MAX] __ALIGNED(4);
+
+/* Kernels ------------------------------------------------------------------*/
+static arm_fir_instance_q15          FirQ15;
+static q15_t                         FirState[BENCH_TAPS_MAX + BENCH_BLOCK_MAX - 1U] __ALIGNED(4);
+
+static q15_t                         ConvScratch1[BENCH_BLOCK_MAX + 2U * BENCH_TAPS_MAX - 2U] __ALIGNED(4);
+static q15_t                         ConvScratch2[BENCH_TAPS_MAX] __ALIGNED(4);
+
+static arm_fir_sparse_instance_q15   FirSparseQ15;
+static q15_t                         SparseState[(BENCH_TAPS_MAX - 1U) * BENCH_SPARSE_SPACING + BENCH_BLOCK_MAX] __ALIGNED(4);
+static int32_t                       SparseTapDelay[BENCH_TAPS_MAX];
+static q15_t                         SparseScratchIn[BENCH_BLOCK_MAX] __ALIGNED(4);
+static q31_t                         SparseScratchOut[BENCH_BLOCK_MAX];
+
+static arm_biquad_casd_df1_inst_q15  BiquadQ15;
+static q15_t                         BiquadState[4U * BENCH_STAGES_MAX] __ALIGNED(4);
+
+static arm_cfft_radix2_instance_q15  CfftRadix2Q15;
+static arm_cfft_radix4_instance_q15  CfftRadix4Q15;
+static const arm_cfft_instance_q15  *pCfftQ15;
+
+/* Private functions ---------------------------------------------------------*/
+static const arm_cfft_instance_q15 *CfftQ15(uint32_t Length)
+{
+  switch (Length)
+  {
+  case 16U:
+    return &arm_cfft_sR_q15_len16;
+  case 64U:
+    return &arm_cfft_sR_q15_len64;
+  case 256U:
+    return &arm_cfft_sR_q15_len256;
+  case 1024U:
+    return &arm_cfft_sR_q15_len1024;
+  default:
+    return NULL;
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+int32_t BENCH_Setup(uint32_t Kernel, uint32_t Param, uint32_t Block)
+{
+  uint32_t seed = 0x2545F491U;
+  uint32_t i;
+
+  if (Kernel >= BENCH_KERNELS)
+  {
+    return -1;
+  }
+  switch (BenchKernels[Kernel].Sweep)
+  {
+  case BENCH_SWEEP_FIR:
+    if ((Param == 0U) || (Param > BENCH_TAPS_MAX) || (Block == 0U) || (Block > BENCH_BLOCK_MAX))
+    {
+      return -1;
+    }
+    break;
+
+  case BENCH_SWEEP_BIQUAD:
+    if ((Param == 0U) || (Param > BENCH_STAGES_MAX) || (Block == 0U) || (Block > BENCH_BLOCK_MAX))
+    {
+      return -1;
+    }
+    break;
+
+  default:
+    if (Param > BENCH_FFT_MAX)
+    {
+      return -1;
+    }
+    break;
+  }
+
+  /* White noise at -6 dBFS in, small taps: no saturation on the way */
+  for (i = 0U; i < 2U * BENCH_FFT_MAX; i++)
+  {
+    seed = seed * 1664525U + 1013904223U;
+    BenchIn[i] = (q15_t)((int32_t)seed >> 17);
+  }
+  for (i = 0U; i < BENCH_TAPS_MAX; i++)
+  {
+    seed = seed * 1664525U + 1013904223U;
+    BenchCoeffs[i] = (q15_t)((int32_t)seed >> 21);
+  }
+
+  switch (Kernel)
+  {
+  case BENCH_FIR_Q15:
+  case BENCH_FIR_Q15_C:
+  case BENCH_FIR_FAST_Q15:
+    if (arm_fir_init_q15(&FirQ15, (uint16_t)Param, BenchCoeffs, FirState, Block) != ARM_MATH_SUCCESS)
+    {
+      return -1;
+    }
+    break;
+
+  case BENCH_CONV_OPT_Q15:
+    break;
+
+  case BENCH_FIR_SPARSE_Q15:
+    for (i = 0U; i < Param; i++)
+    {
+      SparseTapDelay[i] = (int32_t)(i * BENCH_SPARSE_SPACING);
+    }
+    arm_fir_sparse_init_q15(&FirSparseQ15, (uint16_t)Param, BenchCoeffs, SparseState, SparseTapDelay,
+                            (uint16_t)((Param - 1U) * BENCH_SPARSE_SPACING), Block);
+    break;
+
+  case BENCH_BIQUAD_Q15:
+  case BENCH_BIQUAD_Q15_C:
+    for (i = 0U; i < 6U * Param; i++)
+    {
+      BenchBiquadCoeffs[i] = BenchLowpass[i % 6U];
+    }
+    arm_biquad_cascade_df1_init_q15(&BiquadQ15, (uint8_t)Param, BenchBiquadCoeffs, BiquadState, 1);
+    break;
+
+  case BENCH_CFFT_RADIX2_Q15:
+    if (arm_cfft_radix2_init_q15(&CfftRadix2Q15, (uint16_t)Param, 0U, 1U) != ARM_MATH_SUCCESS)
+    {
+      return -1;
+    }
+    break;
+
+  case BENCH_CFFT_RADIX4_Q15:
+    if (arm_cfft_radix4_init_q15(&CfftRadix4Q15, (uint16_t)Param, 0U, 1U) != ARM_MATH_SUCCESS)
+    {
+      return -1;
+    }
+    break;
+
+  default:
+    pCfftQ15 = CfftQ15(Param);
+    if (pCfftQ15 == NULL)
+    {
+      return -1;
+    }
+    break;
+  }
+
+  BenchConfig.Kernel = Kernel;
+  BenchConfig.Param = Param;
+  BenchConfig.Block = Block;
+  return 0;
+}
+
+void BENCH_Run(uint32_t Kernel)
+{
+  uint32_t block = BenchConfig.Block;
+
+  if (Kernel != BenchConfig.Kernel)
+  {
+    return;
+  }
+
+  switch (Kernel)
+  {
+  case BENCH_FIR_Q15:
+    arm_fir_q15(&FirQ15, BenchIn, BenchOut, block);
+    break;
+
+  case BENCH_FIR_Q15_C:
+    arm_fir_q15_c(&FirQ15, BenchIn, BenchOut, block);
+    break;
+
+  case BENCH_FIR_FAST_Q15:
+    arm_fir_fast_q15(&FirQ15, BenchIn, BenchOut, block);
+    break;
+
+  case BENCH_CONV_OPT_Q15:
+    arm_conv_opt_q15(BenchIn, block, BenchCoeffs, BenchConfig.Param, BenchOut, ConvScratch1, ConvScratch2);
+    break;
+
+  case BENCH_FIR_SPARSE_Q15:
+    arm_fir_sparse_q15(&FirSparseQ15, BenchIn, BenchOut, SparseScratchIn, SparseScratchOut, block);
+    break;
+
+  case BENCH_BIQUAD_Q15:
+    arm_biquad_cascade_df1_q15(&BiquadQ15, BenchIn, BenchOut, block);
+    break;
+
+  case BENCH_BIQUAD_Q15_C:
+    arm_biquad_cascade_df1_q15_c(&BiquadQ15, BenchIn, BenchOut, block);
+    break;
+
+  case BENCH_CFFT_RADIX2_Q15:
+    arm_cfft_radix2_q15(&CfftRadix2Q15, BenchIn);
+    break;
+
+  case BENCH_CFFT_RADIX4_Q15:
+    arm_cfft_radix4_q15(&CfftRadix4Q15, BenchIn);
+    break;
+
+  default:
+    arm_cfft_q15(pCfftQ15, BenchIn, 0U, 1U);
+    break;
+  }
+}
+
+int main(void)
+{
+  for (;;)
+  {
+    __WFI();
+  }
+}
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file    adc_sim.h
+  * @brief   ADC, TIM3 trigger and circular DMA model behind the SAMPLER_IO_*
+  *          link layer.
+  ******************************************************************************
+  */
+#ifndef __ADC_SIM_H
+#define __ADC_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* TIM3 clock, PCLK with the APB prescaler at 1 */
+#define ADC_SIM_PCLK_HZ          48000000U
+/* CPU time of the DMA interrupt entry, HAL_DMA_IRQHandler() and the HAL ADC
+   callback, in us */
+#define ADC_SIM_DMA_ISR_US       3U
+
+typedef struct
+{
+  uint32_t Blocks;           /* Half and complete transfer interrupts taken */
+  uint64_t Conversions;      /* Samples written by the DMA */
+  uint64_t MaxDispatch;      /* Longest wait of a transfer interrupt, in us */
+} ADC_SimStatsTypeDef;
+
+/* Stopped, mid-scale input */
+void     ADC_Sim_Reset(void);
+void     ADC_Sim_GetStats(ADC_SimStatsTypeDef *pStats);
+
+/* 12-bit counts converted in turn, from the first again after the last.
+   The array must remain valid while converting. */
+void     ADC_Sim_SetInput(const uint16_t *pCounts, uint32_t Count);
+/* Reads the input from a file: 16-bit PCM WAV (first channel, the 12 upper
+   bits of each sample), or text with one count, 0 to 4095, per line.
+   Returns the number of samples and the WAV rate in *pRate (0 for text),
+   0 on failure. */
+uint32_t ADC_Sim_LoadFile(const char *pPath, uint32_t *pRate);
+/* Input sample n, as set or loaded */
+uint16_t ADC_Sim_Input(uint64_t n);
+
+/* Rate TIM3 sets for SampleRate, as SAMPLER_IO_Start() returns it */
+uint32_t ADC_Sim_Rate(uint32_t SampleRate);
+/* Time, in us, of the last conversion of the block being handed over */
+uint64_t ADC_Sim_BlockTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ADC_SIM_H */
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file    core_cm0.h
+  * @brief   Host stand-in for the CMSIS-Core Cortex-M0 header, as included by
+  *          arm_math.h: the intrinsics the CMSIS-DSP sources use, in C. The
+  *          interrupt masking functions come from stm32f0xx_hal.h (sim.c).
+  ******************************************************************************
+  */
+#ifndef __CORE_CM0_H_GENERIC
+#define __CORE_CM0_H_GENERIC
+
+#include <stdint.h>
+
+#ifndef __ASM
+#define __ASM                    __asm
+#endif
+#ifndef __INLINE
+#define __INLINE                 inline
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE          static inline
+#endif
+#ifndef __STATIC_FORCEINLINE
+#define __STATIC_FORCEINLINE     __attribute__((always_inline)) static inline
+#endif
+#ifndef __IO
+#define __IO                     volatile
+#endif
+
+#ifndef __DMB
+#define __DMB()                  __asm volatile ("" ::: "memory")
+#endif
+
+__STATIC_INLINE uint8_t __CLZ(uint32_t value)
+{
+  return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+__STATIC_INLINE int32_t __SSAT(int32_t val, uint32_t sat)
+{
+  const int32_t max = (int32_t)((1U << (sat - 1U)) - 1U);
+  const int32_t min = -1 - max;
+
+  return (val > max) ? max : ((val < min) ? min : val);
+}
+
+__STATIC_INLINE uint32_t __USAT(int32_t val, uint32_t sat)
+{
+  const uint32_t max = (1U << sat) - 1U;
+
+  return (val > (int32_t)max) ? max : ((val < 0) ? 0U : (uint32_t)val);
+}
+
+#endif /* __CORE_CM0_H_GENERIC */
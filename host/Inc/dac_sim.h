@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    dac_sim.h
+  * @brief   DAC, TIM6 trigger and circular DMA model behind the SYNTH_IO_*
+  *          link layer.
+  ******************************************************************************
+  */
+#ifndef __DAC_SIM_H
+#define __DAC_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* TIM6 clock, PCLK with the APB prescaler at 1 */
+#define DAC_SIM_PCLK_HZ          48000000U
+/* CPU time of the DMA interrupt entry, HAL_DMA_IRQHandler() and the HAL DAC
+   callback, in us */
+#define DAC_SIM_DMA_ISR_US       3U
+
+typedef struct
+{
+  uint32_t Blocks;           /* Half and complete transfer interrupts taken */
+  uint64_t Updates;          /* Samples read by the DMA */
+  uint64_t MaxDispatch;      /* Longest wait of a transfer interrupt, in us */
+} DAC_SimStatsTypeDef;
+
+/* Stopped, nothing captured */
+void     DAC_Sim_Reset(void);
+void     DAC_Sim_GetStats(DAC_SimStatsTypeDef *pStats);
+
+/* Keeps the first Max samples output, 12-bit, from the start; the array
+   must remain valid while running */
+void     DAC_Sim_SetCapture(uint16_t *pSamples, uint32_t Max);
+/* Samples kept so far */
+uint32_t DAC_Sim_Captured(void);
+
+/* Rate TIM6 sets for SampleRate, as SYNTH_IO_Init() returns it */
+uint32_t DAC_Sim_Rate(uint32_t SampleRate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC_SIM_H */
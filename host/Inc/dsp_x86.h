@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file    dsp_x86.h
+  * @brief   CMSIS-DSP on the host: choice between the portable C kernels, as
+  *          built for the Cortex-M0, and their SSE4.1 or AVX2 versions.
+  *
+  *          The functions below take the same arguments and give the same
+  *          results as the C path, bit for bit, except arm_dot_prod_f32()
+  *          which sums in several accumulators (within the 120 dB basic math
+  *          threshold of DSP_Lib_TestSuite):
+  *           - arm_fir_f32(), arm_fir_q15()
+  *           - arm_biquad_cascade_df1_f32(), stages in SIMD lanes: filters of
+  *             one or two stages stay on the C path
+  *           - arm_cfft_f32(), and arm_rfft_fast_f32() through it: lengths
+  *             below 64 stay on the C path
+  *           - arm_dot_prod_f32(), arm_dot_prod_q31(), arm_dot_prod_q15(),
+  *             arm_dot_prod_q7()
+  *           - arm_mat_mult_f32()
+  *          The best path the CPU supports is selected before main().
+  ******************************************************************************
+  */
+#ifndef __DSP_X86_H
+#define __DSP_X86_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include "arm_math.h"
+
+typedef enum
+{
+  DSP_X86_C     = 0,         /* Portable C, as for the Cortex-M0 */
+  DSP_X86_SSE41 = 1,         /* SSE4.1, 4 float lanes */
+  DSP_X86_AVX2  = 2          /* AVX2, 8 float lanes */
+} DSP_X86_PathTypeDef;
+
+#define DSP_X86_PATHS            3U
+
+/* Best path supported by the CPU (and built: C only on other hosts) */
+DSP_X86_PathTypeDef DSP_X86_Best(void);
+/* Path used by the functions above; 0 on success, -1 if not supported */
+int                 DSP_X86_Select(DSP_X86_PathTypeDef Path);
+DSP_X86_PathTypeDef DSP_X86_Current(void);
+const char         *DSP_X86_Name(DSP_X86_PathTypeDef Path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_X86_H */
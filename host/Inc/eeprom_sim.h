@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file    eeprom_sim.h
+  * @brief   M24LR64 I2C EEPROM model behind the BSP EEPROM_IO_* link layer.
+  ******************************************************************************
+  */
+#ifndef __EEPROM_SIM_H
+#define __EEPROM_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define EEPROM_SIM_SIZE          0x2000U
+#define EEPROM_SIM_PAGESIZE      4U
+/* Self-timed write cycle (tW, datasheet maximum) */
+#define EEPROM_SIM_TW_US         5000U
+/* 100 kHz bus: 9 clocks per byte including ACK */
+#define EEPROM_SIM_BYTE_US       90U
+
+typedef struct
+{
+  uint32_t WriteCycles;      /* Page programming cycles */
+  uint32_t BytesWritten;     /* Data bytes received by the array */
+  uint32_t BytesRead;        /* Data bytes sent by the array */
+  uint32_t Nacks;            /* Transfers refused while programming */
+  uint32_t BusBusy;          /* Transfers refused while the bus was in use */
+  uint32_t MaxWear;          /* Most write cycles seen by one page */
+} EEPROM_SimStatsTypeDef;
+
+void     EEPROM_Sim_Reset(uint8_t fill);
+uint8_t *EEPROM_Sim_Memory(void);
+void     EEPROM_Sim_GetStats(EEPROM_SimStatsTypeDef *pStats);
+uint32_t EEPROM_Sim_PageWear(uint16_t MemAddress);
+
+/* File-backed image: 0 on success */
+int      EEPROM_Sim_Load(const char *path);
+int      EEPROM_Sim_Save(const char *path);
+
+/* Power failure: the page write after the next `programs` ones is torn (a
+   random subset of its bytes lands) and every later write is lost, until
+   EEPROM_Sim_PowerCycle(). The array content survives the power cycle. */
+void     EEPROM_Sim_PowerFail(uint32_t programs, uint32_t seed);
+uint32_t EEPROM_Sim_PowerLost(void);
+void     EEPROM_Sim_PowerCycle(void);
+
+/* Link busy: the read after the next `reads` ones is refused with HAL_BUSY,
+   as while the cache or the asynchronous API holds the EEPROM transfer.
+   EEPROM_Sim_ReadFaulted() tells whether it happened. */
+void     EEPROM_Sim_ReadFault(uint32_t reads);
+uint32_t EEPROM_Sim_ReadFaulted(void);
+
+/* Device side, for bus models that carry the transfers themselves: ready
+   (acknowledges its address) outside tW, page write latched at STOP */
+uint32_t EEPROM_Sim_DevReady(void);
+void     EEPROM_Sim_DevWrite(uint16_t MemAddress, const uint8_t *pData, uint32_t Size);
+void     EEPROM_Sim_DevRead(uint16_t MemAddress, uint8_t *pData, uint32_t Size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EEPROM_SIM_H */
@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    flash_sim.h
+  * @brief   STM32F072xB internal flash model behind HAL_FLASH_Program() and
+  *          HAL_FLASHEx_Erase().
+  ******************************************************************************
+  */
+#ifndef __FLASH_SIM_H
+#define __FLASH_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define FLASH_SIM_SIZE           0x20000U
+/* Half-word programming time and page erase time (datasheet maximum) */
+#define FLASH_SIM_PROGRAM_US     70U
+#define FLASH_SIM_ERASE_US       40000U
+
+typedef struct
+{
+  uint32_t HalfWords;        /* Half-words programmed */
+  uint32_t Erases;           /* Pages erased */
+  uint32_t Errors;           /* Refused operations: locked, not erased, range */
+  uint32_t MaxWear;          /* Most erases seen by one page */
+} FLASH_SimStatsTypeDef;
+
+/* Maps the array at FLASH_BASE, read-only to the program as on the chip,
+   erases it and clears the counters. */
+void     FLASH_Sim_Reset(void);
+void     FLASH_Sim_GetStats(FLASH_SimStatsTypeDef *pStats);
+
+/* Power failure: the half-word program or page erase after the next `ops`
+   ones is torn (some of its bits, or some of its words, change) and every
+   later operation is lost, until FLASH_Sim_PowerCycle(). The array content
+   survives the power cycle, which also locks the flash again. */
+void     FLASH_Sim_PowerFail(uint32_t ops, uint32_t seed);
+uint32_t FLASH_Sim_PowerLost(void);
+void     FLASH_Sim_PowerCycle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_SIM_H */
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file    gyro_sim.h
+  * @brief   L3GD20 gyroscope model on SPI2 behind the GYRO_IO_* link layer.
+  ******************************************************************************
+  */
+#ifndef __GYRO_SIM_H
+#define __GYRO_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Bus time of n bytes at 6 MHz (PCLK / 8), in us */
+#define GYRO_SIM_BUS_US(n)       ((((uint64_t)(n)) * 4U + 2U) / 3U)
+/* CPU time of a HAL_SPI_TransmitReceive()/HAL_SPI_Receive() call besides
+   its bytes, and of each byte polled by it, in us */
+#define GYRO_SIM_HAL_US          4U
+#define GYRO_SIM_POLL_BYTE_US    2U
+/* CPU time of a DMA start, of a DMA completion interrupt and of the EXTI
+   interrupt entry, in us */
+#define GYRO_SIM_DMA_START_US    10U
+#define GYRO_SIM_DMA_ISR_US      10U
+#define GYRO_SIM_EXTI_US         2U
+
+typedef struct
+{
+  uint32_t Samples;          /* Samples produced at the output data rate */
+  uint32_t Overwritten;      /* Samples replaced before they were read */
+  uint32_t Transfers;        /* Chip select cycles */
+  uint32_t DmaBursts;        /* DMA reads */
+  uint32_t Bytes;            /* Data bytes read */
+  uint64_t BusTime;          /* us the bus was in use */
+  uint32_t Collisions;       /* Blocking accesses during a DMA burst */
+  uint32_t Interrupts;       /* INT2 EXTI interrupts taken */
+} GYRO_SimStatsTypeDef;
+
+/* Power-on registers, no sample yet, EXTI line off. ByteReads selects the
+   former link layer, one HAL call per byte, for the blocking reads. */
+void     GYRO_Sim_Reset(uint32_t ByteReads);
+void     GYRO_Sim_GetStats(GYRO_SimStatsTypeDef *pStats);
+
+/* Sample number n reads X = n, Y = ~n, Z = 3 * n (16-bit) */
+void     GYRO_Sim_Sample(uint32_t n, int16_t *pXYZ);
+/* Output registers on sample n, data ready, as when just measured */
+void     GYRO_Sim_Hold(uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GYRO_SIM_H */
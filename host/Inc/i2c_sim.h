@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    i2c_sim.h
+  * @brief   I2C2 bus model behind the I2C_IO_* link layer of the transaction
+  *          scheduler, with the M24LR64 EEPROM and an STLM75 on it.
+  ******************************************************************************
+  */
+#ifndef __I2C_SIM_H
+#define __I2C_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define I2C_SIM_EEPROM_ADDRESS   0xA0U
+#define I2C_SIM_TSENSOR_ADDRESS  0x90U
+/* CPU time of a DMA start and of a completion interrupt, in us */
+#define I2C_SIM_ISR_US           10U
+/* Time I2C_IO_Probe() waits for a STOP before giving up, in us */
+#define I2C_SIM_PROBE_LIMIT_US   1000U
+/* STLM75 conversion period, and CPU time of the OS EXTI interrupt entry, in us */
+#define I2C_SIM_CONV_US          150000U
+#define I2C_SIM_EXTI_US          2U
+
+typedef struct
+{
+  uint32_t Transfers;        /* DMA transfers started */
+  uint32_t Bytes;            /* Data bytes carried */
+  uint64_t BusTime;          /* us the bus was in use */
+  uint32_t Nacks;            /* Transfers or probes not acknowledged */
+  uint32_t Probes;           /* Single addressing attempts */
+  uint32_t Faults;           /* Transfers ended by an injected bus error */
+  uint32_t Hangs;            /* Transfers or probes left without completion */
+  uint32_t Recoveries;       /* Bus resets */
+  uint32_t Conversions;      /* STLM75 conversions */
+  uint32_t OsEvents;         /* OS output activations */
+  uint32_t Interrupts;       /* OS EXTI interrupts taken */
+} I2C_SimStatsTypeDef;
+
+/* Idle bus, STLM75 registers at their power-on values (the EEPROM array is
+   reset with EEPROM_Sim_Reset()) */
+void     I2C_Sim_Reset(void);
+void     I2C_Sim_GetStats(I2C_SimStatsTypeDef *pStats);
+
+/* STLM75 temperature, in half degrees C, and raw register (MSB first) */
+void     I2C_Sim_SetTemp(int16_t Halves);
+uint16_t I2C_Sim_TsensorRegister(uint8_t Reg);
+
+/* From now on the STLM75 converts every I2C_SIM_CONV_US the temperature
+   Profile gives at that time (us), in 1/256 degree C, and drives its OS
+   output; NULL stops the conversions */
+void     I2C_Sim_TempProfile(int32_t (*Profile)(uint64_t Time));
+/* 1 while the OS output is active */
+uint32_t I2C_Sim_TsensorOS(void);
+
+/* Out of every 1000 transfers, ErrorRate end with a bus error halfway and
+   HangRate never complete */
+void     I2C_Sim_Faults(uint32_t ErrorRate, uint32_t HangRate, uint32_t Seed);
+/* SCL held low from the next probe on, until I2C_IO_Recover() */
+void     I2C_Sim_HangProbe(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __I2C_SIM_H */
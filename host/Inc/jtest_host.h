@@ -0,0 +1,36 @@
+/**
+  ******************************************************************************
+  * @file    jtest_host.h
+  * @brief   Host stand-in for the SysTick cycle counting of the JTest
+  *          framework (DSP_Lib_TestSuite/Common/JTest), included before every
+  *          test source (-include): JTEST_COUNT_CYCLES() times the function
+  *          under test with the host monotonic clock instead, and hands the
+  *          duration to the runner (dsp_lib_test.c).
+  *
+  *          Defining the include guard of jtest_cycle.h keeps that header,
+  *          and the device header it needs for SysTick, out of the build.
+  ******************************************************************************
+  */
+#ifndef __JTEST_HOST_H
+#define __JTEST_HOST_H
+
+#include <stdint.h>
+
+#define _JTEST_CYCLE_H_
+
+/* Monotonic time, ns */
+uint64_t JTEST_HOST_Now(void);
+/* One call of the current function under test, Duration ns */
+void     JTEST_HOST_Count(uint64_t Duration);
+
+#define JTEST_COUNT_CYCLES(fn_call)                                     \
+    do                                                                  \
+    {                                                                   \
+        uint64_t __jtest_host_start = JTEST_HOST_Now();                 \
+                                                                        \
+        fn_call;                                                        \
+                                                                        \
+        JTEST_HOST_Count(JTEST_HOST_Now() - __jtest_host_start);        \
+    } while (0)
+
+#endif /* __JTEST_HOST_H */
@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file    lcd_sim.h
+  * @brief   ST7735 or HX8347D display model on SPI1 behind the LCD_IO_* link
+  *          layer.
+  ******************************************************************************
+  */
+#ifndef __LCD_SIM_H
+#define __LCD_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define LCD_SIM_ST7735           0U
+#define LCD_SIM_HX8347D          1U
+
+/* Bus time of n bytes at 12 MHz (PCLK / 4), in us */
+#define LCD_SIM_BUS_US(n)        ((((uint64_t)(n)) * 2U + 2U) / 3U)
+/* CPU time of a blocking link call besides its bytes (chip select, data or
+   command line, HAL_SPI_Transmit() set up), in us */
+#define LCD_SIM_CALL_US          2U
+/* CPU time of a DMA start and of a DMA completion interrupt, in us */
+#define LCD_SIM_DMA_START_US     10U
+#define LCD_SIM_DMA_ISR_US       10U
+
+typedef struct
+{
+  uint32_t Commands;         /* Command bytes */
+  uint32_t DataBytes;        /* Parameter and pixel bytes */
+  uint32_t Pixels;           /* Pixels written to the display memory */
+  uint32_t Calls;            /* Blocking link calls */
+  uint32_t DmaTransfers;     /* DMA transfers */
+  uint64_t BusTime;          /* us the bus was in use */
+  uint64_t CpuTime;          /* us the link layer kept the CPU, waits excluded */
+  uint32_t Timeouts;         /* DMA waits that gave up */
+} LCD_SimStatsTypeDef;
+
+/* Link layer, as declared by the component drivers: the ST7735 and HX8347D
+   headers cannot be included together */
+void     LCD_IO_Init(void);
+void     LCD_IO_WriteReg(uint8_t Reg);
+void     LCD_IO_WriteMultipleData(uint8_t *pData, uint32_t Size);
+uint16_t LCD_IO_ReadData(uint16_t Reg);
+void     LCD_IO_WriteDataDMA(uint16_t *pData, uint32_t Count);
+void     LCD_IO_FillDataDMA(uint16_t RGBCode, uint32_t Count);
+void     LCD_IO_WaitDMA(void);
+void     LCD_Delay(uint32_t Delay);
+
+/* Power-on controller, display memory black */
+void     LCD_Sim_Reset(uint32_t Controller);
+/* Display memory black and statistics cleared, registers kept */
+void     LCD_Sim_Clear(void);
+void     LCD_Sim_GetStats(LCD_SimStatsTypeDef *pStats);
+
+/* Display memory as shown, RGB565, Width pixels per line */
+const uint16_t *LCD_Sim_Frame(uint16_t *pWidth, uint16_t *pHeight);
+/* Display memory as a binary PPM; 0 on success */
+int      LCD_Sim_WritePPM(const char *pPath);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LCD_SIM_H */
@@ -0,0 +1,39 @@
+/**
+  ******************************************************************************
+  * @file    sim.h
+  * @brief   Virtual time, interrupt and event model for the host builds.
+  ******************************************************************************
+  */
+#ifndef __SIM_H
+#define __SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* CPU cost of one HAL_GetTick() poll in a wait loop, in us */
+#define SIM_POLL_US        1U
+
+typedef void (*SIM_EventTypeDef)(void *arg);
+
+/* Runs fn on a stack mapped below 4 GB and returns its result. The BSP hands
+   buffer addresses to the link layer as uint32_t, so on a 64-bit host every
+   buffer must live in the low 4 GB: programs are linked without PIE for
+   their static data, and their stack data comes from here. */
+int      SIM_Main(int (*fn)(void));
+
+void     SIM_Reset(void);
+uint64_t SIM_Now(void);
+void     SIM_Advance(uint64_t us);
+void     SIM_Busy(uint64_t us);
+void     SIM_Schedule(uint64_t delay_us, SIM_EventTypeDef fn, void *arg);
+void     SIM_SetTickHook(void (*hook)(void));
+uint64_t SIM_SpinTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_H */
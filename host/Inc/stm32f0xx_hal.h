@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file    stm32f0xx_hal.h
+  * @brief   Host stand-in for the STM32F0xx HAL header.
+  *
+  *          Provides just enough of the HAL and CMSIS-Core surface for the BSP
+  *          and component drivers to compile natively. Time, interrupts and
+  *          peripherals are modelled by the simulator in sim.c.
+  ******************************************************************************
+  */
+#ifndef __STM32F0xx_HAL_H
+#define __STM32F0xx_HAL_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __IO      volatile
+#define __weak    __attribute__((weak))
+#define __STATIC_INLINE static inline
+
+#define HAL_I2C_MODULE_ENABLED
+#define HAL_FLASH_MODULE_ENABLED
+
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t          Instance;
+  __IO uint32_t     State;
+  __IO uint32_t     ErrorCode;
+} I2C_HandleTypeDef;
+
+#define I2C_MEMADD_SIZE_8BIT         (0x00000001U)
+#define I2C_MEMADD_SIZE_16BIT        (0x00000002U)
+
+/* Internal flash of the STM32F072xB, modelled by flash_sim.c */
+#define FLASH_BASE                   0x08000000UL
+#define FLASH_BANK1_END              0x0801FFFFUL
+#define FLASH_PAGE_SIZE              0x800U
+#define FLASH_TYPEPROGRAM_HALFWORD   (0x01U)
+#define FLASH_TYPEPROGRAM_WORD       (0x02U)
+#define FLASH_TYPEPROGRAM_DOUBLEWORD (0x03U)
+#define FLASH_TYPEERASE_PAGES        (0x00U)
+
+typedef struct
+{
+  uint32_t TypeErase;
+  uint32_t PageAddress;
+  uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+
+/* GPIO pins; the EXTI lines are raised by the peripheral models */
+#define GPIO_PIN_0                   ((uint16_t)0x0001U)
+#define GPIO_PIN_1                   ((uint16_t)0x0002U)
+#define GPIO_PIN_2                   ((uint16_t)0x0004U)
+#define GPIO_PIN_3                   ((uint16_t)0x0008U)
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+/* HAL time base, driven by the simulated SysTick */
+void     HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+void     HAL_Delay(uint32_t Delay);
+
+/* CMSIS-Core interrupt masking */
+uint32_t __get_PRIMASK(void);
+void     __set_PRIMASK(uint32_t priMask);
+void     __disable_irq(void);
+void     __enable_irq(void);
+
+/* CMSIS-Core memory barrier: one CPU, so only the compiler may reorder */
+#ifndef __DMB
+#define __DMB()   __asm volatile ("" ::: "memory")
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F0xx_HAL_H */
@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file    uart_sim.h
+  * @brief   USART3 and transmit DMA model behind the SPECTRUM_IO_* link
+  *          layer.
+  ******************************************************************************
+  */
+#ifndef __UART_SIM_H
+#define __UART_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* CPU time of the DMA and transmission complete interrupts, with the HAL
+   handlers, in us */
+#define UART_SIM_ISR_US          3U
+
+typedef struct
+{
+  uint32_t BaudRate;
+  uint32_t Frames;           /* Transmissions completed */
+  uint64_t Bytes;            /* Bytes on the line */
+  uint64_t BusyTime;         /* Time the line was sending, in us */
+} UART_SimStatsTypeDef;
+
+/* Idle line, nothing captured */
+void UART_Sim_Reset(void);
+void UART_Sim_GetStats(UART_SimStatsTypeDef *pStats);
+/* Writes every byte sent to pFile, NULL to stop */
+void UART_Sim_SetCapture(FILE *pFile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_SIM_H */
@@ -0,0 +1,340 @@
+/**
+  ******************************************************************************
+  * @file    adc_sim.c
+  * @brief   ADC, TIM3 trigger and circular DMA model behind the SAMPLER_IO_*
+  *          link layer.
+  *
+  *          Mirrors the sampler link section of stm32f072b_discovery.c:
+  *          SAMPLER_IO_Start() sets the TIM3 divider the same way, and every
+  *          timer period converts one input sample into the next halfword of
+  *          the circular buffer, left aligned. When a half of the buffer is
+  *          full the DMA interrupt runs as a simulator event and hands it to
+  *          SAMPLER_IO_HalfCpltCallback() or SAMPLER_IO_CpltCallback(); an
+  *          interrupt that falls due while another runs waits for it, as on
+  *          the NVIC, and the blocks of a half that complete meanwhile are
+  *          lost to the last of them. The samples of a half are written
+  *          when its interrupt is taken; SAMPLER_IO_GetPosition() follows
+  *          the conversions in time, so a chain still running when the DMA
+  *          comes back to its block sees the DMA there.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_sampler.h"
+#include "adc_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ADC_SIM_MIDSCALE     2048U
+
+static ADC_SimStatsTypeDef Stats;
+static uintptr_t           Generation;
+static const uint16_t     *pInput;
+static uint32_t            InputCount;
+static uint16_t           *pLoaded;
+static uint16_t           *pBuffer;
+static uint32_t            Length;
+static uint32_t            Period;         /* PCLK cycles per conversion */
+static uint64_t            StartTime;
+static uint64_t            NextBlock;      /* Blocks handed over since the start */
+static uint64_t            BlockTime;
+
+static void ADC_Sim_Transfer(void *arg);
+
+void ADC_Sim_Reset(void)
+{
+  memset(&Stats, 0, sizeof(Stats));
+  Generation++;
+  pInput = NULL;
+  InputCount = 0;
+  pBuffer = NULL;
+  Length = 0;
+}
+
+void ADC_Sim_GetStats(ADC_SimStatsTypeDef *pStats)
+{
+  *pStats = Stats;
+}
+
+void ADC_Sim_SetInput(const uint16_t *pCounts, uint32_t Count)
+{
+  pInput = pCounts;
+  InputCount = Count;
+}
+
+uint16_t ADC_Sim_Input(uint64_t n)
+{
+  return (InputCount != 0U) ? (uint16_t)(pInput[n % InputCount] & 0x0FFFU) : (uint16_t)ADC_SIM_MIDSCALE;
+}
+
+static uint32_t ADC_Sim_Le(const uint8_t *p, uint32_t Bytes)
+{
+  uint32_t v = 0;
+
+  while (Bytes-- != 0U)
+  {
+    v = (v << 8) | p[Bytes];
+  }
+  return v;
+}
+
+/* 16-bit PCM, first channel; 0 if not such a file */
+static uint32_t ADC_Sim_Wav(const uint8_t *pData, size_t Size, uint32_t *pRate)
+{
+  size_t   pos = 12;
+  uint32_t channels = 0, bits = 0, i, count;
+
+  while (pos + 8U <= Size)
+  {
+    uint32_t id = ADC_Sim_Le(&pData[pos], 4U);
+    uint32_t size = ADC_Sim_Le(&pData[pos + 4U], 4U);
+
+    pos += 8U;
+    if (size > Size - pos)
+    {
+      size = (uint32_t)(Size - pos);
+    }
+    if ((id == 0x20746D66U) && (size >= 16U))              /* "fmt " */
+    {
+      if (ADC_Sim_Le(&pData[pos], 2U) != 1U)
+      {
+        return 0;
+      }
+      channels = ADC_Sim_Le(&pData[pos + 2U], 2U);
+      *pRate = ADC_Sim_Le(&pData[pos + 4U], 4U);
+      bits = ADC_Sim_Le(&pData[pos + 14U], 2U);
+    }
+    else if (id == 0x61746164U)                            /* "data" */
+    {
+      if ((bits != 16U) || (channels == 0U))
+      {
+        return 0;
+      }
+      count = size / (2U * channels);
+      pLoaded = malloc(count * sizeof(uint16_t) + 1U);
+      if (pLoaded == NULL)
+      {
+        return 0;
+      }
+      for (i = 0; i < count; i++)
+      {
+        int16_t s = (int16_t)ADC_Sim_Le(&pData[pos + 2U * channels * i], 2U);
+        pLoaded[i] = (uint16_t)(((int32_t)s + 32768) >> 4);
+      }
+      return count;
+    }
+    pos += size + (size & 1U);
+  }
+  return 0;
+}
+
+static uint32_t ADC_Sim_Text(const char *pText)
+{
+  uint32_t count = 0, lines = 1;
+  const char *p;
+  char *end;
+
+  for (p = pText; *p != '\0'; p++)
+  {
+    lines += (*p == '\n') ? 1U : 0U;
+  }
+  pLoaded = malloc(lines * sizeof(uint16_t));
+  if (pLoaded == NULL)
+  {
+    return 0;
+  }
+  for (p = pText; *p != '\0'; p++)
+  {
+    long v = strtol(p, &end, 10);
+
+    if (end == p)
+    {
+      if ((*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n'))
+      {
+        return 0;
+      }
+      continue;
+    }
+    if ((v < 0) || (v > 4095))
+    {
+      return 0;
+    }
+    pLoaded[count++] = (uint16_t)v;
+    /* Anything after the first field of the line is ignored */
+    p = strchr(end, '\n');
+    if (p == NULL)
+    {
+      break;
+    }
+  }
+  return count;
+}
+
+uint32_t ADC_Sim_LoadFile(const char *pPath, uint32_t *pRate)
+{
+  FILE    *f = fopen(pPath, "rb");
+  uint8_t *data;
+  long     size;
+  uint32_t count;
+
+  *pRate = 0;
+  if (f == NULL)
+  {
+    return 0;
+  }
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  rewind(f);
+  data = malloc((size_t)size + 1U);
+  if ((size <= 0) || (data == NULL) || (fread(data, 1, (size_t)size, f) != (size_t)size))
+  {
+    fclose(f);
+    free(data);
+    return 0;
+  }
+  fclose(f);
+  data[size] = 0;
+
+  free(pLoaded);
+  pLoaded = NULL;
+  if ((size >= 12) && (memcmp(data, "RIFF", 4) == 0) && (memcmp(&data[8], "WAVE", 4) == 0))
+  {
+    count = ADC_Sim_Wav(data, (size_t)size, pRate);
+  }
+  else
+  {
+    count = ADC_Sim_Text((const char *)data);
+  }
+  free(data);
+  if (count != 0U)
+  {
+    ADC_Sim_SetInput(pLoaded, count);
+  }
+  return count;
+}
+
+/* TIM3 prescaler and period as ADCx_TimerInit() sets them */
+static uint32_t ADC_Sim_Period(uint32_t SampleRate)
+{
+  uint32_t divider = (ADC_SIM_PCLK_HZ + SampleRate / 2U) / SampleRate;
+  uint32_t prescaler;
+
+  if (divider < 2U)
+  {
+    return 0;
+  }
+  prescaler = (divider - 1U) / 65536U;
+  return (prescaler + 1U) * (divider / (prescaler + 1U));
+}
+
+uint32_t ADC_Sim_Rate(uint32_t SampleRate)
+{
+  uint32_t period = (SampleRate != 0U) ? ADC_Sim_Period(SampleRate) : 0U;
+
+  return (period != 0U) ? ADC_SIM_PCLK_HZ / period : 0U;
+}
+
+uint64_t ADC_Sim_BlockTime(void)
+{
+  return BlockTime;
+}
+
+/* Time, in us, at which the conversions done since the start reach n */
+static uint64_t ADC_Sim_TimeOf(uint64_t n)
+{
+  return StartTime + (n * Period + (ADC_SIM_PCLK_HZ / 1000000U) - 1U) / (ADC_SIM_PCLK_HZ / 1000000U);
+}
+
+/* Runs the DMA interrupt once the conversions done reach n */
+static void ADC_Sim_Schedule(uint64_t n, void *arg)
+{
+  uint64_t due = ADC_Sim_TimeOf(n);
+
+  SIM_Schedule((due > SIM_Now()) ? (due - SIM_Now()) : 0U, ADC_Sim_Transfer, arg);
+}
+
+static void ADC_Sim_Transfer(void *arg)
+{
+  uint64_t block, done, first, due;
+  uint32_t half, i;
+
+  if ((uintptr_t)arg != Generation)
+  {
+    return;
+  }
+  /* One pending flag per half: the blocks of this half converted while it
+     waited merge into one interrupt, for the last of them */
+  done = (SIM_Now() - StartTime) * (ADC_SIM_PCLK_HZ / 1000000U) / Period / (Length / 2U);
+  block = NextBlock;
+  if (done > block + 2U)
+  {
+    block += 2U * ((done - 1U - block) / 2U);
+  }
+  NextBlock = block + 1U;
+  half = (uint32_t)(block & 1U);
+  first = block * (Length / 2U);
+  due = ADC_Sim_TimeOf(first + Length / 2U);
+
+  /* The next interrupt falls due whatever happens to this one */
+  ADC_Sim_Schedule(first + Length, arg);
+
+  for (i = 0; i < Length / 2U; i++)
+  {
+    pBuffer[half * (Length / 2U) + i] = (uint16_t)(ADC_Sim_Input(first + i) << 4);
+  }
+  Stats.Blocks++;
+  Stats.Conversions += Length / 2U;
+  if (SIM_Now() - due > Stats.MaxDispatch)
+  {
+    Stats.MaxDispatch = SIM_Now() - due;
+  }
+  BlockTime = due;
+
+  SIM_Busy(ADC_SIM_DMA_ISR_US);
+  if (half == 0U)
+  {
+    SAMPLER_IO_HalfCpltCallback();
+  }
+  else
+  {
+    SAMPLER_IO_CpltCallback();
+  }
+}
+
+uint32_t SAMPLER_IO_Start(uint16_t *pBuf, uint32_t Len, uint32_t SampleRate)
+{
+  if ((pBuf == NULL) || (Len < 2U) || ((Len & 1U) != 0U) || (SampleRate == 0U))
+  {
+    return 0;
+  }
+  Period = ADC_Sim_Period(SampleRate);
+  if (Period == 0U)
+  {
+    return 0;
+  }
+  Generation++;
+  pBuffer = pBuf;
+  Length = Len;
+  StartTime = SIM_Now();
+  NextBlock = 0;
+  ADC_Sim_Schedule(Length / 2U, (void *)Generation);
+  return ADC_SIM_PCLK_HZ / Period;
+}
+
+void SAMPLER_IO_Stop(void)
+{
+  Generation++;
+  Length = 0;
+}
+
+uint32_t SAMPLER_IO_GetPosition(void)
+{
+  uint64_t done;
+
+  if (Length == 0U)
+  {
+    return 0;
+  }
+  done = (SIM_Now() - StartTime) * (ADC_SIM_PCLK_HZ / 1000000U) / Period;
+  return (uint32_t)(done % Length);
+}
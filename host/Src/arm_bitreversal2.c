@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    arm_bitreversal2.c
+  * @brief   Host version of Drivers/CMSIS/DSP/Source/TransformFunctions/
+  *          arm_bitreversal2.S, the Cortex-M0 code in C: the CFFT functions
+  *          call it for their bit reversal.
+  *
+  *          The tables (arm_common_tables.c) hold pairs of byte offsets of
+  *          the values to swap, for 32-bit data: 8-byte complex values for
+  *          arm_bitreversal_32(), 4-byte ones (offsets halved) for
+  *          arm_bitreversal_16().
+  ******************************************************************************
+  */
+#include <stdint.h>
+#include <string.h>
+
+void arm_bitreversal_32(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTab)
+{
+  uint32_t i, a, b, tmp;
+
+  for (i = 0; i < ((uint32_t)bitRevLen + 1U) / 2U; i++)
+  {
+    a = pBitRevTab[2U * i] >> 2;
+    b = pBitRevTab[2U * i + 1U] >> 2;
+    tmp = pSrc[a];
+    pSrc[a] = pSrc[b];
+    pSrc[b] = tmp;
+    tmp = pSrc[a + 1U];
+    pSrc[a + 1U] = pSrc[b + 1U];
+    pSrc[b + 1U] = tmp;
+  }
+}
+
+void arm_bitreversal_16(uint16_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTab)
+{
+  uint8_t *p = (uint8_t *)pSrc;
+  uint32_t i, a, b, tmp;
+
+  for (i = 0; i < ((uint32_t)bitRevLen + 1U) / 2U; i++)
+  {
+    a = pBitRevTab[2U * i] >> 1;
+    b = pBitRevTab[2U * i + 1U] >> 1;
+    memcpy(&tmp, p + a, 4);
+    memcpy(p + a, p + b, 4);
+    memcpy(p + b, &tmp, 4);
+  }
+}
@@ -0,0 +1,341 @@
+/**
+  ******************************************************************************
+  * @file    bench_adc_stream.c
+  * @brief   ADC to CMSIS-DSP sampling pipeline on the simulated ADC: block
+  *          latency, CPU load and the highest sample rate without overruns.
+  *
+  *          BSP_SAMPLER_Start() runs on adc_sim.c with several chains, from
+  *          the RMS value alone to a 64-tap decimation by 8. Each chain is
+  *          run at RATE_HZ, where the latency of every block is measured
+  *          from its last conversion to the end of the application callback,
+  *          then at rising rates until the DMA catches up with it: the
+  *          highest rate without an overrun is found by bisection, up to
+  *          the ADC limit SAMPLER_RATE_MAX.
+  *
+  *          The callback output is checked bit for bit, block by block,
+  *          against the same chain run apart on the same input; a mismatch,
+  *          an overrun at RATE_HZ, or no overrun above the highest rate
+  *          makes the program exit with status 1. The input is a tone with
+  *          an interferer above the decimated band and some noise, or the
+  *          file given as argument (see ADC_Sim_LoadFile()), looped.
+  *
+  *          No Cortex-M0 runs here: the chain is charged with the estimated
+  *          cycles of the ARM_MATH_CM0_FAMILY C code of its functions
+  *          (CYCLES_* below) at CPU_MHZ, in the application callback, which
+  *          ends the chain.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_sampler.h"
+#include "adc_sim.h"
+#include "sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define RATE_HZ             48000U
+#define RATE_MIN_HZ         1000U
+#define RUN_BLOCKS          64U
+#define SEARCH_BLOCKS       16U
+#define IDLE_STEP_US        10U
+#define INPUT_SAMPLES       4096U
+#define CPU_MHZ             48U
+
+/* Estimated Cortex-M0 cycles, calls, loads and stores included */
+#define CYCLES_CONVERT      5U         /* per sample: one XOR per two */
+#define CYCLES_DECIM_TAP    26U        /* q63 multiply-accumulate */
+#define CYCLES_DECIM_OUTPUT 40U        /* setup, saturation and store */
+#define CYCLES_DECIM_COPY   9U         /* per sample copied to the state */
+#define CYCLES_DECIM_CALL   60U
+#define CYCLES_RMS_SAMPLE   14U        /* q63 sum of squares */
+/* __aeabi_ldivmod, then arm_sqrt_q15(): soft-float and the loop of __CLZ */
+#define CYCLES_RMS_CALL     650U
+/* SAMPLER_Process(), the DMA position and the callback */
+#define CYCLES_CHAIN        80U
+
+typedef struct
+{
+  const char *Name;
+  uint16_t    BlockSize;
+  uint8_t     DecimFactor;
+  uint16_t    DecimTaps;
+} Bench_ChainTypeDef;
+
+typedef struct
+{
+  uint32_t Rate;
+  uint32_t Blocks;
+  uint32_t Overruns;
+  uint32_t Mismatches;
+  double   LatencyMean;
+  uint64_t LatencyMax;
+  double   Load;
+} Bench_ResultTypeDef;
+
+static const Bench_ChainTypeDef Chains[] =
+{
+  { "rms",          256U, 1U,  0U },
+  { "decim4x32",    256U, 4U, 32U },
+  { "decim4x32/64",  64U, 4U, 32U },
+  { "decim8x64",    256U, 8U, 64U },
+};
+
+static uint16_t                      Input[INPUT_SAMPLES];
+static q15_t                         Coeffs[SAMPLER_TAPS_MAX];
+static const Bench_ChainTypeDef     *pChain;
+static uint32_t                      ChainCycles;
+/* Reference chain, run on the same input in the callback */
+static arm_fir_decimate_instance_q15 RefDecim;
+static q15_t                         RefState[SAMPLER_TAPS_MAX + SAMPLER_BLOCK_MAX - 1U];
+static q15_t                         RefIn[SAMPLER_BLOCK_MAX];
+static q15_t                         RefOut[SAMPLER_BLOCK_MAX];
+static uint32_t                      Seen;
+static uint32_t                      Target;
+static uint32_t                      Mismatches;
+static uint64_t                      LatencySum;
+static uint64_t                      LatencyMax;
+
+/* Hamming-windowed sinc low-pass at 0.4 of the decimated rate, unity gain */
+static void Bench_Design(uint32_t Taps, uint32_t Factor)
+{
+  double   h[SAMPLER_TAPS_MAX], sum = 0.0, fc = 0.4 / Factor;
+  uint32_t i;
+
+  for (i = 0; i < Taps; i++)
+  {
+    double t = i - (Taps - 1U) / 2.0;
+    double w = 0.54 - 0.46 * cos(2.0 * M_PI * i / (Taps - 1U));
+
+    h[i] = ((t == 0.0) ? 2.0 * fc : sin(2.0 * M_PI * fc * t) / (M_PI * t)) * w;
+    sum += h[i];
+  }
+  for (i = 0; i < Taps; i++)
+  {
+    Coeffs[i] = (q15_t)lrint(32767.0 * h[i] / sum);
+  }
+}
+
+/* Estimated cycles of the chain on one block */
+static uint32_t Bench_Cycles(const Bench_ChainTypeDef *pC)
+{
+  uint32_t out = pC->BlockSize / pC->DecimFactor;
+  uint32_t cycles = CYCLES_CONVERT * pC->BlockSize + CYCLES_RMS_SAMPLE * out + CYCLES_RMS_CALL + CYCLES_CHAIN;
+
+  if (pC->DecimFactor > 1U)
+  {
+    cycles += (CYCLES_DECIM_TAP * pC->DecimTaps + CYCLES_DECIM_OUTPUT) * out +
+              CYCLES_DECIM_COPY * (pC->BlockSize + pC->DecimTaps - 1U) + CYCLES_DECIM_CALL;
+  }
+  return cycles;
+}
+
+static void Bench_Callback(const q15_t *pBlock, uint32_t Count, q15_t Rms)
+{
+  const q15_t *pRef = RefIn;
+  uint32_t     i, n = pChain->BlockSize;
+  uint64_t     latency;
+  q15_t        rms;
+
+  SIM_Busy((ChainCycles + CPU_MHZ - 1U) / CPU_MHZ);
+  latency = SIM_Now() - ADC_Sim_BlockTime();
+  LatencySum += latency;
+  LatencyMax = (latency > LatencyMax) ? latency : LatencyMax;
+
+  /* Block Seen, as converted: left aligned, offset binary */
+  for (i = 0; i < n; i++)
+  {
+    RefIn[i] = (q15_t)((ADC_Sim_Input((uint64_t)Seen * n + i) << 4) ^ 0x8000U);
+  }
+  if (pChain->DecimFactor > 1U)
+  {
+    arm_fir_decimate_q15(&RefDecim, RefIn, RefOut, n);
+    pRef = RefOut;
+    n /= pChain->DecimFactor;
+  }
+  arm_rms_q15((q15_t *)pRef, n, &rms);
+
+  /* Stopped from here: an overloaded chain leaves no time to the main loop */
+  if (++Seen == Target)
+  {
+    BSP_SAMPLER_Stop();
+  }
+
+  if ((Count != n) || (Rms != rms))
+  {
+    Mismatches++;
+    return;
+  }
+  for (i = 0; i < n; i++)
+  {
+    if (pBlock[i] != pRef[i])
+    {
+      Mismatches++;
+      return;
+    }
+  }
+}
+
+static int Bench_Run(const Bench_ChainTypeDef *pC, uint32_t Rate, uint32_t Blocks, Bench_ResultTypeDef *pResult)
+{
+  SAMPLER_ConfigTypeDef config;
+  SAMPLER_StatsTypeDef  stats;
+  uint64_t              start;
+
+  SIM_Reset();
+  pChain = pC;
+  ChainCycles = Bench_Cycles(pC);
+  Seen = 0;
+  Target = Blocks;
+  Mismatches = 0;
+  LatencySum = 0;
+  LatencyMax = 0;
+  if (pC->DecimFactor > 1U)
+  {
+    Bench_Design(pC->DecimTaps, pC->DecimFactor);
+    arm_fir_decimate_init_q15(&RefDecim, pC->DecimTaps, pC->DecimFactor, Coeffs, RefState, pC->BlockSize);
+  }
+
+  config.SampleRate = Rate;
+  config.BlockSize = pC->BlockSize;
+  config.DecimFactor = pC->DecimFactor;
+  config.DecimTaps = pC->DecimTaps;
+  config.pDecimCoeffs = Coeffs;
+  config.Callback = Bench_Callback;
+  if (BSP_SAMPLER_Start(&config) != SAMPLER_OK)
+  {
+    printf("%s: not started at %u Hz\n", pC->Name, (unsigned)Rate);
+    return 1;
+  }
+  start = SIM_Now();
+  while (Seen < Blocks)
+  {
+    SIM_Advance(IDLE_STEP_US);
+  }
+  BSP_SAMPLER_GetStats(&stats);
+
+  pResult->Rate = stats.SampleRate;
+  pResult->Blocks = stats.Blocks;
+  pResult->Overruns = stats.Overruns;
+  pResult->Mismatches = Mismatches;
+  pResult->LatencyMean = (double)LatencySum / Seen;
+  pResult->LatencyMax = LatencyMax;
+  pResult->Load = (double)SIM_SpinTime() / (double)(SIM_Now() - start);
+  return (stats.Errors != 0U) ? 1 : 0;
+}
+
+/* Highest rate without an overrun, to 0.5 % */
+static uint32_t Bench_MaxRate(const Bench_ChainTypeDef *pC, int *pFailed)
+{
+  Bench_ResultTypeDef result;
+  uint32_t lo = RATE_MIN_HZ, hi = SAMPLER_RATE_MAX, mid;
+
+  *pFailed |= Bench_Run(pC, hi, SEARCH_BLOCKS, &result);
+  if (result.Overruns == 0U)
+  {
+    return result.Rate;
+  }
+  while (hi - lo > lo / 200U)
+  {
+    mid = lo + (hi - lo) / 2U;
+    *pFailed |= Bench_Run(pC, mid, SEARCH_BLOCKS, &result);
+    if (result.Overruns == 0U)
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  /* The detection itself: overruns just above, none at the rate found */
+  *pFailed |= Bench_Run(pC, lo, RUN_BLOCKS, &result);
+  if (result.Overruns != 0U)
+  {
+    printf("%s: %u overruns at %u Hz\n", pC->Name, (unsigned)result.Overruns, (unsigned)result.Rate);
+    *pFailed = 1;
+  }
+  *pFailed |= Bench_Run(pC, (hi + hi / 50U < SAMPLER_RATE_MAX) ? hi + hi / 50U : SAMPLER_RATE_MAX, RUN_BLOCKS, &result);
+  if (result.Overruns == 0U)
+  {
+    printf("%s: no overrun at %u Hz\n", pC->Name, (unsigned)result.Rate);
+    *pFailed = 1;
+  }
+  return ADC_Sim_Rate(lo);
+}
+
+static void Bench_Synthetic(void)
+{
+  uint32_t seed = 0x2545F491U, i;
+
+  /* A tone every 64 samples, an interferer at 0.4 of the rate, noise */
+  for (i = 0; i < INPUT_SAMPLES; i++)
+  {
+    double v = 2048.0 + 1400.0 * sin(2.0 * M_PI * i / 64.0) + 300.0 * sin(2.0 * M_PI * 0.4 * i);
+
+    seed = seed * 1664525U + 1013904223U;
+    Input[i] = (uint16_t)lrint(v + (double)(seed >> 28) - 8.0);
+  }
+  ADC_Sim_SetInput(Input, INPUT_SAMPLES);
+}
+
+static char *Path;
+
+static int Bench_Main(void)
+{
+  Bench_ResultTypeDef result;
+  uint32_t count = INPUT_SAMPLES, rate = RATE_HZ, blocks, max;
+  size_t   c;
+  int      failed = 0;
+
+  ADC_Sim_Reset();
+  if (Path != NULL)
+  {
+    count = ADC_Sim_LoadFile(Path, &rate);
+    if (count == 0U)
+    {
+      printf("%s: not a 16-bit PCM WAV file or a list of 12-bit counts\n", Path);
+      return 2;
+    }
+    if ((rate == 0U) || (rate > SAMPLER_RATE_MAX))
+    {
+      rate = RATE_HZ;
+    }
+    printf("input %s: %u samples, run at %u Hz\n", Path, (unsigned)count, (unsigned)rate);
+  }
+  else
+  {
+    Bench_Synthetic();
+    printf("input synthetic: %u samples, run at %u Hz\n", (unsigned)count, (unsigned)rate);
+  }
+
+  printf("%-13s %5s %5s %4s  %7s  %9s %9s %7s  %14s  %s\n", "chain", "block", "decim", "taps", "cycles",
+         "latency", "max", "CPU", "max rate", "blocks checked");
+  for (c = 0; c < sizeof(Chains) / sizeof(Chains[0]); c++)
+  {
+    const Bench_ChainTypeDef *pC = &Chains[c];
+
+    /* The whole input once, at least RUN_BLOCKS blocks */
+    blocks = (count + pC->BlockSize - 1U) / pC->BlockSize;
+    blocks = (blocks < RUN_BLOCKS) ? RUN_BLOCKS : blocks;
+    failed |= Bench_Run(pC, rate, blocks, &result);
+    if ((result.Overruns != 0U) || (result.Mismatches != 0U))
+    {
+      printf("%s: %u overruns, %u blocks out of %u not as the reference chain\n", pC->Name,
+             (unsigned)result.Overruns, (unsigned)result.Mismatches, (unsigned)result.Blocks);
+      failed = 1;
+    }
+    max = Bench_MaxRate(pC, &failed);
+    printf("%-13s %5u %5u %4u  %7u  %6.0f us %6u us %6.2f%%  %s%8u Hz  %u\n", pC->Name, (unsigned)pC->BlockSize,
+           (unsigned)pC->DecimFactor, (unsigned)pC->DecimTaps, (unsigned)Bench_Cycles(pC), result.LatencyMean,
+           (unsigned)result.LatencyMax, 100.0 * result.Load, (max >= ADC_Sim_Rate(SAMPLER_RATE_MAX)) ? ">=" : "  ",
+           (unsigned)max, (unsigned)result.Blocks);
+  }
+  printf("latency: last conversion of a block to the end of its callback; CPU at %u MHz, DMA interrupt included\n",
+         CPU_MHZ);
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  Path = (argc > 1) ? argv[1] : NULL;
+  return SIM_Main(Bench_Main);
+}
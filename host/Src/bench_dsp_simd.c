@@ -0,0 +1,437 @@
+/**
+  ******************************************************************************
+  * @file    bench_dsp_simd.c
+  * @brief   CMSIS-DSP on the host: the SSE4.1 and AVX2 kernels of dsp_x86.h
+  *          against the portable C path, time per call and results.
+  *
+  *          Each kernel runs on the same inputs through every path the CPU
+  *          supports. The outputs of the C path are the reference: the SIMD
+  *          ones must be identical to them, arm_dot_prod_f32() aside, and
+  *          within the SNR threshold of DSP_Lib_TestSuite for the function
+  *          group and type (filtering, transform, basic math, matrix). A
+  *          mismatch makes the program exit with status 1.
+  *
+  *          The inputs are noise and tones from a fixed seed; block sizes
+  *          and lengths leave tails after the vector loops. The q15 dot
+  *          product inputs hold runs of -32768, the pair sum that overflows
+  *          _mm_madd_epi16().
+  ******************************************************************************
+  */
+#include "dsp_x86.h"
+#include "arm_const_structs.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* DSP_Lib_TestSuite thresholds, dB */
+#define SNR_FILTERING_F32   99.0
+#define SNR_FILTERING_Q15   60.0
+#define SNR_TRANSFORM_F32   90.0
+#define SNR_BASIC_F32       120.0
+#define SNR_BASIC_Q31       100.0
+#define SNR_BASIC_Q15       75.0
+#define SNR_BASIC_Q7        25.0
+#define SNR_MATRIX          120.0
+
+#define SIGNAL_LEN          4000U
+#define BLOCK               250U
+#define FIR_TAPS            63U
+#define BIQUAD_STAGES_MAX   8U
+#define DOT_LEN             1003U
+#define DOT_COUNT           64U
+#define MAT_ROWS            60U
+#define MAT_INNER           97U
+#define MAT_COLS            75U
+#define FFT_LEN_MAX         4096U
+
+#define OUT_MAX             (2U * 2U * FFT_LEN_MAX)
+#define TIME_MIN            0.05       /* s of calls per path */
+
+typedef struct
+{
+  const char *Name;
+  double      SnrMin;
+  uint32_t    Exact;                   /* identical to the C path */
+  uint32_t    Arg;
+  uint32_t  (*Run)(uint32_t Arg, double *pOut);   /* outputs written */
+} Bench_KernelTypeDef;
+
+static uint32_t Seed = 12345U;
+
+static float32_t SignalF32[SIGNAL_LEN], DotF32[2][DOT_COUNT * DOT_LEN];
+static q15_t     SignalQ15[SIGNAL_LEN], DotQ15[2][DOT_COUNT * DOT_LEN];
+static q31_t     DotQ31[2][DOT_COUNT * DOT_LEN];
+static q7_t      DotQ7[2][DOT_COUNT * DOT_LEN];
+static float32_t FirF32Coeffs[FIR_TAPS], FirF32State[FIR_TAPS + BLOCK - 1U];
+static q15_t     FirQ15Coeffs[FIR_TAPS], FirQ15State[FIR_TAPS + BLOCK - 1U];
+static float32_t BiquadCoeffs[5U * BIQUAD_STAGES_MAX], BiquadState[4U * BIQUAD_STAGES_MAX];
+static float32_t MatA[MAT_ROWS * MAT_INNER], MatB[MAT_INNER * MAT_COLS], MatC[MAT_ROWS * MAT_COLS];
+static float32_t FftIn[2U * FFT_LEN_MAX], FftBuf[2U * FFT_LEN_MAX];
+static float32_t BufF32[SIGNAL_LEN];
+static q15_t     BufQ15[SIGNAL_LEN];
+static double    Out[DSP_X86_PATHS][OUT_MAX];
+static double    Scratch[OUT_MAX];
+
+/* Uniform in [-1, 1) */
+static double Bench_Uniform(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return (Seed >> 8) / 8388608.0 - 1.0;
+}
+
+static double Bench_Seconds(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void Bench_Inputs(void)
+{
+  uint32_t i, k;
+  double   x, h, sum = 0;
+
+  for (i = 0; i < SIGNAL_LEN; i++)
+  {
+    x = 0.4 * sin(0.01 * i) + 0.2 * sin(0.37 * i) + 0.1 * Bench_Uniform();
+    SignalF32[i] = (float32_t)x;
+    SignalQ15[i] = (q15_t)floor(x * 32768.0);
+  }
+
+  /* Windowed sinc low-pass at a fifth of the sampling rate */
+  for (i = 0; i < FIR_TAPS; i++)
+  {
+    x = (double)i - (FIR_TAPS - 1U) / 2.0;
+    h = (x == 0) ? 0.4 : sin(0.4 * M_PI * x) / (M_PI * x);
+    h *= 0.54 - 0.46 * cos(2.0 * M_PI * i / (FIR_TAPS - 1U));
+    FirF32Coeffs[i] = (float32_t)h;
+    sum += h;
+  }
+  for (i = 0; i < FIR_TAPS; i++)
+  {
+    FirQ15Coeffs[i] = (q15_t)floor(FirF32Coeffs[i] / sum * 32767.0 + 0.5);
+  }
+
+  /* Low-pass sections, poles of radius 0.9 to 0.97, unity gain at DC;
+     a1 and a2 as CMSIS-DSP takes them, added */
+  for (k = 0; k < BIQUAD_STAGES_MAX; k++)
+  {
+    double r = 0.9 + 0.01 * k, theta = 0.05 + 0.04 * k;
+    double a1 = 2.0 * r * cos(theta), a2 = -r * r, b0 = (1.0 - a1 - a2) / 4.0;
+
+    BiquadCoeffs[5U * k] = (float32_t)b0;
+    BiquadCoeffs[5U * k + 1U] = (float32_t)(2.0 * b0);
+    BiquadCoeffs[5U * k + 2U] = (float32_t)b0;
+    BiquadCoeffs[5U * k + 3U] = (float32_t)a1;
+    BiquadCoeffs[5U * k + 4U] = (float32_t)a2;
+  }
+
+  for (k = 0; k < 2U; k++)
+  {
+    for (i = 0; i < DOT_COUNT * DOT_LEN; i++)
+    {
+      DotF32[k][i] = (float32_t)Bench_Uniform();
+      DotQ31[k][i] = (q31_t)(Bench_Uniform() * 2147483648.0);
+      DotQ15[k][i] = (q15_t)(Bench_Uniform() * 32768.0);
+      DotQ7[k][i] = (q7_t)(Bench_Uniform() * 128.0);
+      /* Full scale runs: -32768 * -32768 pairs in the q15 products */
+      if ((i % 97U) < 6U)
+      {
+        DotQ15[k][i] = -32768;
+        DotQ7[k][i] = -128;
+        DotQ31[k][i] = (q31_t)0x80000000;
+      }
+    }
+  }
+
+  for (i = 0; i < MAT_ROWS * MAT_INNER; i++)
+  {
+    MatA[i] = (float32_t)Bench_Uniform();
+  }
+  for (i = 0; i < MAT_INNER * MAT_COLS; i++)
+  {
+    MatB[i] = (float32_t)Bench_Uniform();
+  }
+  for (i = 0; i < 2U * FFT_LEN_MAX; i++)
+  {
+    FftIn[i] = (float32_t)(0.5 * sin(0.05 * i) + 0.25 * Bench_Uniform());
+  }
+}
+
+static uint32_t Bench_FirF32(uint32_t Arg, double *pOut)
+{
+  arm_fir_instance_f32 fir;
+  uint32_t i;
+
+  (void)Arg;
+  arm_fir_init_f32(&fir, FIR_TAPS, FirF32Coeffs, FirF32State, BLOCK);
+  for (i = 0; i < SIGNAL_LEN; i += BLOCK)
+  {
+    arm_fir_f32(&fir, SignalF32 + i, BufF32 + i, BLOCK);
+  }
+  for (i = 0; i < SIGNAL_LEN; i++)
+  {
+    pOut[i] = BufF32[i];
+  }
+  return SIGNAL_LEN;
+}
+
+static uint32_t Bench_FirQ15(uint32_t Arg, double *pOut)
+{
+  arm_fir_instance_q15 fir;
+  uint32_t i;
+
+  (void)Arg;
+  memset(FirQ15State, 0, sizeof(FirQ15State));
+  fir.numTaps = FIR_TAPS;
+  fir.pCoeffs = FirQ15Coeffs;
+  fir.pState = FirQ15State;
+  for (i = 0; i < SIGNAL_LEN; i += BLOCK)
+  {
+    arm_fir_q15(&fir, SignalQ15 + i, BufQ15 + i, BLOCK);
+  }
+  for (i = 0; i < SIGNAL_LEN; i++)
+  {
+    pOut[i] = BufQ15[i];
+  }
+  return SIGNAL_LEN;
+}
+
+/* Arg stages, in place */
+static uint32_t Bench_Biquad(uint32_t Arg, double *pOut)
+{
+  arm_biquad_casd_df1_inst_f32 iir;
+  uint32_t i;
+
+  arm_biquad_cascade_df1_init_f32(&iir, (uint8_t)Arg, BiquadCoeffs, BiquadState);
+  memcpy(BufF32, SignalF32, sizeof(BufF32));
+  for (i = 0; i < SIGNAL_LEN; i += BLOCK)
+  {
+    arm_biquad_cascade_df1_f32(&iir, BufF32 + i, BufF32 + i, BLOCK);
+  }
+  for (i = 0; i < SIGNAL_LEN; i++)
+  {
+    pOut[i] = BufF32[i];
+  }
+  return SIGNAL_LEN;
+}
+
+/* Forward transform of Arg points, then the inverse one of the result,
+   both bit reversed */
+static uint32_t Bench_Cfft(uint32_t Arg, double *pOut)
+{
+  const arm_cfft_instance_f32 *S;
+  uint32_t i;
+
+  switch (Arg)
+  {
+  case 16:   S = &arm_cfft_sR_f32_len16;   break;
+  case 32:   S = &arm_cfft_sR_f32_len32;   break;
+  case 64:   S = &arm_cfft_sR_f32_len64;   break;
+  case 128:  S = &arm_cfft_sR_f32_len128;  break;
+  case 256:  S = &arm_cfft_sR_f32_len256;  break;
+  case 512:  S = &arm_cfft_sR_f32_len512;  break;
+  case 1024: S = &arm_cfft_sR_f32_len1024; break;
+  case 2048: S = &arm_cfft_sR_f32_len2048; break;
+  default:   S = &arm_cfft_sR_f32_len4096; break;
+  }
+  memcpy(FftBuf, FftIn, 2U * Arg * sizeof(float32_t));
+  arm_cfft_f32(S, FftBuf, 0U, 1U);
+  for (i = 0; i < 2U * Arg; i++)
+  {
+    pOut[i] = FftBuf[i];
+  }
+  arm_cfft_f32(S, FftBuf, 1U, 1U);
+  for (i = 0; i < 2U * Arg; i++)
+  {
+    pOut[2U * Arg + i] = FftBuf[i];
+  }
+  return 4U * Arg;
+}
+
+static uint32_t Bench_DotF32(uint32_t Arg, double *pOut)
+{
+  float32_t r;
+  uint32_t  i;
+
+  (void)Arg;
+  for (i = 0; i < DOT_COUNT; i++)
+  {
+    arm_dot_prod_f32(DotF32[0] + i * DOT_LEN, DotF32[1] + i * DOT_LEN, DOT_LEN, &r);
+    pOut[i] = r;
+  }
+  return DOT_COUNT;
+}
+
+static uint32_t Bench_DotQ31(uint32_t Arg, double *pOut)
+{
+  q63_t    r;
+  uint32_t i;
+
+  (void)Arg;
+  for (i = 0; i < DOT_COUNT; i++)
+  {
+    arm_dot_prod_q31(DotQ31[0] + i * DOT_LEN, DotQ31[1] + i * DOT_LEN, DOT_LEN, &r);
+    pOut[i] = (double)r;
+  }
+  return DOT_COUNT;
+}
+
+static uint32_t Bench_DotQ15(uint32_t Arg, double *pOut)
+{
+  q63_t    r;
+  uint32_t i;
+
+  (void)Arg;
+  for (i = 0; i < DOT_COUNT; i++)
+  {
+    arm_dot_prod_q15(DotQ15[0] + i * DOT_LEN, DotQ15[1] + i * DOT_LEN, DOT_LEN, &r);
+    pOut[i] = (double)r;
+  }
+  return DOT_COUNT;
+}
+
+static uint32_t Bench_DotQ7(uint32_t Arg, double *pOut)
+{
+  q31_t    r;
+  uint32_t i;
+
+  (void)Arg;
+  for (i = 0; i < DOT_COUNT; i++)
+  {
+    arm_dot_prod_q7(DotQ7[0] + i * DOT_LEN, DotQ7[1] + i * DOT_LEN, DOT_LEN, &r);
+    pOut[i] = (double)r;
+  }
+  return DOT_COUNT;
+}
+
+static uint32_t Bench_MatMult(uint32_t Arg, double *pOut)
+{
+  arm_matrix_instance_f32 a, b, c;
+  uint32_t i;
+
+  (void)Arg;
+  arm_mat_init_f32(&a, MAT_ROWS, MAT_INNER, MatA);
+  arm_mat_init_f32(&b, MAT_INNER, MAT_COLS, MatB);
+  arm_mat_init_f32(&c, MAT_ROWS, MAT_COLS, MatC);
+  if (arm_mat_mult_f32(&a, &b, &c) != ARM_MATH_SUCCESS)
+  {
+    return 0;
+  }
+  for (i = 0; i < MAT_ROWS * MAT_COLS; i++)
+  {
+    pOut[i] = MatC[i];
+  }
+  return MAT_ROWS * MAT_COLS;
+}
+
+static const Bench_KernelTypeDef Kernels[] =
+{
+  { "fir_f32, 63 taps",           SNR_FILTERING_F32, 1, 0,    Bench_FirF32 },
+  { "fir_q15, 63 taps",           SNR_FILTERING_Q15, 1, 0,    Bench_FirQ15 },
+  { "biquad_df1_f32, 2 stages",   SNR_FILTERING_F32, 1, 2,    Bench_Biquad },
+  { "biquad_df1_f32, 4 stages",   SNR_FILTERING_F32, 1, 4,    Bench_Biquad },
+  { "biquad_df1_f32, 8 stages",   SNR_FILTERING_F32, 1, 8,    Bench_Biquad },
+  { "cfft_f32, 16",               SNR_TRANSFORM_F32, 1, 16,   Bench_Cfft },
+  { "cfft_f32, 32",               SNR_TRANSFORM_F32, 1, 32,   Bench_Cfft },
+  { "cfft_f32, 64",               SNR_TRANSFORM_F32, 1, 64,   Bench_Cfft },
+  { "cfft_f32, 128",              SNR_TRANSFORM_F32, 1, 128,  Bench_Cfft },
+  { "cfft_f32, 256",              SNR_TRANSFORM_F32, 1, 256,  Bench_Cfft },
+  { "cfft_f32, 512",              SNR_TRANSFORM_F32, 1, 512,  Bench_Cfft },
+  { "cfft_f32, 1024",             SNR_TRANSFORM_F32, 1, 1024, Bench_Cfft },
+  { "cfft_f32, 2048",             SNR_TRANSFORM_F32, 1, 2048, Bench_Cfft },
+  { "cfft_f32, 4096",             SNR_TRANSFORM_F32, 1, 4096, Bench_Cfft },
+  { "dot_prod_f32, 1003",         SNR_BASIC_F32,     0, 0,    Bench_DotF32 },
+  { "dot_prod_q31, 1003",         SNR_BASIC_Q31,     1, 0,    Bench_DotQ31 },
+  { "dot_prod_q15, 1003",         SNR_BASIC_Q15,     1, 0,    Bench_DotQ15 },
+  { "dot_prod_q7, 1003",          SNR_BASIC_Q7,      1, 0,    Bench_DotQ7 },
+  { "mat_mult_f32, 60x97 x 97x75", SNR_MATRIX,       1, 0,    Bench_MatMult },
+};
+
+/* Signal to error of pTest against pRef, dB; INFINITY when identical */
+static double Bench_Snr(const double *pRef, const double *pTest, uint32_t Size)
+{
+  double signal = 0, error = 0;
+  uint32_t i;
+
+  for (i = 0; i < Size; i++)
+  {
+    signal += pRef[i] * pRef[i];
+    error += (pRef[i] - pTest[i]) * (pRef[i] - pTest[i]);
+  }
+  return (error == 0) ? INFINITY : 10.0 * log10(signal / error);
+}
+
+static uint32_t Bench_Identical(const double *pRef, const double *pTest, uint32_t Size)
+{
+  uint32_t i;
+
+  for (i = 0; i < Size; i++)
+  {
+    if (pRef[i] != pTest[i])
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int main(void)
+{
+  DSP_X86_PathTypeDef best = DSP_X86_Best(), p;
+  const Bench_KernelTypeDef *k;
+  uint32_t size[DSP_X86_PATHS], calls, identical;
+  double   ns[DSP_X86_PATHS], t0, t, snr;
+  size_t   i;
+  int      failed = 0;
+
+  Bench_Inputs();
+  printf("Best path on this CPU: %s\n", DSP_X86_Name(best));
+  printf("%-28s %-7s %12s %8s  %s\n", "kernel", "path", "ns/call", "speedup", "against C");
+
+  for (i = 0; i < sizeof(Kernels) / sizeof(Kernels[0]); i++)
+  {
+    k = &Kernels[i];
+    for (p = DSP_X86_C; p <= best; p++)
+    {
+      DSP_X86_Select(p);
+      size[p] = k->Run(k->Arg, Out[p]);
+      calls = 0;
+      t0 = Bench_Seconds();
+      do
+      {
+        k->Run(k->Arg, Scratch);
+        calls++;
+        t = Bench_Seconds() - t0;
+      } while (t < TIME_MIN);
+      ns[p] = t * 1e9 / calls;
+
+      if (p == DSP_X86_C)
+      {
+        printf("%-28s %-7s %12.0f %8s  %s\n", k->Name, DSP_X86_Name(p), ns[p], "", (size[p] == 0) ? "error" : "reference");
+        failed |= (size[p] == 0);
+        continue;
+      }
+      identical = (size[p] == size[DSP_X86_C]) && Bench_Identical(Out[DSP_X86_C], Out[p], size[p]);
+      snr = Bench_Snr(Out[DSP_X86_C], Out[p], size[p]);
+      if (identical != 0)
+      {
+        printf("%-28s %-7s %12.0f %7.2fx  identical\n", k->Name, DSP_X86_Name(p), ns[p], ns[DSP_X86_C] / ns[p]);
+      }
+      else
+      {
+        printf("%-28s %-7s %12.0f %7.2fx  SNR %.1f dB (min %.0f)\n", k->Name, DSP_X86_Name(p), ns[p],
+               ns[DSP_X86_C] / ns[p], snr, k->SnrMin);
+      }
+      if ((size[p] != size[DSP_X86_C]) || ((k->Exact != 0) && (identical == 0)) || (snr < k->SnrMin))
+      {
+        printf("%s: %s results out of limits\n", k->Name, DSP_X86_Name(p));
+        failed = 1;
+      }
+    }
+  }
+  DSP_X86_Select(best);
+  return failed;
+}
@@ -0,0 +1,305 @@
+/**
+  ******************************************************************************
+  * @file    bench_eeprom_async.c
+  * @brief   Blocking versus asynchronous EEPROM transfers on the simulated
+  *          M24LR64: correctness, transfer time, and the CPU time left to
+  *          the application during a 4 KB write and read.
+  *
+  *          The blocking functions keep the caller until the data is
+  *          programmed. The asynchronous requests return at once; the
+  *          application then idles (as in __WFI()) and only the interrupt
+  *          handlers use the CPU: DMA completions and the ACK polls made by
+  *          BSP_EEPROM_AsyncTickHandler() from SysTick.
+  *
+  *          Every transfer is read back and compared. A blocking read and
+  *          write addressed to the EEPROM during its write cycle must fail
+  *          at once, without reaching the timeout. Any mismatch, error or
+  *          timeout makes the program exit with status 1.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_eeprom.h"
+#include "eeprom_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BLOCK_SIZE      4096U
+#define IDLE_STEP_US    10U
+
+static uint8_t   Data[BLOCK_SIZE];
+static uint8_t   Check[BLOCK_SIZE];
+static uint32_t  Timeouts;
+static uint32_t  Completions;
+static uint32_t  Order[4];
+static uint32_t  OrderCount;
+
+uint32_t BSP_EEPROM_TIMEOUT_UserCallback(void)
+{
+  Timeouts++;
+  return 0;
+}
+
+static void Bench_Fill(uint8_t *pBuffer, uint32_t Size, uint32_t Seed)
+{
+  uint32_t i;
+
+  for (i = 0; i < Size; i++)
+  {
+    Seed = Seed * 1664525U + 1013904223U;
+    pBuffer[i] = (uint8_t)(Seed >> 24);
+  }
+}
+
+static int Bench_Compare(const char *pWhat, uint16_t Addr, const uint8_t *pExpected, uint32_t Size)
+{
+  if (memcmp(EEPROM_Sim_Memory() + Addr, pExpected, Size) != 0)
+  {
+    printf("%s: EEPROM content differs\n", pWhat);
+    return 1;
+  }
+  return 0;
+}
+
+static void Bench_Done(EEPROM_RequestTypeDef *pRequest)
+{
+  Completions++;
+  if (OrderCount < 4U)
+  {
+    Order[OrderCount++] = (uint32_t)(uintptr_t)pRequest->pContext;
+  }
+}
+
+/* Idles until the request completes; returns the CPU time used meanwhile. */
+static uint64_t Bench_Wait(EEPROM_RequestTypeDef *pRequest)
+{
+  uint64_t busy = SIM_SpinTime();
+
+  while (BSP_EEPROM_AsyncStatus(pRequest) == EEPROM_BUSY)
+  {
+    SIM_Advance(IDLE_STEP_US);
+  }
+  return SIM_SpinTime() - busy;
+}
+
+static void Bench_Report(const char *pName, uint64_t Time, uint64_t Busy)
+{
+  printf("%-16s %8.1f ms  CPU busy %8.1f ms  idle %5.1f%%\n",
+         pName, Time / 1000.0, Busy / 1000.0, 100.0 * (double)(Time - Busy) / (double)Time);
+}
+
+static int Bench_Blocking(void)
+{
+  uint64_t start;
+  uint16_t count;
+  uint8_t  byte = 0x5A;
+  int      failed = 0;
+
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  BSP_EEPROM_Init();
+  Bench_Fill(Data, BLOCK_SIZE, 1);
+
+  /* The caller is held for the whole transfer: it is all CPU time */
+  start = SIM_Now();
+  if (BSP_EEPROM_WriteBuffer(Data, 0x0102, BLOCK_SIZE) != EEPROM_OK)
+  {
+    printf("blocking write failed\n");
+    failed = 1;
+  }
+  Bench_Report("blocking write", SIM_Now() - start, SIM_Now() - start);
+  failed |= Bench_Compare("blocking write", 0x0102, Data, BLOCK_SIZE);
+
+  start = SIM_Now();
+  count = BLOCK_SIZE;
+  memset(Check, 0, sizeof(Check));
+  if ((BSP_EEPROM_ReadBuffer(Check, 0x0102, &count) != EEPROM_OK) || (memcmp(Check, Data, BLOCK_SIZE) != 0))
+  {
+    printf("blocking read failed\n");
+    failed = 1;
+  }
+  Bench_Report("blocking read", SIM_Now() - start, SIM_Now() - start);
+
+  /* Single bytes go through the polling path of the link layer */
+  if (BSP_EEPROM_WriteBuffer(&byte, 0x1FFF, 1) != EEPROM_OK)
+  {
+    printf("blocking 1-byte write failed\n");
+    failed = 1;
+  }
+  count = 1;
+  byte = 0;
+  if ((BSP_EEPROM_ReadBuffer(&byte, 0x1FFF, &count) != EEPROM_OK) || (byte != 0x5A))
+  {
+    printf("blocking 1-byte read failed\n");
+    failed = 1;
+  }
+  return failed;
+}
+
+static int Bench_Async(void)
+{
+  EEPROM_RequestTypeDef req[4];
+  EEPROM_SimStatsTypeDef stats;
+  uint8_t  small[3] = { 0x11, 0x22, 0x33 };
+  uint8_t  readback[8];
+  uint64_t start, busy;
+  uint32_t i;
+  int      failed = 0;
+
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  SIM_SetTickHook(BSP_EEPROM_AsyncTickHandler);
+  BSP_EEPROM_Init();
+  Bench_Fill(Data, BLOCK_SIZE, 2);
+
+  /* 4 KB write, polled */
+  start = SIM_Now();
+  if (BSP_EEPROM_WriteAsync(&req[0], Data, 0x0F03, BLOCK_SIZE, NULL) != EEPROM_OK)
+  {
+    printf("async write not queued\n");
+    return 1;
+  }
+  busy = Bench_Wait(&req[0]);
+  Bench_Report("async write", SIM_Now() - start, busy);
+  if (BSP_EEPROM_AsyncStatus(&req[0]) != EEPROM_OK)
+  {
+    printf("async write ended with status %u\n", (unsigned)BSP_EEPROM_AsyncStatus(&req[0]));
+    failed = 1;
+  }
+  failed |= Bench_Compare("async write", 0x0F03, Data, BLOCK_SIZE);
+
+  /* 4 KB read, polled */
+  memset(Check, 0, sizeof(Check));
+  start = SIM_Now();
+  BSP_EEPROM_ReadAsync(&req[0], Check, 0x0F03, BLOCK_SIZE, NULL);
+  busy = Bench_Wait(&req[0]);
+  Bench_Report("async read", SIM_Now() - start, busy);
+  if ((BSP_EEPROM_AsyncStatus(&req[0]) != EEPROM_OK) || (memcmp(Check, Data, BLOCK_SIZE) != 0))
+  {
+    printf("async read failed\n");
+    failed = 1;
+  }
+
+  /* Queued requests complete in order with callbacks; a read queued after a
+     write sees its data; single bytes also go by DMA */
+  Completions = 0;
+  OrderCount = 0;
+  memset(readback, 0, sizeof(readback));
+  for (i = 0; i < 4U; i++)
+  {
+    req[i].pContext = (void *)(uintptr_t)i;
+  }
+  BSP_EEPROM_WriteAsync(&req[0], small, 0x0FFE, sizeof(small), Bench_Done);
+  BSP_EEPROM_WriteAsync(&req[1], &small[1], 0x0000, 1, Bench_Done);
+  BSP_EEPROM_ReadAsync(&req[2], readback, 0x0FFE, sizeof(small), Bench_Done);
+  BSP_EEPROM_ReadAsync(&req[3], &readback[4], 0x0000, 1, Bench_Done);
+  while (Completions < 4U)
+  {
+    SIM_Advance(IDLE_STEP_US);
+  }
+  for (i = 0; i < 4U; i++)
+  {
+    if ((Order[i] != i) || (req[i].Status != EEPROM_OK))
+    {
+      printf("queued request %u: order %u, status %u\n", (unsigned)i, (unsigned)Order[i], (unsigned)req[i].Status);
+      failed = 1;
+    }
+  }
+  if ((memcmp(readback, small, sizeof(small)) != 0) || (readback[4] != small[1]))
+  {
+    printf("queued reads returned wrong data\n");
+    failed = 1;
+  }
+  if (BSP_EEPROM_WriteAsync(&req[0], small, EEPROM_MAX_SIZE - 1U, 2, NULL) != EEPROM_FAIL)
+  {
+    printf("out-of-range request accepted\n");
+    failed = 1;
+  }
+
+  EEPROM_Sim_GetStats(&stats);
+  printf("async            %u write cycles, %u transfers refused while programming\n",
+         (unsigned)stats.WriteCycles, (unsigned)stats.Nacks);
+  return failed;
+}
+
+/* Starts a page write and returns once its data is sent: the EEPROM then
+   refuses every transfer for tW. */
+static void Bench_StartWriteCycle(uint16_t Addr)
+{
+  uint8_t count = EEPROM_PAGESIZE;
+
+  BSP_EEPROM_WritePage(Data, Addr, &count);
+  while (count > 0)
+  {
+    SIM_Advance(IDLE_STEP_US);
+  }
+}
+
+static int Bench_Refused(void)
+{
+  uint64_t start, time;
+  uint32_t timeouts = Timeouts;
+  uint16_t count;
+  int      failed = 0;
+
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  BSP_EEPROM_Init();
+  Bench_Fill(Data, BLOCK_SIZE, 3);
+
+  Bench_StartWriteCycle(0x0040);
+  start = SIM_Now();
+  count = 16;
+  if (BSP_EEPROM_ReadBuffer(Check, 0x0040, &count) != EEPROM_FAIL)
+  {
+    printf("refused blocking read did not fail\n");
+    failed = 1;
+  }
+  time = SIM_Now() - start;
+  BSP_EEPROM_WaitEepromStandbyState();
+
+  Bench_StartWriteCycle(0x0044);
+  start = SIM_Now();
+  if (BSP_EEPROM_WriteBuffer(Data, 0x0080, 8) != EEPROM_FAIL)
+  {
+    printf("refused blocking write did not fail\n");
+    failed = 1;
+  }
+  time += SIM_Now() - start;
+  printf("refused          read and write failed in %.2f ms\n", time / 1000.0);
+  if ((Timeouts != timeouts) || (time > EEPROM_SIM_TW_US))
+  {
+    printf("refused transfers waited for the timeout\n");
+    failed = 1;
+  }
+
+  /* The driver is usable again once the EEPROM answers */
+  BSP_EEPROM_WaitEepromStandbyState();
+  count = 8;
+  if ((BSP_EEPROM_ReadBuffer(Check, 0x0040, &count) != EEPROM_OK) || (memcmp(Check, Data, 4) != 0) ||
+      (memcmp(&Check[4], Data, 4) != 0))
+  {
+    printf("read after a refused transfer failed\n");
+    failed = 1;
+  }
+  return failed;
+}
+
+static int Bench_Main(void)
+{
+  int failed = 0;
+
+  failed |= Bench_Blocking();
+  failed |= Bench_Async();
+  failed |= Bench_Refused();
+  if (Timeouts != 0)
+  {
+    printf("%u timeouts\n", (unsigned)Timeouts);
+    failed = 1;
+  }
+  return failed;
+}
+
+int main(void)
+{
+  return SIM_Main(Bench_Main);
+}
@@ -0,0 +1,281 @@
+/**
+  ******************************************************************************
+  * @file    bench_eeprom_cache.c
+  * @brief   EEPROM write throughput: blocking page writes against the
+  *          write-combining cache, on the simulated M24LR64.
+  *
+  *          Each scenario is run twice from a blank EEPROM. "blocked" is the
+  *          time the caller spends inside the write calls, "durable" the time
+  *          until every byte is in the array. The EEPROM content is compared
+  *          with the expected image after each run, and read back through the
+  *          cache; any mismatch makes the program exit with status 1.
+  *          A last run starts a burst while the EEPROM is still programming
+  *          and checks that the refused burst is retried.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_eeprom_cache.h"
+#include "eeprom_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef enum
+{
+  MODE_BLOCKING = 0,
+  MODE_CACHE
+} ModeTypeDef;
+
+typedef struct
+{
+  uint64_t Blocked;
+  uint64_t Durable;
+  uint32_t Bytes;
+} ResultTypeDef;
+
+static uint8_t       Expected[EEPROM_SIM_SIZE];
+static __IO uint8_t  PageCount;
+static uint32_t      Seed;
+
+static uint32_t Bench_Rand(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return Seed >> 8;
+}
+
+/* BSP_EEPROM_WriteBuffer() page loop, with the standby wait it intends. */
+static uint32_t Bench_WriteBlocking(const uint8_t *pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite)
+{
+  while (NumByteToWrite > 0)
+  {
+    uint8_t chunk = (uint8_t)(EEPROM_PAGESIZE - (WriteAddr % EEPROM_PAGESIZE));
+
+    if (chunk > NumByteToWrite)
+    {
+      chunk = (uint8_t)NumByteToWrite;
+    }
+    PageCount = chunk;
+    if (BSP_EEPROM_WritePage((uint8_t *)pBuffer, WriteAddr, (uint8_t *)&PageCount) != EEPROM_OK)
+    {
+      return EEPROM_FAIL;
+    }
+    while ((chunk > 1) && (PageCount > 0))
+    {
+      (void)HAL_GetTick();
+    }
+    if (EEPROM_IO_IsDeviceReady(DISCOVERY_EEPROM_I2C_ADDRESS_A01, EEPROM_MAX_TRIALS_NUMBER) != HAL_OK)
+    {
+      return EEPROM_TIMEOUT;
+    }
+    pBuffer += chunk;
+    WriteAddr += chunk;
+    NumByteToWrite -= chunk;
+  }
+  return EEPROM_OK;
+}
+
+static void Bench_Write(ModeTypeDef mode, ResultTypeDef *pResult, const uint8_t *pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite)
+{
+  uint64_t start = SIM_Now();
+  uint32_t status;
+
+  memcpy(&Expected[WriteAddr], pBuffer, NumByteToWrite);
+  if (mode == MODE_BLOCKING)
+  {
+    status = Bench_WriteBlocking(pBuffer, WriteAddr, NumByteToWrite);
+  }
+  else
+  {
+    status = BSP_EEPROM_CacheWrite(pBuffer, WriteAddr, NumByteToWrite);
+  }
+  if (status != EEPROM_OK)
+  {
+    printf("write of %u bytes at 0x%04X failed (%u)\n", NumByteToWrite, WriteAddr, (unsigned)status);
+  }
+  pResult->Blocked += SIM_Now() - start;
+  pResult->Bytes += NumByteToWrite;
+}
+
+/* One 256-byte block. */
+static void Scenario_Block(ModeTypeDef mode, ResultTypeDef *pResult)
+{
+  uint8_t data[256];
+  uint32_t i;
+
+  for (i = 0; i < sizeof(data); i++)
+  {
+    data[i] = (uint8_t)(i * 7U + 3U);
+  }
+  Bench_Write(mode, pResult, data, 0x0100, sizeof(data));
+}
+
+/* A 12-byte status record rewritten every 2 ms. */
+static void Scenario_Record(ModeTypeDef mode, ResultTypeDef *pResult)
+{
+  uint8_t record[12];
+  uint32_t i;
+
+  for (i = 0; i < 32; i++)
+  {
+    memset(record, (int)i, sizeof(record));
+    record[0] = 0xA5;
+    record[1] = (uint8_t)i;
+    Bench_Write(mode, pResult, record, 0x0402, sizeof(record));
+    SIM_Advance(2000);
+  }
+}
+
+/* Single bytes scattered over 1 KB, more than the cache holds. */
+static void Scenario_Scatter(ModeTypeDef mode, ResultTypeDef *pResult)
+{
+  uint8_t value;
+  uint32_t i;
+
+  Seed = 12345;
+  for (i = 0; i < 256; i++)
+  {
+    value = (uint8_t)Bench_Rand();
+    Bench_Write(mode, pResult, &value, (uint16_t)(0x1000 + (Bench_Rand() % 1024)), 1);
+  }
+}
+
+static int Bench_Run(const char *name, void (*scenario)(ModeTypeDef, ResultTypeDef *))
+{
+  static const char *modes[] = { "blocking", "cache" };
+  uint8_t readback[EEPROM_SIM_SIZE];
+  int failed = 0;
+  uint32_t m;
+
+  for (m = MODE_BLOCKING; m <= MODE_CACHE; m++)
+  {
+    ResultTypeDef result = { 0 };
+    EEPROM_SimStatsTypeDef stats;
+    uint64_t start;
+
+    SIM_Reset();
+    EEPROM_Sim_Reset(0xFF);
+    memset(Expected, 0xFF, sizeof(Expected));
+    if (m == MODE_CACHE)
+    {
+      SIM_SetTickHook(BSP_EEPROM_CacheProcess);
+      BSP_EEPROM_CacheInit();
+    }
+    else
+    {
+      BSP_EEPROM_Init();
+    }
+
+    start = SIM_Now();
+    scenario((ModeTypeDef)m, &result);
+    if ((m == MODE_CACHE) && (BSP_EEPROM_CacheFlush() != EEPROM_OK))
+    {
+      printf("%s/%s: flush failed\n", name, modes[m]);
+      failed = 1;
+    }
+    result.Durable = SIM_Now() - start;
+    EEPROM_Sim_GetStats(&stats);
+
+    if (memcmp(EEPROM_Sim_Memory(), Expected, EEPROM_SIM_SIZE) != 0)
+    {
+      printf("%s/%s: EEPROM content mismatch\n", name, modes[m]);
+      failed = 1;
+    }
+    if (m == MODE_CACHE)
+    {
+      BSP_EEPROM_CacheRead(readback, 0, EEPROM_SIM_SIZE);
+      if (memcmp(readback, Expected, EEPROM_SIM_SIZE) != 0)
+      {
+        printf("%s/%s: read back mismatch\n", name, modes[m]);
+        failed = 1;
+      }
+    }
+
+    printf("%-8s %-9s %6u B  blocked %9.2f ms  durable %9.2f ms  %8.1f B/s  %5u cycles  max wear %3u\n",
+           name, modes[m], (unsigned)result.Bytes,
+           result.Blocked / 1000.0, result.Durable / 1000.0,
+           result.Bytes * 1e6 / (double)result.Durable,
+           (unsigned)stats.WriteCycles, (unsigned)stats.MaxWear);
+  }
+  return failed;
+}
+
+/* A burst started while the EEPROM still programs a direct page write is
+   refused; the cache must retry it rather than lose it or hang. */
+static int Bench_Refused(void)
+{
+  EEPROM_CacheStatsTypeDef stats;
+  uint8_t  page[EEPROM_PAGESIZE];
+  uint8_t  data[16];
+  uint8_t  readback[16];
+  uint64_t start;
+  uint32_t i;
+  int      failed = 0;
+
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  SIM_SetTickHook(BSP_EEPROM_CacheProcess);
+  BSP_EEPROM_CacheInit();
+  for (i = 0; i < sizeof(data); i++)
+  {
+    data[i] = (uint8_t)(i * 5U + 1U);
+  }
+  memset(page, 0x5A, sizeof(page));
+
+  PageCount = EEPROM_PAGESIZE;
+  if (BSP_EEPROM_WritePage(page, 0x0600, (uint8_t *)&PageCount) != EEPROM_OK)
+  {
+    printf("refused: direct page write failed\n");
+    failed = 1;
+  }
+  while (PageCount > 0)
+  {
+    (void)HAL_GetTick();
+  }
+  start = SIM_Now();
+  BSP_EEPROM_CacheWrite(data, 0x0700, sizeof(data));
+  BSP_EEPROM_CacheProcess();
+  if (BSP_EEPROM_CacheFlush() != EEPROM_OK)
+  {
+    printf("refused: flush failed\n");
+    failed = 1;
+  }
+  start = SIM_Now() - start;
+  BSP_EEPROM_CacheGetStats(&stats);
+  BSP_EEPROM_CacheInvalidate();
+  BSP_EEPROM_CacheRead(readback, 0x0700, sizeof(readback));
+  if ((memcmp(&EEPROM_Sim_Memory()[0x0700], data, sizeof(data)) != 0) ||
+      (memcmp(readback, data, sizeof(data)) != 0) ||
+      (memcmp(&EEPROM_Sim_Memory()[0x0600], page, sizeof(page)) != 0))
+  {
+    printf("refused: EEPROM content mismatch\n");
+    failed = 1;
+  }
+  if (stats.Errors == 0)
+  {
+    printf("refused: burst was not refused\n");
+    failed = 1;
+  }
+  printf("refused  cache     %6u B  durable %9.2f ms  %u refused bursts retried\n",
+         (unsigned)sizeof(data), start / 1000.0, (unsigned)stats.Errors);
+  if (start > (sizeof(data) / EEPROM_PAGESIZE + 3U) * EEPROM_SIM_TW_US)
+  {
+    printf("refused: retry waited for the completion timeout\n");
+    failed = 1;
+  }
+  return failed;
+}
+
+static int Bench_Main(void)
+{
+  int failed = 0;
+
+  failed |= Bench_Run("block", Scenario_Block);
+  failed |= Bench_Run("record", Scenario_Record);
+  failed |= Bench_Run("scatter", Scenario_Scatter);
+  failed |= Bench_Refused();
+  return failed;
+}
+
+int main(void)
+{
+  return SIM_Main(Bench_Main);
+}
@@ -0,0 +1,405 @@
+/**
+  ******************************************************************************
+  * @file    bench_eeprom_kv.c
+  * @brief   Log-structured key-value store on the simulated M24LR64: write
+  *          amplification, wear and lookup time, and power-fail recovery.
+  *
+  *          The workload mixes hot 4-byte counters, settings and a few large
+  *          calibration blobs. It is run against the store and against one
+  *          fixed EEPROM slot per key, written in place. The EEPROM image is
+  *          kept in a file (argument 1, default bench_eeprom_kv.img) and every
+  *          remount reloads it from there.
+  *
+  *          The power-fail trials cut the supply at a random page write, tear
+  *          that page, remount from the file and check that every key holds
+  *          its last committed value, or the value being written at the cut.
+  *
+  *          The read-fault trials refuse one EEPROM read, as when the link is
+  *          busy, inside BSP_EEPROM_KV_Process() and BSP_EEPROM_KV_Init():
+  *          the call must fail, and no key may be lost.
+  *          Any mismatch makes the program exit with status 1.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_eeprom_kv.h"
+#include "eeprom_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+#define KEYS            24U
+#define KEY_BASE        0x0100U
+#define OPS             3000U
+#define LOOKUPS         2000U
+#define TRIALS          200U
+#define FIXED_SLOT      64U
+
+typedef struct
+{
+  uint8_t  Present;
+  uint8_t  Length;
+  uint8_t  Value[EEPROM_KV_MAX_VALUE];
+} ModelTypeDef;
+
+typedef struct
+{
+  uint16_t Key;
+  uint8_t  Delete;
+  uint8_t  Length;
+  uint8_t  Value[EEPROM_KV_MAX_VALUE];
+} OpTypeDef;
+
+static const char   *ImagePath = "bench_eeprom_kv.img";
+static ModelTypeDef  Model[KEYS];
+static uint32_t      Seed;
+
+static uint32_t Bench_Rand(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return Seed >> 8;
+}
+
+/* Next operation: 70% counters, 25% settings, 4% calibration, 1% delete. */
+static void Bench_NextOp(OpTypeDef *pOp)
+{
+  uint32_t r = Bench_Rand() % 100U;
+  uint32_t i, k;
+
+  pOp->Delete = 0;
+  if (r < 70U)
+  {
+    k = Bench_Rand() % 8U;
+    pOp->Length = 4;
+  }
+  else if (r < 95U)
+  {
+    k = 8U + (Bench_Rand() % 12U);
+    pOp->Length = (uint8_t)(8U + (k % 3U) * 4U);
+  }
+  else if (r < 99U)
+  {
+    k = 20U + (Bench_Rand() % 4U);
+    pOp->Length = 48;
+  }
+  else
+  {
+    k = 8U + (Bench_Rand() % 16U);
+    pOp->Delete = 1;
+    pOp->Length = 0;
+  }
+  pOp->Key = (uint16_t)(KEY_BASE + k);
+  for (i = 0; i < pOp->Length; i++)
+  {
+    pOp->Value[i] = (uint8_t)Bench_Rand();
+  }
+  if (k < 8U)
+  {
+    /* Counters only move a little */
+    memcpy(pOp->Value, Model[k].Value, 4);
+    pOp->Value[0]++;
+  }
+}
+
+static void Bench_Apply(const OpTypeDef *pOp)
+{
+  ModelTypeDef *m = &Model[pOp->Key - KEY_BASE];
+
+  m->Present = (pOp->Delete == 0) ? 1 : 0;
+  m->Length = pOp->Length;
+  memcpy(m->Value, pOp->Value, pOp->Length);
+}
+
+static uint32_t Bench_Execute(const OpTypeDef *pOp)
+{
+  uint32_t status;
+
+  if (pOp->Delete != 0)
+  {
+    status = BSP_EEPROM_KV_Delete(pOp->Key);
+    return (status == EEPROM_KV_NOT_FOUND) ? EEPROM_OK : status;
+  }
+  return BSP_EEPROM_KV_Set(pOp->Key, pOp->Value, pOp->Length);
+}
+
+/* Compares the store with the model; pAlt is an accepted alternative state
+   for the key of pAlt->Key (the write in progress at a power cut). */
+static int Bench_Verify(const char *pWhen, const ModelTypeDef *pAlt, uint16_t AltKey)
+{
+  uint8_t  value[EEPROM_KV_MAX_VALUE];
+  uint8_t  length;
+  uint32_t k, status;
+  int      bad = 0;
+
+  for (k = 0; k < KEYS; k++)
+  {
+    const ModelTypeDef *m = &Model[k];
+    int ok;
+
+    length = sizeof(value);
+    status = BSP_EEPROM_KV_Get((uint16_t)(KEY_BASE + k), value, &length);
+    ok = (m->Present == 0) ? (status == EEPROM_KV_NOT_FOUND)
+                           : ((status == EEPROM_OK) && (length == m->Length) && (memcmp(value, m->Value, length) == 0));
+    if ((ok == 0) && (pAlt != NULL) && (AltKey == KEY_BASE + k))
+    {
+      ok = (pAlt->Present == 0) ? (status == EEPROM_KV_NOT_FOUND)
+                                : ((status == EEPROM_OK) && (length == pAlt->Length) && (memcmp(value, pAlt->Value, length) == 0));
+    }
+    if (ok == 0)
+    {
+      printf("%s: key 0x%04X wrong (status %u)\n", pWhen, (unsigned)(KEY_BASE + k), (unsigned)status);
+      bad = 1;
+    }
+  }
+  return bad;
+}
+
+/* Saves the image, wipes the simulated array, reloads it and remounts. */
+static uint32_t Bench_Remount(void)
+{
+  if (EEPROM_Sim_Save(ImagePath) != 0)
+  {
+    printf("cannot write %s\n", ImagePath);
+    return EEPROM_FAIL;
+  }
+  EEPROM_Sim_Reset(0x00);
+  if (EEPROM_Sim_Load(ImagePath) != 0)
+  {
+    printf("cannot read %s\n", ImagePath);
+    return EEPROM_FAIL;
+  }
+  return BSP_EEPROM_KV_Init();
+}
+
+/* In-place baseline: one slot per key, programmed page by page. */
+static void Fixed_Write(uint16_t Addr, const uint8_t *pBuffer, uint16_t Size)
+{
+  while (Size > 0)
+  {
+    uint16_t chunk = (uint16_t)(EEPROM_PAGESIZE - (Addr % EEPROM_PAGESIZE));
+
+    if (chunk > Size)
+    {
+      chunk = Size;
+    }
+    EEPROM_IO_WriteData(DISCOVERY_EEPROM_I2C_ADDRESS_A01, Addr, (uint32_t)pBuffer, chunk);
+    while (EEPROM_IO_Probe(DISCOVERY_EEPROM_I2C_ADDRESS_A01) != HAL_OK)
+    {
+    }
+    pBuffer += chunk;
+    Addr += chunk;
+    Size -= chunk;
+  }
+}
+
+static void Bench_Report(const char *pName, uint32_t UserBytes, uint64_t Time)
+{
+  EEPROM_SimStatsTypeDef stats;
+
+  EEPROM_Sim_GetStats(&stats);
+  printf("%-8s user %7u B  programmed %7u B  WA %5.2f  %6u cycles  max page wear %5u  %7.2f ms/op\n",
+         pName, (unsigned)UserBytes, (unsigned)stats.BytesWritten,
+         (double)stats.BytesWritten / UserBytes, (unsigned)stats.WriteCycles,
+         (unsigned)stats.MaxWear, Time / 1000.0 / OPS);
+}
+
+static int Bench_Workload(void)
+{
+  EEPROM_KVStatsTypeDef kv;
+  OpTypeDef op;
+  uint64_t start, setTime = 0, maxSet = 0, t;
+  uint32_t i, user = 0;
+  uint8_t  value[EEPROM_KV_MAX_VALUE];
+  uint8_t  length;
+  int      failed = 0;
+
+  /* In-place baseline */
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  memset(Model, 0, sizeof(Model));
+  Seed = 1;
+  start = SIM_Now();
+  for (i = 0; i < OPS; i++)
+  {
+    Bench_NextOp(&op);
+    if (op.Delete == 0)
+    {
+      Fixed_Write((uint16_t)((op.Key - KEY_BASE) * FIXED_SLOT), op.Value, op.Length);
+      user += op.Length;
+    }
+    Bench_Apply(&op);
+  }
+  Bench_Report("in-place", user, SIM_Now() - start);
+
+  /* Log-structured store */
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  memset(Model, 0, sizeof(Model));
+  Seed = 1;
+  BSP_EEPROM_KV_Init();
+  for (i = 0; i < OPS; i++)
+  {
+    Bench_NextOp(&op);
+    t = SIM_Now();
+    if (Bench_Execute(&op) != EEPROM_OK)
+    {
+      printf("op %u on key 0x%04X failed\n", (unsigned)i, op.Key);
+      failed = 1;
+    }
+    t = SIM_Now() - t;
+    setTime += t;
+    maxSet = (t > maxSet) ? t : maxSet;
+    Bench_Apply(&op);
+    /* Idle time of the main loop */
+    BSP_EEPROM_KV_Process();
+  }
+  BSP_EEPROM_KV_GetStats(&kv);
+  Bench_Report("kv", kv.UserBytes, setTime);
+  printf("kv       %u records, %u copied by compaction, %u segments reclaimed, slowest write %.2f ms\n",
+         (unsigned)kv.Records, (unsigned)kv.CopiedRecords, (unsigned)kv.Compactions, maxSet / 1000.0);
+  failed |= Bench_Verify("workload", NULL, 0);
+
+  /* Lookups */
+  start = SIM_Now();
+  for (i = 0; i < LOOKUPS; i++)
+  {
+    length = sizeof(value);
+    BSP_EEPROM_KV_Get((uint16_t)(KEY_BASE + (Bench_Rand() % KEYS)), value, &length);
+  }
+  t = SIM_Now() - start;
+  BSP_EEPROM_KV_GetStats(&kv);
+  printf("lookup   %.1f us per get (I2C read included), %.2f index probes per lookup\n",
+         (double)t / LOOKUPS, (double)kv.Probes / kv.Lookups);
+
+  /* Remount from the file */
+  start = SIM_Now();
+  if (Bench_Remount() != EEPROM_OK)
+  {
+    printf("remount failed\n");
+    failed = 1;
+  }
+  printf("mount    %.2f ms to rebuild the index of %u keys\n",
+         (SIM_Now() - start) / 1000.0, (unsigned)BSP_EEPROM_KV_Count());
+  failed |= Bench_Verify("remount", NULL, 0);
+  return failed;
+}
+
+static int Bench_PowerFail(void)
+{
+  ModelTypeDef before;
+  OpTypeDef op;
+  uint32_t trial, i, bad = 0;
+  uint16_t key;
+
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  memset(Model, 0, sizeof(Model));
+  Seed = 7;
+  BSP_EEPROM_KV_Init();
+  BSP_EEPROM_KV_Format();
+
+  for (trial = 0; trial < TRIALS; trial++)
+  {
+    EEPROM_Sim_PowerFail(Bench_Rand() % 400U, Bench_Rand());
+    key = 0;
+    for (i = 0; (i < 1000U) && (EEPROM_Sim_PowerLost() == 0); i++)
+    {
+      Bench_NextOp(&op);
+      before = Model[op.Key - KEY_BASE];
+      Bench_Execute(&op);
+      Bench_Apply(&op);
+      if (EEPROM_Sim_PowerLost() != 0)
+      {
+        key = op.Key;
+        break;
+      }
+      /* A cut during compaction must not lose anything */
+      BSP_EEPROM_KV_Process();
+    }
+
+    /* The write at the cut may or may not have committed */
+    EEPROM_Sim_PowerCycle();
+    if ((Bench_Remount() != EEPROM_OK) || (Bench_Verify("power fail", &before, key) != 0))
+    {
+      bad++;
+    }
+    /* Resynchronise the model with whichever value survived */
+    if (key != 0)
+    {
+      ModelTypeDef *m = &Model[key - KEY_BASE];
+      uint8_t length = sizeof(m->Value);
+
+      m->Present = (BSP_EEPROM_KV_Get(key, m->Value, &length) == EEPROM_OK) ? 1 : 0;
+      m->Length = (m->Present != 0) ? length : 0;
+    }
+  }
+  printf("power    %u cuts, %u bad recoveries\n", (unsigned)TRIALS, (unsigned)bad);
+  return (bad != 0) ? 1 : 0;
+}
+
+static int Bench_ReadFault(void)
+{
+  OpTypeDef op;
+  uint32_t i, status, hit = 0, bad = 0;
+
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  memset(Model, 0, sizeof(Model));
+  Seed = 11;
+  BSP_EEPROM_KV_Init();
+  BSP_EEPROM_KV_Format();
+
+  /* One refused read in the compaction: it must fail, not release */
+  for (i = 0; i < 1000U; i++)
+  {
+    Bench_NextOp(&op);
+    Bench_Execute(&op);
+    Bench_Apply(&op);
+    EEPROM_Sim_ReadFault(Bench_Rand() % 3U);
+    status = BSP_EEPROM_KV_Process();
+    if (EEPROM_Sim_ReadFaulted() != 0)
+    {
+      hit++;
+      bad += (status == EEPROM_OK) ? 1U : 0U;
+    }
+    EEPROM_Sim_PowerCycle();
+  }
+  bad += (Bench_Verify("read fault", NULL, 0) != 0) ? 1U : 0U;
+
+  /* One refused read in the mount: it must fail, the next one succeed */
+  for (i = 0; i < 50U; i++)
+  {
+    EEPROM_Sim_ReadFault(Bench_Rand() % 200U);
+    status = BSP_EEPROM_KV_Init();
+    if (EEPROM_Sim_ReadFaulted() != 0)
+    {
+      hit++;
+      bad += (status == EEPROM_OK) ? 1U : 0U;
+    }
+    EEPROM_Sim_PowerCycle();
+    if (BSP_EEPROM_KV_Init() != EEPROM_OK)
+    {
+      bad++;
+    }
+  }
+  bad += (Bench_Verify("read fault mount", NULL, 0) != 0) ? 1U : 0U;
+  printf("faults   %u refused reads, %u bad results\n", (unsigned)hit, (unsigned)bad);
+  return (bad != 0) ? 1 : 0;
+}
+
+static int Bench_Main(void)
+{
+  int failed = 0;
+
+  failed |= Bench_Workload();
+  failed |= Bench_PowerFail();
+  failed |= Bench_ReadFault();
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1)
+  {
+    ImagePath = argv[1];
+  }
+  return SIM_Main(Bench_Main);
+}
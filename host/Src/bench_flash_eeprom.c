@@ -0,0 +1,276 @@
+/**
+  ******************************************************************************
+  * @file    bench_flash_eeprom.c
+  * @brief   EEPROM emulation in the simulated internal flash: write
+  *          throughput and latency, read cost, and power-fail recovery.
+  *
+  *          The workload updates 64 variables, most of the writes going to a
+  *          few hot ones, with some grouped updates. It runs twice: with
+  *          BSP_FLASH_EE_Process() called from the idle loop after every
+  *          write, and without it, so that page swaps run inside the writes.
+  *
+  *          Reads are compared with a reference lookup that scans the active
+  *          page backwards for the newest entry, as emulations without an
+  *          index do.
+  *
+  *          The power-fail trials cut the supply at a random half-word
+  *          program or page erase, remount and check that every variable
+  *          holds its last committed value, or the value being written at
+  *          the cut. Any mismatch makes the program exit with status 1.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_flash_eeprom.h"
+#include "flash_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VARS            FLASH_EE_VARIABLES
+#define OPS             20000U
+#define READS           20000U
+#define TRIALS          300U
+
+typedef struct
+{
+  uint8_t  Present;
+  uint32_t Value;
+} ModelTypeDef;
+
+static ModelTypeDef  Model[VARS];
+static uint32_t      Latency[OPS];
+static uint32_t      Seed;
+
+static uint32_t Bench_Rand(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return Seed >> 8;
+}
+
+/* 75% of the writes go to 8 hot variables */
+static uint16_t Bench_NextVar(void)
+{
+  if ((Bench_Rand() % 4U) != 0)
+  {
+    return (uint16_t)(Bench_Rand() % 8U);
+  }
+  return (uint16_t)(Bench_Rand() % VARS);
+}
+
+static int Bench_Compare(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+/* Compares the emulation with the model; AltVar may also hold pAlt. */
+static int Bench_Verify(const char *pWhen, const ModelTypeDef *pAlt, uint16_t AltVar)
+{
+  uint32_t var, value, status;
+  int      bad = 0;
+
+  for (var = 0; var < VARS; var++)
+  {
+    const ModelTypeDef *m = &Model[var];
+    int ok;
+
+    status = BSP_FLASH_EE_Read((uint16_t)var, &value);
+    ok = (m->Present == 0) ? (status == FLASH_EE_NOT_FOUND)
+                           : ((status == FLASH_EE_OK) && (value == m->Value));
+    if ((ok == 0) && (pAlt != NULL) && (AltVar == var))
+    {
+      ok = (pAlt->Present == 0) ? (status == FLASH_EE_NOT_FOUND)
+                                : ((status == FLASH_EE_OK) && (value == pAlt->Value));
+    }
+    if (ok == 0)
+    {
+      printf("%s: variable %u wrong (status %u)\n", pWhen, (unsigned)var, (unsigned)status);
+      bad = 1;
+    }
+  }
+  return bad;
+}
+
+/* Reference lookup without an index: newest matching entry of the valid page. */
+static uint32_t Scan_Read(uint16_t Var, uint32_t *pData, uint32_t *pVisited)
+{
+  uint32_t page, slot, addr;
+
+  page = (*(volatile uint16_t *)FLASH_EE_BASE == 0x0000U) ? FLASH_EE_BASE : FLASH_EE_BASE + FLASH_PAGE_SIZE;
+  for (slot = FLASH_EE_PAGE_ENTRIES; slot-- > 0;)
+  {
+    addr = page + 8U * (slot + 1U);
+    (*pVisited)++;
+    if (*(volatile uint16_t *)addr == Var)
+    {
+      *pData = *(volatile uint16_t *)(addr + 2U) | ((uint32_t)*(volatile uint16_t *)(addr + 4U) << 16);
+      return FLASH_EE_OK;
+    }
+  }
+  return FLASH_EE_NOT_FOUND;
+}
+
+static int Bench_Workload(const char *pName, int Background)
+{
+  FLASH_EE_StatsTypeDef ee;
+  FLASH_SimStatsTypeDef fl;
+  uint64_t start, busy = 0, t, maxStep = 0;
+  uint32_t i, n, ops = 0;
+  uint16_t vars[4];
+  uint32_t values[4];
+  int      failed = 0;
+
+  SIM_Reset();
+  FLASH_Sim_Reset();
+  memset(Model, 0, sizeof(Model));
+  Seed = 1;
+  BSP_FLASH_EE_Init();
+
+  start = SIM_Now();
+  for (i = 0; i < OPS; i++)
+  {
+    /* One write in ten updates a group of four variables */
+    n = ((Bench_Rand() % 10U) == 0) ? 4U : 1U;
+    for (ops = 0; ops < n; ops++)
+    {
+      vars[ops] = Bench_NextVar();
+      values[ops] = Bench_Rand();
+    }
+    t = SIM_Now();
+    if (BSP_FLASH_EE_WriteMulti(vars, values, n) != FLASH_EE_OK)
+    {
+      printf("%s: write %u failed\n", pName, (unsigned)i);
+      failed = 1;
+    }
+    Latency[i] = (uint32_t)(SIM_Now() - t);
+    busy += Latency[i];
+    for (ops = 0; ops < n; ops++)
+    {
+      Model[vars[ops]].Present = 1;
+      Model[vars[ops]].Value = values[ops];
+    }
+    if (Background != 0)
+    {
+      t = SIM_Now();
+      BSP_FLASH_EE_Process();
+      t = SIM_Now() - t;
+      maxStep = (t > maxStep) ? t : maxStep;
+    }
+  }
+  t = SIM_Now() - start;
+  failed |= Bench_Verify(pName, NULL, 0);
+
+  BSP_FLASH_EE_GetStats(&ee);
+  FLASH_Sim_GetStats(&fl);
+  qsort(Latency, OPS, sizeof(Latency[0]), Bench_Compare);
+  printf("%-10s %6.0f writes/s  latency avg %6.1f us  p50 %5u  p99 %6u  max %6u us\n",
+         pName, ee.Writes / (t / 1e6), (double)busy / OPS, (unsigned)Latency[OPS / 2],
+         (unsigned)Latency[(OPS * 99U) / 100U], (unsigned)Latency[OPS - 1U]);
+  printf("%-10s %u entries (%u copied), %u swaps, %u erases, max page wear %u, %u swap steps in writes\n",
+         pName, (unsigned)ee.Entries, (unsigned)ee.Copies, (unsigned)ee.Swaps, (unsigned)ee.Erases,
+         (unsigned)fl.MaxWear, (unsigned)ee.SyncSteps);
+  if (Background != 0)
+  {
+    printf("%-10s longest BSP_FLASH_EE_Process() step %.1f ms\n", pName, maxStep / 1000.0);
+  }
+  return failed;
+}
+
+static int Bench_Reads(void)
+{
+  uint32_t i, var, a, b = 0, visited = 0;
+  int      failed = 0;
+
+  /* One page, 160 entries: every variable once, then the hot ones */
+  SIM_Reset();
+  FLASH_Sim_Reset();
+  BSP_FLASH_EE_Init();
+  for (i = 0; i < 160U; i++)
+  {
+    var = (i < VARS) ? i : (Bench_Rand() % 8U);
+    BSP_FLASH_EE_Write((uint16_t)var, Bench_Rand());
+  }
+  for (i = 0; i < READS; i++)
+  {
+    var = Bench_Rand() % VARS;
+    if ((BSP_FLASH_EE_Read((uint16_t)var, &a) != FLASH_EE_OK) ||
+        (Scan_Read((uint16_t)var, &b, &visited) != FLASH_EE_OK) || (a != b))
+    {
+      printf("read of variable %u differs from the page scan\n", (unsigned)var);
+      failed = 1;
+      break;
+    }
+  }
+  printf("read       1 index lookup + 2 half-word loads, page scan visits %.1f slots per read (160 of 255 used)\n",
+         (double)visited / READS);
+  return failed;
+}
+
+static int Bench_PowerFail(void)
+{
+  ModelTypeDef before;
+  uint32_t trial, i, value, bad = 0;
+  uint16_t var, cut;
+  FLASH_EE_StatsTypeDef ee;
+
+  SIM_Reset();
+  FLASH_Sim_Reset();
+  memset(Model, 0, sizeof(Model));
+  Seed = 7;
+  BSP_FLASH_EE_Init();
+
+  for (trial = 0; trial < TRIALS; trial++)
+  {
+    FLASH_Sim_PowerFail(Bench_Rand() % 3000U, Bench_Rand());
+    cut = 0xFFFF;
+    memset(&before, 0, sizeof(before));
+    for (i = 0; (i < 2000U) && (FLASH_Sim_PowerLost() == 0); i++)
+    {
+      var = Bench_NextVar();
+      value = Bench_Rand();
+      before = Model[var];
+      BSP_FLASH_EE_Write(var, value);
+      Model[var].Present = 1;
+      Model[var].Value = value;
+      if (FLASH_Sim_PowerLost() != 0)
+      {
+        cut = var;
+        break;
+      }
+      /* A cut during a page swap must not lose anything */
+      BSP_FLASH_EE_Process();
+    }
+
+    FLASH_Sim_PowerCycle();
+    if ((BSP_FLASH_EE_Init() != FLASH_EE_OK) || (Bench_Verify("power fail", &before, cut) != 0))
+    {
+      bad++;
+    }
+    /* Resynchronise the model with whichever value survived */
+    if (cut != 0xFFFF)
+    {
+      Model[cut].Present = (BSP_FLASH_EE_Read(cut, &Model[cut].Value) == FLASH_EE_OK) ? 1U : 0U;
+    }
+  }
+  BSP_FLASH_EE_GetStats(&ee);
+  printf("power      %u cuts over %u page swaps, %u bad recoveries\n",
+         (unsigned)TRIALS, (unsigned)ee.Generation, (unsigned)bad);
+  return (bad != 0) ? 1 : 0;
+}
+
+static int Bench_Main(void)
+{
+  int failed = 0;
+
+  failed |= Bench_Workload("foreground", 0);
+  failed |= Bench_Workload("background", 1);
+  failed |= Bench_Reads();
+  failed |= Bench_PowerFail();
+  return failed;
+}
+
+int main(void)
+{
+  return SIM_Main(Bench_Main);
+}
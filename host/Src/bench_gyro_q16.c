@@ -0,0 +1,159 @@
+/**
+  ******************************************************************************
+  * @file    bench_gyro_q16.c
+  * @brief   Q16.16 gyroscope data path against the float one: equivalence
+  *          over every raw value and full scale, and the cost per sample.
+  *
+  *          Both component drivers read each of the 65536 raw values on the
+  *          three axes through the simulated L3GD20 at every full scale. The
+  *          Q16.16 result must stay within GYRO_Q16_TOLERANCE of the exact
+  *          value, and the float one (mdps) is checked against it as well.
+  *
+  *          No Cortex-M0 runs here: the conversion cycles come from the
+  *          instruction sequences, soft-float calls for the float path
+  *          (CYCLES_FLOAT_AXIS, libgcc __aeabi_i2f and __aeabi_fmul) and
+  *          MULS, ADDS, ASRS for the Q16.16 one. The SPI read costs the same
+  *          for both and comes from the bus model.
+  *
+  *          Any value out of tolerance makes the program exit with status 1.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_gyroscope.h"
+#include "gyro_sim.h"
+#include "sim.h"
+#include <math.h>
+#include <stdio.h>
+
+#define CPU_MHZ             48U
+/* Estimated Cortex-M0 cycles per axis, load and store included */
+#define CYCLES_FLOAT_AXIS   120U
+#define CYCLES_Q16_AXIS     7U
+/* Q16.16 error allowed, relative to the value, plus one LSB of rounding */
+#define GYRO_Q16_TOLERANCE  1e-5
+#define READS               1000U
+
+typedef struct
+{
+  const char *Name;
+  void      (*Init)(uint16_t);
+  void      (*ReadFloat)(float *);
+  void      (*ReadQ16)(int32_t *);
+  uint8_t     FullScale[3];
+  double      Mdps[3];
+} Bench_ComponentTypeDef;
+
+static const Bench_ComponentTypeDef Components[2] =
+{
+  { "L3GD20", L3GD20_Init, L3GD20_ReadXYZAngRate, L3GD20_ReadXYZAngRateQ16,
+    { L3GD20_FULLSCALE_250, L3GD20_FULLSCALE_500, L3GD20_FULLSCALE_2000 }, { 8.75, 17.5, 70.0 } },
+  { "I3G4250D", I3G4250D_Init, I3G4250D_ReadXYZAngRate, I3G4250D_ReadXYZAngRateQ16,
+    { I3G4250D_FULLSCALE_245, I3G4250D_FULLSCALE_500, I3G4250D_FULLSCALE_2000 }, { 8.75, 17.5, 70.0 } },
+};
+
+static int Bench_Equivalence(const Bench_ComponentTypeDef *pComp, uint32_t Scale)
+{
+  int16_t  raw[3];
+  int32_t  q16[3];
+  float    mdps[3];
+  double   maxerr = 0, maxfloat = 0;
+  uint32_t n, bad = 0;
+  int      i;
+
+  /* Powered down, little endian: the output registers only change on Hold */
+  pComp->Init((uint16_t)((uint16_t)pComp->FullScale[Scale] << 8));
+  for (n = 0; n < 0x10000U; n++)
+  {
+    GYRO_Sim_Sample(n, raw);
+    GYRO_Sim_Hold(n);
+    pComp->ReadQ16(q16);
+    GYRO_Sim_Hold(n);
+    pComp->ReadFloat(mdps);
+    for (i = 0; i < 3; i++)
+    {
+      double exact = raw[i] * pComp->Mdps[Scale] * 65.536;
+      double err = fabs(q16[i] - exact);
+
+      if (err > maxerr)
+      {
+        maxerr = err;
+      }
+      if (err > 1.0 + fabs(exact) * GYRO_Q16_TOLERANCE)
+      {
+        bad++;
+      }
+      err = fabs(q16[i] / 65.536 - mdps[i]);
+      if (err > maxfloat)
+      {
+        maxfloat = err;
+      }
+      if (err > 1.0 / 65.536 + fabs(mdps[i]) * GYRO_Q16_TOLERANCE)
+      {
+        bad++;
+      }
+    }
+  }
+  printf("%-8s %4.0f dps  max error %6.1f LSB (%.4f dps)  float path within %.4f dps  %u out of tolerance\n",
+         pComp->Name, 32768.0 * pComp->Mdps[Scale] / 1000.0, maxerr, maxerr / 65536.0,
+         maxfloat / 1000.0, (unsigned)bad);
+  return (bad != 0) ? 1 : 0;
+}
+
+/* CPU time of READS reads through the BSP, SPI included, in us */
+static double Bench_ReadCost(uint32_t Q16)
+{
+  float    mdps[3];
+  int32_t  q16[3];
+  uint64_t spin = SIM_SpinTime();
+  uint32_t r;
+
+  for (r = 0; r < READS; r++)
+  {
+    if (Q16 != 0)
+    {
+      BSP_GYRO_GetXYZQ16(q16);
+    }
+    else
+    {
+      BSP_GYRO_GetXYZ(mdps);
+    }
+  }
+  return (double)(SIM_SpinTime() - spin) / READS;
+}
+
+static int Bench_Main(void)
+{
+  double   spi_float, spi_q16;
+  uint32_t c, s;
+  int      failed = 0;
+
+  SIM_Reset();
+  GYRO_Sim_Reset(0);
+  for (c = 0; c < 2; c++)
+  {
+    for (s = 0; s < 3; s++)
+    {
+      failed |= Bench_Equivalence(&Components[c], s);
+    }
+  }
+
+  /* Cost per sample, SPI read and conversion */
+  SIM_Reset();
+  GYRO_Sim_Reset(0);
+  if (BSP_GYRO_Init() != GYRO_OK)
+  {
+    printf("gyroscope not found\n");
+    return 1;
+  }
+  spi_float = Bench_ReadCost(0);
+  spi_q16 = Bench_ReadCost(1);
+  printf("conversion  float %4u cycles  Q16.16 %3u cycles per sample (%.1fx)\n",
+         3U * CYCLES_FLOAT_AXIS, 3U * CYCLES_Q16_AXIS, (double)CYCLES_FLOAT_AXIS / CYCLES_Q16_AXIS);
+  printf("per sample  float %5.2f us  Q16.16 %5.2f us  (SPI read %.2f us)\n",
+         spi_float + 3.0 * CYCLES_FLOAT_AXIS / CPU_MHZ, spi_q16 + 3.0 * CYCLES_Q16_AXIS / CPU_MHZ, spi_q16);
+  return failed;
+}
+
+int main(void)
+{
+  return SIM_Main(Bench_Main);
+}
@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  * @file    bench_gyro_stream.c
+  * @brief   Gyroscope FIFO streaming with SPI DMA bursts on the simulated
+  *          L3GD20: samples/s and CPU time per sample against reading each
+  *          sample on its data ready interrupt.
+  *
+  *          The gyroscope runs at 760 Hz. Three ways to get the samples:
+  *           - former: data ready on INT2, then the former
+  *             L3GD20_ReadXYZAngRate(), CTRL_REG4 read again for each sample
+  *             and one HAL call per SPI byte;
+  *           - cached: data ready on INT2, then BSP_GYRO_GetXYZ() with the
+  *             cached CTRL_REG4 and the data in one HAL call;
+  *           - stream: BSP_GYRO_StreamStart(), the FIFO watermark on INT2
+  *             and one DMA burst for all the stored samples.
+  *          The first two convert to dps in floats, as GetXYZ does: that
+  *          costs GYRO_FLOAT_US of soft-float code on the Cortex-M0. The
+  *          main loop stays idle (as in __WFI()), so the CPU time is the
+  *          interrupt time.
+  *
+  *          Every sample is checked against the device sequence. A wrong
+  *          sample, or a sample lost by the stream, makes the program exit
+  *          with status 1.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_gyroscope.h"
+#include "gyro_sim.h"
+#include "sim.h"
+#include <math.h>
+#include <stdio.h>
+
+#define WARMUP_US       20000U
+#define RUN_US          2000000U
+#define IDLE_STEP_US    10U
+/* Three int to float conversions and products in soft-float, in us */
+#define GYRO_FLOAT_US   8U
+
+enum { MODE_FORMER, MODE_CACHED, MODE_STREAM, MODES };
+
+static const char *const ModeName[MODES] = { "former", "cached", "stream" };
+static uint32_t Mode;
+static uint32_t Counting;
+static uint32_t Started;
+static uint32_t Expected;
+static uint32_t Received;
+static uint32_t Lost;
+static uint32_t Corrupt;
+
+static void Bench_Check(const int16_t *pXYZ)
+{
+  int16_t  ref[3];
+  uint32_t n = (uint16_t)pXYZ[0];
+
+  if (Counting == 0)
+  {
+    return;
+  }
+  /* Sample numbers are known modulo 2^16 from X */
+  if (Started != 0)
+  {
+    Lost += (uint16_t)(n - Expected);
+  }
+  Started = 1;
+  Expected = (uint16_t)(n + 1U);
+  Received++;
+  GYRO_Sim_Sample(n, ref);
+  if ((pXYZ[1] != ref[1]) || (pXYZ[2] != ref[2]))
+  {
+    Corrupt++;
+  }
+}
+
+/* L3GD20_ReadXYZAngRate() before the CTRL_REG4 cache */
+static void Bench_ReadFormer(float *pfData)
+{
+  uint8_t tmpbuffer[6];
+  uint8_t tmpreg;
+  int16_t raw[3];
+  float   sensitivity;
+  int     i;
+
+  GYRO_IO_Read(&tmpreg, L3GD20_CTRL_REG4_ADDR, 1);
+  GYRO_IO_Read(tmpbuffer, L3GD20_OUT_X_L_ADDR, 6);
+  for (i = 0; i < 3; i++)
+  {
+    if ((tmpreg & L3GD20_BLE_MSB) == 0)
+    {
+      raw[i] = (int16_t)(((uint16_t)tmpbuffer[2 * i + 1] << 8) + tmpbuffer[2 * i]);
+    }
+    else
+    {
+      raw[i] = (int16_t)(((uint16_t)tmpbuffer[2 * i] << 8) + tmpbuffer[2 * i + 1]);
+    }
+  }
+  sensitivity = ((tmpreg & 0x30) == L3GD20_FULLSCALE_500) ? L3GD20_SENSITIVITY_500DPS : L3GD20_SENSITIVITY_250DPS;
+  for (i = 0; i < 3; i++)
+  {
+    pfData[i] = (float)(raw[i] * sensitivity);
+  }
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  float   dps[3];
+  int16_t raw[3];
+  int     i;
+
+  if (GPIO_Pin != GYRO_INT2_PIN)
+  {
+    return;
+  }
+  if (Mode == MODE_STREAM)
+  {
+    BSP_GYRO_StreamIRQHandler();
+    return;
+  }
+  if (Mode == MODE_FORMER)
+  {
+    Bench_ReadFormer(dps);
+  }
+  else
+  {
+    BSP_GYRO_GetXYZ(dps);
+  }
+  SIM_Busy(GYRO_FLOAT_US);
+  for (i = 0; i < 3; i++)
+  {
+    raw[i] = (int16_t)lrintf(dps[i] / L3GD20_SENSITIVITY_500DPS);
+  }
+  Bench_Check(raw);
+}
+
+static void Bench_Burst(int16_t *pSamples, uint32_t Count)
+{
+  uint32_t i;
+
+  for (i = 0; i < Count; i++)
+  {
+    Bench_Check(&pSamples[3 * i]);
+  }
+}
+
+static void Bench_Idle(uint64_t Duration)
+{
+  uint64_t end = SIM_Now() + Duration;
+
+  while (SIM_Now() < end)
+  {
+    SIM_Advance(IDLE_STEP_US);
+  }
+}
+
+static int Bench_Run(uint32_t RunMode)
+{
+  GYRO_SimStatsTypeDef    dev0, dev;
+  GYRO_StreamStatsTypeDef stream = {0, 0, 0, 0};
+  uint64_t spin;
+  uint8_t  ctrl1;
+  double   seconds = RUN_US / 1e6;
+  int      failed = 0;
+
+  SIM_Reset();
+  GYRO_Sim_Reset((RunMode == MODE_FORMER) ? 1U : 0U);
+  Mode = RunMode;
+  Counting = 0;
+  Started = 0;
+  Received = 0;
+  Lost = 0;
+  Corrupt = 0;
+
+  if (BSP_GYRO_Init() != GYRO_OK)
+  {
+    printf("%s: gyroscope not found\n", ModeName[RunMode]);
+    return 1;
+  }
+  /* 760 Hz */
+  GYRO_IO_Read(&ctrl1, L3GD20_CTRL_REG1_ADDR, 1);
+  ctrl1 |= L3GD20_OUTPUT_DATARATE_4;
+  GYRO_IO_Write(&ctrl1, L3GD20_CTRL_REG1_ADDR, 1);
+
+  if (RunMode == MODE_STREAM)
+  {
+    if (BSP_GYRO_StreamStart(Bench_Burst) != GYRO_OK)
+    {
+      printf("%s: stream not started\n", ModeName[RunMode]);
+      return 1;
+    }
+  }
+  else
+  {
+    BSP_GYRO_EnableIT(L3GD20_INT2);
+    GYRO_IO_INT2Config(1);
+  }
+  Bench_Idle(WARMUP_US);
+
+  Counting = 1;
+  GYRO_Sim_GetStats(&dev0);
+  spin = SIM_SpinTime();
+  Bench_Idle(RUN_US);
+  spin = SIM_SpinTime() - spin;
+  GYRO_Sim_GetStats(&dev);
+  Counting = 0;
+
+  if (RunMode == MODE_STREAM)
+  {
+    BSP_GYRO_StreamStop();
+    BSP_GYRO_GetStreamStats(&stream);
+  }
+  else
+  {
+    GYRO_IO_INT2Config(0);
+  }
+
+  printf("%-7s %5.0f samples/s  CPU %6.2f us/sample  busy %5.2f%%  %4.0f interrupts/s  %4.0f SPI transfers/s  %u lost\n",
+         ModeName[RunMode], Received / seconds, (Received != 0) ? (double)spin / Received : 0.0,
+         100.0 * (double)spin / RUN_US, (dev.Interrupts - dev0.Interrupts) / seconds, (dev.Transfers - dev0.Transfers) / seconds,
+         (unsigned)Lost);
+  if (RunMode == MODE_STREAM)
+  {
+    printf("        %u bursts of %.1f samples, %u found the FIFO full, %u failed\n",
+           (unsigned)stream.Bursts, (stream.Bursts != 0) ? (double)stream.Samples / stream.Bursts : 0.0,
+           (unsigned)stream.Overruns, (unsigned)stream.Errors);
+    if ((Lost != 0) || (stream.Errors != 0) || (dev.Collisions != dev0.Collisions))
+    {
+      failed = 1;
+    }
+  }
+  if ((Corrupt != 0) || (Received == 0))
+  {
+    printf("%s: %u wrong samples out of %u\n", ModeName[RunMode], (unsigned)Corrupt, (unsigned)Received);
+    failed = 1;
+  }
+  return failed;
+}
+
+static int Bench_Main(void)
+{
+  int failed = 0;
+  uint32_t m;
+
+  for (m = 0; m < MODES; m++)
+  {
+    failed |= Bench_Run(m);
+  }
+  return failed;
+}
+
+int main(void)
+{
+  return SIM_Main(Bench_Main);
+}
@@ -0,0 +1,340 @@
+/**
+  ******************************************************************************
+  * @file    bench_lcd_blit.c
+  * @brief   Display throughput of the ST7735 and HX8347D drivers: the former
+  *          blocking writes against the window and DMA bulk operations.
+  *
+  *          Each scene is drawn twice on the display model, once the way the
+  *          drivers did before the bulk operations (a cursor and a blocking
+  *          write per line, a cursor per pixel for vertical lines) and once
+  *          through the LCD_DrvTypeDef bulk operations:
+  *           - clear: the whole screen in one color (FillRect);
+  *           - rects: 100 rectangles of random size and color (FillRect);
+  *           - vlines: a vertical line every fourth column (DrawVLine);
+  *           - image: a 64 x 64 image at 8 places, one from an odd address
+  *             (DrawRGBImage);
+  *           - spans: a gradient over the screen rendered line by line,
+  *             SPAN_US_PER_8 us of CPU per 8 pixels (DrawRGBSpans).
+  *          Both display memories must match the reference raster of the
+  *          scene, or the program exits with status 1. Time and CPU load are
+  *          in simulated time, the last transfer included.
+  *
+  *          With a directory argument, the display memory after each bulk
+  *          scene is written there as <controller>_<scene>.ppm.
+  ******************************************************************************
+  */
+#include "lcd.h"
+#include "lcd_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SPAN_US_PER_8       1U         /* 6 cycles per pixel at 48 MHz */
+#define IMAGE_SIZE          64U
+#define RECTS               100U
+
+extern LCD_DrvTypeDef st7735_drv;
+extern LCD_DrvTypeDef hx8347d_drv;
+
+typedef struct
+{
+  const char     *Name;
+  uint32_t        Controller;
+  LCD_DrvTypeDef *pDrv;
+  uint16_t        LineLength;          /* pixels along the memory lines */
+  uint16_t        Lines;
+} Bench_DisplayTypeDef;
+
+typedef struct
+{
+  const char *Name;
+  void      (*Draw)(uint32_t Bulk);
+} Bench_SceneTypeDef;
+
+static const Bench_DisplayTypeDef *Display;
+static uint16_t  Reference[320U * 240U];
+static uint16_t  Line[320];
+static uint16_t  Image[IMAGE_SIZE * IMAGE_SIZE];
+static uint8_t   OddImage[IMAGE_SIZE * IMAGE_SIZE * 2U + 1U];
+static uint64_t  RenderTime;
+static uint32_t  Seed;
+
+static uint32_t Bench_Random(uint32_t Range)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return (Seed >> 8) % Range;
+}
+
+/* Driver coordinates of pixel Pos of memory line Ln: an ST7735 line is a
+   Ypos and its pixels Xpos, an HX8347D line is an Xpos and its pixels Ypos */
+static void Bench_Coords(uint16_t Ln, uint16_t Pos, uint16_t *pX, uint16_t *pY)
+{
+  if (Display->Controller == LCD_SIM_ST7735)
+  {
+    *pX = Pos;
+    *pY = Ln;
+  }
+  else
+  {
+    *pX = Ln;
+    *pY = Pos;
+  }
+}
+
+/* Rectangle of Count pixels along the lines from (Ln, Pos), Lines lines */
+static void Bench_RefRect(uint16_t Ln, uint16_t Pos, uint16_t Count, uint16_t Lines, const uint16_t *pPixels, uint16_t RGBCode)
+{
+  uint32_t l, i;
+
+  for (l = 0; l < Lines; l++)
+  {
+    for (i = 0; i < Count; i++)
+    {
+      Reference[(Ln + l) * Display->LineLength + Pos + i] = (pPixels != NULL) ? pPixels[l * Count + i] : RGBCode;
+    }
+  }
+}
+
+/* Former line drawing: cursor, then a blocking write */
+static void Bench_FormerLine(uint16_t Ln, uint16_t Pos, const uint16_t *pPixels, uint16_t Count)
+{
+  uint16_t x, y;
+
+  Bench_Coords(Ln, Pos, &x, &y);
+  Display->pDrv->SetCursor(x, y);
+  if (Display->Controller == LCD_SIM_HX8347D)
+  {
+    /* Prepare to write GRAM */
+    LCD_IO_WriteReg(0x22);
+  }
+  LCD_IO_WriteMultipleData((uint8_t *)pPixels, (uint32_t)Count * 2U);
+}
+
+static void Bench_Rect(uint32_t Bulk, uint16_t Ln, uint16_t Pos, uint16_t Count, uint16_t Lines, uint16_t RGBCode)
+{
+  uint16_t x, y, l;
+
+  Bench_RefRect(Ln, Pos, Count, Lines, NULL, RGBCode);
+  if (Bulk != 0)
+  {
+    Bench_Coords(Ln, Pos, &x, &y);
+    Display->pDrv->FillRect(x, y, Count, Lines, RGBCode);
+    return;
+  }
+  for (l = 0; l < Count; l++)
+  {
+    Line[l] = RGBCode;
+  }
+  for (l = 0; l < Lines; l++)
+  {
+    Bench_FormerLine((uint16_t)(Ln + l), Pos, Line, Count);
+  }
+}
+
+static void Bench_Clear(uint32_t Bulk)
+{
+  Bench_Rect(Bulk, 0, 0, Display->LineLength, Display->Lines, 0x2945);
+}
+
+static void Bench_Rects(uint32_t Bulk)
+{
+  uint32_t r;
+
+  Seed = 7U;
+  for (r = 0; r < RECTS; r++)
+  {
+    uint16_t count = (uint16_t)(1U + Bench_Random(Display->LineLength / 2U));
+    uint16_t lines = (uint16_t)(1U + Bench_Random(Display->Lines / 2U));
+    uint16_t pos = (uint16_t)Bench_Random(Display->LineLength - count + 1U);
+    uint16_t ln = (uint16_t)Bench_Random(Display->Lines - lines + 1U);
+
+    Bench_Rect(Bulk, ln, pos, count, lines, (uint16_t)Bench_Random(0x10000U));
+  }
+}
+
+static void Bench_VLines(uint32_t Bulk)
+{
+  uint16_t pos, l, x, y;
+
+  for (pos = 0; pos < Display->LineLength; pos += 4U)
+  {
+    uint16_t color = (uint16_t)(0xF800U | pos);
+
+    Bench_RefRect(0, pos, 1, Display->Lines, NULL, color);
+    Bench_Coords(0, pos, &x, &y);
+    if (Bulk != 0)
+    {
+      Display->pDrv->DrawVLine(color, x, y, Display->Lines);
+      continue;
+    }
+    for (l = 0; l < Display->Lines; l++)
+    {
+      Bench_Coords(l, pos, &x, &y);
+      Display->pDrv->WritePixel(x, y, color);
+    }
+  }
+}
+
+static void Bench_Images(uint32_t Bulk)
+{
+  uint16_t n, l, x, y, ln, pos;
+
+  for (n = 0; n < 8U; n++)
+  {
+    ln = (uint16_t)((n * 37U) % (Display->Lines - IMAGE_SIZE + 1U));
+    pos = (uint16_t)((n * 29U) % (Display->LineLength - IMAGE_SIZE + 1U));
+    Bench_RefRect(ln, pos, IMAGE_SIZE, IMAGE_SIZE, Image, 0);
+    if (Bulk != 0)
+    {
+      Bench_Coords(ln, pos, &x, &y);
+      /* The last one from an odd address: copied through the line buffers */
+      Display->pDrv->DrawRGBImage(x, y, IMAGE_SIZE, IMAGE_SIZE,
+                                  (n == 7U) ? &OddImage[1] : (uint8_t *)Image);
+      continue;
+    }
+    for (l = 0; l < IMAGE_SIZE; l++)
+    {
+      Bench_FormerLine((uint16_t)(ln + l), pos, &Image[l * IMAGE_SIZE], IMAGE_SIZE);
+    }
+  }
+}
+
+static void Bench_Gradient(uint16_t Ln, uint16_t *pSpan, uint16_t Width)
+{
+  uint16_t i;
+
+  for (i = 0; i < Width; i++)
+  {
+    pSpan[i] = (uint16_t)((((i * 31U) / Width) << 11) | (((Ln * 63U) / Display->Lines) << 5) | ((i ^ Ln) & 0x1FU));
+  }
+}
+
+/* The span renderer, charged for its CPU time */
+static void Bench_RenderSpan(uint16_t Ln, uint16_t *pSpan, uint16_t Width)
+{
+  Bench_Gradient(Ln, pSpan, Width);
+  RenderTime += (Width + 7U) / 8U * SPAN_US_PER_8;
+  SIM_Busy((Width + 7U) / 8U * SPAN_US_PER_8);
+}
+
+static void Bench_Spans(uint32_t Bulk)
+{
+  uint16_t l;
+
+  for (l = 0; l < Display->Lines; l++)
+  {
+    Bench_Gradient(l, Line, Display->LineLength);
+    Bench_RefRect(l, 0, Display->LineLength, 1, Line, 0);
+  }
+  if (Bulk != 0)
+  {
+    Display->pDrv->DrawRGBSpans(0, 0, Display->LineLength, Display->Lines, Bench_RenderSpan);
+    return;
+  }
+  for (l = 0; l < Display->Lines; l++)
+  {
+    Bench_RenderSpan(l, Line, Display->LineLength);
+    Bench_FormerLine(l, 0, Line, Display->LineLength);
+  }
+}
+
+static const Bench_DisplayTypeDef Displays[2] =
+{
+  { "st7735",  LCD_SIM_ST7735,  &st7735_drv,  128, 160 },
+  { "hx8347d", LCD_SIM_HX8347D, &hx8347d_drv, 320, 240 },
+};
+
+static const Bench_SceneTypeDef Scenes[] =
+{
+  { "clear",  Bench_Clear },
+  { "rects",  Bench_Rects },
+  { "vlines", Bench_VLines },
+  { "image",  Bench_Images },
+  { "spans",  Bench_Spans },
+};
+
+static const char *OutDir;
+
+/* Draws a scene on a black display; 1 if the memory differs from the
+   reference */
+static int Bench_Run(const Bench_SceneTypeDef *pScene, uint32_t Bulk, uint64_t *pTime, double *pCpu, uint32_t *pPixels)
+{
+  LCD_SimStatsTypeDef stats;
+  const uint16_t *frame;
+  uint16_t w, h;
+  uint64_t t0;
+  char     path[512];
+
+  memset(Reference, 0, sizeof(Reference));
+  LCD_Sim_Clear();
+  t0 = SIM_Now();
+  RenderTime = 0;
+  pScene->Draw(Bulk);
+  LCD_IO_WaitDMA();
+  *pTime = SIM_Now() - t0;
+  LCD_Sim_GetStats(&stats);
+  *pCpu = 100.0 * (double)(stats.CpuTime + RenderTime) / (double)*pTime;
+  *pPixels = stats.Pixels;
+
+  frame = LCD_Sim_Frame(&w, &h);
+  if ((Bulk != 0) && (OutDir != NULL))
+  {
+    snprintf(path, sizeof(path), "%s/%s_%s.ppm", OutDir, Display->Name, pScene->Name);
+    if (LCD_Sim_WritePPM(path) != 0)
+    {
+      printf("%s: cannot write\n", path);
+    }
+  }
+  if ((memcmp(frame, Reference, (size_t)w * h * 2U) != 0) || (stats.Timeouts != 0))
+  {
+    printf("%s %s (%s): display memory differs from the reference\n", Display->Name, pScene->Name,
+           (Bulk != 0) ? "bulk" : "former");
+    return 1;
+  }
+  return 0;
+}
+
+static int Bench_Main(void)
+{
+  uint64_t former, bulk;
+  double   cpu_former, cpu_bulk;
+  uint32_t px_former, px_bulk;
+  size_t   d, s;
+  uint32_t i;
+  int      failed = 0;
+
+  for (i = 0; i < IMAGE_SIZE * IMAGE_SIZE; i++)
+  {
+    Image[i] = (uint16_t)(i * 0x9E37U);
+  }
+  memcpy(&OddImage[1], Image, sizeof(Image));
+
+  for (d = 0; d < 2; d++)
+  {
+    Display = &Displays[d];
+    SIM_Reset();
+    LCD_Sim_Reset(Display->Controller);
+    Display->pDrv->Init();
+    printf("%s %ux%u, SPI 12 MHz (%.0f pixels/s on the bus)\n", Display->Name,
+           (unsigned)Display->LineLength, (unsigned)Display->Lines, 12e6 / 16.0);
+    for (s = 0; s < sizeof(Scenes) / sizeof(Scenes[0]); s++)
+    {
+      failed |= Bench_Run(&Scenes[s], 0, &former, &cpu_former, &px_former);
+      failed |= Bench_Run(&Scenes[s], 1, &bulk, &cpu_bulk, &px_bulk);
+      printf("  %-7s %6u px  former %8.1f ms %7.0f px/s CPU %3.0f%%  bulk %7.1f ms %7.0f px/s CPU %3.0f%%  %5.1fx\n",
+             Scenes[s].Name, (unsigned)px_bulk,
+             former / 1000.0, px_former * 1e6 / (double)former, cpu_former,
+             bulk / 1000.0, px_bulk * 1e6 / (double)bulk, cpu_bulk, (double)former / (double)bulk);
+    }
+  }
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1)
+  {
+    OutDir = argv[1];
+  }
+  return SIM_Main(Bench_Main);
+}
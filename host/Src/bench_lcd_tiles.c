@@ -0,0 +1,316 @@
+/**
+  ******************************************************************************
+  * @file    bench_lcd_tiles.c
+  * @brief   Tile renderer on a live numeric dashboard: bytes sent per frame
+  *          against a whole screen redraw.
+  *
+  *          On the ST7735 and HX8347D display models, a dashboard of a title,
+  *          a status light and four labelled values (temperature, two rates,
+  *          uptime) is updated FRAMES times as telemetry at 10 Hz would: the
+  *          values move a little every frame, the light changes color with
+  *          the temperature. Each frame is one BSP_LCD_Refresh(); the bytes
+  *          on the bus (commands, window and pixels) and the bus time come
+  *          from the display model.
+  *
+  *          Every CHECK_EVERY frames and at the end, the display memory must
+  *          match a reference raster of the dashboard drawn here from
+  *          LCD_Font5x7, or the program exits with status 1. A last full
+  *          redraw through BSP_LCD_Invalidate() must match it as well.
+  *
+  *          The ST7735 runs a second time with a copy of its driver without
+  *          DrawRGBImage(), as spfd5408_drv is: the renderer must fall back
+  *          to WritePixel() and draw the same screen.
+  *
+  *          With a directory argument, the last screen of each display is
+  *          written there as <controller>_dashboard.ppm.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_lcd.h"
+#include "lcd_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FRAMES              600U
+#define CHECK_EVERY         50U
+#define VALUES              4U
+#define BACK_COLOR          0x0000U
+#define TEXT_COLOR          0xFFFFU
+#define LABEL_COLOR         0x07FFU
+#define PANEL_COLOR         0x18E3U
+
+extern LCD_DrvTypeDef st7735_drv;
+extern LCD_DrvTypeDef hx8347d_drv;
+
+typedef struct
+{
+  const char     *Name;
+  uint32_t        Controller;
+  LCD_DrvTypeDef *pDrv;
+  uint32_t        Orientation;
+  uint8_t         LabelScale;
+  uint8_t         ValueScale;
+} Bench_DisplayTypeDef;
+
+/* The dashboard as the reference raster draws it */
+typedef struct
+{
+  uint16_t X, Y, Width, Height;
+  uint16_t Color, BackColor;
+  uint8_t  Scale;              /* 0 for a rectangle */
+  uint8_t  Length;
+  char     Text[LCD_TEXT_MAX + 1U];
+  uint8_t  Element;
+} Bench_ElementTypeDef;
+
+/* st7735_drv without DrawRGBImage(), filled in by Bench_Main() */
+static LCD_DrvTypeDef Pixel_drv;
+
+static const Bench_DisplayTypeDef Displays[3] =
+{
+  { "st7735",  LCD_SIM_ST7735,  &st7735_drv,  LCD_ORIENTATION_XY, 1, 2 },
+  { "hx8347d", LCD_SIM_HX8347D, &hx8347d_drv, LCD_ORIENTATION_YX, 2, 3 },
+  { "pixel",   LCD_SIM_ST7735,  &Pixel_drv,   LCD_ORIENTATION_XY, 1, 2 },
+};
+
+static const char *const Labels[VALUES] = { "TEMP C", "RATE X DPS", "RATE Z DPS", "UPTIME S" };
+
+static Bench_ElementTypeDef Elements[LCD_ELEMENTS_MAX];
+static uint32_t             ElementCount;
+static uint16_t             Reference[320U * 240U];
+static uint32_t             Seed;
+
+static int32_t Bench_Random(int32_t Range)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return (int32_t)((Seed >> 8) % (uint32_t)(2 * Range + 1)) - Range;
+}
+
+static Bench_ElementTypeDef *Bench_AddRect(uint16_t X, uint16_t Y, uint16_t W, uint16_t H, uint16_t Color)
+{
+  Bench_ElementTypeDef *p = &Elements[ElementCount++];
+
+  memset(p, 0, sizeof(*p));
+  p->X = X;
+  p->Y = Y;
+  p->Width = W;
+  p->Height = H;
+  p->Color = Color;
+  p->Element = BSP_LCD_AddRect(X, Y, W, H, Color);
+  return p;
+}
+
+static Bench_ElementTypeDef *Bench_AddText(uint16_t X, uint16_t Y, uint8_t Length, uint8_t Scale, uint16_t Color,
+                                           uint16_t BackColor, const char *pText)
+{
+  Bench_ElementTypeDef *p = &Elements[ElementCount++];
+
+  memset(p, 0, sizeof(*p));
+  p->X = X;
+  p->Y = Y;
+  p->Width = (uint16_t)(Length * LCD_CELL_WIDTH * Scale);
+  p->Height = (uint16_t)(LCD_CELL_HEIGHT * Scale);
+  p->Color = Color;
+  p->BackColor = BackColor;
+  p->Scale = Scale;
+  p->Length = Length;
+  p->Element = BSP_LCD_AddText(X, Y, Length, Scale, Color, BackColor);
+  snprintf(p->Text, sizeof(p->Text), "%s", pText);
+  BSP_LCD_SetText(p->Element, pText);
+  return p;
+}
+
+static void Bench_SetText(Bench_ElementTypeDef *p, const char *pText)
+{
+  snprintf(p->Text, sizeof(p->Text), "%s", pText);
+  BSP_LCD_SetText(p->Element, pText);
+}
+
+/* Whole screen, pixel by pixel from the font bits */
+static void Bench_Reference(uint16_t Width, uint16_t Height)
+{
+  const Bench_ElementTypeDef *p;
+  uint32_t e, x, y, i;
+
+  for (i = 0; i < (uint32_t)Width * Height; i++)
+  {
+    Reference[i] = BACK_COLOR;
+  }
+  for (e = 0; e < ElementCount; e++)
+  {
+    p = &Elements[e];
+    for (y = 0; y < p->Height; y++)
+    {
+      for (x = 0; x < p->Width; x++)
+      {
+        uint16_t color = p->Color;
+
+        if (p->Scale != 0)
+        {
+          uint32_t cell = x / (LCD_CELL_WIDTH * p->Scale);
+          uint32_t fx = (x / p->Scale) % LCD_CELL_WIDTH, fy = y / p->Scale;
+          char     c = (cell < strlen(p->Text)) ? p->Text[cell] : ' ';
+          uint8_t  bits = (fy < LCD_FONT_HEIGHT) ? LCD_Font5x7[(c - LCD_FONT_FIRST) * LCD_FONT_HEIGHT + fy] : 0U;
+
+          color = ((fx < LCD_FONT_WIDTH) && ((bits & (0x10U >> fx)) != 0)) ? p->Color : p->BackColor;
+        }
+        Reference[(p->Y + y) * Width + p->X + x] = color;
+      }
+    }
+  }
+}
+
+static int Bench_Check(const char *pName, uint32_t Frame)
+{
+  const uint16_t *frame;
+  uint16_t w, h;
+
+  frame = LCD_Sim_Frame(&w, &h);
+  Bench_Reference(w, h);
+  if (memcmp(frame, Reference, (size_t)w * h * 2U) != 0)
+  {
+    printf("%s frame %u: display memory differs from the reference\n", pName, (unsigned)Frame);
+    return 1;
+  }
+  return 0;
+}
+
+static uint64_t Bench_Bytes(void)
+{
+  LCD_SimStatsTypeDef stats;
+
+  LCD_Sim_GetStats(&stats);
+  return (uint64_t)stats.Commands + stats.DataBytes;
+}
+
+static int Bench_Display(const Bench_DisplayTypeDef *pDisplay, const char *pOutDir)
+{
+  Bench_ElementTypeDef *values[VALUES], *light;
+  LCD_StatsTypeDef stats;
+  uint16_t w, h, y, label_h, value_h, row_h;
+  uint64_t bytes, t0, first = 0, total = 0, max = 0, time = 0;
+  uint32_t areas = 0;
+  double   temp = 23.40, rate_x = 0.0, rate_z = 0.0;
+  char     text[LCD_TEXT_MAX + 1U], path[512];
+  uint32_t f, v;
+  int      failed = 0;
+
+  SIM_Reset();
+  LCD_Sim_Reset(pDisplay->Controller);
+  ElementCount = 0;
+  Seed = 99U;
+  if (BSP_LCD_Init(pDisplay->pDrv, pDisplay->Orientation, BACK_COLOR) != LCD_OK)
+  {
+    printf("%s: init failed\n", pDisplay->Name);
+    return 1;
+  }
+  LCD_Sim_Frame(&w, &h);
+  LCD_Sim_Clear();
+
+  /* Title, status light, then a label and a value per row */
+  label_h = (uint16_t)(LCD_CELL_HEIGHT * pDisplay->LabelScale);
+  value_h = (uint16_t)(LCD_CELL_HEIGHT * pDisplay->ValueScale);
+  row_h = (uint16_t)(label_h + 2U + value_h + 4U);
+  Bench_AddText(4, 4, 9, pDisplay->LabelScale, TEXT_COLOR, BACK_COLOR, "TELEMETRY");
+  light = Bench_AddRect((uint16_t)(w - 4U - 2U * label_h), 4, (uint16_t)(2U * label_h), label_h, 0x07E0);
+  y = (uint16_t)(4U + label_h + 4U);
+  for (v = 0; v < VALUES; v++)
+  {
+    Bench_AddRect(0, y, w, (uint16_t)(row_h - 2U), PANEL_COLOR);
+    Bench_AddText(4, (uint16_t)(y + 1U), (uint8_t)strlen(Labels[v]), pDisplay->LabelScale, LABEL_COLOR, PANEL_COLOR, Labels[v]);
+    values[v] = Bench_AddText(4, (uint16_t)(y + 1U + label_h + 2U), 8, pDisplay->ValueScale, TEXT_COLOR, PANEL_COLOR, "");
+    y = (uint16_t)(y + row_h);
+  }
+
+  for (f = 0; f <= FRAMES; f++)
+  {
+    /* Telemetry at 10 Hz */
+    temp += Bench_Random(3) * 0.01;
+    rate_x += Bench_Random(8) * 0.1 - rate_x * 0.05;
+    rate_z = (f % 100U < 20U) ? 45.0 + Bench_Random(5) * 0.1 : Bench_Random(3) * 0.1;
+    snprintf(text, sizeof(text), "%+7.2f", temp);
+    Bench_SetText(values[0], text);
+    snprintf(text, sizeof(text), "%+7.1f", rate_x);
+    Bench_SetText(values[1], text);
+    snprintf(text, sizeof(text), "%+7.1f", rate_z);
+    Bench_SetText(values[2], text);
+    snprintf(text, sizeof(text), "%8.1f", f * 0.1);
+    Bench_SetText(values[3], text);
+    light->Color = (temp > 23.5) ? 0xF800U : ((temp > 23.3) ? 0xFFE0U : 0x07E0U);
+    BSP_LCD_SetRectColor(light->Element, light->Color);
+
+    bytes = Bench_Bytes();
+    BSP_LCD_GetStats(&stats);
+    areas -= (f != 0) ? stats.Areas : 0U;
+    t0 = SIM_Now();
+    BSP_LCD_Refresh();
+    LCD_IO_WaitDMA();
+    bytes = Bench_Bytes() - bytes;
+    BSP_LCD_GetStats(&stats);
+    areas += (f != 0) ? stats.Areas : 0U;
+    if (f == 0)
+    {
+      /* The whole dashboard, the screen cleared */
+      first = bytes;
+    }
+    else
+    {
+      total += bytes;
+      max = (bytes > max) ? bytes : max;
+      time += SIM_Now() - t0;
+    }
+    if ((f % CHECK_EVERY) == 0)
+    {
+      failed |= Bench_Check(pDisplay->Name, f);
+    }
+  }
+
+  /* Everything again, as after a display wake-up */
+  BSP_LCD_Invalidate(0, 0, w, h);
+  LCD_Sim_Clear();
+  BSP_LCD_Refresh();
+  LCD_IO_WaitDMA();
+  failed |= Bench_Check(pDisplay->Name, FRAMES + 1U);
+  if (pOutDir != NULL)
+  {
+    snprintf(path, sizeof(path), "%s/%s_dashboard.ppm", pOutDir, pDisplay->Name);
+    if (LCD_Sim_WritePPM(path) != 0)
+    {
+      printf("%s: cannot write\n", path);
+    }
+  }
+
+  BSP_LCD_GetStats(&stats);
+  printf("%-7s %ux%u  whole screen %6u bytes  first frame %6u bytes\n", pDisplay->Name, (unsigned)w, (unsigned)h,
+         (unsigned)(w * h * 2U), (unsigned)first);
+  printf("        per frame %6.0f bytes average, %u max (%.1f%% of the screen)  %.2f ms on the bus (%.1f ms whole)\n",
+         (double)total / FRAMES, (unsigned)max, 100.0 * total / FRAMES / (w * h * 2.0),
+         time / 1000.0 / FRAMES, LCD_SIM_BUS_US(w * h * 2U) / 1000.0);
+  printf("        %.1f areas per frame  glyph cache %u hits %u misses (%.1f%% hits)\n",
+         (double)areas / FRAMES, (unsigned)stats.GlyphHits, (unsigned)stats.GlyphMisses,
+         100.0 * stats.GlyphHits / (stats.GlyphHits + stats.GlyphMisses));
+  return failed;
+}
+
+static const char *OutDir;
+
+static int Bench_Main(void)
+{
+  int failed = 0;
+
+  failed |= Bench_Display(&Displays[0], OutDir);
+  failed |= Bench_Display(&Displays[1], OutDir);
+  Pixel_drv = st7735_drv;
+  Pixel_drv.DrawRGBImage = NULL;
+  failed |= Bench_Display(&Displays[2], OutDir);
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1)
+  {
+    OutDir = argv[1];
+  }
+  return SIM_Main(Bench_Main);
+}
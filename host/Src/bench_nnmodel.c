@@ -0,0 +1,409 @@
+/**
+  ******************************************************************************
+  * @file    bench_nnmodel.c
+  * @brief   The cifar10 example network as a model image
+  *          (tools/nn_model.py) run by stm32f072b_discovery_nnmodel.c,
+  *          against the same CMSIS-NN calls made directly, and its latency.
+  *
+  *          Usage: bench_nnmodel [--vectors image.nnm]
+  *          Prints the scores of the image with ip1 in q7 and in 4 bits,
+  *          the time of each op and of a whole inference on the host, from
+  *          the image and by direct calls, and the images the runtime must
+  *          reject. Exits with status 1 if the q7 image gives other scores
+  *          than the direct calls, the 4-bit one another class, or a broken
+  *          image is accepted. --vectors runs a model image file instead
+  *          (an arena as large as that of cifar10), on the example input,
+  *          and prints the input and the output of every op, for
+  *          tools/nn_model_m0.py.
+  *
+  ==============================================================================
+                          ##### Notes #####
+  ==============================================================================
+  *  Both images are converted at build time (cmake/nn_model.cmake) from
+  *  cmake/nn_cifar10.json and the weights header of the example; the
+  *  direct calls are those of arm_nnexamples_cifar10.cpp, on a buffer per
+  *  tensor. The input is scaled as the example does it, into the input
+  *  tensor of the arena, before every run: the image leaves that to the
+  *  application. The times are the fastest of NNMODEL_BENCH_RUNS runs.
+  *
+  *  The broken images are copies of the q7 one in RAM, each with one field
+  *  changed and the checksum made right again (but for the checksum case
+  *  itself), so that BSP_NNMODEL_Init() has to find the field. Cortex-M0
+  *  cycles are those of tools/nn_model_m0.py (nn_model_m0.md).
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_nnmodel.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "arm_nnexamples_cifar10_parameter.h"
+#include "arm_nnexamples_cifar10_weights.h"
+#include "arm_nnexamples_cifar10_inputs.h"
+#include "bench_nnmodel_cifar10_model.h"
+#include "bench_nnmodel_cifar10_q4_model.h"
+
+#define NNMODEL_BENCH_RUNS  10U
+#define CIFAR10_CLASS       8U         /* of the example image, in q7 */
+
+static const uint8_t Model[CIFAR10_MODEL_SIZE] __attribute__((aligned(4))) = CIFAR10_MODEL;
+static const uint8_t ModelQ4[CIFAR10_Q4_MODEL_SIZE] __attribute__((aligned(4))) = CIFAR10_Q4_MODEL;
+static q7_t          Arena[CIFAR10_MODEL_ARENA_SIZE] __attribute__((aligned(4)));
+/* Image files of --vectors, as large as the flash */
+static uint8_t       File[128U * 1024U] __attribute__((aligned(4)));
+/* Broken copies (Bench_Break()), one word more for the misaligned one */
+static uint8_t       Copy[CIFAR10_MODEL_SIZE + 4U] __attribute__((aligned(4)));
+
+/* The direct calls, a buffer each */
+static const q7_t    Conv1Wt[CONV1_IM_CH * CONV1_KER_DIM * CONV1_KER_DIM * CONV1_OUT_CH] = CONV1_WT;
+static const q7_t    Conv1Bias[CONV1_OUT_CH] = CONV1_BIAS;
+static const q7_t    Conv2Wt[CONV2_IM_CH * CONV2_KER_DIM * CONV2_KER_DIM * CONV2_OUT_CH] = CONV2_WT;
+static const q7_t    Conv2Bias[CONV2_OUT_CH] = CONV2_BIAS;
+static const q7_t    Conv3Wt[CONV3_IM_CH * CONV3_KER_DIM * CONV3_KER_DIM * CONV3_OUT_CH] = CONV3_WT;
+static const q7_t    Conv3Bias[CONV3_OUT_CH] = CONV3_BIAS;
+static const q7_t    Ip1Wt[IP1_DIM * IP1_OUT] = IP1_WT;
+static const q7_t    Ip1Bias[IP1_OUT] = IP1_BIAS;
+static const uint8_t Image[CONV1_IM_CH * CONV1_IM_DIM * CONV1_IM_DIM] = IMG_DATA;
+
+static q7_t  Data[CONV1_IM_CH * CONV1_IM_DIM * CONV1_IM_DIM];
+static q7_t  Conv1[CONV1_OUT_CH * CONV1_OUT_DIM * CONV1_OUT_DIM];
+static q7_t  Pool1[CONV1_OUT_CH * POOL1_OUT_DIM * POOL1_OUT_DIM];
+static q7_t  Conv2[CONV2_OUT_CH * CONV2_OUT_DIM * CONV2_OUT_DIM];
+static q7_t  Pool2[CONV2_OUT_CH * POOL2_OUT_DIM * POOL2_OUT_DIM];
+static q7_t  Conv3[CONV3_OUT_CH * CONV3_OUT_DIM * CONV3_OUT_DIM];
+static q7_t  Pool3[CONV3_OUT_CH * POOL3_OUT_DIM * POOL3_OUT_DIM];
+static q7_t  Ip1[IP1_OUT];
+static q7_t  Prob[IP1_OUT];
+static q15_t Scratch[2 * CONV2_IM_CH * CONV2_KER_DIM * CONV2_KER_DIM];
+
+/* Images BSP_NNMODEL_Init() must reject, made by Bench_Break() */
+static const char *const Broken[] =
+{
+  "weight byte changed", "unknown op code", "conv1 as conv fast", "pool1 output on input",
+  "conv2 output too wide", "ip1 weights past end", "relu1 not in place", "arena a word short",
+  "image a byte short", "image misaligned"
+};
+
+static double Bench_Seconds(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* NNMODEL_Checksum() as the format defines it: Fletcher-32 by blocks of 2048
+   bytes, reduced by end-around carry */
+static uint32_t Bench_Checksum(const uint8_t *pData, uint32_t Size)
+{
+  uint32_t a = 0U, b = 0U, i;
+
+  for (i = 0U; i < Size; i++)
+  {
+    a += pData[i];
+    b += a;
+    if ((((i + 1U) % 2048U) == 0U) || (i + 1U == Size))
+    {
+      a = (a & 0xFFFFU) + (a >> 16);
+      b = (b & 0xFFFFU) + (b >> 16);
+    }
+  }
+  a = (a & 0xFFFFU) + (a >> 16);
+  b = (b & 0xFFFFU) + (b >> 16);
+  return (b << 16) | a;
+}
+
+/* The example image, scaled as arm_nnexamples_cifar10.cpp does */
+static void Bench_Input(q7_t *pData)
+{
+  static const int          mean[3] = INPUT_MEAN_SHIFT;
+  static const unsigned int scale[3] = INPUT_RIGHT_SHIFT;
+  uint32_t i;
+
+  for (i = 0; i < 32U * 32U * 3U; i++)
+  {
+    pData[i] = (q7_t)__SSAT((((int)Image[i] - mean[i % 3U]) * 128 + (1 << (scale[i % 3U] - 1U)))
+                            >> scale[i % 3U], 8);
+  }
+}
+
+/* arm_nnexamples_cifar10.cpp, the scores after softmax in Prob */
+static void Bench_Direct(void)
+{
+  arm_convolve_HWC_q7_RGB(Data, CONV1_IM_DIM, CONV1_IM_CH, Conv1Wt, CONV1_OUT_CH, CONV1_KER_DIM,
+                          CONV1_PADDING, CONV1_STRIDE, Conv1Bias, CONV1_BIAS_LSHIFT, CONV1_OUT_RSHIFT,
+                          Conv1, CONV1_OUT_DIM, Scratch, NULL);
+  arm_relu_q7(Conv1, CONV1_OUT_DIM * CONV1_OUT_DIM * CONV1_OUT_CH);
+  arm_maxpool_q7_HWC(Conv1, CONV1_OUT_DIM, CONV1_OUT_CH, POOL1_KER_DIM, POOL1_PADDING, POOL1_STRIDE,
+                     POOL1_OUT_DIM, NULL, Pool1);
+  arm_convolve_HWC_q7_fast(Pool1, CONV2_IM_DIM, CONV2_IM_CH, Conv2Wt, CONV2_OUT_CH, CONV2_KER_DIM,
+                           CONV2_PADDING, CONV2_STRIDE, Conv2Bias, CONV2_BIAS_LSHIFT, CONV2_OUT_RSHIFT,
+                           Conv2, CONV2_OUT_DIM, Scratch, NULL);
+  arm_relu_q7(Conv2, CONV2_OUT_DIM * CONV2_OUT_DIM * CONV2_OUT_CH);
+  arm_maxpool_q7_HWC(Conv2, CONV2_OUT_DIM, CONV2_OUT_CH, POOL2_KER_DIM, POOL2_PADDING, POOL2_STRIDE,
+                     POOL2_OUT_DIM, NULL, Pool2);
+  arm_convolve_HWC_q7_fast(Pool2, CONV3_IM_DIM, CONV3_IM_CH, Conv3Wt, CONV3_OUT_CH, CONV3_KER_DIM,
+                           CONV3_PADDING, CONV3_STRIDE, Conv3Bias, CONV3_BIAS_LSHIFT, CONV3_OUT_RSHIFT,
+                           Conv3, CONV3_OUT_DIM, Scratch, NULL);
+  arm_relu_q7(Conv3, CONV3_OUT_DIM * CONV3_OUT_DIM * CONV3_OUT_CH);
+  arm_maxpool_q7_HWC(Conv3, CONV3_OUT_DIM, CONV3_OUT_CH, POOL3_KER_DIM, POOL3_PADDING, POOL3_STRIDE,
+                     POOL3_OUT_DIM, NULL, Pool3);
+  arm_fully_connected_q7_opt(Pool3, Ip1Wt, IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT, IP1_OUT_RSHIFT, Ip1Bias, Ip1,
+                             Scratch);
+  arm_softmax_q7(Ip1, IP1_OUT, Prob);
+}
+
+static uint32_t Bench_Class(const q7_t *pScores, uint32_t Count)
+{
+  uint32_t i, best = 0U;
+
+  for (i = 1U; i < Count; i++)
+  {
+    if (pScores[i] > pScores[best])
+    {
+      best = i;
+    }
+  }
+  return best;
+}
+
+static void Bench_PrintScores(const char *pName, const q7_t *pScores, uint32_t Count)
+{
+  uint32_t i;
+
+  printf("%-22s", pName);
+  for (i = 0U; i < Count; i++)
+  {
+    printf(" %4d", pScores[i]);
+  }
+  printf("   class %u\n", (unsigned)Bench_Class(pScores, Count));
+}
+
+static uint32_t Bench_OutputSize(const NNMODEL_OpTypeDef *pOp)
+{
+  return (uint32_t)pOp->OutDim * pOp->OutDim * pOp->OutCh;
+}
+
+/* A copy of the q7 image in Copy with one thing changed, and the checksum
+   made right again but for the first case: the address to open, with the
+   image and arena sizes to give */
+static const uint8_t *Bench_Break(uint32_t Case, uint32_t *pSize, uint32_t *pArenaSize)
+{
+  NNMODEL_HeaderTypeDef *header = (NNMODEL_HeaderTypeDef *)Copy;
+  NNMODEL_OpTypeDef     *ops;
+
+  memcpy(Copy, Model, sizeof(Model));
+  ops = (NNMODEL_OpTypeDef *)(Copy + header->OpOffset);
+  *pSize = sizeof(Model);
+  *pArenaSize = sizeof(Arena);
+  /* Ops of the image: 0 conv1, 1 relu1, 2 pool1, 3 conv2, 9 ip1 */
+  switch (Case)
+  {
+    case 0:
+      Copy[sizeof(Model) - 1U] ^= 0x55U;
+      return Copy;
+    case 1:
+      ops[0].Code = NNMODEL_OP_COUNT;
+      break;
+    case 2:
+      ops[0].Code = NNMODEL_OP_CONV_FAST;     /* 3 input channels */
+      break;
+    case 3:
+      ops[2].Output = ops[2].Input;
+      break;
+    case 4:
+      ops[3].OutDim++;
+      break;
+    case 5:
+      ops[9].Weights = header->Size - 16U;
+      break;
+    case 6:
+      ops[1].Output = ops[2].Output;
+      break;
+    case 7:
+      *pArenaSize -= 4U;
+      break;
+    case 8:
+      *pSize -= 1U;
+      break;
+    default:
+      memmove(Copy + 2U, Copy, sizeof(Model));
+      return Copy + 2U;
+  }
+  header->Checksum = Bench_Checksum(Copy + sizeof(NNMODEL_HeaderTypeDef),
+                                    header->Size - sizeof(NNMODEL_HeaderTypeDef));
+  return Copy;
+}
+
+/* One run of the image file at pPath op by op, for tools/nn_model_m0.py */
+static int Bench_Vectors(const char *pPath)
+{
+  NNMODEL_HandleTypeDef model;
+  uint32_t              i, k, n;
+  q7_t                 *p;
+  FILE                 *f = fopen(pPath, "rb");
+
+  if (f == NULL)
+  {
+    perror(pPath);
+    return 2;
+  }
+  n = (uint32_t)fread(File, 1U, sizeof(File), f);
+  fclose(f);
+  if (BSP_NNMODEL_Init(&model, File, n, Arena, sizeof(Arena)) != NNMODEL_OK)
+  {
+    fprintf(stderr, "%s: model image rejected\n", pPath);
+    return 1;
+  }
+  p = BSP_NNMODEL_GetInput(&model, &n);
+  Bench_Input(p);
+  printf("input");
+  for (k = 0U; k < n; k++)
+  {
+    printf(" %d", p[k]);
+  }
+  printf("\n");
+  for (i = 0U; i < model.pHeader->OpCount; i++)
+  {
+    if (BSP_NNMODEL_RunOp(&model, i) != NNMODEL_OK)
+    {
+      fprintf(stderr, "op %u failed\n", (unsigned)i);
+      return 1;
+    }
+    p = &Arena[model.pOps[i].Output];
+    printf("op %u", (unsigned)i);
+    for (k = 0U; k < Bench_OutputSize(&model.pOps[i]); k++)
+    {
+      printf(" %d", p[k]);
+    }
+    printf("\n");
+  }
+  return 0;
+}
+
+/* Runs the model NNMODEL_BENCH_RUNS times: the fastest whole run, and the
+   fastest run of each op into pOpTimes; the scores into pScores */
+static double Bench_Model(const NNMODEL_HandleTypeDef *pModel, double *pOpTimes, q7_t *pScores)
+{
+  double   best = 1e9, t;
+  uint32_t r, i, n;
+  q7_t    *output;
+
+  for (i = 0U; i < pModel->pHeader->OpCount; i++)
+  {
+    pOpTimes[i] = 1e9;
+  }
+  for (r = 0U; r < NNMODEL_BENCH_RUNS; r++)
+  {
+    Bench_Input(BSP_NNMODEL_GetInput(pModel, NULL));
+    t = Bench_Seconds();
+    (void)BSP_NNMODEL_Run(pModel);
+    t = Bench_Seconds() - t;
+    best = (t < best) ? t : best;
+
+    Bench_Input(BSP_NNMODEL_GetInput(pModel, NULL));
+    for (i = 0U; i < pModel->pHeader->OpCount; i++)
+    {
+      t = Bench_Seconds();
+      (void)BSP_NNMODEL_RunOp(pModel, i);
+      t = Bench_Seconds() - t;
+      pOpTimes[i] = (t < pOpTimes[i]) ? t : pOpTimes[i];
+    }
+  }
+  output = BSP_NNMODEL_GetOutput(pModel, &n);
+  memcpy(pScores, output, n);
+  return best;
+}
+
+int main(int argc, char **argv)
+{
+  static const char *names[NNMODEL_OP_COUNT] =
+  {
+    "conv basic", "conv fast", "conv RGB", "depthwise", "maxpool", "avepool", "relu", "softmax",
+    "fc", "fc opt", "fc q4"
+  };
+  NNMODEL_HandleTypeDef model, modelQ4;
+  double   opTimes[16], opTimesQ4[16], direct = 1e9, run, runQ4, t, init;
+  q7_t     scores[IP1_OUT], scoresQ4[IP1_OUT];
+  uint32_t i, k, size, arenaSize;
+  const uint8_t *image;
+  int      failed = 0;
+  uint8_t  status;
+
+  if ((argc == 3) && (strcmp(argv[1], "--vectors") == 0))
+  {
+    return Bench_Vectors(argv[2]);
+  }
+  else if (argc >= 2)
+  {
+    printf("usage: %s [--vectors image.nnm]\n", argv[0]);
+    return 2;
+  }
+
+  t = Bench_Seconds();
+  status = BSP_NNMODEL_Init(&model, Model, sizeof(Model), Arena, sizeof(Arena));
+  init = Bench_Seconds() - t;
+  if ((status != NNMODEL_OK) || (BSP_NNMODEL_Init(&modelQ4, ModelQ4, sizeof(ModelQ4), Arena, sizeof(Arena))
+                                 != NNMODEL_OK) || (model.pHeader->OpCount > 16U))
+  {
+    printf("cifar10 model images rejected\n");
+    return 1;
+  }
+  for (i = 0U; i < NNMODEL_BENCH_RUNS; i++)
+  {
+    Bench_Input(Data);
+    t = Bench_Seconds();
+    Bench_Direct();
+    t = Bench_Seconds() - t;
+    direct = (t < direct) ? t : direct;
+  }
+  run = Bench_Model(&model, opTimes, scores);
+  runQ4 = Bench_Model(&modelQ4, opTimesQ4, scoresQ4);
+
+  failed |= (memcmp(scores, Prob, IP1_OUT) != 0);
+  failed |= (Bench_Class(scoresQ4, IP1_OUT) != CIFAR10_CLASS) || (Bench_Class(scores, IP1_OUT) != CIFAR10_CLASS);
+  printf("cifar10 image: %u bytes, %u ops, arena %u bytes; ip1 in 4 bits: %u bytes\n",
+         (unsigned)sizeof(Model), (unsigned)model.pHeader->OpCount, (unsigned)model.pHeader->ArenaSize,
+         (unsigned)sizeof(ModelQ4));
+  Bench_PrintScores("direct calls", Prob, IP1_OUT);
+  Bench_PrintScores("image", scores, IP1_OUT);
+  Bench_PrintScores("image, ip1 in 4 bits", scoresQ4, IP1_OUT);
+
+  printf("\n%-3s %-12s %-10s %-10s %10s %10s\n", "op", "kernel", "in", "out", "host us", "4-bit us");
+  for (i = 0U; i < model.pHeader->OpCount; i++)
+  {
+    const NNMODEL_OpTypeDef *op = &model.pOps[i];
+    char in[24], out[24];
+
+    snprintf(in, sizeof(in), "%ux%ux%u", op->InDim, op->InDim, op->InCh);
+    snprintf(out, sizeof(out), "%ux%ux%u", op->OutDim, op->OutDim, op->OutCh);
+    printf("%-3u %-12s %-10s %-10s %10.1f %10.1f\n", (unsigned)i, names[op->Code], in, out, opTimes[i] * 1e6,
+           opTimesQ4[i] * 1e6);
+  }
+  printf("inference: %.1f us from the image (%.1f with ip1 in 4 bits), %.1f by direct calls: %+.2f %%; "
+         "BSP_NNMODEL_Init() %.1f us\n", run * 1e6, runQ4 * 1e6, direct * 1e6, (run - direct) * 100.0 / direct,
+         init * 1e6);
+
+  /* The images the runtime must reject */
+  printf("\nbroken images:\n");
+  for (k = 0U; k < sizeof(Broken) / sizeof(Broken[0]); k++)
+  {
+    image = Bench_Break(k, &size, &arenaSize);
+    status = BSP_NNMODEL_Init(&model, image, size, Arena, arenaSize);
+    printf("  %-24s %s\n", Broken[k], (status == NNMODEL_ERROR) ? "rejected" : "ACCEPTED");
+    failed |= (status != NNMODEL_ERROR);
+  }
+  /* and the intact copy accepted, its checksum the one made here */
+  memcpy(Copy, Model, sizeof(Model));
+  status = BSP_NNMODEL_Init(&model, Copy, sizeof(Model), Arena, sizeof(Arena));
+  if (Bench_Checksum(Copy + sizeof(NNMODEL_HeaderTypeDef), sizeof(Model) - sizeof(NNMODEL_HeaderTypeDef))
+      != ((const NNMODEL_HeaderTypeDef *)Copy)->Checksum)
+  {
+    status = NNMODEL_ERROR;
+  }
+  printf("  %-24s %s\n", "intact copy", (status == NNMODEL_OK) ? "accepted" : "REJECTED");
+  failed |= (status != NNMODEL_OK);
+
+  printf("%s\n", (failed != 0) ? "MISMATCH" : "identical to the direct calls");
+  return failed;
+}
@@ -0,0 +1,287 @@
+/**
+  ******************************************************************************
+  * @file    bench_orientation.c
+  * @brief   Orientation filter replay: drift and attitude error on gyroscope
+  *          traces, and the cost per sample against the output data rate.
+  *
+  *          Without arguments, synthetic L3GD20 traces at 760 Hz, 500 dps
+  *          full scale, are made from known angular rates: each raw value
+  *          adds a rate offset and noise to the true rate, and the true
+  *          attitude integrates the true rate in double precision. Every
+  *          trace starts still for the calibration:
+  *           - still: 60 s, the offset drifting by 8 LSB as when warming;
+  *           - turns: 90 degree turns about each axis, then back;
+  *           - tumble: 20 s of rates up to 200 dps on all axes at once.
+  *          The samples go through BSP_ORIENT_Update() in FIFO bursts of
+  *          BURST samples and the attitude is read back through
+  *          BSP_ORIENT_GetAttitude(). An error or a drift beyond the limits
+  *          makes the program exit with status 1.
+  *
+  *          With a file argument, the file is replayed instead: raw X, Y, Z
+  *          int16 little endian per sample, as the stream callback gets them,
+  *          recorded at 760 Hz and 500 dps with the board still at the start.
+  *          The final attitude and the rate offset are printed.
+  *
+  *          No Cortex-M0 runs here: the cycles per sample come from the
+  *          instruction sequences of the filter (CYCLES_* below, the 32x32
+  *          to 64-bit products through libgcc __aeabi_lmul).
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_orientation.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ODR_HZ              760U
+#define ODR_MAX_HZ          800U       /* I3G4250D; 760 Hz for the L3GD20 */
+#define SENSITIVITY_UDPS    17500U
+#define BURST               28U
+#define CPU_MHZ             48U
+
+/* Estimated Cortex-M0 cycles, calls, loads and stores included */
+#define CYCLES_LMUL         40U        /* __aeabi_lmul, signed 32x32 */
+#define CYCLES_ROTATE       (19U * CYCLES_LMUL + 60U)
+#define CYCLES_AXIS         (3U + 5U + 5U + 4U + 12U + CYCLES_LMUL + 10U)
+#define CYCLES_SAMPLE       (CYCLES_ROTATE + 3U * CYCLES_AXIS + 6U)
+/* Per burst: 3 x (mean division and five calls), renormalization, publish */
+#define CYCLES_BURST        (3U * (150U + 30U) + 8U * CYCLES_LMUL + 100U)
+
+#define STILL_DRIFT_MAX     0.5        /* degrees per minute */
+#define ERROR_MAX           1.0        /* degrees */
+
+typedef struct
+{
+  const char *Name;
+  double      Seconds;
+  void      (*Rate)(double t, double *pDps);
+  double      BiasDrift;               /* LSB over the trace */
+} Bench_TraceTypeDef;
+
+static uint32_t Seed;
+
+/* Zero mean, unit variance, from four uniforms */
+static double Bench_Noise(void)
+{
+  double sum = 0;
+  int    i;
+
+  for (i = 0; i < 4; i++)
+  {
+    Seed = Seed * 1664525U + 1013904223U;
+    sum += (Seed >> 8) / 16777216.0;
+  }
+  return (sum - 2.0) * sqrt(3.0);
+}
+
+static void Bench_RateStill(double t, double *pDps)
+{
+  (void)t;
+  pDps[0] = pDps[1] = pDps[2] = 0;
+}
+
+/* After 2 s, 90 degrees at 180 dps about X, Y, Z, then back, 1 s apart */
+static void Bench_RateTurns(double t, double *pDps)
+{
+  int step = (int)floor(t - 2.0);
+
+  pDps[0] = pDps[1] = pDps[2] = 0;
+  if ((t >= 2.0) && (step < 6) && ((t - 2.0 - step) < 0.5))
+  {
+    pDps[step % 3] = (step < 3) ? 180.0 : -180.0;
+  }
+}
+
+static void Bench_RateTumble(double t, double *pDps)
+{
+  double u = t - 2.0;
+
+  pDps[0] = pDps[1] = pDps[2] = 0;
+  if ((u >= 0) && (u < 20.0))
+  {
+    pDps[0] = 200.0 * sin(2.0 * M_PI * 0.3 * u);
+    pDps[1] = 150.0 * sin(2.0 * M_PI * 0.7 * u);
+    pDps[2] = 100.0 * sin(2.0 * M_PI * 1.1 * u);
+  }
+}
+
+static const Bench_TraceTypeDef Traces[] =
+{
+  { "still",  60.0, Bench_RateStill,  8.0 },
+  { "turns",  10.0, Bench_RateTurns,  0.0 },
+  { "tumble", 24.0, Bench_RateTumble, 0.0 },
+};
+
+/* p = p * (cos |h|, sin |h| h / |h|), h the half rotation in rad */
+static void Bench_Rotate(double *p, const double *h)
+{
+  double a = sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]);
+  double r[4], q[4];
+
+  r[0] = cos(a);
+  r[1] = (a > 0) ? h[0] * sin(a) / a : 0;
+  r[2] = (a > 0) ? h[1] * sin(a) / a : 0;
+  r[3] = (a > 0) ? h[2] * sin(a) / a : 0;
+  q[0] = p[0] * r[0] - p[1] * r[1] - p[2] * r[2] - p[3] * r[3];
+  q[1] = p[0] * r[1] + p[1] * r[0] + p[2] * r[3] - p[3] * r[2];
+  q[2] = p[0] * r[2] - p[1] * r[3] + p[2] * r[0] + p[3] * r[1];
+  q[3] = p[0] * r[3] + p[1] * r[2] - p[2] * r[1] + p[3] * r[0];
+  p[0] = q[0];
+  p[1] = q[1];
+  p[2] = q[2];
+  p[3] = q[3];
+}
+
+/* Angle between the filter attitude and p, in degrees */
+static double Bench_Error(const ORIENT_AttitudeTypeDef *pAtt, const double *p)
+{
+  double w = pAtt->W / 32768.0, x = pAtt->X / 32768.0, y = pAtt->Y / 32768.0, z = pAtt->Z / 32768.0;
+  double n = sqrt(w * w + x * x + y * y + z * z);
+  double dot = fabs(w * p[0] + x * p[1] + y * p[2] + z * p[3]) / n;
+
+  return 2.0 * acos((dot > 1.0) ? 1.0 : dot) * 180.0 / M_PI;
+}
+
+static double Bench_Seconds(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int Bench_Trace(const Bench_TraceTypeDef *pTrace, double *pNs)
+{
+  ORIENT_AttitudeTypeDef att;
+  const double bias0[3] = { 12.0, -7.0, 5.0 };
+  const double lsb = SENSITIVITY_UDPS * 1e-6;
+  uint32_t n, total = (uint32_t)(pTrace->Seconds * ODR_HZ);
+  uint32_t fill = 0;
+  int16_t  burst[3 * BURST];
+  double   truth[4] = { 1, 0, 0, 0 };
+  double   dps[3], h[3], err, maxerr = 0, t0, elapsed = 0;
+  double   calerr = 0, drift;
+  int      i, failed = 0;
+
+  Seed = 12345U;
+  if (BSP_ORIENT_Init(ODR_HZ, SENSITIVITY_UDPS) != ORIENT_OK)
+  {
+    printf("%s: init failed\n", pTrace->Name);
+    return 1;
+  }
+  for (n = 0; n < total; n++)
+  {
+    double t = (double)n / ODR_HZ;
+
+    pTrace->Rate(t, dps);
+    for (i = 0; i < 3; i++)
+    {
+      double raw = dps[i] / lsb + bias0[i] + pTrace->BiasDrift * n / total + 3.0 * Bench_Noise();
+
+      raw = floor(raw + 0.5);
+      burst[3 * fill + i] = (int16_t)((raw > 32767) ? 32767 : ((raw < -32768) ? -32768 : raw));
+      /* The filter holds each sample over the period */
+      h[i] = dps[i] * M_PI / 180.0 / ODR_HZ / 2.0;
+    }
+    if (n >= ORIENT_CALIBRATION_SAMPLES)
+    {
+      Bench_Rotate(truth, h);
+    }
+    if (++fill == BURST)
+    {
+      t0 = Bench_Seconds();
+      BSP_ORIENT_Update(burst, fill);
+      elapsed += Bench_Seconds() - t0;
+      fill = 0;
+      BSP_ORIENT_GetAttitude(&att);
+      if (att.Calibrated != 0)
+      {
+        err = Bench_Error(&att, truth);
+        maxerr = (err > maxerr) ? err : maxerr;
+      }
+    }
+  }
+  BSP_ORIENT_GetAttitude(&att);
+  err = Bench_Error(&att, truth);
+  for (i = 0; i < 3; i++)
+  {
+    double b = att.Bias[i] / 65536.0 - bias0[i] - pTrace->BiasDrift * n / total;
+
+    calerr = (fabs(b) > calerr) ? fabs(b) : calerr;
+  }
+  drift = err / (pTrace->Seconds / 60.0);
+  *pNs = elapsed * 1e9 / total;
+
+  printf("%-7s %5.1f s  final error %7.4f deg  max %7.4f deg  (%6.4f deg/min)  offset within %5.3f LSB  %6.1f ns/sample\n",
+         pTrace->Name, pTrace->Seconds, err, maxerr, drift, calerr, *pNs);
+  if ((maxerr > ERROR_MAX) || ((pTrace->Rate == Bench_RateStill) && (drift > STILL_DRIFT_MAX)))
+  {
+    printf("%s: out of limits\n", pTrace->Name);
+    failed = 1;
+  }
+  return failed;
+}
+
+static int Bench_File(const char *pPath)
+{
+  ORIENT_AttitudeTypeDef att;
+  FILE    *f = fopen(pPath, "rb");
+  uint8_t  bytes[6 * BURST];
+  int16_t  burst[3 * BURST];
+  size_t   got, i;
+  uint32_t total = 0;
+  double   angle;
+
+  if (f == NULL)
+  {
+    printf("%s: cannot open\n", pPath);
+    return 1;
+  }
+  if (BSP_ORIENT_Init(ODR_HZ, SENSITIVITY_UDPS) != ORIENT_OK)
+  {
+    fclose(f);
+    return 1;
+  }
+  while ((got = fread(bytes, 6, BURST, f)) > 0)
+  {
+    for (i = 0; i < 3 * got; i++)
+    {
+      burst[i] = (int16_t)(bytes[2 * i] | ((uint16_t)bytes[2 * i + 1] << 8));
+    }
+    BSP_ORIENT_Update(burst, (uint32_t)got);
+    total += (uint32_t)got;
+  }
+  fclose(f);
+
+  BSP_ORIENT_GetAttitude(&att);
+  angle = 2.0 * atan2(sqrt((double)att.X * att.X + (double)att.Y * att.Y + (double)att.Z * att.Z),
+                      fabs((double)att.W)) * 180.0 / M_PI;
+  printf("%s: %u samples (%.1f s)  attitude W %.4f X %.4f Y %.4f Z %.4f  (%.3f deg from the start)\n",
+         pPath, (unsigned)total, (double)total / ODR_HZ, att.W / 32768.0, att.X / 32768.0,
+         att.Y / 32768.0, att.Z / 32768.0, angle);
+  printf("offset %.3f %.3f %.3f LSB  %s\n", att.Bias[0] / 65536.0, att.Bias[1] / 65536.0,
+         att.Bias[2] / 65536.0, (att.Calibrated != 0) ? "calibrated" : "not calibrated");
+  return (att.Calibrated != 0) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+  double   ns, worst = 0;
+  uint32_t cycles = CYCLES_SAMPLE + CYCLES_BURST / BURST;
+  size_t   t;
+  int      failed = 0;
+
+  if (argc > 1)
+  {
+    return Bench_File(argv[1]);
+  }
+  for (t = 0; t < sizeof(Traces) / sizeof(Traces[0]); t++)
+  {
+    failed |= Bench_Trace(&Traces[t], &ns);
+    worst = (ns > worst) ? ns : worst;
+  }
+  printf("Cortex-M0 estimate  %u cycles per sample, %.2f ms per burst of %u  CPU %.2f%% at %u Hz (budget %u cycles per sample)\n",
+         (unsigned)cycles, cycles * BURST / (CPU_MHZ * 1000.0), BURST,
+         100.0 * cycles * ODR_MAX_HZ / (CPU_MHZ * 1e6), ODR_MAX_HZ, (unsigned)(CPU_MHZ * 1000000U / ODR_MAX_HZ));
+  return failed;
+}
@@ -0,0 +1,486 @@
+/**
+  ******************************************************************************
+  * @file    bench_spectrum.c
+  * @brief   Spectrum analyzer on the simulated ADC and USART3: frames per
+  *          second, CPU load and line use, with the bins checked against a
+  *          floating-point transform.
+  *
+  *          BSP_SAMPLER_Start() runs on adc_sim.c at RATE_HZ and pushes its
+  *          blocks to BSP_SPECTRUM_Push(); the main loop calls
+  *          BSP_SPECTRUM_Process() and the frames go out on uart_sim.c. Each
+  *          FFT size runs with 50% overlap at two baud rates: at the higher
+  *          one every frame must be analysed and sent, at the lower one the
+  *          line is the limit and frames are left out (TxDropped).
+  *
+  *          Every frame analysed is checked against a double-precision
+  *          Hann-windowed DFT of the same samples, scaled as arm_rfft_q15()
+  *          (1 / N): the bins of power 2^BIN_STRONG_LOG2 and above within
+  *          BIN_TOLERANCE steps, the others at the FLOOR of the analyzer,
+  *          which is that power. A full-scale sine must give
+  *          SPECTRUM_BIN_FULL_SCALE - 16 at its bin (the Hann window halves
+  *          the amplitude). A mismatch, a frame dropped or a transmit error
+  *          makes the program exit with status 1. The input is a tone, a
+  *          chirp and some noise, or the file given as argument (see
+  *          ADC_Sim_LoadFile()), looped.
+  *
+  *          No Cortex-M0 runs here: each frame is charged, in the analyzer
+  *          callback, with the cycles of arm_mult_q15() and arm_rfft_q15()
+  *          on the cycle model (tools/spectrum_m0.py) and the estimated
+  *          cycles of the BSP code (CYCLES_* below), at CPU_MHZ; the
+  *          sampler blocks with the estimates of bench_adc_stream.c.
+  *
+  *          bench_spectrum [--vectors] [--capture <prefix>] [input]
+  *            --vectors  prints the samples, window, arm_rfft_q15() output
+  *                       and bins of one frame of each size, for
+  *                       tools/spectrum_m0.py, and exits
+  *            --capture  writes the bytes sent at the higher baud rate to
+  *                       <prefix>_<N>.bin and the bins of every frame to
+  *                       <prefix>_<N>.csv, for tools/spectrum_decode.py
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_sampler.h"
+#include "stm32f072b_discovery_spectrum.h"
+#include "adc_sim.h"
+#include "uart_sim.h"
+#include "sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE_HZ             48000U
+#define BLOCK_SIZE          128U
+#define KEY_INTERVAL        16U
+#define FLOOR               96U        /* Power 2^12: 42 dB under a full-scale sine */
+#define RUN_US              1000000U
+#define IDLE_STEP_US        10U
+#define INPUT_SAMPLES       48000U
+#define CPU_MHZ             48U
+#define BIN_STRONG_LOG2     12U
+#define BIN_TOLERANCE       2
+#define MODE_CHECK          0U
+#define MODE_VECTORS        1U         /* Bench_Vectors() on frame SETTLE_FRAMES */
+#define MODE_FULL_SCALE     2U         /* Bin FULL_SCALE_BIN of frame SETTLE_FRAMES */
+#define SETTLE_FRAMES       4U
+#define FULL_SCALE_BIN      16U
+
+/* Sampler chain without decimation, as bench_adc_stream.c estimates it */
+#define CYCLES_CONVERT      5U
+#define CYCLES_RMS_SAMPLE   14U
+#define CYCLES_RMS_CALL     650U
+#define CYCLES_CHAIN        80U
+/* Estimated Cortex-M0 cycles of the BSP code, as tools/spectrum_m0.py */
+#define CYCLES_PUSH_SAMPLE  4U         /* memcpy() into the ring */
+#define CYCLES_BIN          40U        /* power, SPECTRUM_Log() */
+#define CYCLES_DELTA_BIN    26U
+#define CYCLES_CHECKSUM     7U         /* per byte */
+#define CYCLES_FRAME        700U
+
+typedef struct
+{
+  uint16_t FftSize;
+  uint32_t MultCycles;       /* arm_mult_q15(), N samples */
+  uint32_t RfftCycles;       /* arm_rfft_q15() */
+} Bench_SizeTypeDef;
+
+typedef struct
+{
+  uint32_t Frames;
+  uint32_t Checked;
+  uint32_t Mismatches;
+} Bench_ResultTypeDef;
+
+/* libarm_cortexM0l_math.a on the cycle model, 1 wait state */
+static const Bench_SizeTypeDef Sizes[] =
+{
+  { 256U, 4380U,  53708U },
+  { 512U, 8732U, 119041U },
+};
+
+static const uint32_t BaudRates[] = { 921600U, 115200U };
+
+static uint16_t                 Input[INPUT_SAMPLES];
+static const Bench_SizeTypeDef *pSize;
+static uint32_t                 FrameCycles;
+static Bench_ResultTypeDef      Result;
+static double                   Cos[SPECTRUM_FFT_MAX];
+static double                   Hann[SPECTRUM_FFT_MAX];
+static FILE                    *pCsv;
+static uint8_t                  Mode;
+static uint8_t                  FullScaleBin;
+static uint8_t                  FullScalePeak;
+
+/* Estimated cycles of the analysis of a frame */
+static uint32_t Bench_FrameCycles(const Bench_SizeTypeDef *pS)
+{
+  uint32_t bins = pS->FftSize / 2U;
+
+  return pS->MultCycles + pS->RfftCycles + CYCLES_BIN * bins + CYCLES_DELTA_BIN * bins +
+         CYCLES_CHECKSUM * (SPECTRUM_HEADER_SIZE + bins / 2U + SPECTRUM_CHECKSUM_SIZE) + CYCLES_FRAME;
+}
+
+static void Bench_Sampler(const q15_t *pBlock, uint32_t Count, q15_t Rms)
+{
+  uint32_t cycles = (CYCLES_CONVERT + CYCLES_RMS_SAMPLE + CYCLES_PUSH_SAMPLE) * Count + CYCLES_RMS_CALL +
+                    CYCLES_CHAIN;
+
+  (void)Rms;
+  SIM_Busy((cycles + CPU_MHZ - 1U) / CPU_MHZ);
+  BSP_SPECTRUM_Push(pBlock, Count);
+}
+
+static q15_t Bench_Sample(uint64_t n)
+{
+  return (q15_t)((ADC_Sim_Input(n) << 4) ^ 0x8000U);
+}
+
+/* 8 log2 of the power of bin k of the frame ending at End, from doubles */
+static double Bench_Reference(uint32_t End, uint32_t k, double *pPower)
+{
+  uint32_t size = pSize->FftSize, n;
+  double   re = 0.0, im = 0.0, x;
+
+  for (n = 0; n < size; n++)
+  {
+    x = Hann[n] * Bench_Sample((uint64_t)End - size + n);
+    re += x * Cos[(k * n) % size];
+    im -= x * Cos[(k * n + 3U * size / 4U) % size];
+  }
+  re /= size;
+  im /= size;
+  *pPower = re * re + im * im;
+  return (*pPower > 0.0) ? 8.0 * log2(*pPower) : 0.0;
+}
+
+static void Bench_Vectors(const uint8_t *pBins, uint32_t End)
+{
+  arm_rfft_instance_q15 fft;
+  static q15_t          window[SPECTRUM_FFT_MAX], frame[SPECTRUM_FFT_MAX], output[2U * SPECTRUM_FFT_MAX];
+  uint32_t              size = pSize->FftSize, step, i;
+
+  /* The window of BSP_SPECTRUM_Init() */
+  arm_rfft_init_q15(&fft, size, 0U, 1U);
+  step = 2U * fft.twidCoefRModifier;
+  window[0] = 0;
+  for (i = 1; i < size / 2U; i++)
+  {
+    window[i] = (q15_t)(0x4000 + fft.pTwiddleAReal[i * step + 1U]);
+    window[size - i] = window[i];
+  }
+  window[size / 2U] = 0x7FFF;
+
+  printf("frame %u\ninput", (unsigned)size);
+  for (i = 0; i < size; i++)
+  {
+    frame[i] = Bench_Sample((uint64_t)End - size + i);
+    printf(" %d", frame[i]);
+  }
+  printf("\nwindow");
+  for (i = 0; i < size; i++)
+  {
+    printf(" %d", window[i]);
+  }
+  arm_mult_q15(frame, window, frame, size);
+  arm_rfft_q15(&fft, frame, output);
+  printf("\noutput");
+  for (i = 0; i < 2U * size; i++)
+  {
+    printf(" %d", output[i]);
+  }
+  printf("\nbins");
+  for (i = 0; i < size / 2U; i++)
+  {
+    printf(" %u", pBins[i]);
+  }
+  printf("\n");
+}
+
+static void Bench_Callback(const uint8_t *pBins, uint32_t Count, uint32_t End)
+{
+  uint32_t k;
+  double   ref, power;
+  int      mismatch = 0;
+
+  SIM_Busy((FrameCycles + CPU_MHZ - 1U) / CPU_MHZ);
+  Result.Frames++;
+  if (Mode != MODE_CHECK)
+  {
+    if (Result.Frames != SETTLE_FRAMES)
+    {
+      return;
+    }
+    if (Mode == MODE_VECTORS)
+    {
+      Bench_Vectors(pBins, End);
+      return;
+    }
+    FullScaleBin = pBins[FULL_SCALE_BIN];
+    FullScalePeak = 1U;
+    for (k = 0; k < Count; k++)
+    {
+      FullScalePeak &= (pBins[k] <= FullScaleBin) ? 1U : 0U;
+    }
+    return;
+  }
+
+  if (pCsv != NULL)
+  {
+    fprintf(pCsv, "%u", (unsigned)(Result.Frames - 1U));
+    for (k = 0; k < Count; k++)
+    {
+      fprintf(pCsv, ",%u", pBins[k]);
+    }
+    fprintf(pCsv, "\n");
+  }
+
+  for (k = 0; k < Count; k++)
+  {
+    ref = Bench_Reference(End, k, &power);
+    if (power >= (double)(1UL << BIN_STRONG_LOG2))
+    {
+      mismatch |= (fabs(pBins[k] - ((ref > FLOOR) ? ref : FLOOR)) > BIN_TOLERANCE) ? 1 : 0;
+    }
+    else
+    {
+      /* Nothing weak in the reference shows up above the floor */
+      mismatch |= (pBins[k] > FLOOR + BIN_TOLERANCE) ? 1 : 0;
+    }
+  }
+  Result.Checked++;
+  Result.Mismatches += (uint32_t)mismatch;
+}
+
+static int Bench_Run(const Bench_SizeTypeDef *pS, uint32_t BaudRate, uint32_t Rate, FILE *pCapture,
+                     SPECTRUM_StatsTypeDef *pStats, UART_SimStatsTypeDef *pUart, uint64_t *pElapsed)
+{
+  SPECTRUM_ConfigTypeDef spectrum;
+  SAMPLER_ConfigTypeDef  sampler;
+  SAMPLER_StatsTypeDef   stats;
+  uint64_t               start;
+  uint32_t               i;
+
+  SIM_Reset();
+  UART_Sim_Reset();
+  UART_Sim_SetCapture(pCapture);
+  pSize = pS;
+  FrameCycles = Bench_FrameCycles(pS);
+  memset(&Result, 0, sizeof(Result));
+  for (i = 0; i < pS->FftSize; i++)
+  {
+    Cos[i] = cos(2.0 * M_PI * i / pS->FftSize);
+    Hann[i] = 0.5 - 0.5 * Cos[i];
+  }
+
+  spectrum.FftSize = pS->FftSize;
+  spectrum.Hop = pS->FftSize / 2U;
+  spectrum.KeyInterval = KEY_INTERVAL;
+  spectrum.Floor = (Mode == MODE_CHECK) ? FLOOR : 0U;
+  spectrum.SampleRate = ADC_Sim_Rate(Rate);
+  spectrum.BaudRate = BaudRate;
+  spectrum.Callback = Bench_Callback;
+  if (BSP_SPECTRUM_Init(&spectrum) != SPECTRUM_OK)
+  {
+    printf("%u points: analyzer not initialized\n", (unsigned)pS->FftSize);
+    return 1;
+  }
+  sampler.SampleRate = Rate;
+  sampler.BlockSize = BLOCK_SIZE;
+  sampler.DecimFactor = 1U;
+  sampler.DecimTaps = 0U;
+  sampler.pDecimCoeffs = NULL;
+  sampler.Callback = Bench_Sampler;
+  if (BSP_SAMPLER_Start(&sampler) != SAMPLER_OK)
+  {
+    printf("%u points: sampler not started at %u Hz\n", (unsigned)pS->FftSize, (unsigned)Rate);
+    return 1;
+  }
+
+  start = SIM_Now();
+  while ((SIM_Now() - start < RUN_US) && ((Mode == MODE_CHECK) || (Result.Frames < SETTLE_FRAMES)))
+  {
+    if (BSP_SPECTRUM_Process() == 0U)
+    {
+      SIM_Advance(IDLE_STEP_US);
+    }
+  }
+  BSP_SAMPLER_Stop();
+  *pElapsed = SIM_Now() - start;
+  /* The last frame off the line */
+  SIM_Advance(100000U);
+  BSP_SAMPLER_GetStats(&stats);
+  BSP_SPECTRUM_GetStats(pStats);
+  UART_Sim_GetStats(pUart);
+  UART_Sim_SetCapture(NULL);
+  return ((stats.Overruns != 0U) || (stats.Errors != 0U)) ? 1 : 0;
+}
+
+/* A sine at bin FULL_SCALE_BIN of N = 256, 2047 counts */
+static int Bench_FullScale(void)
+{
+  static uint16_t       sine[256U / FULL_SCALE_BIN];
+  SPECTRUM_StatsTypeDef stats;
+  UART_SimStatsTypeDef  uart;
+  uint64_t              elapsed;
+  uint32_t              period = sizeof(sine) / sizeof(sine[0]), i;
+  int                   failed;
+
+  for (i = 0; i < period; i++)
+  {
+    sine[i] = (uint16_t)lrint(2048.0 + 2047.0 * sin(2.0 * M_PI * i / period));
+  }
+  ADC_Sim_SetInput(sine, period);
+  Mode = MODE_FULL_SCALE;
+  FullScaleBin = 0;
+  FullScalePeak = 0;
+  failed = Bench_Run(&Sizes[0], BaudRates[0], RATE_HZ, NULL, &stats, &uart, &elapsed);
+  Mode = MODE_CHECK;
+  printf("full-scale sine: bin %u, %s\n", (unsigned)FullScaleBin,
+         (FullScalePeak != 0U) ? "the peak" : "not the peak");
+  return (failed != 0) || (FullScalePeak == 0U) || (FullScaleBin != SPECTRUM_BIN_FULL_SCALE - 16U);
+}
+
+static void Bench_Synthetic(void)
+{
+  uint32_t seed = 0x2545F491U, i;
+  double   t, span = (double)INPUT_SAMPLES / RATE_HZ;
+
+  /* A tone at 1 kHz, a chirp from 500 Hz to 20 kHz over the input, noise */
+  for (i = 0; i < INPUT_SAMPLES; i++)
+  {
+    double v;
+
+    t = (double)i / RATE_HZ;
+    v = 2048.0 + 1200.0 * sin(2.0 * M_PI * 1000.0 * t) +
+        500.0 * sin(2.0 * M_PI * (500.0 * t + (20000.0 - 500.0) * t * t / (2.0 * span)));
+    seed = seed * 1664525U + 1013904223U;
+    Input[i] = (uint16_t)lrint(v + (double)(seed >> 28) - 8.0);
+  }
+  ADC_Sim_SetInput(Input, INPUT_SAMPLES);
+}
+
+static char *Path;
+static char *Prefix;
+
+static int Bench_Main(void)
+{
+  SPECTRUM_StatsTypeDef stats;
+  UART_SimStatsTypeDef  uart;
+  uint64_t              elapsed;
+  uint32_t              count = INPUT_SAMPLES, rate = RATE_HZ;
+  size_t                s, b;
+  FILE                 *capture;
+  char                  name[512];
+  double                seconds;
+  int                   failed = 0;
+
+  ADC_Sim_Reset();
+  if (Mode == MODE_VECTORS)
+  {
+    Bench_Synthetic();
+    for (s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]); s++)
+    {
+      failed |= Bench_Run(&Sizes[s], BaudRates[0], RATE_HZ, NULL, &stats, &uart, &elapsed);
+    }
+    return failed;
+  }
+
+  failed |= Bench_FullScale();
+  if (Path != NULL)
+  {
+    count = ADC_Sim_LoadFile(Path, &rate);
+    if (count == 0U)
+    {
+      printf("%s: not a 16-bit PCM WAV file or a list of 12-bit counts\n", Path);
+      return 2;
+    }
+    if ((rate == 0U) || (rate > SAMPLER_RATE_MAX))
+    {
+      rate = RATE_HZ;
+    }
+    printf("input %s: %u samples, run at %u Hz\n", Path, (unsigned)count, (unsigned)rate);
+  }
+  else
+  {
+    Bench_Synthetic();
+    printf("input synthetic: %u samples, run at %u Hz\n", (unsigned)count, (unsigned)rate);
+  }
+
+  printf("%5s %7s %7s  %6s %6s %7s %5s %7s %9s  %7s %7s %7s  %s\n", "FFT", "baud", "cycles", "frames",
+         "drops", "sent", "keys", "tx drop", "bytes/fr", "fr/s", "line", "CPU", "bins checked");
+  for (s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]); s++)
+  {
+    const Bench_SizeTypeDef *pS = &Sizes[s];
+
+    for (b = 0; b < sizeof(BaudRates) / sizeof(BaudRates[0]); b++)
+    {
+      capture = NULL;
+      pCsv = NULL;
+      if ((Prefix != NULL) && (b == 0U))
+      {
+        snprintf(name, sizeof(name), "%s_%u.bin", Prefix, (unsigned)pS->FftSize);
+        capture = fopen(name, "wb");
+        snprintf(name, sizeof(name), "%s_%u.csv", Prefix, (unsigned)pS->FftSize);
+        pCsv = fopen(name, "w");
+        if ((capture == NULL) || (pCsv == NULL))
+        {
+          printf("%s: cannot be written\n", name);
+          return 2;
+        }
+      }
+      failed |= Bench_Run(pS, BaudRates[b], rate, capture, &stats, &uart, &elapsed);
+      if (capture != NULL)
+      {
+        fclose(capture);
+        fclose(pCsv);
+        pCsv = NULL;
+      }
+
+      seconds = elapsed / 1e6;
+      printf("%5u %7u %7u  %6u %6u %7u %5u %7u %9.1f  %7.1f %6.1f%% %6.1f%%  %u\n", (unsigned)pS->FftSize,
+             (unsigned)BaudRates[b], (unsigned)Bench_FrameCycles(pS), (unsigned)stats.Frames,
+             (unsigned)stats.Dropped, (unsigned)stats.Sent, (unsigned)stats.KeyFrames, (unsigned)stats.TxDropped,
+             (stats.Sent != 0U) ? (double)stats.Bytes / stats.Sent : 0.0, stats.Frames / seconds,
+             100.0 * uart.BusyTime / (double)elapsed, 100.0 * SIM_SpinTime() / (double)elapsed,
+             (unsigned)Result.Checked);
+      if ((Result.Mismatches != 0U) || (Result.Checked != stats.Frames) || (stats.Dropped != 0U) ||
+          (stats.TxErrors != 0U) || ((b == 0U) && (stats.TxDropped != 0U)))
+      {
+        printf("%u points at %u baud: %u frames out of %u not as the reference, %u dropped, %u not sent, "
+               "%u transmit errors\n", (unsigned)pS->FftSize, (unsigned)BaudRates[b],
+               (unsigned)Result.Mismatches, (unsigned)Result.Checked, (unsigned)stats.Dropped,
+               (unsigned)stats.TxDropped, (unsigned)stats.TxErrors);
+        failed = 1;
+      }
+    }
+  }
+  printf("%u samples per frame, 50%% overlap; CPU at %u MHz: sampler, analyzer and USART interrupts\n",
+         (unsigned)BLOCK_SIZE, CPU_MHZ);
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  int i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--vectors") == 0)
+    {
+      Mode = MODE_VECTORS;
+    }
+    else if ((strcmp(argv[i], "--capture") == 0) && (i + 1 < argc))
+    {
+      Prefix = argv[++i];
+    }
+    else if (argv[i][0] != '-')
+    {
+      Path = argv[i];
+    }
+    else
+    {
+      printf("usage: %s [--vectors] [--capture <prefix>] [input]\n", argv[0]);
+      return 2;
+    }
+  }
+  return SIM_Main(Bench_Main);
+}
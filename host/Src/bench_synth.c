@@ -0,0 +1,480 @@
+/**
+  ******************************************************************************
+  * @file    bench_synth.c
+  * @brief   DAC waveform synthesizer on the simulated DAC: output against a
+  *          double-precision oscillator, CPU load per sample and the highest
+  *          update rate without underruns.
+  *
+  *          BSP_SYNTH_Start() runs on dac_sim.c with several sets of voices:
+  *          a sine, interpolated then from the nearest table entry, a chord,
+  *          sweeps, a mix of every waveform with a voice changed while
+  *          running, and a mix driven into clipping. Each set is run for
+  *          RUN_MS at RATE_HZ; every sample the DAC output is compared with
+  *          the same voices computed in double precision from the phase
+  *          accumulators of the BSP (floor(f * 2^32 / rate) per sample, the
+  *          same sweep steps), within TOLERANCE_LSB plus, for the nearest
+  *          entry, the half table step. A jump of the phase anywhere, at a
+  *          block boundary, a sweep end or the voice change, shows as a
+  *          mismatch. Then the highest rate without an underrun is found by
+  *          bisection, up to SYNTH_RATE_MAX.
+  *
+  *          A mismatch, an underrun or error at RATE_HZ, clipping where
+  *          there should be none or none where there should be, or no
+  *          underrun above the highest rate makes the program exit with
+  *          status 1. With --wav <prefix>, each output goes to
+  *          <prefix>_<set>.wav, 16-bit PCM at the DAC rate.
+  *
+  *          No Cortex-M0 runs here: each block is charged with the estimated
+  *          cycles of the BSP C code (CYCLES_* below) at CPU_MHZ, in the
+  *          application callback, on top of the DMA interrupt of dac_sim.c.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_synth.h"
+#include "dac_sim.h"
+#include "sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE_HZ             48000U
+#define RATE_MIN_HZ         8000U
+#define RUN_MS              500U
+#define SEARCH_BLOCKS       32U
+#define IDLE_STEP_US        10U
+#define CPU_MHZ             48U
+#define CHANGE_BLOCK        100U       /* Callback from which a voice changes */
+#define TOLERANCE_LSB       1.0
+#define CAPTURE_MAX         (RATE_HZ * RUN_MS / 1000U)
+
+/* Estimated Cortex-M0 cycles of the BSP, 1 flash wait state on sinTable_q15,
+   loads and stores included */
+#define CYCLES_SINE         30U        /* per sample: two LDRSH, two MULS */
+#define CYCLES_SINE_TABLE   20U        /* one LDRSH, the rounded index */
+#define CYCLES_SQUARE       12U
+#define CYCLES_SAW          15U
+#define CYCLES_MIX          16U        /* per sample: memset(), shift, saturation */
+#define CYCLES_VOICE        60U        /* per voice and block: call, state */
+#define CYCLES_SWEEP_END    50U        /* the run cut at the end of a sweep */
+/* SYNTH_Process() but the voices: two positions, pending settings, callback */
+#define CYCLES_BLOCK        120U
+
+typedef struct
+{
+  const char               *Name;
+  uint16_t                  BlockSize;
+  SYNTH_VoiceTypeDef        Voices[SYNTH_VOICES];
+  uint8_t                   Clips;         /* Clipping expected */
+  uint8_t                   ChangeVoice;
+  const SYNTH_VoiceTypeDef *pChange;       /* Set from the callback of CHANGE_BLOCK */
+} Bench_SetTypeDef;
+
+typedef struct
+{
+  SYNTH_StatsTypeDef Stats;
+  uint32_t           Samples;          /* Compared with the reference */
+  uint32_t           Mismatches;
+  double             MaxError;         /* LSB */
+  double             Snr;              /* dB */
+  double             Load;
+} Bench_ResultTypeDef;
+
+/* Reference voice, sample by sample */
+typedef struct
+{
+  SYNTH_VoiceTypeDef Voice;
+  uint32_t           Phase;
+  uint32_t           Increment;
+  int32_t            Step;
+  uint32_t           Left;
+  uint32_t           Samples;
+  uint32_t           Start;
+  uint32_t           End;
+  uint8_t            Sweep;
+} Bench_RefTypeDef;
+
+static const SYNTH_VoiceTypeDef SawChange = { SYNTH_WAVE_SAW, SYNTH_SWEEP_NONE, 12000, 440000U, 0U, 0U };
+
+static const Bench_SetTypeDef Sets[] =
+{
+  { "sine", 128U, { { SYNTH_WAVE_SINE, SYNTH_SWEEP_NONE, 29491, 1000000U, 0U, 0U } }, 0U, 0U, NULL },
+  { "table", 128U, { { SYNTH_WAVE_SINE_TABLE, SYNTH_SWEEP_NONE, 29491, 1000000U, 0U, 0U } }, 0U, 0U, NULL },
+  { "chord", 128U, { { SYNTH_WAVE_SINE, SYNTH_SWEEP_NONE, 7500, 440000U, 0U, 0U },
+                     { SYNTH_WAVE_SINE, SYNTH_SWEEP_NONE, 7500, 554365U, 0U, 0U },
+                     { SYNTH_WAVE_SINE, SYNTH_SWEEP_NONE, 7500, 659255U, 0U, 0U },
+                     { SYNTH_WAVE_SINE, SYNTH_SWEEP_NONE, 7500, 880000U, 0U, 0U } }, 0U, 0U, NULL },
+  { "sweep", 64U, { { SYNTH_WAVE_SINE, SYNTH_SWEEP_PINGPONG, 20000, 100000U, 10000000U, 200U },
+                    { SYNTH_WAVE_SQUARE, SYNTH_SWEEP_REPEAT, 4000, 250000U, 500000U, 50U } }, 0U, 0U, NULL },
+  { "mixed", 256U, { { SYNTH_WAVE_SAW, SYNTH_SWEEP_NONE, 10000, 220000U, 0U, 0U },
+                     { SYNTH_WAVE_SQUARE, SYNTH_SWEEP_NONE, 6000, 330000U, 0U, 0U },
+                     { SYNTH_WAVE_SINE_TABLE, SYNTH_SWEEP_NONE, 6000, 1760000U, 0U, 0U },
+                     { SYNTH_WAVE_SINE, SYNTH_SWEEP_ONCE, 6000, 3000000U, 300000U, 100U } }, 0U, 0U, &SawChange },
+  { "clip", 128U, { { SYNTH_WAVE_SINE, SYNTH_SWEEP_NONE, 30000, 1000000U, 0U, 0U },
+                    { SYNTH_WAVE_SINE, SYNTH_SWEEP_NONE, 30000, 1500000U, 0U, 0U } }, 1U, 0U, NULL },
+};
+
+static const Bench_SetTypeDef *pSet;
+static uint32_t                BlockCycles;
+static uint32_t                Seen;
+static uint32_t                Target;
+static uint16_t                Output[CAPTURE_MAX];
+static Bench_RefTypeDef        Refs[SYNTH_VOICES];
+
+/* Estimated cycles of a block of the voices */
+static uint32_t Bench_Cycles(const SYNTH_VoiceTypeDef *pVoices, uint32_t BlockSize)
+{
+  static const uint32_t wave[] = { 0U, CYCLES_SINE, CYCLES_SINE_TABLE, CYCLES_SQUARE, CYCLES_SAW };
+  uint32_t cycles = CYCLES_BLOCK + CYCLES_MIX * BlockSize, v;
+
+  for (v = 0; v < SYNTH_VOICES; v++)
+  {
+    if ((pVoices[v].Wave == SYNTH_WAVE_OFF) || (pVoices[v].Amplitude == 0))
+    {
+      continue;
+    }
+    cycles += CYCLES_VOICE + wave[pVoices[v].Wave] * BlockSize;
+    cycles += (pVoices[v].Sweep != SYNTH_SWEEP_NONE) ? CYCLES_SWEEP_END : 0U;
+  }
+  return cycles;
+}
+
+static void Bench_Callback(const uint16_t *pBlock, uint32_t Count)
+{
+  SYNTH_VoiceTypeDef voices[SYNTH_VOICES];
+
+  SIM_Busy((BlockCycles + CPU_MHZ - 1U) / CPU_MHZ);
+  if ((Seen == CHANGE_BLOCK) && (pSet->pChange != NULL))
+  {
+    BSP_SYNTH_SetVoice(pSet->ChangeVoice, pSet->pChange);
+    memcpy(voices, pSet->Voices, sizeof(voices));
+    voices[pSet->ChangeVoice] = *pSet->pChange;
+    BlockCycles = Bench_Cycles(voices, pSet->BlockSize);
+  }
+  /* Stopped from here: an overloaded synthesizer leaves no time to the main
+     loop */
+  if (++Seen == Target)
+  {
+    BSP_SYNTH_Stop();
+  }
+}
+
+/* The voice settings as the BSP takes them, from the reference side */
+static uint32_t Bench_Increment(uint32_t Frequency, uint32_t Rate)
+{
+  uint64_t increment = ((uint64_t)Frequency << 32) / ((uint64_t)Rate * 1000U);
+
+  return (increment < 0x80000000U) ? (uint32_t)increment : 0x7FFFFFFFU;
+}
+
+static void Bench_RefSet(Bench_RefTypeDef *pRef, const SYNTH_VoiceTypeDef *pVoice, uint32_t Rate)
+{
+  uint64_t samples = (uint64_t)pVoice->SweepTime * Rate / 1000U;
+
+  pRef->Voice = *pVoice;
+  pRef->Start = Bench_Increment(pVoice->Frequency, Rate);
+  pRef->End = Bench_Increment(pVoice->SweepTo, Rate);
+  pRef->Increment = pRef->Start;
+  pRef->Step = 0;
+  pRef->Sweep = pVoice->Sweep;
+  if ((pRef->Sweep == SYNTH_SWEEP_NONE) || (samples == 0U))
+  {
+    pRef->Sweep = SYNTH_SWEEP_NONE;
+    return;
+  }
+  pRef->Samples = (uint32_t)samples;
+  pRef->Left = pRef->Samples;
+  pRef->Step = (int32_t)(((int64_t)pRef->End - (int64_t)pRef->Start) / (int64_t)samples);
+}
+
+/* Value of a voice at its phase, in q15 units */
+static double Bench_RefValue(const Bench_RefTypeDef *pRef)
+{
+  double amplitude = pRef->Voice.Amplitude;
+
+  switch (pRef->Voice.Wave)
+  {
+    case SYNTH_WAVE_SINE:
+    case SYNTH_WAVE_SINE_TABLE:
+      return amplitude * sin(2.0 * M_PI * pRef->Phase / 4294967296.0);
+    case SYNTH_WAVE_SQUARE:
+      return (pRef->Phase < 0x80000000U) ? amplitude : -amplitude;
+    case SYNTH_WAVE_SAW:
+      return amplitude * (int16_t)(pRef->Phase >> 16) / 32768.0;
+    default:
+      return 0.0;
+  }
+}
+
+static void Bench_RefNext(Bench_RefTypeDef *pRef)
+{
+  pRef->Phase += pRef->Increment;
+  pRef->Increment += (uint32_t)pRef->Step;
+  if ((pRef->Sweep == SYNTH_SWEEP_NONE) || (--pRef->Left != 0U))
+  {
+    return;
+  }
+  pRef->Left = pRef->Samples;
+  if (pRef->Sweep == SYNTH_SWEEP_ONCE)
+  {
+    pRef->Increment = pRef->End;
+    pRef->Step = 0;
+    pRef->Sweep = SYNTH_SWEEP_NONE;
+  }
+  else if (pRef->Sweep == SYNTH_SWEEP_REPEAT)
+  {
+    pRef->Increment = pRef->Start;
+  }
+  else
+  {
+    pRef->Step = -pRef->Step;
+  }
+}
+
+/* Output against the reference voices, sample by sample */
+static void Bench_Compare(const Bench_SetTypeDef *pS, uint32_t Rate, uint32_t Count, Bench_ResultTypeDef *pResult)
+{
+  double   signal = 0.0, noise = 0.0, tolerance = TOLERANCE_LSB, expected, error;
+  uint32_t n, v;
+
+  memset(Refs, 0, sizeof(Refs));
+  for (v = 0; v < SYNTH_VOICES; v++)
+  {
+    Bench_RefSet(&Refs[v], &pS->Voices[v], Rate);
+    /* Nearest entry: up to half a table step of phase off */
+    if (pS->Voices[v].Wave == SYNTH_WAVE_SINE_TABLE)
+    {
+      tolerance += pS->Voices[v].Amplitude * M_PI / 512.0 / 16.0;
+    }
+  }
+  pResult->Samples = Count;
+  pResult->Mismatches = 0;
+  pResult->MaxError = 0.0;
+  for (n = 0; n < Count; n++)
+  {
+    if ((pS->pChange != NULL) && (n == (CHANGE_BLOCK + 1U) * pS->BlockSize))
+    {
+      Bench_RefSet(&Refs[pS->ChangeVoice], pS->pChange, Rate);
+      if (pS->pChange->Wave == SYNTH_WAVE_SINE_TABLE)
+      {
+        tolerance += pS->pChange->Amplitude * M_PI / 512.0 / 16.0;
+      }
+    }
+    expected = 0.0;
+    for (v = 0; v < SYNTH_VOICES; v++)
+    {
+      expected += Bench_RefValue(&Refs[v]);
+      Bench_RefNext(&Refs[v]);
+    }
+    expected = 2048.0 + expected / 16.0;
+    expected = (expected < 0.0) ? 0.0 : ((expected > 4095.0) ? 4095.0 : expected);
+    error = Output[n] - expected;
+    if (fabs(error) > tolerance)
+    {
+      if (pResult->Mismatches++ == 0U)
+      {
+        printf("%s: sample %u is %u, %.2f expected\n", pS->Name, (unsigned)n, (unsigned)Output[n], expected);
+      }
+    }
+    pResult->MaxError = (fabs(error) > pResult->MaxError) ? fabs(error) : pResult->MaxError;
+    signal += (expected - 2048.0) * (expected - 2048.0);
+    noise += error * error;
+  }
+  pResult->Snr = (noise > 0.0) ? 10.0 * log10(signal / noise) : INFINITY;
+}
+
+static int Bench_Run(const Bench_SetTypeDef *pS, uint32_t Rate, uint32_t Blocks, Bench_ResultTypeDef *pResult)
+{
+  SYNTH_ConfigTypeDef config;
+  uint64_t            start;
+  uint32_t            v;
+
+  SIM_Reset();
+  DAC_Sim_Reset();
+  DAC_Sim_SetCapture(Output, CAPTURE_MAX);
+  pSet = pS;
+  BlockCycles = Bench_Cycles(pS->Voices, pS->BlockSize);
+  Seen = 0;
+  Target = Blocks;
+  for (v = 0; v < SYNTH_VOICES; v++)
+  {
+    BSP_SYNTH_SetVoice(v, &pS->Voices[v]);
+  }
+
+  config.SampleRate = Rate;
+  config.BlockSize = pS->BlockSize;
+  config.Callback = Bench_Callback;
+  if (BSP_SYNTH_Start(&config) != SYNTH_OK)
+  {
+    printf("%s: not started at %u Hz\n", pS->Name, (unsigned)Rate);
+    return 1;
+  }
+  start = SIM_Now();
+  while (Seen < Blocks)
+  {
+    SIM_Advance(IDLE_STEP_US);
+  }
+  BSP_SYNTH_GetStats(&pResult->Stats);
+  pResult->Load = (double)SIM_SpinTime() / (double)(SIM_Now() - start);
+  pResult->Samples = DAC_Sim_Captured();
+  return (pResult->Stats.Errors != 0U) ? 1 : 0;
+}
+
+/* Highest rate without an underrun, to 0.5 % */
+static uint32_t Bench_MaxRate(const Bench_SetTypeDef *pS, int *pFailed)
+{
+  Bench_ResultTypeDef result;
+  uint32_t lo = RATE_MIN_HZ, hi = SYNTH_RATE_MAX, mid;
+
+  *pFailed |= Bench_Run(pS, hi, SEARCH_BLOCKS, &result);
+  if (result.Stats.Underruns == 0U)
+  {
+    return result.Stats.SampleRate;
+  }
+  while (hi - lo > lo / 200U)
+  {
+    mid = lo + (hi - lo) / 2U;
+    *pFailed |= Bench_Run(pS, mid, SEARCH_BLOCKS, &result);
+    if (result.Stats.Underruns == 0U)
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  /* The detection itself: underruns just above, none at the rate found */
+  *pFailed |= Bench_Run(pS, lo, 4U * SEARCH_BLOCKS, &result);
+  if (result.Stats.Underruns != 0U)
+  {
+    printf("%s: %u underruns at %u Hz\n", pS->Name, (unsigned)result.Stats.Underruns,
+           (unsigned)result.Stats.SampleRate);
+    *pFailed = 1;
+  }
+  *pFailed |= Bench_Run(pS, (hi + hi / 50U < SYNTH_RATE_MAX) ? hi + hi / 50U : SYNTH_RATE_MAX,
+                        4U * SEARCH_BLOCKS, &result);
+  if (result.Stats.Underruns == 0U)
+  {
+    printf("%s: no underrun at %u Hz\n", pS->Name, (unsigned)result.Stats.SampleRate);
+    *pFailed = 1;
+  }
+  return DAC_Sim_Rate(lo);
+}
+
+static void Bench_Le(uint8_t *p, uint32_t Value, uint32_t Bytes)
+{
+  while (Bytes-- != 0U)
+  {
+    *p++ = (uint8_t)Value;
+    Value >>= 8;
+  }
+}
+
+/* 16-bit PCM, mono: the 12-bit samples left aligned, offset removed */
+static int Bench_WriteWav(const char *pPath, const uint16_t *pSamples, uint32_t Count, uint32_t Rate)
+{
+  uint8_t  header[44], sample[2];
+  uint32_t i;
+  FILE    *f = fopen(pPath, "wb");
+
+  if (f == NULL)
+  {
+    return 1;
+  }
+  memcpy(header, "RIFF", 4);
+  Bench_Le(&header[4], 36U + 2U * Count, 4U);
+  memcpy(&header[8], "WAVEfmt ", 8);
+  Bench_Le(&header[16], 16U, 4U);
+  Bench_Le(&header[20], 1U, 2U);                    /* PCM */
+  Bench_Le(&header[22], 1U, 2U);                    /* mono */
+  Bench_Le(&header[24], Rate, 4U);
+  Bench_Le(&header[28], 2U * Rate, 4U);
+  Bench_Le(&header[32], 2U, 2U);
+  Bench_Le(&header[34], 16U, 2U);
+  memcpy(&header[36], "data", 4);
+  Bench_Le(&header[40], 2U * Count, 4U);
+  fwrite(header, 1, sizeof(header), f);
+  for (i = 0; i < Count; i++)
+  {
+    Bench_Le(sample, (uint32_t)(((int32_t)pSamples[i] - 2048) * 16), 2U);
+    fwrite(sample, 1, sizeof(sample), f);
+  }
+  return (fclose(f) == 0) ? 0 : 1;
+}
+
+static const char *WavPrefix;
+
+static int Bench_Main(void)
+{
+  Bench_ResultTypeDef result;
+  uint32_t blocks, max, voices, v, cycles;
+  char     path[256];
+  size_t   s;
+  int      failed = 0;
+
+  printf("%-6s %5s %6s  %13s %7s  %9s %7s  %9s %7s  %14s\n", "set", "block", "voices", "cycles/sample", "CPU",
+         "max error", "SNR", "underruns", "clipped", "max rate");
+  for (s = 0; s < sizeof(Sets) / sizeof(Sets[0]); s++)
+  {
+    const Bench_SetTypeDef *pS = &Sets[s];
+
+    /* RUN_MS of output: the two blocks written before the start go out first */
+    blocks = (CAPTURE_MAX + pS->BlockSize - 1U) / pS->BlockSize + 2U;
+    failed |= Bench_Run(pS, RATE_HZ, blocks, &result);
+    if (result.Samples < CAPTURE_MAX)
+    {
+      printf("%s: %u samples output, %u expected\n", pS->Name, (unsigned)result.Samples, (unsigned)CAPTURE_MAX);
+      failed = 1;
+    }
+    Bench_Compare(pS, result.Stats.SampleRate, result.Samples, &result);
+    if ((result.Stats.Underruns != 0U) || (result.Mismatches != 0U) ||
+        ((result.Stats.Clipped != 0U) != (pS->Clips != 0U)))
+    {
+      printf("%s: %u underruns, %u samples out of %u not as the reference, %u clipped\n", pS->Name,
+             (unsigned)result.Stats.Underruns, (unsigned)result.Mismatches, (unsigned)result.Samples,
+             (unsigned)result.Stats.Clipped);
+      failed = 1;
+    }
+    if (WavPrefix != NULL)
+    {
+      snprintf(path, sizeof(path), "%s_%s.wav", WavPrefix, pS->Name);
+      if (Bench_WriteWav(path, Output, result.Samples, result.Stats.SampleRate) != 0)
+      {
+        printf("%s: cannot be written\n", path);
+        return 2;
+      }
+    }
+
+    for (v = 0, voices = 0; v < SYNTH_VOICES; v++)
+    {
+      voices += (pS->Voices[v].Wave != SYNTH_WAVE_OFF) ? 1U : 0U;
+    }
+    cycles = Bench_Cycles(pS->Voices, pS->BlockSize) + DAC_SIM_DMA_ISR_US * CPU_MHZ;
+    max = Bench_MaxRate(pS, &failed);
+    printf("%-6s %5u %6u  %13.1f %6.2f%%  %5.2f LSB %4.1f dB  %9u %7u  %s%8u Hz\n", pS->Name,
+           (unsigned)pS->BlockSize, (unsigned)voices, (double)cycles / pS->BlockSize, 100.0 * result.Load,
+           result.MaxError, result.Snr, (unsigned)result.Stats.Underruns, (unsigned)result.Stats.Clipped,
+           (max >= DAC_Sim_Rate(SYNTH_RATE_MAX)) ? ">=" : "  ", (unsigned)max);
+  }
+  printf("%u ms at %u Hz per set; CPU at %u MHz, DMA interrupt included; error and SNR against the\n"
+         "double-precision voices, in 12-bit steps\n", RUN_MS, RATE_HZ, CPU_MHZ);
+  if (WavPrefix != NULL)
+  {
+    printf("output written to %s_<set>.wav\n", WavPrefix);
+  }
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  if ((argc == 3) && (strcmp(argv[1], "--wav") == 0))
+  {
+    WavPrefix = argv[2];
+  }
+  else if (argc != 1)
+  {
+    printf("usage: %s [--wav <prefix>]\n", argv[0]);
+    return 2;
+  }
+  return SIM_Main(Bench_Main);
+}
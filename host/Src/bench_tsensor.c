@@ -0,0 +1,377 @@
+/**
+  ******************************************************************************
+  * @file    bench_tsensor.c
+  * @brief   STLM75 sampling service on the simulated bus: threshold alerts
+  *          and a decimated history against a main loop polling the sensor.
+  *
+  *          The sensor follows a 25 minute temperature profile: 22 C, up to
+  *          30 C, down to 20 C, up to 27 C, then down to -5 C, with three
+  *          single-conversion glitches of 6 to 8 degrees. The limits are
+  *          26 C and 24 C, so the profile crosses them four times.
+  *
+  *           - polling: BSP_TSENSOR_ReadTemp() every 10 ms from the main
+  *             loop, the limits compared in software;
+  *           - alert: BSP_TSENSOR_AlertStart() and nothing else, the CPU
+  *             idle (as in __WFI()) between interrupts;
+  *           - history: the alerts plus a read every 100 ms averaged by 10,
+  *             the history taken every 5 s, then left to overflow.
+  *
+  *          The alerts must match the crossings of the profile without the
+  *          glitches, one conversion after the first beyond a limit (fault
+  *          queue of 2); every history entry must equal the mean of the
+  *          register values at its read times. A mismatch makes the
+  *          program exit with status 1.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_tsensor.h"
+#include "i2c_sim.h"
+#include "eeprom_sim.h"
+#include "sim.h"
+#include <stdio.h>
+
+#define RUN_US          1500000000ULL
+#define POLL_US         10000U
+#define HIGH_LIMIT      26
+#define LOW_LIMIT       24
+#define PERIOD_MS       100U
+#define DECIMATION      10U
+#define CONSUME_US      5000000U
+#define OVERFLOW_US     40000000U
+#define CROSSINGS_MAX   16U
+#define ENTRIES_MAX     2048U
+/* Completion of the read after the OS edge: EXTI, 2-byte read, DMA interrupt */
+#define ALERT_SLACK_US  2000U
+
+enum { MODE_POLLING, MODE_ALERT, MODE_HISTORY };
+
+typedef struct
+{
+  uint64_t Time;
+  int16_t  Temp;
+  uint32_t Above;
+} Bench_EventTypeDef;
+
+/* Profile corners: seconds, degrees C */
+static const int32_t Corners[][2] =
+{
+  { 0, 22 }, { 60, 22 }, { 300, 30 }, { 420, 30 }, { 720, 20 }, { 840, 20 },
+  { 960, 27 }, { 1080, 27 }, { 1200, 23 }, { 1320, -5 }, { 1500, -5 },
+};
+/* Glitches: conversion number, degrees C added */
+static const int32_t Glitches[][2] = { { 200, 6 }, { 2000, -8 }, { 6667, -6 } };
+
+static Bench_EventTypeDef Events[CROSSINGS_MAX];
+static uint32_t           EventCount;
+static uint64_t           Crossings[CROSSINGS_MAX];
+static uint32_t           CrossingCount;
+static int16_t            Entries[ENTRIES_MAX];
+static uint32_t           EntryCount;
+static uint32_t           StartTick;
+static uint32_t           PollAbove;
+
+/* Temperature without the glitches, 1/256 degree C */
+static int32_t Bench_Base(uint64_t Time)
+{
+  uint32_t i;
+  int64_t  t = (int64_t)Time;
+
+  for (i = 1; i < sizeof(Corners) / sizeof(Corners[0]); i++)
+  {
+    int64_t t0 = Corners[i - 1][0] * 1000000LL, t1 = Corners[i][0] * 1000000LL;
+
+    if (t < t1)
+    {
+      return (int32_t)((Corners[i - 1][1] * 256LL * (t1 - t) + Corners[i][1] * 256LL * (t - t0)) / (t1 - t0));
+    }
+  }
+  return Corners[i - 1][1] * 256;
+}
+
+static int32_t Bench_Profile(uint64_t Time)
+{
+  uint32_t i;
+  int32_t  temp = Bench_Base(Time);
+
+  for (i = 0; i < sizeof(Glitches) / sizeof(Glitches[0]); i++)
+  {
+    int64_t d = (int64_t)Time - (int64_t)Glitches[i][0] * I2C_SIM_CONV_US;
+
+    /* 140 ms around the conversion: exactly one sees it */
+    if ((d >= -20000) && (d < 120000))
+    {
+      temp += Glitches[i][1] * 256;
+    }
+  }
+  return temp;
+}
+
+/* Register value after conversion j (as the sensor quantizes it) */
+static int16_t Bench_Register(uint64_t j, uint32_t Glitch)
+{
+  int32_t t = (Glitch != 0) ? Bench_Profile(j * I2C_SIM_CONV_US) : Bench_Base(j * I2C_SIM_CONV_US);
+
+  return (int16_t)(t & ~0x7F);
+}
+
+/* Conversions that first go beyond the next limit, the glitches left out */
+static void Bench_Crossings(void)
+{
+  uint64_t j;
+  uint32_t above = 0;
+
+  CrossingCount = 0;
+  for (j = 1; (j * I2C_SIM_CONV_US) < RUN_US; j++)
+  {
+    int16_t temp = Bench_Register(j, 0);
+
+    if ((above == 0) ? (temp > HIGH_LIMIT * 256) : (temp < LOW_LIMIT * 256))
+    {
+      above ^= 1U;
+      Crossings[CrossingCount++] = j * I2C_SIM_CONV_US;
+    }
+  }
+}
+
+static void Bench_Alert(int16_t Temp, uint32_t Above)
+{
+  if (EventCount < CROSSINGS_MAX)
+  {
+    Events[EventCount].Time = SIM_Now();
+    Events[EventCount].Temp = Temp;
+    Events[EventCount].Above = Above;
+  }
+  EventCount++;
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  if (GPIO_Pin == TSENSOR_OS_PIN)
+  {
+    BSP_TSENSOR_AlertIRQHandler();
+  }
+}
+
+static void Bench_Tick(void)
+{
+  BSP_I2C_TickHandler();
+  BSP_TSENSOR_TickHandler();
+}
+
+static void Bench_Consume(void)
+{
+  EntryCount += BSP_TSENSOR_GetHistory(&Entries[EntryCount], ENTRIES_MAX - EntryCount);
+}
+
+/* Software limits on the polled values, as a main loop would compare them */
+static void Bench_Poll(void)
+{
+  float temp = BSP_TSENSOR_ReadTemp();
+
+  if ((PollAbove == 0) ? (temp > (float)HIGH_LIMIT) : (temp < (float)LOW_LIMIT))
+  {
+    PollAbove ^= 1U;
+    Bench_Alert((int16_t)(temp * 256.0f), PollAbove);
+  }
+}
+
+/* Entry e of the history: mean of the register values read at ticks
+   StartTick + PERIOD_MS * k, the read ending after any conversion due at the
+   tick itself */
+static int16_t Bench_Entry(uint32_t e)
+{
+  int32_t  sum = 0;
+  uint32_t k;
+
+  for (k = e * DECIMATION + 1U; k <= (e + 1U) * DECIMATION; k++)
+  {
+    uint64_t read = (uint64_t)(StartTick + PERIOD_MS * k) * 1000U;
+
+    sum += Bench_Register(read / I2C_SIM_CONV_US, 1);
+  }
+  return (int16_t)(sum / (int32_t)DECIMATION);
+}
+
+static int Bench_CheckEvents(const char *pName, uint32_t Mode)
+{
+  uint32_t i, matched = 0;
+  uint64_t latency, worst = 0;
+  int failed = 0;
+
+  for (i = 0; (i < EventCount) && (i < CROSSINGS_MAX); i++)
+  {
+    uint32_t c;
+
+    /* The matching crossing: the last one at or before the event */
+    for (c = CrossingCount; (c > 0) && (Crossings[c - 1] > Events[i].Time); c--)
+    {
+    }
+    if ((c == 0) || (Events[i].Above != (c & 1U)))
+    {
+      continue;
+    }
+    latency = Events[i].Time - Crossings[c - 1];
+    if (Mode == MODE_POLLING)
+    {
+      if (latency > POLL_US + ALERT_SLACK_US)
+      {
+        continue;
+      }
+    }
+    else if ((latency < I2C_SIM_CONV_US) || (latency > I2C_SIM_CONV_US + ALERT_SLACK_US) ||
+             ((Events[i].Above != 0) ? (Events[i].Temp <= HIGH_LIMIT * 256) : (Events[i].Temp >= LOW_LIMIT * 256)))
+    {
+      printf("%s: alert %u at %.3f s, %.1f C, above %u, off its crossing\n", pName, (unsigned)i,
+             Events[i].Time / 1e6, Events[i].Temp / 256.0, (unsigned)Events[i].Above);
+      failed = 1;
+      continue;
+    }
+    matched++;
+    worst = (latency > worst) ? latency : worst;
+  }
+  if ((Mode != MODE_POLLING) && ((EventCount != CrossingCount) || (matched != CrossingCount)))
+  {
+    printf("%s: %u alerts, %u matching, for %u crossings\n", pName, (unsigned)EventCount,
+           (unsigned)matched, (unsigned)CrossingCount);
+    failed = 1;
+  }
+  if ((Mode == MODE_POLLING) && (matched != CrossingCount))
+  {
+    printf("%s: %u of %u crossings seen\n", pName, (unsigned)matched, (unsigned)CrossingCount);
+    failed = 1;
+  }
+  printf("%-8s events %2u (%u spurious), latency up to %6.1f ms",
+         pName, (unsigned)EventCount, (unsigned)(EventCount - matched), worst / 1000.0);
+  return failed;
+}
+
+static int Bench_Run(const char *pName, uint32_t Mode)
+{
+  I2C_SimStatsTypeDef  bus;
+  TSENSOR_StatsTypeDef stats;
+  uint64_t next = 0, consume = 0, stop = RUN_US;
+  uint32_t i, expected;
+  int failed = 0;
+
+  SIM_Reset();
+  EEPROM_Sim_Reset(0xFF);
+  I2C_Sim_Reset();
+  I2C_Sim_SetTemp(2 * 22);
+  I2C_Sim_TempProfile(Bench_Profile);
+  SIM_SetTickHook(Bench_Tick);
+  EventCount = 0;
+  EntryCount = 0;
+  PollAbove = 0;
+
+  if (BSP_TSENSOR_Init() != TSENSOR_OK)
+  {
+    printf("%s: sensor not found\n", pName);
+    return 1;
+  }
+  if (Mode != MODE_POLLING)
+  {
+    if (BSP_TSENSOR_AlertStart(HIGH_LIMIT, LOW_LIMIT, Bench_Alert) != TSENSOR_OK)
+    {
+      printf("%s: alert start failed\n", pName);
+      return 1;
+    }
+  }
+  if (Mode == MODE_HISTORY)
+  {
+    StartTick = HAL_GetTick();
+    BSP_TSENSOR_SampleStart(PERIOD_MS, DECIMATION);
+    consume = SIM_Now() + CONSUME_US;
+    stop = RUN_US - OVERFLOW_US;
+  }
+
+  while (SIM_Now() < RUN_US)
+  {
+    if (Mode == MODE_POLLING)
+    {
+      if (SIM_Now() >= next)
+      {
+        next += POLL_US;
+        Bench_Poll();
+      }
+      else
+      {
+        SIM_Advance(next - SIM_Now());
+      }
+    }
+    else if ((Mode == MODE_HISTORY) && (consume <= stop))
+    {
+      SIM_Advance((consume > SIM_Now()) ? (consume - SIM_Now()) : 0U);
+      Bench_Consume();
+      consume += CONSUME_US;
+    }
+    else
+    {
+      SIM_Advance(RUN_US - SIM_Now());
+    }
+  }
+  SIM_SetTickHook(NULL);
+  I2C_Sim_GetStats(&bus);
+  BSP_TSENSOR_GetStats(&stats);
+
+  failed |= Bench_CheckEvents(pName, Mode);
+  printf("  transfers %6u  bus %7.1f ms  CPU %7.1f ms (%.4f%%)\n", (unsigned)bus.Transfers,
+         bus.BusTime / 1000.0, SIM_SpinTime() / 1000.0, 100.0 * SIM_SpinTime() / RUN_US);
+
+  if ((Mode != MODE_POLLING) &&
+      ((stats.Alerts != CrossingCount) || (bus.OsEvents != CrossingCount) || (stats.Errors != 0)))
+  {
+    printf("%s: %u OS interrupts, %u OS edges, %u errors\n", pName, (unsigned)stats.Alerts,
+           (unsigned)bus.OsEvents, (unsigned)stats.Errors);
+    failed = 1;
+  }
+  if (Mode == MODE_HISTORY)
+  {
+    /* Left unread for the last OVERFLOW_US: the ring keeps the newest */
+    uint32_t written = stats.Entries, taken = EntryCount, unread = written - EntryCount;
+
+    Bench_Consume();
+    expected = (uint32_t)((RUN_US / 1000U - StartTick) / (PERIOD_MS * DECIMATION));
+    if ((written != expected) || (stats.Skipped != 0) || (unread <= TSENSOR_HISTORY_SIZE) ||
+        (stats.Overwritten != unread - TSENSOR_HISTORY_SIZE) || (EntryCount != taken + TSENSOR_HISTORY_SIZE))
+    {
+      printf("%s: %u entries written (%u expected), %u taken, %u overwritten, %u skipped\n", pName,
+             (unsigned)written, (unsigned)expected, (unsigned)EntryCount, (unsigned)stats.Overwritten,
+             (unsigned)stats.Skipped);
+      failed = 1;
+    }
+    for (i = 0; i < EntryCount; i++)
+    {
+      /* The overwritten entries were the oldest of the unread ones */
+      uint32_t e = (i < taken) ? i : (i + stats.Overwritten);
+
+      if (Entries[i] != Bench_Entry(e))
+      {
+        printf("%s: entry %u is %.3f C, %.3f C expected\n", pName, (unsigned)e,
+               Entries[i] / 256.0, Bench_Entry(e) / 256.0);
+        failed = 1;
+        break;
+      }
+    }
+    printf("         %u reads, %u entries of %u reads, %u overwritten unread, from %.2f C to %.2f C\n",
+           (unsigned)stats.Reads, (unsigned)written, (unsigned)DECIMATION, (unsigned)stats.Overwritten,
+           Entries[0] / 256.0, Entries[EntryCount - 1] / 256.0);
+  }
+  return failed;
+}
+
+static int Bench_Main(void)
+{
+  int failed = 0;
+
+  Bench_Crossings();
+  printf("profile  %.0f s, limits %d C / %d C, %u crossings, conversions every %u ms, fault queue 2\n",
+         RUN_US / 1e6, HIGH_LIMIT, LOW_LIMIT, (unsigned)CrossingCount, (unsigned)(I2C_SIM_CONV_US / 1000U));
+  failed |= Bench_Run("polling", MODE_POLLING);
+  failed |= Bench_Run("alert", MODE_ALERT);
+  failed |= Bench_Run("history", MODE_HISTORY);
+  return failed;
+}
+
+int main(void)
+{
+  return SIM_Main(Bench_Main);
+}
@@ -0,0 +1,206 @@
+/**
+  ******************************************************************************
+  * @file    dac_sim.c
+  * @brief   DAC, TIM6 trigger and circular DMA model behind the SYNTH_IO_*
+  *          link layer.
+  *
+  *          Mirrors the synthesizer link section of stm32f072b_discovery.c:
+  *          SYNTH_IO_Init() sets the TIM6 divider the same way, and every
+  *          timer period the DMA moves the next halfword of the circular
+  *          buffer to the DAC. When it is done with a half of the buffer the
+  *          DMA interrupt runs as a simulator event and hands it back to
+  *          SYNTH_IO_HalfCpltCallback() or SYNTH_IO_CpltCallback(); an
+  *          interrupt that falls due while another runs waits for it, as on
+  *          the NVIC, and the blocks of a half read meanwhile lose theirs to
+  *          the last of them. The samples of a half are taken as output when
+  *          its interrupt is taken, before the callback refills it: a block
+  *          written late shows as the one before it repeated.
+  *          SYNTH_IO_GetPosition() follows the updates in time, so a block
+  *          still being written when the DMA comes back to it sees the DMA
+  *          there.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_synth.h"
+#include "dac_sim.h"
+#include "sim.h"
+#include <string.h>
+
+static DAC_SimStatsTypeDef Stats;
+static uintptr_t           Generation;
+static uint16_t           *pBuffer;
+static uint32_t            Length;
+static uint32_t            Period;         /* PCLK cycles per update */
+static uint64_t            StartTime;
+static uint64_t            NextBlock;      /* Blocks handed back since the start */
+static uint16_t           *pCapture;
+static uint32_t            CaptureMax;
+static uint32_t            Captured;
+
+static void DAC_Sim_Transfer(void *arg);
+
+void DAC_Sim_Reset(void)
+{
+  memset(&Stats, 0, sizeof(Stats));
+  Generation++;
+  pBuffer = NULL;
+  Length = 0;
+  Period = 0;
+  pCapture = NULL;
+  CaptureMax = 0;
+  Captured = 0;
+}
+
+void DAC_Sim_GetStats(DAC_SimStatsTypeDef *pStats)
+{
+  *pStats = Stats;
+}
+
+void DAC_Sim_SetCapture(uint16_t *pSamples, uint32_t Max)
+{
+  pCapture = pSamples;
+  CaptureMax = Max;
+  Captured = 0;
+}
+
+uint32_t DAC_Sim_Captured(void)
+{
+  return Captured;
+}
+
+/* TIM6 prescaler and period as DACx_TimerInit() sets them */
+static uint32_t DAC_Sim_Period(uint32_t SampleRate)
+{
+  uint32_t divider = (DAC_SIM_PCLK_HZ + SampleRate / 2U) / SampleRate;
+  uint32_t prescaler;
+
+  if (divider < 2U)
+  {
+    return 0;
+  }
+  prescaler = (divider - 1U) / 65536U;
+  return (prescaler + 1U) * (divider / (prescaler + 1U));
+}
+
+uint32_t DAC_Sim_Rate(uint32_t SampleRate)
+{
+  uint32_t period = (SampleRate != 0U) ? DAC_Sim_Period(SampleRate) : 0U;
+
+  return (period != 0U) ? DAC_SIM_PCLK_HZ / period : 0U;
+}
+
+/* Time, in us, at which the updates done since the start reach n */
+static uint64_t DAC_Sim_TimeOf(uint64_t n)
+{
+  return StartTime + (n * Period + (DAC_SIM_PCLK_HZ / 1000000U) - 1U) / (DAC_SIM_PCLK_HZ / 1000000U);
+}
+
+/* Runs the DMA interrupt once the updates done reach n */
+static void DAC_Sim_Schedule(uint64_t n, void *arg)
+{
+  uint64_t due = DAC_Sim_TimeOf(n);
+
+  SIM_Schedule((due > SIM_Now()) ? (due - SIM_Now()) : 0U, DAC_Sim_Transfer, arg);
+}
+
+/* Output of a half as the DMA read it */
+static void DAC_Sim_Capture(uint32_t Half)
+{
+  uint32_t count = Length / 2U;
+
+  if (Captured + count > CaptureMax)
+  {
+    count = CaptureMax - Captured;
+  }
+  if (count != 0U)
+  {
+    memcpy(&pCapture[Captured], &pBuffer[Half * (Length / 2U)], count * sizeof(uint16_t));
+    Captured += count;
+  }
+}
+
+static void DAC_Sim_Transfer(void *arg)
+{
+  uint64_t block, skip, done, due;
+  uint32_t half;
+
+  if ((uintptr_t)arg != Generation)
+  {
+    return;
+  }
+  /* One pending flag per half: the blocks of this half read while it waited
+     merge into one interrupt, for the last of them */
+  done = (SIM_Now() - StartTime) * (DAC_SIM_PCLK_HZ / 1000000U) / Period / (Length / 2U);
+  block = NextBlock;
+  skip = (done > block + 2U) ? block + 2U * ((done - 1U - block) / 2U) : block;
+  /* The blocks skipped went out all the same, as they were */
+  for (; block < skip; block++)
+  {
+    DAC_Sim_Capture((uint32_t)(block & 1U));
+  }
+  NextBlock = block + 1U;
+  half = (uint32_t)(block & 1U);
+  due = DAC_Sim_TimeOf((block + 1U) * (Length / 2U));
+
+  /* The next interrupt falls due whatever happens to this one */
+  DAC_Sim_Schedule((block + 2U) * (Length / 2U), arg);
+
+  DAC_Sim_Capture(half);
+  Stats.Blocks++;
+  Stats.Updates = (block + 1U) * (Length / 2U);
+  if (SIM_Now() - due > Stats.MaxDispatch)
+  {
+    Stats.MaxDispatch = SIM_Now() - due;
+  }
+
+  SIM_Busy(DAC_SIM_DMA_ISR_US);
+  if (half == 0U)
+  {
+    SYNTH_IO_HalfCpltCallback();
+  }
+  else
+  {
+    SYNTH_IO_CpltCallback();
+  }
+}
+
+uint32_t SYNTH_IO_Init(uint32_t SampleRate)
+{
+  Generation++;
+  Length = 0;
+  Period = (SampleRate != 0U) ? DAC_Sim_Period(SampleRate) : 0U;
+  return (Period != 0U) ? DAC_SIM_PCLK_HZ / Period : 0U;
+}
+
+uint8_t SYNTH_IO_Start(uint16_t *pBuf, uint32_t Len)
+{
+  if ((pBuf == NULL) || (Len < 2U) || ((Len & 1U) != 0U) || (Period == 0U))
+  {
+    return 1;
+  }
+  Generation++;
+  pBuffer = pBuf;
+  Length = Len;
+  StartTime = SIM_Now();
+  NextBlock = 0;
+  Captured = 0;
+  DAC_Sim_Schedule(Length / 2U, (void *)Generation);
+  return 0;
+}
+
+void SYNTH_IO_Stop(void)
+{
+  Generation++;
+  Length = 0;
+}
+
+uint32_t SYNTH_IO_GetPosition(void)
+{
+  uint64_t done;
+
+  if (Length == 0U)
+  {
+    return 0;
+  }
+  done = (SIM_Now() - StartTime) * (DAC_SIM_PCLK_HZ / 1000000U) / Period;
+  return (uint32_t)(done % Length);
+}
@@ -0,0 +1,202 @@
+/**
+  ******************************************************************************
+  * @file    dsp_lib_test.c
+  * @brief   DSP_Lib_TestSuite on the host: the JTest groups of all_tests.c
+  *          (basic, complex, controller, fast math, filtering, matrix,
+  *          statistics, support, transform and intrinsics) against RefLibs,
+  *          run on the cmsis_dsp host library through one dsp_x86.h path.
+  *
+  *          Usage: dsp_lib_test [-v] [C|SSE4.1|AVX2]
+  *          The best path of the CPU runs by default. One line per test:
+  *          result, test, function under test, calls of the function and
+  *          mean time per call. -v adds the JTest output, as the debugger
+  *          scripts of the FVP and MPS2 projects print it.
+  *
+  *          Exits with status 1 if a test fails, 77 (skipped, for CTest) if
+  *          the CPU lacks the path.
+  *
+  ==============================================================================
+                          ##### Notes #####
+  ==============================================================================
+  *  On the targets, the JTest actions (test_start(), dump_str(), ...) only
+  *  count: the debugger breaks on them and reads JTEST_FW. They are defined
+  *  here instead of jtest_trigger_action.c, printing what the debugger
+  *  would, and main() replaces the one of the suite, which sets fault
+  *  handler bits of the System Control Block and never returns.
+  *
+  *  The test and function names come from the strings dumped by
+  *  JTEST_TEST_RUN(); the times from JTEST_COUNT_CYCLES() (jtest_host.h),
+  *  around each call of the function under test only, not the reference.
+  ******************************************************************************
+  */
+#include "jtest.h"
+#include "all_tests.h"
+#include "dsp_x86.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#define NAME_LEN            64U
+#define STATUS_SKIPPED      77
+
+typedef enum
+{
+  DUMP_NONE      = 0,
+  DUMP_TEST_NAME = 1,                  /* next string: test name */
+  DUMP_FUT_NAME  = 2                   /* next string: function under test */
+} DumpStateTypeDef;
+
+static int              Verbose;
+static DumpStateTypeDef DumpState;
+static char             TestName[NAME_LEN];
+static char             FutName[NAME_LEN];
+static uint32_t         TestPassed;
+static uint32_t         Calls;
+static uint64_t         Time;
+static uint64_t         TotalTime;
+
+uint64_t JTEST_HOST_Now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void JTEST_HOST_Count(uint64_t Duration)
+{
+  Calls++;
+  Time += Duration;
+}
+
+/* Copy of a dumped name without its trailing newline */
+static void CopyName(char *pName, const char *pStr)
+{
+  size_t len = strcspn(pStr, "\n");
+
+  if (len >= NAME_LEN)
+  {
+    len = NAME_LEN - 1U;
+  }
+  memcpy(pName, pStr, len);
+  pName[len] = '\0';
+}
+
+void test_start(void)
+{
+  JTEST_FW.test_start++;
+  TestName[0] = '\0';
+  FutName[0] = '\0';
+  TestPassed = 0U;
+  Calls = 0U;
+  Time = 0U;
+}
+
+void test_end(void)
+{
+  JTEST_FW.test_end++;
+  printf("%s  %-40s %-32s %5lu %11.0f ns\n", TestPassed ? "PASS" : "FAIL", TestName, FutName,
+         (unsigned long)Calls, (Calls != 0U) ? (double)Time / Calls : 0.0);
+  TotalTime += Time;
+}
+
+void group_start(void)
+{
+  JTEST_FW.group_start++;
+}
+
+void group_end(void)
+{
+  JTEST_FW.group_end++;
+}
+
+/* One segment of JTEST_FW.str_buffer, as many bytes as the debugger reads */
+void dump_str(void)
+{
+  const char *pStr = JTEST_FW.str_buffer;
+
+  JTEST_FW.dump_str++;
+  if (Verbose)
+  {
+    printf("%.*s", (int)JTEST_STR_MAX_OUTPUT_SIZE, pStr);
+  }
+
+  if (DumpState == DUMP_TEST_NAME)
+  {
+    CopyName(TestName, pStr);
+  }
+  else if (DumpState == DUMP_FUT_NAME)
+  {
+    CopyName(FutName, pStr);
+  }
+  DumpState = DUMP_NONE;
+
+  if (strcmp(pStr, "Test Name:\n") == 0)
+  {
+    DumpState = DUMP_TEST_NAME;
+  }
+  else if (strcmp(pStr, "Function Under Test:\n") == 0)
+  {
+    DumpState = DUMP_FUT_NAME;
+  }
+  else if (strcmp(pStr, "Test Passed\n") == 0)
+  {
+    TestPassed = 1U;
+  }
+}
+
+void dump_data(void)
+{
+  JTEST_FW.dump_data++;
+}
+
+void exit_fw(void)
+{
+  JTEST_FW.exit_fw++;
+  printf("%lu tests, %lu passed, %lu failed, %.1f ms in the functions under test\n",
+         (unsigned long)(JTEST_FW.passed + JTEST_FW.failed), (unsigned long)JTEST_FW.passed,
+         (unsigned long)JTEST_FW.failed, (double)TotalTime / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+  DSP_X86_PathTypeDef path = DSP_X86_Best();
+  uint32_t p;
+  int i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-v") == 0)
+    {
+      Verbose = 1;
+      continue;
+    }
+    for (p = 0; p < DSP_X86_PATHS; p++)
+    {
+      if (strcasecmp(argv[i], DSP_X86_Name((DSP_X86_PathTypeDef)p)) == 0)
+      {
+        break;
+      }
+    }
+    if (p == DSP_X86_PATHS)
+    {
+      fprintf(stderr, "usage: %s [-v] [C|SSE4.1|AVX2]\n", argv[0]);
+      return 2;
+    }
+    path = (DSP_X86_PathTypeDef)p;
+  }
+
+  if (DSP_X86_Select(path) != 0)
+  {
+    printf("%s: not supported on this CPU\n", DSP_X86_Name(path));
+    return STATUS_SKIPPED;
+  }
+  printf("DSP_Lib_TestSuite, %s path\n", DSP_X86_Name(path));
+
+  JTEST_INIT();
+  JTEST_GROUP_CALL(all_tests);
+  JTEST_ACT_EXIT_FW();
+
+  return (JTEST_FW.failed == 0U) ? 0 : 1;
+}
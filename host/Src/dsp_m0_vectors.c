@@ -0,0 +1,219 @@
+/**
+  ******************************************************************************
+  * @file    dsp_m0_vectors.c
+  * @brief   Test vectors of arm_fir_q15() and arm_biquad_cascade_df1_q15()
+  *          for tools/dsp_m0_check.py, which runs Cortex-M0 builds of the two
+  *          kernels on tools/m0_model.py against them.
+  *
+  *          Each case is two calls in a row on the same instance, so that
+  *          the state kept between calls is checked too. The expected
+  *          outputs are those of the C kernels of cmsis_dsp (the
+  *          ARM_MATH_CM0_FAMILY code), alongside those of RefLibs for the
+  *          SNR check of DSP_Lib_TestSuite. Cases:
+  *           - suite: the filtering_tests grids of DSP_Lib_TestSuite, block
+  *             sizes by tap counts (stages and post shifts) on its inputs
+  *             and coefficients
+  *           - bound: taps (stage coefficients) whose absolute values add up
+  *             to exactly 65535, the most the 32-bit accumulators of the
+  *             Thumb-1 kernels take, on full-scale inputs that saturate
+  *           - over: the same plus one, through the 64-bit accumulators
+  *           - lowpass: a Butterworth low-pass biquad at fs / 10, as
+  *             designed for postShift = 1
+  *          FIR tap counts of every remainder modulo 4 and odd blocks are
+  *          included.
+  *
+  *          Output, one line each, integers separated by spaces:
+  *            fir <name> <numTaps> <blockSize>
+  *            biquad <name> <numStages> <postShift> <blockSize>
+  *          then "coeffs", "input" (2 * blockSize samples), "output" and
+  *          "reference" lines.
+  ******************************************************************************
+  */
+#include "arm_math.h"
+#include "dsp_x86.h"
+#include "filtering_test_data.h"
+#include "ref.h"
+#include <stdio.h>
+#include <string.h>
+
+#define VEC_CALLS           2U
+#define VEC_TAPS_MAX        64U
+#define VEC_BLOCK_MAX       FILTERING_MAX_BLOCKSIZE
+#define VEC_STAGES_MAX      FILTERING_MAX_NUMSTAGES
+#define VEC_SAMPLES         (VEC_CALLS * VEC_BLOCK_MAX)
+
+static const uint16_t VecTaps[]     = { 1U, 2U, 3U, 5U, 7U, 16U, 63U };
+static const uint32_t VecBlocks[]   = { 1U, 2U, 7U, 32U, 33U };
+static const uint16_t VecStages[]   = { 1U, 3U };
+/* Butterworth low-pass at fs / 10, halved for postShift = 1 */
+static const q15_t    VecLowpass[6] = { 1106, 0, 2211, 1106, 18727, -6763 };
+
+static uint32_t Seed = 0x2545F491U;
+
+static q15_t Coeffs[VEC_STAGES_MAX * 6U + VEC_TAPS_MAX];
+static q15_t Input[VEC_SAMPLES];
+static q15_t Output[VEC_SAMPLES], Reference[VEC_SAMPLES];
+static q15_t State[VEC_TAPS_MAX + VEC_BLOCK_MAX], RefState[VEC_TAPS_MAX + VEC_BLOCK_MAX];
+
+static uint32_t Vec_Random(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return Seed;
+}
+
+static void Vec_Print(const char *pName, const q15_t *pData, uint32_t Count)
+{
+  uint32_t i;
+
+  printf("%s", pName);
+  for (i = 0; i < Count; i++)
+  {
+    printf(" %d", pData[i]);
+  }
+  printf("\n");
+}
+
+/* Count taps whose absolute values add up to Sum, random signs */
+static void Vec_BoundTaps(q15_t *pTaps, uint32_t Count, uint32_t Sum)
+{
+  uint32_t i, each = Sum / Count;
+
+  for (i = 0; i < Count; i++)
+  {
+    uint32_t mag = each + ((i == 0U) ? Sum % Count : 0U);
+    pTaps[i] = (q15_t)((Vec_Random() & 0x80000000U) ? -(int32_t)mag : (int32_t)mag);
+  }
+}
+
+/* Runs of full-scale samples of either sign, to saturate both ways */
+static void Vec_FullScale(q15_t *pData, uint32_t Count)
+{
+  uint32_t i;
+
+  for (i = 0; i < Count; i++)
+  {
+    pData[i] = ((Vec_Random() >> 28) & 1U) ? (q15_t)32767 : (q15_t)-32768;
+  }
+}
+
+static void Vec_Fir(const char *pName, uint16_t NumTaps, uint32_t BlockSize)
+{
+  arm_fir_instance_q15 fir, ref;
+  uint32_t call;
+
+  memset(State, 0, sizeof(State));
+  memset(RefState, 0, sizeof(RefState));
+  arm_fir_init_q15(&fir, NumTaps, Coeffs, State, BlockSize);
+  arm_fir_init_q15(&ref, NumTaps, Coeffs, RefState, BlockSize);
+  for (call = 0; call < VEC_CALLS; call++)
+  {
+    arm_fir_q15(&fir, &Input[call * BlockSize], &Output[call * BlockSize], BlockSize);
+    ref_fir_q15(&ref, &Input[call * BlockSize], &Reference[call * BlockSize], BlockSize);
+  }
+
+  printf("fir %s %u %u\n", pName, (unsigned)NumTaps, (unsigned)BlockSize);
+  Vec_Print("coeffs", Coeffs, NumTaps);
+  Vec_Print("input", Input, VEC_CALLS * BlockSize);
+  Vec_Print("output", Output, VEC_CALLS * BlockSize);
+  Vec_Print("reference", Reference, VEC_CALLS * BlockSize);
+}
+
+static void Vec_Biquad(const char *pName, uint8_t NumStages, int8_t PostShift, uint32_t BlockSize)
+{
+  arm_biquad_casd_df1_inst_q15 biquad, ref;
+  uint32_t call;
+
+  memset(State, 0, sizeof(State));
+  memset(RefState, 0, sizeof(RefState));
+  arm_biquad_cascade_df1_init_q15(&biquad, NumStages, Coeffs, State, PostShift);
+  arm_biquad_cascade_df1_init_q15(&ref, NumStages, Coeffs, RefState, PostShift);
+  for (call = 0; call < VEC_CALLS; call++)
+  {
+    arm_biquad_cascade_df1_q15(&biquad, &Input[call * BlockSize], &Output[call * BlockSize], BlockSize);
+    ref_biquad_cascade_df1_q15(&ref, &Input[call * BlockSize], &Reference[call * BlockSize], BlockSize);
+  }
+
+  printf("biquad %s %u %d %u\n", pName, (unsigned)NumStages, (int)PostShift, (unsigned)BlockSize);
+  Vec_Print("coeffs", Coeffs, 6U * NumStages);
+  Vec_Print("input", Input, VEC_CALLS * BlockSize);
+  Vec_Print("output", Output, VEC_CALLS * BlockSize);
+  Vec_Print("reference", Reference, VEC_CALLS * BlockSize);
+}
+
+/* Stage coefficients (b0, 0, b1, b2, a1, a2) adding up to Sum */
+static void Vec_BoundStages(uint32_t NumStages, uint32_t Sum)
+{
+  uint32_t s;
+  q15_t    taps[5];
+
+  for (s = 0; s < NumStages; s++)
+  {
+    Vec_BoundTaps(taps, 5U, Sum);
+    Coeffs[6U * s] = taps[0];
+    Coeffs[6U * s + 1U] = 0;
+    memcpy(&Coeffs[6U * s + 2U], &taps[1], 4U * sizeof(q15_t));
+  }
+}
+
+int main(void)
+{
+  uint32_t i, j, k, b;
+
+  /* The C kernels, not their SSE4.1/AVX2 versions */
+  DSP_X86_Select(DSP_X86_C);
+
+  /* DSP_Lib_TestSuite grids */
+  memcpy(Input, filtering_q15_inputs, sizeof(Input));
+  for (i = 0; i < (uint32_t)filtering_blocksizes.element_count; i++)
+  {
+    b = ARR_DESC_ELT(uint32_t, i, &filtering_blocksizes);
+    for (j = 0; j < (uint32_t)filtering_numtaps.element_count; j++)
+    {
+      memcpy(Coeffs, filtering_coeffs_q15, sizeof(filtering_coeffs_q15));
+      Vec_Fir("suite", ARR_DESC_ELT(uint16_t, j, &filtering_numtaps), b);
+    }
+    for (j = 0; j < (uint32_t)filtering_numstages.element_count; j++)
+    {
+      for (k = 0; k < (uint32_t)filtering_postshifts.element_count; k++)
+      {
+        memcpy(Coeffs, filtering_coeffs_b_q15, 6U * FILTERING_MAX_NUMSTAGES * sizeof(q15_t));
+        Vec_Biquad("suite", (uint8_t)ARR_DESC_ELT(uint16_t, j, &filtering_numstages),
+                   (int8_t)ARR_DESC_ELT(uint8_t, k, &filtering_postshifts), b);
+      }
+    }
+  }
+
+  /* Either side of the 32-bit accumulator bound, saturating */
+  for (i = 0; i < sizeof(VecBlocks) / sizeof(VecBlocks[0]); i++)
+  {
+    b = VecBlocks[i];
+    for (j = 0; j < sizeof(VecTaps) / sizeof(VecTaps[0]); j++)
+    {
+      Vec_FullScale(Input, VEC_SAMPLES);
+      Vec_BoundTaps(Coeffs, VecTaps[j], 65535U);
+      Vec_Fir("bound", VecTaps[j], b);
+      Vec_BoundTaps(Coeffs, VecTaps[j], 65536U);
+      Vec_Fir("over", VecTaps[j], b);
+    }
+    for (j = 0; j < sizeof(VecStages) / sizeof(VecStages[0]); j++)
+    {
+      Vec_FullScale(Input, VEC_SAMPLES);
+      Vec_BoundStages(VecStages[j], 65535U);
+      Vec_Biquad("bound", (uint8_t)VecStages[j], 1, b);
+      Vec_BoundStages(VecStages[j], 65536U);
+      Vec_Biquad("over", (uint8_t)VecStages[j], 1, b);
+    }
+
+    /* Noise at -6 dBFS through the low-pass */
+    for (j = 0; j < VEC_SAMPLES; j++)
+    {
+      Input[j] = (q15_t)((int32_t)Vec_Random() >> 17);
+    }
+    for (j = 0; j < 4U; j++)
+    {
+      memcpy(&Coeffs[6U * j], VecLowpass, sizeof(VecLowpass));
+    }
+    Vec_Biquad("lowpass", 4U, 1, b);
+  }
+  return 0;
+}
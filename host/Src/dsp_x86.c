@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @file    dsp_x86.c
+  * @brief   Entry points of the CMSIS-DSP kernels with SIMD versions on the
+  *          host, forwarding to the kernels of the selected path.
+  ******************************************************************************
+  */
+#include "dsp_x86.h"
+#include "dsp_x86_kernels.h"
+
+typedef struct
+{
+  void       (*FirF32)(const arm_fir_instance_f32 *, float32_t *, float32_t *, uint32_t);
+  void       (*FirQ15)(const arm_fir_instance_q15 *, q15_t *, q15_t *, uint32_t);
+  void       (*BiquadDf1F32)(const arm_biquad_casd_df1_inst_f32 *, float32_t *, float32_t *, uint32_t);
+  void       (*CfftF32)(const arm_cfft_instance_f32 *, float32_t *, uint8_t, uint8_t);
+  void       (*DotProdF32)(float32_t *, float32_t *, uint32_t, float32_t *);
+  void       (*DotProdQ31)(q31_t *, q31_t *, uint32_t, q63_t *);
+  void       (*DotProdQ15)(q15_t *, q15_t *, uint32_t, q63_t *);
+  void       (*DotProdQ7)(q7_t *, q7_t *, uint32_t, q31_t *);
+  arm_status (*MatMultF32)(const arm_matrix_instance_f32 *, const arm_matrix_instance_f32 *,
+                           arm_matrix_instance_f32 *);
+} DSP_X86_KernelsTypeDef;
+
+#define DSP_X86_KERNELS(suffix)                                                                  \
+  { arm_fir_f32_##suffix, arm_fir_q15_##suffix, arm_biquad_cascade_df1_f32_##suffix,             \
+    arm_cfft_f32_##suffix, arm_dot_prod_f32_##suffix, arm_dot_prod_q31_##suffix,                 \
+    arm_dot_prod_q15_##suffix, arm_dot_prod_q7_##suffix, arm_mat_mult_f32_##suffix }
+
+static const DSP_X86_KernelsTypeDef Kernels[DSP_X86_PATHS] =
+{
+  DSP_X86_KERNELS(c),
+#ifdef DSP_X86_SIMD
+  DSP_X86_KERNELS(sse41),
+  DSP_X86_KERNELS(avx2),
+#endif
+};
+
+static const char *const Names[DSP_X86_PATHS] = { "C", "SSE4.1", "AVX2" };
+
+static DSP_X86_PathTypeDef Current = DSP_X86_C;
+
+DSP_X86_PathTypeDef DSP_X86_Best(void)
+{
+#ifdef DSP_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+  {
+    return DSP_X86_AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.1"))
+  {
+    return DSP_X86_SSE41;
+  }
+#endif
+  return DSP_X86_C;
+}
+
+int DSP_X86_Select(DSP_X86_PathTypeDef Path)
+{
+  if ((uint32_t)Path > (uint32_t)DSP_X86_Best())
+  {
+    return -1;
+  }
+  Current = Path;
+  return 0;
+}
+
+DSP_X86_PathTypeDef DSP_X86_Current(void)
+{
+  return Current;
+}
+
+const char *DSP_X86_Name(DSP_X86_PathTypeDef Path)
+{
+  return ((uint32_t)Path < DSP_X86_PATHS) ? Names[Path] : "?";
+}
+
+__attribute__((constructor))
+static void DSP_X86_Init(void)
+{
+  Current = DSP_X86_Best();
+}
+
+void arm_fir_f32(const arm_fir_instance_f32 *S, float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  Kernels[Current].FirF32(S, pSrc, pDst, blockSize);
+}
+
+void arm_fir_q15(const arm_fir_instance_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  Kernels[Current].FirQ15(S, pSrc, pDst, blockSize);
+}
+
+void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, float32_t *pSrc,
+                                float32_t *pDst, uint32_t blockSize)
+{
+  /* One or two stages gain nothing from the stage lanes; up to four fill
+     the SSE4.1 lanes better than the AVX2 ones */
+  if ((S->numStages < 3U) || (Current == DSP_X86_C))
+  {
+    Kernels[DSP_X86_C].BiquadDf1F32(S, pSrc, pDst, blockSize);
+  }
+  else if (S->numStages <= 4U)
+  {
+    Kernels[DSP_X86_SSE41].BiquadDf1F32(S, pSrc, pDst, blockSize);
+  }
+  else
+  {
+    Kernels[Current].BiquadDf1F32(S, pSrc, pDst, blockSize);
+  }
+}
+
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag)
+{
+  Kernels[Current].CfftF32(S, p1, ifftFlag, bitReverseFlag);
+}
+
+void arm_dot_prod_f32(float32_t *pSrcA, float32_t *pSrcB, uint32_t blockSize, float32_t *result)
+{
+  Kernels[Current].DotProdF32(pSrcA, pSrcB, blockSize, result);
+}
+
+void arm_dot_prod_q31(q31_t *pSrcA, q31_t *pSrcB, uint32_t blockSize, q63_t *result)
+{
+  Kernels[Current].DotProdQ31(pSrcA, pSrcB, blockSize, result);
+}
+
+void arm_dot_prod_q15(q15_t *pSrcA, q15_t *pSrcB, uint32_t blockSize, q63_t *result)
+{
+  Kernels[Current].DotProdQ15(pSrcA, pSrcB, blockSize, result);
+}
+
+void arm_dot_prod_q7(q7_t *pSrcA, q7_t *pSrcB, uint32_t blockSize, q31_t *result)
+{
+  Kernels[Current].DotProdQ7(pSrcA, pSrcB, blockSize, result);
+}
+
+arm_status arm_mat_mult_f32(const arm_matrix_instance_f32 *pSrcA, const arm_matrix_instance_f32 *pSrcB,
+                            arm_matrix_instance_f32 *pDst)
+{
+  return Kernels[Current].MatMultF32(pSrcA, pSrcB, pDst);
+}
@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file    dsp_x86_avx2.c
+  * @brief   AVX2 kernels of dsp_x86.c: dsp_x86_template.h on 256-bit
+  *          vectors, 8 floats or 16 int16. Built with -mavx2, without FMA.
+  ******************************************************************************
+  */
+#include "dsp_x86_kernels.h"
+#include <immintrin.h>
+#include <string.h>
+
+#define DSP_X86_FN(name)         name##_avx2
+#define VW                       8U
+#define VW16                     16U
+
+typedef __m256  VF;
+typedef __m256i VI;
+
+#define VF_ZERO()                _mm256_setzero_ps()
+#define VF_SET1(x)               _mm256_set1_ps(x)
+#define VF_LOAD(p)               _mm256_loadu_ps(p)
+#define VF_STORE(p, v)           _mm256_storeu_ps((p), (v))
+#define VF_LOADMASK(p)           _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)(p)))
+#define VF_ADD(a, b)             _mm256_add_ps((a), (b))
+#define VF_SUB(a, b)             _mm256_sub_ps((a), (b))
+#define VF_MUL(a, b)             _mm256_mul_ps((a), (b))
+#define VF_NEG(a)                _mm256_xor_ps((a), _mm256_set1_ps(-0.0f))
+/* Lanes of b where the mask is set, of a elsewhere */
+#define VF_BLEND(a, b, mask)     _mm256_blendv_ps((a), (b), (mask))
+#define VF_REVERSE(a)            _mm256_permutevar8x32_ps((a), _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0))
+/* x in lane 0, lanes 0 to 6 of a in lanes 1 to 7 */
+#define VF_SHIFTIN(a, x)         _mm256_blend_ps(_mm256_permutevar8x32_ps((a), _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6)), \
+                                                 _mm256_set1_ps(x), 0x01)
+
+#define VI_ZERO()                _mm256_setzero_si256()
+#define VI_SET1_32(x)            _mm256_set1_epi32(x)
+#define VI_SET1_64(x)            _mm256_set1_epi64x(x)
+#define VI_LOAD(p)               _mm256_loadu_si256((const __m256i *)(const void *)(p))
+#define VI_STORE(p, v)           _mm256_storeu_si256((__m256i *)(void *)(p), (v))
+#define VI_LOAD8TO16(p)          _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(const void *)(p)))
+#define VI_ADD32(a, b)           _mm256_add_epi32((a), (b))
+#define VI_SUB32(a, b)           _mm256_sub_epi32((a), (b))
+#define VI_ADD64(a, b)           _mm256_add_epi64((a), (b))
+#define VI_SUB64(a, b)           _mm256_sub_epi64((a), (b))
+#define VI_XOR(a, b)             _mm256_xor_si256((a), (b))
+#define VI_SRLI64(a, n)          _mm256_srli_epi64((a), (n))
+#define VI_MUL32(a, b)           _mm256_mul_epi32((a), (b))
+#define VI_MADD16(a, b)          _mm256_madd_epi16((a), (b))
+#define VI_WIDEN_LO(a)           _mm256_cvtepi32_epi64(_mm256_castsi256_si128(a))
+#define VI_WIDEN_HI(a)           _mm256_cvtepi32_epi64(_mm256_extracti128_si256((a), 1))
+
+/* Interleaved real and imaginary parts of 8 complex values. The in-lane
+   shuffles leave the values in the order 0 1 4 5 2 3 6 7, put back in order
+   by 64-bit permutes */
+static inline void VF_CPXLOAD(const float32_t *p, VF *pRe, VF *pIm)
+{
+  VF a = _mm256_loadu_ps(p), b = _mm256_loadu_ps(p + 8);
+
+  *pRe = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+                                                _MM_SHUFFLE(3, 1, 2, 0)));
+  *pIm = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))),
+                                                _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+static inline void VF_CPXSTORE(float32_t *p, VF Re, VF Im)
+{
+  Re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(Re), _MM_SHUFFLE(3, 1, 2, 0)));
+  Im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(Im), _MM_SHUFFLE(3, 1, 2, 0)));
+  _mm256_storeu_ps(p, _mm256_unpacklo_ps(Re, Im));
+  _mm256_storeu_ps(p + 8, _mm256_unpackhi_ps(Re, Im));
+}
+
+/* 16-bit lanes of a and b interleaved: a0 b0 a1 b1 ... in *pLo, the second
+   half in *pHi; 64-bit permutes first, as the unpacks stay in their lane */
+static inline void VI_ZIP16(VI a, VI b, VI *pLo, VI *pHi)
+{
+  a = _mm256_permute4x64_epi64(a, _MM_SHUFFLE(3, 1, 2, 0));
+  b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(3, 1, 2, 0));
+  *pLo = _mm256_unpacklo_epi16(a, b);
+  *pHi = _mm256_unpackhi_epi16(a, b);
+}
+
+/* 8 x 8 transpose in place */
+static inline void VF_TRANSPOSE(VF *r)
+{
+  VF t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+  VF t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+  VF t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+  VF t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+  VF u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  VF u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  VF u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  VF u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  VF u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  VF u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  VF u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  VF u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+  r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+  r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+  r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+  r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+  r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+  r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+  r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+  r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+static inline float32_t VF_HSUM(VF a)
+{
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+static inline int64_t VI_HSUM64(VI a)
+{
+  __m128i s = _mm_add_epi64(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+
+  return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+}
+
+static inline int32_t VI_HSUM32(VI a)
+{
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(s);
+}
+
+#include "dsp_x86_template.h"
@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file    dsp_x86_kernels.h
+  * @brief   Kernels behind dsp_x86.c, one set per path: the CMSIS-DSP C
+  *          sources renamed with a _c suffix (host/CMakeLists.txt), and the
+  *          _sse41 and _avx2 sets built from dsp_x86_template.h.
+  ******************************************************************************
+  */
+#ifndef __DSP_X86_KERNELS_H
+#define __DSP_X86_KERNELS_H
+
+#include "arm_math.h"
+
+#define DSP_X86_DECLARE(suffix)                                                                  \
+void       arm_fir_f32_##suffix(const arm_fir_instance_f32 *S, float32_t *pSrc,                 \
+                                float32_t *pDst, uint32_t blockSize);                           \
+void       arm_fir_q15_##suffix(const arm_fir_instance_q15 *S, q15_t *pSrc, q15_t *pDst,        \
+                                uint32_t blockSize);                                            \
+void       arm_biquad_cascade_df1_f32_##suffix(const arm_biquad_casd_df1_inst_f32 *S,           \
+                                               float32_t *pSrc, float32_t *pDst,                \
+                                               uint32_t blockSize);                             \
+void       arm_cfft_f32_##suffix(const arm_cfft_instance_f32 *S, float32_t *p1,                 \
+                                 uint8_t ifftFlag, uint8_t bitReverseFlag);                     \
+void       arm_dot_prod_f32_##suffix(float32_t *pSrcA, float32_t *pSrcB, uint32_t blockSize,    \
+                                     float32_t *result);                                        \
+void       arm_dot_prod_q31_##suffix(q31_t *pSrcA, q31_t *pSrcB, uint32_t blockSize,            \
+                                     q63_t *result);                                            \
+void       arm_dot_prod_q15_##suffix(q15_t *pSrcA, q15_t *pSrcB, uint32_t blockSize,            \
+                                     q63_t *result);                                            \
+void       arm_dot_prod_q7_##suffix(q7_t *pSrcA, q7_t *pSrcB, uint32_t blockSize,               \
+                                    q31_t *result);                                             \
+arm_status arm_mat_mult_f32_##suffix(const arm_matrix_instance_f32 *pSrcA,                      \
+                                     const arm_matrix_instance_f32 *pSrcB,                      \
+                                     arm_matrix_instance_f32 *pDst);
+
+DSP_X86_DECLARE(c)
+DSP_X86_DECLARE(sse41)
+DSP_X86_DECLARE(avx2)
+
+/* arm_bitreversal2.c */
+void arm_bitreversal_32(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTable);
+
+#endif /* __DSP_X86_KERNELS_H */
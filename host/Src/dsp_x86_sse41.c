@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file    dsp_x86_sse41.c
+  * @brief   SSE4.1 kernels of dsp_x86.c: dsp_x86_template.h on 128-bit
+  *          vectors, 4 floats or 8 int16. Built with -msse4.1.
+  ******************************************************************************
+  */
+#include "dsp_x86_kernels.h"
+#include <smmintrin.h>
+#include <string.h>
+
+#define DSP_X86_FN(name)         name##_sse41
+#define VW                       4U
+#define VW16                     8U
+
+typedef __m128  VF;
+typedef __m128i VI;
+
+#define VF_ZERO()                _mm_setzero_ps()
+#define VF_SET1(x)               _mm_set1_ps(x)
+#define VF_LOAD(p)               _mm_loadu_ps(p)
+#define VF_STORE(p, v)           _mm_storeu_ps((p), (v))
+#define VF_LOADMASK(p)           _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(p)))
+#define VF_ADD(a, b)             _mm_add_ps((a), (b))
+#define VF_SUB(a, b)             _mm_sub_ps((a), (b))
+#define VF_MUL(a, b)             _mm_mul_ps((a), (b))
+#define VF_NEG(a)                _mm_xor_ps((a), _mm_set1_ps(-0.0f))
+/* Lanes of b where the mask is set, of a elsewhere */
+#define VF_BLEND(a, b, mask)     _mm_blendv_ps((a), (b), (mask))
+#define VF_REVERSE(a)            _mm_shuffle_ps((a), (a), _MM_SHUFFLE(0, 1, 2, 3))
+/* x in lane 0, lanes 0 to 2 of a in lanes 1 to 3 */
+#define VF_SHIFTIN(a, x)         _mm_move_ss(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a), 4)), _mm_set_ss(x))
+
+#define VI_ZERO()                _mm_setzero_si128()
+#define VI_SET1_32(x)            _mm_set1_epi32(x)
+#define VI_SET1_64(x)            _mm_set1_epi64x(x)
+#define VI_LOAD(p)               _mm_loadu_si128((const __m128i *)(const void *)(p))
+#define VI_STORE(p, v)           _mm_storeu_si128((__m128i *)(void *)(p), (v))
+#define VI_LOAD8TO16(p)          _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)(const void *)(p)))
+#define VI_ADD32(a, b)           _mm_add_epi32((a), (b))
+#define VI_SUB32(a, b)           _mm_sub_epi32((a), (b))
+#define VI_ADD64(a, b)           _mm_add_epi64((a), (b))
+#define VI_SUB64(a, b)           _mm_sub_epi64((a), (b))
+#define VI_XOR(a, b)             _mm_xor_si128((a), (b))
+#define VI_SRLI64(a, n)          _mm_srli_epi64((a), (n))
+#define VI_MUL32(a, b)           _mm_mul_epi32((a), (b))
+#define VI_MADD16(a, b)          _mm_madd_epi16((a), (b))
+#define VI_WIDEN_LO(a)           _mm_cvtepi32_epi64(a)
+#define VI_WIDEN_HI(a)           _mm_cvtepi32_epi64(_mm_srli_si128((a), 8))
+
+/* Interleaved real and imaginary parts of 4 complex values */
+static inline void VF_CPXLOAD(const float32_t *p, VF *pRe, VF *pIm)
+{
+  VF a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4);
+
+  *pRe = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  *pIm = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static inline void VF_CPXSTORE(float32_t *p, VF Re, VF Im)
+{
+  _mm_storeu_ps(p, _mm_unpacklo_ps(Re, Im));
+  _mm_storeu_ps(p + 4, _mm_unpackhi_ps(Re, Im));
+}
+
+/* 16-bit lanes of a and b interleaved: a0 b0 a1 b1 ... in *pLo, the second
+   half in *pHi */
+static inline void VI_ZIP16(VI a, VI b, VI *pLo, VI *pHi)
+{
+  *pLo = _mm_unpacklo_epi16(a, b);
+  *pHi = _mm_unpackhi_epi16(a, b);
+}
+
+#define VF_TRANSPOSE(r)          _MM_TRANSPOSE4_PS((r)[0], (r)[1], (r)[2], (r)[3])
+
+static inline float32_t VF_HSUM(VF a)
+{
+  a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+  a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+  return _mm_cvtss_f32(a);
+}
+
+static inline int64_t VI_HSUM64(VI a)
+{
+  return _mm_cvtsi128_si64(a) + _mm_extract_epi64(a, 1);
+}
+
+static inline int32_t VI_HSUM32(VI a)
+{
+  a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+  a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(a);
+}
+
+#include "dsp_x86_template.h"
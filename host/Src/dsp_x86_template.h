@@ -0,0 +1,872 @@
+/**
+  ******************************************************************************
+  * @file    dsp_x86_template.h
+  * @brief   SIMD versions of the CMSIS-DSP kernels listed in dsp_x86.h,
+  *          written once for the vector operations of the including file:
+  *          dsp_x86_sse41.c (4 float lanes) and dsp_x86_avx2.c (8).
+  *
+  *          The including file defines DSP_X86_FN(name), naming the kernels
+  *          of its path, VW, the float lanes, VW16, the 16-bit lanes, and
+  *          the VF_ (float) and VI_ (integer) operations used below.
+  *
+  ==============================================================================
+                          ##### Notes #####
+  ==============================================================================
+  *  The results are those of the Cortex-M0 C code, bit for bit: each output
+  *  goes through the same operations, in the same order, as in the C code,
+  *  only several outputs at once. Hence the layout of the loops:
+  *   - FIR and matrix product: the lanes hold consecutive outputs, each
+  *     summed tap after tap as in C;
+  *   - biquad cascade: the lanes hold consecutive stages, lane s filtering
+  *     sample t - s while lane s - 1 filters sample t - s + 1 (a wavefront),
+  *     the stage outputs moving one lane up at each step;
+  *   - complex FFT: the lanes hold butterflies of the same stage, found at
+  *     consecutive addresses in the first stages (twiddles gathered per
+  *     lane) and eight complex values apart in the last one (transposed);
+  *   - integer dot products: exact in any order, 64-bit lanes where C sums
+  *     in 64 bits.
+  *  arm_dot_prod_f32() is the exception: its sum is split over the lanes.
+  *
+  *  The host build disables floating-point contraction (-ffp-contract=off):
+  *  neither path may fuse a multiply and an add the other does not.
+  *
+  *  _mm_madd_epi16() overflows on one pair only, -32768 * -32768 twice,
+  *  2^31; every other pair sum is in [-2^31 + 2^16, 2^31 - 1]. Subtracting
+  *  1 from the pair sums, which wraps 2^31 to 2^31 - 1 exactly, and adding
+  *  the count back to the 64-bit total keeps the q15 sums exact.
+  ******************************************************************************
+  */
+
+#define C81                      0.70710678118f
+
+/* Radix-8 butterfly on eight legs of VW butterflies, the first loop of
+   arm_radix8_butterfly_f32() when pCo is NULL, the second one otherwise,
+   the legs 2 to 8 multiplied by the conjugates of pCo[1..7], pSi[1..7].
+   Lanes set in Keep are left unmultiplied (the twiddle-free j = 0). */
+static inline __attribute__((always_inline))
+void DSP_X86_FN(Radix8)(VF *xr, VF *xi, const VF *pCo, const VF *pSi, VF Keep)
+{
+  VF r1, r2, r3, r4, r5, r6, r7, r8, s1, s2, s3, s4, s5, s6, s7, s8, t1, t2;
+  VF c81 = VF_SET1(C81);
+  VF orr[8], oi[8];
+  int k;
+
+  r1 = VF_ADD(xr[0], xr[4]);
+  r5 = VF_SUB(xr[0], xr[4]);
+  r2 = VF_ADD(xr[1], xr[5]);
+  r6 = VF_SUB(xr[1], xr[5]);
+  r3 = VF_ADD(xr[2], xr[6]);
+  r7 = VF_SUB(xr[2], xr[6]);
+  r4 = VF_ADD(xr[3], xr[7]);
+  r8 = VF_SUB(xr[3], xr[7]);
+  t1 = VF_SUB(r1, r3);
+  r1 = VF_ADD(r1, r3);
+  r3 = VF_SUB(r2, r4);
+  r2 = VF_ADD(r2, r4);
+  orr[0] = VF_ADD(r1, r2);
+  r2 = VF_SUB(r1, r2);
+  s1 = VF_ADD(xi[0], xi[4]);
+  s5 = VF_SUB(xi[0], xi[4]);
+  s2 = VF_ADD(xi[1], xi[5]);
+  s6 = VF_SUB(xi[1], xi[5]);
+  s3 = VF_ADD(xi[2], xi[6]);
+  s7 = VF_SUB(xi[2], xi[6]);
+  s4 = VF_ADD(xi[3], xi[7]);
+  s8 = VF_SUB(xi[3], xi[7]);
+  t2 = VF_SUB(s1, s3);
+  s1 = VF_ADD(s1, s3);
+  s3 = VF_SUB(s2, s4);
+  s2 = VF_ADD(s2, s4);
+  r1 = VF_ADD(t1, s3);
+  t1 = VF_SUB(t1, s3);
+  oi[0] = VF_ADD(s1, s2);
+  s2 = VF_SUB(s1, s2);
+  s1 = VF_SUB(t2, r3);
+  t2 = VF_ADD(t2, r3);
+  orr[4] = r2;
+  oi[4] = s2;
+  orr[2] = r1;
+  oi[2] = s1;
+  orr[6] = t1;
+  oi[6] = t2;
+  r1 = VF_MUL(VF_SUB(r6, r8), c81);
+  r6 = VF_MUL(VF_ADD(r6, r8), c81);
+  s1 = VF_MUL(VF_SUB(s6, s8), c81);
+  s6 = VF_MUL(VF_ADD(s6, s8), c81);
+  t1 = VF_SUB(r5, r1);
+  r5 = VF_ADD(r5, r1);
+  r8 = VF_SUB(r7, r6);
+  r7 = VF_ADD(r7, r6);
+  t2 = VF_SUB(s5, s1);
+  s5 = VF_ADD(s5, s1);
+  s8 = VF_SUB(s7, s6);
+  s7 = VF_ADD(s7, s6);
+  orr[1] = VF_ADD(r5, s7);
+  orr[7] = VF_SUB(r5, s7);
+  orr[5] = VF_ADD(t1, s8);
+  orr[3] = VF_SUB(t1, s8);
+  oi[1] = VF_SUB(s5, r7);
+  oi[7] = VF_ADD(s5, r7);
+  oi[5] = VF_SUB(t2, r8);
+  oi[3] = VF_ADD(t2, r8);
+
+  xr[0] = orr[0];
+  xi[0] = oi[0];
+  for (k = 1; k < 8; k++)
+  {
+    if (pCo != NULL)
+    {
+      /* p1 + p2, p3 - p4 */
+      VF pr = VF_ADD(VF_MUL(pCo[k], orr[k]), VF_MUL(pSi[k], oi[k]));
+      VF pi = VF_SUB(VF_MUL(pCo[k], oi[k]), VF_MUL(pSi[k], orr[k]));
+
+      xr[k] = VF_BLEND(pr, orr[k], Keep);
+      xi[k] = VF_BLEND(pi, oi[k], Keep);
+    }
+    else
+    {
+      xr[k] = orr[k];
+      xi[k] = oi[k];
+    }
+  }
+}
+
+/* arm_radix8_butterfly_f32() on fftLen >= 64 complex values */
+static void DSP_X86_FN(Radix8Stages)(float32_t *pSrc, uint32_t fftLen, const float32_t *pCoef,
+                                     uint32_t twidCoefModifier)
+{
+  VF       xr[8], xi[8], co[8], si[8], rows[VW], keep0, keepNone = VF_ZERO();
+  float32_t tr[VW], ti[VW];
+  int32_t  first[VW];
+  uint32_t n1, n2 = fftLen, i1, j, k, l, q, c;
+
+  for (l = 0; l < VW; l++)
+  {
+    first[l] = (l == 0U) ? -1 : 0;
+  }
+  keep0 = VF_LOADMASK(first);
+
+  do
+  {
+    n1 = n2;
+    n2 = n2 >> 3;
+
+    if (n2 >= VW)
+    {
+      /* Lanes j to j + VW - 1: consecutive addresses in each leg */
+      for (j = 0; j < n2; j += VW)
+      {
+        for (k = 1; k < 8; k++)
+        {
+          for (l = 0; l < VW; l++)
+          {
+            tr[l] = pCoef[2U * (k * (j + l) * twidCoefModifier)];
+            ti[l] = pCoef[2U * (k * (j + l) * twidCoefModifier) + 1U];
+          }
+          co[k] = VF_LOAD(tr);
+          si[k] = VF_LOAD(ti);
+        }
+        for (i1 = j; i1 < fftLen; i1 += n1)
+        {
+          for (k = 0; k < 8; k++)
+          {
+            VF_CPXLOAD(pSrc + 2U * (i1 + k * n2), &xr[k], &xi[k]);
+          }
+          DSP_X86_FN(Radix8)(xr, xi, co, si, (j == 0U) ? keep0 : keepNone);
+          for (k = 0; k < 8; k++)
+          {
+            VF_CPXSTORE(pSrc + 2U * (i1 + k * n2), xr[k], xi[k]);
+          }
+        }
+      }
+    }
+    else
+    {
+      /* n2 = 1, the last stage: VW butterflies of eight consecutive values
+         each, VW floats of each transposed into lanes. fftLen / 8 is a
+         multiple of VW from fftLen = 64 */
+      for (i1 = 0; i1 < fftLen; i1 += 8U * VW)
+      {
+        for (q = 0; q < 16U / VW; q++)
+        {
+          for (l = 0; l < VW; l++)
+          {
+            rows[l] = VF_LOAD(pSrc + 2U * (i1 + 8U * l) + q * VW);
+          }
+          VF_TRANSPOSE(rows);
+          for (c = 0; c < VW; c++)
+          {
+            if (((q * VW + c) & 1U) == 0U)
+            {
+              xr[(q * VW + c) >> 1] = rows[c];
+            }
+            else
+            {
+              xi[(q * VW + c) >> 1] = rows[c];
+            }
+          }
+        }
+        DSP_X86_FN(Radix8)(xr, xi, NULL, NULL, keepNone);
+        for (q = 0; q < 16U / VW; q++)
+        {
+          for (c = 0; c < VW; c++)
+          {
+            rows[c] = (((q * VW + c) & 1U) == 0U) ? xr[(q * VW + c) >> 1] : xi[(q * VW + c) >> 1];
+          }
+          VF_TRANSPOSE(rows);
+          for (l = 0; l < VW; l++)
+          {
+            VF_STORE(pSrc + 2U * (i1 + 8U * l) + q * VW, rows[l]);
+          }
+        }
+      }
+    }
+
+    twidCoefModifier <<= 3;
+  } while (n2 > 7U);
+}
+
+/* arm_cfft_radix8by2_f32(), fftLen >= 128 */
+static void DSP_X86_FN(Radix8by2)(const arm_cfft_instance_f32 *S, float32_t *p1)
+{
+  uint32_t  L = S->fftLen;
+  float32_t *p2 = p1 + L;
+  float32_t *pMid1 = p1 + (L >> 1);
+  float32_t *pMid2 = p2 + (L >> 1);
+  const float32_t *tw = S->pTwiddle;
+  VF ar, ai, br, bi, cr, ci, dr, di, wr, wi, t2r, t2i, t4r, t4i;
+  uint32_t k;
+
+  /* L / 4 complex values in each quarter */
+  for (k = 0; k < (L >> 2); k += VW)
+  {
+    VF_CPXLOAD(p1 + 2U * k, &ar, &ai);
+    VF_CPXLOAD(p2 + 2U * k, &br, &bi);
+    VF_CPXLOAD(pMid1 + 2U * k, &cr, &ci);
+    VF_CPXLOAD(pMid2 + 2U * k, &dr, &di);
+    VF_CPXLOAD(tw + 2U * k, &wr, &wi);
+
+    VF_CPXSTORE(p1 + 2U * k, VF_ADD(ar, br), VF_ADD(ai, bi));
+    t2r = VF_SUB(ar, br);
+    t2i = VF_SUB(ai, bi);
+    VF_CPXSTORE(pMid1 + 2U * k, VF_ADD(cr, dr), VF_ADD(ci, di));
+    t4r = VF_SUB(dr, cr);
+    t4i = VF_SUB(di, ci);
+
+    VF_CPXSTORE(p2 + 2U * k,
+                VF_ADD(VF_MUL(t2r, wr), VF_MUL(t2i, wi)),
+                VF_SUB(VF_MUL(t2i, wr), VF_MUL(t2r, wi)));
+    VF_CPXSTORE(pMid2 + 2U * k,
+                VF_SUB(VF_MUL(t4r, wi), VF_MUL(t4i, wr)),
+                VF_ADD(VF_MUL(t4i, wi), VF_MUL(t4r, wr)));
+  }
+
+  DSP_X86_FN(Radix8Stages)(p1, L >> 1, S->pTwiddle, 2U);
+  DSP_X86_FN(Radix8Stages)(p2, L >> 1, S->pTwiddle, 2U);
+}
+
+/* One value k of the top half of arm_cfft_radix8by4_f32(), k = 0 to L / 2
+   for columns of L values, its twiddles at k, 2k and 3k (none for k = 0) */
+static void DSP_X86_FN(By4Top)(float32_t *p1, uint32_t L, const float32_t *tw, uint32_t k)
+{
+  float32_t *a = p1 + 2U * k, *b = a + 2U * L, *c = b + 2U * L, *d = c + 2U * L;
+  float32_t p1ap3_0, p1sp3_0, p1ap3_1, p1sp3_1, t2[2], t3[2], t4[2];
+  float32_t twR, twI;
+
+  p1ap3_0 = a[0] + c[0];
+  p1sp3_0 = a[0] - c[0];
+  p1ap3_1 = a[1] + c[1];
+  p1sp3_1 = a[1] - c[1];
+  t2[0] = p1sp3_0 + b[1] - d[1];
+  t2[1] = p1sp3_1 - b[0] + d[0];
+  t3[0] = p1ap3_0 - b[0] - d[0];
+  t3[1] = p1ap3_1 - b[1] - d[1];
+  t4[0] = p1sp3_0 - b[1] + d[1];
+  t4[1] = p1sp3_1 + b[0] - d[0];
+  a[0] = p1ap3_0 + b[0] + d[0];
+  a[1] = p1ap3_1 + b[1] + d[1];
+
+  if (k == 0U)
+  {
+    b[0] = t2[0];
+    b[1] = t2[1];
+    c[0] = t3[0];
+    c[1] = t3[1];
+    d[0] = t4[0];
+    d[1] = t4[1];
+    return;
+  }
+  twR = tw[2U * k];
+  twI = tw[2U * k + 1U];
+  b[0] = t2[0] * twR + t2[1] * twI;
+  b[1] = t2[1] * twR - t2[0] * twI;
+  twR = tw[4U * k];
+  twI = tw[4U * k + 1U];
+  c[0] = t3[0] * twR + t3[1] * twI;
+  c[1] = t3[1] * twR - t3[0] * twI;
+  twR = tw[6U * k];
+  twI = tw[6U * k + 1U];
+  d[0] = t4[0] * twR + t4[1] * twI;
+  d[1] = t4[1] * twR - t4[0] * twI;
+}
+
+/* Value L - k of the bottom half, k = 1 to L / 2 - 1, with the twiddles of
+   k by symmetry */
+static void DSP_X86_FN(By4Bottom)(float32_t *p1, uint32_t L, const float32_t *tw, uint32_t k)
+{
+  float32_t *a = p1 + 2U * (L - k), *b = a + 2U * L, *c = b + 2U * L, *d = c + 2U * L;
+  float32_t p1ap3_0, p1sp3_0, p1ap3_1, p1sp3_1, t2[4], t3[4], t4[4];
+  float32_t twR, twI;
+
+  p1ap3_1 = a[0] + c[0];
+  p1sp3_1 = a[0] - c[0];
+  p1ap3_0 = a[1] + c[1];
+  p1sp3_0 = a[1] - c[1];
+  t2[2] = b[1] - d[1] + p1sp3_1;
+  t2[3] = a[1] - c[1] - b[0] + d[0];
+  t3[2] = p1ap3_1 - b[0] - d[0];
+  t3[3] = p1ap3_0 - b[1] - d[1];
+  t4[2] = b[1] - d[1] - p1sp3_1;
+  t4[3] = d[0] - b[0] - p1sp3_0;
+  a[1] = p1ap3_0 + b[1] + d[1];
+  a[0] = p1ap3_1 + b[0] + d[0];
+
+  twR = tw[2U * k];
+  twI = tw[2U * k + 1U];
+  b[1] = t2[3] * twI - t2[2] * twR;
+  b[0] = t2[2] * twI + t2[3] * twR;
+  twR = tw[4U * k];
+  twI = tw[4U * k + 1U];
+  c[1] = -t3[3] * twR - t3[2] * twI;
+  c[0] = t3[3] * twI - t3[2] * twR;
+  twR = tw[6U * k];
+  twI = tw[6U * k + 1U];
+  d[1] = t4[3] * twI - t4[2] * twR;
+  d[0] = t4[2] * twI + t4[3] * twR;
+}
+
+/* arm_cfft_radix8by4_f32(), fftLen >= 256 */
+static void DSP_X86_FN(Radix8by4)(const arm_cfft_instance_f32 *S, float32_t *p1)
+{
+  uint32_t  L = (uint32_t)S->fftLen >> 2;  /* complex values per column */
+  const float32_t *tw = S->pTwiddle;
+  float32_t *pc[4], w2r[VW], w2i[VW], w3r[VW], w3i[VW], w4r[VW], w4i[VW];
+  VF ar, ai, br, bi, cr, ci, dr, di, r2, i2, r3, i3, r4, i4;
+  VF apr, api, asr, asi, t2r, t2i, t3r, t3i, t4r, t4i;
+  uint32_t k, l, m;
+
+  pc[0] = p1;
+  pc[1] = p1 + 2U * L;
+  pc[2] = p1 + 4U * L;
+  pc[3] = p1 + 6U * L;
+
+  DSP_X86_FN(By4Top)(p1, L, tw, 0U);
+  for (k = 1; k + VW <= (L >> 1); k += VW)
+  {
+    for (l = 0; l < VW; l++)
+    {
+      w2r[l] = tw[2U * (k + l)];
+      w2i[l] = tw[2U * (k + l) + 1U];
+      w3r[l] = tw[4U * (k + l)];
+      w3i[l] = tw[4U * (k + l) + 1U];
+      w4r[l] = tw[6U * (k + l)];
+      w4i[l] = tw[6U * (k + l) + 1U];
+    }
+    r2 = VF_LOAD(w2r);
+    i2 = VF_LOAD(w2i);
+    r3 = VF_LOAD(w3r);
+    i3 = VF_LOAD(w3i);
+    r4 = VF_LOAD(w4r);
+    i4 = VF_LOAD(w4i);
+
+    /* Top: values k to k + VW - 1 */
+    VF_CPXLOAD(pc[0] + 2U * k, &ar, &ai);
+    VF_CPXLOAD(pc[1] + 2U * k, &br, &bi);
+    VF_CPXLOAD(pc[2] + 2U * k, &cr, &ci);
+    VF_CPXLOAD(pc[3] + 2U * k, &dr, &di);
+    apr = VF_ADD(ar, cr);
+    asr = VF_SUB(ar, cr);
+    api = VF_ADD(ai, ci);
+    asi = VF_SUB(ai, ci);
+    t2r = VF_SUB(VF_ADD(asr, bi), di);
+    t2i = VF_ADD(VF_SUB(asi, br), dr);
+    t3r = VF_SUB(VF_SUB(apr, br), dr);
+    t3i = VF_SUB(VF_SUB(api, bi), di);
+    t4r = VF_ADD(VF_SUB(asr, bi), di);
+    t4i = VF_SUB(VF_ADD(asi, br), dr);
+    VF_CPXSTORE(pc[0] + 2U * k, VF_ADD(VF_ADD(apr, br), dr), VF_ADD(VF_ADD(api, bi), di));
+    VF_CPXSTORE(pc[1] + 2U * k, VF_ADD(VF_MUL(t2r, r2), VF_MUL(t2i, i2)),
+                VF_SUB(VF_MUL(t2i, r2), VF_MUL(t2r, i2)));
+    VF_CPXSTORE(pc[2] + 2U * k, VF_ADD(VF_MUL(t3r, r3), VF_MUL(t3i, i3)),
+                VF_SUB(VF_MUL(t3i, r3), VF_MUL(t3r, i3)));
+    VF_CPXSTORE(pc[3] + 2U * k, VF_ADD(VF_MUL(t4r, r4), VF_MUL(t4i, i4)),
+                VF_SUB(VF_MUL(t4i, r4), VF_MUL(t4r, i4)));
+
+    /* Bottom: values L - k down to L - k - VW + 1, lanes reversed to line
+       up with the twiddles of k */
+    m = L - k - (VW - 1U);
+    VF_CPXLOAD(pc[0] + 2U * m, &ar, &ai);
+    VF_CPXLOAD(pc[1] + 2U * m, &br, &bi);
+    VF_CPXLOAD(pc[2] + 2U * m, &cr, &ci);
+    VF_CPXLOAD(pc[3] + 2U * m, &dr, &di);
+    ar = VF_REVERSE(ar);
+    ai = VF_REVERSE(ai);
+    br = VF_REVERSE(br);
+    bi = VF_REVERSE(bi);
+    cr = VF_REVERSE(cr);
+    ci = VF_REVERSE(ci);
+    dr = VF_REVERSE(dr);
+    di = VF_REVERSE(di);
+    apr = VF_ADD(ar, cr);
+    asr = VF_SUB(ar, cr);
+    api = VF_ADD(ai, ci);
+    asi = VF_SUB(ai, ci);
+    t2r = VF_ADD(VF_SUB(bi, di), asr);
+    t2i = VF_ADD(VF_SUB(VF_SUB(ai, ci), br), dr);
+    t3r = VF_SUB(VF_SUB(apr, br), dr);
+    t3i = VF_SUB(VF_SUB(api, bi), di);
+    t4r = VF_SUB(VF_SUB(bi, di), asr);
+    t4i = VF_SUB(VF_SUB(dr, br), asi);
+    VF_CPXSTORE(pc[0] + 2U * m, VF_REVERSE(VF_ADD(VF_ADD(apr, br), dr)),
+                VF_REVERSE(VF_ADD(VF_ADD(api, bi), di)));
+    VF_CPXSTORE(pc[1] + 2U * m, VF_REVERSE(VF_ADD(VF_MUL(t2r, i2), VF_MUL(t2i, r2))),
+                VF_REVERSE(VF_SUB(VF_MUL(t2i, i2), VF_MUL(t2r, r2))));
+    VF_CPXSTORE(pc[2] + 2U * m, VF_REVERSE(VF_SUB(VF_MUL(t3i, i3), VF_MUL(t3r, r3))),
+                VF_REVERSE(VF_SUB(VF_MUL(VF_NEG(t3i), r3), VF_MUL(t3r, i3))));
+    VF_CPXSTORE(pc[3] + 2U * m, VF_REVERSE(VF_ADD(VF_MUL(t4r, i4), VF_MUL(t4i, r4))),
+                VF_REVERSE(VF_SUB(VF_MUL(t4i, i4), VF_MUL(t4r, r4))));
+  }
+  for (; k < (L >> 1); k++)
+  {
+    DSP_X86_FN(By4Top)(p1, L, tw, k);
+    DSP_X86_FN(By4Bottom)(p1, L, tw, k);
+  }
+  DSP_X86_FN(By4Top)(p1, L, tw, L >> 1);
+
+  for (l = 0; l < 4U; l++)
+  {
+    DSP_X86_FN(Radix8Stages)(pc[l], L, S->pTwiddle, 4U);
+  }
+}
+
+void DSP_X86_FN(arm_cfft_f32)(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag,
+                              uint8_t bitReverseFlag)
+{
+  uint32_t  L = S->fftLen, l;
+  float32_t invL, *pSrc;
+
+  if (L < 64U)
+  {
+    arm_cfft_f32_c(S, p1, ifftFlag, bitReverseFlag);
+    return;
+  }
+
+  if (ifftFlag == 1U)
+  {
+    pSrc = p1 + 1;
+    for (l = 0; l < L; l++)
+    {
+      *pSrc = -*pSrc;
+      pSrc += 2;
+    }
+  }
+
+  switch (L)
+  {
+  case 128:
+  case 1024:
+    DSP_X86_FN(Radix8by2)(S, p1);
+    break;
+  case 256:
+  case 2048:
+    DSP_X86_FN(Radix8by4)(S, p1);
+    break;
+  case 64:
+  case 512:
+  case 4096:
+    DSP_X86_FN(Radix8Stages)(p1, L, S->pTwiddle, 1U);
+    break;
+  }
+
+  if (bitReverseFlag)
+  {
+    arm_bitreversal_32((uint32_t *)p1, S->bitRevLength, S->pBitRevTable);
+  }
+
+  if (ifftFlag == 1U)
+  {
+    invL = 1.0f / (float32_t)L;
+    pSrc = p1;
+    for (l = 0; l < L; l++)
+    {
+      *pSrc++ *= invL;
+      *pSrc = -(*pSrc) * invL;
+      pSrc++;
+    }
+  }
+}
+
+void DSP_X86_FN(arm_fir_f32)(const arm_fir_instance_f32 *S, float32_t *pSrc, float32_t *pDst,
+                             uint32_t blockSize)
+{
+  float32_t *pState = S->pState;
+  const float32_t *pCoeffs = S->pCoeffs;
+  uint32_t  numTaps = S->numTaps, n = 0, i;
+  float32_t acc;
+
+  /* The whole block into the state first: pSrc may be pDst */
+  memcpy(pState + (numTaps - 1U), pSrc, blockSize * sizeof(float32_t));
+
+  for (; n + 4U * VW <= blockSize; n += 4U * VW)
+  {
+    VF acc0 = VF_ZERO(), acc1 = VF_ZERO(), acc2 = VF_ZERO(), acc3 = VF_ZERO();
+
+    for (i = 0; i < numTaps; i++)
+    {
+      VF b = VF_SET1(pCoeffs[i]);
+      const float32_t *px = pState + n + i;
+
+      acc0 = VF_ADD(acc0, VF_MUL(VF_LOAD(px), b));
+      acc1 = VF_ADD(acc1, VF_MUL(VF_LOAD(px + VW), b));
+      acc2 = VF_ADD(acc2, VF_MUL(VF_LOAD(px + 2U * VW), b));
+      acc3 = VF_ADD(acc3, VF_MUL(VF_LOAD(px + 3U * VW), b));
+    }
+    VF_STORE(pDst + n, acc0);
+    VF_STORE(pDst + n + VW, acc1);
+    VF_STORE(pDst + n + 2U * VW, acc2);
+    VF_STORE(pDst + n + 3U * VW, acc3);
+  }
+  for (; n + VW <= blockSize; n += VW)
+  {
+    VF acc0 = VF_ZERO();
+
+    for (i = 0; i < numTaps; i++)
+    {
+      acc0 = VF_ADD(acc0, VF_MUL(VF_LOAD(pState + n + i), VF_SET1(pCoeffs[i])));
+    }
+    VF_STORE(pDst + n, acc0);
+  }
+  for (; n < blockSize; n++)
+  {
+    acc = 0.0f;
+    for (i = 0; i < numTaps; i++)
+    {
+      acc += pState[n + i] * pCoeffs[i];
+    }
+    pDst[n] = acc;
+  }
+
+  memmove(pState, pState + blockSize, (numTaps - 1U) * sizeof(float32_t));
+}
+
+/* Sum of the products of n q15 pairs, exact */
+static inline q63_t DSP_X86_FN(DotQ15)(const q15_t *pA, const q15_t *pB, uint32_t n)
+{
+  VI       acc = VI_ZERO(), one = VI_SET1_32(1), m;
+  q63_t    sum, pairs = 0;
+  uint32_t i = 0;
+
+  for (; i + VW16 <= n; i += VW16)
+  {
+    m = VI_SUB32(VI_MADD16(VI_LOAD(pA + i), VI_LOAD(pB + i)), one);
+    acc = VI_ADD64(acc, VI_ADD64(VI_WIDEN_LO(m), VI_WIDEN_HI(m)));
+    pairs += VW16 / 2U;
+  }
+  sum = VI_HSUM64(acc) + pairs;
+  for (; i < n; i++)
+  {
+    sum += (q63_t)((q31_t)pA[i] * pB[i]);
+  }
+  return sum;
+}
+
+void DSP_X86_FN(arm_fir_q15)(const arm_fir_instance_q15 *S, q15_t *pSrc, q15_t *pDst,
+                             uint32_t blockSize)
+{
+  q15_t   *pState = S->pState;
+  const q15_t *pCoeffs = S->pCoeffs;
+  uint32_t numTaps = S->numTaps, n = 0, i;
+  int64_t  acc[VW16];
+  q63_t    pairs = (numTaps + 1U) / 2U;
+  VI       one = VI_SET1_32(1), c, lo, hi;
+
+  memcpy(pState + (numTaps - 1U), pSrc, blockSize * sizeof(q15_t));
+
+  /* VW16 outputs at a time, two taps per _mm_madd_epi16(): the lanes of
+     (x[n + i], x[n + i + 1]) against (b[i], b[i + 1]) */
+  for (; (numTaps >= 2U) && (n + VW16 <= blockSize); n += VW16)
+  {
+    const q15_t *px = pState + n;
+    VI acc0 = VI_ZERO(), acc1 = VI_ZERO(), acc2 = VI_ZERO(), acc3 = VI_ZERO();
+
+    for (i = 0; i < numTaps; i += 2U)
+    {
+      if (i + 1U < numTaps)
+      {
+        c = VI_SET1_32((int32_t)(uint16_t)pCoeffs[i] | ((int32_t)pCoeffs[i + 1U] * 65536));
+        VI_ZIP16(VI_LOAD(px + i), VI_LOAD(px + i + 1U), &lo, &hi);
+      }
+      else
+      {
+        /* Odd last tap, as (x[n + i - 1], x[n + i]) against (0, b[i]):
+           no read past the state */
+        c = VI_SET1_32((int32_t)pCoeffs[i] * 65536);
+        VI_ZIP16(VI_LOAD(px + i - 1U), VI_LOAD(px + i), &lo, &hi);
+      }
+      lo = VI_SUB32(VI_MADD16(lo, c), one);
+      hi = VI_SUB32(VI_MADD16(hi, c), one);
+      acc0 = VI_ADD64(acc0, VI_WIDEN_LO(lo));
+      acc1 = VI_ADD64(acc1, VI_WIDEN_HI(lo));
+      acc2 = VI_ADD64(acc2, VI_WIDEN_LO(hi));
+      acc3 = VI_ADD64(acc3, VI_WIDEN_HI(hi));
+    }
+    VI_STORE(acc, acc0);
+    VI_STORE(acc + VW16 / 4U, acc1);
+    VI_STORE(acc + VW16 / 2U, acc2);
+    VI_STORE(acc + 3U * VW16 / 4U, acc3);
+    for (i = 0; i < VW16; i++)
+    {
+      pDst[n + i] = (q15_t)__SSAT((q31_t)((acc[i] + pairs) >> 15), 16);
+    }
+  }
+  for (; n < blockSize; n++)
+  {
+    pDst[n] = (q15_t)__SSAT((q31_t)(DSP_X86_FN(DotQ15)(pState + n, pCoeffs, numTaps) >> 15), 16);
+  }
+
+  memmove(pState, pState + blockSize, (numTaps - 1U) * sizeof(q15_t));
+}
+
+void DSP_X86_FN(arm_biquad_cascade_df1_f32)(const arm_biquad_casd_df1_inst_f32 *S, float32_t *pSrc,
+                                            float32_t *pDst, uint32_t blockSize)
+{
+  float32_t *pIn = pSrc;
+  float32_t *pState = S->pState;
+  const float32_t *pCoeffs = S->pCoeffs;
+  float32_t b[5][VW], st[4][VW], out[VW];
+  int32_t   active[VW];
+  VF        b0, b1, b2, a1, a2, xn1, xn2, yn1, yn2, xn, acc, mask;
+  uint32_t  stage = 0, count, s, t, steps;
+
+  while (stage < S->numStages)
+  {
+    count = S->numStages - stage;
+    count = (count > VW) ? VW : count;
+
+    /* Lanes past the last stage filter nothing: zero coefficients */
+    memset(b, 0, sizeof(b));
+    memset(st, 0, sizeof(st));
+    for (s = 0; s < count; s++)
+    {
+      for (t = 0; t < 5U; t++)
+      {
+        b[t][s] = pCoeffs[5U * (stage + s) + t];
+      }
+      for (t = 0; t < 4U; t++)
+      {
+        st[t][s] = pState[4U * (stage + s) + t];
+      }
+    }
+    b0 = VF_LOAD(b[0]);
+    b1 = VF_LOAD(b[1]);
+    b2 = VF_LOAD(b[2]);
+    a1 = VF_LOAD(b[3]);
+    a2 = VF_LOAD(b[4]);
+    xn1 = VF_LOAD(st[0]);
+    xn2 = VF_LOAD(st[1]);
+    yn1 = VF_LOAD(st[2]);
+    yn2 = VF_LOAD(st[3]);
+    acc = VF_ZERO();
+
+    /* Step t: lane s filters sample t - s, from lane s - 1 at step t - 1 */
+    steps = blockSize + count - 1U;
+    for (t = 0; t < steps; t++)
+    {
+      xn = VF_SHIFTIN(acc, (t < blockSize) ? pIn[t] : 0.0f);
+
+      /* acc = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] + a1 * y[n-1] + a2 * y[n-2] */
+      acc = VF_ADD(VF_ADD(VF_ADD(VF_ADD(VF_MUL(b0, xn), VF_MUL(b1, xn1)), VF_MUL(b2, xn2)),
+                          VF_MUL(a1, yn1)), VF_MUL(a2, yn2));
+
+      if ((t + 1U >= count) && (t < blockSize))
+      {
+        xn2 = xn1;
+        xn1 = xn;
+        yn2 = yn1;
+        yn1 = acc;
+      }
+      else
+      {
+        /* Filling or draining the wavefront: lanes outside the block keep
+           their state */
+        for (s = 0; s < VW; s++)
+        {
+          active[s] = ((s <= t) && (t - s < blockSize)) ? -1 : 0;
+        }
+        mask = VF_LOADMASK(active);
+        xn2 = VF_BLEND(xn2, xn1, mask);
+        xn1 = VF_BLEND(xn1, xn, mask);
+        yn2 = VF_BLEND(yn2, yn1, mask);
+        yn1 = VF_BLEND(yn1, acc, mask);
+      }
+
+      if (t + 1U >= count)
+      {
+        VF_STORE(out, acc);
+        pDst[t + 1U - count] = out[count - 1U];
+      }
+    }
+
+    VF_STORE(st[0], xn1);
+    VF_STORE(st[1], xn2);
+    VF_STORE(st[2], yn1);
+    VF_STORE(st[3], yn2);
+    for (s = 0; s < count; s++)
+    {
+      for (t = 0; t < 4U; t++)
+      {
+        pState[4U * (stage + s) + t] = st[t][s];
+      }
+    }
+
+    /* Further stages in place in the output buffer */
+    pIn = pDst;
+    stage += count;
+  }
+}
+
+void DSP_X86_FN(arm_dot_prod_f32)(float32_t *pSrcA, float32_t *pSrcB, uint32_t blockSize,
+                                  float32_t *result)
+{
+  VF        acc0 = VF_ZERO(), acc1 = VF_ZERO(), acc2 = VF_ZERO(), acc3 = VF_ZERO();
+  float32_t sum;
+  uint32_t  i = 0;
+
+  for (; i + 4U * VW <= blockSize; i += 4U * VW)
+  {
+    acc0 = VF_ADD(acc0, VF_MUL(VF_LOAD(pSrcA + i), VF_LOAD(pSrcB + i)));
+    acc1 = VF_ADD(acc1, VF_MUL(VF_LOAD(pSrcA + i + VW), VF_LOAD(pSrcB + i + VW)));
+    acc2 = VF_ADD(acc2, VF_MUL(VF_LOAD(pSrcA + i + 2U * VW), VF_LOAD(pSrcB + i + 2U * VW)));
+    acc3 = VF_ADD(acc3, VF_MUL(VF_LOAD(pSrcA + i + 3U * VW), VF_LOAD(pSrcB + i + 3U * VW)));
+  }
+  for (; i + VW <= blockSize; i += VW)
+  {
+    acc0 = VF_ADD(acc0, VF_MUL(VF_LOAD(pSrcA + i), VF_LOAD(pSrcB + i)));
+  }
+  sum = VF_HSUM(VF_ADD(VF_ADD(acc0, acc1), VF_ADD(acc2, acc3)));
+  for (; i < blockSize; i++)
+  {
+    sum += pSrcA[i] * pSrcB[i];
+  }
+  *result = sum;
+}
+
+void DSP_X86_FN(arm_dot_prod_q31)(q31_t *pSrcA, q31_t *pSrcB, uint32_t blockSize, q63_t *result)
+{
+  /* Arithmetic shift of 64-bit lanes by 14: ((x >>> 14) ^ m) - m */
+  VI       acc = VI_ZERO(), m = VI_SET1_64((int64_t)1 << 49), a, b, p;
+  q63_t    sum;
+  uint32_t i = 0;
+
+  for (; i + VW <= blockSize; i += VW)
+  {
+    a = VI_LOAD(pSrcA + i);
+    b = VI_LOAD(pSrcB + i);
+    p = VI_MUL32(a, b);
+    acc = VI_ADD64(acc, VI_SUB64(VI_XOR(VI_SRLI64(p, 14), m), m));
+    p = VI_MUL32(VI_SRLI64(a, 32), VI_SRLI64(b, 32));
+    acc = VI_ADD64(acc, VI_SUB64(VI_XOR(VI_SRLI64(p, 14), m), m));
+  }
+  sum = VI_HSUM64(acc);
+  for (; i < blockSize; i++)
+  {
+    sum += ((q63_t)pSrcA[i] * pSrcB[i]) >> 14U;
+  }
+  *result = sum;
+}
+
+void DSP_X86_FN(arm_dot_prod_q15)(q15_t *pSrcA, q15_t *pSrcB, uint32_t blockSize, q63_t *result)
+{
+  *result = DSP_X86_FN(DotQ15)(pSrcA, pSrcB, blockSize);
+}
+
+void DSP_X86_FN(arm_dot_prod_q7)(q7_t *pSrcA, q7_t *pSrcB, uint32_t blockSize, q31_t *result)
+{
+  VI       acc = VI_ZERO();
+  uint32_t sum, i = 0;
+
+  /* Pair sums of at most 2 * 128 * 128: no overflow */
+  for (; i + VW16 <= blockSize; i += VW16)
+  {
+    acc = VI_ADD32(acc, VI_MADD16(VI_LOAD8TO16(pSrcA + i), VI_LOAD8TO16(pSrcB + i)));
+  }
+  /* Wrapping, as the 32-bit sum of the Cortex-M0 */
+  sum = (uint32_t)VI_HSUM32(acc);
+  for (; i < blockSize; i++)
+  {
+    sum += (uint32_t)(q31_t)((q15_t)pSrcA[i] * pSrcB[i]);
+  }
+  *result = (q31_t)sum;
+}
+
+arm_status DSP_X86_FN(arm_mat_mult_f32)(const arm_matrix_instance_f32 *pSrcA,
+                                        const arm_matrix_instance_f32 *pSrcB,
+                                        arm_matrix_instance_f32 *pDst)
+{
+  const float32_t *pA = pSrcA->pData, *pB = pSrcB->pData;
+  float32_t *pOut = pDst->pData;
+  uint32_t  numRowsA = pSrcA->numRows, numColsA = pSrcA->numCols, numColsB = pSrcB->numCols;
+  uint32_t  row, col, k;
+  float32_t sum;
+
+#ifdef ARM_MATH_MATRIX_CHECK
+  if ((pSrcA->numCols != pSrcB->numRows) ||
+      (pSrcA->numRows != pDst->numRows) || (pSrcB->numCols != pDst->numCols))
+  {
+    return ARM_MATH_SIZE_MISMATCH;
+  }
+#endif
+
+  for (row = 0; row < numRowsA; row++)
+  {
+    const float32_t *pRow = pA + row * numColsA;
+
+    col = 0;
+    for (; col + 2U * VW <= numColsB; col += 2U * VW)
+    {
+      VF acc0 = VF_ZERO(), acc1 = VF_ZERO();
+
+      for (k = 0; k < numColsA; k++)
+      {
+        VF a = VF_SET1(pRow[k]);
+
+        acc0 = VF_ADD(acc0, VF_MUL(a, VF_LOAD(pB + k * numColsB + col)));
+        acc1 = VF_ADD(acc1, VF_MUL(a, VF_LOAD(pB + k * numColsB + col + VW)));
+      }
+      VF_STORE(pOut + row * numColsB + col, acc0);
+      VF_STORE(pOut + row * numColsB + col + VW, acc1);
+    }
+    for (; col + VW <= numColsB; col += VW)
+    {
+      VF acc0 = VF_ZERO();
+
+      for (k = 0; k < numColsA; k++)
+      {
+        acc0 = VF_ADD(acc0, VF_MUL(VF_SET1(pRow[k]), VF_LOAD(pB + k * numColsB + col)));
+      }
+      VF_STORE(pOut + row * numColsB + col, acc0);
+    }
+    for (; col < numColsB; col++)
+    {
+      sum = 0.0f;
+      for (k = 0; k < numColsA; k++)
+      {
+        sum += pRow[k] * pB[k * numColsB + col];
+      }
+      pOut[row * numColsB + col] = sum;
+    }
+  }
+  return ARM_MATH_SUCCESS;
+}
+
+#undef C81
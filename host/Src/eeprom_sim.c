@@ -0,0 +1,347 @@
+/**
+  ******************************************************************************
+  * @file    eeprom_sim.c
+  * @brief   M24LR64 I2C EEPROM model behind the BSP EEPROM_IO_* link layer.
+  *
+  *          Mirrors stm32f072b_discovery.c: transfers of more than one byte go
+  *          through the DMA and complete from an interrupt, single bytes are
+  *          sent in polling mode and charged to the CPU; the *DataDMA variants
+  *          always use the DMA. The device rolls over
+  *          within its 4-byte page and does not acknowledge for tW after each
+  *          write; a DMA transfer that is not acknowledged ends with
+  *          EEPROM_IO_ErrorCallback() instead of the completion callback.
+  *          EEPROM_IO_IsDeviceReady() waits 5 ms before its first trial, as
+  *          the board's does; EEPROM_IO_Probe() addresses the device at once.
+  *          The device side is also available to the I2C bus model.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_eeprom.h"
+#include "eeprom_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+  uint16_t  MemAddress;
+  uint8_t  *pBuffer;
+  uint32_t  Size;
+  uint32_t  Nack;
+} EEPROM_SimXferTypeDef;
+
+static uint8_t                Memory[EEPROM_SIM_SIZE];
+static uint32_t               Wear[EEPROM_SIM_SIZE / EEPROM_SIM_PAGESIZE];
+static EEPROM_SimStatsTypeDef Stats;
+static EEPROM_SimXferTypeDef  Xfer;
+static uint64_t               ReadyAt;
+static uint32_t               BusBusy;
+static uint32_t               FailArmed;
+static uint32_t               FailCountdown;
+static uint32_t               FailSeed;
+static uint32_t               PowerLost;
+static uint32_t               ReadFaultArmed;
+static uint32_t               ReadFaultCountdown;
+static uint32_t               ReadFaulted;
+
+void EEPROM_Sim_Reset(uint8_t fill)
+{
+  memset(Memory, fill, sizeof(Memory));
+  memset(Wear, 0, sizeof(Wear));
+  memset(&Stats, 0, sizeof(Stats));
+  EEPROM_Sim_PowerCycle();
+}
+
+void EEPROM_Sim_PowerFail(uint32_t programs, uint32_t seed)
+{
+  FailArmed = 1;
+  FailCountdown = programs;
+  FailSeed = seed;
+}
+
+uint32_t EEPROM_Sim_PowerLost(void)
+{
+  return PowerLost;
+}
+
+void EEPROM_Sim_ReadFault(uint32_t reads)
+{
+  ReadFaultArmed = 1;
+  ReadFaultCountdown = reads;
+  ReadFaulted = 0;
+}
+
+uint32_t EEPROM_Sim_ReadFaulted(void)
+{
+  return ReadFaulted;
+}
+
+void EEPROM_Sim_PowerCycle(void)
+{
+  ReadyAt = 0;
+  BusBusy = 0;
+  FailArmed = 0;
+  PowerLost = 0;
+  ReadFaultArmed = 0;
+  ReadFaulted = 0;
+}
+
+int EEPROM_Sim_Load(const char *path)
+{
+  FILE *f = fopen(path, "rb");
+  size_t n;
+
+  if (f == NULL)
+  {
+    return -1;
+  }
+  n = fread(Memory, 1, sizeof(Memory), f);
+  fclose(f);
+  return (n == sizeof(Memory)) ? 0 : -1;
+}
+
+int EEPROM_Sim_Save(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  size_t n;
+
+  if (f == NULL)
+  {
+    return -1;
+  }
+  n = fwrite(Memory, 1, sizeof(Memory), f);
+  return ((fclose(f) == 0) && (n == sizeof(Memory))) ? 0 : -1;
+}
+
+uint8_t *EEPROM_Sim_Memory(void)
+{
+  return Memory;
+}
+
+void EEPROM_Sim_GetStats(EEPROM_SimStatsTypeDef *pStats)
+{
+  *pStats = Stats;
+}
+
+uint32_t EEPROM_Sim_PageWear(uint16_t MemAddress)
+{
+  return Wear[(MemAddress % EEPROM_SIM_SIZE) / EEPROM_SIM_PAGESIZE];
+}
+
+uint32_t EEPROM_Sim_DevReady(void)
+{
+  return (SIM_Now() >= ReadyAt) ? 1U : 0U;
+}
+
+/* Latches a page write at the STOP condition and starts tW. */
+void EEPROM_Sim_DevWrite(uint16_t MemAddress, const uint8_t *pData, uint32_t Size)
+{
+  uint16_t page = (uint16_t)((MemAddress % EEPROM_SIM_SIZE) & ~(EEPROM_SIM_PAGESIZE - 1U));
+  uint16_t offset = (uint16_t)(MemAddress & (EEPROM_SIM_PAGESIZE - 1U));
+  uint32_t i, torn = 0;
+
+  if (PowerLost != 0)
+  {
+    return;
+  }
+  if ((FailArmed != 0) && (FailCountdown-- == 0))
+  {
+    torn = 1;
+    PowerLost = 1;
+  }
+  for (i = 0; i < Size; i++)
+  {
+    if (torn != 0)
+    {
+      FailSeed = FailSeed * 1103515245U + 12345U;
+      if (((FailSeed >> 16) & 1U) == 0)
+      {
+        continue;
+      }
+    }
+    Memory[page + ((offset + i) & (EEPROM_SIM_PAGESIZE - 1U))] = pData[i];
+  }
+  Stats.WriteCycles++;
+  Stats.BytesWritten += Size;
+  if (++Wear[page / EEPROM_SIM_PAGESIZE] > Stats.MaxWear)
+  {
+    Stats.MaxWear = Wear[page / EEPROM_SIM_PAGESIZE];
+  }
+  ReadyAt = SIM_Now() + EEPROM_SIM_TW_US;
+}
+
+void EEPROM_Sim_DevRead(uint16_t MemAddress, uint8_t *pData, uint32_t Size)
+{
+  uint32_t i;
+
+  for (i = 0; i < Size; i++)
+  {
+    pData[i] = Memory[(MemAddress + i) % EEPROM_SIM_SIZE];
+  }
+  Stats.BytesRead += Size;
+}
+
+static void EEPROM_Sim_TxDone(void *arg)
+{
+  (void)arg;
+  BusBusy = 0;
+  if (Xfer.Nack != 0)
+  {
+    EEPROM_IO_ErrorCallback();
+    return;
+  }
+  /* The DMA reads the source buffer while the bytes go out */
+  EEPROM_Sim_DevWrite(Xfer.MemAddress, Xfer.pBuffer, Xfer.Size);
+  EEPROM_IO_TxCpltCallback();
+}
+
+static void EEPROM_Sim_RxDone(void *arg)
+{
+  (void)arg;
+  BusBusy = 0;
+  if (Xfer.Nack != 0)
+  {
+    EEPROM_IO_ErrorCallback();
+    return;
+  }
+  EEPROM_Sim_DevRead(Xfer.MemAddress, Xfer.pBuffer, Xfer.Size);
+  EEPROM_IO_RxCpltCallback();
+}
+
+void EEPROM_IO_Init(void)
+{
+}
+
+static uint32_t EEPROM_Sim_Write(uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize, uint32_t Dma)
+{
+  /* START, device address, two address bytes, data, STOP */
+  uint64_t duration = (3U + BufferSize) * EEPROM_SIM_BYTE_US + 10U;
+
+  if (BusBusy != 0)
+  {
+    Stats.BusBusy++;
+    return HAL_ERROR;
+  }
+  if (Dma == 0)
+  {
+    if (EEPROM_Sim_DevReady() == 0)
+    {
+      Stats.Nacks++;
+      SIM_Busy(EEPROM_SIM_BYTE_US);
+      return HAL_ERROR;
+    }
+    SIM_Busy(duration);
+    EEPROM_Sim_DevWrite(MemAddress, (const uint8_t *)pBuffer, 1);
+    return HAL_OK;
+  }
+
+  Xfer.MemAddress = MemAddress;
+  Xfer.pBuffer = (uint8_t *)pBuffer;
+  Xfer.Size = BufferSize;
+  Xfer.Nack = (EEPROM_Sim_DevReady() == 0) ? 1U : 0U;
+  if (Xfer.Nack != 0)
+  {
+    Stats.Nacks++;
+    duration = EEPROM_SIM_BYTE_US + 10U;
+  }
+  BusBusy = 1;
+  SIM_Schedule(duration, EEPROM_Sim_TxDone, NULL);
+  return HAL_OK;
+}
+
+static uint32_t EEPROM_Sim_Read(uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize, uint32_t Dma)
+{
+  /* Dummy write of the address, repeated START, device address, data */
+  uint64_t duration = (4U + BufferSize) * EEPROM_SIM_BYTE_US + 20U;
+
+  if (ReadFaultArmed != 0)
+  {
+    if (ReadFaultCountdown == 0)
+    {
+      ReadFaultArmed = 0;
+      ReadFaulted = 1;
+      return HAL_BUSY;
+    }
+    ReadFaultCountdown--;
+  }
+  if (BusBusy != 0)
+  {
+    Stats.BusBusy++;
+    return HAL_ERROR;
+  }
+  if (Dma == 0)
+  {
+    if (EEPROM_Sim_DevReady() == 0)
+    {
+      Stats.Nacks++;
+      SIM_Busy(EEPROM_SIM_BYTE_US);
+      return HAL_ERROR;
+    }
+    SIM_Busy(duration);
+    EEPROM_Sim_DevRead(MemAddress, (uint8_t *)pBuffer, 1);
+    return HAL_OK;
+  }
+
+  Xfer.MemAddress = MemAddress;
+  Xfer.pBuffer = (uint8_t *)pBuffer;
+  Xfer.Size = BufferSize;
+  Xfer.Nack = (EEPROM_Sim_DevReady() == 0) ? 1U : 0U;
+  if (Xfer.Nack != 0)
+  {
+    Stats.Nacks++;
+    duration = EEPROM_SIM_BYTE_US + 10U;
+  }
+  BusBusy = 1;
+  SIM_Schedule(duration, EEPROM_Sim_RxDone, NULL);
+  return HAL_OK;
+}
+
+/* The link layer sends single bytes in polling mode, the rest by DMA */
+uint32_t EEPROM_IO_WriteData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+{
+  (void)DevAddress;
+  return EEPROM_Sim_Write(MemAddress, pBuffer, BufferSize, (BufferSize == 1) ? 0U : 1U);
+}
+
+uint32_t EEPROM_IO_ReadData(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+{
+  (void)DevAddress;
+  return EEPROM_Sim_Read(MemAddress, pBuffer, BufferSize, (BufferSize == 1) ? 0U : 1U);
+}
+
+uint32_t EEPROM_IO_WriteDataDMA(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+{
+  (void)DevAddress;
+  return EEPROM_Sim_Write(MemAddress, pBuffer, BufferSize, 1);
+}
+
+uint32_t EEPROM_IO_ReadDataDMA(uint16_t DevAddress, uint16_t MemAddress, uint32_t pBuffer, uint32_t BufferSize)
+{
+  (void)DevAddress;
+  return EEPROM_Sim_Read(MemAddress, pBuffer, BufferSize, 1);
+}
+
+/* HAL_I2C_IsDeviceReady() with one trial: one addressing attempt. */
+HAL_StatusTypeDef EEPROM_IO_Probe(uint16_t DevAddress)
+{
+  (void)DevAddress;
+  if (BusBusy != 0)
+  {
+    SIM_Busy(SIM_POLL_US);
+    return HAL_BUSY;
+  }
+  SIM_Busy(EEPROM_SIM_BYTE_US + 10U);
+  return (EEPROM_Sim_DevReady() != 0) ? HAL_OK : HAL_ERROR;
+}
+
+/* As the board link function: HAL_Delay(5), then one probe per trial. */
+HAL_StatusTypeDef EEPROM_IO_IsDeviceReady(uint16_t DevAddress, uint32_t Trials)
+{
+  HAL_StatusTypeDef status = HAL_ERROR;
+
+  HAL_Delay(5);
+  while ((Trials-- > 0) && (status != HAL_OK))
+  {
+    status = EEPROM_IO_Probe(DevAddress);
+  }
+  return status;
+}
@@ -0,0 +1,314 @@
+/**
+  ******************************************************************************
+  * @file    fft_tables_test.c
+  * @brief   Tables of tools/fft_tables.py against those of arm_common_tables.c
+  *          and arm_const_structs.c, on the cmsis_dsp host library.
+  *
+  *          Two generated sets link beside the stock tables: gen_, every
+  *          length and type, and small_, q15 and q31 on 16, 64, 256 and 1024
+  *          points, each with its radix-2/4 and real FFT init functions. For
+  *          every length:
+  *           - the twiddles of arm_cfft_q15/q31/f32() hold the same values,
+  *             the fixed-point bit-reversal tables the same pairs
+  *           - arm_cfft_q15/q31/f32(), forward then inverse, give the same
+  *             output bit for bit with either instance
+  *           - so do arm_cfft_radix2/radix4_q15/q31() set up by the stock
+  *             init functions and by those of each set, stepping through the
+  *             4096-point (gen_) or 1024-point (small_) tables; they also
+  *             agree on the lengths they reject
+  *           - so do arm_rfft_q15/q31() of twice the length, forward and
+  *             inverse, set up by arm_rfft_init_q15/q31() and by those of
+  *             gen_ (realCoefA/B of 8192 points, as the stock ones) and of
+  *             small_ (2048 points) where it has the length
+  *          gen_ also has sinTable_q15, which must hold the stock values.
+  *          Exits with status 1 on any difference.
+  ******************************************************************************
+  */
+#include "arm_const_structs.h"
+#include "arm_common_tables.h"
+#include "fft_tables_test_gen_fft_tables.h"
+#include "fft_tables_test_small_fft_tables.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FFT_LEN_MAX         4096U
+/* Largest length of the small_ set */
+#define SMALL_LEN_MAX       1024U
+#define RFFT_LEN_MAX        (2U * FFT_LEN_MAX)
+
+#define FFT_LENGTHS(X) X(16) X(32) X(64) X(128) X(256) X(512) X(1024) X(2048) X(4096)
+
+typedef struct
+{
+  uint32_t                     Length;
+  const arm_cfft_instance_q15 *pStockQ15, *pGenQ15;
+  const arm_cfft_instance_q31 *pStockQ31, *pGenQ31;
+  const arm_cfft_instance_f32 *pStockF32, *pGenF32;
+} Test_LengthTypeDef;
+
+#define TEST_LENGTH(n) { n, &arm_cfft_sR_q15_len##n, &gen_arm_cfft_sR_q15_len##n, \
+                            &arm_cfft_sR_q31_len##n, &gen_arm_cfft_sR_q31_len##n, \
+                            &arm_cfft_sR_f32_len##n, &gen_arm_cfft_sR_f32_len##n },
+
+static const Test_LengthTypeDef Lengths[] = { FFT_LENGTHS(TEST_LENGTH) };
+
+static uint32_t  Seed = 0x2545F491U;
+
+static q15_t     InQ15[2U * FFT_LEN_MAX], StockQ15[2U * FFT_LEN_MAX], GenQ15[2U * FFT_LEN_MAX];
+static q31_t     InQ31[2U * FFT_LEN_MAX], StockQ31[2U * FFT_LEN_MAX], GenQ31[2U * FFT_LEN_MAX];
+static float32_t InF32[2U * FFT_LEN_MAX], StockF32[2U * FFT_LEN_MAX], GenF32[2U * FFT_LEN_MAX];
+/* arm_rfft_q15/q31() transform their input in place: a copy for each. The
+   inverse reads the Nyquist pair after the N values */
+static q15_t     SrcQ15[2U][RFFT_LEN_MAX + 2U], RealStockQ15[2U * RFFT_LEN_MAX], RealGenQ15[2U * RFFT_LEN_MAX];
+static q31_t     SrcQ31[2U][RFFT_LEN_MAX + 2U], RealStockQ31[2U * RFFT_LEN_MAX], RealGenQ31[2U * RFFT_LEN_MAX];
+
+static uint32_t Test_Random(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return Seed;
+}
+
+/* Noise at -6 dBFS */
+static void Test_Inputs(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < 2U * FFT_LEN_MAX; i++)
+  {
+    InQ15[i] = (q15_t)((int32_t)Test_Random() >> 17);
+    InQ31[i] = (q31_t)((int32_t)Test_Random() >> 1);
+    InF32[i] = (float32_t)((int32_t)Test_Random() >> 8) / 16777216.0f;
+  }
+}
+
+/* 0 if the tables of the two instances agree: same twiddle values, same
+   bit-reversal length and, for the fixed-point ones, the same pairs */
+static int Test_TablesQ15(const arm_cfft_instance_q15 *pA, const arm_cfft_instance_q15 *pB)
+{
+  return (memcmp(pA->pTwiddle, pB->pTwiddle, 3U * pA->fftLen / 2U * sizeof(q15_t)) != 0) ||
+         (pA->bitRevLength != pB->bitRevLength) ||
+         (memcmp(pA->pBitRevTable, pB->pBitRevTable, pA->bitRevLength * sizeof(uint16_t)) != 0);
+}
+
+static int Test_TablesQ31(const arm_cfft_instance_q31 *pA, const arm_cfft_instance_q31 *pB)
+{
+  return (memcmp(pA->pTwiddle, pB->pTwiddle, 3U * pA->fftLen / 2U * sizeof(q31_t)) != 0) ||
+         (pA->bitRevLength != pB->bitRevLength) ||
+         (memcmp(pA->pBitRevTable, pB->pBitRevTable, pA->bitRevLength * sizeof(uint16_t)) != 0);
+}
+
+/* The f32 bit-reversal tables swap in another order: compared through the
+   outputs. The zeros of the twiddles on the axes may differ in sign */
+static int Test_TablesF32(const arm_cfft_instance_f32 *pA, const arm_cfft_instance_f32 *pB)
+{
+  uint32_t i;
+
+  for (i = 0; i < 2U * pA->fftLen; i++)
+  {
+    if (pA->pTwiddle[i] != pB->pTwiddle[i])
+    {
+      return 1;
+    }
+  }
+  return pA->bitRevLength != pB->bitRevLength;
+}
+
+/* Forward transform, then inverse of the result, through both instances */
+static int Test_CfftQ15(const Test_LengthTypeDef *pL)
+{
+  size_t size = 2U * pL->Length * sizeof(q15_t);
+  int    differs = 0;
+  uint8_t ifft;
+
+  memcpy(StockQ15, InQ15, size);
+  memcpy(GenQ15, InQ15, size);
+  for (ifft = 0; ifft < 2U; ifft++)
+  {
+    arm_cfft_q15(pL->pStockQ15, StockQ15, ifft, 1U);
+    arm_cfft_q15(pL->pGenQ15, GenQ15, ifft, 1U);
+    differs |= memcmp(StockQ15, GenQ15, size) != 0;
+  }
+  return differs;
+}
+
+static int Test_CfftQ31(const Test_LengthTypeDef *pL)
+{
+  size_t size = 2U * pL->Length * sizeof(q31_t);
+  int    differs = 0;
+  uint8_t ifft;
+
+  memcpy(StockQ31, InQ31, size);
+  memcpy(GenQ31, InQ31, size);
+  for (ifft = 0; ifft < 2U; ifft++)
+  {
+    arm_cfft_q31(pL->pStockQ31, StockQ31, ifft, 1U);
+    arm_cfft_q31(pL->pGenQ31, GenQ31, ifft, 1U);
+    differs |= memcmp(StockQ31, GenQ31, size) != 0;
+  }
+  return differs;
+}
+
+static int Test_CfftF32(const Test_LengthTypeDef *pL)
+{
+  size_t size = 2U * pL->Length * sizeof(float32_t);
+  int    differs = 0;
+  uint8_t ifft;
+
+  memcpy(StockF32, InF32, size);
+  memcpy(GenF32, InF32, size);
+  for (ifft = 0; ifft < 2U; ifft++)
+  {
+    arm_cfft_f32(pL->pStockF32, StockF32, ifft, 1U);
+    arm_cfft_f32(pL->pGenF32, GenF32, ifft, 1U);
+    differs |= memcmp(StockF32, GenF32, size) != 0;
+  }
+  return differs;
+}
+
+/* Legacy kernels: 0 if both init functions reject the length or both
+   transforms agree; *pRun set when the length is supported */
+#define TEST_RADIX(name, radix, type, in, out_stock, out_gen)                                                   \
+static int Test_##name(arm_status (*Init)(arm_cfft_radix##radix##_instance_##type *, uint16_t, uint8_t, uint8_t),\
+                       uint16_t Length, int *pRun)                                                              \
+{                                                                                                               \
+  arm_cfft_radix##radix##_instance_##type stock, gen;                                                           \
+  size_t  size = 2U * Length * sizeof(type##_t);                                                                \
+  int     differs = 0;                                                                                          \
+  uint8_t ifft;                                                                                                 \
+                                                                                                                \
+  memcpy(out_stock, in, size);                                                                                  \
+  memcpy(out_gen, in, size);                                                                                    \
+  for (ifft = 0; ifft < 2U; ifft++)                                                                             \
+  {                                                                                                             \
+    arm_status s = arm_cfft_radix##radix##_init_##type(&stock, Length, ifft, 1U);                               \
+    if (s != Init(&gen, Length, ifft, 1U))                                                                      \
+    {                                                                                                           \
+      return 1;                                                                                                 \
+    }                                                                                                           \
+    if (s != ARM_MATH_SUCCESS)                                                                                  \
+    {                                                                                                           \
+      return 0;                                                                                                 \
+    }                                                                                                           \
+    *pRun = 1;                                                                                                  \
+    arm_cfft_radix##radix##_##type(&stock, out_stock);                                                          \
+    arm_cfft_radix##radix##_##type(&gen, out_gen);                                                              \
+    differs |= memcmp(out_stock, out_gen, size) != 0;                                                           \
+  }                                                                                                             \
+  return differs;                                                                                               \
+}
+
+TEST_RADIX(Radix2Q15, 2, q15, InQ15, StockQ15, GenQ15)
+TEST_RADIX(Radix4Q15, 4, q15, InQ15, StockQ15, GenQ15)
+TEST_RADIX(Radix2Q31, 2, q31, InQ31, StockQ31, GenQ31)
+TEST_RADIX(Radix4Q31, 4, q31, InQ31, StockQ31, GenQ31)
+
+/* Real FFT of Length points, forward then inverse of the same input: 0 if
+   both init functions reject the length or both transforms agree; *pRun
+   set when the generated init function accepts it */
+#define TEST_RFFT(name, type, in, src, out_stock, out_gen)                                                      \
+static int Test_##name(arm_status (*Init)(arm_rfft_instance_##type *, uint32_t, uint32_t, uint32_t),            \
+                       uint32_t Length, int *pRun)                                                              \
+{                                                                                                               \
+  arm_rfft_instance_##type stock, gen;                                                                          \
+  size_t   size = 2U * Length * sizeof(type##_t);                                                               \
+  int      differs = 0;                                                                                         \
+  uint32_t ifft;                                                                                                \
+                                                                                                                \
+  for (ifft = 0; ifft < 2U; ifft++)                                                                             \
+  {                                                                                                             \
+    arm_status s = arm_rfft_init_##type(&stock, Length, ifft, 1U);                                              \
+    if (s != Init(&gen, Length, ifft, 1U))                                                                      \
+    {                                                                                                           \
+      return 1;                                                                                                 \
+    }                                                                                                           \
+    if (s != ARM_MATH_SUCCESS)                                                                                  \
+    {                                                                                                           \
+      return 0;                                                                                                 \
+    }                                                                                                           \
+    *pRun = 1;                                                                                                  \
+    memset(src, 0, sizeof(src));                                                                                \
+    memcpy(src[0], in, Length * sizeof(type##_t));                                                              \
+    memcpy(src[1], in, Length * sizeof(type##_t));                                                              \
+    memset(out_stock, 0, size);                                                                                 \
+    memset(out_gen, 0, size);                                                                                   \
+    arm_rfft_##type(&stock, src[0], out_stock);                                                                 \
+    arm_rfft_##type(&gen, src[1], out_gen);                                                                     \
+    differs |= (memcmp(src[0], src[1], Length * sizeof(type##_t)) != 0) ||                                      \
+               (memcmp(out_stock, out_gen, size) != 0);                                                         \
+  }                                                                                                             \
+  return differs;                                                                                               \
+}
+
+TEST_RFFT(RfftQ15, q15, InQ15, SrcQ15, RealStockQ15, RealGenQ15)
+TEST_RFFT(RfftQ31, q31, InQ31, SrcQ31, RealStockQ31, RealGenQ31)
+
+/* Both generated sets of init functions against the stock ones */
+#define TEST_RADIX_BOTH(name, radix, type, length, run)                                                         \
+  (Test_##name(gen_arm_cfft_radix##radix##_init_##type, length, run) |                                          \
+   (((length) <= SMALL_LEN_MAX) ? Test_##name(small_arm_cfft_radix##radix##_init_##type, length, run) : 0))
+
+/* small_ only has the real lengths of its complex ones: the stock function
+   accepts the others */
+#define TEST_RFFT_BOTH(name, type, length, run)                                                                 \
+  (Test_##name(gen_arm_rfft_init_##type, length, run) |                                                         \
+   (Test_Small(length / 2U) ? Test_##name(small_arm_rfft_init_##type, length, run) : 0))
+
+static int Test_Small(uint32_t Length)
+{
+  return (Length == 16U) || (Length == 64U) || (Length == 256U) || (Length == 1024U);
+}
+
+static const char *Test_Result(int Differs, int Run)
+{
+  return Differs ? "DIFFERS" : (Run ? "identical" : "-");
+}
+
+int main(void)
+{
+  const Test_LengthTypeDef *l;
+  int      tables, cfft[3], radix[4], run[4], rfft[2], rrun[2];
+  int      failed = 0;
+  size_t   i;
+  uint32_t k;
+
+  Test_Inputs();
+  printf("%6s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s\n", "length", "tables",
+         "cfft_q15", "cfft_q31", "cfft_f32", "radix2q15", "radix4q15", "radix2q31", "radix4q31",
+         "rfft_q15", "rfft_q31");
+
+  for (i = 0; i < sizeof(Lengths) / sizeof(Lengths[0]); i++)
+  {
+    l = &Lengths[i];
+    tables = Test_TablesQ15(l->pStockQ15, l->pGenQ15) ||
+             Test_TablesQ31(l->pStockQ31, l->pGenQ31) ||
+             Test_TablesF32(l->pStockF32, l->pGenF32);
+    cfft[0] = Test_CfftQ15(l);
+    cfft[1] = Test_CfftQ31(l);
+    cfft[2] = Test_CfftF32(l);
+    memset(run, 0, sizeof(run));
+    radix[0] = TEST_RADIX_BOTH(Radix2Q15, 2, q15, l->Length, &run[0]);
+    radix[1] = TEST_RADIX_BOTH(Radix4Q15, 4, q15, l->Length, &run[1]);
+    radix[2] = TEST_RADIX_BOTH(Radix2Q31, 2, q31, l->Length, &run[2]);
+    radix[3] = TEST_RADIX_BOTH(Radix4Q31, 4, q31, l->Length, &run[3]);
+    memset(rrun, 0, sizeof(rrun));
+    rfft[0] = TEST_RFFT_BOTH(RfftQ15, q15, 2U * l->Length, &rrun[0]);
+    rfft[1] = TEST_RFFT_BOTH(RfftQ31, q31, 2U * l->Length, &rrun[1]);
+
+    printf("%6u  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s  %-9s\n", (unsigned)l->Length,
+           Test_Result(tables, 1), Test_Result(cfft[0], 1), Test_Result(cfft[1], 1), Test_Result(cfft[2], 1),
+           Test_Result(radix[0], run[0]), Test_Result(radix[1], run[1]),
+           Test_Result(radix[2], run[2]), Test_Result(radix[3], run[3]),
+           Test_Result(rfft[0], rrun[0]), Test_Result(rfft[1], rrun[1]));
+    failed |= tables | cfft[0] | cfft[1] | cfft[2] | rfft[0] | rfft[1];
+    /* A real FFT never run is a length the generated init rejects */
+    failed |= !rrun[0] | !rrun[1];
+    for (k = 0; k < 4U; k++)
+    {
+      failed |= radix[k];
+    }
+  }
+  tables = memcmp(gen_sinTable_q15, sinTable_q15, sizeof(sinTable_q15)) != 0;
+  printf("sinTable_q15: %s\n", Test_Result(tables, 1));
+  failed |= tables;
+  return failed;
+}
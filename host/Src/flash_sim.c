@@ -0,0 +1,207 @@
+/**
+  ******************************************************************************
+  * @file    flash_sim.c
+  * @brief   STM32F072xB internal flash model behind HAL_FLASH_Program() and
+  *          HAL_FLASHEx_Erase().
+  *
+  *          The array is mapped at its real address so that the code under
+  *          test reads it with plain loads. It stays read-only outside the
+  *          HAL calls, so a stray store faults as a bus error would. As on
+  *          the chip, programming needs the flash unlocked, goes half-word
+  *          by half-word, and a half-word that is not erased can only be
+  *          programmed to 0x0000. The CPU is charged the programming and
+  *          erase times: it stalls fetching code from flash meanwhile.
+  ******************************************************************************
+  */
+#define _GNU_SOURCE
+#include "stm32f0xx_hal.h"
+#include "flash_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define FLASH_SIM_PAGES          (FLASH_SIM_SIZE / FLASH_PAGE_SIZE)
+
+static uint8_t               *Memory;
+static uint32_t               Wear[FLASH_SIM_PAGES];
+static FLASH_SimStatsTypeDef  Stats;
+static uint32_t               Locked = 1;
+static uint32_t               FailArmed;
+static uint32_t               FailCountdown;
+static uint32_t               FailSeed;
+static uint32_t               PowerLost;
+
+static void FLASH_Sim_Writable(int writable)
+{
+  mprotect(Memory, FLASH_SIM_SIZE, (writable != 0) ? (PROT_READ | PROT_WRITE) : PROT_READ);
+}
+
+void FLASH_Sim_Reset(void)
+{
+  if (Memory == NULL)
+  {
+    void *p = mmap((void *)FLASH_BASE, FLASH_SIM_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (p != (void *)FLASH_BASE)
+    {
+      fprintf(stderr, "flash_sim: cannot map the flash at 0x%08lX\n", (unsigned long)FLASH_BASE);
+      exit(2);
+    }
+    Memory = p;
+  }
+  FLASH_Sim_Writable(1);
+  memset(Memory, 0xFF, FLASH_SIM_SIZE);
+  FLASH_Sim_Writable(0);
+  memset(Wear, 0, sizeof(Wear));
+  memset(&Stats, 0, sizeof(Stats));
+  FLASH_Sim_PowerCycle();
+}
+
+void FLASH_Sim_GetStats(FLASH_SimStatsTypeDef *pStats)
+{
+  *pStats = Stats;
+}
+
+void FLASH_Sim_PowerFail(uint32_t ops, uint32_t seed)
+{
+  FailArmed = 1;
+  FailCountdown = ops;
+  FailSeed = seed;
+}
+
+uint32_t FLASH_Sim_PowerLost(void)
+{
+  return PowerLost;
+}
+
+void FLASH_Sim_PowerCycle(void)
+{
+  Locked = 1;
+  FailArmed = 0;
+  PowerLost = 0;
+}
+
+static uint32_t FLASH_Sim_Rand(void)
+{
+  FailSeed = FailSeed * 1103515245U + 12345U;
+  return FailSeed >> 16;
+}
+
+/* Counts down to the power cut: 1 if this operation is the torn one. */
+static uint32_t FLASH_Sim_Cut(void)
+{
+  if ((FailArmed != 0) && (FailCountdown-- == 0))
+  {
+    FailArmed = 0;
+    PowerLost = 1;
+    return 1;
+  }
+  return 0;
+}
+
+static HAL_StatusTypeDef FLASH_Sim_ProgramHalfWord(uint32_t Address, uint16_t Value)
+{
+  uint16_t *cell = (uint16_t *)(Memory + (Address - FLASH_BASE));
+  uint16_t  target = Value;
+
+  if (PowerLost != 0)
+  {
+    return HAL_OK;
+  }
+  SIM_Busy(FLASH_SIM_PROGRAM_US);
+  if ((*cell != 0xFFFFU) && (Value != 0x0000U))
+  {
+    /* PGERR */
+    Stats.Errors++;
+    return HAL_ERROR;
+  }
+  if (FLASH_Sim_Cut() != 0)
+  {
+    /* Only some of the bits to clear get there */
+    target = (uint16_t)(Value | (FLASH_Sim_Rand() & ~Value & *cell));
+  }
+  FLASH_Sim_Writable(1);
+  *cell &= target;
+  FLASH_Sim_Writable(0);
+  Stats.HalfWords++;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+  Locked = 0;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+  Locked = 1;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+  uint32_t count = (TypeProgram == FLASH_TYPEPROGRAM_DOUBLEWORD) ? 4U :
+                   (TypeProgram == FLASH_TYPEPROGRAM_WORD) ? 2U : 1U;
+  uint32_t i;
+
+  if ((Locked != 0) || ((Address & 1U) != 0) || (Address < FLASH_BASE) ||
+      ((Address + 2U * count) > (FLASH_BASE + FLASH_SIM_SIZE)))
+  {
+    Stats.Errors++;
+    return HAL_ERROR;
+  }
+  for (i = 0; i < count; i++)
+  {
+    if (FLASH_Sim_ProgramHalfWord(Address + 2U * i, (uint16_t)(Data >> (16U * i))) != HAL_OK)
+    {
+      return HAL_ERROR;
+    }
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+  uint32_t page, first, i;
+
+  *PageError = 0xFFFFFFFFU;
+  first = (pEraseInit->PageAddress - FLASH_BASE) / FLASH_PAGE_SIZE;
+  if ((Locked != 0) || (pEraseInit->TypeErase != FLASH_TYPEERASE_PAGES) ||
+      (pEraseInit->PageAddress < FLASH_BASE) || ((first + pEraseInit->NbPages) > FLASH_SIM_PAGES))
+  {
+    Stats.Errors++;
+    return HAL_ERROR;
+  }
+  for (page = first; page < first + pEraseInit->NbPages; page++)
+  {
+    uint32_t *words = (uint32_t *)(Memory + page * FLASH_PAGE_SIZE);
+    uint32_t torn;
+
+    if (PowerLost != 0)
+    {
+      break;
+    }
+    SIM_Busy(FLASH_SIM_ERASE_US);
+    torn = FLASH_Sim_Cut();
+    FLASH_Sim_Writable(1);
+    for (i = 0; i < FLASH_PAGE_SIZE / 4U; i++)
+    {
+      /* A cut erase leaves a random subset of the words erased */
+      if ((torn == 0) || ((FLASH_Sim_Rand() & 1U) != 0))
+      {
+        words[i] = 0xFFFFFFFFU;
+      }
+    }
+    FLASH_Sim_Writable(0);
+    Stats.Erases++;
+    if (++Wear[page] > Stats.MaxWear)
+    {
+      Stats.MaxWear = Wear[page];
+    }
+  }
+  return HAL_OK;
+}
@@ -0,0 +1,397 @@
+/**
+  ******************************************************************************
+  * @file    gyro_sim.c
+  * @brief   L3GD20 gyroscope model on SPI2 behind the GYRO_IO_* link layer.
+  *
+  *          Mirrors the gyroscope link section of stm32f072b_discovery.c:
+  *          blocking reads send the address byte, then take the data in one
+  *          HAL_SPI_Receive() (or one HAL call per byte, as the former link
+  *          layer did, after GYRO_Sim_Reset(1)); writes go one byte per HAL
+  *          call; GYRO_IO_ReadDMA() ends with GYRO_IO_RxCpltCallback() from
+  *          the DMA interrupt. The bus runs at 6 MHz.
+  *          The device produces samples at the output data rate of CTRL_REG1
+  *          while powered. Its FIFO holds 32 samples (stream mode drops the
+  *          oldest, FIFO mode the newest) and, when enabled, the multiple
+  *          byte reads wrap from OUT_Z_H back to OUT_X_L. The INT2 signals of
+  *          CTRL_REG3 drive the EXTI line: HAL_GPIO_EXTI_Callback() runs as
+  *          the interrupt at each rising edge, or at a software trigger from
+  *          GYRO_IO_INT2Check(). Active low INT2 is not modelled.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_gyroscope.h"
+#include "gyro_sim.h"
+#include "sim.h"
+#include <string.h>
+
+#define GYRO_SIM_CTRL1       0x20U
+#define GYRO_SIM_CTRL3       0x22U
+#define GYRO_SIM_CTRL4       0x23U
+#define GYRO_SIM_CTRL5       0x24U
+#define GYRO_SIM_STATUS      0x27U
+#define GYRO_SIM_OUT_X_L     0x28U
+#define GYRO_SIM_OUT_Z_H     0x2DU
+#define GYRO_SIM_FIFO_CTRL   0x2EU
+#define GYRO_SIM_FIFO_SRC    0x2FU
+
+static const uint32_t       Odr[4] = { 95U, 190U, 380U, 760U };
+static uint8_t              Regs[0x40];
+static GYRO_SimStatsTypeDef Stats;
+static uintptr_t            Generation;
+static uint32_t             ByteMode;
+static uint32_t             Running;
+static uint64_t             NextTime;
+static uint32_t             Remainder;
+static uint32_t             Produced;
+static uint32_t             Latest;
+static uint32_t             DataReady;
+static uint32_t             Fifo[32];
+static uint32_t             FifoHead;
+static uint32_t             FifoLevel;
+static uint32_t             Line;
+static uint32_t             ExtiEnabled;
+static uint32_t             ExtiPending;
+static uint32_t             DmaBusy;
+
+static void GYRO_Sim_Boot(void)
+{
+  memset(Regs, 0, sizeof(Regs));
+  Regs[GYRO_SIM_CTRL1] = 0x07;
+  FifoLevel = 0;
+}
+
+void GYRO_Sim_Reset(uint32_t ByteReads)
+{
+  GYRO_Sim_Boot();
+  memset(&Stats, 0, sizeof(Stats));
+  Generation++;
+  ByteMode = ByteReads;
+  Running = 0;
+  Produced = 0;
+  Latest = 0;
+  DataReady = 0;
+  FifoHead = 0;
+  Line = 0;
+  ExtiEnabled = 0;
+  ExtiPending = 0;
+  DmaBusy = 0;
+}
+
+void GYRO_Sim_GetStats(GYRO_SimStatsTypeDef *pStats)
+{
+  *pStats = Stats;
+}
+
+void GYRO_Sim_Sample(uint32_t n, int16_t *pXYZ)
+{
+  pXYZ[0] = (int16_t)n;
+  pXYZ[1] = (int16_t)~n;
+  pXYZ[2] = (int16_t)(n * 3U);
+}
+
+void GYRO_Sim_Hold(uint32_t n)
+{
+  Latest = n;
+  DataReady = 1;
+}
+
+static uint32_t GYRO_Sim_FifoOn(void)
+{
+  return (((Regs[GYRO_SIM_CTRL5] & 0x40U) != 0) && ((Regs[GYRO_SIM_FIFO_CTRL] & 0xE0U) != 0)) ? 1U : 0U;
+}
+
+static uint8_t GYRO_Sim_FifoSrc(void)
+{
+  uint8_t src = (uint8_t)(FifoLevel & 0x1FU);
+
+  if ((FifoLevel >= (Regs[GYRO_SIM_FIFO_CTRL] & 0x1FU)) && (FifoLevel != 0))
+  {
+    src |= 0x80U;
+  }
+  if (FifoLevel == 32U)
+  {
+    src |= 0x40U;
+  }
+  if (FifoLevel == 0)
+  {
+    src |= 0x20U;
+  }
+  return src;
+}
+
+static void GYRO_Sim_Exti(void *arg)
+{
+  if ((uintptr_t)arg != Generation)
+  {
+    return;
+  }
+  ExtiPending = 0;
+  if (ExtiEnabled == 0)
+  {
+    return;
+  }
+  Stats.Interrupts++;
+  SIM_Busy(GYRO_SIM_EXTI_US);
+  HAL_GPIO_EXTI_Callback(GYRO_INT2_PIN);
+}
+
+/* Sets the EXTI pending bit: the interrupt runs once the current one ends */
+static void GYRO_Sim_Trigger(void)
+{
+  if ((ExtiEnabled != 0) && (ExtiPending == 0))
+  {
+    ExtiPending = 1;
+    SIM_Schedule(0, GYRO_Sim_Exti, (void *)Generation);
+  }
+}
+
+static void GYRO_Sim_UpdateLine(void)
+{
+  uint8_t  ctrl3 = Regs[GYRO_SIM_CTRL3];
+  uint8_t  src = GYRO_Sim_FifoSrc();
+  uint32_t line = 0;
+
+  if (((ctrl3 & 0x08U) != 0) && (DataReady != 0))
+  {
+    line = 1;
+  }
+  if ((GYRO_Sim_FifoOn() != 0) && ((ctrl3 & (src >> 5) & 0x07U) != 0))
+  {
+    /* I2_WTM, I2_ORun and I2_Empty line up with WTM, OVRN and EMPTY */
+    line = 1;
+  }
+  if ((line != 0) && (Line == 0))
+  {
+    GYRO_Sim_Trigger();
+  }
+  Line = line;
+}
+
+static void GYRO_Sim_Tick(void *arg)
+{
+  uint32_t odr;
+
+  if ((uintptr_t)arg != Generation)
+  {
+    return;
+  }
+  if ((Regs[GYRO_SIM_CTRL1] & 0x08U) == 0)
+  {
+    Running = 0;
+    return;
+  }
+
+  if (GYRO_Sim_FifoOn() != 0)
+  {
+    if (FifoLevel < 32U)
+    {
+      Fifo[(FifoHead + FifoLevel++) % 32U] = Produced;
+    }
+    else if ((Regs[GYRO_SIM_FIFO_CTRL] & 0xE0U) == 0x20U)
+    {
+      /* FIFO mode: full, the new sample is dropped */
+      Stats.Overwritten++;
+    }
+    else
+    {
+      Stats.Overwritten++;
+      Fifo[FifoHead] = Produced;
+      FifoHead = (FifoHead + 1U) % 32U;
+    }
+  }
+  else if (DataReady != 0)
+  {
+    Stats.Overwritten++;
+  }
+  Latest = Produced++;
+  DataReady = 1;
+  Stats.Samples++;
+
+  /* Next sample, the fraction of a us carried over */
+  odr = Odr[Regs[GYRO_SIM_CTRL1] >> 6];
+  NextTime += (1000000U + Remainder) / odr;
+  Remainder = (1000000U + Remainder) % odr;
+  SIM_Schedule((NextTime > SIM_Now()) ? (NextTime - SIM_Now()) : 0U, GYRO_Sim_Tick, arg);
+  GYRO_Sim_UpdateLine();
+}
+
+static uint8_t GYRO_Sim_ReadReg(uint8_t Addr)
+{
+  int16_t  xyz[3];
+  uint32_t n, hi;
+
+  if ((Addr >= GYRO_SIM_OUT_X_L) && (Addr <= GYRO_SIM_OUT_Z_H))
+  {
+    n = ((GYRO_Sim_FifoOn() != 0) && (FifoLevel != 0)) ? Fifo[FifoHead] : Latest;
+    GYRO_Sim_Sample(n, xyz);
+    hi = (Addr & 1U) ^ (((Regs[GYRO_SIM_CTRL4] & 0x40U) != 0) ? 1U : 0U);
+    if (Addr == GYRO_SIM_OUT_Z_H)
+    {
+      /* The last output byte releases the sample */
+      if ((GYRO_Sim_FifoOn() != 0) && (FifoLevel != 0))
+      {
+        FifoHead = (FifoHead + 1U) % 32U;
+        FifoLevel--;
+      }
+      DataReady = 0;
+    }
+    return (uint8_t)((uint16_t)xyz[(Addr - GYRO_SIM_OUT_X_L) / 2U] >> (hi * 8U));
+  }
+  switch (Addr)
+  {
+  case 0x0F:
+    return 0xD4;
+  case 0x26:
+    return 25;
+  case GYRO_SIM_STATUS:
+    return (DataReady != 0) ? 0x0FU : 0x00U;
+  case GYRO_SIM_FIFO_SRC:
+    return GYRO_Sim_FifoSrc();
+  default:
+    return Regs[Addr & 0x3FU];
+  }
+}
+
+static void GYRO_Sim_WriteReg(uint8_t Addr, uint8_t Value)
+{
+  switch (Addr)
+  {
+  case GYRO_SIM_CTRL1:
+    Regs[Addr] = Value;
+    if (((Value & 0x08U) != 0) && (Running == 0))
+    {
+      Running = 1;
+      NextTime = SIM_Now() + 1000000U / Odr[Value >> 6];
+      Remainder = 1000000U % Odr[Value >> 6];
+      SIM_Schedule(1000000U / Odr[Value >> 6], GYRO_Sim_Tick, (void *)Generation);
+    }
+    break;
+  case GYRO_SIM_CTRL5:
+    if ((Value & 0x80U) != 0)
+    {
+      GYRO_Sim_Boot();
+    }
+    else
+    {
+      Regs[Addr] = Value;
+    }
+    break;
+  case GYRO_SIM_FIFO_CTRL:
+    Regs[Addr] = Value;
+    if ((Value & 0xE0U) == 0)
+    {
+      /* Bypass mode empties the FIFO */
+      FifoLevel = 0;
+    }
+    break;
+  default:
+    if (((Addr > GYRO_SIM_CTRL1) && (Addr <= 0x25U)) || ((Addr >= 0x30U) && (Addr <= 0x38U)))
+    {
+      Regs[Addr] = Value;
+    }
+    break;
+  }
+}
+
+/* Register access with the address increment of multiple byte transfers */
+static void GYRO_Sim_Access(uint8_t *pBuffer, uint8_t Addr, uint16_t Size, uint32_t Write)
+{
+  uint16_t i;
+
+  if (DmaBusy != 0)
+  {
+    Stats.Collisions++;
+  }
+  Stats.Transfers++;
+  Stats.Bytes += Size;
+  Stats.BusTime += GYRO_SIM_BUS_US(1U + Size);
+  for (i = 0; i < Size; i++)
+  {
+    if (Write != 0)
+    {
+      GYRO_Sim_WriteReg(Addr, pBuffer[i]);
+    }
+    else
+    {
+      pBuffer[i] = GYRO_Sim_ReadReg(Addr);
+    }
+    if ((Addr == GYRO_SIM_OUT_Z_H) && (GYRO_Sim_FifoOn() != 0))
+    {
+      Addr = GYRO_SIM_OUT_X_L;
+    }
+    else
+    {
+      Addr = (uint8_t)((Addr + 1U) & 0x3FU);
+    }
+  }
+  GYRO_Sim_UpdateLine();
+}
+
+void GYRO_IO_Init(void)
+{
+}
+
+void GYRO_IO_Write(uint8_t* pBuffer, uint8_t WriteAddr, uint16_t NumByteToWrite)
+{
+  /* One SPIx_WriteRead() per byte */
+  SIM_Busy((1U + NumByteToWrite) * (GYRO_SIM_HAL_US + GYRO_SIM_POLL_BYTE_US));
+  GYRO_Sim_Access(pBuffer, WriteAddr, NumByteToWrite, 1);
+}
+
+void GYRO_IO_Read(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead)
+{
+  if ((ByteMode != 0) || (NumByteToRead == 1U))
+  {
+    SIM_Busy((1U + NumByteToRead) * (GYRO_SIM_HAL_US + GYRO_SIM_POLL_BYTE_US));
+  }
+  else
+  {
+    /* Address byte, then one HAL_SPI_Receive() */
+    SIM_Busy(2U * GYRO_SIM_HAL_US + (1U + NumByteToRead) * GYRO_SIM_POLL_BYTE_US);
+  }
+  GYRO_Sim_Access(pBuffer, ReadAddr, NumByteToRead, 0);
+}
+
+static void GYRO_Sim_DmaDone(void *arg)
+{
+  if ((uintptr_t)arg != Generation)
+  {
+    return;
+  }
+  DmaBusy = 0;
+  SIM_Busy(GYRO_SIM_DMA_ISR_US);
+  GYRO_IO_RxCpltCallback();
+}
+
+uint32_t GYRO_IO_ReadDMA(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead)
+{
+  if (DmaBusy != 0)
+  {
+    Stats.Collisions++;
+    return 1;
+  }
+  SIM_Busy(GYRO_SIM_HAL_US + GYRO_SIM_POLL_BYTE_US + GYRO_SIM_DMA_START_US);
+  /* The FIFO is drained as the bytes go; the buffer is not looked at
+     before the completion callback */
+  GYRO_Sim_Access(pBuffer, ReadAddr, NumByteToRead, 0);
+  Stats.DmaBursts++;
+  DmaBusy = 1;
+  SIM_Schedule(GYRO_SIM_BUS_US(NumByteToRead), GYRO_Sim_DmaDone, (void *)Generation);
+  return 0;
+}
+
+void GYRO_IO_INT2Config(uint32_t Enable)
+{
+  ExtiEnabled = Enable;
+  if (Enable != 0)
+  {
+    GYRO_IO_INT2Check();
+  }
+}
+
+void GYRO_IO_INT2Check(void)
+{
+  if (Line != 0)
+  {
+    GYRO_Sim_Trigger();
+  }
+}
@@ -0,0 +1,432 @@
+/**
+  ******************************************************************************
+  * @file    i2c_sim.c
+  * @brief   I2C2 bus model behind the I2C_IO_* link layer of the transaction
+  *          scheduler.
+  *
+  *          Mirrors the link section of stm32f072b_discovery.c: memory
+  *          transfers go through the DMA and end with
+  *          BSP_I2C_XferCpltCallback() or BSP_I2C_XferErrorCallback() from
+  *          an interrupt; probes address the device once. The bus runs at
+  *          100 kHz. Two devices answer: the M24LR64 EEPROM (eeprom_sim.c,
+  *          which NACKs during tW) and an STLM75, whose register pointer
+  *          does not step. Bus errors and transfers that never complete can
+  *          be injected, and a bus held low under a probe, which then gives
+  *          up with HAL_TIMEOUT after its loop bound; I2C_IO_Recover() drops
+  *          the transfer in progress and frees the bus.
+  *          The TSENSOR_IO_* link functions are mirrored too.
+  *          Given a temperature profile, the STLM75 converts periodically
+  *          and drives its OS output from the limits, the fault queue and
+  *          the mode of its configuration register; in interrupt mode any
+  *          register read releases it. Each activation runs
+  *          HAL_GPIO_EXTI_Callback(TSENSOR_OS_PIN) as the interrupt while
+  *          TSENSOR_IO_AlertConfig() has the line enabled. Shutdown and the
+  *          OS polarity bit are not modelled.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_i2c.h"
+#include "stm32f072b_discovery_tsensor.h"
+#include "i2c_sim.h"
+#include "eeprom_sim.h"
+#include "sim.h"
+#include <string.h>
+
+typedef struct
+{
+  uint16_t  DevAddress;
+  uint16_t  MemAddress;
+  uint8_t  *pBuffer;
+  uint16_t  Size;
+  uint8_t   Write;
+  uint8_t   Result;          /* 0 done, 1 NACK, 2 bus error */
+} I2C_SimXferTypeDef;
+
+static I2C_SimXferTypeDef   Xfer;
+static I2C_SimStatsTypeDef  Stats;
+static uint32_t             InFlight;
+static uintptr_t            Generation;
+static uint32_t             ErrorRate;
+static uint32_t             HangRate;
+static uint32_t             ProbeHang;
+static uint32_t             FaultSeed;
+static uint8_t              TsPointer;
+static uint16_t             TsRegs[4];
+static int32_t            (*TsProfile)(uint64_t Time);
+static uint32_t             TsOs;
+static uint32_t             TsArmedLow;      /* Interrupt mode: next edge is the low limit */
+static uint32_t             TsFaults;
+static uint32_t             TsExti;
+static uintptr_t            TsGeneration;    /* Not bumped by bus resets */
+
+void I2C_Sim_Reset(void)
+{
+  memset(&Stats, 0, sizeof(Stats));
+  InFlight = 0;
+  Generation++;
+  ErrorRate = 0;
+  HangRate = 0;
+  ProbeHang = 0;
+  TsPointer = 0;
+  TsRegs[0] = 0;                 /* TEMP */
+  TsRegs[1] = 0;                 /* CONF, one byte in the MSB */
+  TsRegs[2] = (uint16_t)(75 << 8);  /* THYS */
+  TsRegs[3] = (uint16_t)(80 << 8);  /* TOS */
+  TsProfile = NULL;
+  TsGeneration++;
+  TsOs = 0;
+  TsArmedLow = 0;
+  TsFaults = 0;
+  TsExti = 0;
+  I2C_Sim_SetTemp(2 * 25);
+}
+
+void I2C_Sim_GetStats(I2C_SimStatsTypeDef *pStats)
+{
+  *pStats = Stats;
+}
+
+void I2C_Sim_SetTemp(int16_t Halves)
+{
+  TsRegs[0] = (uint16_t)((uint16_t)Halves << 7);
+}
+
+uint16_t I2C_Sim_TsensorRegister(uint8_t Reg)
+{
+  return TsRegs[Reg & 3U];
+}
+
+uint32_t I2C_Sim_TsensorOS(void)
+{
+  return TsOs;
+}
+
+static void I2C_Sim_Exti(void *arg)
+{
+  if (((uintptr_t)arg != TsGeneration) || (TsExti == 0))
+  {
+    return;
+  }
+  Stats.Interrupts++;
+  SIM_Busy(I2C_SIM_EXTI_US);
+  HAL_GPIO_EXTI_Callback(TSENSOR_OS_PIN);
+}
+
+static void I2C_Sim_SetOS(uint32_t Active)
+{
+  if ((Active != 0) && (TsOs == 0))
+  {
+    Stats.OsEvents++;
+    if (TsExti != 0)
+    {
+      /* Falling edge: the EXTI pending bit is set */
+      SIM_Schedule(0, I2C_Sim_Exti, (void *)TsGeneration);
+    }
+  }
+  TsOs = Active;
+}
+
+static void I2C_Sim_Convert(void *arg)
+{
+  static const uint32_t queue[4] = { 1U, 2U, 4U, 6U };
+  uint8_t  conf = (uint8_t)(TsRegs[1] >> 8);
+  int32_t  t;
+  int16_t  temp, tos = (int16_t)TsRegs[3], thys = (int16_t)TsRegs[2];
+  uint32_t beyond;
+
+  if (((uintptr_t)arg != TsGeneration) || (TsProfile == NULL))
+  {
+    return;
+  }
+  /* 0.5 degree steps, rounded down, within the range of the register */
+  t = TsProfile(SIM_Now());
+  t = (t > 32767) ? 32767 : ((t < -32768) ? -32768 : t);
+  temp = (int16_t)(t & ~0x7F);
+  TsRegs[0] = (uint16_t)temp;
+  Stats.Conversions++;
+
+  if ((conf & STLM75_INTERRUPT_MODE) != 0)
+  {
+    beyond = (TsArmedLow != 0) ? (temp < thys) : (temp > tos);
+  }
+  else
+  {
+    beyond = (TsOs != 0) ? (temp < thys) : (temp > tos);
+  }
+  TsFaults = (beyond != 0) ? (TsFaults + 1U) : 0U;
+  if (TsFaults >= queue[(conf >> 3) & 3U])
+  {
+    TsFaults = 0;
+    if ((conf & STLM75_INTERRUPT_MODE) != 0)
+    {
+      TsArmedLow ^= 1U;
+      I2C_Sim_SetOS(1);
+    }
+    else
+    {
+      I2C_Sim_SetOS(TsOs ^ 1U);
+    }
+  }
+  SIM_Schedule(I2C_SIM_CONV_US, I2C_Sim_Convert, arg);
+}
+
+void I2C_Sim_TempProfile(int32_t (*Profile)(uint64_t Time))
+{
+  uint32_t start = (TsProfile == NULL) ? 1U : 0U;
+
+  TsProfile = Profile;
+  if ((Profile != NULL) && (start != 0))
+  {
+    SIM_Schedule(I2C_SIM_CONV_US, I2C_Sim_Convert, (void *)TsGeneration);
+  }
+}
+
+void I2C_Sim_Faults(uint32_t Error, uint32_t Hang, uint32_t Seed)
+{
+  ErrorRate = Error;
+  HangRate = Hang;
+  FaultSeed = Seed;
+}
+
+void I2C_Sim_HangProbe(void)
+{
+  ProbeHang = 1;
+}
+
+static uint32_t I2C_Sim_Rand(void)
+{
+  FaultSeed = FaultSeed * 1103515245U + 12345U;
+  return FaultSeed >> 16;
+}
+
+/* Whether the device acknowledges its address now */
+static uint32_t I2C_Sim_Ack(uint16_t DevAddress)
+{
+  if (DevAddress == I2C_SIM_EEPROM_ADDRESS)
+  {
+    return EEPROM_Sim_DevReady();
+  }
+  return (DevAddress == I2C_SIM_TSENSOR_ADDRESS) ? 1U : 0U;
+}
+
+static void I2C_Sim_TsensorAccess(void)
+{
+  uint16_t i;
+  uint16_t *reg;
+
+  TsPointer = (uint8_t)(Xfer.MemAddress & 3U);
+  reg = &TsRegs[TsPointer];
+  for (i = 0; i < Xfer.Size; i++)
+  {
+    /* MSB then LSB, the pointer stays on the register */
+    uint32_t shift = ((TsPointer == 1U) || ((i & 1U) == 0)) ? 8U : 0U;
+
+    if (Xfer.Write != 0)
+    {
+      if (TsPointer != 0)
+      {
+        *reg = (uint16_t)((*reg & ~(0xFFU << shift)) | ((uint16_t)Xfer.pBuffer[i] << shift));
+      }
+    }
+    else
+    {
+      Xfer.pBuffer[i] = (uint8_t)(*reg >> shift);
+    }
+  }
+  if ((Xfer.Write == 0) && (((TsRegs[1] >> 8) & STLM75_INTERRUPT_MODE) != 0))
+  {
+    /* Any read releases the OS output */
+    I2C_Sim_SetOS(0);
+  }
+}
+
+static void I2C_Sim_Done(void *arg)
+{
+  if (((uintptr_t)arg != Generation) || (InFlight == 0))
+  {
+    /* Dropped by a bus reset */
+    return;
+  }
+  InFlight = 0;
+  SIM_Busy(I2C_SIM_ISR_US);
+  if (Xfer.Result != 0)
+  {
+    BSP_I2C_XferErrorCallback((Xfer.Result == 1U) ? 1U : 0U);
+    return;
+  }
+  if (Xfer.DevAddress == I2C_SIM_EEPROM_ADDRESS)
+  {
+    if (Xfer.Write != 0)
+    {
+      EEPROM_Sim_DevWrite(Xfer.MemAddress, Xfer.pBuffer, Xfer.Size);
+    }
+    else
+    {
+      EEPROM_Sim_DevRead(Xfer.MemAddress, Xfer.pBuffer, Xfer.Size);
+    }
+  }
+  else
+  {
+    I2C_Sim_TsensorAccess();
+  }
+  BSP_I2C_XferCpltCallback();
+}
+
+static HAL_StatusTypeDef I2C_Sim_Start(uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize,
+                                       uint8_t *pBuffer, uint16_t Size, uint8_t Write)
+{
+  /* Address, memory address, (repeated START and address,) data */
+  uint32_t bytes = 1U + ((MemAddSize == I2C_MEMADD_SIZE_16BIT) ? 2U : 1U) + ((Write != 0) ? 0U : 1U) + Size;
+  uint64_t duration = bytes * EEPROM_SIM_BYTE_US + ((Write != 0) ? 10U : 20U);
+  uint32_t fault;
+
+  if (InFlight != 0)
+  {
+    return HAL_BUSY;
+  }
+  SIM_Busy(I2C_SIM_ISR_US);
+  Xfer.DevAddress = DevAddress;
+  Xfer.MemAddress = MemAddress;
+  Xfer.pBuffer = pBuffer;
+  Xfer.Size = Size;
+  Xfer.Write = Write;
+  Xfer.Result = 0;
+  Stats.Transfers++;
+
+  fault = ((ErrorRate + HangRate) != 0) ? (I2C_Sim_Rand() % 1000U) : 1000U;
+  if (I2C_Sim_Ack(DevAddress) == 0)
+  {
+    Xfer.Result = 1;
+    Stats.Nacks++;
+    duration = EEPROM_SIM_BYTE_US + 10U;
+  }
+  else if (fault < ErrorRate)
+  {
+    Xfer.Result = 2;
+    Stats.Faults++;
+    duration /= 2U;
+  }
+  else if (fault < ErrorRate + HangRate)
+  {
+    /* SCL held low: no interrupt until the bus is reset */
+    Stats.Hangs++;
+    InFlight = 1;
+    return HAL_OK;
+  }
+  else
+  {
+    Stats.Bytes += Size;
+  }
+  Stats.BusTime += duration;
+  InFlight = 1;
+  SIM_Schedule(duration, I2C_Sim_Done, (void *)Generation);
+  return HAL_OK;
+}
+
+void I2C_IO_Init(void)
+{
+}
+
+void I2C_IO_Recover(void)
+{
+  /* DMA abort, peripheral de-init and init */
+  SIM_Busy(2U * I2C_SIM_ISR_US);
+  Stats.Recoveries++;
+  InFlight = 0;
+  ProbeHang = 0;
+  Generation++;
+}
+
+HAL_StatusTypeDef I2C_IO_MemWriteDMA(uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pBuffer, uint16_t Size)
+{
+  return I2C_Sim_Start(DevAddress, MemAddress, MemAddSize, pBuffer, Size, 1);
+}
+
+HAL_StatusTypeDef I2C_IO_MemReadDMA(uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pBuffer, uint16_t Size)
+{
+  return I2C_Sim_Start(DevAddress, MemAddress, MemAddSize, pBuffer, Size, 0);
+}
+
+/* One addressing attempt, its wait for the STOP bounded by a loop count. */
+HAL_StatusTypeDef I2C_IO_Probe(uint16_t DevAddress)
+{
+  if (InFlight != 0)
+  {
+    SIM_Busy(SIM_POLL_US);
+    return HAL_BUSY;
+  }
+  Stats.Probes++;
+  if (ProbeHang != 0)
+  {
+    Stats.Hangs++;
+    Stats.BusTime += I2C_SIM_PROBE_LIMIT_US;
+    SIM_Busy(I2C_SIM_PROBE_LIMIT_US);
+    return HAL_TIMEOUT;
+  }
+  Stats.BusTime += EEPROM_SIM_BYTE_US + 10U;
+  SIM_Busy(EEPROM_SIM_BYTE_US + 10U);
+  if (I2C_Sim_Ack(DevAddress) == 0)
+  {
+    Stats.Nacks++;
+    return HAL_ERROR;
+  }
+  return HAL_OK;
+}
+
+/* Temperature sensor link, as in stm32f072b_discovery.c */
+void TSENSOR_IO_Init(void)
+{
+  BSP_I2C_Init();
+}
+
+static void TSENSOR_IO_Transfer(uint16_t DevAddress, uint8_t *pBuffer, uint8_t Reg, uint16_t Length, uint8_t Write)
+{
+  I2C_TransactionTypeDef xfer;
+
+  memset(&xfer, 0, sizeof(xfer));
+  xfer.DevAddress = DevAddress;
+  xfer.MemAddress = Reg;
+  xfer.MemAddSize = I2C_MEMADD_SIZE_8BIT;
+  xfer.Size       = Length;
+  xfer.pBuffer    = pBuffer;
+  xfer.Write      = Write;
+  xfer.Priority   = I2C_PRIORITY_HIGH;
+  BSP_I2C_Transfer(&xfer);
+}
+
+void TSENSOR_IO_Write(uint16_t DevAddress, uint8_t *pBuffer, uint8_t WriteAddr, uint16_t Length)
+{
+  TSENSOR_IO_Transfer(DevAddress, pBuffer, WriteAddr, Length, 1);
+}
+
+void TSENSOR_IO_Read(uint16_t DevAddress, uint8_t *pBuffer, uint8_t ReadAddr, uint16_t Length)
+{
+  TSENSOR_IO_Transfer(DevAddress, pBuffer, ReadAddr, Length, 0);
+}
+
+uint16_t TSENSOR_IO_IsDeviceReady(uint16_t DevAddress, uint32_t Trials)
+{
+  HAL_StatusTypeDef status = HAL_ERROR;
+
+  while ((Trials-- > 0) && (status != HAL_OK))
+  {
+    status = BSP_I2C_Probe(DevAddress);
+  }
+  return (uint16_t)status;
+}
+
+void TSENSOR_IO_AlertConfig(uint32_t Enable)
+{
+  TsExti = Enable;
+  if (Enable != 0)
+  {
+    TSENSOR_IO_AlertCheck();
+  }
+}
+
+void TSENSOR_IO_AlertCheck(void)
+{
+  if ((TsExti != 0) && (TsOs != 0))
+  {
+    SIM_Schedule(0, I2C_Sim_Exti, (void *)TsGeneration);
+  }
+}
@@ -0,0 +1,390 @@
+/**
+  ******************************************************************************
+  * @file    lcd_sim.c
+  * @brief   ST7735 or HX8347D display model on SPI1 behind the LCD_IO_* link
+  *          layer.
+  *
+  *          Mirrors the LCD link section of stm32f072b_discovery.c: commands
+  *          go as one byte with the data/command line low; data go as one
+  *          byte, or as 16-bit frames, most significant byte first; every
+  *          blocking call first waits for the DMA transfer in progress.
+  *          LCD_IO_WriteDataDMA() and LCD_IO_FillDataDMA() start one
+  *          transfer per 65535 pixels, after the previous one, and return.
+  *          The pixels of a transfer reach the display memory when it ends,
+  *          so that a buffer changed during its transfer shows. The bus runs
+  *          at 12 MHz.
+  *          ST7735: 128 x 160, column and row address set (0x2A, 0x2B),
+  *          memory write (0x2C), memory access control (0x36): MX and MY
+  *          mirror the columns and rows against the 0xC0 of st7735_Init().
+  *          HX8347D: 320 x 240, 8-bit registers written with 16-bit data,
+  *          columns on registers 0x02-0x05 (the direction of the writes),
+  *          rows on 0x06-0x09, GRAM write (0x22) from the start addresses,
+  *          MX of register 0x16 mirrors the rows against 0xE0. Register 0x00
+  *          reads the ID, 0x47. Other commands and registers are ignored.
+  ******************************************************************************
+  */
+#include "stm32f0xx_hal.h"
+#include "lcd_sim.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+#define LCD_SIM_MAX_PIXELS   (320U * 240U)
+#define LCD_SIM_TIMEOUT_MS   100U
+
+static uint16_t            Frame[LCD_SIM_MAX_PIXELS];
+static LCD_SimStatsTypeDef Stats;
+static uintptr_t           Generation;
+static uint32_t            Controller;
+static uint16_t            Width;
+static uint16_t            Height;
+static uint8_t             Command;
+static uint32_t            ParamCount;
+static uint8_t             HighByte;
+static uint32_t            HaveHigh;
+/* Address window and counter, in memory columns and rows */
+static uint16_t            ColStart, ColEnd, RowStart, RowEnd;
+static uint16_t            Col, Row;
+static uint8_t             Access;
+static uint8_t             Regs[256];
+/* DMA transfer in progress */
+static uint32_t            DmaBusy;
+static uint16_t           *DmaData;
+static uint16_t            DmaFill;
+static uint32_t            DmaCount;
+
+void LCD_Sim_Reset(uint32_t Ctrl)
+{
+  Generation++;
+  Controller = Ctrl;
+  Command = 0;
+  ParamCount = 0;
+  HaveHigh = 0;
+  memset(Regs, 0, sizeof(Regs));
+  DmaBusy = 0;
+  Col = Row = 0;
+  ColStart = RowStart = 0;
+  if (Controller == LCD_SIM_ST7735)
+  {
+    Width = 128;
+    Height = 160;
+    Access = 0xC0;
+  }
+  else
+  {
+    Width = 320;
+    Height = 240;
+    Access = 0xE0;
+  }
+  ColEnd = (uint16_t)(Width - 1U);
+  RowEnd = (uint16_t)(Height - 1U);
+  LCD_Sim_Clear();
+}
+
+void LCD_Sim_Clear(void)
+{
+  memset(Frame, 0, sizeof(Frame));
+  memset(&Stats, 0, sizeof(Stats));
+}
+
+void LCD_Sim_GetStats(LCD_SimStatsTypeDef *pStats)
+{
+  *pStats = Stats;
+}
+
+const uint16_t *LCD_Sim_Frame(uint16_t *pWidth, uint16_t *pHeight)
+{
+  *pWidth = Width;
+  *pHeight = Height;
+  return Frame;
+}
+
+int LCD_Sim_WritePPM(const char *pPath)
+{
+  FILE    *f = fopen(pPath, "wb");
+  uint32_t i;
+  uint8_t  rgb[3];
+
+  if (f == NULL)
+  {
+    return 1;
+  }
+  fprintf(f, "P6\n%u %u\n255\n", (unsigned)Width, (unsigned)Height);
+  for (i = 0; i < (uint32_t)Width * Height; i++)
+  {
+    rgb[0] = (uint8_t)(((Frame[i] >> 11) & 0x1FU) * 255U / 31U);
+    rgb[1] = (uint8_t)(((Frame[i] >> 5) & 0x3FU) * 255U / 63U);
+    rgb[2] = (uint8_t)((Frame[i] & 0x1FU) * 255U / 31U);
+    fwrite(rgb, 1, 3, f);
+  }
+  return (fclose(f) == 0) ? 0 : 1;
+}
+
+/* Stores a pixel at the address counter and moves it on, columns first */
+static void LCD_Sim_Pixel(uint16_t RGBCode)
+{
+  uint32_t x = Col, y = Row;
+
+  if (Controller == LCD_SIM_ST7735)
+  {
+    x = (((Access ^ 0xC0U) & 0x40U) != 0) ? (Width - 1U - x) : x;
+    y = (((Access ^ 0xC0U) & 0x80U) != 0) ? (Height - 1U - y) : y;
+  }
+  else
+  {
+    y = (((Access ^ 0xE0U) & 0x40U) != 0) ? (Height - 1U - y) : y;
+  }
+  if ((x < Width) && (y < Height))
+  {
+    Frame[y * Width + x] = RGBCode;
+  }
+  Stats.Pixels++;
+
+  if (Col++ >= ColEnd)
+  {
+    Col = ColStart;
+    if (Row++ >= RowEnd)
+    {
+      Row = RowStart;
+    }
+  }
+}
+
+static void LCD_Sim_Command(uint8_t Cmd)
+{
+  Stats.Commands++;
+  Command = Cmd;
+  ParamCount = 0;
+  HaveHigh = 0;
+  if ((Controller == LCD_SIM_ST7735) ? (Cmd == 0x2CU) : (Cmd == 0x22U))
+  {
+    Col = ColStart;
+    Row = RowStart;
+  }
+}
+
+static void LCD_Sim_ST7735Data(uint8_t Data)
+{
+  uint16_t value;
+
+  switch (Command)
+  {
+  case 0x2A:
+  case 0x2B:
+    if ((ParamCount & 1U) == 0)
+    {
+      HighByte = Data;
+    }
+    else
+    {
+      value = (uint16_t)((HighByte << 8) | Data);
+      if (Command == 0x2AU)
+      {
+        *((ParamCount < 2U) ? &ColStart : &ColEnd) = value;
+      }
+      else
+      {
+        *((ParamCount < 2U) ? &RowStart : &RowEnd) = value;
+      }
+    }
+    ParamCount++;
+    break;
+  case 0x2C:
+    if (HaveHigh == 0)
+    {
+      HighByte = Data;
+      HaveHigh = 1;
+    }
+    else
+    {
+      HaveHigh = 0;
+      LCD_Sim_Pixel((uint16_t)((HighByte << 8) | Data));
+    }
+    break;
+  case 0x36:
+    Access = Data;
+    break;
+  default:
+    break;
+  }
+}
+
+static void LCD_Sim_HX8347DData(uint8_t Data)
+{
+  uint16_t value;
+
+  if (HaveHigh == 0)
+  {
+    HighByte = Data;
+    HaveHigh = 1;
+    return;
+  }
+  HaveHigh = 0;
+  value = (uint16_t)((HighByte << 8) | Data);
+  if (Command == 0x22U)
+  {
+    LCD_Sim_Pixel(value);
+    return;
+  }
+  Regs[Command] = (uint8_t)value;
+  ColStart = (uint16_t)((Regs[0x02] << 8) | Regs[0x03]);
+  ColEnd   = (uint16_t)((Regs[0x04] << 8) | Regs[0x05]);
+  RowStart = (uint16_t)((Regs[0x06] << 8) | Regs[0x07]);
+  RowEnd   = (uint16_t)((Regs[0x08] << 8) | Regs[0x09]);
+  if (Command == 0x16U)
+  {
+    Access = (uint8_t)value;
+  }
+}
+
+static void LCD_Sim_Data(uint8_t Data)
+{
+  Stats.DataBytes++;
+  if (Controller == LCD_SIM_ST7735)
+  {
+    LCD_Sim_ST7735Data(Data);
+  }
+  else
+  {
+    LCD_Sim_HX8347DData(Data);
+  }
+}
+
+/* CPU time of a blocking call sending Bytes bytes */
+static void LCD_Sim_Blocking(uint32_t Bytes)
+{
+  uint64_t us = LCD_SIM_CALL_US + LCD_SIM_BUS_US(Bytes);
+
+  Stats.Calls++;
+  Stats.BusTime += LCD_SIM_BUS_US(Bytes);
+  Stats.CpuTime += us;
+  SIM_Busy(us);
+}
+
+void LCD_IO_Init(void)
+{
+}
+
+void LCD_IO_WriteReg(uint8_t Reg)
+{
+  LCD_IO_WaitDMA();
+  LCD_Sim_Blocking(1);
+  LCD_Sim_Command(Reg);
+}
+
+void LCD_IO_WriteMultipleData(uint8_t *pData, uint32_t Size)
+{
+  uint32_t i;
+
+  LCD_IO_WaitDMA();
+  if (Size == 1U)
+  {
+    LCD_Sim_Blocking(1);
+    LCD_Sim_Data(pData[0]);
+    return;
+  }
+  /* 16-bit frames of the halfwords in memory: the odd byte is dropped */
+  LCD_Sim_Blocking(Size & ~1U);
+  for (i = 0; i + 1U < Size; i += 2U)
+  {
+    LCD_Sim_Data(pData[i + 1U]);
+    LCD_Sim_Data(pData[i]);
+  }
+}
+
+uint16_t LCD_IO_ReadData(uint16_t Reg)
+{
+  LCD_IO_WaitDMA();
+  LCD_Sim_Blocking(3);
+  LCD_Sim_Command((uint8_t)Reg);
+  if ((Controller == LCD_SIM_HX8347D) && (Reg == 0x00U))
+  {
+    return 0x47;
+  }
+  return Regs[Reg & 0xFFU];
+}
+
+static void LCD_Sim_DmaDone(void *arg)
+{
+  uint32_t i;
+
+  if ((uintptr_t)arg != Generation)
+  {
+    return;
+  }
+  for (i = 0; i < DmaCount; i++)
+  {
+    uint16_t v = (DmaData != NULL) ? DmaData[i] : DmaFill;
+
+    LCD_Sim_Data((uint8_t)(v >> 8));
+    LCD_Sim_Data((uint8_t)v);
+  }
+  DmaBusy = 0;
+  Stats.CpuTime += LCD_SIM_DMA_ISR_US;
+  SIM_Busy(LCD_SIM_DMA_ISR_US);
+}
+
+/* One DMA transfer of at most 65535 pixels, after the previous one */
+static void LCD_Sim_StartDMA(uint16_t *pData, uint16_t RGBCode, uint32_t Count)
+{
+  LCD_IO_WaitDMA();
+  Stats.DmaTransfers++;
+  Stats.BusTime += LCD_SIM_BUS_US(2U * Count);
+  Stats.CpuTime += LCD_SIM_DMA_START_US;
+  SIM_Busy(LCD_SIM_DMA_START_US);
+  DmaData = pData;
+  DmaFill = RGBCode;
+  DmaCount = Count;
+  DmaBusy = 1;
+  SIM_Schedule(LCD_SIM_BUS_US(2U * Count), LCD_Sim_DmaDone, (void *)Generation);
+}
+
+void LCD_IO_WriteDataDMA(uint16_t *pData, uint32_t Count)
+{
+  uint32_t count;
+
+  while (Count > 0)
+  {
+    count = (Count > 0xFFFFU) ? 0xFFFFU : Count;
+    LCD_Sim_StartDMA(pData, 0, count);
+    pData += count;
+    Count -= count;
+  }
+}
+
+void LCD_IO_FillDataDMA(uint16_t RGBCode, uint32_t Count)
+{
+  uint32_t count;
+
+  while (Count > 0)
+  {
+    count = (Count > 0xFFFFU) ? 0xFFFFU : Count;
+    LCD_Sim_StartDMA(NULL, RGBCode, count);
+    Count -= count;
+  }
+}
+
+void LCD_IO_WaitDMA(void)
+{
+  uint32_t tickstart;
+
+  if (DmaBusy == 0)
+  {
+    return;
+  }
+  tickstart = HAL_GetTick();
+  while (DmaBusy != 0)
+  {
+    if ((HAL_GetTick() - tickstart) > LCD_SIM_TIMEOUT_MS)
+    {
+      Stats.Timeouts++;
+      Generation++;
+      DmaBusy = 0;
+    }
+  }
+}
+
+void LCD_Delay(uint32_t Delay)
+{
+  HAL_Delay(Delay);
+}
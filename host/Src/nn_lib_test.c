@@ -0,0 +1,1349 @@
+/**
+  ******************************************************************************
+  * @file    nn_lib_test.c
+  * @brief   CMSIS-NN on the host: every kernel against the reference of
+  *          NN_Lib_Tests/nn_test/Ref_Implementations over random shapes,
+  *          with the MAC rate of both, and the cifar10 and gru example
+  *          networks through the kernels and through the references.
+  *
+  *          Usage: nn_lib_test [-v] [seed]
+  *          One line per kernel: shapes drawn, mean MACs per call, MMAC/s
+  *          of the kernel and of the reference, and the result; -v adds a
+  *          line per shape. Exits with status 1 on a mismatch.
+  *
+  ==============================================================================
+                          ##### Notes #####
+  ==============================================================================
+  *  cmsis_nn is built as for the Cortex-M0 (ARM_MATH_CM0): the portable C
+  *  paths the board runs, not the ARM_MATH_DSP ones of the Cortex-M4
+  *  projects the references came with. Outputs must be identical to the
+  *  references, but for arm_avepool_q7_HWC() (1 LSB, as in
+  *  arm_nnexamples_nn_test.cpp).
+  *
+  *  The _opt fully connected kernels get their weights interleaved here,
+  *  from a row-major matrix, as their comments describe, and must match
+  *  the plain reference on that matrix: this checks the layout the
+  *  converters have to write, which the *_opt_ref functions, taking the
+  *  interleaved weights as well, do not.
+  *
+  *  The kernels without a reference are held to a model in double: the
+  *  activation tables to sigmoid and tanh at the table points (q7) or
+  *  interpolated between them (q15), softmax to 2^x over the inputs within
+  *  8 (q7) or 16 (q15) of the largest, the q7 to q15 expansions to a sign
+  *  extension in order (the reordered one keeps it on the Cortex-M0), the
+  *  4-bit fully connected kernel to its sums and scales in 64 bits, its
+  *  weights packed here as arm_fully_connected_q7_q4() documents.
+  *
+  *  Shapes are drawn within the constraints of each kernel (_fast q7
+  *  convolutions: input channels a multiple of 4, output channels of 2,
+  *  and so on). Output shifts follow the spread of the sums, so that a few
+  *  outputs saturate; q15 data keep to 12 bits, which leaves the sums of
+  *  the largest shapes clear of overflow.
+  *
+  *  MACs: one per weight applied in convolutions and fully connected
+  *  layers, one per window element in pooling, one per element otherwise.
+  *  The in-place kernels (ReLU, pooling, activations) work on a fresh copy
+  *  of their input at each call, which counts in their time.
+  ******************************************************************************
+  */
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+#include "ref_functions.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arm_nnexamples_cifar10_parameter.h"
+#include "arm_nnexamples_cifar10_weights.h"
+#include "arm_nnexamples_cifar10_inputs.h"
+#include "arm_nnexamples_gru_test_data.h"
+
+#define CASES               24U        /* shapes per kernel */
+#define TIME_MIN            0.002      /* s of calls per shape and implementation */
+#define DATA_MAX            32768U     /* elements of a tensor */
+#define BIAS_MAX            64U
+
+#define Q15_BITS            12U        /* q15 data range, bits */
+
+typedef struct
+{
+  uint16_t InX, InY, ChIn;
+  uint16_t KerX, KerY, PadX, PadY, StrideX, StrideY;
+  uint16_t OutX, OutY, ChOut;
+  uint16_t BiasShift, OutShift;
+  uint16_t IntWidth;
+  arm_nn_activation_type Type;
+  uint32_t Size;                       /* elements, or vector length */
+  uint32_t Rows;                       /* fully connected outputs */
+} NN_ShapeTypeDef;
+
+typedef struct
+{
+  const char *Name;
+  uint32_t    Q15;                     /* q15_t output */
+  int32_t     Tolerance;               /* LSB */
+  uint64_t  (*Draw)(void);             /* shape and inputs, MACs per call */
+  void      (*Run)(void);              /* kernel into OutQ7 or OutQ15 */
+  void      (*Ref)(void);              /* reference into RefQ7 or RefQ15 */
+} NN_KernelTypeDef;
+
+static uint32_t        Seed = 1U;
+static int             Verbose;
+static NN_ShapeTypeDef S;
+static uint32_t        OutLen;
+static arm_status      Status;
+
+static q7_t  InQ7[DATA_MAX], WtQ7[DATA_MAX], WtOptQ7[DATA_MAX], BiasQ7[BIAS_MAX];
+static q7_t  OutQ7[DATA_MAX], RefQ7[DATA_MAX], WorkQ7[DATA_MAX];
+static q15_t InQ15[DATA_MAX], WtQ15[DATA_MAX], WtOptQ15[DATA_MAX], BiasQ15[BIAS_MAX];
+static q15_t OutQ15[DATA_MAX], RefQ15[DATA_MAX];
+static q15_t BufQ15[DATA_MAX];
+static uint16_t ScaleQ4[BIAS_MAX];
+static uint8_t  ZeroQ4[BIAS_MAX];
+
+static double NN_Seconds(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t NN_Rand(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return Seed >> 8;
+}
+
+/* Uniform in [Min, Max] */
+static int32_t NN_Range(int32_t Min, int32_t Max)
+{
+  return Min + (int32_t)(NN_Rand() % (uint32_t)(Max - Min + 1));
+}
+
+static void NN_FillQ7(q7_t *pData, uint32_t Count)
+{
+  uint32_t i;
+
+  for (i = 0; i < Count; i++)
+  {
+    pData[i] = (q7_t)NN_Range(-128, 127);
+  }
+}
+
+static void NN_FillQ15(q15_t *pData, uint32_t Count, uint32_t Bits)
+{
+  uint32_t i;
+
+  for (i = 0; i < Count; i++)
+  {
+    pData[i] = (q15_t)NN_Range(-(1 << (Bits - 1U)), (1 << (Bits - 1U)) - 1);
+  }
+}
+
+/* Output shift for sums of Count products of uniform BitsA and BitsB data:
+   a typical sum lands on a quarter of the OutBits range, give or take a
+   bit either way. At least 1, the rounding of the kernels needs it. */
+static uint16_t NN_Shift(uint32_t Count, uint32_t BitsA, uint32_t BitsB, uint32_t OutBits)
+{
+  double spread = ldexp(1.0, (int)(BitsA + BitsB - 2U)) / 3.0 * sqrt((double)Count);
+  int32_t shift = (int32_t)lround(log2(spread)) - (int32_t)(OutBits - 2U) + NN_Range(-1, 1);
+
+  return (uint16_t)((shift < 1) ? 1 : shift);
+}
+
+/* One axis of a convolution or pooling window; the output as the kernels
+   count it */
+static void NN_DrawAxis(uint16_t *pIn, uint16_t *pKer, uint16_t *pPad, uint16_t *pStride, uint16_t *pOut,
+                        uint32_t InMax, uint32_t KerMax)
+{
+  *pIn = (uint16_t)NN_Range(3, (int32_t)InMax);
+  *pKer = (uint16_t)NN_Range(1, (int32_t)((KerMax < *pIn) ? KerMax : *pIn));
+  *pPad = (uint16_t)NN_Range(0, *pKer / 2);
+  *pStride = (uint16_t)NN_Range(1, 2);
+  *pOut = (uint16_t)((*pIn + 2U * *pPad - *pKer) / *pStride + 1U);
+}
+
+static void NN_DrawWindow(uint32_t Square, uint32_t InMax, uint32_t KerMax)
+{
+  NN_DrawAxis(&S.InX, &S.KerX, &S.PadX, &S.StrideX, &S.OutX, InMax, KerMax);
+  if (Square != 0U)
+  {
+    S.InY = S.InX;
+    S.KerY = S.KerX;
+    S.PadY = S.PadX;
+    S.StrideY = S.StrideX;
+    S.OutY = S.OutX;
+  }
+  else
+  {
+    NN_DrawAxis(&S.InY, &S.KerY, &S.PadY, &S.StrideY, &S.OutY, InMax, KerMax);
+  }
+}
+
+/* Channel count in [Min, Max], a multiple of Multiple */
+static uint16_t NN_DrawChannels(uint32_t Min, uint32_t Max, uint32_t Multiple)
+{
+  return (uint16_t)(Multiple * (uint32_t)NN_Range((int32_t)((Min + Multiple - 1U) / Multiple), (int32_t)(Max / Multiple)));
+}
+
+/* Convolution: the window, weights, bias and shifts; MACs per call */
+static uint64_t NN_DrawConv(uint32_t Square, uint32_t Q15, uint32_t Depthwise)
+{
+  uint32_t taps, weights;
+
+  NN_DrawWindow(Square, 12U, 5U);
+  taps = (uint32_t)S.KerX * S.KerY * ((Depthwise != 0U) ? 1U : S.ChIn);
+  weights = taps * S.ChOut;
+  S.BiasShift = (uint16_t)NN_Range(0, 3);
+  S.OutShift = NN_Shift(taps, (Q15 != 0U) ? Q15_BITS : 8U, (Q15 != 0U) ? Q15_BITS : 8U, (Q15 != 0U) ? 16U : 8U);
+  OutLen = (uint32_t)S.OutX * S.OutY * S.ChOut;
+  if (Q15 != 0U)
+  {
+    NN_FillQ15(InQ15, (uint32_t)S.InX * S.InY * S.ChIn, Q15_BITS);
+    NN_FillQ15(WtQ15, weights, Q15_BITS);
+    NN_FillQ15(BiasQ15, S.ChOut, Q15_BITS);
+  }
+  else
+  {
+    NN_FillQ7(InQ7, (uint32_t)S.InX * S.InY * S.ChIn);
+    NN_FillQ7(WtQ7, weights);
+    NN_FillQ7(BiasQ7, S.ChOut);
+  }
+  return (uint64_t)OutLen * taps;
+}
+
+/* Convolutions ------------------------------------------------------------*/
+
+static uint64_t NN_DrawConvQ7Basic(void)
+{
+  S.ChIn = NN_DrawChannels(1U, 8U, 1U);
+  S.ChOut = NN_DrawChannels(1U, 8U, 1U);
+  return NN_DrawConv(1U, 0U, 0U);
+}
+
+static uint64_t NN_DrawConvQ7Fast(void)
+{
+  S.ChIn = NN_DrawChannels(4U, 16U, 4U);
+  S.ChOut = NN_DrawChannels(2U, 16U, 2U);
+  return NN_DrawConv(1U, 0U, 0U);
+}
+
+static uint64_t NN_DrawConvQ7RGB(void)
+{
+  S.ChIn = 3U;
+  S.ChOut = NN_DrawChannels(1U, 16U, 1U);
+  return NN_DrawConv(1U, 0U, 0U);
+}
+
+static uint64_t NN_DrawConvQ7BasicNonsquare(void)
+{
+  S.ChIn = NN_DrawChannels(1U, 8U, 1U);
+  S.ChOut = NN_DrawChannels(1U, 8U, 1U);
+  return NN_DrawConv(0U, 0U, 0U);
+}
+
+static uint64_t NN_DrawConvQ7FastNonsquare(void)
+{
+  S.ChIn = NN_DrawChannels(4U, 16U, 4U);
+  S.ChOut = NN_DrawChannels(2U, 16U, 2U);
+  return NN_DrawConv(0U, 0U, 0U);
+}
+
+static uint64_t NN_DrawConvQ7_1x1(void)
+{
+  uint64_t macs;
+
+  S.ChIn = NN_DrawChannels(4U, 32U, 4U);
+  S.ChOut = NN_DrawChannels(2U, 32U, 2U);
+  macs = NN_DrawConv(0U, 0U, 0U);
+  /* 1x1 kernel, no padding, stride 1 */
+  S.KerX = S.KerY = 1U;
+  S.PadX = S.PadY = 0U;
+  S.StrideX = S.StrideY = 1U;
+  S.OutX = S.InX;
+  S.OutY = S.InY;
+  OutLen = (uint32_t)S.OutX * S.OutY * S.ChOut;
+  S.OutShift = NN_Shift(S.ChIn, 8U, 8U, 8U);
+  (void)macs;
+  return (uint64_t)OutLen * S.ChIn;
+}
+
+static uint64_t NN_DrawConvQ15Basic(void)
+{
+  S.ChIn = NN_DrawChannels(1U, 8U, 1U);
+  S.ChOut = NN_DrawChannels(1U, 8U, 1U);
+  return NN_DrawConv(1U, 1U, 0U);
+}
+
+static uint64_t NN_DrawConvQ15Fast(void)
+{
+  S.ChIn = NN_DrawChannels(2U, 16U, 2U);
+  S.ChOut = NN_DrawChannels(2U, 16U, 2U);
+  return NN_DrawConv(1U, 1U, 0U);
+}
+
+static uint64_t NN_DrawConvQ15FastNonsquare(void)
+{
+  S.ChIn = NN_DrawChannels(2U, 16U, 2U);
+  S.ChOut = NN_DrawChannels(2U, 16U, 2U);
+  return NN_DrawConv(0U, 1U, 0U);
+}
+
+static uint64_t NN_DrawDepthwise(void)
+{
+  S.ChIn = S.ChOut = NN_DrawChannels(1U, 32U, 1U);
+  return NN_DrawConv(1U, 0U, 1U);
+}
+
+static uint64_t NN_DrawDepthwiseNonsquare(void)
+{
+  S.ChIn = S.ChOut = NN_DrawChannels(2U, 32U, 2U);
+  return NN_DrawConv(0U, 0U, 1U);
+}
+
+static void NN_RunConvQ7Basic(void)
+{
+  Status = arm_convolve_HWC_q7_basic(InQ7, S.InX, S.ChIn, WtQ7, S.ChOut, S.KerX, S.PadX, S.StrideX, BiasQ7,
+                                     S.BiasShift, S.OutShift, OutQ7, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RunConvQ7Fast(void)
+{
+  Status = arm_convolve_HWC_q7_fast(InQ7, S.InX, S.ChIn, WtQ7, S.ChOut, S.KerX, S.PadX, S.StrideX, BiasQ7,
+                                    S.BiasShift, S.OutShift, OutQ7, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RunConvQ7RGB(void)
+{
+  Status = arm_convolve_HWC_q7_RGB(InQ7, S.InX, S.ChIn, WtQ7, S.ChOut, S.KerX, S.PadX, S.StrideX, BiasQ7,
+                                   S.BiasShift, S.OutShift, OutQ7, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RefConvQ7(void)
+{
+  arm_convolve_HWC_q7_ref(InQ7, S.InX, S.ChIn, WtQ7, S.ChOut, S.KerX, S.PadX, S.StrideX, BiasQ7,
+                          S.BiasShift, S.OutShift, RefQ7, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RunConvQ7BasicNonsquare(void)
+{
+  Status = arm_convolve_HWC_q7_basic_nonsquare(InQ7, S.InX, S.InY, S.ChIn, WtQ7, S.ChOut, S.KerX, S.KerY,
+                                               S.PadX, S.PadY, S.StrideX, S.StrideY, BiasQ7, S.BiasShift,
+                                               S.OutShift, OutQ7, S.OutX, S.OutY, BufQ15, NULL);
+}
+
+static void NN_RunConvQ7FastNonsquare(void)
+{
+  Status = arm_convolve_HWC_q7_fast_nonsquare(InQ7, S.InX, S.InY, S.ChIn, WtQ7, S.ChOut, S.KerX, S.KerY,
+                                              S.PadX, S.PadY, S.StrideX, S.StrideY, BiasQ7, S.BiasShift,
+                                              S.OutShift, OutQ7, S.OutX, S.OutY, BufQ15, NULL);
+}
+
+static void NN_RunConvQ7_1x1(void)
+{
+  Status = arm_convolve_1x1_HWC_q7_fast_nonsquare(InQ7, S.InX, S.InY, S.ChIn, WtQ7, S.ChOut, S.KerX, S.KerY,
+                                                  S.PadX, S.PadY, S.StrideX, S.StrideY, BiasQ7, S.BiasShift,
+                                                  S.OutShift, OutQ7, S.OutX, S.OutY, BufQ15, NULL);
+}
+
+static void NN_RefConvQ7Nonsquare(void)
+{
+  arm_convolve_HWC_q7_ref_nonsquare(InQ7, S.InX, S.InY, S.ChIn, WtQ7, S.ChOut, S.KerX, S.KerY,
+                                    S.PadX, S.PadY, S.StrideX, S.StrideY, BiasQ7, S.BiasShift,
+                                    S.OutShift, RefQ7, S.OutX, S.OutY, BufQ15, NULL);
+}
+
+static void NN_RunConvQ15Basic(void)
+{
+  Status = arm_convolve_HWC_q15_basic(InQ15, S.InX, S.ChIn, WtQ15, S.ChOut, S.KerX, S.PadX, S.StrideX, BiasQ15,
+                                      S.BiasShift, S.OutShift, OutQ15, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RunConvQ15Fast(void)
+{
+  Status = arm_convolve_HWC_q15_fast(InQ15, S.InX, S.ChIn, WtQ15, S.ChOut, S.KerX, S.PadX, S.StrideX, BiasQ15,
+                                     S.BiasShift, S.OutShift, OutQ15, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RefConvQ15(void)
+{
+  arm_convolve_HWC_q15_ref(InQ15, S.InX, S.ChIn, WtQ15, S.ChOut, S.KerX, S.PadX, S.StrideX, BiasQ15,
+                           S.BiasShift, S.OutShift, RefQ15, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RunConvQ15FastNonsquare(void)
+{
+  Status = arm_convolve_HWC_q15_fast_nonsquare(InQ15, S.InX, S.InY, S.ChIn, WtQ15, S.ChOut, S.KerX, S.KerY,
+                                               S.PadX, S.PadY, S.StrideX, S.StrideY, BiasQ15, S.BiasShift,
+                                               S.OutShift, OutQ15, S.OutX, S.OutY, BufQ15, NULL);
+}
+
+static void NN_RefConvQ15Nonsquare(void)
+{
+  arm_convolve_HWC_q15_nonsquare_ref(InQ15, S.InX, S.InY, S.ChIn, WtQ15, S.ChOut, S.KerX, S.KerY,
+                                     S.PadX, S.PadY, S.StrideX, S.StrideY, BiasQ15, S.BiasShift,
+                                     S.OutShift, RefQ15, S.OutX, S.OutY, BufQ15, NULL);
+}
+
+static void NN_RunDepthwise(void)
+{
+  Status = arm_depthwise_separable_conv_HWC_q7(InQ7, S.InX, S.ChIn, WtQ7, S.ChOut, S.KerX, S.PadX, S.StrideX,
+                                               BiasQ7, S.BiasShift, S.OutShift, OutQ7, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RefDepthwise(void)
+{
+  arm_depthwise_separable_conv_HWC_q7_ref(InQ7, S.InX, S.ChIn, WtQ7, S.ChOut, S.KerX, S.PadX, S.StrideX,
+                                          BiasQ7, S.BiasShift, S.OutShift, RefQ7, S.OutX, BufQ15, NULL);
+}
+
+static void NN_RunDepthwiseNonsquare(void)
+{
+  Status = arm_depthwise_separable_conv_HWC_q7_nonsquare(InQ7, S.InX, S.InY, S.ChIn, WtQ7, S.ChOut, S.KerX,
+                                                         S.KerY, S.PadX, S.PadY, S.StrideX, S.StrideY, BiasQ7,
+                                                         S.BiasShift, S.OutShift, OutQ7, S.OutX, S.OutY,
+                                                         BufQ15, NULL);
+}
+
+static void NN_RefDepthwiseNonsquare(void)
+{
+  arm_depthwise_separable_conv_HWC_q7_ref_nonsquare(InQ7, S.InX, S.InY, S.ChIn, WtQ7, S.ChOut, S.KerX,
+                                                    S.KerY, S.PadX, S.PadY, S.StrideX, S.StrideY, BiasQ7,
+                                                    S.BiasShift, S.OutShift, RefQ7, S.OutX, S.OutY,
+                                                    BufQ15, NULL);
+}
+
+/* Fully connected ---------------------------------------------------------*/
+
+/* Row-major Rows x Cols q7 matrix interleaved for arm_fully_connected_q7_opt():
+   per 4 rows and 4 columns, rows 1-2 then 3-4 of columns 1 and 3, then of
+   columns 2 and 4; the columns left over 4 rows at a time, the rows left
+   over as they are */
+static void NN_InterleaveQ7Opt(const q7_t *pM, q7_t *pOpt, uint32_t Rows, uint32_t Cols)
+{
+  uint32_t r, c, k, half;
+
+  for (r = 0; r + 4U <= Rows; r += 4U)
+  {
+    for (c = 0; c + 4U <= Cols; c += 4U)
+    {
+      for (half = 0; half < 2U; half++)
+      {
+        for (k = 0; k < 4U; k += 2U)
+        {
+          *pOpt++ = pM[(r + k) * Cols + c + half];
+          *pOpt++ = pM[(r + k + 1U) * Cols + c + half];
+          *pOpt++ = pM[(r + k) * Cols + c + half + 2U];
+          *pOpt++ = pM[(r + k + 1U) * Cols + c + half + 2U];
+        }
+      }
+    }
+    for (; c < Cols; c++)
+    {
+      for (k = 0; k < 4U; k++)
+      {
+        *pOpt++ = pM[(r + k) * Cols + c];
+      }
+    }
+  }
+  memcpy(pOpt, &pM[r * Cols], (Rows - r) * Cols);
+}
+
+/* For arm_fully_connected_mat_q7_vec_q15_opt(): per 4 rows and 2 columns,
+   rows 1-2 then 3-4, each as row 1 column 1, row 2 column 1, row 1 column
+   2, row 2 column 2; the column left over 4 rows at a time */
+static void NN_InterleaveQ7Q15Opt(const q7_t *pM, q7_t *pOpt, uint32_t Rows, uint32_t Cols)
+{
+  uint32_t r, c, k;
+
+  for (r = 0; r + 4U <= Rows; r += 4U)
+  {
+    for (c = 0; c + 2U <= Cols; c += 2U)
+    {
+      for (k = 0; k < 4U; k += 2U)
+      {
+        *pOpt++ = pM[(r + k) * Cols + c];
+        *pOpt++ = pM[(r + k + 1U) * Cols + c];
+        *pOpt++ = pM[(r + k) * Cols + c + 1U];
+        *pOpt++ = pM[(r + k + 1U) * Cols + c + 1U];
+      }
+    }
+    for (; c < Cols; c++)
+    {
+      for (k = 0; k < 4U; k++)
+      {
+        *pOpt++ = pM[(r + k) * Cols + c];
+      }
+    }
+  }
+  memcpy(pOpt, &pM[r * Cols], (Rows - r) * Cols);
+}
+
+/* For arm_fully_connected_q15_opt(): per 4 rows and 2 columns, each row's
+   pair; the column left over 4 rows at a time */
+static void NN_InterleaveQ15Opt(const q15_t *pM, q15_t *pOpt, uint32_t Rows, uint32_t Cols)
+{
+  uint32_t r, c, k;
+
+  for (r = 0; r + 4U <= Rows; r += 4U)
+  {
+    for (c = 0; c + 2U <= Cols; c += 2U)
+    {
+      for (k = 0; k < 4U; k++)
+      {
+        *pOpt++ = pM[(r + k) * Cols + c];
+        *pOpt++ = pM[(r + k) * Cols + c + 1U];
+      }
+    }
+    for (; c < Cols; c++)
+    {
+      for (k = 0; k < 4U; k++)
+      {
+        *pOpt++ = pM[(r + k) * Cols + c];
+      }
+    }
+  }
+  memcpy(pOpt, &pM[r * Cols], (Rows - r) * Cols * sizeof(q15_t));
+}
+
+/* Vector of Size, Rows outputs; VecQ15 and WtQ15: which operands are q15 */
+static uint64_t NN_DrawFc(uint32_t VecQ15, uint32_t WtQ15Type, uint32_t OutQ15Type)
+{
+  S.Size = (uint32_t)NN_Range(1, 320);
+  S.Rows = (uint32_t)NN_Range(1, BIAS_MAX);
+  S.BiasShift = (uint16_t)NN_Range(0, 3);
+  S.OutShift = NN_Shift(S.Size, (VecQ15 != 0U) ? Q15_BITS : 8U, (WtQ15Type != 0U) ? Q15_BITS : 8U,
+                        (OutQ15Type != 0U) ? 16U : 8U);
+  OutLen = S.Rows;
+  if (VecQ15 != 0U)
+  {
+    NN_FillQ15(InQ15, S.Size, Q15_BITS);
+  }
+  else
+  {
+    NN_FillQ7(InQ7, S.Size);
+  }
+  if (WtQ15Type != 0U)
+  {
+    NN_FillQ15(WtQ15, S.Size * S.Rows, Q15_BITS);
+    NN_FillQ15(BiasQ15, S.Rows, Q15_BITS);
+    NN_InterleaveQ15Opt(WtQ15, WtOptQ15, S.Rows, S.Size);
+  }
+  else
+  {
+    NN_FillQ7(WtQ7, S.Size * S.Rows);
+    NN_FillQ7(BiasQ7, S.Rows);
+    if (VecQ15 != 0U)
+    {
+      NN_InterleaveQ7Q15Opt(WtQ7, WtOptQ7, S.Rows, S.Size);
+    }
+    else
+    {
+      NN_InterleaveQ7Opt(WtQ7, WtOptQ7, S.Rows, S.Size);
+    }
+  }
+  return (uint64_t)S.Size * S.Rows;
+}
+
+static uint64_t NN_DrawFcQ7(void)
+{
+  return NN_DrawFc(0U, 0U, 0U);
+}
+
+static uint64_t NN_DrawFcQ15(void)
+{
+  return NN_DrawFc(1U, 1U, 1U);
+}
+
+static uint64_t NN_DrawFcQ7Q15(void)
+{
+  return NN_DrawFc(1U, 0U, 1U);
+}
+
+static void NN_RunFcQ7(void)
+{
+  Status = arm_fully_connected_q7(InQ7, WtQ7, S.Size, S.Rows, S.BiasShift, S.OutShift, BiasQ7, OutQ7, BufQ15);
+}
+
+static void NN_RunFcQ7Opt(void)
+{
+  Status = arm_fully_connected_q7_opt(InQ7, WtOptQ7, S.Size, S.Rows, S.BiasShift, S.OutShift, BiasQ7, OutQ7,
+                                      BufQ15);
+}
+
+static void NN_RefFcQ7(void)
+{
+  arm_fully_connected_q7_ref(InQ7, WtQ7, S.Size, S.Rows, S.BiasShift, S.OutShift, BiasQ7, RefQ7, BufQ15);
+}
+
+static void NN_RunFcQ15(void)
+{
+  Status = arm_fully_connected_q15(InQ15, WtQ15, S.Size, S.Rows, S.BiasShift, S.OutShift, BiasQ15, OutQ15,
+                                   NULL);
+}
+
+static void NN_RunFcQ15Opt(void)
+{
+  Status = arm_fully_connected_q15_opt(InQ15, WtOptQ15, S.Size, S.Rows, S.BiasShift, S.OutShift, BiasQ15,
+                                       OutQ15, NULL);
+}
+
+static void NN_RefFcQ15(void)
+{
+  arm_fully_connected_q15_ref(InQ15, WtQ15, S.Size, S.Rows, S.BiasShift, S.OutShift, BiasQ15, RefQ15, NULL);
+}
+
+static void NN_RunFcQ7Q15(void)
+{
+  Status = arm_fully_connected_mat_q7_vec_q15(InQ15, WtQ7, S.Size, S.Rows, S.BiasShift, S.OutShift, BiasQ7,
+                                              OutQ15, NULL);
+}
+
+static void NN_RunFcQ7Q15Opt(void)
+{
+  Status = arm_fully_connected_mat_q7_vec_q15_opt(InQ15, WtOptQ7, S.Size, S.Rows, S.BiasShift, S.OutShift,
+                                                  BiasQ7, OutQ15, NULL);
+}
+
+static void NN_RefFcQ7Q15(void)
+{
+  arm_fully_connected_mat_q7_vec_q15_ref(InQ15, WtQ7, S.Size, S.Rows, S.BiasShift, S.OutShift, BiasQ7, RefQ15,
+                                         NULL);
+}
+
+/* For arm_fully_connected_q7_q4(): the 4-bit values of pM (row-major, one
+   a byte) two columns a byte, the first low; rows by groups of 4, the last
+   of the rows left over, interleaved byte by byte within a group */
+static void NN_PackQ4(const q7_t *pM, uint8_t *pPacked, uint32_t Rows, uint32_t Cols)
+{
+  uint32_t bytes = (Cols + 1U) / 2U;
+  uint32_t r, p, k, c;
+
+  for (r = 0; r < Rows; r++)
+  {
+    uint32_t first = (r & ~3U) * bytes + (r & 3U);
+    uint32_t step = (Rows - (r & ~3U) < 4U) ? Rows - (r & ~3U) : 4U;
+
+    for (p = 0; p < bytes; p++)
+    {
+      c = 2U * p;
+      k = (c + 1U < Cols) ? (uint32_t)pM[r * Cols + c + 1U] : 0U;
+      pPacked[first + p * step] = (uint8_t)((uint32_t)pM[r * Cols + c] | (k << 4));
+    }
+  }
+}
+
+/* Weights 0..15 with a zero point and scale per row, the scales up to the
+   largest tools/nn_q4_pack.py writes (a q7 range over 15 steps) */
+static uint64_t NN_DrawFcQ4(void)
+{
+  uint32_t i;
+
+  S.Size = (uint32_t)NN_Range(1, 320);
+  S.Rows = (uint32_t)NN_Range(1, BIAS_MAX);
+  S.BiasShift = (uint16_t)NN_Range(0, 3);
+  S.OutShift = NN_Shift(S.Size, 8U, 8U, 8U);
+  OutLen = S.Rows;
+  NN_FillQ7(InQ7, S.Size);
+  for (i = 0; i < S.Size * S.Rows; i++)
+  {
+    WtQ7[i] = (q7_t)NN_Range(0, 15);
+  }
+  for (i = 0; i < S.Rows; i++)
+  {
+    ScaleQ4[i] = (uint16_t)NN_Range(1, (255 << ARM_NN_Q4_SCALE_SHIFT) / 15);
+    ZeroQ4[i] = (uint8_t)NN_Range(0, 15);
+  }
+  NN_FillQ7(BiasQ7, S.Rows);
+  NN_PackQ4(WtQ7, (uint8_t *)WtOptQ7, S.Rows, S.Size);
+  return (uint64_t)S.Size * S.Rows;
+}
+
+static void NN_RunFcQ4(void)
+{
+  Status = arm_fully_connected_q7_q4(InQ7, (const uint8_t *)WtOptQ7, ScaleQ4, ZeroQ4, S.Size, S.Rows,
+                                     S.BiasShift, S.OutShift, BiasQ7, OutQ7);
+}
+
+/* The sum of the 64-bit products of the scales, rounded to nearest */
+static void NN_RefFcQ4(void)
+{
+  uint32_t r, c;
+
+  for (r = 0; r < S.Rows; r++)
+  {
+    int64_t acc = 0;
+    int64_t out;
+
+    for (c = 0; c < S.Size; c++)
+    {
+      acc += (int64_t)InQ7[c] * (WtQ7[r * S.Size + c] - ZeroQ4[r]);
+    }
+    out = ((int64_t)BiasQ7[r] << S.BiasShift) + NN_ROUND(S.OutShift)
+        + ((acc * ScaleQ4[r] + (1 << (ARM_NN_Q4_SCALE_SHIFT - 1))) >> ARM_NN_Q4_SCALE_SHIFT);
+    RefQ7[r] = (q7_t)__SSAT((int32_t)(out >> S.OutShift), 8);
+  }
+}
+
+/* Pooling -----------------------------------------------------------------*/
+
+static uint64_t NN_DrawPool(void)
+{
+  NN_DrawWindow(1U, 16U, 4U);
+  S.ChIn = S.ChOut = NN_DrawChannels(1U, 16U, 1U);
+  OutLen = (uint32_t)S.OutX * S.OutY * S.ChOut;
+  NN_FillQ7(InQ7, (uint32_t)S.InX * S.InY * S.ChIn);
+  return (uint64_t)OutLen * S.KerX * S.KerY;
+}
+
+/* The kernels work in place: on a copy */
+static void NN_RunMaxpool(void)
+{
+  memcpy(WorkQ7, InQ7, (uint32_t)S.InX * S.InY * S.ChIn);
+  arm_maxpool_q7_HWC(WorkQ7, S.InX, S.ChIn, S.KerX, S.PadX, S.StrideX, S.OutX, (q7_t *)BufQ15, OutQ7);
+}
+
+static void NN_RefMaxpool(void)
+{
+  memcpy(WorkQ7, InQ7, (uint32_t)S.InX * S.InY * S.ChIn);
+  arm_maxpool_q7_HWC_ref(WorkQ7, S.InX, S.ChIn, S.KerX, S.PadX, S.StrideX, S.OutX, (q7_t *)BufQ15, RefQ7);
+}
+
+static void NN_RunAvepool(void)
+{
+  memcpy(WorkQ7, InQ7, (uint32_t)S.InX * S.InY * S.ChIn);
+  arm_avepool_q7_HWC(WorkQ7, S.InX, S.ChIn, S.KerX, S.PadX, S.StrideX, S.OutX, (q7_t *)BufQ15, OutQ7);
+}
+
+static void NN_RefAvepool(void)
+{
+  memcpy(WorkQ7, InQ7, (uint32_t)S.InX * S.InY * S.ChIn);
+  arm_avepool_q7_HWC_ref(WorkQ7, S.InX, S.ChIn, S.KerX, S.PadX, S.StrideX, S.OutX, (q7_t *)BufQ15, RefQ7);
+}
+
+/* Element-wise ------------------------------------------------------------*/
+
+static uint64_t NN_DrawVector(void)
+{
+  S.Size = (uint32_t)NN_Range(1, 2048);
+  OutLen = S.Size;
+  NN_FillQ7(InQ7, 2U * S.Size);
+  NN_FillQ15(InQ15, 2U * S.Size, 16U);
+  return S.Size;
+}
+
+static void NN_RunReluQ7(void)
+{
+  memcpy(OutQ7, InQ7, S.Size);
+  arm_relu_q7(OutQ7, (uint16_t)S.Size);
+}
+
+static void NN_RefReluQ7(void)
+{
+  memcpy(RefQ7, InQ7, S.Size);
+  arm_relu_q7_ref(RefQ7, (uint16_t)S.Size);
+}
+
+static void NN_RunReluQ15(void)
+{
+  memcpy(OutQ15, InQ15, S.Size * sizeof(q15_t));
+  arm_relu_q15(OutQ15, (uint16_t)S.Size);
+}
+
+static void NN_RefReluQ15(void)
+{
+  memcpy(RefQ15, InQ15, S.Size * sizeof(q15_t));
+  arm_relu_q15_ref(RefQ15, (uint16_t)S.Size);
+}
+
+static uint64_t NN_DrawMultQ7(void)
+{
+  uint64_t macs = NN_DrawVector();
+
+  S.OutShift = (uint16_t)NN_Range(1, 10);
+  return macs;
+}
+
+static uint64_t NN_DrawMultQ15(void)
+{
+  uint64_t macs = NN_DrawVector();
+
+  S.OutShift = (uint16_t)NN_Range(9, 18);
+  return macs;
+}
+
+static void NN_RunMultQ7(void)
+{
+  arm_nn_mult_q7(InQ7, InQ7 + S.Size, OutQ7, S.OutShift, S.Size);
+}
+
+static void NN_RefMultQ7(void)
+{
+  arm_nn_mult_q7_ref(InQ7, InQ7 + S.Size, RefQ7, S.OutShift, S.Size);
+}
+
+static void NN_RunMultQ15(void)
+{
+  arm_nn_mult_q15(InQ15, InQ15 + S.Size, OutQ15, S.OutShift, S.Size);
+}
+
+static void NN_RefMultQ15(void)
+{
+  arm_nn_mult_q15_ref(InQ15, InQ15 + S.Size, RefQ15, S.OutShift, S.Size);
+}
+
+static void NN_RunQ7ToQ15(void)
+{
+  arm_q7_to_q15_no_shift(InQ7, OutQ15, S.Size);
+}
+
+static void NN_RunQ7ToQ15Reordered(void)
+{
+  arm_q7_to_q15_reordered_no_shift(InQ7, OutQ15, S.Size);
+}
+
+static void NN_RefQ7ToQ15(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < S.Size; i++)
+  {
+    RefQ15[i] = InQ7[i];
+  }
+}
+
+/* Per 4: 1, 3, 2, 4, the two words of __SXTB16() and __SXTB16(__ROR(, 8));
+   the tail in order. The Cortex-M0 path, and the kernels that read its
+   output there, keep the order throughout. */
+static void NN_RefQ7ToQ15Reordered(void)
+{
+#ifdef ARM_MATH_CM0_FAMILY
+  NN_RefQ7ToQ15();
+#else
+  static const uint8_t order[4] = { 0, 2, 1, 3 };
+  uint32_t i;
+
+  for (i = 0; i < S.Size; i++)
+  {
+    RefQ15[i] = InQ7[(i < (S.Size & ~3U)) ? (i & ~3U) + order[i & 3U] : i];
+  }
+#endif
+}
+
+/* Activations and softmax -------------------------------------------------*/
+
+static uint64_t NN_DrawActivation(void)
+{
+  uint64_t macs = NN_DrawVector();
+
+  S.IntWidth = (uint16_t)NN_Range(0, 3);
+  S.Type = (NN_Rand() & 1U) ? ARM_TANH : ARM_SIGMOID;
+  return macs;
+}
+
+static double NN_Activation(double x)
+{
+  return (S.Type == ARM_SIGMOID) ? 1.0 / (1.0 + exp(-x)) : tanh(x);
+}
+
+static int32_t NN_Saturate(double Value, uint32_t Bits)
+{
+  double max = ldexp(1.0, (int)Bits - 1) - 1.0;
+
+  return (int32_t)((Value > max) ? max : ((Value < -max - 1.0) ? -max - 1.0 : Value));
+}
+
+static void NN_RunActivationQ7(void)
+{
+  memcpy(OutQ7, InQ7, S.Size);
+  arm_nn_activations_direct_q7(OutQ7, (uint16_t)S.Size, S.IntWidth, S.Type);
+}
+
+/* The table holds the function on [-8, 8) in steps of 1/16: at the point
+   the input falls on, after the shift to 3 integer bits */
+static void NN_RefActivationQ7(void)
+{
+  uint32_t i;
+  int32_t  point;
+
+  for (i = 0; i < S.Size; i++)
+  {
+    point = InQ7[i] >> (3U - S.IntWidth);
+    RefQ7[i] = (q7_t)NN_Saturate(round(NN_Activation(point / 16.0) * 128.0), 8U);
+  }
+}
+
+static void NN_RunActivationQ15(void)
+{
+  memcpy(OutQ15, InQ15, S.Size * sizeof(q15_t));
+  arm_nn_activations_direct_q15(OutQ15, (uint16_t)S.Size, S.IntWidth, S.Type);
+}
+
+/* Linear between the points around the input; the last point held */
+static void NN_RefActivationQ15(void)
+{
+  uint32_t shift = 11U - S.IntWidth, i;
+  int32_t  point;
+  double   frac, value;
+
+  for (i = 0; i < S.Size; i++)
+  {
+    point = InQ15[i] >> shift;
+    frac = (InQ15[i] & ((1 << shift) - 1)) / ldexp(1.0, (int)shift);
+    value = NN_Activation(point / 16.0);
+    if (point != 127)
+    {
+      value += (NN_Activation((point + 1) / 16.0) - value) * frac;
+    }
+    RefQ15[i] = (q15_t)NN_Saturate(round(value * 32768.0), 16U);
+  }
+}
+
+/* Inputs within Spread of each other, at an offset, so that a few or most
+   count in the sum */
+static uint64_t NN_DrawSoftmax(void)
+{
+  int32_t spread, offset, bits;
+  uint32_t i;
+
+  S.Size = (uint32_t)NN_Range(1, 64);
+  OutLen = S.Size;
+  bits = NN_Range(3, 8);
+  spread = 1 << bits;
+  offset = NN_Range(-128, 128 - spread);
+  for (i = 0; i < S.Size; i++)
+  {
+    InQ7[i] = (q7_t)(offset + NN_Range(0, spread - 1));
+    InQ15[i] = (q15_t)(offset * 256 + NN_Range(0, (spread << NN_Range(0, 2)) - 1));
+  }
+  return S.Size;
+}
+
+static void NN_RunSoftmaxQ7(void)
+{
+  arm_softmax_q7(InQ7, (uint16_t)S.Size, OutQ7);
+}
+
+static void NN_RunSoftmaxQ15(void)
+{
+  arm_softmax_q15(InQ15, (uint16_t)S.Size, OutQ15);
+}
+
+/* 2^x over the sum for the inputs within Window below the largest, scaled
+   to 2^Frac and rounded down, 0 for the others */
+static void NN_RefSoftmax(const void *pIn, uint32_t Q15, int32_t Window, uint32_t Frac)
+{
+  int32_t max = -65536, x;
+  double   sum = 0.0;
+  uint32_t i;
+
+  for (i = 0; i < S.Size; i++)
+  {
+    x = (Q15 != 0U) ? ((const q15_t *)pIn)[i] : ((const q7_t *)pIn)[i];
+    max = (x > max) ? x : max;
+  }
+  for (i = 0; i < S.Size; i++)
+  {
+    x = (Q15 != 0U) ? ((const q15_t *)pIn)[i] : ((const q7_t *)pIn)[i];
+    sum += (x > max - Window) ? ldexp(1.0, x - max) : 0.0;
+  }
+  for (i = 0; i < S.Size; i++)
+  {
+    x = (Q15 != 0U) ? ((const q15_t *)pIn)[i] : ((const q7_t *)pIn)[i];
+    x = (x > max - Window) ? NN_Saturate(floor(ldexp(1.0, x - max + (int)Frac) / sum), Frac + 1U) : 0;
+    if (Q15 != 0U)
+    {
+      RefQ15[i] = (q15_t)x;
+    }
+    else
+    {
+      RefQ7[i] = (q7_t)x;
+    }
+  }
+}
+
+static void NN_RefSoftmaxQ7(void)
+{
+  NN_RefSoftmax(InQ7, 0U, 8, 7U);
+}
+
+static void NN_RefSoftmaxQ15(void)
+{
+  NN_RefSoftmax(InQ15, 1U, 16, 15U);
+}
+
+static const NN_KernelTypeDef Kernels[] =
+{
+  { "convolve_HWC_q7_basic",             0, 0, NN_DrawConvQ7Basic,          NN_RunConvQ7Basic,          NN_RefConvQ7 },
+  { "convolve_HWC_q7_fast",              0, 0, NN_DrawConvQ7Fast,           NN_RunConvQ7Fast,           NN_RefConvQ7 },
+  { "convolve_HWC_q7_RGB",               0, 0, NN_DrawConvQ7RGB,            NN_RunConvQ7RGB,            NN_RefConvQ7 },
+  { "convolve_HWC_q7_basic_nonsquare",   0, 0, NN_DrawConvQ7BasicNonsquare, NN_RunConvQ7BasicNonsquare, NN_RefConvQ7Nonsquare },
+  { "convolve_HWC_q7_fast_nonsquare",    0, 0, NN_DrawConvQ7FastNonsquare,  NN_RunConvQ7FastNonsquare,  NN_RefConvQ7Nonsquare },
+  { "convolve_1x1_HWC_q7_fast_nonsquare", 0, 0, NN_DrawConvQ7_1x1,          NN_RunConvQ7_1x1,           NN_RefConvQ7Nonsquare },
+  { "convolve_HWC_q15_basic",            1, 0, NN_DrawConvQ15Basic,         NN_RunConvQ15Basic,         NN_RefConvQ15 },
+  { "convolve_HWC_q15_fast",             1, 0, NN_DrawConvQ15Fast,          NN_RunConvQ15Fast,          NN_RefConvQ15 },
+  { "convolve_HWC_q15_fast_nonsquare",   1, 0, NN_DrawConvQ15FastNonsquare, NN_RunConvQ15FastNonsquare, NN_RefConvQ15Nonsquare },
+  { "depthwise_separable_conv_HWC_q7",   0, 0, NN_DrawDepthwise,            NN_RunDepthwise,            NN_RefDepthwise },
+  { "depthwise_separable_conv_HWC_q7_nonsquare", 0, 0, NN_DrawDepthwiseNonsquare, NN_RunDepthwiseNonsquare, NN_RefDepthwiseNonsquare },
+  { "fully_connected_q7",                0, 0, NN_DrawFcQ7,                 NN_RunFcQ7,                 NN_RefFcQ7 },
+  { "fully_connected_q7_opt",            0, 0, NN_DrawFcQ7,                 NN_RunFcQ7Opt,              NN_RefFcQ7 },
+  { "fully_connected_q15",               1, 0, NN_DrawFcQ15,                NN_RunFcQ15,                NN_RefFcQ15 },
+  { "fully_connected_q15_opt",           1, 0, NN_DrawFcQ15,                NN_RunFcQ15Opt,             NN_RefFcQ15 },
+  { "fully_connected_mat_q7_vec_q15",    1, 0, NN_DrawFcQ7Q15,              NN_RunFcQ7Q15,              NN_RefFcQ7Q15 },
+  { "fully_connected_mat_q7_vec_q15_opt", 1, 0, NN_DrawFcQ7Q15,             NN_RunFcQ7Q15Opt,           NN_RefFcQ7Q15 },
+  { "fully_connected_q7_q4",             0, 0, NN_DrawFcQ4,                 NN_RunFcQ4,                 NN_RefFcQ4 },
+  { "maxpool_q7_HWC",                    0, 0, NN_DrawPool,                 NN_RunMaxpool,              NN_RefMaxpool },
+  { "avepool_q7_HWC",                    0, 1, NN_DrawPool,                 NN_RunAvepool,              NN_RefAvepool },
+  { "relu_q7",                           0, 0, NN_DrawVector,               NN_RunReluQ7,               NN_RefReluQ7 },
+  { "relu_q15",                          1, 0, NN_DrawVector,               NN_RunReluQ15,              NN_RefReluQ15 },
+  { "nn_mult_q7",                        0, 0, NN_DrawMultQ7,               NN_RunMultQ7,               NN_RefMultQ7 },
+  { "nn_mult_q15",                       1, 0, NN_DrawMultQ15,              NN_RunMultQ15,              NN_RefMultQ15 },
+  { "q7_to_q15_no_shift",                1, 0, NN_DrawVector,               NN_RunQ7ToQ15,              NN_RefQ7ToQ15 },
+  { "q7_to_q15_reordered_no_shift",      1, 0, NN_DrawVector,               NN_RunQ7ToQ15Reordered,     NN_RefQ7ToQ15Reordered },
+  { "nn_activations_direct_q7",          0, 1, NN_DrawActivation,           NN_RunActivationQ7,         NN_RefActivationQ7 },
+  { "nn_activations_direct_q15",         1, 2, NN_DrawActivation,           NN_RunActivationQ15,        NN_RefActivationQ15 },
+  { "softmax_q7",                        0, 0, NN_DrawSoftmax,              NN_RunSoftmaxQ7,            NN_RefSoftmaxQ7 },
+  { "softmax_q15",                       1, 0, NN_DrawSoftmax,              NN_RunSoftmaxQ15,           NN_RefSoftmaxQ15 },
+};
+
+static void NN_PrintShape(void)
+{
+  printf("    in %ux%ux%u kernel %ux%u pad %u,%u stride %u,%u out %ux%ux%u shift %u,%u size %u rows %u "
+         "int %u %s\n", S.InX, S.InY, S.ChIn, S.KerX, S.KerY, S.PadX, S.PadY, S.StrideX, S.StrideY,
+         S.OutX, S.OutY, S.ChOut, S.BiasShift, S.OutShift, (unsigned)S.Size, (unsigned)S.Rows, S.IntWidth,
+         (S.Type == ARM_SIGMOID) ? "sigmoid" : "tanh");
+}
+
+/* Index of the first output further than Tolerance from the reference,
+   OutLen if none; the outputs past OutLen must be as they were */
+static uint32_t NN_Compare(uint32_t Q15, int32_t Tolerance)
+{
+  int32_t  diff;
+  uint32_t i;
+
+  for (i = 0; i < OutLen; i++)
+  {
+    diff = (Q15 != 0U) ? OutQ15[i] - RefQ15[i] : OutQ7[i] - RefQ7[i];
+    if ((diff > Tolerance) || (diff < -Tolerance))
+    {
+      return i;
+    }
+  }
+  return OutLen;
+}
+
+/* Calls of Fn for at least TIME_MIN, s per call */
+static double NN_Time(void (*Fn)(void))
+{
+  uint32_t calls = 0;
+  double   t0 = NN_Seconds(), t;
+
+  do
+  {
+    Fn();
+    calls++;
+    t = NN_Seconds() - t0;
+  } while (t < TIME_MIN);
+  return t / calls;
+}
+
+/* One kernel over CASES shapes: 0 if it matches on all of them */
+static int NN_TestKernel(const NN_KernelTypeDef *pKernel)
+{
+  uint64_t macs, total = 0;
+  double   t_run = 0, t_ref = 0;
+  uint32_t n, bad;
+
+  for (n = 0; n < CASES; n++)
+  {
+    memset(&S, 0, sizeof(S));
+    macs = pKernel->Draw();
+    memset(OutQ7, 0x25, sizeof(OutQ7));
+    memset(OutQ15, 0x25, sizeof(OutQ15));
+    memset(RefQ7, 0, sizeof(RefQ7));
+    memset(RefQ15, 0, sizeof(RefQ15));
+    Status = ARM_MATH_SUCCESS;
+    pKernel->Ref();
+    pKernel->Run();
+    if (Verbose != 0)
+    {
+      NN_PrintShape();
+    }
+    bad = NN_Compare(pKernel->Q15, pKernel->Tolerance);
+    if ((Status != ARM_MATH_SUCCESS) || (bad != OutLen))
+    {
+      printf("%-42s FAILED: status %d, output %u of %u: %d, reference %d\n", pKernel->Name, (int)Status,
+             (unsigned)bad, (unsigned)OutLen,
+             (bad == OutLen) ? 0 : ((pKernel->Q15 != 0U) ? OutQ15[bad] : OutQ7[bad]),
+             (bad == OutLen) ? 0 : ((pKernel->Q15 != 0U) ? RefQ15[bad] : RefQ7[bad]));
+      NN_PrintShape();
+      return 1;
+    }
+    t_run += NN_Time(pKernel->Run);
+    t_ref += NN_Time(pKernel->Ref);
+    total += macs;
+  }
+  /* One call of each shape: the rates weight the shapes by their MACs */
+  printf("%-42s %5u %10.0f %9.1f %9.1f %7.2fx  %s\n", pKernel->Name, CASES, (double)total / CASES,
+         (double)total / t_run / 1e6, (double)total / t_ref / 1e6,
+         t_ref / t_run, (pKernel->Tolerance == 0) ? "identical" : "within tolerance");
+  return 0;
+}
+
+/* Example networks ------------------------------------------------------*/
+
+static q7_t Cifar10Conv1Wt[CONV1_IM_CH * CONV1_KER_DIM * CONV1_KER_DIM * CONV1_OUT_CH] = CONV1_WT;
+static q7_t Cifar10Conv1Bias[CONV1_OUT_CH] = CONV1_BIAS;
+static q7_t Cifar10Conv2Wt[CONV2_IM_CH * CONV2_KER_DIM * CONV2_KER_DIM * CONV2_OUT_CH] = CONV2_WT;
+static q7_t Cifar10Conv2Bias[CONV2_OUT_CH] = CONV2_BIAS;
+static q7_t Cifar10Conv3Wt[CONV3_IM_CH * CONV3_KER_DIM * CONV3_KER_DIM * CONV3_OUT_CH] = CONV3_WT;
+static q7_t Cifar10Conv3Bias[CONV3_OUT_CH] = CONV3_BIAS;
+static q7_t Cifar10Ip1Wt[IP1_DIM * IP1_OUT] = IP1_WT;
+static q7_t Cifar10Ip1Bias[IP1_OUT] = IP1_BIAS;
+static const uint8_t Cifar10Image[CONV1_IM_CH * CONV1_IM_DIM * CONV1_IM_DIM] = IMG_DATA;
+static q7_t Cifar10Buffer[32 * 32 * 10 * 4];
+static q7_t Cifar10Col[2 * 5 * 5 * 32 * 2];
+
+#define CIFAR10_MACS  ((uint64_t)CONV1_OUT_DIM * CONV1_OUT_DIM * CONV1_OUT_CH * CONV1_KER_DIM * CONV1_KER_DIM * CONV1_IM_CH \
+                     + (uint64_t)CONV2_OUT_DIM * CONV2_OUT_DIM * CONV2_OUT_CH * CONV2_KER_DIM * CONV2_KER_DIM * CONV2_IM_CH \
+                     + (uint64_t)CONV3_OUT_DIM * CONV3_OUT_DIM * CONV3_OUT_CH * CONV3_KER_DIM * CONV3_KER_DIM * CONV3_IM_CH \
+                     + (uint64_t)IP1_DIM * IP1_OUT)
+
+/* arm_nnexamples_cifar10.cpp, with the kernels or with the references:
+   the scores before softmax into pOut */
+static void NN_Cifar10(uint32_t Reference, q7_t *pOut)
+{
+  static const int mean[3] = INPUT_MEAN_SHIFT;
+  static const unsigned int scale[3] = INPUT_RIGHT_SHIFT;
+  q7_t    *buf1 = Cifar10Buffer;
+  q7_t    *buf2 = buf1 + 32 * 32 * 32;
+  uint32_t i;
+
+  for (i = 0; i < 32U * 32U * 3U; i++)
+  {
+    buf2[i] = (q7_t)__SSAT((((int)Cifar10Image[i] - mean[i % 3U]) * 128 + (1 << (scale[i % 3U] - 1U)))
+                           >> scale[i % 3U], 8);
+  }
+  if (Reference == 0U)
+  {
+    arm_convolve_HWC_q7_RGB(buf2, CONV1_IM_DIM, CONV1_IM_CH, Cifar10Conv1Wt, CONV1_OUT_CH, CONV1_KER_DIM,
+                            CONV1_PADDING, CONV1_STRIDE, Cifar10Conv1Bias, CONV1_BIAS_LSHIFT, CONV1_OUT_RSHIFT,
+                            buf1, CONV1_OUT_DIM, (q15_t *)Cifar10Col, NULL);
+    arm_relu_q7(buf1, CONV1_OUT_DIM * CONV1_OUT_DIM * CONV1_OUT_CH);
+    arm_maxpool_q7_HWC(buf1, CONV1_OUT_DIM, CONV1_OUT_CH, POOL1_KER_DIM, POOL1_PADDING, POOL1_STRIDE,
+                       POOL1_OUT_DIM, NULL, buf2);
+    arm_convolve_HWC_q7_fast(buf2, CONV2_IM_DIM, CONV2_IM_CH, Cifar10Conv2Wt, CONV2_OUT_CH, CONV2_KER_DIM,
+                             CONV2_PADDING, CONV2_STRIDE, Cifar10Conv2Bias, CONV2_BIAS_LSHIFT, CONV2_OUT_RSHIFT,
+                             buf1, CONV2_OUT_DIM, (q15_t *)Cifar10Col, NULL);
+    arm_relu_q7(buf1, CONV2_OUT_DIM * CONV2_OUT_DIM * CONV2_OUT_CH);
+    arm_maxpool_q7_HWC(buf1, CONV2_OUT_DIM, CONV2_OUT_CH, POOL2_KER_DIM, POOL2_PADDING, POOL2_STRIDE,
+                       POOL2_OUT_DIM, Cifar10Col, buf2);
+    arm_convolve_HWC_q7_fast(buf2, CONV3_IM_DIM, CONV3_IM_CH, Cifar10Conv3Wt, CONV3_OUT_CH, CONV3_KER_DIM,
+                             CONV3_PADDING, CONV3_STRIDE, Cifar10Conv3Bias, CONV3_BIAS_LSHIFT, CONV3_OUT_RSHIFT,
+                             buf1, CONV3_OUT_DIM, (q15_t *)Cifar10Col, NULL);
+    arm_relu_q7(buf1, CONV3_OUT_DIM * CONV3_OUT_DIM * CONV3_OUT_CH);
+    arm_maxpool_q7_HWC(buf1, CONV3_OUT_DIM, CONV3_OUT_CH, POOL3_KER_DIM, POOL3_PADDING, POOL3_STRIDE,
+                       POOL3_OUT_DIM, Cifar10Col, buf2);
+    arm_fully_connected_q7_opt(buf2, Cifar10Ip1Wt, IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT, IP1_OUT_RSHIFT,
+                               Cifar10Ip1Bias, pOut, (q15_t *)buf1);
+  }
+  else
+  {
+    arm_convolve_HWC_q7_ref(buf2, CONV1_IM_DIM, CONV1_IM_CH, Cifar10Conv1Wt, CONV1_OUT_CH, CONV1_KER_DIM,
+                            CONV1_PADDING, CONV1_STRIDE, Cifar10Conv1Bias, CONV1_BIAS_LSHIFT, CONV1_OUT_RSHIFT,
+                            buf1, CONV1_OUT_DIM, (q15_t *)Cifar10Col, NULL);
+    arm_relu_q7_ref(buf1, CONV1_OUT_DIM * CONV1_OUT_DIM * CONV1_OUT_CH);
+    arm_maxpool_q7_HWC_ref(buf1, CONV1_OUT_DIM, CONV1_OUT_CH, POOL1_KER_DIM, POOL1_PADDING, POOL1_STRIDE,
+                           POOL1_OUT_DIM, NULL, buf2);
+    arm_convolve_HWC_q7_ref(buf2, CONV2_IM_DIM, CONV2_IM_CH, Cifar10Conv2Wt, CONV2_OUT_CH, CONV2_KER_DIM,
+                            CONV2_PADDING, CONV2_STRIDE, Cifar10Conv2Bias, CONV2_BIAS_LSHIFT, CONV2_OUT_RSHIFT,
+                            buf1, CONV2_OUT_DIM, (q15_t *)Cifar10Col, NULL);
+    arm_relu_q7_ref(buf1, CONV2_OUT_DIM * CONV2_OUT_DIM * CONV2_OUT_CH);
+    arm_maxpool_q7_HWC_ref(buf1, CONV2_OUT_DIM, CONV2_OUT_CH, POOL2_KER_DIM, POOL2_PADDING, POOL2_STRIDE,
+                           POOL2_OUT_DIM, NULL, buf2);
+    arm_convolve_HWC_q7_ref(buf2, CONV3_IM_DIM, CONV3_IM_CH, Cifar10Conv3Wt, CONV3_OUT_CH, CONV3_KER_DIM,
+                            CONV3_PADDING, CONV3_STRIDE, Cifar10Conv3Bias, CONV3_BIAS_LSHIFT, CONV3_OUT_RSHIFT,
+                            buf1, CONV3_OUT_DIM, (q15_t *)Cifar10Col, NULL);
+    arm_relu_q7_ref(buf1, CONV3_OUT_DIM * CONV3_OUT_DIM * CONV3_OUT_CH);
+    arm_maxpool_q7_HWC_ref(buf1, CONV3_OUT_DIM, CONV3_OUT_CH, POOL3_KER_DIM, POOL3_PADDING, POOL3_STRIDE,
+                           POOL3_OUT_DIM, NULL, buf2);
+    arm_fully_connected_q7_opt_ref(buf2, Cifar10Ip1Wt, IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT, IP1_OUT_RSHIFT,
+                                   Cifar10Ip1Bias, pOut, (q15_t *)buf1);
+  }
+}
+
+#define GRU_HISTORY   32
+#define GRU_INPUT     32
+
+static q7_t  GruUpdateX2[2 * GRU_HISTORY * GRU_HISTORY] = UPDATE_GATE_WEIGHT_X2;
+static q7_t  GruResetX2[2 * GRU_HISTORY * GRU_HISTORY] = RESET_GATE_WEIGHT_X2;
+static q7_t  GruHiddenX2[2 * GRU_HISTORY * GRU_HISTORY] = HIDDEN_STATE_WEIGHT_X2;
+static q7_t  GruUpdateX4[2 * GRU_HISTORY * GRU_HISTORY] = UPDATE_GATE_WEIGHT_X4;
+static q7_t  GruResetX4[2 * GRU_HISTORY * GRU_HISTORY] = RESET_GATE_WEIGHT_X4;
+static q7_t  GruHiddenX4[2 * GRU_HISTORY * GRU_HISTORY] = HIDDEN_STATE_WEIGHT_X4;
+static q7_t  GruUpdateBias[GRU_HISTORY] = UPDATE_GATE_BIAS;
+static q7_t  GruResetBias[GRU_HISTORY] = RESET_GATE_BIAS;
+static q7_t  GruHiddenBias[GRU_HISTORY] = HIDDEN_STATE_BIAS;
+static const q15_t GruInput1[GRU_INPUT] = INPUT_DATA1;
+static const q15_t GruInput2[GRU_INPUT] = INPUT_DATA2;
+static const q15_t GruHistory[GRU_HISTORY] = HISTORY_DATA;
+
+#define GRU_MACS      (2U * 3U * (GRU_INPUT + GRU_HISTORY) * GRU_HISTORY)
+
+/* gru_example() of arm_nnexamples_gru.cpp: the x4 weights and the _opt
+   kernel, or the x2 (row-major) ones and the reference */
+static void NN_GruStep(q15_t *pScratch, uint32_t Reference)
+{
+  q15_t *reset = pScratch;
+  q15_t *input = pScratch + GRU_HISTORY;
+  q15_t *history = pScratch + GRU_HISTORY + GRU_INPUT;
+  q15_t *update = pScratch + 2 * GRU_HISTORY + GRU_INPUT;
+  q15_t *hidden = pScratch + 3 * GRU_HISTORY + GRU_INPUT;
+
+  if (Reference == 0U)
+  {
+    arm_fully_connected_mat_q7_vec_q15_opt(input, GruResetX4, GRU_INPUT + GRU_HISTORY, GRU_HISTORY, 0, 15,
+                                           GruResetBias, reset, NULL);
+  }
+  else
+  {
+    arm_fully_connected_mat_q7_vec_q15_ref(input, GruResetX2, GRU_INPUT + GRU_HISTORY, GRU_HISTORY, 0, 15,
+                                           GruResetBias, reset, NULL);
+  }
+  arm_nn_activations_direct_q15(reset, GRU_HISTORY, 0, ARM_SIGMOID);
+  arm_mult_q15(history, reset, reset, GRU_HISTORY);
+
+  if (Reference == 0U)
+  {
+    arm_fully_connected_mat_q7_vec_q15_opt(input, GruUpdateX4, GRU_INPUT + GRU_HISTORY, GRU_HISTORY, 0, 15,
+                                           GruUpdateBias, update, NULL);
+  }
+  else
+  {
+    arm_fully_connected_mat_q7_vec_q15_ref(input, GruUpdateX2, GRU_INPUT + GRU_HISTORY, GRU_HISTORY, 0, 15,
+                                           GruUpdateBias, update, NULL);
+  }
+  arm_nn_activations_direct_q15(update, GRU_HISTORY, 0, ARM_SIGMOID);
+
+  if (Reference == 0U)
+  {
+    arm_fully_connected_mat_q7_vec_q15_opt(reset, GruHiddenX4, GRU_INPUT + GRU_HISTORY, GRU_HISTORY, 0, 15,
+                                           GruHiddenBias, hidden, NULL);
+  }
+  else
+  {
+    arm_fully_connected_mat_q7_vec_q15_ref(reset, GruHiddenX2, GRU_INPUT + GRU_HISTORY, GRU_HISTORY, 0, 15,
+                                           GruHiddenBias, hidden, NULL);
+  }
+  arm_nn_activations_direct_q15(hidden, GRU_HISTORY, 0, ARM_TANH);
+  arm_mult_q15(update, hidden, hidden, GRU_HISTORY);
+
+  arm_offset_q15(update, (q15_t)0x8000, update, GRU_HISTORY);
+  arm_mult_q15(history, update, update, GRU_HISTORY);
+  arm_sub_q15(hidden, update, history, GRU_HISTORY);
+}
+
+/* The two steps of the example from HISTORY_DATA; the history out */
+static void NN_Gru(uint32_t Reference, q15_t *pHistory)
+{
+  q15_t scratch[GRU_HISTORY * 4 + GRU_INPUT];
+
+  memcpy(&scratch[GRU_HISTORY], GruInput1, sizeof(GruInput1));
+  memcpy(&scratch[GRU_HISTORY + GRU_INPUT], GruHistory, sizeof(GruHistory));
+  NN_GruStep(scratch, Reference);
+  memcpy(&scratch[GRU_HISTORY], GruInput2, sizeof(GruInput2));
+  NN_GruStep(scratch, Reference);
+  memcpy(pHistory, &scratch[GRU_HISTORY + GRU_INPUT], sizeof(GruHistory));
+}
+
+static void NN_Cifar10Run(void)
+{
+  NN_Cifar10(0U, OutQ7);
+}
+
+static void NN_Cifar10Ref(void)
+{
+  NN_Cifar10(1U, RefQ7);
+}
+
+static void NN_GruRun(void)
+{
+  NN_Gru(0U, OutQ15);
+}
+
+static void NN_GruRef(void)
+{
+  NN_Gru(1U, RefQ15);
+}
+
+/* A network through the kernels and the references: 0 if identical */
+static int NN_TestNetwork(const char *pName, uint32_t Q15, uint32_t Outputs, uint64_t Macs,
+                          void (*Run)(void), void (*Ref)(void))
+{
+  double   t_run, t_ref;
+  uint32_t bad, i;
+
+  memset(OutQ7, 0x25, sizeof(OutQ7));
+  memset(OutQ15, 0x25, sizeof(OutQ15));
+  memset(RefQ7, 0, sizeof(RefQ7));
+  memset(RefQ15, 0, sizeof(RefQ15));
+  OutLen = Outputs;
+  Run();
+  Ref();
+  bad = NN_Compare(Q15, 0);
+  t_run = NN_Time(Run);
+  t_ref = NN_Time(Ref);
+  printf("%-10s %8.3f MMAC %9.1f us %9.1f us %7.2fx  %s\n", pName, Macs / 1e6, t_run * 1e6, t_ref * 1e6,
+         t_ref / t_run, (bad == OutLen) ? "identical" : "MISMATCH");
+  if (Verbose != 0)
+  {
+    printf("   ");
+    for (i = 0; i < Outputs; i++)
+    {
+      printf(" %d", (Q15 != 0U) ? OutQ15[i] : OutQ7[i]);
+    }
+    printf("\n");
+  }
+  return bad != OutLen;
+}
+
+int main(int argc, char **argv)
+{
+  int      failed = 0, i;
+  uint32_t k, best = 0;
+  q7_t     scores[IP1_OUT];
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-v") == 0)
+    {
+      Verbose = 1;
+    }
+    else
+    {
+      Seed = (uint32_t)strtoul(argv[i], NULL, 0);
+    }
+  }
+
+  printf("%-42s %5s %10s %9s %9s %8s  %s\n", "kernel", "shapes", "MAC/call", "MMAC/s", "ref", "speedup", "result");
+  for (k = 0; k < sizeof(Kernels) / sizeof(Kernels[0]); k++)
+  {
+    failed |= NN_TestKernel(&Kernels[k]);
+  }
+
+  printf("\n%-10s %13s %12s %12s %8s  %s\n", "network", "per inference", "kernels", "references", "speedup",
+         "result");
+  failed |= NN_TestNetwork("cifar10", 0U, IP1_OUT, CIFAR10_MACS, NN_Cifar10Run, NN_Cifar10Ref);
+  arm_softmax_q7(OutQ7, IP1_OUT, scores);
+  for (k = 1; k < IP1_OUT; k++)
+  {
+    best = (scores[k] > scores[best]) ? k : best;
+  }
+  printf("cifar10: class %u, confidence %d/128\n", (unsigned)best, scores[best]);
+  failed |= NN_TestNetwork("gru", 1U, GRU_HISTORY, GRU_MACS, NN_GruRun, NN_GruRef);
+  return failed;
+}
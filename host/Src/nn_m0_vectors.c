@@ -0,0 +1,537 @@
+/**
+  ******************************************************************************
+  * @file    nn_m0_vectors.c
+  * @brief   Test vectors of the q7 convolutions and fully connected kernels of
+  *          CMSIS-NN for tools/nn_m0_check.py, which runs the Thumb-1
+  *          kernels of the Cortex-M0 (*_cm0.S) on tools/m0_model.py against
+  *          them.
+  *
+  *          The expected outputs are those of the references of
+  *          NN_Lib_Tests/nn_test/Ref_Implementations. Cases:
+  *           - random: shapes drawn within the constraints of each kernel,
+  *             output channels and rows of every remainder modulo 4,
+  *             windows partly outside the input
+  *           - edge: a kernel larger than the input, one output channel,
+  *             one column, outputs that all saturate
+  *           - mismatch: shapes the _fast, _RGB and 1x1 kernels reject with
+  *             ARM_MATH_SIZE_MISMATCH
+  *           - cifar10: conv1, conv2, conv3 and ip1 of the example network
+  *             on its image, each on the output of the references before it;
+  *             ip1 again with the 4-bit weights tools/nn_q4_pack.py makes
+  *             of its own (cmake/nn_q4.cmake)
+  *
+  *          arm_fully_connected_q7_q4() has no reference: its expected
+  *          outputs are those of the C kernel, which nn_lib_test holds to a
+  *          64-bit model.
+  *
+  *          Output, one line each, integers separated by spaces:
+  *            conv <function> <name> <status> <dim_im_in_x> <dim_im_in_y>
+  *                 <ch_im_in> <ch_im_out> <dim_kernel_x> <dim_kernel_y>
+  *                 <padding_x> <padding_y> <stride_x> <stride_y>
+  *                 <bias_shift> <out_shift> <dim_im_out_x> <dim_im_out_y>
+  *            fc <function> <name> <status> <dim_vec> <num_of_rows>
+  *                 <bias_shift> <out_shift>
+  *          then "input", "weights" (in the layout of the function), "bias"
+  *          and "output" lines; status is the arm_status expected, the
+  *          output line empty unless it is ARM_MATH_SUCCESS. The weights of
+  *          arm_fully_connected_q7_q4 are its packed bytes, as q7, with
+  *          "scale" and "zero" lines after them.
+  ******************************************************************************
+  */
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+#include "ref_functions.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "arm_nnexamples_cifar10_parameter.h"
+#include "arm_nnexamples_cifar10_weights.h"
+#include "arm_nnexamples_cifar10_inputs.h"
+#include "nn_m0_vectors_ip1_wt_q4.h"
+
+#define VEC_RANDOM_SHAPES   6U
+#define VEC_INPUT_MAX       (32U * 32U * 32U)
+#define VEC_WEIGHTS_MAX     (32U * 32U * 5U * 5U)
+#define VEC_OUTPUT_MAX      (32U * 32U * 32U)
+#define VEC_BIAS_MAX        64U
+
+typedef enum
+{
+  VEC_BASIC,                  /* any shape */
+  VEC_FAST,                   /* ch_im_in % 4 == 0, ch_im_out % 2 == 0 */
+  VEC_RGB,                    /* ch_im_in == 3 */
+  VEC_1X1                     /* and 1x1, no padding, stride 1 */
+} VecKindTypeDef;
+
+typedef struct
+{
+  const char     *Function;
+  uint8_t        Square;
+  VecKindTypeDef Kind;
+} VecConvTypeDef;
+
+typedef struct
+{
+  uint16_t InX, InY, ChIn, ChOut, KerX, KerY, PadX, PadY, StrideX, StrideY;
+  uint16_t BiasShift, OutShift;
+} VecShapeTypeDef;
+
+static const VecConvTypeDef VecConvs[] =
+{
+  { "arm_convolve_HWC_q7_basic",              1U, VEC_BASIC },
+  { "arm_convolve_HWC_q7_fast",               1U, VEC_FAST  },
+  { "arm_convolve_HWC_q7_RGB",                1U, VEC_RGB   },
+  { "arm_convolve_HWC_q7_basic_nonsquare",    0U, VEC_BASIC },
+  { "arm_convolve_HWC_q7_fast_nonsquare",     0U, VEC_FAST  },
+  { "arm_convolve_1x1_HWC_q7_fast_nonsquare", 0U, VEC_1X1   },
+};
+
+static uint32_t Seed = 0x2545F491U;
+
+static q7_t  Input[VEC_INPUT_MAX], Weights[VEC_WEIGHTS_MAX], Output[VEC_OUTPUT_MAX];
+static q7_t  Interleaved[VEC_WEIGHTS_MAX], Bias[VEC_BIAS_MAX];
+static q15_t BufferA[2U * VEC_WEIGHTS_MAX];
+static uint16_t ScaleQ4[VEC_BIAS_MAX];
+static uint8_t  ZeroQ4[VEC_BIAS_MAX];
+
+/* cifar10, as in arm_nnexamples_cifar10.cpp */
+static const q7_t    Conv1Wt[CONV1_IM_CH * CONV1_KER_DIM * CONV1_KER_DIM * CONV1_OUT_CH] = CONV1_WT;
+static const q7_t    Conv1Bias[CONV1_OUT_CH] = CONV1_BIAS;
+static const q7_t    Conv2Wt[CONV2_IM_CH * CONV2_KER_DIM * CONV2_KER_DIM * CONV2_OUT_CH] = CONV2_WT;
+static const q7_t    Conv2Bias[CONV2_OUT_CH] = CONV2_BIAS;
+static const q7_t    Conv3Wt[CONV3_IM_CH * CONV3_KER_DIM * CONV3_KER_DIM * CONV3_OUT_CH] = CONV3_WT;
+static const q7_t    Conv3Bias[CONV3_OUT_CH] = CONV3_BIAS;
+static const q7_t    Ip1Wt[IP1_DIM * IP1_OUT] = IP1_WT;
+static const q7_t    Ip1Bias[IP1_OUT] = IP1_BIAS;
+static const uint8_t  Ip1WtQ4[IP1_WT_Q4_SIZE] = IP1_WT_Q4;
+static const uint16_t Ip1ScaleQ4[IP1_OUT] = IP1_WT_Q4_SCALE;
+static const uint8_t  Ip1ZeroQ4[IP1_OUT] = IP1_WT_Q4_ZERO;
+static const uint8_t Image[CONV1_IM_CH * CONV1_IM_DIM * CONV1_IM_DIM] = IMG_DATA;
+
+static uint32_t Vec_Random(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return Seed >> 8;
+}
+
+/* Uniform in [Min, Max] */
+static int32_t Vec_Range(int32_t Min, int32_t Max)
+{
+  return Min + (int32_t)(Vec_Random() % (uint32_t)(Max - Min + 1));
+}
+
+static void Vec_Fill(q7_t *pData, uint32_t Count)
+{
+  uint32_t i;
+
+  for (i = 0; i < Count; i++)
+  {
+    pData[i] = (q7_t)Vec_Range(-128, 127);
+  }
+}
+
+static void Vec_Print(const char *pName, const q7_t *pData, uint32_t Count)
+{
+  uint32_t i;
+
+  printf("%s", pName);
+  for (i = 0; i < Count; i++)
+  {
+    printf(" %d", pData[i]);
+  }
+  printf("\n");
+}
+
+/* The shift that brings sums of Count products of full-scale q7 back to
+   about 8 bits, a few saturating */
+static uint16_t Vec_OutShift(uint32_t Count)
+{
+  uint16_t shift = 8U;
+
+  while (Count > 1U)
+  {
+    Count >>= 2;
+    shift++;
+  }
+  return (uint16_t)(shift + Vec_Range(-1, 1));
+}
+
+static uint16_t Vec_OutDim(uint16_t In, uint16_t Kernel, uint16_t Pad, uint16_t Stride)
+{
+  return (uint16_t)((In + 2U * Pad - Kernel) / Stride + 1U);
+}
+
+/* One conv case on the data of Input, Weights and Bias; the reference
+   output unless Status is a mismatch */
+static void Vec_Conv(const VecConvTypeDef *pConv, const char *pName, const VecShapeTypeDef *pShape,
+                     arm_status Status)
+{
+  const VecShapeTypeDef *s = pShape;
+  uint16_t outX = Vec_OutDim(s->InX, s->KerX, s->PadX, s->StrideX);
+  uint16_t outY = Vec_OutDim(s->InY, s->KerY, s->PadY, s->StrideY);
+
+  printf("conv %s %s %d %u %u %u %u %u %u %u %u %u %u %u %u %u %u\n", pConv->Function, pName, (int)Status,
+         s->InX, s->InY, s->ChIn, s->ChOut, s->KerX, s->KerY, s->PadX, s->PadY, s->StrideX, s->StrideY,
+         s->BiasShift, s->OutShift, outX, outY);
+  Vec_Print("input", Input, (uint32_t)s->InX * s->InY * s->ChIn);
+  Vec_Print("weights", Weights, (uint32_t)s->ChIn * s->KerX * s->KerY * s->ChOut);
+  Vec_Print("bias", Bias, s->ChOut);
+  if (Status != ARM_MATH_SUCCESS)
+  {
+    Vec_Print("output", Output, 0U);
+    return;
+  }
+  arm_convolve_HWC_q7_ref_nonsquare(Input, s->InX, s->InY, s->ChIn, Weights, s->ChOut, s->KerX, s->KerY,
+                                    s->PadX, s->PadY, s->StrideX, s->StrideY, Bias, s->BiasShift,
+                                    s->OutShift, Output, outX, outY, BufferA, NULL);
+  Vec_Print("output", Output, (uint32_t)outX * outY * s->ChOut);
+}
+
+/* A random shape within the constraints of pConv, square if it is */
+static void Vec_DrawShape(const VecConvTypeDef *pConv, VecShapeTypeDef *pShape)
+{
+  VecShapeTypeDef *s = pShape;
+
+  s->InX = (uint16_t)Vec_Range(1, 12);
+  s->InY = pConv->Square ? s->InX : (uint16_t)Vec_Range(1, 12);
+  s->ChIn = (pConv->Kind == VEC_RGB) ? 3U
+          : (pConv->Kind == VEC_BASIC) ? (uint16_t)Vec_Range(1, 9) : (uint16_t)(4 * Vec_Range(1, 3));
+  s->ChOut = (pConv->Kind == VEC_BASIC || pConv->Kind == VEC_RGB) ? (uint16_t)Vec_Range(1, 11)
+           : (uint16_t)(2 * Vec_Range(1, 6));
+  if (pConv->Kind == VEC_1X1)
+  {
+    s->KerX = s->KerY = 1U;
+    s->PadX = s->PadY = 0U;
+    s->StrideX = s->StrideY = 1U;
+  }
+  else
+  {
+    s->KerX = (uint16_t)Vec_Range(1, 5);
+    s->KerY = pConv->Square ? s->KerX : (uint16_t)Vec_Range(1, 5);
+    s->PadX = (uint16_t)Vec_Range(0, (s->KerX - 1) / 2 + 1);
+    s->PadY = pConv->Square ? s->PadX : (uint16_t)Vec_Range(0, (s->KerY - 1) / 2 + 1);
+    s->StrideX = (uint16_t)Vec_Range(1, 3);
+    s->StrideY = pConv->Square ? s->StrideX : (uint16_t)Vec_Range(1, 3);
+    /* The padded input must hold the kernel */
+    if (s->InX + 2U * s->PadX < s->KerX)
+    {
+      s->InX = s->KerX;
+    }
+    if (s->InY + 2U * s->PadY < s->KerY)
+    {
+      s->InY = s->KerY;
+    }
+    if (pConv->Square)
+    {
+      s->InX = s->InY = (s->InX > s->InY) ? s->InX : s->InY;
+    }
+  }
+  s->BiasShift = (uint16_t)Vec_Range(0, 6);
+  s->OutShift = Vec_OutShift((uint32_t)s->ChIn * s->KerX * s->KerY);
+}
+
+static void Vec_ConvRandom(const VecConvTypeDef *pConv)
+{
+  VecShapeTypeDef s;
+  uint32_t        i;
+
+  for (i = 0; i < VEC_RANDOM_SHAPES; i++)
+  {
+    Vec_DrawShape(pConv, &s);
+    Vec_Fill(Input, (uint32_t)s.InX * s.InY * s.ChIn);
+    Vec_Fill(Weights, (uint32_t)s.ChIn * s.KerX * s.KerY * s.ChOut);
+    Vec_Fill(Bias, s.ChOut);
+    Vec_Conv(pConv, "random", &s, ARM_MATH_SUCCESS);
+  }
+}
+
+/* Edges of every function that takes them, and the shapes rejected */
+static void Vec_ConvEdges(const VecConvTypeDef *pConv)
+{
+  VecShapeTypeDef s;
+  uint16_t        chIn = (pConv->Kind == VEC_RGB) ? 3U : 4U;
+
+  /* Kernel over the whole input and beyond, one output channel at the
+     basic kernels; all outputs saturating */
+  s = (VecShapeTypeDef){ 2U, 2U, chIn, (pConv->Kind == VEC_FAST) ? 2U : 1U, 5U, 5U, 2U, 2U, 1U, 1U, 0U, 1U };
+  if (pConv->Kind != VEC_1X1)
+  {
+    Vec_Fill(Input, 4U * chIn);
+    Vec_Fill(Weights, 25U * chIn * s.ChOut);
+    Vec_Fill(Bias, s.ChOut);
+    Vec_Conv(pConv, "edge", &s, ARM_MATH_SUCCESS);
+  }
+  /* One column, output channels one group and a pair more */
+  s = (VecShapeTypeDef){ 1U, 7U, chIn, 6U, 1U, 3U, 0U, 1U, 1U, 2U, 7U, 10U };
+  if (pConv->Square)
+  {
+    s.InY = 1U;
+    s.KerY = 1U;
+    s.PadY = 0U;
+    s.StrideY = 1U;
+  }
+  if (pConv->Kind == VEC_1X1)
+  {
+    s.KerY = 1U;
+    s.PadY = 0U;
+    s.StrideY = 1U;
+  }
+  Vec_Fill(Input, (uint32_t)s.InY * chIn);
+  Vec_Fill(Weights, (uint32_t)s.KerY * chIn * s.ChOut);
+  Vec_Fill(Bias, s.ChOut);
+  Vec_Conv(pConv, "edge", &s, ARM_MATH_SUCCESS);
+
+  s = (VecShapeTypeDef){ 4U, 4U, 4U, 2U, 1U, 1U, 0U, 0U, 1U, 1U, 0U, 8U };
+  switch (pConv->Kind)
+  {
+    case VEC_FAST:
+      s.ChIn = 6U;
+      Vec_Conv(pConv, "mismatch", &s, ARM_MATH_SIZE_MISMATCH);
+      s.ChIn = 4U;
+      s.ChOut = 3U;
+      Vec_Conv(pConv, "mismatch", &s, ARM_MATH_SIZE_MISMATCH);
+      break;
+    case VEC_RGB:
+      Vec_Conv(pConv, "mismatch", &s, ARM_MATH_SIZE_MISMATCH);
+      break;
+    case VEC_1X1:
+      s.ChIn = 2U;
+      Vec_Conv(pConv, "mismatch", &s, ARM_MATH_SIZE_MISMATCH);
+      s.ChIn = 4U;
+      s.ChOut = 1U;
+      Vec_Conv(pConv, "mismatch", &s, ARM_MATH_SIZE_MISMATCH);
+      s.ChOut = 2U;
+      s.KerY = 3U;
+      Vec_Conv(pConv, "mismatch", &s, ARM_MATH_SIZE_MISMATCH);
+      s.KerY = 1U;
+      s.PadX = 1U;
+      Vec_Conv(pConv, "mismatch", &s, ARM_MATH_SIZE_MISMATCH);
+      s.PadX = 0U;
+      s.StrideY = 2U;
+      Vec_Conv(pConv, "mismatch", &s, ARM_MATH_SIZE_MISMATCH);
+      break;
+    default:
+      break;
+  }
+}
+
+/* Weights of arm_fully_connected_q7_opt(): per 4 rows and 4 columns, rows
+   1-2 then 3-4 of columns 1 and 3, then the same of columns 2 and 4, each
+   as row 1 column 1, row 2 column 1, row 1 column 3, row 2 column 3; the
+   columns left over 4 rows at a time, the rows left over as they are */
+static void Vec_InterleaveQ7Opt(const q7_t *pM, q7_t *pOpt, uint32_t Rows, uint32_t Cols)
+{
+  uint32_t r, c, k, half;
+
+  for (r = 0; r + 4U <= Rows; r += 4U)
+  {
+    for (c = 0; c + 4U <= Cols; c += 4U)
+    {
+      for (half = 0; half < 2U; half++)
+      {
+        for (k = 0; k < 4U; k += 2U)
+        {
+          *pOpt++ = pM[(r + k) * Cols + c + half];
+          *pOpt++ = pM[(r + k + 1U) * Cols + c + half];
+          *pOpt++ = pM[(r + k) * Cols + c + half + 2U];
+          *pOpt++ = pM[(r + k + 1U) * Cols + c + half + 2U];
+        }
+      }
+    }
+    for (; c < Cols; c++)
+    {
+      for (k = 0; k < 4U; k++)
+      {
+        *pOpt++ = pM[(r + k) * Cols + c];
+      }
+    }
+  }
+  memcpy(pOpt, &pM[r * Cols], (Rows - r) * Cols);
+}
+
+/* Both fully connected kernels on the data of Input, Weights (row after
+   row) and Bias */
+static void Vec_Fc(const char *pName, uint16_t Dim, uint16_t Rows, uint16_t BiasShift, uint16_t OutShift)
+{
+  printf("fc arm_fully_connected_q7 %s 0 %u %u %u %u\n", pName, Dim, Rows, BiasShift, OutShift);
+  Vec_Print("input", Input, Dim);
+  Vec_Print("weights", Weights, (uint32_t)Dim * Rows);
+  Vec_Print("bias", Bias, Rows);
+  arm_fully_connected_q7_ref(Input, Weights, Dim, Rows, BiasShift, OutShift, Bias, Output, NULL);
+  Vec_Print("output", Output, Rows);
+
+  Vec_InterleaveQ7Opt(Weights, Interleaved, Rows, Dim);
+  printf("fc arm_fully_connected_q7_opt %s 0 %u %u %u %u\n", pName, Dim, Rows, BiasShift, OutShift);
+  Vec_Print("input", Input, Dim);
+  Vec_Print("weights", Interleaved, (uint32_t)Dim * Rows);
+  Vec_Print("bias", Bias, Rows);
+  arm_fully_connected_q7_opt_ref(Input, Interleaved, Dim, Rows, BiasShift, OutShift, Bias, Output, NULL);
+  Vec_Print("output", Output, Rows);
+}
+
+/* For arm_fully_connected_q7_q4(): the 4-bit values of pM (row-major, one
+   a byte) two columns a byte, the first low; rows by groups of 4, the last
+   of the rows left over, interleaved byte by byte within a group */
+static void Vec_PackQ4(const q7_t *pM, uint8_t *pPacked, uint32_t Rows, uint32_t Cols)
+{
+  uint32_t bytes = (Cols + 1U) / 2U;
+  uint32_t r, p, c, hi;
+
+  for (r = 0; r < Rows; r++)
+  {
+    uint32_t first = (r & ~3U) * bytes + (r & 3U);
+    uint32_t step = (Rows - (r & ~3U) < 4U) ? Rows - (r & ~3U) : 4U;
+
+    for (p = 0; p < bytes; p++)
+    {
+      c = 2U * p;
+      hi = (c + 1U < Cols) ? (uint32_t)pM[r * Cols + c + 1U] : 0U;
+      pPacked[first + p * step] = (uint8_t)((uint32_t)pM[r * Cols + c] | (hi << 4));
+    }
+  }
+}
+
+static void Vec_PrintQ4(const char *pName, const uint8_t *pPacked, uint32_t Bytes, const uint16_t *pScale,
+                        const uint8_t *pZero, uint16_t Dim, uint16_t Rows, uint16_t BiasShift, uint16_t OutShift,
+                        const q7_t *pBias)
+{
+  uint32_t i;
+
+  printf("fc arm_fully_connected_q7_q4 %s 0 %u %u %u %u\n", pName, Dim, Rows, BiasShift, OutShift);
+  Vec_Print("input", Input, Dim);
+  Vec_Print("weights", (const q7_t *)pPacked, Bytes);
+  printf("scale");
+  for (i = 0; i < Rows; i++)
+  {
+    printf(" %u", pScale[i]);
+  }
+  printf("\nzero");
+  for (i = 0; i < Rows; i++)
+  {
+    printf(" %u", pZero[i]);
+  }
+  printf("\n");
+  Vec_Print("bias", pBias, Rows);
+  arm_fully_connected_q7_q4(Input, pPacked, pScale, pZero, Dim, Rows, BiasShift, OutShift, pBias, Output);
+  Vec_Print("output", Output, Rows);
+}
+
+/* The 4-bit kernel on Input, values 0..15 in Weights, ScaleQ4, ZeroQ4 and
+   Bias; scales up to those of a q7 range over 15 steps */
+static void Vec_FcQ4(const char *pName, uint16_t Dim, uint16_t Rows, uint16_t BiasShift, uint16_t OutShift)
+{
+  uint32_t i;
+
+  for (i = 0; i < (uint32_t)Dim * Rows; i++)
+  {
+    Weights[i] = (q7_t)Vec_Range(0, 15);
+  }
+  for (i = 0; i < Rows; i++)
+  {
+    ScaleQ4[i] = (uint16_t)Vec_Range(1, (255 << ARM_NN_Q4_SCALE_SHIFT) / 15);
+    ZeroQ4[i] = (uint8_t)Vec_Range(0, 15);
+  }
+  Vec_PackQ4(Weights, (uint8_t *)Interleaved, Rows, Dim);
+  Vec_PrintQ4(pName, (const uint8_t *)Interleaved, (uint32_t)Rows * ((Dim + 1U) / 2U), ScaleQ4, ZeroQ4, Dim,
+              Rows, BiasShift, OutShift, Bias);
+}
+
+static void Vec_FcRandom(void)
+{
+  static const uint16_t dims[] = { 1U, 3U, 4U, 6U, 17U, 64U, 131U };
+  uint32_t i;
+  uint16_t rows;
+
+  for (i = 0; i < sizeof(dims) / sizeof(dims[0]); i++)
+  {
+    rows = (uint16_t)Vec_Range(1, 13);
+    Vec_Fill(Input, dims[i]);
+    Vec_Fill(Weights, (uint32_t)dims[i] * rows);
+    Vec_Fill(Bias, rows);
+    Vec_Fc("random", dims[i], rows, (uint16_t)Vec_Range(0, 6), Vec_OutShift(dims[i]));
+    Vec_FcQ4("random", dims[i], rows, (uint16_t)Vec_Range(0, 6), Vec_OutShift(dims[i]));
+  }
+  /* Every row remainder, saturating */
+  for (rows = 4U; rows < 8U; rows++)
+  {
+    Vec_Fill(Input, 9U);
+    Vec_Fill(Weights, 9U * rows);
+    Vec_Fill(Bias, rows);
+    Vec_Fc("edge", 9U, rows, 0U, 2U);
+    Vec_FcQ4("edge", 9U, rows, 0U, 2U);
+  }
+}
+
+/* cifar10: each layer on what the references make of the image */
+static void Vec_Cifar10(void)
+{
+  static const int          mean[3] = INPUT_MEAN_SHIFT;
+  static const unsigned int scale[3] = INPUT_RIGHT_SHIFT;
+  static q7_t               activations[VEC_OUTPUT_MAX];
+  VecShapeTypeDef           s;
+  uint32_t                  i;
+
+  for (i = 0; i < 32U * 32U * 3U; i++)
+  {
+    Input[i] = (q7_t)__SSAT((((int)Image[i] - mean[i % 3U]) * 128 + (1 << (scale[i % 3U] - 1U)))
+                            >> scale[i % 3U], 8);
+  }
+  s = (VecShapeTypeDef){ CONV1_IM_DIM, CONV1_IM_DIM, CONV1_IM_CH, CONV1_OUT_CH, CONV1_KER_DIM, CONV1_KER_DIM,
+                         CONV1_PADDING, CONV1_PADDING, CONV1_STRIDE, CONV1_STRIDE,
+                         CONV1_BIAS_LSHIFT, CONV1_OUT_RSHIFT };
+  memcpy(Weights, Conv1Wt, sizeof(Conv1Wt));
+  memcpy(Bias, Conv1Bias, sizeof(Conv1Bias));
+  Vec_Conv(&VecConvs[2], "cifar10_conv1", &s, ARM_MATH_SUCCESS);
+  arm_relu_q7(Output, CONV1_OUT_DIM * CONV1_OUT_DIM * CONV1_OUT_CH);
+  arm_maxpool_q7_HWC(Output, CONV1_OUT_DIM, CONV1_OUT_CH, POOL1_KER_DIM, POOL1_PADDING, POOL1_STRIDE,
+                     POOL1_OUT_DIM, NULL, activations);
+  memcpy(Input, activations, POOL1_OUT_DIM * POOL1_OUT_DIM * CONV1_OUT_CH);
+
+  s = (VecShapeTypeDef){ CONV2_IM_DIM, CONV2_IM_DIM, CONV2_IM_CH, CONV2_OUT_CH, CONV2_KER_DIM, CONV2_KER_DIM,
+                         CONV2_PADDING, CONV2_PADDING, CONV2_STRIDE, CONV2_STRIDE,
+                         CONV2_BIAS_LSHIFT, CONV2_OUT_RSHIFT };
+  memcpy(Weights, Conv2Wt, sizeof(Conv2Wt));
+  memcpy(Bias, Conv2Bias, sizeof(Conv2Bias));
+  Vec_Conv(&VecConvs[1], "cifar10_conv2", &s, ARM_MATH_SUCCESS);
+  arm_relu_q7(Output, CONV2_OUT_DIM * CONV2_OUT_DIM * CONV2_OUT_CH);
+  arm_maxpool_q7_HWC(Output, CONV2_OUT_DIM, CONV2_OUT_CH, POOL2_KER_DIM, POOL2_PADDING, POOL2_STRIDE,
+                     POOL2_OUT_DIM, NULL, activations);
+  memcpy(Input, activations, POOL2_OUT_DIM * POOL2_OUT_DIM * CONV2_OUT_CH);
+
+  s = (VecShapeTypeDef){ CONV3_IM_DIM, CONV3_IM_DIM, CONV3_IM_CH, CONV3_OUT_CH, CONV3_KER_DIM, CONV3_KER_DIM,
+                         CONV3_PADDING, CONV3_PADDING, CONV3_STRIDE, CONV3_STRIDE,
+                         CONV3_BIAS_LSHIFT, CONV3_OUT_RSHIFT };
+  memcpy(Weights, Conv3Wt, sizeof(Conv3Wt));
+  memcpy(Bias, Conv3Bias, sizeof(Conv3Bias));
+  Vec_Conv(&VecConvs[1], "cifar10_conv3", &s, ARM_MATH_SUCCESS);
+  arm_relu_q7(Output, CONV3_OUT_DIM * CONV3_OUT_DIM * CONV3_OUT_CH);
+  arm_maxpool_q7_HWC(Output, CONV3_OUT_DIM, CONV3_OUT_CH, POOL3_KER_DIM, POOL3_PADDING, POOL3_STRIDE,
+                     POOL3_OUT_DIM, NULL, activations);
+  memcpy(Input, activations, IP1_DIM);
+
+  /* The example's weights are in the layout of arm_fully_connected_q7_opt() */
+  printf("fc arm_fully_connected_q7_opt cifar10_ip1 0 %u %u %u %u\n", IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT,
+         IP1_OUT_RSHIFT);
+  Vec_Print("input", Input, IP1_DIM);
+  Vec_Print("weights", Ip1Wt, IP1_DIM * IP1_OUT);
+  Vec_Print("bias", Ip1Bias, IP1_OUT);
+  arm_fully_connected_q7_opt_ref(Input, Ip1Wt, IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT, IP1_OUT_RSHIFT, Ip1Bias,
+                                 Output, NULL);
+  Vec_Print("output", Output, IP1_OUT);
+  Vec_PrintQ4("cifar10_ip1", Ip1WtQ4, sizeof(Ip1WtQ4), Ip1ScaleQ4, Ip1ZeroQ4, IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT,
+              IP1_OUT_RSHIFT, Ip1Bias);
+}
+
+int main(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < sizeof(VecConvs) / sizeof(VecConvs[0]); i++)
+  {
+    Vec_ConvRandom(&VecConvs[i]);
+    Vec_ConvEdges(&VecConvs[i]);
+  }
+  Vec_FcRandom();
+  Vec_Cifar10();
+  return 0;
+}
@@ -0,0 +1,153 @@
+/**
+  ******************************************************************************
+  * @file    nn_plan_test.c
+  * @brief   The cifar10 example network in the one arena planned by
+  *          tools/nn_plan.py (cmake/nn_cifar10.json), against the same
+  *          network with a buffer per tensor and per scratch.
+  *
+  *          Usage: nn_plan_test
+  *          Prints the arena against the buffers apart and the two buffers
+  *          of arm_nnexamples_cifar10.cpp. Exits with status 1 if the scores
+  *          differ, or differ with what the arena held before.
+  *
+  ==============================================================================
+                          ##### Notes #####
+  ==============================================================================
+  *  Each layer gets its pointers from the offsets of the generated header:
+  *  a plan that overlaps tensors live at the same time shows as other
+  *  scores. The arena is filled with two patterns in turn before a run, so
+  *  that nothing read before it is written goes unnoticed. Built for the
+  *  Cortex-M0, the kernels leave bufferA and vec_buffer alone (the
+  *  ARM_MATH_DSP paths use them): the scratch sizes planned are those the
+  *  kernels document, for either build.
+  ******************************************************************************
+  */
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "arm_nnexamples_cifar10_parameter.h"
+#include "arm_nnexamples_cifar10_weights.h"
+#include "arm_nnexamples_cifar10_inputs.h"
+#include "nn_plan_test_cifar10_plan.h"
+
+/* col_buffer and scratch_buffer of arm_nnexamples_cifar10.cpp */
+#define EXAMPLE_SIZE        (2 * 5 * 5 * 32 * 2 + 32 * 32 * 10 * 4)
+
+typedef struct
+{
+  q7_t *Data;
+  q7_t *Conv1, *Conv1Scratch, *Pool1;
+  q7_t *Conv2, *Conv2Scratch, *Pool2;
+  q7_t *Conv3, *Conv3Scratch, *Pool3;
+  q7_t *Ip1, *Ip1Scratch, *Prob;
+} Cifar10BuffersTypeDef;
+
+static q7_t Conv1Wt[CONV1_IM_CH * CONV1_KER_DIM * CONV1_KER_DIM * CONV1_OUT_CH] = CONV1_WT;
+static q7_t Conv1Bias[CONV1_OUT_CH] = CONV1_BIAS;
+static q7_t Conv2Wt[CONV2_IM_CH * CONV2_KER_DIM * CONV2_KER_DIM * CONV2_OUT_CH] = CONV2_WT;
+static q7_t Conv2Bias[CONV2_OUT_CH] = CONV2_BIAS;
+static q7_t Conv3Wt[CONV3_IM_CH * CONV3_KER_DIM * CONV3_KER_DIM * CONV3_OUT_CH] = CONV3_WT;
+static q7_t Conv3Bias[CONV3_OUT_CH] = CONV3_BIAS;
+static q7_t Ip1Wt[IP1_DIM * IP1_OUT] = IP1_WT;
+static q7_t Ip1Bias[IP1_OUT] = IP1_BIAS;
+static const uint8_t Image[CONV1_IM_CH * CONV1_IM_DIM * CONV1_IM_DIM] = IMG_DATA;
+
+/* Arena, aligned as the plan assumes */
+static q7_t Arena[CIFAR10_ARENA_SIZE] __attribute__((aligned(CIFAR10_ARENA_ALIGN)));
+
+/* A buffer each */
+static q7_t Data[CIFAR10_DATA_SIZE] __attribute__((aligned(4)));
+static q7_t Conv1[CIFAR10_CONV1_SIZE] __attribute__((aligned(4)));
+static q7_t Conv1Scratch[CIFAR10_CONV1_SCRATCH_SIZE] __attribute__((aligned(4)));
+static q7_t Pool1[CIFAR10_POOL1_SIZE] __attribute__((aligned(4)));
+static q7_t Conv2[CIFAR10_CONV2_SIZE] __attribute__((aligned(4)));
+static q7_t Conv2Scratch[CIFAR10_CONV2_SCRATCH_SIZE] __attribute__((aligned(4)));
+static q7_t Pool2[CIFAR10_POOL2_SIZE] __attribute__((aligned(4)));
+static q7_t Conv3[CIFAR10_CONV3_SIZE] __attribute__((aligned(4)));
+static q7_t Conv3Scratch[CIFAR10_CONV3_SCRATCH_SIZE] __attribute__((aligned(4)));
+static q7_t Pool3[CIFAR10_POOL3_SIZE] __attribute__((aligned(4)));
+static q7_t Ip1[CIFAR10_IP1_SIZE] __attribute__((aligned(4)));
+static q7_t Ip1Scratch[CIFAR10_IP1_SCRATCH_SIZE] __attribute__((aligned(4)));
+static q7_t Prob[CIFAR10_PROB_SIZE] __attribute__((aligned(4)));
+
+static const Cifar10BuffersTypeDef Apart =
+{
+  Data, Conv1, Conv1Scratch, Pool1, Conv2, Conv2Scratch, Pool2, Conv3, Conv3Scratch, Pool3, Ip1, Ip1Scratch, Prob
+};
+
+static const Cifar10BuffersTypeDef Planned =
+{
+  Arena + CIFAR10_DATA_OFFSET,
+  Arena + CIFAR10_CONV1_OFFSET, Arena + CIFAR10_CONV1_SCRATCH_OFFSET, Arena + CIFAR10_POOL1_OFFSET,
+  Arena + CIFAR10_CONV2_OFFSET, Arena + CIFAR10_CONV2_SCRATCH_OFFSET, Arena + CIFAR10_POOL2_OFFSET,
+  Arena + CIFAR10_CONV3_OFFSET, Arena + CIFAR10_CONV3_SCRATCH_OFFSET, Arena + CIFAR10_POOL3_OFFSET,
+  Arena + CIFAR10_IP1_OFFSET, Arena + CIFAR10_IP1_SCRATCH_OFFSET, Arena + CIFAR10_PROB_OFFSET
+};
+
+/* arm_nnexamples_cifar10.cpp on the buffers of pBuf: the class scores after
+   softmax into pScores */
+static void Cifar10_Run(const Cifar10BuffersTypeDef *pBuf, q7_t *pScores)
+{
+  static const int mean[3] = INPUT_MEAN_SHIFT;
+  static const unsigned int scale[3] = INPUT_RIGHT_SHIFT;
+  uint32_t i;
+
+  for (i = 0; i < 32U * 32U * 3U; i++)
+  {
+    pBuf->Data[i] = (q7_t)__SSAT((((int)Image[i] - mean[i % 3U]) * 128 + (1 << (scale[i % 3U] - 1U)))
+                                 >> scale[i % 3U], 8);
+  }
+  arm_convolve_HWC_q7_RGB(pBuf->Data, CONV1_IM_DIM, CONV1_IM_CH, Conv1Wt, CONV1_OUT_CH, CONV1_KER_DIM,
+                          CONV1_PADDING, CONV1_STRIDE, Conv1Bias, CONV1_BIAS_LSHIFT, CONV1_OUT_RSHIFT,
+                          pBuf->Conv1, CONV1_OUT_DIM, (q15_t *)pBuf->Conv1Scratch, NULL);
+  arm_relu_q7(pBuf->Conv1, CONV1_OUT_DIM * CONV1_OUT_DIM * CONV1_OUT_CH);
+  arm_maxpool_q7_HWC(pBuf->Conv1, CONV1_OUT_DIM, CONV1_OUT_CH, POOL1_KER_DIM, POOL1_PADDING, POOL1_STRIDE,
+                     POOL1_OUT_DIM, NULL, pBuf->Pool1);
+  arm_convolve_HWC_q7_fast(pBuf->Pool1, CONV2_IM_DIM, CONV2_IM_CH, Conv2Wt, CONV2_OUT_CH, CONV2_KER_DIM,
+                           CONV2_PADDING, CONV2_STRIDE, Conv2Bias, CONV2_BIAS_LSHIFT, CONV2_OUT_RSHIFT,
+                           pBuf->Conv2, CONV2_OUT_DIM, (q15_t *)pBuf->Conv2Scratch, NULL);
+  arm_relu_q7(pBuf->Conv2, CONV2_OUT_DIM * CONV2_OUT_DIM * CONV2_OUT_CH);
+  arm_maxpool_q7_HWC(pBuf->Conv2, CONV2_OUT_DIM, CONV2_OUT_CH, POOL2_KER_DIM, POOL2_PADDING, POOL2_STRIDE,
+                     POOL2_OUT_DIM, NULL, pBuf->Pool2);
+  arm_convolve_HWC_q7_fast(pBuf->Pool2, CONV3_IM_DIM, CONV3_IM_CH, Conv3Wt, CONV3_OUT_CH, CONV3_KER_DIM,
+                           CONV3_PADDING, CONV3_STRIDE, Conv3Bias, CONV3_BIAS_LSHIFT, CONV3_OUT_RSHIFT,
+                           pBuf->Conv3, CONV3_OUT_DIM, (q15_t *)pBuf->Conv3Scratch, NULL);
+  arm_relu_q7(pBuf->Conv3, CONV3_OUT_DIM * CONV3_OUT_DIM * CONV3_OUT_CH);
+  arm_maxpool_q7_HWC(pBuf->Conv3, CONV3_OUT_DIM, CONV3_OUT_CH, POOL3_KER_DIM, POOL3_PADDING, POOL3_STRIDE,
+                     POOL3_OUT_DIM, NULL, pBuf->Pool3);
+  arm_fully_connected_q7_opt(pBuf->Pool3, Ip1Wt, IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT, IP1_OUT_RSHIFT, Ip1Bias,
+                             pBuf->Ip1, (q15_t *)pBuf->Ip1Scratch);
+  arm_softmax_q7(pBuf->Ip1, IP1_OUT, pBuf->Prob);
+  memcpy(pScores, pBuf->Prob, IP1_OUT);
+}
+
+int main(void)
+{
+  static const uint8_t patterns[2] = { 0x00, 0xA5 };
+  q7_t     expected[IP1_OUT], scores[IP1_OUT];
+  uint32_t i, k;
+  int      failed = 0;
+
+  Cifar10_Run(&Apart, expected);
+  for (k = 0; k < sizeof(patterns); k++)
+  {
+    memset(Arena, patterns[k], sizeof(Arena));
+    Cifar10_Run(&Planned, scores);
+    failed |= (memcmp(scores, expected, IP1_OUT) != 0);
+  }
+
+  printf("cifar10 activations and scratch: %u bytes in one arena, %u with a buffer each, %u in the example\n",
+         (unsigned)CIFAR10_ARENA_SIZE, (unsigned)(sizeof(Data) + sizeof(Conv1) + sizeof(Conv1Scratch)
+         + sizeof(Pool1) + sizeof(Conv2) + sizeof(Conv2Scratch) + sizeof(Pool2) + sizeof(Conv3)
+         + sizeof(Conv3Scratch) + sizeof(Pool3) + sizeof(Ip1) + sizeof(Ip1Scratch) + sizeof(Prob)),
+         (unsigned)EXAMPLE_SIZE);
+  printf("scores:");
+  for (i = 0; i < IP1_OUT; i++)
+  {
+    printf(" %d", scores[i]);
+  }
+  printf("  %s\n", (failed != 0) ? "MISMATCH" : "identical");
+  return failed;
+}
@@ -0,0 +1,203 @@
+/**
+  ******************************************************************************
+  * @file    nn_q4_test.c
+  * @brief   Fully connected layers with the 4-bit weights of
+  *          tools/nn_q4_pack.py (arm_fully_connected_q7_q4()) against the
+  *          same layers in q7: IP2 of NN_Lib_Tests (127 x 127) on random
+  *          inputs, and ip1 of the cifar10 example on its image.
+  *
+  *          Usage: nn_q4_test
+  *          Prints the weight bytes of both and the output error of the
+  *          4-bit layers. Exits with status 1 if the signal to error ratio
+  *          of IP2 falls under NN_Q4_SNR_MIN, or cifar10 finds another class.
+  *
+  ==============================================================================
+                          ##### Notes #####
+  ==============================================================================
+  *  The weights are packed at build time (cmake/nn_q4.cmake) from the very
+  *  headers the q7 layers read; bias, bias_shift and out_shift are those of
+  *  the q7 layers. IP2 holds uniform random weights, the worst case of a
+  *  16-level grid; the trained weights of ip1 lose less.
+  *
+  *  The error is measured on the outputs before saturation would hide it:
+  *  the output shift of IP2 leaves the sums of random inputs within q7.
+  *  cifar10 runs its convolutions once, in q7, and ip1 both ways on their
+  *  output; the scores after softmax are printed side by side.
+  ******************************************************************************
+  */
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fully_connected_testing_weights.h"
+#include "arm_nnexamples_cifar10_parameter.h"
+#include "arm_nnexamples_cifar10_weights.h"
+#include "arm_nnexamples_cifar10_inputs.h"
+#include "nn_q4_test_ip2_weight_q4.h"
+#include "nn_q4_test_ip1_wt_q4.h"
+
+#define IP2_DIM             127U
+#define IP2_ROWS            127U
+#define IP2_OUT_RSHIFT      10U
+#define IP2_VECTORS         64U
+#define NN_Q4_SNR_MIN       15.0       /* dB, IP2 outputs */
+#define CIFAR10_CLASS       8U         /* of the example image, in q7 */
+
+static const q7_t     Ip2Wt[IP2_DIM * IP2_ROWS] = IP2_WEIGHT;
+static const uint8_t  Ip2WtQ4[IP2_WEIGHT_Q4_SIZE] = IP2_WEIGHT_Q4;
+static const uint16_t Ip2ScaleQ4[IP2_ROWS] = IP2_WEIGHT_Q4_SCALE;
+static const uint8_t  Ip2ZeroQ4[IP2_ROWS] = IP2_WEIGHT_Q4_ZERO;
+
+static const q7_t     Conv1Wt[CONV1_IM_CH * CONV1_KER_DIM * CONV1_KER_DIM * CONV1_OUT_CH] = CONV1_WT;
+static const q7_t     Conv1Bias[CONV1_OUT_CH] = CONV1_BIAS;
+static const q7_t     Conv2Wt[CONV2_IM_CH * CONV2_KER_DIM * CONV2_KER_DIM * CONV2_OUT_CH] = CONV2_WT;
+static const q7_t     Conv2Bias[CONV2_OUT_CH] = CONV2_BIAS;
+static const q7_t     Conv3Wt[CONV3_IM_CH * CONV3_KER_DIM * CONV3_KER_DIM * CONV3_OUT_CH] = CONV3_WT;
+static const q7_t     Conv3Bias[CONV3_OUT_CH] = CONV3_BIAS;
+static const q7_t     Ip1Wt[IP1_DIM * IP1_OUT] = IP1_WT;
+static const q7_t     Ip1Bias[IP1_OUT] = IP1_BIAS;
+static const uint8_t  Ip1WtQ4[IP1_WT_Q4_SIZE] = IP1_WT_Q4;
+static const uint16_t Ip1ScaleQ4[IP1_OUT] = IP1_WT_Q4_SCALE;
+static const uint8_t  Ip1ZeroQ4[IP1_OUT] = IP1_WT_Q4_ZERO;
+static const uint8_t  Image[CONV1_IM_CH * CONV1_IM_DIM * CONV1_IM_DIM] = IMG_DATA;
+
+static q7_t Data[CONV1_IM_CH * CONV1_IM_DIM * CONV1_IM_DIM];
+static q7_t Conv1[CONV1_OUT_CH * CONV1_OUT_DIM * CONV1_OUT_DIM];
+static q7_t Pool1[CONV1_OUT_CH * POOL1_OUT_DIM * POOL1_OUT_DIM];
+static q7_t Conv2[CONV2_OUT_CH * CONV2_OUT_DIM * CONV2_OUT_DIM];
+static q7_t Pool2[CONV2_OUT_CH * POOL2_OUT_DIM * POOL2_OUT_DIM];
+static q7_t Conv3[CONV3_OUT_CH * CONV3_OUT_DIM * CONV3_OUT_DIM];
+static q7_t Pool3[CONV3_OUT_CH * POOL3_OUT_DIM * POOL3_OUT_DIM];
+static q15_t Scratch[2 * CONV2_IM_CH * CONV2_KER_DIM * CONV2_KER_DIM];
+
+static uint32_t Seed = 1U;
+
+static uint32_t Q4_Rand(void)
+{
+  Seed = Seed * 1664525U + 1013904223U;
+  return Seed >> 8;
+}
+
+/* IP2 on random inputs: the ratio of the power of the q7 outputs to that of
+   their difference with the 4-bit ones, dB */
+static double Q4_Ip2(uint32_t *pWorst)
+{
+  q7_t     in[IP2_DIM], bias[IP2_ROWS], out[IP2_ROWS], outQ4[IP2_ROWS];
+  double   signal = 0.0, error = 0.0;
+  uint32_t v, i;
+
+  *pWorst = 0U;
+  for (v = 0; v < IP2_VECTORS; v++)
+  {
+    for (i = 0; i < IP2_DIM; i++)
+    {
+      in[i] = (q7_t)(Q4_Rand() & 0xFFU);
+    }
+    for (i = 0; i < IP2_ROWS; i++)
+    {
+      bias[i] = (q7_t)(Q4_Rand() & 0xFFU);
+    }
+    arm_fully_connected_q7(in, Ip2Wt, IP2_DIM, IP2_ROWS, 0, IP2_OUT_RSHIFT, bias, out, NULL);
+    arm_fully_connected_q7_q4(in, Ip2WtQ4, Ip2ScaleQ4, Ip2ZeroQ4, IP2_DIM, IP2_ROWS, 0, IP2_OUT_RSHIFT, bias,
+                              outQ4);
+    for (i = 0; i < IP2_ROWS; i++)
+    {
+      int32_t diff = (int32_t)outQ4[i] - out[i];
+
+      signal += (double)out[i] * out[i];
+      error += (double)diff * diff;
+      if ((uint32_t)abs(diff) > *pWorst)
+      {
+        *pWorst = (uint32_t)abs(diff);
+      }
+    }
+  }
+  return 10.0 * log10(signal / ((error > 0.0) ? error : 1.0));
+}
+
+/* The cifar10 example up to pool3, the input of ip1 */
+static void Q4_Cifar10Features(void)
+{
+  static const int mean[3] = INPUT_MEAN_SHIFT;
+  static const unsigned int scale[3] = INPUT_RIGHT_SHIFT;
+  uint32_t i;
+
+  for (i = 0; i < 32U * 32U * 3U; i++)
+  {
+    Data[i] = (q7_t)__SSAT((((int)Image[i] - mean[i % 3U]) * 128 + (1 << (scale[i % 3U] - 1U)))
+                           >> scale[i % 3U], 8);
+  }
+  arm_convolve_HWC_q7_RGB(Data, CONV1_IM_DIM, CONV1_IM_CH, Conv1Wt, CONV1_OUT_CH, CONV1_KER_DIM,
+                          CONV1_PADDING, CONV1_STRIDE, Conv1Bias, CONV1_BIAS_LSHIFT, CONV1_OUT_RSHIFT,
+                          Conv1, CONV1_OUT_DIM, Scratch, NULL);
+  arm_relu_q7(Conv1, CONV1_OUT_DIM * CONV1_OUT_DIM * CONV1_OUT_CH);
+  arm_maxpool_q7_HWC(Conv1, CONV1_OUT_DIM, CONV1_OUT_CH, POOL1_KER_DIM, POOL1_PADDING, POOL1_STRIDE,
+                     POOL1_OUT_DIM, NULL, Pool1);
+  arm_convolve_HWC_q7_fast(Pool1, CONV2_IM_DIM, CONV2_IM_CH, Conv2Wt, CONV2_OUT_CH, CONV2_KER_DIM,
+                           CONV2_PADDING, CONV2_STRIDE, Conv2Bias, CONV2_BIAS_LSHIFT, CONV2_OUT_RSHIFT,
+                           Conv2, CONV2_OUT_DIM, Scratch, NULL);
+  arm_relu_q7(Conv2, CONV2_OUT_DIM * CONV2_OUT_DIM * CONV2_OUT_CH);
+  arm_maxpool_q7_HWC(Conv2, CONV2_OUT_DIM, CONV2_OUT_CH, POOL2_KER_DIM, POOL2_PADDING, POOL2_STRIDE,
+                     POOL2_OUT_DIM, NULL, Pool2);
+  arm_convolve_HWC_q7_fast(Pool2, CONV3_IM_DIM, CONV3_IM_CH, Conv3Wt, CONV3_OUT_CH, CONV3_KER_DIM,
+                           CONV3_PADDING, CONV3_STRIDE, Conv3Bias, CONV3_BIAS_LSHIFT, CONV3_OUT_RSHIFT,
+                           Conv3, CONV3_OUT_DIM, Scratch, NULL);
+  arm_relu_q7(Conv3, CONV3_OUT_DIM * CONV3_OUT_DIM * CONV3_OUT_CH);
+  arm_maxpool_q7_HWC(Conv3, CONV3_OUT_DIM, CONV3_OUT_CH, POOL3_KER_DIM, POOL3_PADDING, POOL3_STRIDE,
+                     POOL3_OUT_DIM, NULL, Pool3);
+}
+
+static uint32_t Q4_Class(const q7_t *pScores)
+{
+  uint32_t i, best = 0U;
+
+  for (i = 1U; i < IP1_OUT; i++)
+  {
+    if (pScores[i] > pScores[best])
+    {
+      best = i;
+    }
+  }
+  return best;
+}
+
+int main(void)
+{
+  q7_t     ip1[IP1_OUT], ip1Q4[IP1_OUT], prob[IP1_OUT], probQ4[IP1_OUT];
+  uint32_t worst, i, cls, clsQ4;
+  double   snr;
+  int      failed = 0;
+
+  snr = Q4_Ip2(&worst);
+  printf("IP2 %u x %u: %u bytes in q7, %u in 4 bits with scales and zeros; %u random inputs, "
+         "signal to error %.1f dB, error %u at most\n",
+         (unsigned)IP2_ROWS, (unsigned)IP2_DIM, (unsigned)sizeof(Ip2Wt),
+         (unsigned)(sizeof(Ip2WtQ4) + sizeof(Ip2ScaleQ4) + sizeof(Ip2ZeroQ4)), (unsigned)IP2_VECTORS, snr,
+         (unsigned)worst);
+  failed |= (snr < NN_Q4_SNR_MIN);
+
+  Q4_Cifar10Features();
+  arm_fully_connected_q7_opt(Pool3, Ip1Wt, IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT, IP1_OUT_RSHIFT, Ip1Bias, ip1,
+                             NULL);
+  arm_fully_connected_q7_q4(Pool3, Ip1WtQ4, Ip1ScaleQ4, Ip1ZeroQ4, IP1_DIM, IP1_OUT, IP1_BIAS_LSHIFT,
+                            IP1_OUT_RSHIFT, Ip1Bias, ip1Q4);
+  arm_softmax_q7(ip1, IP1_OUT, prob);
+  arm_softmax_q7(ip1Q4, IP1_OUT, probQ4);
+  cls = Q4_Class(prob);
+  clsQ4 = Q4_Class(probQ4);
+  printf("cifar10 ip1 %u x %u: %u bytes in q7, %u in 4 bits with scales and zeros\n",
+         (unsigned)IP1_OUT, (unsigned)IP1_DIM, (unsigned)sizeof(Ip1Wt),
+         (unsigned)(sizeof(Ip1WtQ4) + sizeof(Ip1ScaleQ4) + sizeof(Ip1ZeroQ4)));
+  printf("class  ip1 q7  4-bit  score q7  4-bit\n");
+  for (i = 0; i < IP1_OUT; i++)
+  {
+    printf("%5u %7d %6d %9d %6d\n", (unsigned)i, ip1[i], ip1Q4[i], prob[i], probQ4[i]);
+  }
+  printf("class %u in q7, %u with 4-bit ip1\n", (unsigned)cls, (unsigned)clsQ4);
+  failed |= (cls != CIFAR10_CLASS) || (clsQ4 != cls);
+
+  printf("%s\n", failed ? "FAILED" : "passed");
+  return failed;
+}
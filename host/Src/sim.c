@@ -0,0 +1,260 @@
+/**
+  ******************************************************************************
+  * @file    sim.c
+  * @brief   Virtual time base for the host builds.
+  *
+  *          Time is kept in microseconds and only moves when the code under
+  *          test spends it: every HAL_GetTick() poll costs SIM_POLL_US, and
+  *          peripheral models charge the CPU for blocking transfers with
+  *          SIM_Busy(). Events scheduled by the models (DMA completions ...)
+  *          and the 1 ms SysTick run as "interrupts" once their time is
+  *          reached, unless PRIMASK is set or an interrupt is already running,
+  *          in which case they are taken as soon as that ends.
+  ******************************************************************************
+  */
+#define _GNU_SOURCE
+#include "stm32f0xx_hal.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#define SIM_MAX_EVENTS     32U
+#define SIM_TICK_US        1000U
+#define SIM_STACK_SIZE     (1024U * 1024U)
+
+typedef struct
+{
+  uint64_t          Time;
+  SIM_EventTypeDef  Fn;
+  void             *Arg;
+} SIM_SlotTypeDef;
+
+static SIM_SlotTypeDef  Events[SIM_MAX_EVENTS];
+static uint32_t         EventCount;
+static uint64_t         Now;
+static uint64_t         NextTick = SIM_TICK_US;
+static uint64_t         SpinTime;
+static uint32_t         Tick;
+static uint32_t         PriMask;
+static uint32_t         InIsr;
+static void           (*TickHook)(void);
+
+static ucontext_t       MainContext;
+static ucontext_t       LowContext;
+static int            (*MainFn)(void);
+static int              MainResult;
+
+static void SIM_Dispatch(void);
+
+static void SIM_Trampoline(void)
+{
+  MainResult = MainFn();
+}
+
+int SIM_Main(int (*fn)(void))
+{
+  void *stack = mmap(NULL, SIM_STACK_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+
+  if (stack == MAP_FAILED)
+  {
+    perror("sim: mmap");
+    return 2;
+  }
+  MainFn = fn;
+  getcontext(&LowContext);
+  LowContext.uc_stack.ss_sp = stack;
+  LowContext.uc_stack.ss_size = SIM_STACK_SIZE;
+  LowContext.uc_link = &MainContext;
+  makecontext(&LowContext, SIM_Trampoline, 0);
+  swapcontext(&MainContext, &LowContext);
+  munmap(stack, SIM_STACK_SIZE);
+  return MainResult;
+}
+
+void SIM_Reset(void)
+{
+  EventCount = 0;
+  Now = 0;
+  NextTick = SIM_TICK_US;
+  SpinTime = 0;
+  Tick = 0;
+  PriMask = 0;
+  InIsr = 0;
+  TickHook = NULL;
+}
+
+uint64_t SIM_Now(void)
+{
+  return Now;
+}
+
+uint64_t SIM_SpinTime(void)
+{
+  return SpinTime;
+}
+
+void SIM_SetTickHook(void (*hook)(void))
+{
+  TickHook = hook;
+}
+
+void SIM_Schedule(uint64_t delay_us, SIM_EventTypeDef fn, void *arg)
+{
+  if (EventCount == SIM_MAX_EVENTS)
+  {
+    fprintf(stderr, "sim: event queue overflow\n");
+    abort();
+  }
+  Events[EventCount].Time = Now + delay_us;
+  Events[EventCount].Fn = fn;
+  Events[EventCount].Arg = arg;
+  EventCount++;
+}
+
+/* Moves time forward, taking every interrupt that falls due on the way. */
+void SIM_Advance(uint64_t us)
+{
+  uint64_t target = Now + us;
+
+  for (;;)
+  {
+    uint64_t next = NextTick;
+    uint32_t i;
+
+    for (i = 0; i < EventCount; i++)
+    {
+      if (Events[i].Time < next)
+      {
+        next = Events[i].Time;
+      }
+    }
+    if (next > target)
+    {
+      break;
+    }
+    if (next > Now)
+    {
+      Now = next;
+    }
+    if ((PriMask != 0) || (InIsr != 0))
+    {
+      /* Pending until unmasked: let the clock run to the target */
+      break;
+    }
+    SIM_Dispatch();
+  }
+  /* Interrupt handlers may have spent time past the target */
+  if (target > Now)
+  {
+    Now = target;
+  }
+}
+
+/* CPU time spent in a blocking operation. */
+void SIM_Busy(uint64_t us)
+{
+  SpinTime += us;
+  SIM_Advance(us);
+}
+
+/* Runs every due interrupt, oldest first. */
+static void SIM_Dispatch(void)
+{
+  for (;;)
+  {
+    uint32_t i, best = EventCount;
+
+    for (i = 0; i < EventCount; i++)
+    {
+      if ((Events[i].Time <= Now) && ((best == EventCount) || (Events[i].Time < Events[best].Time)))
+      {
+        best = i;
+      }
+    }
+
+    InIsr = 1;
+    if ((best == EventCount) || (NextTick <= Events[best].Time))
+    {
+      if (NextTick > Now)
+      {
+        InIsr = 0;
+        return;
+      }
+      NextTick += SIM_TICK_US;
+      HAL_IncTick();
+      if (TickHook != NULL)
+      {
+        TickHook();
+      }
+    }
+    else
+    {
+      SIM_SlotTypeDef ev = Events[best];
+      Events[best] = Events[--EventCount];
+      ev.Fn(ev.Arg);
+    }
+    InIsr = 0;
+  }
+}
+
+void HAL_IncTick(void)
+{
+  Tick++;
+}
+
+uint32_t HAL_GetTick(void)
+{
+  if (InIsr == 0)
+  {
+    /* A poll in a wait loop: charge it and let interrupts in */
+    SIM_Busy(SIM_POLL_US);
+  }
+  return Tick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+  uint32_t tickstart = HAL_GetTick();
+  uint32_t wait = Delay;
+
+  if (wait < 0xFFFFFFFFU)
+  {
+    wait++;
+  }
+  while ((HAL_GetTick() - tickstart) < wait)
+  {
+  }
+}
+
+uint32_t __get_PRIMASK(void)
+{
+  return PriMask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+  PriMask = priMask & 1U;
+  if ((PriMask == 0) && (InIsr == 0))
+  {
+    SIM_Dispatch();
+  }
+}
+
+void __disable_irq(void)
+{
+  PriMask = 1;
+}
+
+void __enable_irq(void)
+{
+  __set_PRIMASK(0);
+}
+
+/* As in the HAL: the application overrides it */
+__weak void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  (void)GPIO_Pin;
+}
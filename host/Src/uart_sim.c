@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file    uart_sim.c
+  * @brief   USART3 and transmit DMA model behind the SPECTRUM_IO_* link
+  *          layer.
+  *
+  *          Mirrors the spectrum link section of stm32f072b_discovery.c:
+  *          SPECTRUM_IO_Transmit() puts a frame on the line, 10 bit times a
+  *          byte (8N1) with no gap between bytes, and fails while another
+  *          one is on it, as HAL_UART_Transmit_DMA() does. At the stop bit
+  *          of the last byte the transmission complete interrupt runs as a
+  *          simulator event and calls SPECTRUM_IO_TxCpltCallback(). The
+  *          bytes are captured as the transmission starts: the BSP keeps
+  *          the buffer until the callback.
+  ******************************************************************************
+  */
+#include "stm32f072b_discovery_spectrum.h"
+#include "uart_sim.h"
+#include "sim.h"
+#include <string.h>
+
+static UART_SimStatsTypeDef Stats;
+static uintptr_t            Generation;
+static uint8_t              Busy;
+static FILE                *pCapture;
+
+void UART_Sim_Reset(void)
+{
+  memset(&Stats, 0, sizeof(Stats));
+  Generation++;
+  Busy = 0;
+  pCapture = NULL;
+}
+
+void UART_Sim_GetStats(UART_SimStatsTypeDef *pStats)
+{
+  *pStats = Stats;
+}
+
+void UART_Sim_SetCapture(FILE *pFile)
+{
+  pCapture = pFile;
+}
+
+static void UART_Sim_TxComplete(void *arg)
+{
+  if ((uintptr_t)arg != Generation)
+  {
+    return;
+  }
+  Busy = 0;
+  Stats.Frames++;
+  SIM_Busy(UART_SIM_ISR_US);
+  SPECTRUM_IO_TxCpltCallback();
+}
+
+uint8_t SPECTRUM_IO_Init(uint32_t BaudRate)
+{
+  if (BaudRate == 0U)
+  {
+    return 1;
+  }
+  Generation++;
+  Busy = 0;
+  Stats.BaudRate = BaudRate;
+  return 0;
+}
+
+uint8_t SPECTRUM_IO_Transmit(const uint8_t *pData, uint16_t Length)
+{
+  uint64_t time;
+
+  if ((Busy != 0U) || (Stats.BaudRate == 0U) || (Length == 0U))
+  {
+    return 1;
+  }
+  Busy = 1;
+  if (pCapture != NULL)
+  {
+    fwrite(pData, 1, Length, pCapture);
+  }
+  time = ((uint64_t)Length * 10U * 1000000U + Stats.BaudRate - 1U) / Stats.BaudRate;
+  Stats.Bytes += Length;
+  Stats.BusyTime += time;
+  SIM_Schedule(time, UART_Sim_TxComplete, (void *)Generation);
+  return 0;
+}
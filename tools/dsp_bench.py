@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+"""Per-kernel CMSIS-DSP cycle table of the dsp_bench image on the Cortex-M0 model.
+
+Runs every kernel of BenchKernels[] (dsp_bench/Src/dsp_bench.c) over its sweep
+on m0_model.M0: BENCH_Setup() then BENCH_Run(), timing the kernel function
+alone. For each point the table gives the cycles of one call, per sample
+(output sample of the filters, complex point of the FFTs) and per tap of the
+filters (one multiply-accumulate of one output, five per biquad stage), the
+flash the
+kernel reaches (code run, init function included, and the whole of every
+constant table it reads), the RAM it writes outside the harness buffers
+(instance, state, scratch) and its peak stack.
+
+A kernel that would take a HardFault on the board (unaligned access on the
+Cortex-M0, ...) is reported with the reason instead of its numbers. The
+exit status is non-zero only when the image itself cannot be run.
+"""
+
+import argparse
+import bisect
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import m0_model                     # noqa: E402
+from mem_budget import parse_map    # noqa: E402
+
+SWEEP_FIR = 0
+SWEEP_FFT = 1
+SWEEP_BIQUAD = 2
+# Multiply-accumulates per output sample and unit of the sweep parameter
+TAPS_PER_PARAM = {SWEEP_FIR: 1, SWEEP_BIQUAD: 5}
+# Harness objects and functions, left out of the footprints
+HARNESS_PREFIXES = ("Bench", "BENCH_")
+KERNEL_SIZE = 12                    # sizeof(BENCH_KernelTypeDef)
+
+
+class Point(object):
+    def __init__(self, kernel, sweep, param, block):
+        self.kernel = kernel
+        self.sweep = sweep
+        self.param = param
+        self.block = block
+        self.cycles = None
+        self.instructions = None
+        self.flash = None
+        self.ram = None
+        self.stack = None
+        self.fault = None
+
+    @property
+    def samples(self):
+        return self.block if self.block else self.param
+
+    @property
+    def taps(self):
+        return self.block * self.param * TAPS_PER_PARAM[self.sweep]
+
+
+class Footprint(object):
+    """Symbols of the image by address, to attribute what a run touched."""
+
+    def __init__(self, image, model):
+        self.model = model
+        syms = [s for s in image.symbols.values() if s.size and not s.name.startswith(HARNESS_PREFIXES)]
+        flash = sorted((s.addr, s) for s in syms if self._in(s.addr, model.flash_base, len(model.flash)))
+        self.flash_addrs = [a for a, _ in flash]
+        self.flash_syms = [s for _, s in flash]
+        self.ram_objects = [s for s in syms if s.kind == "object"
+                            and self._in(s.addr, model.ram_base, len(model.ram))]
+
+    @staticmethod
+    def _in(addr, base, size):
+        return base <= addr < base + size
+
+    def _flash_symbol(self, addr):
+        i = bisect.bisect_right(self.flash_addrs, addr) - 1
+        if i >= 0:
+            s = self.flash_syms[i]
+            if addr < s.addr + s.size:
+                return s
+        return None
+
+    def flash(self):
+        touched = {}
+        for addr in list(self.model.code_run()) + list(self.model.flash_reads):
+            s = self._flash_symbol(addr)
+            if s is not None:
+                touched[s.name] = s.size
+        return sum(touched.values())
+
+    def ram(self):
+        written = self.model.written
+        base = self.model.ram_base
+        return sum(sum(written[s.addr - base:s.addr - base + s.size]) for s in self.ram_objects)
+
+
+def read_cstring(model, addr):
+    out = bytearray()
+    while True:
+        c = model.read(addr + len(out), 1)
+        if c == b"\0":
+            return out.decode()
+        out += c
+
+
+def read_u16s(model, image, name):
+    s = image.symbol(name)
+    return list(struct.unpack("<%dH" % (s.size // 2), model.read(s.addr, s.size)))
+
+
+def kernels(model, image):
+    table = image.symbol("BenchKernels")
+    result = []
+    for i in range(table.size // KERNEL_SIZE):
+        name, entry, sweep = struct.unpack("<III", model.read(table.addr + i * KERNEL_SIZE, KERNEL_SIZE))
+        result.append((i, read_cstring(model, name), entry, sweep))
+    return result
+
+
+def run(image, model):
+    setup = image.symbol("BENCH_Setup").addr | 1
+    bench_run = image.symbol("BENCH_Run").addr | 1
+    taps = read_u16s(model, image, "BenchTaps")
+    stages = read_u16s(model, image, "BenchStages")
+    blocks = read_u16s(model, image, "BenchBlocks")
+    lengths = read_u16s(model, image, "BenchFftLengths")
+    footprint = Footprint(image, model)
+
+    points = []
+    for index, name, entry, sweep in kernels(model, image):
+        if sweep == SWEEP_FIR:
+            grid = [(t, b) for t in taps for b in blocks]
+        elif sweep == SWEEP_BIQUAD:
+            grid = [(s, b) for s in stages for b in blocks]
+        else:
+            grid = [(n, 0) for n in lengths]
+        for param, block in grid:
+            p = Point(name, sweep, param, block)
+            points.append(p)
+            model.reset_coverage()
+            try:
+                status = model.call(setup, [index, param, block])[0]
+                if status != 0:
+                    p.fault = "rejected by BENCH_Setup()"
+                    continue
+                win = model.call(bench_run, [index], window=entry)[3]
+            except m0_model.M0Fault as fault:
+                p.fault = "HardFault: %s" % fault
+                continue
+            if win.calls != 1:
+                p.fault = "%s called %d times" % (name, win.calls)
+                continue
+            p.cycles = win.cycles
+            p.instructions = win.instructions
+            p.stack = win.stack
+            p.flash = footprint.flash()
+            p.ram = footprint.ram()
+    return points
+
+
+def markdown(points, image_path, wait_states):
+    lines = [
+        "# CMSIS-DSP q15 kernels on the Cortex-M0",
+        "",
+        "`%s` on the cycle model of `tools/m0_model.py`, %d flash wait state%s."
+        % (os.path.basename(image_path), wait_states, "" if wait_states == 1 else "s"),
+        "Cycles of one call, from the first instruction of the kernel to its return; per sample: per output",
+        "sample of the filters, per complex point of the FFTs; per tap: per multiply-accumulate of one output",
+        "sample (5 per biquad stage). Flash: code run and constant tables read, init function included.",
+        "RAM: instance, state and scratch bytes written. Stack: peak below the entry.",
+        "",
+    ]
+
+    def row(cells):
+        return "| " + " | ".join(str(c) for c in cells) + " |"
+
+    for title, sweep, param in (("Filters", SWEEP_FIR, "Taps"), ("Biquad cascades", SWEEP_BIQUAD, "Stages"),
+                                ("Complex FFT", SWEEP_FFT, "Length")):
+        rows = [p for p in points if p.sweep == sweep]
+        if not rows:
+            continue
+        filters = sweep in TAPS_PER_PARAM
+        head = ["Kernel", param] + (["Block"] if filters else []) + ["Cycles", "Cycles/sample"]
+        head += (["Cycles/tap"] if filters else []) + ["Flash (B)", "RAM (B)", "Stack (B)"]
+        lines += ["## %s" % title, "", row(head), row(["---"] * len(head))]
+        for p in rows:
+            cells = [p.kernel, p.param] + ([p.block] if filters else [])
+            if p.fault:
+                cells += [p.fault] + [""] * (len(head) - len(cells) - 1)
+            else:
+                cells += [p.cycles, "%.1f" % (float(p.cycles) / p.samples)]
+                cells += ["%.1f" % (float(p.cycles) / p.taps)] if filters else []
+                cells += [p.flash, p.ram, p.stack]
+            lines.append(row(cells))
+        lines.append("")
+    return "\n".join(lines)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image", help="linked dsp_bench ELF image")
+    parser.add_argument("--map", help="its GNU ld map file, for the FLASH and RAM regions")
+    parser.add_argument("--output", help="write the markdown table here (default: stdout)")
+    parser.add_argument("--wait-states", type=int, default=0,
+                        help="flash wait states (0 up to 24 MHz, 1 above)")
+    args = parser.parse_args(argv)
+
+    regions = {}
+    if args.map:
+        regions = {r.name.upper(): (r.origin, r.length) for r in parse_map(args.map)[0]}
+    try:
+        image = m0_model.ElfImage(args.image)
+        model = m0_model.M0(image,
+                            flash=regions.get("FLASH", (m0_model.FLASH_BASE, 124 * 1024)),
+                            ram=regions.get("RAM", (m0_model.RAM_BASE, 16 * 1024)),
+                            wait_states=args.wait_states)
+        points = run(image, model)
+    except (ValueError, KeyError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+
+    text = markdown(points, args.image, args.wait_states)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+        for p in points:
+            if p.fault:
+                print("%s %d/%d: %s" % (p.kernel, p.param, p.block, p.fault))
+        print("%d points of %d kernels written to %s"
+              % (len(points), len({p.kernel for p in points}), args.output))
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
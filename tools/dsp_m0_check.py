@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+"""Checks the Thumb-1 q15 FIR and biquad kernels of the Cortex-M0 on the model.
+
+Runs arm_fir_q15() and arm_biquad_cascade_df1_q15() as assembled from
+Drivers/CMSIS/DSP/Source/FilteringFunctions/*_cm0.S ("after") on
+m0_model.M0, on every case printed by the dsp_m0_vectors host program:
+two calls in a row on the same instance, input and output at odd halfword
+addresses. Their outputs must equal those of the C kernels bit for bit, and
+those of the DSP_Lib_TestSuite cases must be within its 60 dB SNR of
+RefLibs. The same kernels of the prebuilt libarm_cortexM0l_math.a
+("before") go through the same cases.
+
+Then both are timed on white noise over a grid of tap counts (stages) for
+the cycle table: cycles per tap, one tap being one multiply-accumulate of one
+output sample (five per stage of the biquad), state copies and setup
+included. Coefficients within the 32-bit accumulator bound of the Thumb-1
+kernels (sum of |coefficient| at most 65535) and above it are timed apart.
+
+Objects and archive members are loaded as m0_model.ElfImage places them:
+    dsp_m0_check.py dsp_m0_vectors --after arm_fir_q15_cm0.o ...
+        --before "libarm_cortexM0l_math.a(arm_fir_q15.o)" ...
+The exit status is 1 on a mismatch or fault, 2 when a file cannot be used.
+"""
+
+import argparse
+import math
+import os
+import struct
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import m0_model                     # noqa: E402
+
+KERNELS = ("arm_fir_q15", "arm_biquad_cascade_df1_q15")
+SNR_THRESHOLD = 60.0                # FILTERING_SNR_THRESHOLD_q15_t
+SNR_CASES = ("suite", "lowpass")
+
+# Model RAM: instance, coefficients, state, then input and output at odd
+# halfwords (no word alignment assumed); the stack at the top
+INSTANCE = m0_model.RAM_BASE
+COEFFS = m0_model.RAM_BASE + 0x40
+STATE = m0_model.RAM_BASE + 0x400
+INPUT = m0_model.RAM_BASE + 0x1002
+OUTPUT = m0_model.RAM_BASE + 0x2002
+STATE_SIZE = 0x800
+
+TIMING_TAPS = (4, 8, 16, 32, 64)
+TIMING_STAGES = (1, 2, 4)
+TIMING_BLOCK = 64
+# Butterworth low-pass at fs / 10 for postShift = 1 (as in dsp_m0_vectors)
+LOWPASS = (1106, 0, 2211, 1106, 18727, -6763)
+
+
+class Case(object):
+    def __init__(self, kernel, name, params):
+        self.kernel = kernel        # "fir" or "biquad"
+        self.name = name
+        self.params = params        # (numTaps, blockSize), (numStages, postShift, blockSize)
+        self.coeffs = []
+        self.input = []
+        self.output = []
+        self.reference = []
+
+    @property
+    def block(self):
+        return self.params[-1]
+
+    def __str__(self):
+        return "%s %s %s" % (self.kernel, self.name, "/".join(str(p) for p in self.params))
+
+
+def read_cases(program):
+    out = subprocess.run([program], check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    cases = []
+    for line in out.splitlines():
+        words = line.split()
+        if not words:
+            continue
+        if words[0] in ("fir", "biquad"):
+            cases.append(Case(words[0], words[1], tuple(int(w) for w in words[2:])))
+        else:
+            setattr(cases[-1], words[0], [int(w) for w in words[1:]])
+    return cases
+
+
+class Kernels(object):
+    """The two kernels of a set of objects, each on its own model."""
+
+    def __init__(self, paths):
+        self.models = {}
+        for path in paths:
+            image = m0_model.ElfImage(path)
+            for name in KERNELS:
+                if name in image.symbols:
+                    self.models[name] = (m0_model.M0(image), image.symbol(name).addr | 1)
+        missing = [name for name in KERNELS if name not in self.models]
+        if missing:
+            raise KeyError("%s not in %s" % (", ".join(missing), " ".join(paths)))
+
+    def run(self, name, coeffs, instance, blocks):
+        """Calls of name over successive blocks on a fresh state; the output
+        samples and the cycles of each call"""
+        model, entry = self.models[name]
+        model.write(COEFFS, struct.pack("<%dh" % len(coeffs), *coeffs))
+        model.write(STATE, bytes(STATE_SIZE))
+        model.write(INSTANCE, instance)
+        output, cycles = [], []
+        for block in blocks:
+            model.write(INPUT, struct.pack("<%dh" % len(block), *block))
+            model.write(OUTPUT, bytes(2 * len(block)))
+            cycles.append(model.call(entry, [INSTANCE, INPUT, OUTPUT, len(block)])[1])
+            output += struct.unpack("<%dh" % len(block), model.read(OUTPUT, 2 * len(block)))
+        return output, cycles
+
+
+def fir_instance(num_taps):
+    return struct.pack("<HxxII", num_taps, STATE, COEFFS)
+
+
+def biquad_instance(num_stages, post_shift):
+    return struct.pack("<bxxxIIbxxx", num_stages, STATE, COEFFS, post_shift)
+
+
+def run_case(kernels, case):
+    blocks = [case.input[i:i + case.block] for i in range(0, len(case.input), case.block)]
+    if case.kernel == "fir":
+        return kernels.run(KERNELS[0], case.coeffs, fir_instance(case.params[0]), blocks)[0]
+    return kernels.run(KERNELS[1], case.coeffs, biquad_instance(*case.params[:2]), blocks)[0]
+
+
+def snr(reference, output):
+    signal = sum(float(r) * r for r in reference)
+    noise = sum(float(r - o) * (r - o) for r, o in zip(reference, output))
+    if noise == 0.0:
+        return float("inf")
+    if signal == 0.0:
+        return float("-inf")
+    return 10.0 * math.log10(signal / noise)
+
+
+def check(kernels, label, cases):
+    """Number of cases of kernels not matching the C kernels, or RefLibs"""
+    failures = 0
+    worst = {}
+    for case in cases:
+        try:
+            output = run_case(kernels, case)
+        except m0_model.M0Fault as fault:
+            print("%s %s: HardFault: %s" % (label, case, fault))
+            failures += 1
+            continue
+        if output != case.output:
+            first = next(i for i, (a, b) in enumerate(zip(output, case.output)) if a != b)
+            print("%s %s: sample %d is %d, not %d" % (label, case, first, output[first], case.output[first]))
+            failures += 1
+            continue
+        if case.name in SNR_CASES:
+            key = (case.kernel, case.name)
+            worst[key] = min(worst.get(key, float("inf")), snr(case.reference, output))
+    print("%s: %d of %d cases bit exact" % (label, len(cases) - failures, len(cases)))
+    for (kernel, name), value in sorted(worst.items()):
+        print("%s %s %s: SNR against RefLibs %s dB at worst" % (label, kernel, name,
+              "inf" if math.isinf(value) else "%.1f" % value))
+        if value < SNR_THRESHOLD:
+            failures += 1
+    return failures
+
+
+def bounded(count, total, seed):
+    """count random coefficients whose absolute values add up to total"""
+    values = []
+    for i in range(count):
+        seed = (seed * 1664525 + 1013904223) & 0xFFFFFFFF
+        magnitude = total // count + (total % count if i == 0 else 0)
+        values.append(-magnitude if seed & 0x80000000 else magnitude)
+    return values, seed
+
+
+def noise(count):
+    """White noise at -6 dBFS, as in dsp_bench"""
+    seed, values = 0x2545F491, []
+    for _ in range(count):
+        seed = (seed * 1664525 + 1013904223) & 0xFFFFFFFF
+        values.append((seed - (1 << 32) if seed & 0x80000000 else seed) >> 17)
+    return values
+
+
+def timing(before, after):
+    """Rows of the cycle table: (kernel, size, accumulator, cycles before,
+    cycles after, taps per call)"""
+    block = noise(TIMING_BLOCK)
+    rows = []
+    for taps in TIMING_TAPS:
+        for accumulator, total in (("32-bit", min(65535, 4096 * taps)), ("64-bit", 65536 + taps)):
+            coeffs = bounded(taps, total, taps)[0]
+            cycles = [k.run(KERNELS[0], coeffs, fir_instance(taps), [block])[1][0] for k in (before, after)]
+            rows.append((KERNELS[0], "%d taps" % taps, accumulator, cycles[0], cycles[1], TIMING_BLOCK * taps))
+    for stages in TIMING_STAGES:
+        over, seed = [], 1
+        for _ in range(stages):
+            taps, seed = bounded(5, 65536, seed)
+            over += taps[:1] + [0] + taps[1:]
+        for accumulator, coeffs in (("32-bit", list(LOWPASS) * stages), ("64-bit", over)):
+            cycles = [k.run(KERNELS[1], coeffs, biquad_instance(stages, 1), [block])[1][0] for k in (before, after)]
+            rows.append((KERNELS[1], "%d stage%s" % (stages, "" if stages == 1 else "s"), accumulator,
+                         cycles[0], cycles[1], TIMING_BLOCK * stages * 5))
+    return rows
+
+
+def markdown(rows):
+    lines = [
+        "# Thumb-1 q15 FIR and biquad kernels on the Cortex-M0",
+        "",
+        "Cycle model of `tools/m0_model.py`, 0 flash wait states, one call on %d samples of white noise."
+        % TIMING_BLOCK,
+        "Before: `libarm_cortexM0l_math.a`. After: `*_cm0.S`. Cycles per tap: per multiply-accumulate of one",
+        "output sample (5 per biquad stage), setup and state copies included.",
+        "",
+        "| Kernel | Size | Accumulator | Cycles before | Cycles after | Cycles/tap before | Cycles/tap after |",
+        "| --- | --- | --- | --- | --- | --- | --- |",
+    ]
+    for kernel, size, accumulator, cycles_before, cycles_after, taps in rows:
+        lines.append("| %s | %s | %s | %d | %d | %.1f | %.1f |" % (
+            kernel, size, accumulator, cycles_before, cycles_after,
+            float(cycles_before) / taps, float(cycles_after) / taps))
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("vectors", help="the dsp_m0_vectors program")
+    parser.add_argument("--after", nargs="+", required=True, help="objects of the Thumb-1 kernels")
+    parser.add_argument("--before", nargs="+", required=True,
+                        help="objects of the kernels they replace, as \"archive.a(member.o)\"")
+    parser.add_argument("--output", help="write the cycle table here (default: stdout)")
+    args = parser.parse_args(argv)
+
+    try:
+        before = Kernels(args.before)
+        after = Kernels(args.after)
+        cases = read_cases(args.vectors)
+    except (ValueError, KeyError, OSError, subprocess.CalledProcessError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+
+    failures = check(after, "after", cases)
+    failures += check(before, "before", cases)
+    if failures:
+        return 1
+
+    text = markdown(timing(before, after))
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+        print("cycle table written to %s" % args.output)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
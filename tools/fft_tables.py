@@ -0,0 +1,427 @@
+#!/usr/bin/env python3
+"""Size-specialised CMSIS-DSP complex FFT tables for one firmware image.
+
+arm_common_tables.c and arm_const_structs.c hold the twiddle and bit-reversal
+tables of every FFT length (16 to 4096) and type, about 1 MB of source. This
+script writes one C file with only the tables of the lengths and types an
+image declares (cmake/fft_tables.cmake), under the CMSIS names, so the image
+builds without those two files:
+
+  - arm_cfft_q15/q31/f32(): twiddleCoef_<N>[_q15|_q31], armBitRevIndexTable<N>
+    or armBitRevIndexTable_fixed_<N>, and arm_cfft_sR_<type>_len<N>
+  - with --radix, the legacy arm_cfft_radix2/radix4 q15 and q31 kernels:
+    their init functions, stepping through the twiddle table of the largest
+    length (shared with arm_cfft_*() of that length) and a bit-reversal table
+    of the same length, instead of the 4096-point ones
+  - with --rfft, arm_rfft_q15/q31() of twice each length: realCoefA/B<Q15|Q31>
+    for the largest real length instead of 8192 points, and the init
+    functions, stepping through them as the stock ones step through theirs
+  - with --sin, sinTable_q15 of arm_sin_q15() and arm_cos_q15(), the one
+    other table of arm_common_tables.c the board support code reads
+
+Every twiddle derives from one quarter wave of cosine at the largest length,
+by symmetry, and is rounded as in the CMSIS tables (q15 floor, q31 floor
+after 0.05 LSB, f32 through 9 decimals): the values equal the stock ones.
+The real FFT coefficients are rounded to nearest from the formula of
+arm_rfft_init_q15/q31.c, at the same angles, and so is the sine table.
+The arm_cfft_f32() bit-reversal tables swap in another order to the same
+permutation. The FFT outputs are bit-exact with the stock tables
+(host fft_tables_test).
+"""
+
+import argparse
+import math
+import os
+import sys
+
+TYPES = ("q15", "q31", "f32")
+# Lengths of arm_cfft_*() and of the legacy radix-2 and radix-4 kernels
+CFFT_LENGTHS = (16, 32, 64, 128, 256, 512, 1024, 2048, 4096)
+RADIX4_LENGTHS = (16, 64, 256, 1024, 4096)
+STOCK_MAX = 4096
+# Real length of the stock realCoefA/B tables
+RFFT_STOCK_MAX = 8192
+# Points of sinTable_q15 over one period (FAST_MATH_TABLE_SIZE)
+SIN_TABLE_SIZE = 512
+# Bytes of a table element
+ELEMENT_SIZE = {"q15": 2, "q31": 4, "f32": 4, "u16": 2}
+PER_LINE = {"q15": 8, "q31": 6, "f32": 4, "u16": 10}
+
+
+class Table(object):
+    def __init__(self, name, ctype, kind, values):
+        self.name = name
+        self.ctype = ctype
+        self.kind = kind
+        self.values = values
+
+    @property
+    def size(self):
+        return len(self.values) * ELEMENT_SIZE[self.kind]
+
+
+def quarter_wave(nmax):
+    """cos(2*pi*r/nmax) for r in 0..nmax/4, exactly 0 at pi/2."""
+    quarter = nmax // 4
+    return [math.cos(2.0 * math.pi * r / nmax) for r in range(quarter)] + [0.0]
+
+
+def cos_sin(wave, nmax, m, n):
+    """cos and sin of 2*pi*m/n, n dividing nmax, folded onto the quarter wave."""
+    quarter = nmax // 4
+    q, r = divmod((m % n) * (nmax // n), quarter)
+    c, s = wave[r], wave[quarter - r]
+    return ((c, s), (-s, c), (-c, -s), (s, -c))[q]
+
+
+def to_q15(x):
+    return max(min(int(math.floor(x * 32768.0)), 0x7FFF), -0x8000)
+
+
+def to_q31(x):
+    return max(min(int(math.floor(x * 2147483648.0 + 0.05)), 0x7FFFFFFF), -0x80000000)
+
+
+def c_value(kind, v):
+    if kind == "q15":
+        return "(q15_t)0x%04X" % (v & 0xFFFF)
+    if kind == "q31":
+        return "0x%08X" % (v & 0xFFFFFFFF)
+    if kind == "f32":
+        text = "%.9f" % v
+        return ("0.000000000" if float(text) == 0.0 else text) + "f"
+    return "%d" % v
+
+
+def to_fixed_round(x, bits):
+    scale = float(1 << (bits - 1))
+    return max(min(int(round(x * scale)), (1 << (bits - 1)) - 1), -(1 << (bits - 1)))
+
+
+def real_coefs(rmax, kind):
+    """realCoefA and realCoefB of real length rmax: entry 2*k and 2*k + 1 at
+    the angle of entry 2*k * (8192 / rmax) of the stock tables."""
+    bits = 16 if kind == "q15" else 32
+    a, b = [], []
+    for k in range(rmax // 2):
+        x = 2.0 * math.pi * (k * (RFFT_STOCK_MAX // rmax)) / RFFT_STOCK_MAX
+        a += [to_fixed_round(0.5 * (1.0 - math.sin(x)), bits), to_fixed_round(0.5 * (-math.cos(x)), bits)]
+        b += [to_fixed_round(0.5 * (1.0 + math.sin(x)), bits), to_fixed_round(0.5 * math.cos(x), bits)]
+    return a, b
+
+
+def sin_table():
+    """sinTable_q15: one period and its first point again."""
+    return [to_fixed_round(math.sin(2.0 * math.pi * i / SIN_TABLE_SIZE), 16) for i in range(SIN_TABLE_SIZE + 1)]
+
+
+def twiddles(wave, nmax, n, kind):
+    """Interleaved cos, sin of the CMSIS twiddle table of length n."""
+    count = n if kind == "f32" else 3 * n // 4
+    out = []
+    for i in range(count):
+        c, s = cos_sin(wave, nmax, i, n)
+        if kind == "q15":
+            out += [to_q15(c), to_q15(s)]
+        elif kind == "q31":
+            out += [to_q31(c), to_q31(s)]
+        else:
+            out += [c, s]
+    return out
+
+
+def bitrev(i, bits):
+    return int(format(i, "0%db" % bits)[::-1], 2) if bits else 0
+
+
+def bitrev_fixed(n):
+    """armBitRevIndexTable_fixed_<n>: pairs i < bitrev(i), byte offsets of q31 pairs."""
+    bits = n.bit_length() - 1
+    out = []
+    for i in range(n):
+        j = bitrev(i, bits)
+        if i < j:
+            out += [i * 8, j * 8]
+    return out
+
+
+def digit_reversal(n):
+    """Input index at each output position of arm_cfft_f32(): a radix-2 or 4
+    first stage by log2(n) mod 3, then radix-8 stages."""
+    first = (1, 2, 4)[(n.bit_length() - 1) % 3]
+
+    def position(x, length, radix):
+        if length == 1:
+            return 0
+        radix = radix if radix != 1 else 8
+        sub = length // radix
+        return (x % radix) * sub + position(x // radix, sub, 1)
+
+    order = [0] * n
+    for x in range(n):
+        order[x] = position(x, n, first)
+    return order
+
+
+def bitrev_f32(n):
+    """armBitRevIndexTable<n>: swaps, in cycle-leader order, of the digit
+    reversal of arm_cfft_f32()."""
+    order = digit_reversal(n)
+    out = []
+    for i in range(n):
+        j = order[i]
+        while j < i:
+            j = order[j]
+        if j != i:
+            out += [i * 8, j * 8]
+    return out
+
+
+def bitrev_radix(nmax):
+    """armBitRevTable of the legacy kernels for lengths up to nmax."""
+    bits = nmax.bit_length() - 1
+    return [bitrev(m + 1, bits) >> 1 for m in range(nmax // 4)]
+
+
+def twiddle_name(prefix, n, kind):
+    return "%stwiddleCoef_%d%s" % (prefix, n, "" if kind == "f32" else "_" + kind)
+
+
+def build(lengths, types, radix, rfft, sin, prefix):
+    """Tables, instances, radix and real FFT tables of the image, and the
+    stock names and sizes the same kernels would link."""
+    nmax = max(lengths)
+    wave = quarter_wave(nmax)
+    tables = {}
+    structs = []
+    stock = {}
+
+    def add(table):
+        tables.setdefault(table.name, table)
+
+    for kind in types:
+        for n in lengths:
+            tw = Table(twiddle_name(prefix, n, kind), "float32_t" if kind == "f32" else kind + "_t",
+                       kind, twiddles(wave, nmax, n, kind))
+            if kind == "f32":
+                br = Table("%sarmBitRevIndexTable%d" % (prefix, n), "uint16_t", "u16", bitrev_f32(n))
+            else:
+                br = Table("%sarmBitRevIndexTable_fixed_%d" % (prefix, n), "uint16_t", "u16", bitrev_fixed(n))
+            add(tw)
+            add(br)
+            structs.append((kind, n, tw, br))
+            stock[twiddle_name("", n, kind)] = tw.size
+            stock[br.name[len(prefix):]] = br.size
+
+    radix_kinds = [k for k in types if k != "f32"] if radix else []
+    shared = {}
+    if radix_kinds:
+        rev = Table("%sarmBitRevTable_%d" % (prefix, nmax), "uint16_t", "u16", bitrev_radix(nmax))
+        add(rev)
+        stock["armBitRevTable"] = 2 * STOCK_MAX // 4
+        for kind in radix_kinds:
+            name = twiddle_name(prefix, nmax, kind)
+            if name not in tables:
+                add(Table(name, kind + "_t", kind, twiddles(wave, nmax, nmax, kind)))
+            shared[kind] = (tables[name], rev)
+            stock[twiddle_name("", STOCK_MAX, kind)] = 3 * STOCK_MAX // 4 * 2 * ELEMENT_SIZE[kind]
+
+    real = {}
+    for kind in ([k for k in types if k != "f32"] if rfft else []):
+        a, b = real_coefs(2 * nmax, kind)
+        suffix = kind.upper()
+        real[kind] = (Table("%srealCoefA%s" % (prefix, suffix), kind + "_t", kind, a),
+                      Table("%srealCoefB%s" % (prefix, suffix), kind + "_t", kind, b))
+        add(real[kind][0])
+        add(real[kind][1])
+        stock["realCoefA" + suffix] = stock["realCoefB" + suffix] = RFFT_STOCK_MAX * ELEMENT_SIZE[kind]
+
+    if sin:
+        add(Table("%ssinTable_q15" % prefix, "q15_t", "q15", sin_table()))
+        stock["sinTable_q15"] = (SIN_TABLE_SIZE + 1) * ELEMENT_SIZE["q15"]
+    return nmax, list(tables.values()), structs, shared, real, stock
+
+
+def emit_table(lines, table, storage):
+    lines.append("%sconst %s %s[%d] =" % (storage, table.ctype, table.name, len(table.values)))
+    lines.append("{")
+    per_line = PER_LINE[table.kind]
+    for i in range(0, len(table.values), per_line):
+        chunk = ", ".join(c_value(table.kind, v) for v in table.values[i:i + per_line])
+        lines.append("  %s%s" % (chunk, "," if i + per_line < len(table.values) else ""))
+    lines.append("};")
+    lines.append("")
+
+
+def emit_radix_init(lines, prefix, kind, radix, nmax, twiddle, rev):
+    lengths = [n for n in (CFFT_LENGTHS if radix == 2 else RADIX4_LENGTHS) if n <= nmax]
+    lines += [
+        "arm_status %sarm_cfft_radix%d_init_%s(" % (prefix, radix, kind),
+        "  arm_cfft_radix%d_instance_%s * S," % (radix, kind),
+        "  uint16_t fftLen,",
+        "  uint8_t ifftFlag,",
+        "  uint8_t bitReverseFlag)",
+        "{",
+        "  S->fftLen = fftLen;",
+        "  S->pTwiddle = (%s_t *) %s;" % (kind, twiddle.name),
+        "  S->ifftFlag = ifftFlag;",
+        "  S->bitReverseFlag = bitReverseFlag;",
+        "",
+        "  switch (S->fftLen)",
+        "  {",
+    ]
+    lines += ["  case %dU:" % n for n in lengths]
+    lines += [
+        "    S->twidCoefModifier = (uint16_t)(%dU / fftLen);" % nmax,
+        "    S->bitRevFactor = S->twidCoefModifier;",
+        "    S->pBitRevTable = (uint16_t *) &%s[S->bitRevFactor - 1U];" % rev.name,
+        "    return ARM_MATH_SUCCESS;",
+        "",
+        "  default:",
+        "    return ARM_MATH_ARGUMENT_ERROR;",
+        "  }",
+        "}",
+        "",
+    ]
+
+
+def emit_rfft_init(lines, prefix, kind, lengths, nmax, coef_a, coef_b):
+    lines += [
+        "arm_status %sarm_rfft_init_%s(" % (prefix, kind),
+        "  arm_rfft_instance_%s * S," % kind,
+        "  uint32_t fftLenReal,",
+        "  uint32_t ifftFlagR,",
+        "  uint32_t bitReverseFlag)",
+        "{",
+        "  S->fftLenReal = fftLenReal;",
+        "  S->pTwiddleAReal = (%s_t *) %s;" % (kind, coef_a.name),
+        "  S->pTwiddleBReal = (%s_t *) %s;" % (kind, coef_b.name),
+        "  S->ifftFlagR = (uint8_t) ifftFlagR;",
+        "  S->bitReverseFlagR = (uint8_t) bitReverseFlag;",
+        "",
+        "  switch (fftLenReal)",
+        "  {",
+    ]
+    for n in reversed(lengths):
+        lines += [
+            "  case %dU:" % (2 * n),
+            "    S->twidCoefRModifier = %dU;" % (nmax // n),
+            "    S->pCfft = &%sarm_cfft_sR_%s_len%d;" % (prefix, kind, n),
+            "    return ARM_MATH_SUCCESS;",
+        ]
+    lines += [
+        "",
+        "  default:",
+        "    return ARM_MATH_ARGUMENT_ERROR;",
+        "  }",
+        "}",
+        "",
+    ]
+
+
+def source(args, nmax, tables, structs, shared, real, header):
+    lines = [
+        "/* Generated by tools/fft_tables.py: do not edit.",
+        " * CMSIS-DSP complex FFT tables of lengths %s, %s%s%s%s. */"
+        % (", ".join(str(n) for n in args.lengths), ", ".join(args.types),
+           ", radix-2/4 init functions" if shared else "",
+           ", real FFT init functions" if real else "", ", sine table" if args.sin else ""),
+        "#include \"arm_math.h\"",
+        "#include \"%s\"" % (os.path.basename(header) if header else "arm_const_structs.h"),
+        "",
+    ]
+    for table in tables:
+        # The shared radix bit-reversal table is only reached through the
+        # init functions below
+        static = "static " if table.name.startswith(args.prefix + "armBitRevTable_") else ""
+        emit_table(lines, table, static)
+    for kind, n, tw, br in structs:
+        lines += [
+            "const arm_cfft_instance_%s %sarm_cfft_sR_%s_len%d = {" % (kind, args.prefix, kind, n),
+            "  %d, %s, %s, %d" % (n, tw.name, br.name, len(br.values)),
+            "};",
+            "",
+        ]
+    for kind in sorted(shared):
+        twiddle, rev = shared[kind]
+        for radix in (2, 4):
+            emit_radix_init(lines, args.prefix, kind, radix, nmax, twiddle, rev)
+    for kind in sorted(real):
+        emit_rfft_init(lines, args.prefix, kind, args.lengths, nmax, *real[kind])
+    return "\n".join(lines)
+
+
+def header_text(args, tables, structs, shared, real, guard):
+    lines = [
+        "/* Generated by tools/fft_tables.py: do not edit. */",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#include \"arm_math.h\"",
+        "",
+    ]
+    for table in tables:
+        if not table.name.startswith(args.prefix + "armBitRevTable_"):
+            lines.append("extern const %s %s[%d];" % (table.ctype, table.name, len(table.values)))
+    for kind, n, _, _ in structs:
+        lines.append("extern const arm_cfft_instance_%s %sarm_cfft_sR_%s_len%d;" % (kind, args.prefix, kind, n))
+    for kind in sorted(shared):
+        for radix in (2, 4):
+            lines.append("arm_status %sarm_cfft_radix%d_init_%s(arm_cfft_radix%d_instance_%s * S, uint16_t fftLen,"
+                         % (args.prefix, radix, kind, radix, kind))
+            lines.append("  uint8_t ifftFlag, uint8_t bitReverseFlag);")
+    for kind in sorted(real):
+        lines.append("arm_status %sarm_rfft_init_%s(arm_rfft_instance_%s * S, uint32_t fftLenReal,"
+                     % (args.prefix, kind, kind))
+        lines.append("  uint32_t ifftFlagR, uint32_t bitReverseFlag);")
+    lines += ["", "#endif /* %s */" % guard, ""]
+    return "\n".join(lines)
+
+
+def write_if_changed(path, text):
+    """Keep the timestamp, and the objects built from it, when nothing changed."""
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--lengths", type=int, nargs="+", required=True,
+                        help="FFT lengths the image uses, 16 to 4096")
+    parser.add_argument("--types", nargs="+", choices=TYPES, required=True, help="data types it uses")
+    parser.add_argument("--radix", action="store_true",
+                        help="also the legacy radix-2/radix-4 init functions (q15, q31)")
+    parser.add_argument("--rfft", action="store_true",
+                        help="also the real FFT init functions of twice each length (q15, q31)")
+    parser.add_argument("--sin", action="store_true", help="also sinTable_q15 (arm_sin_q15, arm_cos_q15)")
+    parser.add_argument("--prefix", default="",
+                        help="prefix of every symbol, to link beside the stock tables (host test)")
+    parser.add_argument("--output", required=True, help="C file to write")
+    parser.add_argument("--header", help="also declare the symbols in this header (with --prefix)")
+    args = parser.parse_args(argv)
+
+    bad = [n for n in args.lengths if n not in CFFT_LENGTHS]
+    if bad:
+        parser.error("unsupported FFT length %s: one of %s" % (bad[0], ", ".join(map(str, CFFT_LENGTHS))))
+    args.lengths = sorted(set(args.lengths))
+    args.types = [t for t in TYPES if t in args.types]
+
+    nmax, tables, structs, shared, real, stock = build(args.lengths, args.types, args.radix, args.rfft,
+                                                       args.sin, args.prefix)
+    write_if_changed(args.output, source(args, nmax, tables, structs, shared, real, args.header))
+    if args.header:
+        guard = "__%s" % os.path.basename(args.header).upper().replace(".", "_").replace("-", "_")
+        write_if_changed(args.header, header_text(args, tables, structs, shared, real, guard))
+
+    generated = sum(t.size for t in tables)
+    print("%s: %d bytes of FFT tables, %d with arm_common_tables.c (%d saved)"
+          % (os.path.basename(args.output), generated, sum(stock.values()), sum(stock.values()) - generated))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,1115 @@
+#!/usr/bin/env python3
+"""Cycle-approximate Cortex-M0 model: runs functions of a linked ELF image.
+
+Interprets the ARMv6-M Thumb instruction set on the flash and RAM of the
+image and counts cycles with the timings of the Cortex-M0 Technical Reference
+Manual (instruction set summary): 1 cycle for data processing and the
+single-cycle multiplier, 2 for loads and stores, 1+N for LDM/STM/PUSH/POP,
+4+N for POP {..., pc}, 3 for taken branches and BX/BLX, 1 for branches not
+taken, 4 for BL and the barriers. Flash wait states (0 at the 8 MHz HSI clock
+of the labs, 1 above 24 MHz) are added to every fetch that refills the
+pipeline and to every data load from flash; the prefetch buffer is assumed to
+hide them on sequential fetches.
+
+Word and halfword accesses must be aligned, stores may only go to RAM and
+only flash and RAM are mapped: anything else raises M0Fault, as the
+HardFault the board would take. There are no exceptions, peripherals or
+interrupts.
+
+Used by dsp_bench.py and dsp_m0_check.py; run directly it calls one function
+of an image (or of a relocatable object, see ElfImage):
+    m0_model.py image.elf arm_fir_q15 0x20000000 ...
+"""
+
+import argparse
+import struct
+import sys
+
+RAM_BASE = 0x20000000
+FLASH_BASE = 0x08000000
+# Return address of call(): execution stops when it gets there
+RETURN_MAGIC = 0xFFFFFFF0
+MASK = 0xFFFFFFFF
+
+STT_OBJECT = 1
+STT_FUNC = 2
+STB_LOCAL = 0
+STB_WEAK = 2
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHT_REL = 9
+SHF_WRITE = 1
+SHF_ALLOC = 2
+ET_REL = 1
+PT_LOAD = 1
+R_ARM_ABS32 = 2
+R_ARM_THM_CALL = 10
+
+
+class M0Fault(Exception):
+    """What would be a HardFault on the board."""
+
+    def __init__(self, reason, pc=None):
+        Exception.__init__(self, reason if pc is None else "%s at pc 0x%08x" % (reason, pc))
+        self.reason = reason
+        self.pc = pc
+
+
+class Symbol(object):
+    def __init__(self, name, addr, size, kind):
+        self.name = name
+        self.addr = addr
+        self.size = size
+        self.kind = kind          # "func" or "object"
+
+
+def read_elf(path):
+    """Bytes of an ELF file, or of the member of an archive named
+    "archive.a(member.o)" """
+    if path.endswith(")") and "(" in path:
+        archive, member = path[:-1].split("(", 1)
+        with open(archive, "rb") as f:
+            data = f.read()
+        if not data.startswith(b"!<arch>\n"):
+            raise ValueError("%s: not an archive" % archive)
+        names = b""
+        off = 8
+        while off + 60 <= len(data):
+            name, size = data[off:off + 16].decode().rstrip(), int(data[off + 48:off + 58])
+            body = data[off + 60:off + 60 + size]
+            if name == "//":
+                names = body
+            elif name.startswith("/") and name[1:].isdigit():
+                start = int(name[1:])
+                name = names[start:names.index(b"\n", start)].decode()
+            if name.rstrip("/") == member:
+                return body
+            off += 60 + size + (size & 1)
+        raise ValueError("%s: no member %s" % (archive, member))
+    with open(path, "rb") as f:
+        return f.read()
+
+
+class ElfImage(object):
+    """Loadable segments and symbols of a little-endian ELF32 ARM image.
+
+    A relocatable object (as assembled or compiled, or a member of an archive
+    named as in the map files: "libfoo.a(bar.o)") is placed as the linker
+    would: its executable and read-only sections in flash from FLASH_BASE,
+    the others in RAM from RAM_BASE. Only R_ARM_ABS32 and the Thumb BL
+    relocations are applied.
+
+    A list of relocatable objects is linked together: the global symbols of
+    each resolve the undefined ones of the others. With roots, the names of
+    the functions to run, only the sections they reach through relocations
+    are placed, as with --gc-sections: the CMSIS-DSP library objects keep
+    each function and table in a section of its own."""
+
+    def __init__(self, path, roots=None):
+        paths = [path] if isinstance(path, str) else list(path)
+        objects = [self._parse(p) for p in paths]
+        # (address, bytes, memory size) per loadable segment, at the run
+        # address: initialised data is where the startup code would copy it
+        self.segments = []
+        self.symbols = {}
+        if len(objects) == 1 and objects[0]["type"] != ET_REL:
+            self._load(objects[0])
+            return
+        for obj in objects:
+            if obj["type"] != ET_REL:
+                raise ValueError("%s: only relocatable objects link together" % obj["path"])
+        self._link(objects, roots)
+
+    @staticmethod
+    def _parse(path):
+        data = read_elf(path)
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s: not a little-endian ELF32 file" % path)
+        (e_type, e_machine, _, entry, e_phoff, e_shoff, _, _, e_phentsize, e_phnum,
+         e_shentsize, e_shnum, _) = struct.unpack_from("<HHIIIIIHHHHHH", data, 16)
+        if e_machine != 40:
+            raise ValueError("%s: not an ARM image" % path)
+        sections = [struct.unpack_from("<IIIIIIIIII", data, e_shoff + i * e_shentsize)
+                    for i in range(e_shnum)]
+        return {"path": path, "data": data, "type": e_type, "entry": entry, "sections": sections,
+                "phdrs": [struct.unpack_from("<IIIIIIII", data, e_phoff + i * e_phentsize)
+                          for i in range(e_phnum)],
+                "symtab": list(ElfImage._symtab(data, sections))}
+
+    def _load(self, obj):
+        """Segments and symbols of a linked image"""
+        self.entry = obj["entry"]
+        data = obj["data"]
+        for p_type, p_offset, p_vaddr, p_paddr, p_filesz, p_memsz, _, _ in obj["phdrs"]:
+            if p_type != PT_LOAD or p_memsz == 0:
+                continue
+            body = data[p_offset:p_offset + p_filesz]
+            self.segments.append((p_vaddr, body, p_memsz))
+            if p_paddr != p_vaddr and p_filesz:
+                self.segments.append((p_paddr, body, p_filesz))
+        self._add_symbols(obj, [0] * len(obj["sections"]), lambda shndx: True)
+
+    def _add_symbols(self, obj, bases, placed):
+        nsections = len(obj["sections"])
+        # Locals first: a global of the same name in another object wins
+        for local in (True, False):
+            for _, st_name, st_value, st_size, kind, bind, st_shndx in obj["symtab"]:
+                if (kind not in (STT_OBJECT, STT_FUNC) or st_shndx == 0 or not st_name or
+                        (bind == STB_LOCAL) != local or (st_shndx < nsections and not placed(st_shndx))):
+                    continue
+                value = st_value + (bases[st_shndx] if st_shndx < nsections else 0)
+                addr = value & ~1 if kind == STT_FUNC else value
+                self.symbols[st_name] = Symbol(st_name, addr, st_size, "func" if kind == STT_FUNC else "object")
+
+    @staticmethod
+    def _symtab(data, sections):
+        """(index, name, value, size, type, binding, section) of every symbol"""
+        for sh in sections:
+            if sh[1] != SHT_SYMTAB:
+                continue
+            strtab = sections[sh[6]]
+            for n, off in enumerate(range(sh[4], sh[4] + sh[5], 16)):
+                st_name, st_value, st_size, st_info, _, st_shndx = struct.unpack_from("<IIIBBH", data, off)
+                start = strtab[4] + st_name
+                name = data[start:data.index(b"\0", start)].decode()
+                yield n, name, st_value, st_size, st_info & 0xF, st_info >> 4, st_shndx
+
+    @staticmethod
+    def _relocations(obj, target):
+        """(offset, type, symbol index) of the relocations of a section"""
+        data = obj["data"]
+        for sh in obj["sections"]:
+            if sh[1] != SHT_REL or sh[7] != target:
+                continue
+            for off in range(sh[4], sh[4] + sh[5], 8):
+                r_offset, r_info = struct.unpack_from("<II", data, off)
+                yield r_offset, r_info & 0xFF, r_info >> 8
+
+    def _link(self, objects, roots):
+        # Definitions of the global symbols: (object, section, value)
+        defined = {}
+        for o, obj in enumerate(objects):
+            for _, name, value, _, _, bind, shndx in obj["symtab"]:
+                if bind == STB_LOCAL or shndx == 0 or shndx >= len(obj["sections"]) or not name:
+                    continue
+                if name in defined and bind != STB_WEAK and defined[name][3] != STB_WEAK:
+                    raise ValueError("%s: %s already defined in %s" % (obj["path"], name,
+                                                                        objects[defined[name][0]]["path"]))
+                if name not in defined or defined[name][3] == STB_WEAK:
+                    defined[name] = (o, shndx, value, bind)
+
+        def resolve(o, index):
+            _, name, value, _, _, bind, shndx = objects[o]["symtab"][index]
+            if shndx != 0:
+                return o, shndx, value
+            if name not in defined:
+                raise ValueError("%s: undefined symbol %s: link it first" % (objects[o]["path"], name))
+            return defined[name][:3]
+
+        def allocated(o, shndx):
+            sh = objects[o]["sections"][shndx]
+            return sh[2] & SHF_ALLOC and sh[5] != 0
+
+        # Sections kept: those the roots reach, or all of them
+        if roots is None:
+            kept = set((o, i) for o, obj in enumerate(objects) for i in range(len(obj["sections"]))
+                       if allocated(o, i))
+        else:
+            kept = set()
+            todo = []
+            for name in roots:
+                if name not in defined:
+                    raise KeyError("symbol %s not in the objects" % name)
+                todo.append(defined[name][:2])
+            while todo:
+                o, shndx = todo.pop()
+                if (o, shndx) in kept or not allocated(o, shndx):
+                    continue
+                kept.add((o, shndx))
+                for _, _, index in self._relocations(objects[o], shndx):
+                    todo.append(resolve(o, index)[:2])
+
+        next_addr = {True: FLASH_BASE, False: RAM_BASE}
+        bases = [[0] * len(obj["sections"]) for obj in objects]
+        bodies = {}
+        for o, obj in enumerate(objects):
+            for i, sh in enumerate(obj["sections"]):
+                if (o, i) not in kept:
+                    continue
+                sh_type, sh_flags, sh_offset, sh_size, sh_addralign = sh[1], sh[2], sh[4], sh[5], sh[8]
+                in_flash = not sh_flags & SHF_WRITE
+                align = max(sh_addralign, 1)
+                bases[o][i] = (next_addr[in_flash] + align - 1) & -align
+                next_addr[in_flash] = bases[o][i] + sh_size
+                body = bytes(sh_size) if sh_type == SHT_NOBITS else obj["data"][sh_offset:sh_offset + sh_size]
+                bodies[(o, i)] = bytearray(body)
+
+        for (o, target), body in bodies.items():
+            for r_offset, kind, index in self._relocations(objects[o], target):
+                so, shndx, value = resolve(o, index)
+                s = bases[so][shndx] + value
+                place = bases[o][target] + r_offset
+                if kind == R_ARM_ABS32:
+                    addend = struct.unpack_from("<I", body, r_offset)[0]
+                    struct.pack_into("<I", body, r_offset, (s + addend) & MASK)
+                elif kind == R_ARM_THM_CALL:
+                    offset = s - (place + 4)
+                    hi, lo = struct.unpack_from("<HH", body, r_offset)
+                    s_bit = (offset >> 24) & 1
+                    j1 = ((offset >> 23) & 1) ^ 1 ^ s_bit
+                    j2 = ((offset >> 22) & 1) ^ 1 ^ s_bit
+                    hi = (hi & 0xF800) | (s_bit << 10) | ((offset >> 12) & 0x3FF)
+                    lo = (lo & 0xD000) | (j1 << 13) | (j2 << 11) | ((offset >> 1) & 0x7FF)
+                    struct.pack_into("<HH", body, r_offset, hi, lo)
+                else:
+                    raise ValueError("%s: relocation type %d not supported: link it first"
+                                     % (objects[o]["path"], kind))
+
+        self.entry = 0
+        self.segments = [(bases[o][i], bytes(body), objects[o]["sections"][i][5])
+                         for (o, i), body in bodies.items()]
+        for o, obj in enumerate(objects):
+            self._add_symbols(obj, bases[o], lambda shndx, o=o: (o, shndx) in kept)
+
+    def symbol(self, name):
+        if name not in self.symbols:
+            raise KeyError("symbol %s not in the image" % name)
+        return self.symbols[name]
+
+
+class Window(object):
+    """Cost of the calls of one function within a run (see M0.call())."""
+
+    def __init__(self, addr):
+        self.addr = addr
+        self.calls = 0
+        self.cycles = 0
+        self.instructions = 0
+        self.stack = 0            # deepest stack use below the entry SP, bytes
+
+
+class M0(object):
+    def __init__(self, image, flash=(FLASH_BASE, 124 * 1024), ram=(RAM_BASE, 16 * 1024),
+                 wait_states=0):
+        self.image = image
+        self.flash_base, flash_len = flash
+        self.ram_base, ram_len = ram
+        self.flash = bytearray(flash_len)
+        self.ram = bytearray(ram_len)
+        self.ws = wait_states
+        for addr, body, size in image.segments:
+            for base, mem in ((self.flash_base, self.flash), (self.ram_base, self.ram)):
+                if base <= addr and addr + size <= base + len(mem):
+                    mem[addr - base:addr - base + len(body)] = body
+                    mem[addr - base + len(body):addr - base + size] = bytes(size - len(body))
+                    break
+            else:
+                raise ValueError("segment 0x%08x+%d outside flash and RAM" % (addr, size))
+
+        self.R = [0] * 16
+        self.F = [0, 0, 0, 0]     # N, Z, C, V
+        self.stall = 0            # cycles not known at decode time
+        self.sp_min = 0
+        self._code = {}
+        self.reset_coverage()
+        self._build_memory()
+
+    # ----------------------------------------------------------------- memory
+
+    def reset_coverage(self):
+        """Forget the code run, the flash read and the RAM written so far."""
+        self._code = {}
+        self.flash_reads = set()
+        if hasattr(self, "written"):
+            self.written[:] = bytes(len(self.ram))
+        else:
+            self.written = bytearray(len(self.ram))
+
+    def code_run(self):
+        """Addresses of the instructions run since reset_coverage()."""
+        return self._code.keys()
+
+    def _build_memory(self):
+        ram, flash, written = self.ram, self.flash, self.written
+        ram_base, ram_len = self.ram_base, len(self.ram)
+        flash_base, flash_len = self.flash_base, len(self.flash)
+        unpack_from, pack_into = struct.unpack_from, struct.pack_into
+        ws = self.ws
+        model = self
+
+        def flash_offset(a, n):
+            o = a - flash_base
+            if 0 <= o <= flash_len - n:
+                model.stall += ws
+                model.flash_reads.add(a)
+                return o
+            raise M0Fault("load from unmapped address 0x%08x" % a)
+
+        def ld32(a):
+            if a & 3:
+                raise M0Fault("unaligned word load from 0x%08x" % a)
+            o = a - ram_base
+            if 0 <= o <= ram_len - 4:
+                return unpack_from("<I", ram, o)[0]
+            return unpack_from("<I", flash, flash_offset(a, 4))[0]
+
+        def ld16(a):
+            if a & 1:
+                raise M0Fault("unaligned halfword load from 0x%08x" % a)
+            o = a - ram_base
+            if 0 <= o <= ram_len - 2:
+                return unpack_from("<H", ram, o)[0]
+            return unpack_from("<H", flash, flash_offset(a, 2))[0]
+
+        def ld8(a):
+            o = a - ram_base
+            if 0 <= o < ram_len:
+                return ram[o]
+            return flash[flash_offset(a, 1)]
+
+        def store_offset(a, n):
+            o = a - ram_base
+            if 0 <= o <= ram_len - n:
+                return o
+            raise M0Fault("store to 0x%08x, outside RAM" % a)
+
+        def st32(a, v):
+            if a & 3:
+                raise M0Fault("unaligned word store to 0x%08x" % a)
+            o = store_offset(a, 4)
+            pack_into("<I", ram, o, v & MASK)
+            written[o:o + 4] = b"\1\1\1\1"
+
+        def st16(a, v):
+            if a & 1:
+                raise M0Fault("unaligned halfword store to 0x%08x" % a)
+            o = store_offset(a, 2)
+            pack_into("<H", ram, o, v & 0xFFFF)
+            written[o:o + 2] = b"\1\1"
+
+        def st8(a, v):
+            o = store_offset(a, 1)
+            ram[o] = v & 0xFF
+            written[o] = 1
+
+        def fetch16(a):
+            o = a - flash_base
+            if 0 <= o <= flash_len - 2:
+                return unpack_from("<H", flash, o)[0]
+            o = a - ram_base
+            if 0 <= o <= ram_len - 2:
+                return unpack_from("<H", ram, o)[0]
+            raise M0Fault("instruction fetch from unmapped address 0x%08x" % a)
+
+        self.ld32, self.ld16, self.ld8 = ld32, ld16, ld8
+        self.st32, self.st16, self.st8 = st32, st16, st8
+        self.fetch16 = fetch16
+
+    def read(self, addr, size):
+        """Bytes of the image memory, as after the last run."""
+        for base, mem in ((self.ram_base, self.ram), (self.flash_base, self.flash)):
+            if base <= addr and addr + size <= base + len(mem):
+                return bytes(mem[addr - base:addr - base + size])
+        raise ValueError("0x%08x+%d outside flash and RAM" % (addr, size))
+
+    def write(self, addr, data):
+        """Set RAM without counting it as written by the code."""
+        o = addr - self.ram_base
+        if not (0 <= o and o + len(data) <= len(self.ram)):
+            raise ValueError("0x%08x+%d outside RAM" % (addr, len(data)))
+        self.ram[o:o + len(data)] = data
+
+    # -------------------------------------------------------------- execution
+
+    def call(self, addr, args=(), window=None, sp=None, max_cycles=500000000):
+        """Run the function at addr with args (r0-r3, then the stack) until it
+        returns; return (r0, cycles, instructions). With window, the address of
+        a function called by it, also return a Window with the cost of that
+        function's calls alone, from its first instruction to its return."""
+        R = self.R
+        if sp is None:
+            sp = self.ram_base + len(self.ram)
+        extra = list(args[4:])
+        sp = (sp - 4 * len(extra)) & ~7
+        for i, value in enumerate(extra):
+            self.st32(sp + 4 * i, value)
+        for i in range(4):
+            R[i] = (args[i] if i < len(args) else 0) & MASK
+        R[13] = sp
+        R[14] = RETURN_MAGIC | 1
+        self.sp_min = sp
+        self.stall = 0
+
+        code = self._code
+        decode = self._decode
+        pc = addr & ~1
+        cycles = 0
+        count = 0
+        win = Window(window & ~1) if window is not None else None
+        watch = win.addr if win is not None else -1
+        ret = -1
+        start_cycles = start_count = entry_sp = 0
+        while pc != RETURN_MAGIC:
+            if pc == watch and ret < 0:
+                ret = R[14] & ~1
+                entry_sp = R[13]
+                self.sp_min = entry_sp
+                start_cycles, start_count = cycles + self.stall, count
+            elif pc == ret and R[13] >= entry_sp:
+                win.calls += 1
+                win.cycles += cycles + self.stall - start_cycles
+                win.instructions += count - start_count
+                win.stack = max(win.stack, entry_sp - self.sp_min)
+                ret = -1
+            entry = code.get(pc)
+            if entry is None:
+                entry = code[pc] = decode(pc)
+            try:
+                pc = entry[0]()
+            except M0Fault as fault:
+                if fault.pc is not None:
+                    raise
+                raise M0Fault(fault.reason, pc)
+            cycles += entry[1]
+            count += 1
+            if cycles > max_cycles:
+                raise M0Fault("no return after %d cycles" % cycles, pc)
+        cycles += self.stall
+        if win is not None:
+            return R[0], cycles, count, win
+        return R[0], cycles, count
+
+    def _decode(self, pc):
+        """(function running the instruction at pc and returning the next pc,
+        cycles of the instruction)"""
+        try:
+            return self._decode_thumb(pc)
+        except M0Fault as fault:
+            if fault.pc is not None:
+                raise
+            raise M0Fault(fault.reason, pc)
+
+    def _decode_thumb(self, pc):
+        R, F = self.R, self.F
+        ld32, ld16, ld8 = self.ld32, self.ld16, self.ld8
+        st32, st16, st8 = self.st32, self.st16, self.st8
+        model = self
+        ws = self.ws
+        op = self.fetch16(pc)
+        nxt = pc + 2
+        pcv = pc + 4                      # PC as read by the instruction
+        top = op >> 11
+
+        def nz(res):
+            F[0] = res >> 31
+            F[1] = res == 0
+            return res
+
+        def add_c(a, b, carry):
+            r = a + b + carry
+            res = r & MASK
+            F[0] = res >> 31
+            F[1] = res == 0
+            F[2] = r > MASK
+            F[3] = ((a ^ res) & (b ^ res)) >> 31
+            return res
+
+        def sp_moved():
+            if R[13] < model.sp_min:
+                model.sp_min = R[13]
+
+        def interwork(target, what):
+            if not target & 1:
+                raise M0Fault("%s to ARM state (address 0x%08x)" % (what, target), pc)
+            return target & ~1
+
+        # Shift by immediate, add/subtract
+        if top <= 2:
+            imm, m, d = (op >> 6) & 31, (op >> 3) & 7, op & 7
+            if top == 0:
+                if imm == 0:
+                    def f():
+                        nz(R[m])
+                        R[d] = R[m]
+                        return nxt
+                else:
+                    def f():
+                        v = R[m]
+                        F[2] = (v >> (32 - imm)) & 1
+                        R[d] = nz((v << imm) & MASK)
+                        return nxt
+            elif top == 1:
+                n = imm or 32
+
+                def f():
+                    v = R[m]
+                    F[2] = (v >> (n - 1)) & 1
+                    R[d] = nz(v >> n)
+                    return nxt
+            else:
+                n = imm or 32
+
+                def f():
+                    v = R[m]
+                    F[2] = (v >> (n - 1)) & 1
+                    if v & 0x80000000:
+                        v -= 0x100000000
+                    R[d] = nz((v >> n) & MASK)
+                    return nxt
+            return f, 1
+
+        if top == 3:
+            sub, is_imm = (op >> 9) & 1, (op >> 10) & 1
+            m, n, d = (op >> 6) & 7, (op >> 3) & 7, op & 7
+            if is_imm:
+                if sub:
+                    def f():
+                        R[d] = add_c(R[n], m ^ MASK, 1)
+                        return nxt
+                else:
+                    def f():
+                        R[d] = add_c(R[n], m, 0)
+                        return nxt
+            elif sub:
+                def f():
+                    R[d] = add_c(R[n], R[m] ^ MASK, 1)
+                    return nxt
+            else:
+                def f():
+                    R[d] = add_c(R[n], R[m], 0)
+                    return nxt
+            return f, 1
+
+        # Move/compare/add/subtract immediate
+        if top <= 7:
+            d, imm = (op >> 8) & 7, op & 0xFF
+            if top == 4:
+                def f():
+                    R[d] = nz(imm)
+                    return nxt
+            elif top == 5:
+                def f():
+                    add_c(R[d], imm ^ MASK, 1)
+                    return nxt
+            elif top == 6:
+                def f():
+                    R[d] = add_c(R[d], imm, 0)
+                    return nxt
+            else:
+                def f():
+                    R[d] = add_c(R[d], imm ^ MASK, 1)
+                    return nxt
+            return f, 1
+
+        if top == 8:
+            if not op & 0x400:
+                return self._data_processing(op, nxt), 1
+            return self._special(op, pc, nxt, pcv, interwork, sp_moved)
+
+        # LDR literal
+        if top == 9:
+            t, addr = (op >> 8) & 7, (pcv & ~3) + (op & 0xFF) * 4
+
+            def f():
+                R[t] = ld32(addr)
+                return nxt
+            return f, 2
+
+        # Load/store register offset
+        if top in (10, 11):
+            kind, m, n, t = (op >> 9) & 7, (op >> 6) & 7, (op >> 3) & 7, op & 7
+            if kind == 0:
+                def f():
+                    st32((R[n] + R[m]) & MASK, R[t])
+                    return nxt
+            elif kind == 1:
+                def f():
+                    st16((R[n] + R[m]) & MASK, R[t])
+                    return nxt
+            elif kind == 2:
+                def f():
+                    st8((R[n] + R[m]) & MASK, R[t])
+                    return nxt
+            elif kind == 3:
+                def f():
+                    v = ld8((R[n] + R[m]) & MASK)
+                    R[t] = (v - 0x100) & MASK if v & 0x80 else v
+                    return nxt
+            elif kind == 4:
+                def f():
+                    R[t] = ld32((R[n] + R[m]) & MASK)
+                    return nxt
+            elif kind == 5:
+                def f():
+                    R[t] = ld16((R[n] + R[m]) & MASK)
+                    return nxt
+            elif kind == 6:
+                def f():
+                    R[t] = ld8((R[n] + R[m]) & MASK)
+                    return nxt
+            else:
+                def f():
+                    v = ld16((R[n] + R[m]) & MASK)
+                    R[t] = (v - 0x10000) & MASK if v & 0x8000 else v
+                    return nxt
+            return f, 2
+
+        # Load/store immediate offset: word, byte, halfword, SP relative
+        if 12 <= top <= 19:
+            load = (op >> 11) & 1
+            if top >= 18:
+                n, t, off = 13, (op >> 8) & 7, (op & 0xFF) * 4
+                acc = (st32, ld32)
+            else:
+                n, t, imm = (op >> 3) & 7, op & 7, (op >> 6) & 31
+                if top <= 13:
+                    off, acc = imm * 4, (st32, ld32)
+                elif top <= 15:
+                    off, acc = imm, (st8, ld8)
+                else:
+                    off, acc = imm * 2, (st16, ld16)
+            if load:
+                ld = acc[1]
+
+                def f():
+                    R[t] = ld((R[n] + off) & MASK)
+                    return nxt
+            else:
+                st = acc[0]
+
+                def f():
+                    st((R[n] + off) & MASK, R[t])
+                    return nxt
+            return f, 2
+
+        # ADR, ADD Rd, SP, #imm
+        if top == 20:
+            d, value = (op >> 8) & 7, ((pcv & ~3) + (op & 0xFF) * 4) & MASK
+
+            def f():
+                R[d] = value
+                return nxt
+            return f, 1
+        if top == 21:
+            d, imm = (op >> 8) & 7, (op & 0xFF) * 4
+
+            def f():
+                R[d] = (R[13] + imm) & MASK
+                return nxt
+            return f, 1
+
+        if top in (22, 23):
+            return self._misc(op, pc, nxt, interwork, sp_moved)
+
+        # STM/LDM
+        if top in (24, 25):
+            n, regs = (op >> 8) & 7, [r for r in range(8) if op & (1 << r)]
+            if not regs:
+                raise M0Fault("LDM/STM with an empty register list")
+            count = len(regs)
+            if top == 24:
+                def f():
+                    a = R[n]
+                    values = [R[r] for r in regs]
+                    for i, v in enumerate(values):
+                        st32(a + 4 * i, v)
+                    R[n] = (a + 4 * count) & MASK
+                    return nxt
+            else:
+                writeback = n not in regs
+
+                def f():
+                    a = R[n]
+                    values = [ld32(a + 4 * i) for i in range(count)]
+                    for r, v in zip(regs, values):
+                        R[r] = v
+                    if writeback:
+                        R[n] = (a + 4 * count) & MASK
+                    return nxt
+            return f, 1 + count
+
+        # Conditional branch, UDF, SVC
+        if top in (26, 27):
+            cond = (op >> 8) & 15
+            if cond == 14:
+                raise M0Fault("undefined instruction (UDF)")
+            if cond == 15:
+                raise M0Fault("SVC, exceptions are not modelled")
+            imm = op & 0xFF
+            target = (pcv + ((imm - 256 if imm & 0x80 else imm) << 1)) & MASK
+            test = _CONDITIONS[cond]
+            taken = 2 + ws
+
+            def f():
+                if test(F):
+                    model.stall += taken
+                    return target
+                return nxt
+            return f, 1
+
+        # B
+        if top == 28:
+            imm = op & 0x7FF
+            target = (pcv + ((imm - 2048 if imm & 0x400 else imm) << 1)) & MASK
+
+            def f():
+                return target
+            return f, 3 + ws
+
+        # 32-bit instructions: BL, MSR, MRS, barriers
+        if top == 30:
+            op2 = self.fetch16(pc + 2)
+            nxt = pc + 4
+            if op2 & 0xD000 == 0xD000:
+                s = (op >> 10) & 1
+                i1 = 1 - (((op2 >> 13) & 1) ^ s)
+                i2 = 1 - (((op2 >> 11) & 1) ^ s)
+                imm = (s << 24) | (i1 << 23) | (i2 << 22) | ((op & 0x3FF) << 12) | ((op2 & 0x7FF) << 1)
+                if s:
+                    imm -= 1 << 25
+                target = (pc + 4 + imm) & MASK
+                link = nxt | 1
+
+                def f():
+                    R[14] = link
+                    return target
+                return f, 4 + ws
+            if op & 0xFFE0 == 0xF380 and op2 & 0xD000 == 0x8000:
+                def f():
+                    return nxt                # MSR: special registers ignored
+                return f, 4
+            if op == 0xF3EF and op2 & 0xF000 == 0x8000:
+                d = (op2 >> 8) & 15
+                sysm = op2 & 0xFF
+
+                def f():
+                    if sysm <= 3:             # APSR and its views
+                        R[d] = (F[0] << 31) | (bool(F[1]) << 30) | (bool(F[2]) << 29) | (F[3] << 28)
+                    else:
+                        R[d] = R[13] if sysm in (8, 9) else 0
+                    return nxt
+                return f, 4
+            if op == 0xF3BF and op2 & 0xFF00 == 0x8F00:
+                def f():
+                    return nxt                # DMB, DSB, ISB
+                return f, 4 + ws
+        raise M0Fault("undefined instruction 0x%04x" % op)
+
+    def _data_processing(self, op, nxt):
+        R, F = self.R, self.F
+        code, m, d = (op >> 6) & 15, (op >> 3) & 7, op & 7
+
+        def nz(res):
+            F[0] = res >> 31
+            F[1] = res == 0
+            return res
+
+        def add_c(a, b, carry):
+            r = a + b + carry
+            res = r & MASK
+            F[0] = res >> 31
+            F[1] = res == 0
+            F[2] = r > MASK
+            F[3] = ((a ^ res) & (b ^ res)) >> 31
+            return res
+
+        if code == 0:
+            def f():
+                R[d] = nz(R[d] & R[m])
+                return nxt
+        elif code == 1:
+            def f():
+                R[d] = nz(R[d] ^ R[m])
+                return nxt
+        elif code == 2:
+            def f():
+                v, n = R[d], R[m] & 0xFF
+                if n:
+                    F[2] = (v >> (32 - n)) & 1 if n <= 32 else 0
+                    v = (v << n) & MASK if n < 32 else 0
+                R[d] = nz(v)
+                return nxt
+        elif code == 3:
+            def f():
+                v, n = R[d], R[m] & 0xFF
+                if n:
+                    F[2] = (v >> (n - 1)) & 1 if n <= 32 else 0
+                    v = v >> n if n < 32 else 0
+                R[d] = nz(v)
+                return nxt
+        elif code == 4:
+            def f():
+                v, n = R[d], R[m] & 0xFF
+                if n:
+                    n = min(n, 32)
+                    F[2] = (v >> (n - 1)) & 1
+                    if v & 0x80000000:
+                        v -= 0x100000000
+                    v = (v >> n) & MASK
+                R[d] = nz(v)
+                return nxt
+        elif code == 5:
+            def f():
+                R[d] = add_c(R[d], R[m], F[2])
+                return nxt
+        elif code == 6:
+            def f():
+                R[d] = add_c(R[d], R[m] ^ MASK, F[2])
+                return nxt
+        elif code == 7:
+            def f():
+                v, n = R[d], R[m] & 0xFF
+                if n:
+                    n &= 31
+                    if n:
+                        v = ((v >> n) | (v << (32 - n))) & MASK
+                    F[2] = v >> 31
+                R[d] = nz(v)
+                return nxt
+        elif code == 8:
+            def f():
+                nz(R[d] & R[m])
+                return nxt
+        elif code == 9:
+            def f():
+                R[d] = add_c(0, R[m] ^ MASK, 1)
+                return nxt
+        elif code == 10:
+            def f():
+                add_c(R[d], R[m] ^ MASK, 1)
+                return nxt
+        elif code == 11:
+            def f():
+                add_c(R[d], R[m], 0)
+                return nxt
+        elif code == 12:
+            def f():
+                R[d] = nz(R[d] | R[m])
+                return nxt
+        elif code == 13:
+            def f():
+                R[d] = nz((R[d] * R[m]) & MASK)
+                return nxt
+        elif code == 14:
+            def f():
+                R[d] = nz(R[d] & ~R[m] & MASK)
+                return nxt
+        else:
+            def f():
+                R[d] = nz(R[m] ^ MASK)
+                return nxt
+        return f
+
+    def _special(self, op, pc, nxt, pcv, interwork, sp_moved):
+        """ADD, CMP and MOV with high registers, BX and BLX"""
+        R, F = self.R, self.F
+        kind = (op >> 8) & 3
+        m = (op >> 3) & 15
+        d = (op & 7) | ((op >> 4) & 8)
+        branch = 3 + self.ws
+
+        def reg(r):
+            return pcv if r == 15 else R[r]
+
+        if kind == 0:
+            if d == 15:
+                def f():
+                    return (pcv + reg(m)) & MASK & ~1
+                return f, branch
+
+            def f():
+                R[d] = (R[d] + reg(m)) & MASK
+                if d == 13:
+                    sp_moved()
+                return nxt
+            return f, 1
+        if kind == 1:
+            def f():
+                a, b = reg(d), reg(m)
+                r = a + (b ^ MASK) + 1
+                res = r & MASK
+                F[0] = res >> 31
+                F[1] = res == 0
+                F[2] = r > MASK
+                F[3] = ((a ^ res) & ((b ^ MASK) ^ res)) >> 31
+                return nxt
+            return f, 1
+        if kind == 2:
+            if d == 15:
+                def f():
+                    return reg(m) & ~1
+                return f, branch
+
+            def f():
+                R[d] = reg(m)
+                if d == 13:
+                    sp_moved()
+                return nxt
+            return f, 1
+        if op & 0x80:
+            link = nxt | 1
+
+            def f():
+                target = interwork(R[m], "BLX")
+                R[14] = link
+                return target
+            return f, branch
+
+        def f():
+            return interwork(reg(m), "BX")
+        return f, branch
+
+    def _misc(self, op, pc, nxt, interwork, sp_moved):
+        """Miscellaneous 16-bit instructions (1011 xxxx xxxx xxxx)"""
+        R = self.R
+        ld32, st32 = self.ld32, self.st32
+        sub = (op >> 8) & 15
+
+        if sub == 0:
+            imm = (op & 0x7F) * 4
+            if op & 0x80:
+                imm = -imm
+
+            def f():
+                R[13] = (R[13] + imm) & MASK
+                sp_moved()
+                return nxt
+            return f, 1
+
+        if sub == 2:
+            kind, m, d = (op >> 6) & 3, (op >> 3) & 7, op & 7
+            if kind == 0:
+                def f():
+                    v = R[m] & 0xFFFF
+                    R[d] = (v - 0x10000) & MASK if v & 0x8000 else v
+                    return nxt
+            elif kind == 1:
+                def f():
+                    v = R[m] & 0xFF
+                    R[d] = (v - 0x100) & MASK if v & 0x80 else v
+                    return nxt
+            elif kind == 2:
+                def f():
+                    R[d] = R[m] & 0xFFFF
+                    return nxt
+            else:
+                def f():
+                    R[d] = R[m] & 0xFF
+                    return nxt
+            return f, 1
+
+        if sub in (4, 5):
+            regs = [r for r in range(8) if op & (1 << r)] + ([14] if op & 0x100 else [])
+            count = len(regs)
+
+            def f():
+                a = (R[13] - 4 * count) & MASK
+                for i, r in enumerate(regs):
+                    st32(a + 4 * i, R[r])
+                R[13] = a
+                sp_moved()
+                return nxt
+            return f, 1 + count
+
+        if sub == 6 and (op & 0xFFEF) == 0xB662:
+            def f():
+                return nxt                    # CPSIE/CPSID i
+            return f, 1
+
+        if sub == 10:
+            kind, m, d = (op >> 6) & 3, (op >> 3) & 7, op & 7
+            if kind == 0:
+                def f():
+                    v = R[m]
+                    R[d] = ((v & 0xFF) << 24) | ((v & 0xFF00) << 8) | ((v >> 8) & 0xFF00) | (v >> 24)
+                    return nxt
+                return f, 1
+            if kind == 1:
+                def f():
+                    v = R[m]
+                    R[d] = ((v & 0x00FF00FF) << 8) | ((v >> 8) & 0x00FF00FF)
+                    return nxt
+                return f, 1
+            if kind == 3:
+                def f():
+                    v = ((R[m] & 0xFF) << 8) | ((R[m] >> 8) & 0xFF)
+                    R[d] = (v - 0x10000) & MASK if v & 0x8000 else v
+                    return nxt
+                return f, 1
+
+        if sub in (12, 13):
+            regs = [r for r in range(8) if op & (1 << r)]
+            count = len(regs) + (1 if op & 0x100 else 0)
+            if op & 0x100:
+                def f():
+                    a = R[13]
+                    for i, r in enumerate(regs):
+                        R[r] = ld32(a + 4 * i)
+                    target = ld32(a + 4 * len(regs))
+                    R[13] = (a + 4 * count) & MASK
+                    return interwork(target, "POP {pc}")
+                return f, 4 + count + self.ws
+
+            def f():
+                a = R[13]
+                for i, r in enumerate(regs):
+                    R[r] = ld32(a + 4 * i)
+                R[13] = (a + 4 * count) & MASK
+                return nxt
+            return f, 1 + count
+
+        if sub == 14:
+            raise M0Fault("BKPT #%d" % (op & 0xFF))
+
+        if sub == 15 and op & 0xF == 0:
+            def f():
+                return nxt                    # NOP, YIELD, WFE, WFI, SEV
+            return f, 1 if op & 0xF0 == 0 else 2
+        raise M0Fault("undefined instruction 0x%04x" % op)
+
+
+_CONDITIONS = [
+    lambda F: F[1],                                   # EQ
+    lambda F: not F[1],                               # NE
+    lambda F: F[2],                                   # CS
+    lambda F: not F[2],                               # CC
+    lambda F: F[0],                                   # MI
+    lambda F: not F[0],                               # PL
+    lambda F: F[3],                                   # VS
+    lambda F: not F[3],                               # VC
+    lambda F: F[2] and not F[1],                      # HI
+    lambda F: not F[2] or F[1],                       # LS
+    lambda F: F[0] == F[3],                           # GE
+    lambda F: F[0] != F[3],                           # LT
+    lambda F: not F[1] and F[0] == F[3],              # GT
+    lambda F: F[1] or F[0] != F[3],                   # LE
+]
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image", help="linked ELF image, object or \"archive.a(member.o)\"")
+    parser.add_argument("function", help="symbol of the function to call")
+    parser.add_argument("args", nargs="*", help="arguments (integers, or symbols for their address)")
+    parser.add_argument("--wait-states", type=int, default=0, help="flash wait states")
+    args = parser.parse_args(argv)
+
+    image = ElfImage(args.image)
+    model = M0(image, wait_states=args.wait_states)
+    values = []
+    for a in args.args:
+        try:
+            values.append(int(a, 0))
+        except ValueError:
+            values.append(image.symbol(a).addr)
+    try:
+        r0, cycles, count = model.call(image.symbol(args.function).addr | 1, values)
+    except M0Fault as fault:
+        print("HardFault: %s" % fault, file=sys.stderr)
+        return 1
+    print("%s returned 0x%08x after %d cycles, %d instructions" % (args.function, r0, cycles, count))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
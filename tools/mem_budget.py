@@ -0,0 +1,411 @@
+#!/usr/bin/env python3
+"""Attribute flash/RAM usage of a linked target to source subsystems.
+
+Parses the GNU ld map file produced by -Wl,-Map, splits every input section
+(and, where the linker lists them, every symbol inside it) into flash and RAM
+bytes, groups them by subsystem (HAL, BSP, DSP, NN, RTT, lab code, ...), and
+checks the totals against the budgets in cmake/memory_budget.json.
+
+A JSON report is always written. The exit status is non-zero when a budget is
+exceeded so the build fails; the stamp file is only touched on success so the
+check re-runs on the next build.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+# Subsystem classification, first match wins. Patterns are matched against the
+# object/archive path as it appears in the map file.
+DEFAULT_SUBSYSTEMS = [
+    ("HAL",  [r"STM32F0xx_HAL_Driver"]),
+    ("BSP",  [r"Drivers/BSP/", r"/BSP/", r"STM32_Discovery\.dir"]),
+    ("DSP",  [r"CMSIS/DSP/", r"libarm_cortexM0l_math\.a", r"arm_dsp", r"CMSIS_DSP"]),
+    ("NN",   [r"CMSIS/NN/", r"CMSIS_NN"]),
+    ("RTT",  [r"SEGGER"]),
+    ("Core", [r"startup_stm32", r"system_stm32f0xx", r"Core/Src/", r"syscalls\.c", r"sysmem\.c"]),
+    ("libc", [r"libc(_nano)?\.a", r"libg(_nano)?\.a", r"libm\.a", r"libgcc\.a",
+              r"libnosys\.a", r"crt[a-z0-9]*\.o", r"arm-none-eabi"]),
+]
+
+# Constant tables on the DSP hot path. These are the usual reason an FFT pulls
+# tens of kilobytes into flash, so they are reported on their own.
+DEFAULT_TABLES = [
+    r"twiddleCoef", r"armBitRevIndexTable", r"armBitRevTable", r"realCoef[AB]",
+    r"sinTable_", r"cos_factors", r"Weights_", r"arm_common_tables", r"arm_const_structs",
+]
+
+RE_MEM_REGION = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S+))?\s*$")
+RE_OUT_SECTION = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?")
+RE_IN_SECTION = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s*(.*)$")
+RE_CONTINUATION = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s*(.*)$")
+RE_OUT_CONTINUATION = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?\s*$")
+RE_SYMBOL = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_.$][\w.$]*)\s*$")
+RE_NAME_ONLY = re.compile(r"^(\s?)(\S+)\s*$")
+
+SECTION_PREFIXES = (".text.", ".rodata.", ".data.", ".bss.", ".sbss.", ".sdata.", ".tbss.", ".tdata.")
+
+
+class Region(object):
+    def __init__(self, name, origin, length):
+        self.name = name
+        self.origin = origin
+        self.length = length
+
+    def contains(self, addr):
+        return self.origin <= addr < self.origin + self.length
+
+
+class Entry(object):
+    """One attributable chunk: an input section or a symbol inside one."""
+
+    def __init__(self, symbol, section, obj, out_section, addr, size, load):
+        self.symbol = symbol
+        self.section = section
+        self.obj = obj
+        self.out_section = out_section
+        self.addr = addr
+        self.size = size
+        self.load = load
+        self.subsystem = None
+        self.flash = 0
+        self.ram = 0
+
+
+def parse_map(path):
+    """Return (regions, output_sections, entries) parsed from a GNU ld map."""
+    with open(path, "r", errors="replace") as f:
+        lines = f.read().splitlines()
+
+    regions = []
+    i = 0
+    while i < len(lines) and not lines[i].startswith("Memory Configuration"):
+        i += 1
+    i += 1
+    while i < len(lines) and not lines[i].startswith("Linker script and memory map"):
+        m = RE_MEM_REGION.match(lines[i])
+        if m and m.group(1) not in ("Name", "*default*"):
+            regions.append(Region(m.group(1), int(m.group(2), 16), int(m.group(3), 16)))
+        i += 1
+
+    out_sections = []
+    sections = []          # [out_name, in_name, obj, addr, size, load_offset, symbols]
+    current_out = None     # (name, vma, size, lma)
+    pending = None         # (indented, name) waiting for its address line
+
+    for line in lines[i:]:
+        if line.startswith("OUTPUT("):
+            break
+
+        if pending is not None:
+            indented, name = pending
+            pending = None
+            if indented:
+                m = RE_CONTINUATION.match(line)
+                if m:
+                    sections.append(_new_input(current_out, name, m.group(3),
+                                               int(m.group(1), 16), int(m.group(2), 16)))
+                    continue
+            else:
+                m = RE_OUT_CONTINUATION.match(line)
+                if m:
+                    current_out = _new_output(out_sections, name, m.group(1), m.group(2), m.group(3))
+                    continue
+
+        if not line.strip():
+            continue
+
+        if not line[0].isspace():
+            m = RE_OUT_SECTION.match(line)
+            if m:
+                current_out = _new_output(out_sections, m.group(1), m.group(2), m.group(3), m.group(4))
+                continue
+            m = RE_NAME_ONLY.match(line)
+            if m and not line.startswith(("LOAD ", "START GROUP", "END GROUP")):
+                pending = (False, m.group(2))
+            continue
+
+        m = RE_IN_SECTION.match(line)
+        if m:
+            name = m.group(1)
+            if name == "*fill*":
+                sections.append(_new_input(current_out, name, "", int(m.group(2), 16), int(m.group(3), 16)))
+            else:
+                sections.append(_new_input(current_out, name, m.group(4),
+                                           int(m.group(2), 16), int(m.group(3), 16)))
+            continue
+
+        m = RE_SYMBOL.match(line)
+        if m and sections and "=" not in line:
+            sections[-1][6].append((int(m.group(1), 16), m.group(2)))
+            continue
+
+        m = RE_NAME_ONLY.match(line)
+        if m and m.group(1) == " " and not m.group(2).startswith("*"):
+            pending = (True, m.group(2))
+
+    entries = []
+    for out_name, in_name, obj, addr, size, load, symbols in sections:
+        if size == 0:
+            continue
+        entries.extend(_split_section(out_name, in_name, obj, addr, size, load, symbols))
+    return regions, out_sections, entries
+
+
+def _new_output(out_sections, name, vma, size, lma):
+    vma = int(vma, 16)
+    out = (name, vma, int(size, 16), int(lma, 16) if lma else vma)
+    out_sections.append(out)
+    return out
+
+
+def _new_input(current_out, name, obj, addr, size):
+    out_name = current_out[0] if current_out else ""
+    load = (current_out[3] - current_out[1]) if current_out else 0
+    return [out_name, name, obj.strip(), addr, size, load, []]
+
+
+def _section_symbol(name):
+    for prefix in SECTION_PREFIXES:
+        if name.startswith(prefix):
+            return name[len(prefix):]
+    return name
+
+
+def _split_section(out_name, in_name, obj, addr, size, load, symbols):
+    """Split an input section at its listed symbols (for code built without
+    -ffunction-sections, e.g. the prebuilt CMSIS-DSP archive)."""
+    end = addr + size
+    symbols = sorted(s for s in symbols if addr <= s[0] < end)
+    if not symbols:
+        return [Entry(_section_symbol(in_name), in_name, obj, out_name, addr, size, load)]
+    result = []
+    if symbols[0][0] > addr:
+        result.append(Entry(_section_symbol(in_name), in_name, obj, out_name,
+                            addr, symbols[0][0] - addr, load))
+    for idx, (sym_addr, sym) in enumerate(symbols):
+        next_addr = symbols[idx + 1][0] if idx + 1 < len(symbols) else end
+        if next_addr > sym_addr:
+            result.append(Entry(sym, in_name, obj, out_name, sym_addr, next_addr - sym_addr, load))
+    return result
+
+
+def classify(entries, regions, subsystems, target_dir, tables):
+    flash = _region(regions, "FLASH")
+    ram = _region(regions, "RAM")
+    compiled = [(name, [re.compile(p) for p in pats]) for name, pats in subsystems]
+    table_res = [re.compile(p) for p in tables]
+
+    kept = []
+    for e in entries:
+        in_flash = flash is not None and flash.contains(e.addr)
+        in_ram = ram is not None and ram.contains(e.addr)
+        if not in_flash and not in_ram:
+            continue
+        if in_flash:
+            e.flash = e.size
+        if in_ram:
+            e.ram = e.size
+            # Initialised data is copied out of flash at reset
+            if e.load and flash is not None and flash.contains(e.addr + e.load):
+                e.flash = e.size
+        e.subsystem = _subsystem_of(e, compiled, target_dir)
+        e.table = _is_table(e, table_res)
+        kept.append(e)
+    return kept
+
+
+def _is_table(entry, patterns):
+    if entry.section.startswith(".text") or entry.section == "*fill*":
+        return False
+    names = (entry.symbol, entry.section, os.path.basename(entry.obj))
+    return any(p.search(n) for p in patterns for n in names)
+
+
+def _region(regions, name):
+    for r in regions:
+        if r.name.upper() == name:
+            return r
+    return None
+
+
+def _subsystem_of(entry, compiled, target_dir):
+    if entry.section == "*fill*":
+        return "padding"
+    obj = entry.obj.replace("\\", "/")
+    for name, pats in compiled:
+        if any(p.search(obj) for p in pats):
+            return name
+    if target_dir and ("/%s.dir/" % target_dir) in obj:
+        return "lab"
+    if not obj:
+        return "linker"
+    return "lab" if obj.endswith((".obj", ".o")) and "CMakeFiles" in obj else "other"
+
+
+def load_budget(path, target):
+    if not path:
+        return {}
+    with open(path) as f:
+        cfg = json.load(f)
+    budget = dict(cfg.get("default", {}))
+    override = cfg.get("targets", {}).get(target, {})
+    for key, value in override.items():
+        if isinstance(value, dict) and isinstance(budget.get(key), dict):
+            merged = dict(budget[key])
+            for sub, limits in value.items():
+                if isinstance(limits, dict) and isinstance(merged.get(sub), dict):
+                    merged[sub] = dict(merged[sub], **limits)
+                else:
+                    merged[sub] = limits
+            budget[key] = merged
+        else:
+            budget[key] = value
+    return budget
+
+
+def summarise(target, regions, out_sections, entries):
+    flash = _region(regions, "FLASH")
+    ram = _region(regions, "RAM")
+    used = {"FLASH": 0, "RAM": 0}
+    for name, vma, size, lma in out_sections:
+        if ram is not None and ram.contains(vma):
+            used["RAM"] += size
+            if lma != vma and flash is not None and flash.contains(lma):
+                used["FLASH"] += size
+        elif flash is not None and flash.contains(vma):
+            used["FLASH"] += size
+
+    subsystems = {}
+    for e in entries:
+        s = subsystems.setdefault(e.subsystem, {"flash": 0, "ram": 0})
+        s["flash"] += e.flash
+        s["ram"] += e.ram
+    # Bytes reserved by the linker script itself (heap/stack, alignment)
+    attributed_ram = sum(e.ram for e in entries)
+    if used["RAM"] > attributed_ram:
+        subsystems["reserved"] = {"flash": 0, "ram": used["RAM"] - attributed_ram}
+
+    functions = {}
+    for e in entries:
+        if e.subsystem in ("padding", "linker"):
+            continue
+        key = (e.symbol, e.obj)
+        f = functions.setdefault(key, {"symbol": e.symbol, "subsystem": e.subsystem,
+                                       "object": e.obj, "section": e.section,
+                                       "flash": 0, "ram": 0})
+        f["flash"] += e.flash
+        f["ram"] += e.ram
+    functions = sorted(functions.values(), key=lambda f: (f["flash"] + f["ram"]), reverse=True)
+
+    tables = [{"symbol": e.symbol, "subsystem": e.subsystem, "object": e.obj,
+               "flash": e.flash, "ram": e.ram} for e in entries if e.table]
+    tables.sort(key=lambda t: t["flash"] + t["ram"], reverse=True)
+
+    return {
+        "target": target,
+        "regions": {r.name: {"origin": r.origin, "length": r.length,
+                             "used": used.get(r.name.upper(), 0)} for r in regions
+                    if r.name.upper() in used},
+        "subsystems": subsystems,
+        "tables": tables,
+        "tables_total": {"flash": sum(t["flash"] for t in tables),
+                         "ram": sum(t["ram"] for t in tables)},
+        "functions": functions,
+    }
+
+
+def check(report, budget):
+    violations = []
+
+    def over(what, kind, used, limit):
+        if limit is not None and used > limit:
+            violations.append({"what": what, "kind": kind, "used": used, "limit": limit})
+
+    regions = report["regions"]
+    over("total", "flash", regions.get("FLASH", {}).get("used", 0), budget.get("flash"))
+    over("total", "ram", regions.get("RAM", {}).get("used", 0), budget.get("ram"))
+
+    for name, limits in budget.get("subsystems", {}).items():
+        used = report["subsystems"].get(name, {"flash": 0, "ram": 0})
+        over(name, "flash", used["flash"], limits.get("flash"))
+        over(name, "ram", used["ram"], limits.get("ram"))
+
+    tables = budget.get("tables", {})
+    over("tables", "flash", report["tables_total"]["flash"], tables.get("flash"))
+    over("tables", "ram", report["tables_total"]["ram"], tables.get("ram"))
+
+    per_function = budget.get("function", {})
+    for f in report["functions"]:
+        over(f["symbol"], "flash", f["flash"], per_function.get("flash"))
+        over(f["symbol"], "ram", f["ram"], per_function.get("ram"))
+    return violations
+
+
+def print_summary(report, violations, top):
+    print("Memory budget for %s" % report["target"])
+    for name, r in sorted(report["regions"].items()):
+        pct = 100.0 * r["used"] / r["length"] if r["length"] else 0.0
+        print("  %-6s %7d / %7d bytes (%5.1f%%)" % (name, r["used"], r["length"], pct))
+    print("  %-10s %8s %8s" % ("subsystem", "flash", "ram"))
+    for name, s in sorted(report["subsystems"].items(), key=lambda kv: -(kv[1]["flash"] + kv[1]["ram"])):
+        print("  %-10s %8d %8d" % (name, s["flash"], s["ram"]))
+    if report["tables"]:
+        print("  hot-path tables: %d bytes flash, %d bytes ram"
+              % (report["tables_total"]["flash"], report["tables_total"]["ram"]))
+        for t in report["tables"][:top]:
+            print("    %-40s %8d %8d  %s" % (t["symbol"], t["flash"], t["ram"], t["subsystem"]))
+    print("  largest symbols:")
+    for f in report["functions"][:top]:
+        print("    %-40s %8d %8d  %s" % (f["symbol"], f["flash"], f["ram"], f["subsystem"]))
+    for v in violations:
+        print("error: %s %s usage %d exceeds budget %d" % (v["what"], v["kind"], v["used"], v["limit"]),
+              file=sys.stderr)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map", help="GNU ld map file")
+    parser.add_argument("--target", required=True, help="CMake target name of the image")
+    parser.add_argument("--budget", help="JSON budget file (cmake/memory_budget.json)")
+    parser.add_argument("--report", help="write the JSON report here")
+    parser.add_argument("--stamp", help="touch this file when all budgets are met")
+    parser.add_argument("--top", type=int, default=10, help="symbols to list in the summary")
+    args = parser.parse_args(argv)
+
+    budget = load_budget(args.budget, args.target)
+    subsystems = DEFAULT_SUBSYSTEMS
+    if "subsystem_patterns" in budget:
+        subsystems = [(k, v) for k, v in budget["subsystem_patterns"]] + DEFAULT_SUBSYSTEMS
+    tables = budget.get("table_patterns", DEFAULT_TABLES)
+
+    regions, out_sections, entries = parse_map(args.map)
+    if not regions:
+        print("error: no memory configuration found in %s" % args.map, file=sys.stderr)
+        return 2
+    entries = classify(entries, regions, subsystems, args.target, tables)
+    report = summarise(args.target, regions, out_sections, entries)
+    violations = check(report, budget)
+    report["budget"] = budget
+    report["violations"] = violations
+
+    if args.report:
+        with open(args.report, "w") as f:
+            json.dump(report, f, indent=2)
+            f.write("\n")
+    print_summary(report, violations, args.top)
+
+    if violations:
+        if args.stamp and os.path.exists(args.stamp):
+            os.remove(args.stamp)
+        return 1
+    if args.stamp:
+        with open(args.stamp, "w") as f:
+            f.write("ok\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+"""Checks the Thumb-1 q7 convolutions and fully connected kernels on the model.
+
+Runs the CMSIS-NN kernels assembled from Drivers/CMSIS/NN/Source/*/*_cm0.S
+(arm_convolve_HWC_q7_basic, _fast, _RGB, _basic_nonsquare, _fast_nonsquare,
+arm_convolve_1x1_HWC_q7_fast_nonsquare, arm_fully_connected_q7, _opt and
+_q4) on m0_model.M0, on every case printed by the nn_m0_vectors host
+program. Their outputs must equal those expected bit for bit (of
+Ref_Implementations, of the C kernel for the 4-bit weights) and their
+status the one expected; the bytes around the output must be left alone,
+and so must the output of a size mismatch. The data are at odd addresses
+and bufferA, bufferB and vec_buffer are NULL: the kernels use neither
+alignment nor scratch. The scales of arm_fully_connected_q7_q4 are uint16,
+at an even address.
+
+The cycles of the same calls make the table: cycles per MAC, one MAC being
+one weight applied to an input inside the image (padding excluded), per
+cifar10 layer and over the random cases of each function. For scale, the
+q7 dot product of the prebuilt libarm_cortexM0l_math.a, a plain C loop as
+compiled for the Cortex-M0, is timed on the input of cifar10 ip1.
+
+    nn_m0_check.py nn_m0_vectors --objects arm_convolve_HWC_q7_cm0.o ...
+        --library libarm_cortexM0l_math.a --output nn_m0_kernels.md
+The exit status is 1 on a mismatch or fault, 2 when a file cannot be used.
+"""
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import m0_model                     # noqa: E402
+
+SQUARE = ("arm_convolve_HWC_q7_basic", "arm_convolve_HWC_q7_fast", "arm_convolve_HWC_q7_RGB")
+NONSQUARE = ("arm_convolve_HWC_q7_basic_nonsquare", "arm_convolve_HWC_q7_fast_nonsquare",
+             "arm_convolve_1x1_HWC_q7_fast_nonsquare")
+FC = ("arm_fully_connected_q7", "arm_fully_connected_q7_opt")
+FC_Q4 = ("arm_fully_connected_q7_q4",)
+KERNELS = SQUARE + NONSQUARE + FC + FC_Q4
+
+# The cifar10 layers do not fit the 16 KB of the board (the output of conv1
+# alone is 32 KB): the model gets more
+RAM_SIZE = 256 * 1024
+GUARD = 4
+GUARD_BYTE = 0x5A
+
+
+class Case(object):
+    def __init__(self, words):
+        self.layer = words[0]       # "conv" or "fc"
+        self.function = words[1]
+        self.name = words[2]
+        self.status = int(words[3])
+        self.params = [int(w) for w in words[4:]]
+        self.input = []
+        self.weights = []
+        self.bias = []
+        self.output = []
+        self.scale = []             # arm_fully_connected_q7_q4
+        self.zero = []
+
+    def __str__(self):
+        return "%s %s %s" % (self.function, self.name, "/".join(str(p) for p in self.params))
+
+    @property
+    def output_size(self):
+        if self.layer == "fc":
+            return self.params[1]
+        return self.params[3] * self.params[12] * self.params[13]
+
+    def macs(self):
+        """Weights applied to inputs inside the image"""
+        if self.layer == "fc":
+            return self.params[0] * self.params[1]
+        in_x, in_y, ch_in, ch_out, kx, ky, px, py, sx, sy = self.params[:10]
+        out_x, out_y = self.params[12:14]
+
+        def inside(dim_in, dim_out, kernel, pad, stride):
+            return sum(max(0, min(kernel, dim_in - (o * stride - pad)) - max(0, pad - o * stride))
+                       for o in range(dim_out))
+        return (inside(in_x, out_x, kx, px, sx) * inside(in_y, out_y, ky, py, sy) * ch_in * ch_out)
+
+    def shape(self):
+        if self.layer == "fc":
+            return "%d x %d" % (self.params[1], self.params[0])
+        in_x, in_y, ch_in, ch_out, kx, ky = self.params[:6]
+        return "%dx%dx%d, %dx%d to %d" % (in_y, in_x, ch_in, ky, kx, ch_out)
+
+
+def read_cases(program):
+    out = subprocess.run([program], check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    cases = []
+    for line in out.splitlines():
+        words = line.split()
+        if not words:
+            continue
+        if words[0] in ("conv", "fc"):
+            cases.append(Case(words))
+        else:
+            setattr(cases[-1], words[0], [int(w) for w in words[1:]])
+    return cases
+
+
+def q7_bytes(values):
+    return struct.pack("<%db" % len(values), *values)
+
+
+class Kernels(object):
+    """The kernels of the objects, linked together on one model."""
+
+    def __init__(self, paths):
+        image = m0_model.ElfImage(paths)
+        missing = [name for name in KERNELS if name not in image.symbols]
+        if missing:
+            raise KeyError("%s not in %s" % (", ".join(missing), " ".join(paths)))
+        self.model = m0_model.M0(image, ram=(m0_model.RAM_BASE, RAM_SIZE))
+        self.entries = dict((name, image.symbol(name).addr | 1) for name in KERNELS)
+
+    def run(self, case):
+        """(status, output, guards intact, cycles) of the case"""
+        model = self.model
+        # Odd addresses, guard bytes around the output
+        addr = m0_model.RAM_BASE + 1
+        places = {}
+        for field in ("input", "weights", "bias"):
+            data = getattr(case, field)
+            places[field] = addr
+            model.write(addr, q7_bytes(data))
+            addr = (addr + len(data) + 2) | 1
+        if case.function in FC_Q4:
+            places["scale"] = addr + 1
+            model.write(addr + 1, struct.pack("<%dH" % len(case.scale), *case.scale))
+            addr = (addr + 1 + 2 * len(case.scale) + 2) | 1
+            places["zero"] = addr
+            model.write(addr, bytes(case.zero))
+            addr = (addr + len(case.zero) + 2) | 1
+        size = case.output_size
+        model.write(addr, bytes([GUARD_BYTE]) * (size + 2 * GUARD))
+        out = addr + GUARD
+        p = case.params
+        if case.function in SQUARE:
+            args = [places["input"], p[0], p[2], places["weights"], p[3], p[4], p[6], p[8],
+                    places["bias"], p[10], p[11], out, p[12], 0, 0]
+        elif case.function in NONSQUARE:
+            args = [places["input"], p[0], p[1], p[2], places["weights"]] + p[3:10] + [
+                places["bias"], p[10], p[11], out, p[12], p[13], 0, 0]
+        elif case.function in FC_Q4:
+            args = [places["input"], places["weights"], places["scale"], places["zero"], p[0], p[1], p[2], p[3],
+                    places["bias"], out]
+        else:
+            args = [places["input"], places["weights"], p[0], p[1], p[2], p[3], places["bias"], out, 0]
+        status, cycles, _ = model.call(self.entries[case.function], args)
+        status = struct.unpack("<i", struct.pack("<I", status))[0]
+        raw = model.read(addr, size + 2 * GUARD)
+        guards = raw[:GUARD] + raw[GUARD + size:] == bytes([GUARD_BYTE]) * (2 * GUARD)
+        output = list(struct.unpack("<%db" % size, raw[GUARD:GUARD + size]))
+        if case.status != 0:
+            guards = guards and raw == bytes([GUARD_BYTE]) * len(raw)
+        return status, output, guards, cycles
+
+
+def check(kernels, cases):
+    """Number of failing cases; the cycles of each in case.cycles"""
+    failures = 0
+    for case in cases:
+        case.cycles = None
+        try:
+            status, output, guards, cycles = kernels.run(case)
+        except m0_model.M0Fault as fault:
+            print("%s: HardFault: %s" % (case, fault))
+            failures += 1
+            continue
+        if status != case.status:
+            print("%s: status %d, not %d" % (case, status, case.status))
+            failures += 1
+        elif case.status == 0 and output != case.output:
+            first = next(i for i, (a, b) in enumerate(zip(output, case.output)) if a != b)
+            print("%s: output %d is %d, not %d" % (case, first, output[first], case.output[first]))
+            failures += 1
+        elif not guards:
+            print("%s: wrote outside its output" % case)
+            failures += 1
+        else:
+            case.cycles = cycles
+    print("%d of %d cases bit exact" % (len(cases) - failures, len(cases)))
+    return failures
+
+
+def dot_prod_reference(library, case):
+    """(MACs, cycles) of arm_dot_prod_q7 of the library on the input of case"""
+    image = m0_model.ElfImage("%s(arm_dot_prod_q7.o)" % library)
+    model = m0_model.M0(image)
+    size = len(case.input)
+    a = m0_model.RAM_BASE
+    b = a + ((size + 3) & ~3)
+    result = b + ((size + 3) & ~3)
+    model.write(a, q7_bytes(case.input))
+    model.write(b, q7_bytes(case.weights[:size]))
+    cycles = model.call(image.symbol("arm_dot_prod_q7").addr | 1, [a, b, size, result])[1]
+    return size, cycles
+
+
+def markdown(cases, reference):
+    lines = [
+        "# Thumb-1 q7 convolutions and fully connected kernels on the Cortex-M0",
+        "",
+        "Cycle model of `tools/m0_model.py`, 0 flash wait states. One MAC: one weight applied to an input",
+        "inside the image (padding excluded). Whole calls, setup and output saturation included.",
+        "",
+        "| Function | Case | Shape | MACs | Cycles | Cycles/MAC |",
+        "| --- | --- | --- | --- | --- | --- |",
+    ]
+    timed = [c for c in cases if c.status == 0 and c.cycles is not None]
+    for case in timed:
+        if case.name.startswith("cifar10"):
+            lines.append("| %s | %s | %s | %d | %d | %.2f |" % (
+                case.function, case.name, case.shape(), case.macs(), case.cycles,
+                float(case.cycles) / case.macs()))
+    # ip1 once, in q7, as the example runs it
+    network = [c for c in timed if c.name.startswith("cifar10") and c.function not in FC_Q4]
+    if network:
+        macs = sum(c.macs() for c in network)
+        cycles = sum(c.cycles for c in network)
+        lines.append("| cifar10 conv1-3, ip1 | | | %d | %d | %.2f |" % (macs, cycles, float(cycles) / macs))
+    for function in KERNELS:
+        drawn = [c for c in timed if c.function == function and c.name == "random" and c.macs()]
+        if drawn:
+            macs = sum(c.macs() for c in drawn)
+            cycles = sum(c.cycles for c in drawn)
+            lines.append("| %s | random (%d) | | %d | %d | %.2f |" % (
+                function, len(drawn), macs, cycles, float(cycles) / macs))
+    if reference is not None:
+        macs, cycles = reference
+        lines.append("| arm_dot_prod_q7 (libarm_cortexM0l_math.a) | one vector | %d | %d | %d | %.2f |" % (
+            macs, macs, cycles, float(cycles) / macs))
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("vectors", help="the nn_m0_vectors program")
+    parser.add_argument("--objects", nargs="+", required=True, help="objects of the Thumb-1 kernels")
+    parser.add_argument("--library", help="libarm_cortexM0l_math.a, for the dot product timed for scale")
+    parser.add_argument("--output", help="write the cycle table here (default: stdout)")
+    args = parser.parse_args(argv)
+
+    try:
+        kernels = Kernels(args.objects)
+        cases = read_cases(args.vectors)
+        reference = None
+        if args.library:
+            ip1 = [c for c in cases if c.name == "cifar10_ip1" and c.function in FC]
+            reference = dot_prod_reference(args.library, ip1[0]) if ip1 else None
+    except (ValueError, KeyError, OSError, subprocess.CalledProcessError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+
+    if check(kernels, cases):
+        return 1
+
+    text = markdown(cases, reference)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+        print("cycle table written to %s" % args.output)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
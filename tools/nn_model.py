@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""Converts a CMSIS-NN layer graph and its weights into a binary model image.
+
+The image is what stm32f072b_discovery_nnmodel.c runs: a header, a table of
+ops, one CMSIS-NN call each, and the weights and biases, little endian, read
+in place from flash (cmake/nn_model.cmake). The graph is the JSON of
+tools/nn_plan.py (e.g. cmake/nn_cifar10.json), which plans the activation
+arena: the image gives every tensor and scratch buffer as an offset in it.
+On top of what the planner reads, a layer may give
+
+  - "variant": the kernel; conv "basic" (default), "fast" or "rgb"; fc "fc"
+    (default, arm_fully_connected_q7), "opt" or "q4" (4-bit weights packed
+    as tools/nn_q4_pack.py does, arm_fully_connected_q7_q4)
+  - "weights", "bias": the q7 values, a list or the name of a
+    #define NAME {...} of the --header files
+  - "layout": order of the fc weights, "rows" (default) or "opt", that of
+    arm_fully_connected_q7_opt; they are reordered for the variant
+  - "bias_shift", "out_shift": numbers or names of #define NAME value
+
+conv, depthwise, fc, maxpool, avepool, relu and softmax layers on square q7
+tensors only, those of the runtime. --variant LAYER=VARIANT overrides the
+graph, e.g. ip1=q4. The input of the image is that of the graph, its output
+that of the last layer; any scaling of the raw input is left to the
+application.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import nn_plan                      # noqa: E402
+import nn_q4_pack                   # noqa: E402
+
+MAGIC = 0x314D4E4E                  # "NNM1"
+VERSION = 1
+HEADER = struct.Struct("<IHHIIIIIIII")
+OP = struct.Struct("<BBHHHHHHHHHIIIIIII")
+CHECKSUM_BLOCK = 2048
+
+# Op codes of stm32f072b_discovery_nnmodel.h
+CODES = {
+    ("conv", "basic"): 0, ("conv", "fast"): 1, ("conv", "rgb"): 2, ("depthwise", None): 3,
+    ("maxpool", None): 4, ("avepool", None): 5, ("relu", None): 6, ("softmax", None): 7,
+    ("fc", "fc"): 8, ("fc", "opt"): 9, ("fc", "q4"): 10,
+}
+DEFAULT_VARIANT = {"conv": "basic", "fc": "fc"}
+
+
+def checksum(data):
+    """Fletcher-32 of NNMODEL_Checksum(), sums reduced by end-around carry."""
+    a = b = 0
+    for start in range(0, len(data), CHECKSUM_BLOCK):
+        for byte in bytearray(data[start:start + CHECKSUM_BLOCK]):
+            a += byte
+            b += a
+        a = (a & 0xFFFF) + (a >> 16)
+        b = (b & 0xFFFF) + (b >> 16)
+    a = (a & 0xFFFF) + (a >> 16)
+    b = (b & 0xFFFF) + (b >> 16)
+    return (b << 16) | a
+
+
+def read_defines(paths):
+    """#define NAME {...} as lists and #define NAME number as numbers."""
+    defines = {}
+    for path in paths:
+        with open(path) as f:
+            text = re.sub(r"\\\r?\n", " ", f.read())
+        for name, value in re.findall(r"^\s*#define\s+(\w+)[ \t]+(.+)$", text, re.M):
+            value = value.strip()
+            if value.startswith("{"):
+                defines[name] = [int(v, 0) for v in value.strip("{}").split(",") if v.strip()]
+            else:
+                try:
+                    defines[name] = int(value, 0)
+                except ValueError:
+                    pass
+    return defines
+
+
+def to_opt(matrix, dim, rows):
+    """Interleaved order of arm_fully_connected_q7_opt(), from_opt() reversed."""
+    values = []
+    for r in range(0, rows - rows % 4, 4):
+        for c in range(0, dim - dim % 4, 4):
+            for half in range(2):
+                for k in (0, 2):
+                    values += [matrix[r + k][c + half], matrix[r + k + 1][c + half],
+                               matrix[r + k][c + half + 2], matrix[r + k + 1][c + half + 2]]
+        for c in range(dim - dim % 4, dim):
+            values += [matrix[r + k][c] for k in range(4)]
+    for r in range(rows - rows % 4, rows):
+        values += matrix[r]
+    return values
+
+
+class Image(object):
+    """Data of the image after the op table, each block word aligned."""
+
+    def __init__(self, base):
+        self.base = base
+        self.data = bytearray()
+
+    def add(self, blob):
+        offset = self.base + len(self.data)
+        self.data += blob + bytes(-len(blob) % 4)
+        return offset
+
+
+def square(layer, key, default):
+    value = layer.get(key, default)
+    x, y = nn_plan.pair(value)
+    if x != y:
+        raise ValueError("%s: %s %s is not square" % (layer["name"], key, value))
+    return x
+
+
+def resolve(layer, key, defines, default=None):
+    value = layer.get(key, default)
+    if value is None:
+        raise ValueError("%s: no %s" % (layer["name"], key))
+    if isinstance(value, str):
+        if value not in defines:
+            raise ValueError("%s: %s %s not defined in the headers" % (layer["name"], key, value))
+        value = defines[value]
+    return value
+
+
+def q7_blob(layer, key, defines, count):
+    values = resolve(layer, key, defines)
+    if not isinstance(values, list) or len(values) != count:
+        raise ValueError("%s: %s has %s values, not %d" % (layer["name"], key,
+                                                           len(values) if isinstance(values, list) else "no",
+                                                           count))
+    if any(not -128 <= v <= 127 for v in values):
+        raise ValueError("%s: %s is not q7" % (layer["name"], key))
+    return values
+
+
+def convert(graph, defines, variants, align):
+    """(image bytes, ops as (layer, code, fields), arena size, buffers)"""
+    buffers, planned = nn_plan.plan(graph, align)
+    offsets = dict((b.name, b.offset) for b in buffers)
+    sizes = dict((b.name, b.size) for b in buffers)
+    source = graph["input"]
+    shapes = {source["name"]: tuple(source["shape"])}
+    kinds = {source["name"]: source.get("type", "q7")}
+    count = len(graph["layers"])
+    image = Image(HEADER.size + count * OP.size)
+    ops = []
+
+    for layer, (name, op, out, kind, read, written) in zip(graph["layers"], planned):
+        h, w, c = shapes[layer["input"]]
+        shapes[name] = out
+        kinds[name] = kind
+        if kinds[layer["input"]] != "q7" or kind != "q7":
+            raise ValueError("%s: q7 tensors only" % name)
+        if h != w or out[0] != out[1]:
+            raise ValueError("%s: square tensors only" % name)
+        variant = variants.get(name, layer.get("variant", DEFAULT_VARIANT.get(op)))
+        if op not in DEFAULT_VARIANT:
+            variant = None
+        if (op, variant) not in CODES:
+            raise ValueError("%s: no runtime op for %s%s" % (name, op, " " + variant if variant else ""))
+        f = dict(InDim=h, InCh=c, OutDim=out[0], OutCh=out[2], KerDim=0, Pad=0, Stride=0, BiasShift=0,
+                 OutShift=0, Input=offsets[read[0]], Output=offsets[written[0]], Scratch=0, Weights=0,
+                 Bias=0, Scale=0, Zero=0)
+        scratch = name + "_scratch"
+        if scratch in offsets:
+            f["Scratch"] = offsets[scratch]
+
+        if op in ("conv", "depthwise", "maxpool", "avepool"):
+            f["KerDim"] = square(layer, "kernel", None)
+            f["Pad"] = square(layer, "pad", 0)
+            f["Stride"] = square(layer, "stride", 1)
+        if op in ("conv", "depthwise", "fc"):
+            f["BiasShift"] = resolve(layer, "bias_shift", defines, 0)
+            f["OutShift"] = resolve(layer, "out_shift", defines, 0)
+        if op in ("conv", "depthwise"):
+            k = f["KerDim"]
+            weights = q7_blob(layer, "weights", defines, k * k * c * (out[2] if op == "conv" else 1))
+            f["Weights"] = image.add(struct.pack("<%db" % len(weights), *weights))
+            bias = q7_blob(layer, "bias", defines, out[2])
+            f["Bias"] = image.add(struct.pack("<%db" % len(bias), *bias))
+        elif op == "fc":
+            f.update(OutDim=1)
+            dim, rows = h * w * c, out[2]
+            weights = q7_blob(layer, "weights", defines, dim * rows)
+            layout = layer.get("layout", "rows")
+            if layout not in ("rows", "opt"):
+                raise ValueError("%s: unknown layout %s" % (name, layout))
+            matrix = (nn_q4_pack.from_opt(weights, dim, rows) if layout == "opt"
+                      else [weights[r * dim:(r + 1) * dim] for r in range(rows)])
+            if variant == "q4":
+                scales, zeros, quantized = [], [], []
+                for row in matrix:
+                    scale, zero, qs = nn_q4_pack.quantize_row(row)
+                    scales.append(scale)
+                    zeros.append(zero)
+                    quantized.append(qs)
+                f["Weights"] = image.add(bytes(nn_q4_pack.pack(quantized, dim)))
+                f["Scale"] = image.add(struct.pack("<%dH" % rows, *scales))
+                f["Zero"] = image.add(bytes(zeros))
+                f["Scratch"] = 0
+            else:
+                values = to_opt(matrix, dim, rows) if variant == "opt" else sum(matrix, [])
+                f["Weights"] = image.add(struct.pack("<%db" % len(values), *values))
+            bias = q7_blob(layer, "bias", defines, rows)
+            f["Bias"] = image.add(struct.pack("<%db" % len(bias), *bias))
+        ops.append((name, CODES[(op, variant)], f))
+
+    arena = nn_plan.aligned(max(b.offset + b.size for b in buffers), align)
+    last = planned[-1][5][0]
+    table = b"".join(OP.pack(code, 0, f["InDim"], f["InCh"], f["OutDim"], f["OutCh"], f["KerDim"], f["Pad"],
+                             f["Stride"], f["BiasShift"], f["OutShift"], f["Input"], f["Output"], f["Scratch"],
+                             f["Weights"], f["Bias"], f["Scale"], f["Zero"]) for _, code, f in ops)
+    body = table + bytes(image.data)
+    header = HEADER.pack(MAGIC, VERSION, count, HEADER.size + len(body), HEADER.size, arena,
+                         offsets[source["name"]], sizes[source["name"]], offsets[last], sizes[last],
+                         checksum(body))
+    return header + body, ops, arena, buffers
+
+
+def c_list(values, per_line=32):
+    lines = [",".join(str(v) for v in values[i:i + per_line]) for i in range(0, len(values), per_line)]
+    return "{" + ", \\\n    ".join(lines) + "}"
+
+
+def header_text(prefix, source, data, ops, arena, guard):
+    return "\n".join([
+        "/* Generated by tools/nn_model.py from %s: do not edit." % source,
+        " * Model image of stm32f072b_discovery_nnmodel.c, %d ops: place %s in a" % (len(ops), prefix),
+        " * word-aligned array of %s_SIZE bytes, with an arena of %s_ARENA_SIZE. */" % (prefix, prefix),
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#define %s_SIZE %d" % (prefix, len(data)),
+        "#define %s_ARENA_SIZE %d" % (prefix, arena),
+        "#define %s %s" % (prefix, c_list(bytearray(data))),
+        "",
+        "#endif /* %s */" % guard,
+        "",
+    ])
+
+
+def write_if_changed(path, data):
+    """Keep the timestamp, and the objects built from it, when nothing changed."""
+    if os.path.exists(path):
+        with open(path, "rb") as f:
+            if f.read() == data:
+                return
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("graph", help="JSON layer graph")
+    parser.add_argument("--header", action="append", default=[], help="C header of weights or shifts, repeatable")
+    parser.add_argument("--variant", action="append", default=[], metavar="LAYER=VARIANT",
+                        help="kernel of a layer, over that of the graph, repeatable")
+    parser.add_argument("--align", type=int, default=4, help="alignment of every buffer, bytes (default 4)")
+    parser.add_argument("--output", help="image to write")
+    parser.add_argument("--c-header", help="C header of the image to write")
+    parser.add_argument("--prefix", help="macros of the C header (default: the graph name in capitals, _MODEL)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="the ops of the image")
+    args = parser.parse_args(argv)
+
+    try:
+        with open(args.graph) as f:
+            graph = json.load(f)
+        defines = read_defines(args.header)
+        variants = dict(v.split("=", 1) for v in args.variant)
+        if args.align % 4:
+            raise ValueError("alignment %d is not a multiple of 4" % args.align)
+        data, ops, arena, _ = convert(graph, defines, variants, args.align)
+    except (OSError, ValueError, KeyError) as e:
+        print("error: %s: %s" % (args.graph, e), file=sys.stderr)
+        return 2
+
+    if args.verbose:
+        names = dict((code, key[0] + ("_" + key[1] if key[1] else "")) for key, code in CODES.items())
+        print("%-8s %-10s %-10s %-10s %7s %7s %8s" % ("op", "kernel", "in", "out", "input", "output", "weights"))
+        for name, code, f in ops:
+            print("%-8s %-10s %-10s %-10s %7d %7d %8d" % (
+                name, names[code], "%dx%dx%d" % (f["InDim"], f["InDim"], f["InCh"]),
+                "%dx%dx%d" % (f["OutDim"], f["OutDim"], f["OutCh"]), f["Input"], f["Output"], f["Weights"]))
+    if args.output:
+        write_if_changed(args.output, data)
+    if args.c_header:
+        prefix = args.prefix if args.prefix else graph["name"].upper() + "_MODEL"
+        guard = "__%s" % os.path.basename(args.c_header).upper().replace(".", "_").replace("-", "_")
+        write_if_changed(args.c_header, header_text(prefix, os.path.basename(args.graph), data, ops, arena,
+                                                    guard).encode())
+    table = HEADER.size + len(ops) * OP.size
+    print("%s: %d ops in %d bytes (%d of header and op table), arena of %d bytes"
+          % (graph["name"], len(ops), len(data), table, arena))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
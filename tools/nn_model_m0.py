@@ -0,0 +1,286 @@
+#!/usr/bin/env python3
+"""End-to-end latency of a model image of the nnmodel runtime on the Cortex-M0.
+
+Runs every op of a model image of tools/nn_model.py on m0_model.M0 at 48 MHz
+(1 flash wait state) as stm32f072b_discovery_nnmodel.c would on the board:
+the image in flash after the code, where the kernels read the weights from,
+the activation arena at the start of RAM. The convolutions and fully
+connected ops run the Thumb-1 kernels assembled from the NN *_cm0.S files,
+with their cycles measured; relu, max pooling and softmax, which have no
+Thumb code here, are worked out in Python as the C functions of CMSIS-NN do
+for the Cortex-M0 and charged estimated cycles (EST_* below), as is the
+dispatch of each op and the checksum of BSP_NNMODEL_Init(). The table marks
+which is which.
+
+The input and the output of every op come from "bench_nnmodel --vectors",
+the runtime on the host: each op output on the model must equal the host
+one bit for bit. An op that differs is reported, and the host output is put
+in its place, so that the next ops still start from the same data.
+
+    nn_model_m0.py bench_nnmodel --images cifar10.nnm ... --objects
+        arm_convolve_HWC_q7_cm0.o ... --output nn_model_m0.md
+The exit status is 1 on a mismatch or fault, 2 when a file cannot be used.
+"""
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import m0_model                     # noqa: E402
+import nn_model                     # noqa: E402
+
+CPU_HZ = 48000000
+WAIT_STATES = 1
+FLASH_SIZE = 128 * 1024
+# The cifar10 arena does not fit the 16 KB of the board: the model gets more
+RAM_SIZE = 64 * 1024
+FILL_BYTE = 0xA5
+
+KERNELS = {0: "arm_convolve_HWC_q7_basic", 1: "arm_convolve_HWC_q7_fast", 2: "arm_convolve_HWC_q7_RGB",
+           8: "arm_fully_connected_q7", 9: "arm_fully_connected_q7_opt", 10: "arm_fully_connected_q7_q4"}
+NAMES = dict((code, key[0] + (" " + key[1] if key[1] else "")) for key, code in nn_model.CODES.items())
+
+# Estimated Cortex-M0 cycles of the C code, data in RAM
+EST_RELU = 10           # per element: LDRSB, compare, STRB, loop
+EST_POOL_TAP = 14       # per window element: bounds, index, LDRSB, compare
+EST_POOL_OUT = 20       # per output element: loops, store
+EST_SOFTMAX = 30        # per element, three passes
+EST_SOFTMAX_CALL = 150  # 0x100000 / sum, __aeabi_idiv
+EST_DISPATCH = 40       # op and table loads, BLX, the arguments stacked
+EST_CHECKSUM = 6        # per byte of the image, from flash
+
+
+def signed(values):
+    return [v - 256 if v > 127 else v for v in values]
+
+
+def relu(data):
+    return [max(v, 0) for v in data]
+
+
+def maxpool(data, dim, ch, kernel, pad, stride, out_dim):
+    """arm_maxpool_q7_HWC() as built without ARM_MATH_DSP."""
+    out = [0] * (out_dim * out_dim * ch)
+    for c in range(ch):
+        for oy in range(out_dim):
+            for ox in range(out_dim):
+                best = -129
+                for ky in range(oy * stride - pad, oy * stride - pad + kernel):
+                    for kx in range(ox * stride - pad, ox * stride - pad + kernel):
+                        if 0 <= ky < dim and 0 <= kx < dim:
+                            best = max(best, data[c + ch * (kx + ky * dim)])
+                out[c + ch * (ox + oy * out_dim)] = best
+    return out
+
+
+def softmax(data):
+    """arm_softmax_q7()."""
+    base = max(data) - 8
+    total = sum(1 << min(v - base, 31) for v in data if v > base)
+    output_base = 0x100000 // total
+    return [max(-128, min(127, output_base >> max(0, min(13 + base - v, 31)))) if v > base else 0 for v in data]
+
+
+def read_vectors(program, path):
+    out = subprocess.run([program, "--vectors", path], check=True, stdout=subprocess.PIPE,
+                         universal_newlines=True).stdout
+    inputs, outputs = None, []
+    for line in out.splitlines():
+        words = line.split()
+        if words[0] == "input":
+            inputs = [int(w) for w in words[1:]]
+        elif words[0] == "op":
+            outputs.append([int(w) for w in words[2:]])
+    return inputs, outputs
+
+
+class Op(object):
+    FIELDS = ("Code", "Reserved", "InDim", "InCh", "OutDim", "OutCh", "KerDim", "Pad", "Stride", "BiasShift",
+              "OutShift", "Input", "Output", "Scratch", "Weights", "Bias", "Scale", "Zero")
+
+    def __init__(self, data, offset):
+        for name, value in zip(self.FIELDS, nn_model.OP.unpack_from(data, offset)):
+            setattr(self, name, value)
+
+    @property
+    def input_size(self):
+        return self.InDim * self.InDim * self.InCh
+
+    @property
+    def output_size(self):
+        return self.OutDim * self.OutDim * self.OutCh
+
+    def macs(self):
+        """Weights applied to inputs inside the image, 0 for the other ops"""
+        if self.Code in (8, 9, 10):
+            return self.input_size * self.OutCh
+        if self.Code not in (0, 1, 2):
+            return 0
+
+        def inside(o):
+            start = o * self.Stride - self.Pad
+            return min(start + self.KerDim, self.InDim) - max(start, 0)
+        taps = sum(inside(y) * inside(x) for y in range(self.OutDim) for x in range(self.OutDim))
+        return taps * self.InCh * self.OutCh
+
+
+class Runtime(object):
+    """The image in flash after the kernels, the arena in RAM."""
+
+    def __init__(self, objects, data):
+        image = m0_model.ElfImage(objects)
+        missing = [name for name in KERNELS.values() if name not in image.symbols]
+        if missing:
+            raise KeyError("%s not in %s" % (", ".join(missing), " ".join(objects)))
+        self.model = m0_model.M0(image, flash=(m0_model.FLASH_BASE, FLASH_SIZE),
+                                 ram=(m0_model.RAM_BASE, RAM_SIZE), wait_states=WAIT_STATES)
+        self.entries = dict((code, image.symbol(name).addr | 1) for code, name in KERNELS.items())
+        end = max(addr + size for addr, _, size in image.segments if addr < m0_model.RAM_BASE)
+        self.base = (end + 3) & ~3
+        offset = self.base - m0_model.FLASH_BASE
+        if offset + len(data) > FLASH_SIZE:
+            raise ValueError("image of %d bytes does not fit the flash after %d bytes of code"
+                             % (len(data), offset))
+        self.model.flash[offset:offset + len(data)] = data
+        self.code_size = offset
+        header = nn_model.HEADER.unpack_from(data, 0)
+        (magic, version, count, size, op_offset, self.arena, self.input, self.input_size, self.output,
+         self.output_size, check) = header
+        if magic != nn_model.MAGIC or version != nn_model.VERSION:
+            raise ValueError("not a model image")
+        if check != nn_model.checksum(data[nn_model.HEADER.size:size]):
+            raise ValueError("checksum of the image")
+        if self.arena + 4096 > RAM_SIZE:
+            raise ValueError("arena of %d bytes too large for the model" % self.arena)
+        self.size = size
+        self.ops = [Op(data, op_offset + i * nn_model.OP.size) for i in range(count)]
+
+    def tensor(self, offset, size):
+        return signed(bytearray(self.model.read(m0_model.RAM_BASE + offset, size)))
+
+    def put(self, offset, values):
+        self.model.write(m0_model.RAM_BASE + offset, struct.pack("<%db" % len(values), *values))
+
+    def run(self, op):
+        """(cycles, measured) of the op, its output in the arena"""
+        ram, flash = m0_model.RAM_BASE, self.base
+        if op.Code in (0, 1, 2):
+            args = [ram + op.Input, op.InDim, op.InCh, flash + op.Weights, op.OutCh, op.KerDim, op.Pad, op.Stride,
+                    flash + op.Bias, op.BiasShift, op.OutShift, ram + op.Output, op.OutDim, ram + op.Scratch, 0]
+        elif op.Code in (8, 9):
+            args = [ram + op.Input, flash + op.Weights, op.input_size, op.OutCh, op.BiasShift, op.OutShift,
+                    flash + op.Bias, ram + op.Output, ram + op.Scratch]
+        elif op.Code == 10:
+            args = [ram + op.Input, flash + op.Weights, flash + op.Scale, flash + op.Zero, op.input_size, op.OutCh,
+                    op.BiasShift, op.OutShift, flash + op.Bias, ram + op.Output]
+        else:
+            data = self.tensor(op.Input, op.input_size)
+            if op.Code == 6:
+                self.put(op.Output, relu(data))
+                return EST_RELU * len(data), False
+            if op.Code == 4:
+                self.put(op.Output, maxpool(data, op.InDim, op.InCh, op.KerDim, op.Pad, op.Stride, op.OutDim))
+                return (EST_POOL_TAP * op.KerDim * op.KerDim + EST_POOL_OUT) * op.output_size, False
+            if op.Code == 7:
+                self.put(op.Output, softmax(data))
+                return EST_SOFTMAX * len(data) + EST_SOFTMAX_CALL, False
+            raise ValueError("no Cortex-M0 kernel or model of %s" % NAMES[op.Code])
+        status, cycles, _ = self.model.call(self.entries[op.Code], args)
+        if status != 0:
+            raise ValueError("%s returned %d" % (KERNELS[op.Code], struct.unpack("<i", struct.pack("<I", status))[0]))
+        return cycles, True
+
+
+def run_image(program, objects, path):
+    """(runtime, [(op, cycles, measured, identical)]) of the image at path"""
+    with open(path, "rb") as f:
+        data = f.read()
+    runtime = Runtime(objects, data)
+    inputs, outputs = read_vectors(program, path)
+    if len(inputs) != runtime.input_size or len(outputs) != len(runtime.ops):
+        raise ValueError("%s: the vectors are not those of the image" % path)
+    runtime.model.write(m0_model.RAM_BASE, bytes([FILL_BYTE]) * runtime.arena)
+    runtime.put(runtime.input, inputs)
+    rows = []
+    for op, expected in zip(runtime.ops, outputs):
+        cycles, measured = runtime.run(op)
+        identical = runtime.tensor(op.Output, op.output_size) == expected
+        if not identical:
+            runtime.put(op.Output, expected)
+        rows.append((op, cycles, measured, identical))
+    return runtime, rows
+
+
+def markdown(results):
+    lines = ["# Model images on the Cortex-M0 model", "",
+             "%d MHz, %d flash wait state; weights read from flash. Measured: the Thumb-1 kernels on the model. "
+             "Estimated: the C code, EST_* of tools/nn_model_m0.py." % (CPU_HZ // 1000000, WAIT_STATES), ""]
+    for name, runtime, rows in results:
+        total = sum(r[1] for r in rows) + EST_DISPATCH * len(rows)
+        measured = sum(r[1] for r in rows if r[2])
+        lines += ["## %s" % name, "",
+                  "Image %d bytes, after %d bytes of kernels; arena %d bytes." % (runtime.size, runtime.code_size,
+                                                                                runtime.arena), "",
+                  "| Op | Kernel | In | Out | MACs | Cycles | Cycles/MAC | ms | |",
+                  "| --- | --- | --- | --- | --- | --- | --- | --- | --- |"]
+        for index, (op, cycles, is_measured, identical) in enumerate(rows):
+            macs = op.macs()
+            lines.append("| %d | %s | %dx%dx%d | %dx%dx%d | %s | %d | %s | %.2f | %s%s |" % (
+                index, NAMES[op.Code], op.InDim, op.InDim, op.InCh, op.OutDim, op.OutDim, op.OutCh,
+                macs if macs else "", cycles, "%.2f" % (float(cycles) / macs) if macs else "",
+                cycles * 1000.0 / CPU_HZ, "measured" if is_measured else "estimated",
+                "" if identical else ", MISMATCH"))
+        lines += ["| | dispatch | | | | %d | | %.2f | estimated |" % (EST_DISPATCH * len(rows),
+                                                                      EST_DISPATCH * len(rows) * 1000.0 / CPU_HZ),
+                  "| | **inference** | | | | **%d** | | **%.1f** | %.1f %% measured |" % (
+                      total, total * 1000.0 / CPU_HZ, measured * 100.0 / total),
+                  "",
+                  "BSP_NNMODEL_Init(): checksum of %d bytes, about %d cycles (%.1f ms), once." % (
+                      runtime.size - nn_model.HEADER.size, EST_CHECKSUM * (runtime.size - nn_model.HEADER.size),
+                      EST_CHECKSUM * (runtime.size - nn_model.HEADER.size) * 1000.0 / CPU_HZ), ""]
+    return "\n".join(lines)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("program", help="bench_nnmodel, for the vectors of --vectors")
+    parser.add_argument("--images", nargs="+", required=True, help="model images (.nnm)")
+    parser.add_argument("--objects", nargs="+", required=True, help="objects of the Thumb-1 NN kernels")
+    parser.add_argument("--output", help="markdown table to write")
+    args = parser.parse_args(argv)
+
+    results = []
+    failed = False
+    for path in args.images:
+        name = os.path.splitext(os.path.basename(path))[0]
+        try:
+            runtime, rows = run_image(args.program, args.objects, path)
+        except (ValueError, KeyError, OSError, subprocess.CalledProcessError) as e:
+            print("error: %s" % e, file=sys.stderr)
+            return 2
+        except m0_model.M0Fault as e:
+            print("%s: fault: %s" % (name, e))
+            return 1
+        results.append((name, runtime, rows))
+        total = sum(r[1] for r in rows) + EST_DISPATCH * len(rows)
+        for index, (op, cycles, measured, identical) in enumerate(rows):
+            if not identical:
+                print("%s: op %d (%s) MISMATCH" % (name, index, NAMES[op.Code]))
+                failed = True
+        print("%s: %d ops, %d cycles, %.1f ms at %d MHz, %.1f %% measured, outputs %s" % (
+            name, len(rows), total, total * 1000.0 / CPU_HZ, CPU_HZ // 1000000,
+            sum(r[1] for r in rows if r[2]) * 100.0 / total,
+            "MISMATCH" if any(not r[3] for r in rows) else "identical to the host"))
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(markdown(results))
+        print("latency table written to %s" % args.output)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+"""Static activation-memory plan of a CMSIS-NN layer graph.
+
+A CMSIS-NN network needs an input and an output buffer per layer, and most
+layers a scratch buffer besides (the im2col bufferA of the convolutions, the
+vec_buffer of the q7 fully connected kernels, the bufferA of average
+pooling). Given the layers in order (a JSON graph, e.g. cmake/nn_cifar10.json),
+this script works out the shape of every tensor, the layer from which each
+buffer is live to the last one reading it, and places all of them in one
+arena so that buffers live at the same time never overlap. It writes a header
+of constant offsets and sizes (cmake/nn_plan.cmake).
+
+Graph: {"name", "input": {"name", "shape": [H, W, C], "type"}, "layers": [...]}
+with each layer {"name", "op", "input", ...}:
+
+  - conv, depthwise: "channels" (conv), "kernel", "pad", "stride", each a
+    number or [x, y]; output floor((in + 2 pad - kernel) / stride) + 1;
+    scratch 2 ch_in kernel_x kernel_y q15 (bufferA)
+  - fc: "units"; scratch the input length in q15 (vec_buffer) for a q7 input,
+    none for a q15 one
+  - maxpool, avepool: "kernel", "pad", "stride"; output as Caffe rounds it,
+    ceil((in + 2 pad - kernel) / stride) + 1; avepool scratch 2 out_x ch q15.
+    Both destroy their input, which no later layer may read
+  - relu, sigmoid, tanh: in place, the output the input buffer under a new name
+  - softmax: an output of the input's shape
+
+A layer may give "type" ("q7" or "q15") for its output, the input's
+otherwise. The output of a layer is live from that layer to the last one
+reading it (to the end if none does), the network input from the start, a
+scratch buffer in its layer only. In-place layers extend the buffer they
+rename. Buffers are placed largest first, each at the lowest aligned offset
+clear of the buffers placed before it whose lifetimes meet its own; the
+result is checked, and compared with the live bytes of the busiest layer (a
+lower bound) and with a buffer each.
+"""
+
+import argparse
+import json
+import math
+import os
+import sys
+
+ELEMENT_SIZE = {"q7": 1, "q15": 2}
+IN_PLACE = ("relu", "sigmoid", "tanh")
+OPS = ("conv", "depthwise", "fc", "maxpool", "avepool", "softmax") + IN_PLACE
+
+
+class Buffer(object):
+    def __init__(self, name, size, first, comment):
+        self.name = name
+        self.size = size
+        self.first = first
+        self.last = first
+        self.comment = comment
+        self.offset = None
+
+    def meets(self, other):
+        return self.first <= other.last and other.first <= self.last
+
+
+def pair(value):
+    """(x, y) of a number or [x, y]."""
+    return (value, value) if isinstance(value, int) else (value[0], value[1])
+
+
+def out_dim(dim, kernel, pad, stride, ceil):
+    span = dim + 2 * pad - kernel
+    if span < 0:
+        raise ValueError("kernel %d larger than the padded input %d" % (kernel, dim + 2 * pad))
+    return (int(math.ceil(span / float(stride))) if ceil else span // stride) + 1
+
+
+def plan(graph, align):
+    """Buffers (tensors, then scratch) with their lifetimes, and the layers
+    as (name, op, shape, type, [buffer names read], [written])."""
+    tensors = {}        # tensor name -> (buffer, shape, type)
+    buffers = []
+    layers = []
+    destroyed = {}      # buffer name -> layer that destroyed it
+
+    source = graph["input"]
+    shape = tuple(source["shape"])
+    kind = source.get("type", "q7")
+    buf = Buffer(source["name"], shape[0] * shape[1] * shape[2] * ELEMENT_SIZE[kind], -1,
+                 "%s %s, network input" % ("x".join(map(str, shape)), kind))
+    buffers.append(buf)
+    tensors[source["name"]] = (buf, shape, kind)
+
+    for index, layer in enumerate(graph["layers"]):
+        name, op = layer["name"], layer["op"]
+        if op not in OPS:
+            raise ValueError("%s: unknown op %s" % (name, op))
+        if name in tensors:
+            raise ValueError("%s: name already used" % name)
+        if layer["input"] not in tensors:
+            raise ValueError("%s: no tensor %s before it" % (name, layer["input"]))
+        buf, (h, w, c), kind = tensors[layer["input"]]
+        if buf.name in destroyed:
+            raise ValueError("%s: reads %s, destroyed by %s" % (name, layer["input"], destroyed[buf.name]))
+        buf.last = index
+        out_kind = layer.get("type", kind)
+        scratch = 0
+
+        if op in ("conv", "depthwise"):
+            kx, ky = pair(layer["kernel"])
+            px, py = pair(layer.get("pad", 0))
+            sx, sy = pair(layer.get("stride", 1))
+            out = (out_dim(h, ky, py, sy, False), out_dim(w, kx, px, sx, False),
+                   layer["channels"] if op == "conv" else c)
+            scratch = 2 * c * kx * ky * ELEMENT_SIZE["q15"]
+        elif op == "fc":
+            out = (1, 1, layer["units"])
+            scratch = h * w * c * ELEMENT_SIZE["q15"] if kind == "q7" else 0
+        elif op in ("maxpool", "avepool"):
+            kx, ky = pair(layer["kernel"])
+            px, py = pair(layer.get("pad", 0))
+            sx, sy = pair(layer.get("stride", 1))
+            out = (out_dim(h, ky, py, sy, True), out_dim(w, kx, px, sx, True), c)
+            scratch = 2 * out[1] * c * ELEMENT_SIZE["q15"] if op == "avepool" else 0
+            destroyed[buf.name] = name
+        else:
+            out = (h, w, c)
+
+        if op in IN_PLACE:
+            tensors[name] = (buf, out, kind)
+            layers.append((name, op, out, kind, [buf.name], [buf.name]))
+            continue
+        size = out[0] * out[1] * out[2] * ELEMENT_SIZE[out_kind]
+        out_buf = Buffer(name, size, index, "%s %s, %s output" % ("x".join(map(str, out)), out_kind, op))
+        buffers.append(out_buf)
+        tensors[name] = (out_buf, out, out_kind)
+        written = [name]
+        if scratch:
+            scratch_buf = Buffer(name + "_scratch", scratch, index, "%s scratch" % op)
+            buffers.append(scratch_buf)
+            written.append(scratch_buf.name)
+        layers.append((name, op, out, out_kind, [buf.name], written))
+
+    # Outputs no layer reads stay live to the end
+    read = set(b for layer in layers for b in layer[4])
+    for buf in buffers:
+        if buf.name not in read and not buf.name.endswith("_scratch"):
+            buf.last = len(layers)
+    place(buffers, align)
+    return buffers, layers
+
+
+def aligned(value, align):
+    return (value + align - 1) // align * align
+
+
+def place(buffers, align):
+    """Largest first, each at the lowest offset clear of those it meets."""
+    for buf in sorted(buffers, key=lambda b: (-b.size, b.first, b.name)):
+        offset = 0
+        for other in sorted((o for o in buffers if o.offset is not None and o.meets(buf)),
+                            key=lambda o: o.offset):
+            if offset + buf.size <= other.offset:
+                break
+            offset = max(offset, aligned(other.offset + other.size, align))
+        buf.offset = offset
+    for a in buffers:
+        for b in buffers:
+            if a is not b and a.meets(b) and a.offset < b.offset + b.size and b.offset < a.offset + a.size:
+                raise AssertionError("%s and %s overlap" % (a.name, b.name))
+
+
+def live_bytes(buffers, step, align):
+    return sum(aligned(b.size, align) for b in buffers if b.first <= step <= b.last)
+
+
+def header_text(graph, buffers, layers, prefix, align, arena, naive, source, guard):
+    lines = [
+        "/* Generated by tools/nn_plan.py from %s: do not edit." % source,
+        " * Activation arena of %s: %d bytes, %d with a buffer each. Offsets are"
+        % (graph["name"], arena, naive),
+        " * multiples of %d from a base as aligned. */" % align,
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#define %sARENA_SIZE %d" % (prefix, arena),
+        "#define %sARENA_ALIGN %d" % (prefix, align),
+        "",
+    ]
+    for buf in buffers:
+        macro = prefix + buf.name.upper()
+        first = "input" if buf.first < 0 else layers[buf.first][0]
+        last = "output" if buf.last >= len(layers) else layers[buf.last][0]
+        live = ("in %s" % first) if first == last else ("%s to %s" % (first, last))
+        lines += [
+            "/* %s, live %s */" % (buf.comment, live),
+            "#define %s_OFFSET %d" % (macro, buf.offset),
+            "#define %s_SIZE %d" % (macro, buf.size),
+        ]
+    lines += ["", "#endif /* %s */" % guard, ""]
+    return "\n".join(lines)
+
+
+def write_if_changed(path, text):
+    """Keep the timestamp, and the objects built from it, when nothing changed."""
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("graph", help="JSON layer graph")
+    parser.add_argument("--output", help="header of offsets to write")
+    parser.add_argument("--prefix", help="prefix of the macros (default: the graph name in capitals and _)")
+    parser.add_argument("--align", type=int, default=4, help="alignment of every buffer, bytes (default 4)")
+    parser.add_argument("--limit", type=int, help="fail if the arena exceeds this many bytes")
+    parser.add_argument("-v", "--verbose", action="store_true", help="live bytes of each layer")
+    args = parser.parse_args(argv)
+
+    with open(args.graph) as f:
+        graph = json.load(f)
+    prefix = args.prefix if args.prefix is not None else graph["name"].upper() + "_"
+    try:
+        buffers, layers = plan(graph, args.align)
+    except (ValueError, KeyError) as e:
+        parser.error("%s: %s" % (args.graph, e))
+
+    arena = aligned(max(b.offset + b.size for b in buffers), args.align)
+    naive = sum(b.size for b in buffers)
+    steps = range(-1, len(layers))
+    bound = max(live_bytes(buffers, s, args.align) for s in steps)
+    if args.verbose:
+        print("%-12s %-10s %-12s %8s" % ("layer", "op", "output", "live"))
+        for step, (name, op, shape, kind, _, _) in enumerate(layers):
+            print("%-12s %-10s %-12s %8d" % (name, op, "x".join(map(str, shape)) + " " + kind,
+                                            live_bytes(buffers, step, args.align)))
+    if args.output:
+        guard = "__%s" % os.path.basename(args.output).upper().replace(".", "_").replace("-", "_")
+        write_if_changed(args.output, header_text(graph, buffers, layers, prefix, args.align, arena, naive,
+                                                  os.path.basename(args.graph), guard))
+    print("%s: %d bytes of activations and scratch in one arena (busiest layer %d), %d with a buffer each"
+          % (graph["name"], arena, bound, naive))
+    if args.limit is not None and arena > args.limit:
+        print("%s: arena of %d bytes over the limit of %d" % (graph["name"], arena, args.limit))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""Packs the q7 weights of a CMSIS-NN fully connected layer into 4 bits.
+
+Reads a weight matrix given as #define NAME {...} in a C header (the way
+the CMSIS-NN examples and tests hold their weights) and writes the packed
+weights of arm_fully_connected_q7_q4() in a header of its own
+(cmake/nn_q4.cmake):
+
+  - every row quantized apart: a 4-bit unsigned q stands for the q7 weight
+    (q - zero) * scale / 2^11, scale a uint16 and zero a uint8 in 0..15
+    (ARM_NN_Q4_SCALE_SHIFT in arm_nnfunctions.h)
+  - the scale and zero of a row are the pair of least squared error found
+    around those of its range: the range of the row stretched to include 0,
+    and scales down to half of that one, every zero within one of where the
+    scale puts 0
+  - two columns a byte, the first in the low nibble; rows by groups of 4,
+    the last of the rows left over, interleaved byte by byte within a group
+
+--layout opt takes the matrix in the interleaved order of
+arm_fully_connected_q7_opt() (IP1_WT of cifar10), rows the row-major one
+of arm_fully_connected_q7(). The bias, bias_shift and out_shift of the q7
+layer are kept: the packed layer computes the same outputs on its rounded
+weights. The error of the weights, in q7 steps, is printed.
+"""
+
+import argparse
+import math
+import os
+import re
+import sys
+
+SCALE_SHIFT = 11
+SCALE_MAX = 0xFFFF
+LEVELS = 16
+SCALE_STEPS = 32
+
+
+def read_define(path, name):
+    """Values of #define name {...} in the header at path."""
+    with open(path) as f:
+        text = f.read()
+    match = re.search(r"^\s*#define\s+%s\s*\{([^}]*)\}" % re.escape(name), text, re.M)
+    if not match:
+        raise ValueError("no #define %s {...} in %s" % (name, path))
+    return [int(v, 0) for v in match.group(1).replace("\\", " ").split(",") if v.strip()]
+
+
+def from_opt(values, dim, rows):
+    """Row-major matrix of the interleaved order of arm_fully_connected_q7_opt()."""
+    matrix = [[0] * dim for _ in range(rows)]
+    it = iter(values)
+    for r in range(0, rows - rows % 4, 4):
+        for c in range(0, dim - dim % 4, 4):
+            for half in range(2):
+                for k in (0, 2):
+                    matrix[r + k][c + half] = next(it)
+                    matrix[r + k + 1][c + half] = next(it)
+                    matrix[r + k][c + half + 2] = next(it)
+                    matrix[r + k + 1][c + half + 2] = next(it)
+        for c in range(dim - dim % 4, dim):
+            for k in range(4):
+                matrix[r + k][c] = next(it)
+    for r in range(rows - rows % 4, rows):
+        for c in range(dim):
+            matrix[r][c] = next(it)
+    return matrix
+
+
+def quantize(q, scale, zero):
+    return max(0, min(LEVELS - 1, int(math.floor(q * (1 << SCALE_SHIFT) / float(scale) + 0.5)) + zero))
+
+
+def quantize_row(row):
+    """(scale, zero, [q]) of least squared error for one row."""
+    lo = min(min(row), 0)
+    hi = max(max(row), 0)
+    if hi == lo:
+        return 1 << SCALE_SHIFT, 0, [0] * len(row)
+    widest = (hi - lo) * (1 << SCALE_SHIFT) / float(LEVELS - 1)
+    best = None
+    for step in range(SCALE_STEPS + 1):
+        scale = min(SCALE_MAX, max(1, int(round(widest * (1.0 - 0.5 * step / SCALE_STEPS)))))
+        centre = int(round(-lo * (1 << SCALE_SHIFT) / float(scale)))
+        for zero in range(centre - 1, centre + 2):
+            if not 0 <= zero < LEVELS:
+                continue
+            qs = [quantize(w, scale, zero) for w in row]
+            error = sum((w - (q - zero) * scale / float(1 << SCALE_SHIFT)) ** 2 for w, q in zip(row, qs))
+            if best is None or error < best[0]:
+                best = (error, scale, zero, qs)
+    return best[1], best[2], best[3]
+
+
+def pack(matrix, dim):
+    """Bytes of arm_fully_connected_q7_q4() from rows of 4-bit values."""
+    def row_bytes(qs):
+        qs = qs + [0] * (dim % 2)
+        return [qs[i] | qs[i + 1] << 4 for i in range(0, len(qs), 2)]
+    packed = []
+    for r in range(0, len(matrix), 4):
+        group = [row_bytes(row) for row in matrix[r:r + 4]]
+        for p in range(len(group[0])):
+            packed += [row[p] for row in group]
+    return packed
+
+
+def c_list(values, per_line=32):
+    lines = [",".join(str(v) for v in values[i:i + per_line]) for i in range(0, len(values), per_line)]
+    return "{" + ", \\\n    ".join(lines) + "}"
+
+
+def header_text(prefix, source, name, dim, rows, packed, scales, zeros, rms, worst, guard):
+    return "\n".join([
+        "/* Generated by tools/nn_q4_pack.py from %s %s: do not edit." % (source, name),
+        " * %d rows of %d weights in 4 bits for arm_fully_connected_q7_q4(), %d bytes"
+        % (rows, dim, len(packed) + 2 * len(scales) + len(zeros)),
+        " * with the scales and zero points, against %d in q7. Weight error %.3f q7 steps"
+        % (dim * rows, rms),
+        " * RMS, %.3f at most. */" % worst,
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#define %s_DIM %d" % (prefix, dim),
+        "#define %s_ROWS %d" % (prefix, rows),
+        "#define %s_SIZE %d" % (prefix, len(packed)),
+        "#define %s %s" % (prefix, c_list(packed)),
+        "#define %s_SCALE %s" % (prefix, c_list(scales, 16)),
+        "#define %s_ZERO %s" % (prefix, c_list(zeros)),
+        "",
+        "#endif /* %s */" % guard,
+        "",
+    ])
+
+
+def write_if_changed(path, text):
+    """Keep the timestamp, and the objects built from it, when nothing changed."""
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("header", help="C header of the q7 weights")
+    parser.add_argument("name", help="macro of the weights, #define NAME {...}")
+    parser.add_argument("--dim", type=int, required=True, help="columns: the length of the input vector")
+    parser.add_argument("--rows", type=int, required=True, help="rows: the length of the output vector")
+    parser.add_argument("--layout", choices=("rows", "opt"), default="rows",
+                        help="order of the q7 weights (default rows)")
+    parser.add_argument("--prefix", help="macros of the packed weights (default: NAME_Q4)")
+    parser.add_argument("--output", help="header of packed weights to write")
+    args = parser.parse_args(argv)
+
+    try:
+        values = read_define(args.header, args.name)
+    except (OSError, ValueError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+    if len(values) != args.dim * args.rows:
+        print("error: %s has %d weights, not %d x %d" % (args.name, len(values), args.rows, args.dim),
+              file=sys.stderr)
+        return 2
+    if any(not -128 <= v <= 127 for v in values):
+        print("error: %s is not q7" % args.name, file=sys.stderr)
+        return 2
+
+    if args.layout == "opt":
+        matrix = from_opt(values, args.dim, args.rows)
+    else:
+        matrix = [values[r * args.dim:(r + 1) * args.dim] for r in range(args.rows)]
+    scales, zeros, quantized = [], [], []
+    squares = 0.0
+    worst = 0.0
+    for row in matrix:
+        scale, zero, qs = quantize_row(row)
+        scales.append(scale)
+        zeros.append(zero)
+        quantized.append(qs)
+        for w, q in zip(row, qs):
+            error = abs(w - (q - zero) * scale / float(1 << SCALE_SHIFT))
+            squares += error * error
+            worst = max(worst, error)
+    rms = math.sqrt(squares / len(values))
+    packed = pack(quantized, args.dim)
+
+    prefix = args.prefix if args.prefix else args.name + "_Q4"
+    if args.output:
+        guard = "__%s" % os.path.basename(args.output).upper().replace(".", "_").replace("-", "_")
+        write_if_changed(args.output, header_text(prefix, os.path.basename(args.header), args.name, args.dim,
+                                                  args.rows, packed, scales, zeros, rms, worst, guard))
+    print("%s: %d x %d weights in %d bytes (scales and zeros included), %d in q7; error %.3f q7 steps RMS, "
+          "%.3f at most" % (args.name, args.rows, args.dim, len(packed) + 3 * len(scales), len(values),
+                            rms, worst))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
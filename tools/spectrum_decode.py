@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""Decode the frames of the spectrum analyzer as captured from USART3.
+
+Reads the byte stream of stm32f072b_discovery_spectrum.c (frame format in
+stm32f072b_discovery_spectrum.h): finds each frame by its sync bytes, checks
+its length and Fletcher-16, and rebuilds the bins of the delta frames from
+the last frame decoded. After a sequence gap or a bad frame the delta frames
+are skipped up to the next key frame.
+
+The bins go to a CSV file, one frame per line: the frame number (counted
+from the sequence numbers), then the bins, or their level in dB under a
+full-scale sine (--db); or to a binary PGM spectrogram, one row per frame.
+With --check, the frames of the CSV file written by "bench_spectrum
+--capture" must all be decoded, and to the same bins.
+
+    spectrum_decode.py capture.bin --csv bins.csv --pgm spectrogram.pgm
+The exit status is 1 when --check fails, 2 when a file cannot be used.
+"""
+
+import argparse
+import math
+import sys
+
+SYNC = b"\xa5\x5a"
+FLAG_KEY = 0x80
+SEQ_MASK = 0x7F
+NIBBLE_ESCAPE = 0x0F
+HEADER_SIZE = 6
+KEY_INFO_SIZE = 6
+CHECKSUM_SIZE = 2
+BIN_FULL_SCALE = 224
+DB_PER_STEP = 10.0 * math.log10(2.0) / 8.0
+
+
+def fletcher16(data):
+    sum1 = sum2 = 0
+    for byte in data:
+        sum1 = (sum1 + byte) % 255
+        sum2 = (sum2 + sum1) % 255
+    return sum1, sum2
+
+
+def undelta(payload, previous):
+    """Bins of a delta payload, or None if it does not hold them all"""
+    nibbles = []
+    for byte in payload:
+        nibbles += [byte & 0x0F, byte >> 4]
+    bins = []
+    i = 0
+    for last in previous:
+        if i >= len(nibbles):
+            return None
+        code = nibbles[i]
+        if code == NIBBLE_ESCAPE:
+            if i + 3 > len(nibbles):
+                return None
+            bins.append(nibbles[i + 1] << 4 | nibbles[i + 2])
+            i += 3
+        else:
+            bins.append(last + (code >> 1 if code & 1 == 0 else -((code + 1) >> 1)))
+            i += 1
+    return bins if all(0 <= b <= 255 for b in bins) else None
+
+
+class Decoder(object):
+    def __init__(self):
+        self.frames = []            # (number, bins)
+        self.keys = 0
+        self.deltas = 0
+        self.bad = 0                # checksum or length
+        self.skipped = 0            # delta frames with no reference
+        self.gaps = 0
+        self.rate = None
+        self.hop = None
+
+    def decode(self, data):
+        pos = 0
+        bins = None
+        seq = number = None
+        while True:
+            pos = data.find(SYNC, pos)
+            if pos < 0 or pos + HEADER_SIZE > len(data):
+                break
+            flags, log2n = data[pos + 2], data[pos + 3]
+            length = data[pos + 4] | data[pos + 5] << 8
+            end = pos + HEADER_SIZE + length
+            count = (1 << log2n) // 2 if 1 <= log2n <= 15 else 0
+            if count == 0 or length > KEY_INFO_SIZE + count or end + CHECKSUM_SIZE > len(data) \
+                    or fletcher16(data[pos + 2:end]) != tuple(data[end:end + CHECKSUM_SIZE]):
+                # Not a frame, or a damaged one: look for the next sync
+                self.bad += 1
+                bins = None
+                pos += 1
+                continue
+            payload = data[pos + HEADER_SIZE:end]
+            pos = end + CHECKSUM_SIZE
+
+            if seq is not None:
+                step = ((flags & SEQ_MASK) - seq) & SEQ_MASK
+                if step != 1:
+                    self.gaps += 1
+                    bins = None
+                number += step if step else SEQ_MASK + 1
+            else:
+                number = flags & SEQ_MASK
+            seq = flags & SEQ_MASK
+
+            if flags & FLAG_KEY:
+                if length != KEY_INFO_SIZE + count:
+                    self.bad += 1
+                    bins = None
+                    continue
+                self.rate = int.from_bytes(payload[0:4], "little")
+                self.hop = int.from_bytes(payload[4:6], "little")
+                bins = list(payload[KEY_INFO_SIZE:])
+                self.keys += 1
+            else:
+                if bins is None or len(bins) != count:
+                    self.skipped += 1
+                    bins = None
+                    continue
+                bins = undelta(payload, bins)
+                if bins is None:
+                    self.bad += 1
+                    continue
+                self.deltas += 1
+            self.frames.append((number, list(bins)))
+        return self.frames
+
+
+def write_csv(path, frames, db):
+    with open(path, "w") as f:
+        for number, bins in frames:
+            if db:
+                values = ["%.2f" % ((b - BIN_FULL_SCALE) * DB_PER_STEP) for b in bins]
+            else:
+                values = ["%d" % b for b in bins]
+            f.write("%d,%s\n" % (number, ",".join(values)))
+
+
+def write_pgm(path, frames):
+    width = max(len(bins) for _, bins in frames)
+    with open(path, "wb") as f:
+        f.write(b"P5\n%d %d\n255\n" % (width, len(frames)))
+        for _, bins in frames:
+            f.write(bytes(bins + [0] * (width - len(bins))))
+
+
+def check(path, frames):
+    decoded = dict(frames)
+    failures = 0
+    count = 0
+    with open(path) as f:
+        for line in f:
+            fields = [int(v) for v in line.split(",")]
+            count += 1
+            bins = decoded.get(fields[0])
+            if bins is None:
+                print("frame %d not decoded" % fields[0])
+                failures += 1
+            elif bins != fields[1:]:
+                first = next(i for i, (a, b) in enumerate(zip(bins, fields[1:])) if a != b) \
+                    if len(bins) == len(fields) - 1 else 0
+                print("frame %d: bin %d decoded as %d, sent as %d" % (fields[0], first, bins[first],
+                                                                      fields[1 + first]))
+                failures += 1
+    if len(decoded) != count:
+        print("%d frames decoded, %d sent" % (len(decoded), count))
+        failures += 1
+    return failures
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="bytes received from USART3")
+    parser.add_argument("--csv", help="write the bins of each frame here")
+    parser.add_argument("--db", action="store_true", help="levels in dB under a full-scale sine in the CSV")
+    parser.add_argument("--pgm", help="write a spectrogram here")
+    parser.add_argument("--check", help="CSV of the bins sent (bench_spectrum --capture)")
+    args = parser.parse_args(argv)
+
+    try:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    except OSError as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+
+    decoder = Decoder()
+    frames = decoder.decode(data)
+    print("%d frames: %d key, %d delta; %d bad, %d skipped, %d sequence gaps%s" % (
+        len(frames), decoder.keys, decoder.deltas, decoder.bad, decoder.skipped, decoder.gaps,
+        "; %d Hz, hop %d" % (decoder.rate, decoder.hop) if decoder.rate is not None else ""))
+
+    try:
+        if args.csv:
+            write_csv(args.csv, frames, args.db)
+        if args.pgm and frames:
+            write_pgm(args.pgm, frames)
+        if args.check:
+            failures = check(args.check, frames)
+            if failures:
+                return 1
+            print("every frame sent decoded to the same bins")
+    except (OSError, ValueError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
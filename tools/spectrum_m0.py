@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Frames per second and CPU load of the spectrum analyzer on the Cortex-M0.
+
+Runs the CMSIS-DSP stages of one frame of stm32f072b_discovery_spectrum.c,
+arm_mult_q15() for the Hann window and arm_rfft_q15(), as the prebuilt
+libarm_cortexM0l_math.a has them, on m0_model.M0 at 48 MHz (1 flash wait
+state), for 256 and 512-point frames. The objects are linked by
+m0_model.ElfImage from the functions called, as --gc-sections would.
+
+The frames come from "bench_spectrum --vectors": the samples of a frame, the
+window of the BSP, the output of arm_rfft_q15() on the host and the bins of
+the BSP. The model output must equal the host one bit for bit, and the bins
+taken from it (SPECTRUM_Log() below) those of the BSP.
+
+The C stages of the BSP itself (power and log of each bin, delta encoding,
+checksum, bookkeeping) are not compiled for the Cortex-M0 here: their
+cycles are estimates (EST_* below), marked as such in the table. The frame
+rate is that of a 48 ksps input with 50% overlap; the UART bound is that of
+the delta frames where every bin changes by less than 8 steps, and of the
+key frames.
+
+    spectrum_m0.py bench_spectrum --library libarm_cortexM0l_math.a
+        --output spectrum_m0.md
+The exit status is 1 on a mismatch or fault, 2 when a file cannot be used.
+"""
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import m0_model                     # noqa: E402
+
+MEMBERS = ("arm_rfft_q15.o", "arm_rfft_init_q15.o", "arm_cfft_q15.o", "arm_cfft_radix4_q15.o",
+           "arm_bitreversal2.o", "arm_const_structs.o", "arm_common_tables.o", "arm_mult_q15.o")
+ROOTS = ("arm_rfft_init_q15", "arm_rfft_q15", "arm_mult_q15")
+
+CPU_HZ = 48000000
+WAIT_STATES = 1
+SAMPLE_RATE = 48000
+BAUD_RATES = (921600, 115200)
+
+# Model RAM: instance, then the buffers of the BSP; the stack at the top
+INSTANCE = m0_model.RAM_BASE
+INPUT = m0_model.RAM_BASE + 0x100
+WINDOW = m0_model.RAM_BASE + 0x500
+FRAME = m0_model.RAM_BASE + 0x900
+OUTPUT = m0_model.RAM_BASE + 0xD00
+
+# Estimated Cortex-M0 cycles of the BSP C code, loads from RAM, 1 wait state
+# on the flash table
+EST_BIN = 40            # two loads, two MULS, the normalisation, table, store
+EST_DELTA_BIN = 26      # difference, range test, one nibble
+EST_CHECKSUM_BYTE = 7   # load, two adds, loop
+EST_FRAME = 700         # frame taken, second arm_mult_q15() call, copies, send
+EST_PUSH_SAMPLE = 4     # memcpy() into the ring, in the sampler interrupt
+
+HEADER = 6
+KEY_INFO = 6
+CHECKSUM = 2
+
+LOG_TABLE = [0, 0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 3,
+             3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 5,
+             5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+             7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8]
+
+
+def spectrum_log(power):
+    """SPECTRUM_Log() of the BSP"""
+    if power == 0:
+        return 0
+    exponent = power.bit_length() - 1
+    mantissa = (power << (31 - exponent)) & 0xFFFFFFFF
+    return 8 * exponent + LOG_TABLE[(mantissa >> 25) & 0x3F]
+
+
+def read_frames(program):
+    out = subprocess.run([program, "--vectors"], check=True, stdout=subprocess.PIPE,
+                         universal_newlines=True).stdout
+    frames = []
+    for line in out.splitlines():
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "frame":
+            frames.append({"size": int(words[1])})
+        else:
+            frames[-1][words[0]] = [int(w) for w in words[1:]]
+    return frames
+
+
+class Analyzer(object):
+    """The CMSIS-DSP stages of a frame on the model."""
+
+    def __init__(self, library):
+        image = m0_model.ElfImage(["%s(%s)" % (library, member) for member in MEMBERS], roots=ROOTS)
+        self.flash = sum(size for addr, _, size in image.segments if addr < m0_model.RAM_BASE)
+        self.model = m0_model.M0(image, wait_states=WAIT_STATES)
+        self.entry = dict((name, image.symbol(name).addr | 1) for name in ROOTS)
+
+    def run(self, frame):
+        """Output and bins of a frame; cycles of each stage"""
+        model, size = self.model, frame["size"]
+        cycles = {}
+        status, cycles["init"], _ = model.call(self.entry["arm_rfft_init_q15"], [INSTANCE, size, 0, 1])
+        if status != 0:
+            raise m0_model.M0Fault("arm_rfft_init_q15(%d) returned %d" % (size, status - (1 << 32)))
+        model.write(INPUT, struct.pack("<%dh" % size, *frame["input"]))
+        model.write(WINDOW, struct.pack("<%dh" % size, *frame["window"]))
+        cycles["window"] = model.call(self.entry["arm_mult_q15"], [INPUT, WINDOW, FRAME, size])[1]
+        model.write(OUTPUT, bytes(4 * size))
+        cycles["rfft"] = model.call(self.entry["arm_rfft_q15"], [INSTANCE, FRAME, OUTPUT])[1]
+        output = list(struct.unpack("<%dh" % (2 * size), model.read(OUTPUT, 4 * size)))
+        bins = [spectrum_log(output[2 * k] ** 2 + output[2 * k + 1] ** 2) for k in range(size // 2)]
+        return output, bins, cycles
+
+
+def estimates(size):
+    bins = size // 2
+    delta = HEADER + (bins + 1) // 2 + CHECKSUM
+    return {
+        "bins": EST_BIN * bins,
+        "encode": EST_DELTA_BIN * bins + EST_CHECKSUM_BYTE * delta + EST_FRAME,
+        "push": EST_PUSH_SAMPLE * size // 2,
+        "delta_bytes": delta,
+        "key_bytes": HEADER + KEY_INFO + bins + CHECKSUM,
+    }
+
+
+def markdown(rows, flash):
+    lines = [
+        "# Spectrum analyzer on the Cortex-M0",
+        "",
+        "Cycle model of `tools/m0_model.py` at %d MHz, %d flash wait state: `arm_mult_q15()` and `arm_rfft_q15()`"
+        % (CPU_HZ // 1000000, WAIT_STATES),
+        "of `libarm_cortexM0l_math.a` (%d bytes of code and tables linked), per frame. Bins, encoding and the"
+        % flash,
+        "ring are C code of the BSP: estimated cycles (est.). Frames at %d ksps with 50%% overlap; the CPU"
+        % (SAMPLE_RATE // 1000),
+        "load is that of the analyzer alone, the sampler chain apart. UART bound: 8N1, delta frames of",
+        "small changes / key frames.",
+        "",
+        "| FFT | arm_mult_q15 | arm_rfft_q15 | Bins (est.) | Encoding (est.) | Cycles/frame | Max frames/s "
+        "| Frames/s | CPU load | Delta / key bytes | %s |"
+        % " | ".join("UART frames/s at %d" % baud for baud in BAUD_RATES),
+        "| --- | --- | --- | --- | --- | --- | --- | --- | --- | --- |%s" % (" --- |" * len(BAUD_RATES)),
+    ]
+    for size, cycles, est in rows:
+        total = cycles["window"] + cycles["rfft"] + est["bins"] + est["encode"]
+        rate = SAMPLE_RATE / (size / 2.0)
+        load = rate * (total + est["push"]) / CPU_HZ
+        uart = ["%d / %d" % (baud // 10 // est["delta_bytes"], baud // 10 // est["key_bytes"])
+                for baud in BAUD_RATES]
+        lines.append("| %d | %d | %d | %d | %d | %d | %d | %.1f | %.1f%% | %d / %d | %s |" % (
+            size, cycles["window"], cycles["rfft"], est["bins"], est["encode"], total,
+            CPU_HZ // total, rate, 100.0 * load, est["delta_bytes"], est["key_bytes"], " | ".join(uart)))
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("vectors", help="the bench_spectrum program")
+    parser.add_argument("--library", required=True, help="libarm_cortexM0l_math.a")
+    parser.add_argument("--output", help="write the table here (default: stdout)")
+    args = parser.parse_args(argv)
+
+    try:
+        analyzer = Analyzer(args.library)
+        frames = read_frames(args.vectors)
+    except (ValueError, KeyError, OSError, subprocess.CalledProcessError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+
+    failures = 0
+    rows = []
+    for frame in frames:
+        size = frame["size"]
+        try:
+            output, bins, cycles = analyzer.run(frame)
+        except m0_model.M0Fault as fault:
+            print("%d points: HardFault: %s" % (size, fault))
+            failures += 1
+            continue
+        if output != frame["output"]:
+            first = next(i for i, (a, b) in enumerate(zip(output, frame["output"])) if a != b)
+            print("%d points: arm_rfft_q15() output %d is %d, not %d" % (size, first, output[first],
+                                                                         frame["output"][first]))
+            failures += 1
+            continue
+        if bins != frame["bins"]:
+            first = next(i for i, (a, b) in enumerate(zip(bins, frame["bins"])) if a != b)
+            print("%d points: bin %d is %d, not %d" % (size, first, bins[first], frame["bins"][first]))
+            failures += 1
+            continue
+        print("%d points: output and bins as on the host; arm_rfft_q15() %d cycles"
+              % (size, cycles["rfft"]))
+        rows.append((size, cycles, estimates(size)))
+    if failures or not rows:
+        return 1
+
+    text = markdown(rows, analyzer.flash)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+        print("table written to %s" % args.output)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())